@@ -309,7 +309,7 @@ NOTE:	Usually, you should let AlertMessages_BoxWrap objects
 void
 Alert_Release	(AlertMessages_BoxRef*		inoutAlertPtr)
 {
-	if (gAlertBoxValidRefs().end() == gAlertBoxValidRefs().find(*inoutAlertPtr))
+	if (false == gAlertBoxValidRefs().contains(*inoutAlertPtr))
 	{
 		Console_Warning(Console_WriteValueAddress, "attempt to Alert_Release() with invalid reference", *inoutAlertPtr);
 	}
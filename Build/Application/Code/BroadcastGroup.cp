@@ -0,0 +1,552 @@
+/*!	\file BroadcastGroup.cp
+	\brief Keeps track of the members of numbered groups that
+	receive the same input.
+*/
+/*###############################################################
+
+	MacTerm
+		© 1998-2021 by Kevin Grant.
+		© 2001-2003 by Ian Anderson.
+		© 1986-1994 University of Illinois Board of Trustees
+		(see About box for full list of U of I contributors).
+	
+	This program is free software; you can redistribute it or
+	modify it under the terms of the GNU General Public License
+	as published by the Free Software Foundation; either version
+	2 of the License, or (at your option) any later version.
+	
+	This program is distributed in the hope that it will be
+	useful, but WITHOUT ANY WARRANTY; without even the implied
+	warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+	PURPOSE.  See the GNU General Public License for more
+	details.
+	
+	You should have received a copy of the GNU General Public
+	License along with this program; if not, write to:
+	
+		Free Software Foundation, Inc.
+		59 Temple Place, Suite 330
+		Boston, MA  02111-1307
+		USA
+
+###############################################################*/
+
+#include "BroadcastGroup.h"
+#include <UniversalDefines.h>
+
+// standard-C includes
+#include <cerrno>
+
+// standard-C++ includes
+#include <algorithm>
+#include <map>
+#include <string>
+#include <thread>
+
+// UNIX includes
+extern "C"
+{
+#	include <unistd.h>
+}
+
+// library includes
+#include <Console.h>
+
+
+
+#pragma mark Types
+namespace {
+
+/*!
+A member of a group, and the writer that it uses for
+input (used to find members that have fallen behind).
+*/
+struct My_Member
+{
+	BroadcastGroup_Member	member;		//!< the member itself
+	AsyncWriter_Ref			writer;		//!< not owned; see BroadcastGroup_AddMember()
+};
+typedef std::vector< My_Member >				My_MemberList;
+typedef std::map< UInt32, My_MemberList >		My_MemberListByGroup;
+
+} // anonymous namespace
+
+#pragma mark Variables
+namespace {
+
+My_MemberListByGroup&	gMemberListsByGroup ()	{ static My_MemberListByGroup x; return x; } // main thread only
+
+} // anonymous namespace
+
+#pragma mark Internal Method Prototypes
+namespace {
+
+void		readTestData			(int, size_t, std::string*);
+Boolean		unitTest000_Begin		();
+Boolean		unitTest001_Begin		();
+
+} // anonymous namespace
+
+
+
+#pragma mark Public Methods
+
+/*!
+A unit test for this module.  This should always
+be run before a release, after any substantial
+changes are made, or if you suspect bugs!  It
+should also be EXPANDED as new functionality is
+proposed (ideally, a test is written before the
+functionality is added).
+
+(2021.06)
+*/
+void
+BroadcastGroup_RunTests ()
+{
+	UInt16		totalTests = 0;
+	UInt16		failedTests = 0;
+	
+	
+	++totalTests; if (false == unitTest000_Begin()) ++failedTests;
+	++totalTests; if (false == unitTest001_Begin()) ++failedTests;
+	
+	Console_WriteUnitTestReport("Broadcast Group", failedTests, totalTests);
+}// RunTests
+
+
+/*!
+Adds a member to the given group, after removing it from
+any group that it is already in.  Members are kept in the
+order that they were added.
+
+The writer is only used to find out whether or not the
+member has fallen behind (see BroadcastGroup_ReturnActiveMembers()),
+so it must stay valid until the member is removed.
+
+\retval kBroadcastGroup_ResultOK
+if the member is now in the given group
+
+\retval kBroadcastGroup_ResultParameterError
+if the group number is 0, or the member or writer is null
+(nothing changes)
+
+(2021.06)
+*/
+BroadcastGroup_Result
+BroadcastGroup_AddMember	(UInt32						inGroupNumber,
+							 BroadcastGroup_Member		inMember,
+							 AsyncWriter_Ref			inWriter)
+{
+	BroadcastGroup_Result	result = kBroadcastGroup_ResultOK;
+	
+	
+	if ((0 == inGroupNumber) || (nullptr == inMember) || (nullptr == inWriter))
+	{
+		result = kBroadcastGroup_ResultParameterError;
+	}
+	else
+	{
+		BroadcastGroup_RemoveMember(inMember);
+		gMemberListsByGroup()[inGroupNumber].push_back(My_Member{ inMember, inWriter });
+	}
+	return result;
+}// AddMember
+
+
+/*!
+Removes a member from its group, if it is in one.  A group
+that has no more members no longer exists.
+
+(2021.06)
+*/
+void
+BroadcastGroup_RemoveMember		(BroadcastGroup_Member		inMember)
+{
+	auto&	listsByGroup = gMemberListsByGroup();
+	
+	
+	for (auto groupIterator = listsByGroup.begin(); groupIterator != listsByGroup.end(); ++groupIterator)
+	{
+		auto&	members = groupIterator->second;
+		auto	toMember = std::find_if(members.begin(), members.end(),
+										[inMember](My_Member const& aMember) { return (inMember == aMember.member); });
+		
+		
+		if (members.end() != toMember)
+		{
+			members.erase(toMember);
+			if (members.empty())
+			{
+				listsByGroup.erase(groupIterator);
+			}
+			break;
+		}
+	}
+}// RemoveMember
+
+
+/*!
+Returns the members of the given group that should receive
+new input from the given sender, in the order that they were
+added.  The sender is always included (even if it is not in
+the group).
+
+Any other member whose writer backlog is full (see
+AsyncWriter_IsBacklogFull()) is removed from the group first,
+so that one slow reader cannot make the others wait or use an
+unlimited amount of memory.  If a filter is given, only the
+members that it accepts are removed (for instance, a member
+that is pacing its own input may be allowed to fall behind).
+Removed members are appended to the given list, if any, so
+that the caller can clean up after them.
+
+(2021.06)
+*/
+std::vector< BroadcastGroup_Member >
+BroadcastGroup_ReturnActiveMembers	(UInt32									inGroupNumber,
+									 BroadcastGroup_Member					inSender,
+									 BroadcastGroup_RemovalFilter			inMayRemoveOrNull,
+									 std::vector< BroadcastGroup_Member >*	outRemovedMembersOrNull)
+{
+	std::vector< BroadcastGroup_Member >	result;
+	auto									toGroup = gMemberListsByGroup().find(inGroupNumber);
+	
+	
+	if (gMemberListsByGroup().end() == toGroup)
+	{
+		result.push_back(inSender);
+	}
+	else
+	{
+		// copy the list, since it changes when a member is removed
+		My_MemberList const		kMembers = toGroup->second;
+		Boolean					foundSender = false;
+		
+		
+		for (auto const& member : kMembers)
+		{
+			if (member.member == inSender)
+			{
+				// the member that sent the input is never removed
+				foundSender = true;
+				result.push_back(member.member);
+			}
+			else if (AsyncWriter_IsBacklogFull(member.writer) &&
+						((nullptr == inMayRemoveOrNull) || inMayRemoveOrNull(member.member)))
+			{
+				BroadcastGroup_RemoveMember(member.member);
+				if (nullptr != outRemovedMembersOrNull)
+				{
+					outRemovedMembersOrNull->push_back(member.member);
+				}
+			}
+			else
+			{
+				result.push_back(member.member);
+			}
+		}
+		
+		if (false == foundSender)
+		{
+			result.insert(result.begin(), inSender);
+		}
+	}
+	return result;
+}// ReturnActiveMembers
+
+
+/*!
+Returns the number of the group that the given member is
+in, or 0 if it is not in a group.
+
+(2021.06)
+*/
+UInt32
+BroadcastGroup_ReturnGroupNumber	(BroadcastGroup_Member		inMember)
+{
+	UInt32		result = 0;
+	
+	
+	for (auto const& groupMembersPair : gMemberListsByGroup())
+	{
+		auto const&		members = groupMembersPair.second;
+		
+		
+		if (members.end() != std::find_if(members.begin(), members.end(),
+											[inMember](My_Member const& aMember) { return (inMember == aMember.member); }))
+		{
+			result = groupMembersPair.first;
+			break;
+		}
+	}
+	return result;
+}// ReturnGroupNumber
+
+
+/*!
+Returns the number of members in the given group (0 if
+the group does not exist).
+
+(2021.06)
+*/
+size_t
+BroadcastGroup_ReturnMemberCount	(UInt32		inGroupNumber)
+{
+	auto		toGroup = gMemberListsByGroup().find(inGroupNumber);
+	size_t		result = 0;
+	
+	
+	if (gMemberListsByGroup().end() != toGroup)
+	{
+		result = toGroup->second.size();
+	}
+	return result;
+}// ReturnMemberCount
+
+
+#pragma mark Internal Methods
+namespace {
+
+/*!
+Reads from the given file descriptor until the given number
+of bytes have been read (or there is an error), appending
+them to the given string.  Used by tests.
+
+(2021.06)
+*/
+void
+readTestData	(int			inFileDescriptor,
+				 size_t			inByteCount,
+				 std::string*	outDataPtr)
+{
+	char	buffer[4096];
+	
+	
+	while (outDataPtr->size() < inByteCount)
+	{
+		ssize_t		bytesRead = read(inFileDescriptor, buffer, std::min(sizeof(buffer), inByteCount - outDataPtr->size()));
+		
+		
+		if (bytesRead <= 0)
+		{
+			break;
+		}
+		outDataPtr->append(buffer, bytesRead);
+	}
+}// readTestData
+
+
+/*!
+Tests group membership: adding members to groups, moving
+a member to another group, removing members, and invalid
+input.
+
+Returns "true" if ALL assertions pass; "false" is
+returned if any fail, however messages should be
+printed for ALL assertion failures regardless.
+
+(2021.06)
+*/
+Boolean
+unitTest000_Begin ()
+{
+	int			pipeFDs[2] = { -1, -1 };
+	Boolean		result = true;
+	
+	
+	Console_TestAssertUpdate(result, 0 == pipe(pipeFDs), Console_WriteValue, "pipe error", errno);
+	if (result)
+	{
+		// the writer is never used to write anything here; any valid writer will do
+		AsyncWriter_Ref		writer = AsyncWriter_New(pipeFDs[1], 1024/* backlog limit */, nullptr/* label */);
+		int					memberData[3] = { 0, 0, 0 };
+		void*				members[3] = { &memberData[0], &memberData[1], &memberData[2] };
+		
+		
+		Console_TestAssertUpdate(result, kBroadcastGroup_ResultParameterError == BroadcastGroup_AddMember(0, members[0], writer),
+									Console_WriteLine, "expected group 0 to be rejected");
+		Console_TestAssertUpdate(result, kBroadcastGroup_ResultParameterError == BroadcastGroup_AddMember(1, nullptr, writer),
+									Console_WriteLine, "expected null member to be rejected");
+		Console_TestAssertUpdate(result, kBroadcastGroup_ResultParameterError == BroadcastGroup_AddMember(1, members[0], nullptr),
+									Console_WriteLine, "expected null writer to be rejected");
+		Console_TestAssertUpdate(result, 0 == BroadcastGroup_ReturnGroupNumber(members[0]),
+									Console_WriteLine, "rejected member should not be in a group");
+		
+		Console_TestAssertUpdate(result, kBroadcastGroup_ResultOK == BroadcastGroup_AddMember(1, members[0], writer),
+									Console_WriteLine, "failed to add first member");
+		Console_TestAssertUpdate(result, kBroadcastGroup_ResultOK == BroadcastGroup_AddMember(1, members[1], writer),
+									Console_WriteLine, "failed to add second member");
+		Console_TestAssertUpdate(result, kBroadcastGroup_ResultOK == BroadcastGroup_AddMember(2, members[2], writer),
+									Console_WriteLine, "failed to add third member");
+		Console_TestAssertUpdate(result, 2 == BroadcastGroup_ReturnMemberCount(1), Console_WriteValue, "group 1 count",
+									BroadcastGroup_ReturnMemberCount(1));
+		Console_TestAssertUpdate(result, 1 == BroadcastGroup_ReturnMemberCount(2), Console_WriteValue, "group 2 count",
+									BroadcastGroup_ReturnMemberCount(2));
+		Console_TestAssertUpdate(result, 2 == BroadcastGroup_ReturnGroupNumber(members[2]), Console_WriteValue, "group number",
+									BroadcastGroup_ReturnGroupNumber(members[2]));
+		
+		// adding a member again does not duplicate it
+		Console_TestAssertUpdate(result, kBroadcastGroup_ResultOK == BroadcastGroup_AddMember(1, members[1], writer),
+									Console_WriteLine, "failed to add second member again");
+		Console_TestAssertUpdate(result, 2 == BroadcastGroup_ReturnMemberCount(1), Console_WriteValue, "group 1 count",
+									BroadcastGroup_ReturnMemberCount(1));
+		
+		// every member receives input from any member, in the order they were added
+		{
+			std::vector< BroadcastGroup_Member > const		kExpected = { members[0], members[1] };
+			
+			
+			Console_TestAssertUpdate(result, kExpected == BroadcastGroup_ReturnActiveMembers(1, members[1]),
+										Console_WriteLine, "wrong members for input from second member");
+		}
+		
+		// a member that moves leaves its old group, and an empty group no longer exists
+		Console_TestAssertUpdate(result, kBroadcastGroup_ResultOK == BroadcastGroup_AddMember(1, members[2], writer),
+									Console_WriteLine, "failed to move third member");
+		Console_TestAssertUpdate(result, 3 == BroadcastGroup_ReturnMemberCount(1), Console_WriteValue, "group 1 count",
+									BroadcastGroup_ReturnMemberCount(1));
+		Console_TestAssertUpdate(result, 0 == BroadcastGroup_ReturnMemberCount(2), Console_WriteValue, "group 2 count",
+									BroadcastGroup_ReturnMemberCount(2));
+		Console_TestAssertUpdate(result, 1 == BroadcastGroup_ReturnGroupNumber(members[2]), Console_WriteValue, "group number",
+									BroadcastGroup_ReturnGroupNumber(members[2]));
+		
+		// a sender that is not in the group only sends to itself
+		{
+			int												otherData = 0;
+			std::vector< BroadcastGroup_Member > const		kExpected = { &otherData };
+			
+			
+			Console_TestAssertUpdate(result, kExpected == BroadcastGroup_ReturnActiveMembers(2, &otherData),
+										Console_WriteLine, "wrong members for sender without a group");
+		}
+		
+		for (auto member : members)
+		{
+			BroadcastGroup_RemoveMember(member);
+			Console_TestAssertUpdate(result, 0 == BroadcastGroup_ReturnGroupNumber(member),
+										Console_WriteLine, "removed member should not be in a group");
+		}
+		Console_TestAssertUpdate(result, 0 == BroadcastGroup_ReturnMemberCount(1), Console_WriteValue, "group 1 count",
+									BroadcastGroup_ReturnMemberCount(1));
+		
+		// removing a member that is not in a group does nothing
+		BroadcastGroup_RemoveMember(members[0]);
+		
+		AsyncWriter_Dispose(&writer);
+	}
+	
+	UNUSED_RETURN(int)close(pipeFDs[0]);
+	UNUSED_RETURN(int)close(pipeFDs[1]);
+	
+	return result;
+}// unitTest000_Begin
+
+
+/*!
+Tests fan-out: input is given to every member of a group,
+through the writer of each member, except for a member
+whose reader has stopped (which is removed from the group,
+without delaying the others).
+
+Returns "true" if ALL assertions pass; "false" is
+returned if any fail, however messages should be
+printed for ALL assertion failures regardless.
+
+(2021.06)
+*/
+Boolean
+unitTest001_Begin ()
+{
+	size_t const	kMemberCount = 3;
+	size_t const	kStalledMember = 2;
+	int				pipes[kMemberCount][2] = { { -1, -1 }, { -1, -1 }, { -1, -1 } };
+	Boolean			result = true;
+	
+	
+	for (size_t i = 0; i < kMemberCount; ++i)
+	{
+		Console_TestAssertUpdate(result, 0 == pipe(pipes[i]), Console_WriteValue, "pipe error", errno);
+	}
+	if (result)
+	{
+		AsyncWriter_Buffer const				kInput = std::make_shared< std::vector< UInt8 > const >(100000, 'z');
+		AsyncWriter_Buffer const				kBacklog = std::make_shared< std::vector< UInt8 > const >(256 * 1024, 'b');
+		AsyncWriter_Ref							writers[kMemberCount] = { nullptr, nullptr, nullptr };
+		BroadcastGroup_Member					members[kMemberCount] = { nullptr, nullptr, nullptr };
+		std::vector< BroadcastGroup_Member >	activeMembers;
+		std::vector< BroadcastGroup_Member >	removedMembers;
+		std::string								output[kMemberCount];
+		std::thread								readers[kMemberCount];
+		
+		
+		for (size_t i = 0; i < kMemberCount; ++i)
+		{
+			writers[i] = AsyncWriter_New(pipes[i][1], 4096/* backlog limit */, nullptr/* label */);
+			members[i] = writers[i]; // any unique pointer is a valid member
+			Console_TestAssertUpdate(result, kBroadcastGroup_ResultOK == BroadcastGroup_AddMember(7, members[i], writers[i]),
+										Console_WriteValue, "failed to add member", i);
+		}
+		
+		// the stalled member is never read, so its backlog stays full; but a
+		// filter can keep it in the group, and the sender is never removed
+		UNUSED_RETURN(AsyncWriter_Result)AsyncWriter_Enqueue(writers[kStalledMember], kBacklog);
+		activeMembers = BroadcastGroup_ReturnActiveMembers(7, members[0], [](BroadcastGroup_Member) { return false; }, &removedMembers);
+		Console_TestAssertUpdate(result, kMemberCount == activeMembers.size(), Console_WriteValue, "active members with filter",
+									activeMembers.size());
+		activeMembers = BroadcastGroup_ReturnActiveMembers(7, members[kStalledMember], nullptr, &removedMembers);
+		Console_TestAssertUpdate(result, kMemberCount == activeMembers.size(), Console_WriteValue, "active members from stalled sender",
+									activeMembers.size());
+		Console_TestAssertUpdate(result, removedMembers.empty(), Console_WriteValue, "removed members", removedMembers.size());
+		
+		// otherwise, the stalled member is removed before any input is sent
+		activeMembers = BroadcastGroup_ReturnActiveMembers(7, members[0], nullptr, &removedMembers);
+		Console_TestAssertUpdate(result, (kMemberCount - 1) == activeMembers.size(), Console_WriteValue, "active members",
+									activeMembers.size());
+		Console_TestAssertUpdate(result, (1 == removedMembers.size()) && (members[kStalledMember] == removedMembers.front()),
+									Console_WriteValue, "removed members", removedMembers.size());
+		Console_TestAssertUpdate(result, 0 == BroadcastGroup_ReturnGroupNumber(members[kStalledMember]),
+									Console_WriteLine, "stalled member should not be in a group");
+		
+		// the same buffer is given to every remaining member; the readers
+		// only start afterwards, to show that sending does not wait for them
+		for (auto member : activeMembers)
+		{
+			Console_TestAssertUpdate(result, kAsyncWriter_ResultOK == AsyncWriter_Enqueue(STATIC_CAST(member, AsyncWriter_Ref), kInput),
+										Console_WriteLine, "failed to enqueue input");
+		}
+		for (size_t i = 0; i < kMemberCount; ++i)
+		{
+			if (kStalledMember != i)
+			{
+				readers[i] = std::thread(readTestData, pipes[i][0], kInput->size(), &output[i]);
+			}
+		}
+		for (size_t i = 0; i < kMemberCount; ++i)
+		{
+			if (kStalledMember != i)
+			{
+				AsyncWriter_WaitUntilWritten(writers[i]);
+				readers[i].join();
+				Console_TestAssertUpdate(result, std::string(kInput->begin(), kInput->end()) == output[i],
+											Console_WriteValue, "output size", output[i].size());
+			}
+			BroadcastGroup_RemoveMember(members[i]);
+			AsyncWriter_Dispose(&writers[i]);
+		}
+		Console_TestAssertUpdate(result, 0 == BroadcastGroup_ReturnMemberCount(7), Console_WriteValue, "group count",
+									BroadcastGroup_ReturnMemberCount(7));
+	}
+	
+	for (size_t i = 0; i < kMemberCount; ++i)
+	{
+		UNUSED_RETURN(int)close(pipes[i][0]);
+		UNUSED_RETURN(int)close(pipes[i][1]);
+	}
+	
+	return result;
+}// unitTest001_Begin
+
+} // anonymous namespace
+
+// BELOW IS REQUIRED NEWLINE TO END FILE
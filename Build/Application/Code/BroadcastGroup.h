@@ -0,0 +1,132 @@
+/*!	\file BroadcastGroup.h
+	\brief Keeps track of the members of numbered groups that
+	receive the same input (for instance, sessions that are
+	broadcasting typed keys to each other).
+	
+	Each member has its own background writer (see
+	AsyncWriter.h), so that a member whose reader has stopped
+	cannot delay the others.  When the members of a group are
+	requested for new input, any member whose writer has fallen
+	too far behind is removed from the group first; otherwise,
+	it would use an unlimited amount of memory, and it would
+	eventually receive only part of what was sent afterwards.
+	
+	A member belongs to at most one group at a time.  Groups
+	are only changed and examined from the main thread.
+*/
+/*###############################################################
+
+	MacTerm
+		© 1998-2021 by Kevin Grant.
+		© 2001-2003 by Ian Anderson.
+		© 1986-1994 University of Illinois Board of Trustees
+		(see About box for full list of U of I contributors).
+	
+	This program is free software; you can redistribute it or
+	modify it under the terms of the GNU General Public License
+	as published by the Free Software Foundation; either version
+	2 of the License, or (at your option) any later version.
+	
+	This program is distributed in the hope that it will be
+	useful, but WITHOUT ANY WARRANTY; without even the implied
+	warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+	PURPOSE.  See the GNU General Public License for more
+	details.
+	
+	You should have received a copy of the GNU General Public
+	License along with this program; if not, write to:
+	
+		Free Software Foundation, Inc.
+		59 Temple Place, Suite 330
+		Boston, MA  02111-1307
+		USA
+
+###############################################################*/
+
+#include <UniversalDefines.h>
+
+#pragma once
+
+// standard-C++ includes
+#include <functional>
+#include <vector>
+
+// library includes
+#include <AsyncWriter.h>
+
+// Mac includes
+#include <CoreServices/CoreServices.h>
+
+
+
+#pragma mark Constants
+
+/*!
+Possible return values from Broadcast Group module routines.
+*/
+typedef long BroadcastGroup_Result;
+enum
+{
+	kBroadcastGroup_ResultOK				= 0,	//!< no error
+	kBroadcastGroup_ResultParameterError	= 1		//!< invalid input (e.g. group number 0 or a null writer)
+};
+
+#pragma mark Types
+
+/*!
+Identifies a member of a group; any unique, non-null pointer
+may be used (for instance, a SessionRef).
+*/
+typedef void*	BroadcastGroup_Member;
+
+/*!
+Returns "true" only if the given member may be removed from
+its group because its writer has fallen behind.
+*/
+typedef std::function< Boolean (BroadcastGroup_Member) >	BroadcastGroup_RemovalFilter;
+
+
+
+#pragma mark Public Methods
+
+//!\name Module Tests
+//@{
+
+void
+	BroadcastGroup_RunTests				();
+
+//@}
+
+//!\name Changing Membership
+//@{
+
+// A MEMBER LEAVES ANY OTHER GROUP FIRST; THE WRITER IS NOT DISPOSED, AND MUST EXIST UNTIL THE MEMBER IS REMOVED
+BroadcastGroup_Result
+	BroadcastGroup_AddMember			(UInt32							inGroupNumber,
+										 BroadcastGroup_Member			inMember,
+										 AsyncWriter_Ref				inWriter);
+
+void
+	BroadcastGroup_RemoveMember			(BroadcastGroup_Member			inMember);
+
+//@}
+
+//!\name Finding Members
+//@{
+
+// MEMBERS OTHER THAN THE SENDER THAT HAVE FALLEN BEHIND ARE REMOVED FIRST (AND OPTIONALLY RETURNED SEPARATELY)
+std::vector< BroadcastGroup_Member >
+	BroadcastGroup_ReturnActiveMembers	(UInt32							inGroupNumber,
+										 BroadcastGroup_Member			inSender,
+										 BroadcastGroup_RemovalFilter	inMayRemoveOrNull = nullptr,
+										 std::vector< BroadcastGroup_Member >*	outRemovedMembersOrNull = nullptr);
+
+UInt32
+	BroadcastGroup_ReturnGroupNumber	(BroadcastGroup_Member			inMember);
+
+size_t
+	BroadcastGroup_ReturnMemberCount	(UInt32							inGroupNumber);
+
+//@}
+
+// BELOW IS REQUIRED NEWLINE TO END FILE
@@ -105,15 +105,27 @@ Boolean
 											 NSPasteboard*				inPasteboardOrNullForMainClipboard = nullptr,
 											 Boolean					inClearFirst = true);
 
+// ALSO REMOVES THE PROMISE FROM THE PASTEBOARD, IF THE PASTEBOARD HAS NOT CHANGED SINCE
+Boolean
+	Clipboard_CancelPromisedText			(TerminalViewRef			inView);
+
 Boolean
 	Clipboard_CreateCFStringArrayFromPasteboard		(CFArrayRef&		outCFStringCFArray,
 											 NSPasteboard*				inPasteboardOrNull = nullptr);
 
+Boolean
+	Clipboard_CreateCFStringFromPasteboard	(CFStringRef&				outCFString,
+											 NSPasteboard*				inPasteboardOrNull = nullptr);
+
 Boolean
 	Clipboard_CreateCGImageFromPasteboard	(CGImageRef&				outImage,
 											 CFStringRef&				outUTI,
 											 NSPasteboard*				inPasteboardOrNull = nullptr);
 
+// TRUE IF A LARGE SELECTION OF THE VIEW WAS COPIED AND IS STILL BEING WRITTEN FOR THE PASTEBOARD
+Boolean
+	Clipboard_PromisedTextIsInProgress		(TerminalViewRef			inView);
+
 void
 	Clipboard_TextToScrap					(TerminalViewRef			inView,
 											 Clipboard_CopyMethod		inHowToCopy,
@@ -70,12 +70,21 @@
 #import <MacTermQuills/MacTermQuills-Swift.h>
 
 
+#pragma mark Constants
+namespace {
+
+TerminalView_RowIndex const		kMy_LargeSelectionRowCount = 10000;		//!< text selections with more rows are promised, not copied right away
+
+} // anonymous namespace
+
 #pragma mark Internal Method Prototypes
 namespace {
 
 CFStringRef		copyTypeDescription			(CFStringRef);
 Boolean			isImageType					(CFStringRef);
 Boolean			isTextType					(CFStringRef);
+Boolean			promiseSelectedText			(TerminalViewRef, UInt16, TerminalView_TextFlags, NSPasteboard*);
+NSArray*		returnPasteboardStrings		(NSPasteboard*);
 void			updateClipboard				();
 
 } // anonymous namespace
@@ -120,10 +129,66 @@ changes to an interface declared in a ".mm" file.
 
 @end //}
 
+
+/*!
+Provides text for the pasteboard from a file that a terminal
+view is writing in the background (see promiseSelectedText()).
+The text is only read when an application asks for it; if the
+file is not finished by then, the rest is written right away.
+The file is removed once the pasteboard no longer needs it.
+*/
+@interface Clipboard_TextFileProvider : NSObject < NSPasteboardItemDataProvider > //{
+
+// initializers
+	- (instancetype)
+	initWithFileURL:(NSURL*)_
+	terminalView:(TerminalViewRef)_ NS_DESIGNATED_INITIALIZER;
+
+// new methods
+	- (void)
+	hideProgress;
+	- (BOOL)
+	isPromisedToPasteboard:(NSPasteboard*)_;
+	- (void)
+	showProgressInWindow:(NSWindow*)_;
+
+// accessors
+	//! The progress of the export; used to finish or cancel it.
+	@property (strong) NSProgress*
+	exportProgress;
+	//! True once the completion block of the export has run
+	//! (after which the terminal view may no longer exist).
+	@property (assign) BOOL
+	exportEnded;
+	//! The file that is being written.
+	@property (strong, readonly) NSURL*
+	fileURL;
+	//! If defined, shows the progress of the export in the
+	//! title bar of the window of the view.
+	@property (strong) NSTitlebarAccessoryViewController*
+	progressAccessory;
+	//! The change count of "promisedPasteboard" right after
+	//! the text was promised to it.
+	@property (assign) NSInteger
+	promisedChangeCount;
+	//! The pasteboard that the text was promised to.
+	@property (weak) NSPasteboard*
+	promisedPasteboard;
+	//! The view whose selected text is being written.
+	@property (assign, readonly) TerminalViewRef
+	terminalView;
+	//! True if the whole text was written to the file.
+	@property (assign) BOOL
+	textWritten;
+
+@end //}
+
 #pragma mark Variables
 namespace {
 
-NSTimer*	gClipboardUpdatesTimer = nil;
+NSInteger						gClipboardChangeCount = -1;		//!< change count of the general pasteboard when the Clipboard window was last updated
+NSTimer*						gClipboardUpdatesTimer = nil;
+Clipboard_TextFileProvider*		gTextFileProvider = nil;		//!< most recent promise of a large selection (pasteboards may not retain it)
 
 } // anonymous namespace
 
@@ -271,6 +336,43 @@ Clipboard_AddNSImageToPasteboard	(NSImage*			inImageToCopy,
 }// AddNSImageToPasteboard
 
 
+/*!
+Cancels the export of a large selection of the given view that
+was copied (see Clipboard_TextToScrap()) and is still being
+written.  If the pasteboard still has the promise of that text
+(nothing else was copied since), the pasteboard is cleared, so
+that nothing can be pasted from a file that will not exist.
+
+Returns true only if a copy was in progress for the view.
+
+(2021.06)
+*/
+Boolean
+Clipboard_CancelPromisedText	(TerminalViewRef	inView)
+{
+	Boolean		result = false;
+	
+	
+	if (Clipboard_PromisedTextIsInProgress(inView))
+	{
+		Clipboard_TextFileProvider*		provider = gTextFileProvider;
+		NSPasteboard*					promisedPasteboard = provider.promisedPasteboard;
+		
+		
+		// the view ends the export (and removes the file) as soon
+		// as it notices that the export was cancelled
+		[provider.exportProgress cancel];
+		[provider hideProgress];
+		if ((nil != promisedPasteboard) && [provider isPromisedToPasteboard:promisedPasteboard])
+		{
+			[promisedPasteboard clearContents];
+		}
+		result = true;
+	}
+	return result;
+}// CancelPromisedText
+
+
 /*!
 Returns true only if the specified pasteboard contains text
 that was successfully converted.  This includes any data that
@@ -288,120 +390,28 @@ When successful (returning true), the "outCFStringCFArray"
 will be defined and you must call CFRelease() on it when
 finished. Otherwise, it will be set to nullptr.
 
+See also Clipboard_CreateCFStringFromPasteboard(), which is
+better for text that may be very large.
+
 (2018.08)
 */
 Boolean
 Clipboard_CreateCFStringArrayFromPasteboard		(CFArrayRef&		outCFStringCFArray,
 												 NSPasteboard*		inPasteboardOrNull)
 {
-	NSPasteboard*		kPasteboard = (nullptr == inPasteboardOrNull)
-										? [NSPasteboard generalPasteboard]
-										: inPasteboardOrNull;
-	NSArray*			objectArray = nil;
 	NSMutableArray*		newStringArray = [[NSMutableArray alloc] init];
-	NSDictionary*		fileReadingOptions = @{ NSPasteboardURLReadingFileURLsOnlyKey: @(YES) };
 	Boolean				result = false;
 	
 	
 	outCFStringCFArray = nullptr; // initially...
 	
-	// first look for file objects
-	objectArray = [kPasteboard readObjectsForClasses:@[NSURL.class] options:fileReadingOptions];
-	if ((nil != objectArray) && (objectArray.count > 0))
+	for (NSString* aString in returnPasteboardStrings(inPasteboardOrNull))
 	{
-		// read URLs; in this case, copy all of them in a row
-		// (separated by new lines)
-		for (id anObject in objectArray)
-		{
-			if ([anObject isKindOfClass:NSURL.class])
-			{
-				NSURL*		asURL = STATIC_CAST(anObject, NSURL*);
-				NSString*	stringValue = [asURL absoluteURL].path;
-				
-				
-				if (nil != stringValue)
-				{
-					[newStringArray addObject:stringValue];
-				}
-				else
-				{
-					Console_Warning(Console_WriteLine, "unable to resolve NSURL object on pasteboard");
-				}
-			}
-			else
-			{
-				// ???
-				Console_Warning(Console_WriteLine, "non-NSURL object in pasteboard");
-			}
-		}
-	}
-	else
-	{
-		// read other types of items
-		NSDictionary*	readingOptions = @{};
+		CFRetainRelease		lineArray(StringUtilities_CFNewStringsWithLines(BRIDGE_CAST(aString, CFStringRef)),
+										CFRetainRelease::kAlreadyRetained);
 		
 		
-		objectArray = [kPasteboard readObjectsForClasses:@[NSPasteboardItem.class] options:readingOptions];
-		if ((nil == objectArray) || (0 == objectArray.count))
-		{
-			// not text content
-			//Console_Warning(Console_WriteLine, "failed to read any text from pasteboard");
-		}
-		else
-		{
-			for (id anObject in objectArray)
-			{
-				if ([anObject isKindOfClass:NSPasteboardItem.class])
-				{
-					// read text
-					NSPasteboardItem*	asPasteboardItem = STATIC_CAST(anObject, NSPasteboardItem*);
-					NSArray*			textUTIs = @[
-														// in order of preference, and most specific first (otherwise the
-														// more generic types will match)
-														BRIDGE_CAST(kUTTypeUTF16ExternalPlainText, NSString*),
-														BRIDGE_CAST(kUTTypeUTF16PlainText, NSString*),
-														BRIDGE_CAST(kUTTypeUTF8PlainText, NSString*),
-														BRIDGE_CAST(kUTTypePlainText, NSString*),
-														@"com.apple.traditional-mac-plain-text",
-													];
-					
-					
-					for (NSString* aUTI in textUTIs)
-					{
-						NSString*	stringValue = [asPasteboardItem stringForType:aUTI];
-						
-						
-						if (nil != stringValue)
-						{
-							CFRetainRelease		lineArray(StringUtilities_CFNewStringsWithLines(BRIDGE_CAST(stringValue, CFStringRef)),
-															CFRetainRelease::kAlreadyRetained);
-							
-							
-							for (id stringObject in BRIDGE_CAST(lineArray.returnCFArrayRef(), NSArray*))
-							{
-								if (NO == [stringObject isKindOfClass:NSString.class])
-								{
-									Console_Warning(Console_WriteLine, "assertion failure; received non-string object in array that expected strings");
-								}
-								else
-								{
-									NSString*	asString = STATIC_CAST(stringObject, NSString*);
-									
-									
-									[newStringArray addObject:asString];
-								}
-							}
-							break;
-						}
-					}
-				}
-				else
-				{
-					// ???
-					Console_Warning(Console_WriteLine, "non-NSPasteboardItem object in pasteboard");
-				}
-			}
-		}
+		[newStringArray addObjectsFromArray:BRIDGE_CAST(lineArray.returnCFArrayRef(), NSArray*)];
 	}
 	
 	if (newStringArray.count > 0)
@@ -415,6 +425,48 @@ Clipboard_CreateCFStringArrayFromPasteboard		(CFArrayRef&		outCFStringCFArray,
 }// CreateCFStringArrayFromPasteboard
 
 
+/*!
+Like Clipboard_CreateCFStringArrayFromPasteboard(), except
+that the text is returned as a single string, with any new-lines
+left in place and with multiple items separated by new-lines.
+When there is just one item, its string is returned as-is,
+without copying; so this is appropriate for very large text.
+
+When successful (returning true), the "outCFString" will be
+defined and you must call CFRelease() on it when finished.
+Otherwise, it will be set to nullptr.
+
+(2021.06)
+*/
+Boolean
+Clipboard_CreateCFStringFromPasteboard	(CFStringRef&		outCFString,
+										 NSPasteboard*		inPasteboardOrNull)
+{
+	NSArray*	stringArray = returnPasteboardStrings(inPasteboardOrNull);
+	Boolean		result = false;
+	
+	
+	outCFString = nullptr; // initially...
+	
+	if (1 == stringArray.count)
+	{
+		outCFString = BRIDGE_CAST(STATIC_CAST(stringArray.firstObject, NSString*), CFStringRef);
+	}
+	else if (stringArray.count > 1)
+	{
+		outCFString = BRIDGE_CAST([stringArray componentsJoinedByString:@"\n"], CFStringRef);
+	}
+	
+	if (nullptr != outCFString)
+	{
+		CFRetain(outCFString);
+		result = true;
+	}
+	
+	return result;
+}// CreateCFStringFromPasteboard
+
+
 /*!
 Returns true only if some item on the specified pasteboard
 is an image.
@@ -468,6 +520,25 @@ Clipboard_CreateCGImageFromPasteboard	(CGImageRef&		outImage,
 }// CreateCGImageFromPasteboard
 
 
+/*!
+Returns true only if a large selection of the given view was
+copied (see Clipboard_TextToScrap()) and is still being written
+in the background; the progress is displayed in the title bar
+of the window, and Clipboard_CancelPromisedText() stops it.
+
+(2021.06)
+*/
+Boolean
+Clipboard_PromisedTextIsInProgress	(TerminalViewRef	inView)
+{
+	Boolean		result = ((nil != gTextFileProvider) && (inView == gTextFileProvider.terminalView) &&
+							(NO == gTextFileProvider.exportEnded) && (NO == gTextFileProvider.exportProgress.cancelled));
+	
+	
+	return result;
+}// PromisedTextIsInProgress
+
+
 /*!
 Shows or hides the clipboard.
 
@@ -502,6 +573,11 @@ is copied.  If “inline” is specified (possibly in
 addition to table mode), each line is concatenated
 together to form a single line.
 
+If a very large selection is copied to the general
+pasteboard, the text is only promised: it is written
+to a temporary file in the background, and the file
+is read if something is pasted.
+
 (3.0)
 */
 void
@@ -532,9 +608,24 @@ Clipboard_TextToScrap	(TerminalViewRef		inView,
 	// get the highlighted characters; assume that text should be inlined unless selected in rectangular mode
 	{
 		TerminalView_TextFlags	flags = (inHowToCopy & kClipboard_CopyMethodInline) ? kTerminalView_TextFlagInline : 0;
+		TerminalView_CellRange	selectionRange;
+		Boolean					isPromised = false;
+		
 		
+		// a huge selection would take a long time to copy into one string
+		// (and would use a lot of memory); instead, it is written to a file
+		// in the background, and only read if something is pasted
+		TerminalView_GetSelectedTextAsVirtualRange(inView, selectionRange);
+		if (((selectionRange.second.second - selectionRange.first.second) > kMy_LargeSelectionRowCount) &&
+			([NSPasteboard generalPasteboard] == inDataTargetOrNull))
+		{
+			isPromised = promiseSelectedText(inView, tableThreshold, flags, inDataTargetOrNull);
+		}
 		
-		textToCopy = TerminalView_ReturnSelectedTextCopyAsUnicode(inView, tableThreshold, flags);
+		unless (isPromised)
+		{
+			textToCopy = TerminalView_ReturnSelectedTextCopyAsUnicode(inView, tableThreshold, flags);
+		}
 	}
 	
 	if (nullptr != textToCopy)
@@ -653,6 +744,184 @@ isTextType	(CFStringRef	inUTI)
 }// isTextType
 
 
+/*!
+Promises the selected text of the given view to a pasteboard:
+the text is written to a temporary file in the background, and
+the pasteboard is given a provider that reads the file when the
+text is needed.  Any earlier promise is cancelled.  Until the
+file is written, the progress is shown in the title bar of the
+window of the view.
+
+Returns true only if the text was promised; otherwise, the
+pasteboard is not changed (although an earlier promise may
+have been cancelled, since it was about to be replaced).
+
+(2021.06)
+*/
+Boolean
+promiseSelectedText		(TerminalViewRef			inView,
+						 UInt16						inMaxSpacesToReplaceWithTabOrZero,
+						 TerminalView_TextFlags		inFlags,
+						 NSPasteboard*				inTarget)
+{
+	Boolean							result = false;
+	NSString*						fileName = [NSString stringWithFormat:@"net.macterm.copy.%@.txt", [[NSUUID UUID] UUIDString]];
+	NSURL*							fileURL = [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:fileName]];
+	Clipboard_TextFileProvider*		provider = [[Clipboard_TextFileProvider alloc] initWithFileURL:fileURL terminalView:inView];
+	NSProgress*						exportProgress = nil;
+	
+	
+	// the earlier promise is about to be replaced, so there is no
+	// reason to keep writing its text (other exports of the view,
+	// such as a save, are not affected)
+	if (nil != gTextFileProvider)
+	{
+		[gTextFileProvider.exportProgress cancel];
+	}
+	
+	exportProgress = TerminalView_StartSelectedTextExport(inView, BRIDGE_CAST(fileURL, CFURLRef), inMaxSpacesToReplaceWithTabOrZero,
+															inFlags,
+															^(Boolean inIsWritten)
+															{
+																provider.exportEnded = YES;
+																provider.textWritten = inIsWritten;
+																[provider hideProgress];
+															});
+	if (nil != exportProgress)
+	{
+		NSPasteboardItem*	pasteboardItem = [[NSPasteboardItem alloc] init];
+		
+		
+		provider.exportProgress = exportProgress;
+		if ([pasteboardItem setDataProvider:provider forTypes:@[NSPasteboardTypeString]])
+		{
+			[inTarget clearContents];
+			result = (YES == [inTarget writeObjects:@[pasteboardItem]]);
+		}
+		
+		if (result)
+		{
+			provider.promisedPasteboard = inTarget;
+			provider.promisedChangeCount = inTarget.changeCount;
+			[provider showProgressInWindow:TerminalView_ReturnNSWindow(inView)];
+			gTextFileProvider = provider;
+		}
+		else
+		{
+			Console_Warning(Console_WriteLine, "failed to promise selected text to pasteboard");
+			[exportProgress cancel];
+		}
+	}
+	
+	return result;
+}// promiseSelectedText
+
+
+/*!
+Returns the text of every item on the specified pasteboard
+(or the main pasteboard, if nullptr), as one string per item
+in an array that may be empty.  Files and directories become
+paths.  Lines are not separated.
+
+(2021.06)
+*/
+NSArray*
+returnPasteboardStrings		(NSPasteboard*		inPasteboardOrNull)
+{
+	NSPasteboard*		kPasteboard = (nullptr == inPasteboardOrNull)
+										? [NSPasteboard generalPasteboard]
+										: inPasteboardOrNull;
+	NSArray*			objectArray = nil;
+	NSMutableArray*		result = [[NSMutableArray alloc] init];
+	NSDictionary*		fileReadingOptions = @{ NSPasteboardURLReadingFileURLsOnlyKey: @(YES) };
+	
+	
+	// first look for file objects
+	objectArray = [kPasteboard readObjectsForClasses:@[NSURL.class] options:fileReadingOptions];
+	if ((nil != objectArray) && (objectArray.count > 0))
+	{
+		// read URLs; in this case, copy all of them in a row
+		// (separated by new lines)
+		for (id anObject in objectArray)
+		{
+			if ([anObject isKindOfClass:NSURL.class])
+			{
+				NSURL*		asURL = STATIC_CAST(anObject, NSURL*);
+				NSString*	stringValue = [asURL absoluteURL].path;
+				
+				
+				if (nil != stringValue)
+				{
+					[result addObject:stringValue];
+				}
+				else
+				{
+					Console_Warning(Console_WriteLine, "unable to resolve NSURL object on pasteboard");
+				}
+			}
+			else
+			{
+				// ???
+				Console_Warning(Console_WriteLine, "non-NSURL object in pasteboard");
+			}
+		}
+	}
+	else
+	{
+		// read other types of items
+		NSDictionary*	readingOptions = @{};
+		
+		
+		objectArray = [kPasteboard readObjectsForClasses:@[NSPasteboardItem.class] options:readingOptions];
+		if ((nil == objectArray) || (0 == objectArray.count))
+		{
+			// not text content
+			//Console_Warning(Console_WriteLine, "failed to read any text from pasteboard");
+		}
+		else
+		{
+			for (id anObject in objectArray)
+			{
+				if ([anObject isKindOfClass:NSPasteboardItem.class])
+				{
+					// read text
+					NSPasteboardItem*	asPasteboardItem = STATIC_CAST(anObject, NSPasteboardItem*);
+					NSArray*			textUTIs = @[
+														// in order of preference, and most specific first (otherwise the
+														// more generic types will match)
+														BRIDGE_CAST(kUTTypeUTF16ExternalPlainText, NSString*),
+														BRIDGE_CAST(kUTTypeUTF16PlainText, NSString*),
+														BRIDGE_CAST(kUTTypeUTF8PlainText, NSString*),
+														BRIDGE_CAST(kUTTypePlainText, NSString*),
+														@"com.apple.traditional-mac-plain-text",
+													];
+					
+					
+					for (NSString* aUTI in textUTIs)
+					{
+						NSString*	stringValue = [asPasteboardItem stringForType:aUTI];
+						
+						
+						if (nil != stringValue)
+						{
+							[result addObject:stringValue];
+							break;
+						}
+					}
+				}
+				else
+				{
+					// ???
+					Console_Warning(Console_WriteLine, "non-NSPasteboardItem object in pasteboard");
+				}
+			}
+		}
+	}
+	
+	return result;
+}// returnPasteboardStrings
+
+
 /*!
 Updates internal state so that other API calls from this
 module actually work with the given pasteboard!
@@ -663,6 +932,12 @@ pasteboard and arranges to update the Clipboard window
 accordingly.  The Clipboard window is only capable of
 rendering one pasteboard at a time.
 
+Data is only read again if the change count of the pasteboard
+is different since the last update.  Text that this module
+promised (see promiseSelectedText()) is never read, since that
+would block until the whole selection is written; instead, the
+window describes the text and how much of it is written.
+
 IMPORTANT:	This API should be called whenever the
 			pasteboard is changed.
 
@@ -674,13 +949,59 @@ updateClipboard ()
 	Clipboard_WindowController*		controller = (Clipboard_WindowController*)
 													[Clipboard_WindowController sharedClipboardWindowController];
 	NSPasteboard*					generalPasteboard = [NSPasteboard generalPasteboard];
+	NSInteger const					kChangeCount = generalPasteboard.changeCount;
 	CGImageRef						imageToRender = nullptr;
 	CFArrayRef						stringsToRender = nullptr;
 	CFStringRef						typeIdentifier = nullptr;
 	CFStringRef						typeCFString = nullptr;
 	
 	
-	if (Clipboard_CreateCGImageFromPasteboard(imageToRender, typeIdentifier, generalPasteboard))
+	if ((nil != gTextFileProvider) && [gTextFileProvider isPromisedToPasteboard:generalPasteboard])
+	{
+		// promised text; asking for it would finish the export
+		// right away, so it is only described
+		Clipboard_TextFileProvider*		provider = gTextFileProvider;
+		
+		
+		typeCFString = copyTypeDescription(kUTTypeText);
+		controller.viewModel.clipboardText = @"";
+		controller.viewModel.clipboardImage = nil;
+		controller.viewModel.clipboardUnknown = NO;
+		controller.viewModel.kindValue = BRIDGE_CAST(typeCFString, NSString*);
+		if ((provider.exportEnded) && (provider.textWritten))
+		{
+			NSDictionary*	fileAttributes = [[NSFileManager defaultManager] attributesOfItemAtPath:provider.fileURL.path error:nil];
+			
+			
+			[controller setDataSize:STATIC_CAST([fileAttributes fileSize], size_t)];
+			[controller setLabel1:nil andValue:nil];
+		}
+		else
+		{
+			CFRetainRelease		unknownCFString(UIStrings_ReturnCopy(kUIStrings_ClipboardWindowValueUnknown),
+												CFRetainRelease::kAlreadyRetained);
+			CFRetainRelease		labelCFString(UIStrings_ReturnCopy(kUIStrings_ClipboardWindowLabelProgress),
+												CFRetainRelease::kAlreadyRetained);
+			CFRetainRelease		templateCFString(UIStrings_ReturnCopy(kUIStrings_ClipboardWindowRowProgressTemplate),
+													CFRetainRelease::kAlreadyRetained);
+			CFRetainRelease		progressCFString(CFStringCreateWithFormat(kCFAllocatorDefault, nullptr/* format options */,
+																			templateCFString.returnCFStringRef(),
+																			STATIC_CAST(provider.exportProgress.completedUnitCount, long long),
+																			STATIC_CAST(provider.exportProgress.totalUnitCount, long long)),
+													CFRetainRelease::kAlreadyRetained);
+			
+			
+			[controller setSizeField:BRIDGE_CAST(unknownCFString.returnCFStringRef(), NSString*)];
+			[controller setLabel1:BRIDGE_CAST(labelCFString.returnCFStringRef(), NSString*)
+									andValue:BRIDGE_CAST(progressCFString.returnCFStringRef(), NSString*)];
+		}
+		[controller setLabel2:nil andValue:nil];
+	}
+	else if (kChangeCount == gClipboardChangeCount)
+	{
+		// the window already shows the current data
+	}
+	else if (Clipboard_CreateCGImageFromPasteboard(imageToRender, typeIdentifier, generalPasteboard))
 	{
 		// image
 		typeCFString = copyTypeDescription(typeIdentifier);
@@ -737,11 +1058,212 @@ updateClipboard ()
 	{
 		CFRelease(typeCFString), typeCFString = nullptr;
 	}
+	gClipboardChangeCount = kChangeCount;
 }// updateClipboard
 
 } // anonymous namespace
 
 
+#pragma mark -
+@implementation Clipboard_TextFileProvider
+
+
+@synthesize fileURL = _fileURL;
+@synthesize terminalView = _terminalView;
+
+
+/*!
+Designated initializer.
+
+(2021.06)
+*/
+- (instancetype)
+initWithFileURL:(NSURL*)		aFileURL
+terminalView:(TerminalViewRef)	aView
+{
+	self = [super init];
+	if (nil != self)
+	{
+		_fileURL = aFileURL;
+		_terminalView = aView;
+		_exportProgress = nil;
+		_exportEnded = NO;
+		_progressAccessory = nil;
+		_promisedChangeCount = -1;
+		_promisedPasteboard = nil;
+		_textWritten = NO;
+	}
+	return self;
+}// initWithFileURL:terminalView:
+
+
+#pragma mark Initializers Disabled From Superclass
+
+
+/*!
+This is not a valid way to initialize this class.
+
+(2021.06)
+*/
+- (instancetype)
+init
+{
+	assert(false && "invalid way to initialize derived class");
+	return [self initWithFileURL:nil terminalView:nullptr];
+}// init
+
+
+#pragma mark New Methods
+
+
+/*!
+Removes the progress of the export from the title bar of
+the window (if it is shown).
+
+(2021.06)
+*/
+- (void)
+hideProgress
+{
+	if (nil != self.progressAccessory)
+	{
+		[self.progressAccessory.view unbind:NSValueBinding];
+		[self.progressAccessory removeFromParentViewController];
+		self.progressAccessory = nil;
+	}
+}// hideProgress
+
+
+/*!
+Returns YES only if the given pasteboard still has the text
+that this provider promised to it (that is, nothing else was
+put on the pasteboard since).
+
+(2021.06)
+*/
+- (BOOL)
+isPromisedToPasteboard:(NSPasteboard*)	aPasteboard
+{
+	BOOL	result = ((nil != aPasteboard) && (aPasteboard == self.promisedPasteboard) &&
+						(aPasteboard.changeCount == self.promisedChangeCount));
+	
+	
+	return result;
+}// isPromisedToPasteboard:
+
+
+/*!
+Shows the progress of the export in the title bar of the
+given window, in the same way as the progress of a Paste;
+the Edit menu has a command to cancel it.  The progress is
+removed by "hideProgress".
+
+(2021.06)
+*/
+- (void)
+showProgressInWindow:(NSWindow*)	aWindow
+{
+	if ((nil != aWindow) && (nil == self.progressAccessory) && (nil != self.exportProgress))
+	{
+		NSProgressIndicator*	progressBar = [[NSProgressIndicator alloc] initWithFrame:NSMakeRect(0, 0, 120, 16)];
+		
+		
+		progressBar.style = NSProgressIndicatorStyleBar;
+		progressBar.controlSize = NSControlSizeSmall;
+		progressBar.indeterminate = NO;
+		progressBar.minValue = 0;
+		progressBar.maxValue = 1;
+		
+		// the export updates its progress on the main queue, so
+		// the indicator can simply follow it
+		[progressBar bind:NSValueBinding toObject:self.exportProgress withKeyPath:@"fractionCompleted" options:nil];
+		
+		self.progressAccessory = [[NSTitlebarAccessoryViewController alloc] init];
+		self.progressAccessory.view = progressBar;
+		self.progressAccessory.layoutAttribute = NSLayoutAttributeRight;
+		[aWindow addTitlebarAccessoryViewController:self.progressAccessory];
+	}
+}// showProgressInWindow:
+
+
+#pragma mark NSPasteboardItemDataProvider
+
+
+/*!
+Gives the pasteboard the text from the file, finishing the
+file first if the view is still writing it.  The file is
+mapped into memory (if possible) instead of being read.
+
+(2021.06)
+*/
+- (void)
+pasteboard:(NSPasteboard*)			aPasteboard
+item:(NSPasteboardItem*)			anItem
+provideDataForType:(NSString*)		aType
+{
+#pragma unused(aPasteboard)
+	unless (self.exportEnded)
+	{
+		// since the export has not ended, the view still exists
+		UNUSED_RETURN(Boolean)TerminalView_FinishSelectedTextExport(self.terminalView, self.exportProgress);
+	}
+	
+	if (self.textWritten)
+	{
+		NSError*	error = nil;
+		NSData*		fileData = [NSData dataWithContentsOfURL:self.fileURL options:NSDataReadingMappedIfSafe error:&error];
+		
+		
+		if (nil == fileData)
+		{
+			Console_Warning(Console_WriteValueCFString, "failed to read copied text from file, error",
+							BRIDGE_CAST([error localizedDescription], CFStringRef));
+		}
+		else
+		{
+			UNUSED_RETURN(BOOL)[anItem setData:fileData forType:aType];
+		}
+	}
+	else
+	{
+		Console_Warning(Console_WriteLine, "copied text is not available because it was not completely written");
+	}
+}// pasteboard:item:provideDataForType:
+
+
+/*!
+Stops the export (if it has not ended) and removes the file,
+since the pasteboard no longer needs the text.
+
+(2021.06)
+*/
+- (void)
+pasteboardFinishedWithDataProvider:(NSPasteboard*)	aPasteboard
+{
+#pragma unused(aPasteboard)
+	if (self.exportEnded)
+	{
+		if (self.textWritten)
+		{
+			UNUSED_RETURN(BOOL)[[NSFileManager defaultManager] removeItemAtURL:self.fileURL error:nil];
+		}
+	}
+	else
+	{
+		// the view removes the file when it sees that the export was cancelled
+		[self.exportProgress cancel];
+	}
+	
+	if (self == gTextFileProvider)
+	{
+		gTextFileProvider = nil;
+	}
+}// pasteboardFinishedWithDataProvider:
+
+
+@end // Clipboard_TextFileProvider
+
+
 #pragma mark -
 @implementation Clipboard_WindowController
 
@@ -235,6 +235,8 @@ points in the responder chain, such as views or windows.)
 @optional
 
 // actions
+	- (IBAction)
+	performBroadcastInputToggle:(id _Nullable)_;
 	- (IBAction)
 	performInterruptProcess:(id _Nullable)_;
 	- (IBAction)
@@ -455,6 +457,10 @@ points in the responder chain, such as views or windows.)
 // actions
 	- (IBAction)
 	performCopyAndPaste:(id _Nullable)_;
+	- (IBAction)
+	performCopyCancel:(id _Nullable)_;
+	- (IBAction)
+	performPasteCancel:(id _Nullable)_;
 
 @end //}
 
@@ -789,6 +795,8 @@ Actions that create new terminal-based sessions.
 	- (IBAction)
 	performNewCustom:(id _Nullable)_;
 	- (IBAction)
+	performReattachDetachedSessions:(id _Nullable)_;
+	- (IBAction)
 	performRestoreWorkspaceDefault:(id _Nullable)_;
 	- (IBAction)
 	performRestoreWorkspaceByFavoriteName:(id _Nullable)_;
@@ -42,6 +42,7 @@
 #import <list>
 #import <sstream>
 #import <string>
+#import <vector>
 
 // Unix includes
 extern "C"
@@ -78,6 +79,7 @@ extern "C"
 #import "HelpSystem.h"
 #import "InfoWindow.h"
 #import "Keypads.h"
+#import "Local.h"
 #import "MacroManager.h"
 #import "PrefPanelTranslations.h"
 #import "PrefsWindow.h"
@@ -3664,6 +3666,37 @@ canPerformNewShell:(id <NSValidatedUserInterfaceItem>)		anItem
 }
 
 
+- (IBAction)
+performReattachDetachedSessions:(id)	sender
+{
+	if (NO == [self viaFirstResponderTryToPerformSelector:_cmd withObject:sender])
+	{
+		if (false == SessionFactory_NewSessionsFromDetachedProcesses())
+		{
+			// failed...
+			Sound_StandardAlert();
+		}
+	}
+}
+- (id)
+canPerformReattachDetachedSessions:(id <NSValidatedUserInterfaceItem>)	anItem
+{
+#pragma unused(anItem)
+	std::vector< Local_DetachedProcessID >	processIDs;
+	
+	
+	if (EventLoop_IsMainWindowFullScreen())
+	{
+		return @(NO);
+	}
+	if ((kLocal_ResultOK != Local_GetDetachedProcesses(processIDs)) || processIDs.empty())
+	{
+		return @(NO);
+	}
+	return @(YES);
+}
+
+
 - (IBAction)
 performRestoreWorkspaceDefault:(id)		sender
 {
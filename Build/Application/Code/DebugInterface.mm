@@ -38,6 +38,7 @@
 // library includes
 #import <Console.h>
 #import <SoundSystem.h>
+#import <TraceSpan.h>
 #import <XPCCallPythonClient.objc++.h>
 
 // application includes
@@ -233,6 +234,39 @@ dumpStateOfActiveTerminal
 }// dumpStateOfActiveTerminal
 
 
+/*!
+Asks the user where to save the trace spans recorded so far,
+and writes them in the JSON format that Chrome and Perfetto
+can display.  Recording is not interrupted.
+
+(2021.06)
+*/
+- (void)
+exportTraceSpans
+{
+	NSSavePanel*	savePanel = [NSSavePanel savePanel];
+	
+	
+	unless (TraceSpan_IsEnabled())
+	{
+		Console_WriteLine("trace span recording is off; the exported trace may be empty or out of date");
+	}
+	
+	savePanel.allowedFileTypes = @[@"json"];
+	savePanel.nameFieldStringValue = @"MacTerm Trace.json";
+	[savePanel beginWithCompletionHandler:^(NSModalResponse aReturnCode)
+	{
+		if (NSModalResponseOK == aReturnCode)
+		{
+			unless (TraceSpan_WriteChromeTraceFile(savePanel.URL.fileSystemRepresentation))
+			{
+				Sound_StandardAlert();
+			}
+		}
+	}];
+}// exportTraceSpans
+
+
 /*!
 Spawns a new instance of the subprocess that wraps calls to
 external Python callbacks.
@@ -317,6 +351,8 @@ updateSettingCache
 	gDebugInterface_LogsTeletypewriterState = gDebugData.logPseudoTerminalDeviceSettings;
 	gDebugInterface_LogsTerminalEcho = gDebugData.logTerminalEchoState;
 	gDebugInterface_LogsTerminalState = gDebugData.logTerminalState;
+	TraceSpan_SetEnabled(gDebugData.recordTraceSpans);
+	UNUSED_RETURN(Console_Severity)Console_SetMinimumSeverity((gDebugData.logWarningsOnly) ? kConsole_SeverityWarning : kConsole_SeverityDebug);
 }// updateSettingCache
 
 
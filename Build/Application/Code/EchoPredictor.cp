@@ -0,0 +1,856 @@
+/*!	\file EchoPredictor.cp
+	\brief Guesses how typed characters will be echoed, so
+	that they can be displayed before the remote host echoes
+	them.
+*/
+/*###############################################################
+
+	MacTerm
+		© 1998-2021 by Kevin Grant.
+		© 2001-2003 by Ian Anderson.
+		© 1986-1994 University of Illinois Board of Trustees
+		(see About box for full list of U of I contributors).
+	
+	This program is free software; you can redistribute it or
+	modify it under the terms of the GNU General Public License
+	as published by the Free Software Foundation; either version
+	2 of the License, or (at your option) any later version.
+	
+	This program is distributed in the hope that it will be
+	useful, but WITHOUT ANY WARRANTY; without even the implied
+	warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+	PURPOSE.  See the GNU General Public License for more
+	details.
+	
+	You should have received a copy of the GNU General Public
+	License along with this program; if not, write to:
+	
+		Free Software Foundation, Inc.
+		59 Temple Place, Suite 330
+		Boston, MA  02111-1307
+		USA
+
+###############################################################*/
+
+#include "EchoPredictor.h"
+#include <UniversalDefines.h>
+
+// standard-C++ includes
+#include <algorithm>
+#include <deque>
+#include <string>
+
+// library includes
+#include <Console.h>
+
+
+
+#pragma mark Constants
+namespace {
+
+UInt64 const	kMy_DisplayRoundTripNanoseconds = 30000000;		//!< slowest round trip at which predictions are not displayed (30 ms)
+UInt64 const	kMy_HideRoundTripNanoseconds = 20000000;		//!< once displayed, predictions stay displayed until the round trip is below this (20 ms)
+UInt64 const	kMy_MinimumTimeoutNanoseconds = 1000000000;		//!< an unconfirmed prediction is never discarded sooner than this (1 second)
+size_t const	kMy_MaximumPredictionCount = 256;				//!< no more characters are predicted until some are confirmed
+
+} // anonymous namespace
+
+#pragma mark Types
+namespace {
+
+/*!
+A character that is expected to be echoed in a particular
+cell of the prediction row.
+*/
+struct My_Prediction
+{
+	UInt64		sentTime;		//!< when the character was typed
+	UInt32		epoch;			//!< see "My_EchoPredictor::epoch"
+	UInt16		column;			//!< zero-based column where the echo should appear
+	UniChar		character;		//!< the character that should be echoed
+};
+
+/*!
+Internal representation of an EchoPredictor_Ref.
+
+Predictions are always consecutive cells of one row, in the
+order that they were typed.  Each one belongs to an epoch;
+input that cannot be predicted starts a new epoch, and the
+predictions of an epoch are only displayed once one of them
+has been confirmed (so that nothing is drawn for a program
+that does not echo, or after a key whose effect is unknown).
+*/
+struct My_EchoPredictor
+{
+	My_EchoPredictor	(EchoPredictor_Options);
+	
+	void
+	discardPredictions	();
+	
+	void
+	discardExpiredPredictions	(UInt64);
+	
+	Boolean
+	isDisplayed		(My_Prediction const&) const;
+	
+	UInt64
+	returnTimeout () const;
+	
+	void
+	updateRoundTrip		(UInt64);
+	
+	std::deque< My_Prediction >		predictions;			//!< unconfirmed characters, in the order typed
+	UInt64							roundTripNanoseconds;	//!< smoothed time from typing to echo; 0 if not known yet
+	UInt32							epoch;					//!< increases after any input that cannot be predicted
+	UInt32							confirmedEpoch;			//!< most recent epoch that had a prediction confirmed
+	UInt32							mispredictionCount;		//!< number of times displayed predictions had to be removed
+	UInt16							cursorColumn;			//!< most recent cursor location reported by the terminal
+	UInt16							cursorRow;				//!< most recent cursor location reported by the terminal
+	UInt16							columnCount;			//!< most recent width reported by the terminal
+	UInt16							predictionRow;			//!< row that every prediction is on
+	Boolean							isCursorKnown;			//!< false until the terminal has been reported once
+	Boolean							isAlternateScreen;		//!< if true, nothing is predicted
+	Boolean							isSlow;					//!< true if the round trip is slow enough to display predictions
+	Boolean							alwaysDisplay;			//!< if true, "isSlow" is ignored
+};
+typedef My_EchoPredictor*	My_EchoPredictorPtr;
+
+} // anonymous namespace
+
+#pragma mark Internal Method Prototypes
+namespace {
+
+Boolean		isPredictable		(UniChar);
+std::string	returnTestDisplay	(EchoPredictor_Ref);
+void		testTerminal		(EchoPredictor_Ref, char const*, UInt16, UInt64);
+Boolean		unitTest000_Begin	();
+Boolean		unitTest001_Begin	();
+
+} // anonymous namespace
+
+
+
+#pragma mark Public Methods
+
+/*!
+A unit test for this module.  This should always
+be run before a release, after any substantial
+changes are made, or if you suspect bugs!  It
+should also be EXPANDED as new functionality is
+proposed (ideally, a test is written before the
+functionality is added).
+
+(2021.06)
+*/
+void
+EchoPredictor_RunTests ()
+{
+	UInt16		totalTests = 0;
+	UInt16		failedTests = 0;
+	
+	
+	++totalTests; if (false == unitTest000_Begin()) ++failedTests;
+	++totalTests; if (false == unitTest001_Begin()) ++failedTests;
+	
+	Console_WriteUnitTestReport("Echo Predictor", failedTests, totalTests);
+}// RunTests
+
+
+/*!
+Destroys a predictor created with EchoPredictor_New(), and
+sets your copy of the reference to nullptr.
+
+(2021.06)
+*/
+void
+EchoPredictor_Dispose	(EchoPredictor_Ref*		inoutRefPtr)
+{
+	if (nullptr != inoutRefPtr)
+	{
+		delete REINTERPRET_CAST(*inoutRefPtr, My_EchoPredictorPtr);
+		*inoutRefPtr = nullptr;
+	}
+}// Dispose
+
+
+/*!
+Returns true only if there are predictions that have not
+been confirmed yet (displayed or not).  In that case, the
+text of the cursor row should be given to the next call to
+EchoPredictor_TerminalChanged().
+
+(2021.06)
+*/
+Boolean
+EchoPredictor_IsPredicting	(EchoPredictor_Ref	inRef)
+{
+	My_EchoPredictorPtr		ptr = REINTERPRET_CAST(inRef, My_EchoPredictorPtr);
+	Boolean					result = false;
+	
+	
+	if (nullptr != ptr)
+	{
+		result = (false == ptr->predictions.empty());
+	}
+	return result;
+}// IsPredicting
+
+
+/*!
+Creates a predictor.  Nothing is predicted until the
+terminal has been reported at least once with
+EchoPredictor_TerminalChanged().  Dispose of it with
+EchoPredictor_Dispose().
+
+Returns nullptr if the predictor cannot be created.
+
+(2021.06)
+*/
+EchoPredictor_Ref
+EchoPredictor_New	(EchoPredictor_Options	inOptions)
+{
+	EchoPredictor_Ref	result = nullptr;
+	
+	
+	try
+	{
+		result = REINTERPRET_CAST(new My_EchoPredictor(inOptions), EchoPredictor_Ref);
+	}
+	catch (std::bad_alloc)
+	{
+		result = nullptr;
+	}
+	return result;
+}// New
+
+
+/*!
+Returns the predictions that should be drawn over the
+terminal right now: consecutive characters of one row,
+starting at the given cell.  Returns false (and clears the
+text) if nothing should be displayed, because there are no
+confirmed predictions or the round trip is fast enough that
+predictions would not help (unless the option
+"kEchoPredictor_OptionAlwaysDisplay" was given).
+
+(2021.06)
+*/
+Boolean
+EchoPredictor_ReturnDisplay		(EchoPredictor_Ref			inRef,
+								 UInt16&					outColumn,
+								 UInt16&					outRow,
+								 std::vector< UniChar >&	outText)
+{
+	My_EchoPredictorPtr		ptr = REINTERPRET_CAST(inRef, My_EchoPredictorPtr);
+	
+	
+	outText.clear();
+	if ((nullptr != ptr) && (ptr->alwaysDisplay || ptr->isSlow))
+	{
+		// epochs never decrease along the list, so the displayed
+		// predictions are always the first ones
+		for (auto const& prediction : ptr->predictions)
+		{
+			if (false == ptr->isDisplayed(prediction))
+			{
+				break;
+			}
+			outText.push_back(prediction.character);
+		}
+		if (false == outText.empty())
+		{
+			outColumn = ptr->predictions.front().column;
+			outRow = ptr->predictionRow;
+		}
+	}
+	return (false == outText.empty());
+}// ReturnDisplay
+
+
+/*!
+Returns the number of times that displayed predictions were
+wrong (or were never confirmed) and had to be removed.
+
+(2021.06)
+*/
+UInt32
+EchoPredictor_ReturnMispredictionCount	(EchoPredictor_Ref	inRef)
+{
+	My_EchoPredictorPtr		ptr = REINTERPRET_CAST(inRef, My_EchoPredictorPtr);
+	UInt32					result = 0;
+	
+	
+	if (nullptr != ptr)
+	{
+		result = ptr->mispredictionCount;
+	}
+	return result;
+}// ReturnMispredictionCount
+
+
+/*!
+Returns the time that typed characters take to be echoed,
+smoothed over recent confirmations (as TCP smooths round
+trips), in nanoseconds.  This includes the time for the
+remote host to respond, not only the network.  Returns 0
+if no prediction has been confirmed yet.
+
+(2021.06)
+*/
+UInt64
+EchoPredictor_ReturnRoundTripNanoseconds	(EchoPredictor_Ref	inRef)
+{
+	My_EchoPredictorPtr		ptr = REINTERPRET_CAST(inRef, My_EchoPredictorPtr);
+	UInt64					result = 0;
+	
+	
+	if (nullptr != ptr)
+	{
+		result = ptr->roundTripNanoseconds;
+	}
+	return result;
+}// ReturnRoundTripNanoseconds
+
+
+/*!
+Reports the state of the terminal, after output from the
+remote host has been processed (or at any other time).
+
+Each prediction that the cursor has moved past is compared
+to the text of the cursor row: if the cell has the
+predicted character, the prediction is confirmed (and the
+time since it was typed updates the round trip); otherwise,
+every prediction is discarded.  Every prediction is also
+discarded if the cursor moves to another row or back past
+the first prediction, if the alternate screen becomes
+active, or if the oldest prediction has waited much longer
+than the round trip.
+
+The text is only needed when EchoPredictor_IsPredicting()
+returns true; it may be shorter than the row (cells past the
+end are considered blank).
+
+(2021.06)
+*/
+void
+EchoPredictor_TerminalChanged	(EchoPredictor_Ref		inRef,
+								 UInt16					inCursorColumn,
+								 UInt16					inCursorRow,
+								 UInt16					inColumnCount,
+								 Boolean				inIsAlternateScreen,
+								 UniChar const*			inCursorRowTextOrNull,
+								 UInt16					inCursorRowTextLength,
+								 UInt64					inNanosecondsNow)
+{
+	My_EchoPredictorPtr		ptr = REINTERPRET_CAST(inRef, My_EchoPredictorPtr);
+	
+	
+	if (nullptr != ptr)
+	{
+		if (inIsAlternateScreen)
+		{
+			ptr->discardPredictions();
+		}
+		else if (false == ptr->predictions.empty())
+		{
+			if ((inCursorRow != ptr->predictionRow) || (inCursorColumn < ptr->predictions.front().column))
+			{
+				// the cursor jumped; whatever happened was not predicted
+				ptr->discardPredictions();
+			}
+			
+			while ((false == ptr->predictions.empty()) && (inCursorColumn > ptr->predictions.front().column))
+			{
+				My_Prediction const&	kPrediction = ptr->predictions.front();
+				
+				
+				if ((nullptr != inCursorRowTextOrNull) && (kPrediction.column < inCursorRowTextLength) &&
+					(kPrediction.character == inCursorRowTextOrNull[kPrediction.column]))
+				{
+					ptr->updateRoundTrip(inNanosecondsNow - std::min(inNanosecondsNow, kPrediction.sentTime));
+					ptr->confirmedEpoch = std::max(ptr->confirmedEpoch, kPrediction.epoch);
+					ptr->predictions.pop_front();
+				}
+				else
+				{
+					ptr->discardPredictions();
+				}
+			}
+			
+			ptr->discardExpiredPredictions(inNanosecondsNow);
+		}
+		ptr->cursorColumn = inCursorColumn;
+		ptr->cursorRow = inCursorRow;
+		ptr->columnCount = inColumnCount;
+		ptr->isAlternateScreen = inIsAlternateScreen;
+		ptr->isCursorKnown = true;
+	}
+}// TerminalChanged
+
+
+/*!
+Reports a character that the user typed (and that was sent
+to the remote host).  If it is printable, it is predicted
+to appear after the cursor (or after the last prediction).
+
+Returns true only if the character was predicted; anything
+else is handled as if EchoPredictor_UserInputOther() was
+called.
+
+(2021.06)
+*/
+Boolean
+EchoPredictor_UserInputCharacter	(EchoPredictor_Ref		inRef,
+									 UniChar				inCharacter,
+									 UInt64					inNanosecondsNow)
+{
+	My_EchoPredictorPtr		ptr = REINTERPRET_CAST(inRef, My_EchoPredictorPtr);
+	Boolean					result = false;
+	
+	
+	if (nullptr != ptr)
+	{
+		ptr->discardExpiredPredictions(inNanosecondsNow);
+		if (isPredictable(inCharacter) && ptr->isCursorKnown && (false == ptr->isAlternateScreen) &&
+			(ptr->predictions.size() < kMy_MaximumPredictionCount))
+		{
+			UInt16 const	kColumn = ((ptr->predictions.empty())
+										? ptr->cursorColumn
+										: STATIC_CAST(ptr->predictions.back().column + 1, UInt16));
+			
+			
+			// the last column is never predicted, since what the cursor
+			// does next depends on the wrap mode of the terminal
+			if ((kColumn + 1) < ptr->columnCount)
+			{
+				My_Prediction	prediction;
+				
+				
+				if (ptr->predictions.empty())
+				{
+					ptr->predictionRow = ptr->cursorRow;
+				}
+				prediction.sentTime = inNanosecondsNow;
+				prediction.epoch = ptr->epoch;
+				prediction.column = kColumn;
+				prediction.character = inCharacter;
+				ptr->predictions.push_back(prediction);
+				result = true;
+			}
+		}
+		
+		if (false == result)
+		{
+			EchoPredictor_UserInputOther(inRef);
+		}
+	}
+	return result;
+}// UserInputCharacter
+
+
+/*!
+Reports that the user typed a key that erases the previous
+character.  The most recent prediction is removed (if any),
+and later predictions are not displayed until one of them
+is confirmed, since the echo of an erase varies.
+
+(2021.06)
+*/
+void
+EchoPredictor_UserInputErase	(EchoPredictor_Ref	inRef)
+{
+	My_EchoPredictorPtr		ptr = REINTERPRET_CAST(inRef, My_EchoPredictorPtr);
+	
+	
+	if (nullptr != ptr)
+	{
+		if (false == ptr->predictions.empty())
+		{
+			ptr->predictions.pop_back();
+		}
+		++(ptr->epoch);
+	}
+}// UserInputErase
+
+
+/*!
+Reports input whose effect cannot be predicted, such as a
+control key, an arrow key or a Paste.  Existing predictions
+are unaffected, but new ones are not displayed until one of
+them is confirmed.
+
+(2021.06)
+*/
+void
+EchoPredictor_UserInputOther	(EchoPredictor_Ref	inRef)
+{
+	My_EchoPredictorPtr		ptr = REINTERPRET_CAST(inRef, My_EchoPredictorPtr);
+	
+	
+	if (nullptr != ptr)
+	{
+		++(ptr->epoch);
+	}
+}// UserInputOther
+
+
+#pragma mark Internal Methods
+namespace {
+
+/*!
+Constructor.  See EchoPredictor_New().
+
+(2021.06)
+*/
+My_EchoPredictor::
+My_EchoPredictor	(EchoPredictor_Options	inOptions)
+:
+predictions(),
+roundTripNanoseconds(0),
+epoch(1), // initially, nothing has been confirmed
+confirmedEpoch(0),
+mispredictionCount(0),
+cursorColumn(0),
+cursorRow(0),
+columnCount(0),
+predictionRow(0),
+isCursorKnown(false),
+isAlternateScreen(false),
+isSlow(false),
+alwaysDisplay(0 != (inOptions & kEchoPredictor_OptionAlwaysDisplay))
+{
+}// My_EchoPredictor default constructor
+
+
+/*!
+Removes every prediction, and starts a new epoch so that
+nothing is displayed again until a prediction is confirmed.
+If any of the predictions was displayed, this counts as a
+misprediction.
+
+(2021.06)
+*/
+void
+My_EchoPredictor::
+discardPredictions ()
+{
+	if ((false == predictions.empty()) && isDisplayed(predictions.front()))
+	{
+		++mispredictionCount;
+	}
+	predictions.clear();
+	++epoch;
+}// My_EchoPredictor::discardPredictions
+
+
+/*!
+Discards every prediction if the oldest one has waited much
+longer than the round trip (for instance, because the
+remote host stopped echoing what is typed).
+
+(2021.06)
+*/
+void
+My_EchoPredictor::
+discardExpiredPredictions	(UInt64		inNanosecondsNow)
+{
+	if ((false == predictions.empty()) && (inNanosecondsNow > predictions.front().sentTime) &&
+		((inNanosecondsNow - predictions.front().sentTime) > returnTimeout()))
+	{
+		discardPredictions();
+	}
+}// My_EchoPredictor::discardExpiredPredictions
+
+
+/*!
+Returns true only if the given prediction belongs to an
+epoch that has been confirmed.  (The round trip is not
+considered; see EchoPredictor_ReturnDisplay().)
+
+(2021.06)
+*/
+Boolean
+My_EchoPredictor::
+isDisplayed		(My_Prediction const&	inPrediction)
+const
+{
+	return (inPrediction.epoch <= confirmedEpoch);
+}// My_EchoPredictor::isDisplayed
+
+
+/*!
+Returns the number of nanoseconds that a prediction may
+wait for confirmation before it is considered wrong.
+
+(2021.06)
+*/
+UInt64
+My_EchoPredictor::
+returnTimeout ()
+const
+{
+	return std::max(kMy_MinimumTimeoutNanoseconds, 4 * roundTripNanoseconds);
+}// My_EchoPredictor::returnTimeout
+
+
+/*!
+Adds a measured round trip to the smoothed value, and
+decides whether it is slow enough to display predictions;
+separate thresholds for starting and stopping prevent the
+display from changing with every small variation.
+
+(2021.06)
+*/
+void
+My_EchoPredictor::
+updateRoundTrip		(UInt64		inNanoseconds)
+{
+	if (0 == roundTripNanoseconds)
+	{
+		roundTripNanoseconds = std::max< UInt64 >(inNanoseconds, 1);
+	}
+	else
+	{
+		roundTripNanoseconds = roundTripNanoseconds - (roundTripNanoseconds / 8) + (inNanoseconds / 8);
+	}
+	
+	if (roundTripNanoseconds > kMy_DisplayRoundTripNanoseconds)
+	{
+		isSlow = true;
+	}
+	else if (roundTripNanoseconds < kMy_HideRoundTripNanoseconds)
+	{
+		isSlow = false;
+	}
+}// My_EchoPredictor::updateRoundTrip
+
+
+/*!
+Returns true only if the given character can be predicted
+to appear in one cell when echoed: that is, it is not a
+control character, a surrogate or a combining mark.  (Wide
+characters are not distinguished, so only characters below
+U+1100 are predicted.)
+
+(2021.06)
+*/
+Boolean
+isPredictable	(UniChar	inCharacter)
+{
+	return ((inCharacter >= 0x0020) && (inCharacter < 0x1100) &&
+			(0x007F != inCharacter) && ((inCharacter < 0x0080) || (inCharacter > 0x009F)) &&
+			((inCharacter < 0x0300) || (inCharacter > 0x036F)));
+}// isPredictable
+
+
+/*!
+Returns the displayed predictions as "column,row:text", or
+an empty string if nothing is displayed, for tests.
+
+(2021.06)
+*/
+std::string
+returnTestDisplay	(EchoPredictor_Ref	inRef)
+{
+	std::vector< UniChar >	text;
+	UInt16					column = 0;
+	UInt16					row = 0;
+	std::string				result;
+	
+	
+	if (EchoPredictor_ReturnDisplay(inRef, column, row, text))
+	{
+		result = std::to_string(column) + "," + std::to_string(row) + ":";
+		for (auto character : text)
+		{
+			result += STATIC_CAST(character, char);
+		}
+	}
+	return result;
+}// returnTestDisplay
+
+
+/*!
+Reports an 80-column terminal whose cursor row has the given
+text, with the cursor on row 5 in the given column, for tests.
+
+(2021.06)
+*/
+void
+testTerminal	(EchoPredictor_Ref	inRef,
+				 char const*		inRowText,
+				 UInt16				inCursorColumn,
+				 UInt64				inNanosecondsNow)
+{
+	std::vector< UniChar >	rowText;
+	
+	
+	for (char const* charPtr = inRowText; '\0' != *charPtr; ++charPtr)
+	{
+		rowText.push_back(STATIC_CAST(*charPtr, UniChar));
+	}
+	EchoPredictor_TerminalChanged(inRef, inCursorColumn, 5/* row */, 80/* columns */, false/* alternate screen */,
+									rowText.data(), STATIC_CAST(rowText.size(), UInt16), inNanosecondsNow);
+}// testTerminal
+
+
+/*!
+Tests the confirmation of predictions, the measurement of
+the round trip, and when predictions are displayed.
+
+Returns "true" if ALL assertions pass; "false" is
+returned if any fail, however messages should be
+printed for ALL assertion failures regardless.
+
+(2021.06)
+*/
+Boolean
+unitTest000_Begin ()
+{
+	UInt64 const		kMillisecond = 1000000;
+	EchoPredictor_Ref	predictor = EchoPredictor_New();
+	std::string			display;
+	Boolean				result = true;
+	
+	
+	// nothing is predicted until the terminal has been reported
+	Console_TestAssertUpdate(result, false == EchoPredictor_UserInputCharacter(predictor, 'x', 0),
+								Console_WriteLine, "character should not be predicted before the terminal is known");
+	
+	// the first predictions are not displayed, since no echo has been seen yet
+	testTerminal(predictor, "$ ", 2, 0);
+	Console_TestAssertUpdate(result, EchoPredictor_UserInputCharacter(predictor, 'l', 0), Console_WriteLine, "character should be predicted");
+	Console_TestAssertUpdate(result, EchoPredictor_UserInputCharacter(predictor, 's', kMillisecond), Console_WriteLine, "character should be predicted");
+	display = returnTestDisplay(predictor);
+	Console_TestAssertUpdate(result, display.empty(), Console_WriteValueStdString, "unconfirmed display", display);
+	
+	// an echo confirms a prediction and measures the round trip; the rest can now be displayed
+	testTerminal(predictor, "$ l", 3, 80 * kMillisecond);
+	Console_TestAssertUpdate(result, 80 * kMillisecond == EchoPredictor_ReturnRoundTripNanoseconds(predictor),
+								Console_WriteValue, "round trip", EchoPredictor_ReturnRoundTripNanoseconds(predictor));
+	display = returnTestDisplay(predictor);
+	Console_TestAssertUpdate(result, "3,5:s" == display, Console_WriteValueStdString, "display after confirmation", display);
+	Console_TestAssertUpdate(result, EchoPredictor_UserInputCharacter(predictor, ' ', 80 * kMillisecond), Console_WriteLine, "space should be predicted");
+	display = returnTestDisplay(predictor);
+	Console_TestAssertUpdate(result, "3,5:s " == display, Console_WriteValueStdString, "display after more typing", display);
+	
+	// erasing removes the last prediction
+	EchoPredictor_UserInputErase(predictor);
+	display = returnTestDisplay(predictor);
+	Console_TestAssertUpdate(result, "3,5:s" == display, Console_WriteValueStdString, "display after erase", display);
+	
+	// the remaining echo arrives; the round trip is smoothed
+	testTerminal(predictor, "$ ls", 4, 81 * kMillisecond);
+	Console_TestAssertUpdate(result, false == EchoPredictor_IsPredicting(predictor), Console_WriteLine, "every prediction should be confirmed");
+	Console_TestAssertUpdate(result, 80 * kMillisecond == EchoPredictor_ReturnRoundTripNanoseconds(predictor),
+								Console_WriteValue, "smoothed round trip", EchoPredictor_ReturnRoundTripNanoseconds(predictor));
+	Console_TestAssertUpdate(result, 0 == EchoPredictor_ReturnMispredictionCount(predictor),
+								Console_WriteValue, "misprediction count", EchoPredictor_ReturnMispredictionCount(predictor));
+	EchoPredictor_Dispose(&predictor);
+	
+	// with a fast round trip, confirmed predictions are only displayed if requested
+	for (auto options : { kEchoPredictor_OptionsNone, kEchoPredictor_OptionAlwaysDisplay })
+	{
+		predictor = EchoPredictor_New(options);
+		testTerminal(predictor, "", 0, 0);
+		UNUSED_RETURN(Boolean)EchoPredictor_UserInputCharacter(predictor, 'a', 0);
+		UNUSED_RETURN(Boolean)EchoPredictor_UserInputCharacter(predictor, 'b', 0);
+		testTerminal(predictor, "a", 1, kMillisecond);
+		display = returnTestDisplay(predictor);
+		if (kEchoPredictor_OptionAlwaysDisplay == options)
+		{
+			Console_TestAssertUpdate(result, "1,5:b" == display, Console_WriteValueStdString, "display when always displayed", display);
+		}
+		else
+		{
+			Console_TestAssertUpdate(result, display.empty(), Console_WriteValueStdString, "display with fast round trip", display);
+		}
+		EchoPredictor_Dispose(&predictor);
+	}
+	
+	return result;
+}// unitTest000_Begin
+
+
+/*!
+Tests the removal of predictions that turn out to be wrong,
+and the situations in which nothing is predicted.
+
+Returns "true" if ALL assertions pass; "false" is
+returned if any fail, however messages should be
+printed for ALL assertion failures regardless.
+
+(2021.06)
+*/
+Boolean
+unitTest001_Begin ()
+{
+	UInt64 const		kMillisecond = 1000000;
+	EchoPredictor_Ref	predictor = EchoPredictor_New(kEchoPredictor_OptionAlwaysDisplay);
+	UInt16				column = 0;
+	UInt16				row = 0;
+	std::vector< UniChar >	text;
+	std::string			display;
+	Boolean				result = true;
+	
+	
+	// confirm one prediction so that later ones are displayed
+	testTerminal(predictor, "", 0, 0);
+	UNUSED_RETURN(Boolean)EchoPredictor_UserInputCharacter(predictor, 'p', 0);
+	testTerminal(predictor, "p", 1, 50 * kMillisecond);
+	
+	// a different character in the cell removes every prediction
+	UNUSED_RETURN(Boolean)EchoPredictor_UserInputCharacter(predictor, 'a', 100 * kMillisecond);
+	UNUSED_RETURN(Boolean)EchoPredictor_UserInputCharacter(predictor, 'b', 100 * kMillisecond);
+	display = returnTestDisplay(predictor);
+	Console_TestAssertUpdate(result, "1,5:ab" == display, Console_WriteValueStdString, "display before misprediction", display);
+	testTerminal(predictor, "pA", 2, 150 * kMillisecond);
+	Console_TestAssertUpdate(result, false == EchoPredictor_IsPredicting(predictor), Console_WriteLine, "misprediction should remove everything");
+	Console_TestAssertUpdate(result, 1 == EchoPredictor_ReturnMispredictionCount(predictor),
+								Console_WriteValue, "misprediction count", EchoPredictor_ReturnMispredictionCount(predictor));
+	
+	// after that, predictions are hidden until one is confirmed
+	UNUSED_RETURN(Boolean)EchoPredictor_UserInputCharacter(predictor, 'c', 200 * kMillisecond);
+	UNUSED_RETURN(Boolean)EchoPredictor_UserInputCharacter(predictor, 'd', 200 * kMillisecond);
+	display = returnTestDisplay(predictor);
+	Console_TestAssertUpdate(result, display.empty(), Console_WriteValueStdString, "display after misprediction", display);
+	testTerminal(predictor, "pAc", 3, 250 * kMillisecond);
+	display = returnTestDisplay(predictor);
+	Console_TestAssertUpdate(result, "3,5:d" == display, Console_WriteValueStdString, "display after new confirmation", display);
+	
+	// a cursor on another row removes every prediction
+	EchoPredictor_TerminalChanged(predictor, 3, 6/* row */, 80, false, nullptr, 0, 260 * kMillisecond);
+	Console_TestAssertUpdate(result, false == EchoPredictor_IsPredicting(predictor), Console_WriteLine, "cursor jump should remove everything");
+	Console_TestAssertUpdate(result, 2 == EchoPredictor_ReturnMispredictionCount(predictor),
+								Console_WriteValue, "misprediction count after jump", EchoPredictor_ReturnMispredictionCount(predictor));
+	
+	// control characters and the last column are not predicted
+	testTerminal(predictor, "pAc", 3, 300 * kMillisecond);
+	Console_TestAssertUpdate(result, false == EchoPredictor_UserInputCharacter(predictor, 0x0D, 300 * kMillisecond),
+								Console_WriteLine, "control character should not be predicted");
+	testTerminal(predictor, "", 79, 300 * kMillisecond);
+	Console_TestAssertUpdate(result, false == EchoPredictor_UserInputCharacter(predictor, 'z', 300 * kMillisecond),
+								Console_WriteLine, "last column should not be predicted");
+	
+	// nothing is predicted on the alternate screen
+	EchoPredictor_TerminalChanged(predictor, 0, 0, 80, true/* alternate screen */, nullptr, 0, 300 * kMillisecond);
+	Console_TestAssertUpdate(result, false == EchoPredictor_UserInputCharacter(predictor, 'q', 300 * kMillisecond),
+								Console_WriteLine, "alternate screen should not be predicted");
+	
+	// predictions that are never echoed expire
+	testTerminal(predictor, "", 0, 400 * kMillisecond);
+	UNUSED_RETURN(Boolean)EchoPredictor_UserInputCharacter(predictor, 'e', 400 * kMillisecond);
+	testTerminal(predictor, "", 0, 900 * kMillisecond);
+	Console_TestAssertUpdate(result, EchoPredictor_IsPredicting(predictor), Console_WriteLine, "prediction should not expire yet");
+	testTerminal(predictor, "", 0, 2000 * kMillisecond);
+	Console_TestAssertUpdate(result, false == EchoPredictor_IsPredicting(predictor), Console_WriteLine, "prediction should expire");
+	Console_TestAssertUpdate(result, false == EchoPredictor_ReturnDisplay(predictor, column, row, text),
+								Console_WriteLine, "nothing should be displayed");
+	EchoPredictor_Dispose(&predictor);
+	
+	return result;
+}// unitTest001_Begin
+
+} // anonymous namespace
+
+// BELOW IS REQUIRED NEWLINE TO END FILE
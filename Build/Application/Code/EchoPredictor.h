@@ -0,0 +1,167 @@
+/*!	\file EchoPredictor.h
+	\brief Guesses how typed characters will be echoed, so
+	that they can be displayed before the remote host echoes
+	them.
+	
+	Over a slow connection, every typed character normally
+	appears only after a round trip.  A predictor remembers
+	each printable character that is typed (and the cell
+	where it should appear), and the session draws these
+	predictions over the terminal until the real output
+	arrives.  Each time the terminal changes, the predictions
+	that the cursor has passed are compared to the screen:
+	a match confirms the prediction (and measures the round
+	trip), and anything else discards every prediction.
+	
+	Predictions are only displayed once the remote host has
+	confirmed that it echoes what is typed: after any input
+	that cannot be predicted (such as a control key), new
+	predictions are hidden until one of them is confirmed.
+	Nothing is predicted while the cursor is in the last
+	column, or while the alternate screen is active (where
+	full-screen programs rarely echo what is typed).  By
+	default, predictions are only displayed when the round
+	trip is slow enough that the difference is noticeable.
+	
+	The predictor does not use the terminal directly; times
+	are given in nanoseconds by the caller (from any clock
+	that never goes backwards).
+*/
+/*###############################################################
+
+	MacTerm
+		© 1998-2021 by Kevin Grant.
+		© 2001-2003 by Ian Anderson.
+		© 1986-1994 University of Illinois Board of Trustees
+		(see About box for full list of U of I contributors).
+	
+	This program is free software; you can redistribute it or
+	modify it under the terms of the GNU General Public License
+	as published by the Free Software Foundation; either version
+	2 of the License, or (at your option) any later version.
+	
+	This program is distributed in the hope that it will be
+	useful, but WITHOUT ANY WARRANTY; without even the implied
+	warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+	PURPOSE.  See the GNU General Public License for more
+	details.
+	
+	You should have received a copy of the GNU General Public
+	License along with this program; if not, write to:
+	
+		Free Software Foundation, Inc.
+		59 Temple Place, Suite 330
+		Boston, MA  02111-1307
+		USA
+
+###############################################################*/
+
+#include <UniversalDefines.h>
+
+#pragma once
+
+// standard-C++ includes
+#include <vector>
+
+// Mac includes
+#include <CoreServices/CoreServices.h>
+
+
+
+#pragma mark Constants
+
+/*!
+Options for EchoPredictor_New().
+*/
+typedef UInt32 EchoPredictor_Options;
+enum
+{
+	kEchoPredictor_OptionsNone				= 0,
+	kEchoPredictor_OptionAlwaysDisplay		= (1 << 0)	//!< display confirmed predictions even when the round trip
+														//!  is fast (normally they are only displayed when slow)
+};
+
+#pragma mark Types
+
+typedef struct EchoPredictor_OpaquePredictor*	EchoPredictor_Ref;
+
+
+
+#pragma mark Public Methods
+
+//!\name Module Tests
+//@{
+
+void
+	EchoPredictor_RunTests					();
+
+//@}
+
+//!\name Creating and Destroying Predictors
+//@{
+
+EchoPredictor_Ref
+	EchoPredictor_New						(EchoPredictor_Options	inOptions = kEchoPredictor_OptionsNone);
+
+void
+	EchoPredictor_Dispose					(EchoPredictor_Ref*		inoutRefPtr);
+
+//@}
+
+//!\name Reporting Input and Output
+//@{
+
+// CALL WHENEVER THE CURSOR OR THE TEXT OF ITS ROW MAY HAVE CHANGED; THE TEXT IS ONLY NEEDED IF EchoPredictor_IsPredicting()
+void
+	EchoPredictor_TerminalChanged			(EchoPredictor_Ref		inRef,
+											 UInt16					inCursorColumn,
+											 UInt16					inCursorRow,
+											 UInt16					inColumnCount,
+											 Boolean				inIsAlternateScreen,
+											 UniChar const*			inCursorRowTextOrNull,
+											 UInt16					inCursorRowTextLength,
+											 UInt64					inNanosecondsNow);
+
+// RETURNS true ONLY IF THE CHARACTER WAS PREDICTED
+Boolean
+	EchoPredictor_UserInputCharacter		(EchoPredictor_Ref		inRef,
+											 UniChar				inCharacter,
+											 UInt64					inNanosecondsNow);
+
+void
+	EchoPredictor_UserInputErase			(EchoPredictor_Ref		inRef);
+
+// FOR ANY INPUT THAT IS NOT A PRINTABLE CHARACTER OR AN ERASE (E.G. CONTROL KEYS, ARROWS, PASTES)
+void
+	EchoPredictor_UserInputOther			(EchoPredictor_Ref		inRef);
+
+//@}
+
+//!\name Displaying Predictions
+//@{
+
+Boolean
+	EchoPredictor_IsPredicting				(EchoPredictor_Ref		inRef);
+
+// RETURNS false IF NOTHING SHOULD BE DISPLAYED; OTHERWISE THE TEXT BELONGS AT THE GIVEN CELL (ON ONE ROW)
+Boolean
+	EchoPredictor_ReturnDisplay				(EchoPredictor_Ref		inRef,
+											 UInt16&				outColumn,
+											 UInt16&				outRow,
+											 std::vector< UniChar >&	outText);
+
+//@}
+
+//!\name Measuring Latency
+//@{
+
+UInt32
+	EchoPredictor_ReturnMispredictionCount	(EchoPredictor_Ref		inRef);
+
+// SMOOTHED; 0 UNTIL A PREDICTION HAS BEEN CONFIRMED
+UInt64
+	EchoPredictor_ReturnRoundTripNanoseconds	(EchoPredictor_Ref		inRef);
+
+//@}
+
+// BELOW IS REQUIRED NEWLINE TO END FILE
@@ -995,7 +995,15 @@ mouseLocation:(NSPoint)			mouseLocation
 			
 			if (Session_GetStateString(rowData->session, stateCFString).ok())
 			{
+				UInt32 const	kRoundTripMilliseconds = Session_ReturnEchoRoundTripMilliseconds(rowData->session);
+				
+				
 				result = BRIDGE_CAST(stateCFString, NSString*);
+				if (kRoundTripMilliseconds > 0)
+				{
+					// predictive local echo measures the delay of the connection
+					result = [NSString stringWithFormat:@"%@ (%u ms)"/* LOCALIZE THIS */, result, STATIC_CAST(kRoundTripMilliseconds, unsigned int)];
+				}
 			}
 		}
 	}
@@ -9,21 +9,21 @@
 		© 2001-2003 by Ian Anderson.
 		© 1986-1994 University of Illinois Board of Trustees
 		(see About box for full list of U of I contributors).
-	
+
 	This program is free software; you can redistribute it or
 	modify it under the terms of the GNU General Public License
 	as published by the Free Software Foundation; either version
 	2 of the License, or (at your option) any later version.
-	
+
 	This program is distributed in the hope that it will be
 	useful, but WITHOUT ANY WARRANTY; without even the implied
 	warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
 	PURPOSE.  See the GNU General Public License for more
 	details.
-	
+
 	You should have received a copy of the GNU General Public
 	License along with this program; if not, write to:
-	
+
 		Free Software Foundation, Inc.
 		59 Temple Place, Suite 330
 		Boston, MA  02111-1307
@@ -43,6 +43,8 @@
 #import <map>
 #import <sstream>
 #import <string>
+#import <utility>
+#import <vector>
 
 // Mac includes
 #import <ApplicationServices/ApplicationServices.h>
@@ -51,26 +53,72 @@
 
 // library includes
 #import <AlertMessages.h>
+#import <AsyncWriter.h>
+#import <CFRetainRelease.h>
 #import <CocoaBasic.h>
 #import <Console.h>
 #import <Localization.h>
 #import <MemoryBlockPtrLocker.template.h>
 #import <MemoryBlocks.h>
 #import <ParameterDecoder.h>
+#import <ProcessSpawn.h>
+#import <TimerWheel.h>
+#import <TraceSpan.h>
 
 // application includes
 #import "AppResources.h"
+#import "BroadcastGroup.h"
 #import "Clipboard.h"
 #import "CommandLine.h"
 #import "Commands.h"
 #import "DebugInterface.h"
+#import "EchoPredictor.h"
 #import "EventLoop.h"
 #import "InfoWindow.h"
+#import "LinkScanner.h"
+#import "Local.h"
+#import "PasteStream.h"
 #import "Preferences.h"
 #import "PrefsWindow.h"
 #import "SessionFactory.h"
+#import "StreamCapture.h"
+#import "Terminal.h"
 #import "TerminalView.h"
+#import "TextExport.h"
 #import "UIStrings.h"
+#import "WordBoundary.h"
+
+
+
+#pragma mark Types
+namespace {
+
+/*!
+Records the time spent in each phase of startup, so
+that a slow launch can be blamed on a specific module.
+The report is written to the console at the end of
+Initialize_ApplicationStartup() in debug builds.
+*/
+class My_StartupTrace
+{
+public:
+	My_StartupTrace ();
+
+	void
+	endPhase	(char const*);
+
+	void
+	writeReport () const;
+
+private:
+	typedef std::pair< char const*, CFAbsoluteTime >	PhaseDuration;
+
+	CFAbsoluteTime					_startTime;			//!< when the trace was constructed
+	CFAbsoluteTime					_phaseStartTime;	//!< when the current phase began
+	std::vector< PhaseDuration >	_phases;			//!< phase names (static strings) and elapsed seconds, in order
+};
+
+} // anonymous namespace
 
 
 
@@ -86,11 +134,15 @@ in a particular dependency order.
 void
 Initialize_ApplicationStartup	(CFBundleRef	inApplicationBundle)
 {
+	My_StartupTrace		startupTrace;
+	
+	
 	// seed random number generator; calls to random() should not be
 	// used for anything particularly important, arc4random() is better
 	::srandom(TickCount());
 	
 	Console_Init();
+	startupTrace.endPhase("Console");
 	
 //#define RUN_MODULE_TESTS (defined DEBUG)
 #define RUN_MODULE_TESTS 0
@@ -100,7 +152,7 @@ Initialize_ApplicationStartup	(CFBundleRef	inApplicationBundle)
 #endif
 	
 #if RUN_MODULE_TESTS
-	//Console_RunTests();
+	Console_RunTests();
 #endif
 	
 #if RUN_MODULE_TESTS
@@ -113,12 +165,51 @@ Initialize_ApplicationStartup	(CFBundleRef	inApplicationBundle)
 	
 	// set the application bundle so everything searches in the right place for resources
 	AppResources_Init(inApplicationBundle);
+	startupTrace.endPhase("AppResources");
+	
+	// local processes are started by a helper program, which
+	// makes their terminals work (see "ProcessSpawn.h")
+	{
+		CFRetainRelease		helperURL(CFBundleCopyAuxiliaryExecutableURL(inApplicationBundle, CFSTR("MacTermSpawnHelper")),
+										CFRetainRelease::kAlreadyRetained);
+		char				helperPath[PATH_MAX];
+		
+		
+		if (helperURL.exists() &&
+			CFURLGetFileSystemRepresentation(helperURL.returnCFURLRef(), true/* absolute */,
+												REINTERPRET_CAST(helperPath, UInt8*), sizeof(helperPath)))
+		{
+			ProcessSpawn_SetHelperPath(helperPath);
+		}
+		else
+		{
+			Console_Warning(Console_WriteLine, "spawn helper not found; local processes will have no controlling terminal");
+		}
+	}
+	
+	// detachable local processes are run by a session server, which
+	// is started when needed (see "SessionServer.h")
+	{
+		CFRetainRelease		serverURL(CFBundleCopyAuxiliaryExecutableURL(inApplicationBundle, CFSTR("MacTermSessionServer")),
+										CFRetainRelease::kAlreadyRetained);
+		char				serverPath[PATH_MAX];
+		
+		
+		if (serverURL.exists() &&
+			CFURLGetFileSystemRepresentation(serverURL.returnCFURLRef(), true/* absolute */,
+												REINTERPRET_CAST(serverPath, UInt8*), sizeof(serverPath)))
+		{
+			Local_SetSessionServerPath(serverPath);
+		}
+	}
 	
 	// initialize Cocoa
 	EventLoop_Init();
+	startupTrace.endPhase("EventLoop");
 	
 	// set up notification info
 	Preferences_Init();
+	startupTrace.endPhase("Preferences");
 	{
 		UInt16					notificationPreferences = kAlertMessages_NotificationTypeMarkDockIcon;
 		Preferences_Result		prefsResult = Preferences_GetData(kPreferences_TagNotification,
@@ -153,41 +244,83 @@ Initialize_ApplicationStartup	(CFBundleRef	inApplicationBundle)
 	// which is likely used for debug)!  Other modules should
 	// be tested as soon as possible after their Init routine
 	// is called, i.e. call Foo_Init() and then Foo_RunTests().
+	AsyncWriter_RunTests();
 	ListenerModel_RunTests();
+	ProcessSpawn_RunTests();
+	TimerWheel_RunTests();
+	TraceSpan_RunTests();
 #endif
 	
 	// do everything else
 	{
 		SessionFactory_Init();
+		startupTrace.endPhase("SessionFactory");
 	#if RUN_MODULE_TESTS
 		//SessionFactory_RunTests();
 	#endif
 		
 		Commands_Init();
+		startupTrace.endPhase("Commands");
 	#if RUN_MODULE_TESTS
 		//Commands_RunTests();
 	#endif
 		
+	#if RUN_MODULE_TESTS
+		BroadcastGroup_RunTests();
+	#endif
+		
+	#if RUN_MODULE_TESTS
+		EchoPredictor_RunTests();
+	#endif
+		
+	#if RUN_MODULE_TESTS
+		LinkScanner_RunTests();
+	#endif
+		
 	#if RUN_MODULE_TESTS
 		ParameterDecoder_RunTests();
 	#endif
 		
+	#if RUN_MODULE_TESTS
+		PasteStream_RunTests();
+	#endif
+		
+	#if RUN_MODULE_TESTS
+		StreamCapture_RunTests();
+	#endif
+		
+	#if RUN_MODULE_TESTS
+		Terminal_RunTests();
+	#endif
+		
+	#if RUN_MODULE_TESTS
+		TextExport_RunTests();
+	#endif
+		
+	#if RUN_MODULE_TESTS
+		WordBoundary_RunTests();
+	#endif
+		
 		TerminalView_Init();
+		startupTrace.endPhase("TerminalView");
 	#if RUN_MODULE_TESTS
-		//TerminalView_RunTests();
+		TerminalView_RunTests();
 	#endif
 		
 		CommandLine_Init();
+		startupTrace.endPhase("CommandLine");
 	#if RUN_MODULE_TESTS
 		//CommandLine_RunTests();
 	#endif
 		
 		Clipboard_Init();
+		startupTrace.endPhase("Clipboard");
 	#if RUN_MODULE_TESTS
 		//Clipboard_RunTests();
 	#endif
 		
 		InfoWindow_Init(); // installs command handler to enable this window to be displayed and hidden
+		startupTrace.endPhase("InfoWindow");
 	#if RUN_MODULE_TESTS
 		//InfooWindow_RunTests();
 	#endif
@@ -229,6 +362,7 @@ Initialize_ApplicationStartup	(CFBundleRef	inApplicationBundle)
 					Console_Warning(Console_WriteLine, "failed to perform command to restore default workspace!");
 				}
 			}
+			startupTrace.endPhase("restore workspace");
 		}
 	}
 	
@@ -241,6 +375,11 @@ Initialize_ApplicationStartup	(CFBundleRef	inApplicationBundle)
 		UNUSED_RETURN(BOOL)[runningApplication activateWithOptions:(NSApplicationActivateAllWindows |
 																	NSApplicationActivateIgnoringOtherApps)];
 	}
+	
+#ifndef NDEBUG
+	// note that module tests (if enabled) are counted in the phase that follows them
+	startupTrace.writeReport();
+#endif
 }// ApplicationStartup
 
 
@@ -285,4 +424,71 @@ Initialize_ApplicationShutDownRemainingComponents ()
 	SessionFactory_Done();
 }// ApplicationShutDownRemainingComponents
 
+
+#pragma mark Internal Methods
+namespace {
+
+/*!
+Constructor.  Starts timing the first phase.
+
+(2021.06)
+*/
+My_StartupTrace::
+My_StartupTrace ()
+:
+_startTime(CFAbsoluteTimeGetCurrent()),
+_phaseStartTime(_startTime),
+_phases()
+{
+	_phases.reserve(16);
+}// My_StartupTrace default constructor
+
+
+/*!
+Records the time since the previous phase ended (or
+since construction) under the given name, and starts
+timing the next phase.  The name must be a string
+constant since only the pointer is kept.
+
+(2021.06)
+*/
+void
+My_StartupTrace::
+endPhase	(char const*	inPhaseName)
+{
+	CFAbsoluteTime const	kNow = CFAbsoluteTimeGetCurrent();
+	
+	
+	_phases.push_back(std::make_pair(inPhaseName, kNow - _phaseStartTime));
+	_phaseStartTime = kNow;
+}// My_StartupTrace::endPhase
+
+
+/*!
+Writes the duration of each recorded phase to the
+console, in microseconds, followed by the total.
+
+(2021.06)
+*/
+void
+My_StartupTrace::
+writeReport ()
+const
+{
+	Console_WriteHorizontalRule();
+	Console_WriteLine("Startup time by phase (microseconds):");
+	for (auto const&	phaseDuration : _phases)
+	{
+		std::ostringstream		labelStream;
+		
+		
+		labelStream << "  " << phaseDuration.first;
+		Console_WriteValue(labelStream.str().c_str(), STATIC_CAST(phaseDuration.second * 1000000.0, SInt64));
+	}
+	Console_WriteValue("  total", STATIC_CAST((_phaseStartTime - _startTime) * 1000000.0, SInt64));
+	Console_WriteHorizontalRule();
+}// My_StartupTrace::writeReport
+
+} // anonymous namespace
+
 // BELOW IS REQUIRED NEWLINE TO END FILE
@@ -0,0 +1,878 @@
+/*!	\file LinkScanner.cp
+	\brief Finds links in terminal text, and remembers the
+	targets of hyperlinks that applications define.
+*/
+/*###############################################################
+
+	MacTerm
+		© 1998-2021 by Kevin Grant.
+		© 2001-2003 by Ian Anderson.
+		© 1986-1994 University of Illinois Board of Trustees
+		(see About box for full list of U of I contributors).
+	
+	This program is free software; you can redistribute it or
+	modify it under the terms of the GNU General Public License
+	as published by the Free Software Foundation; either version
+	2 of the License, or (at your option) any later version.
+	
+	This program is distributed in the hope that it will be
+	useful, but WITHOUT ANY WARRANTY; without even the implied
+	warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+	PURPOSE.  See the GNU General Public License for more
+	details.
+	
+	You should have received a copy of the GNU General Public
+	License along with this program; if not, write to:
+	
+		Free Software Foundation, Inc.
+		59 Temple Place, Suite 330
+		Boston, MA  02111-1307
+		USA
+
+###############################################################*/
+
+#include "LinkScanner.h"
+#include <UniversalDefines.h>
+
+// standard-C includes
+#include <cctype>
+#include <cstring>
+
+// standard-C++ includes
+#include <algorithm>
+#include <array>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// library includes
+#include <Console.h>
+
+
+
+#pragma mark Constants
+namespace {
+
+size_t const	kMy_SchemeAlphabetSize = 40;		//!< letters, digits, "+", "-", "." and ":" (see returnSchemeSymbol())
+SInt16 const	kMy_SchemeLetterCount = 26;			//!< the first symbols are letters, which are the only ones that start schemes
+SInt16 const	kMy_NotSchemeSymbol = -1;			//!< returned by returnSchemeSymbol() for other characters
+SInt16 const	kMy_NoScheme = -1;					//!< no scheme ends at a node of the trie
+UInt16 const	kMy_NoTransition = 0;				//!< the root is never the target of a transition
+
+} // anonymous namespace
+
+#pragma mark Types
+namespace {
+
+/*!
+One node of the trie of a matcher.  The root is node 0.
+*/
+struct My_MatcherNode
+{
+	My_MatcherNode ();
+	
+	std::array< UInt16, kMy_SchemeAlphabetSize >	next;			//!< node for each symbol, or "kMy_NoTransition"
+	SInt16											schemeIndex;	//!< scheme that ends here, or "kMy_NoScheme"
+};
+
+/*!
+Internal representation of a LinkScanner_MatcherRef.
+Since every scheme ends with a colon (which cannot appear
+inside a scheme), a match is complete as soon as a node
+with a scheme is reached.
+*/
+struct My_Matcher
+{
+	SInt16
+	matchScheme		(UniChar const*, UniChar const*, UInt16&) const;
+	
+	std::vector< My_MatcherNode >	nodes;		//!< trie of every scheme; node 0 is the root
+};
+typedef My_Matcher*			My_MatcherPtr;
+typedef My_Matcher const*	My_MatcherConstPtr;
+
+/*!
+Internal representation of a LinkScanner_URITableRef.
+
+IDs are assigned in order, and an ID is stored in slot
+(ID - 1) modulo the capacity; so the table is a ring in
+which each new URI replaces the oldest one.  An ID is
+only valid while its slot still has that ID.
+*/
+struct My_URITable
+{
+	My_URITable		(UInt16);
+	
+	std::unordered_map< std::string, UInt32 >	idsByURI;		//!< every URI that has not been forgotten
+	std::vector< std::string >					uriBySlot;		//!< URI of each slot
+	std::vector< UInt32 >						idBySlot;		//!< ID of each slot; 0 if never used
+	UInt32										nextID;			//!< next ID to assign; never 0
+};
+typedef My_URITable*	My_URITablePtr;
+
+} // anonymous namespace
+
+#pragma mark Internal Method Prototypes
+namespace {
+
+Boolean		isLinkBodyCharacter	(UniChar);
+Boolean		isLinkCharacter		(UniChar);
+Boolean		isLinkTrailer		(UniChar);
+SInt16		returnSchemeSymbol	(UniChar);
+UInt16		returnTrimmedEnd	(UniChar const*, UInt16, UInt16);
+std::string	returnTestLinks		(LinkScanner_MatcherRef, char const*);
+Boolean		unitTest000_Begin	();
+Boolean		unitTest001_Begin	();
+Boolean		unitTest002_Begin	();
+
+} // anonymous namespace
+
+
+
+#pragma mark Public Methods
+
+/*!
+A unit test for this module.  This should always
+be run before a release, after any substantial
+changes are made, or if you suspect bugs!  It
+should also be EXPANDED as new functionality is
+proposed (ideally, a test is written before the
+functionality is added).
+
+(2021.06)
+*/
+void
+LinkScanner_RunTests ()
+{
+	UInt16		totalTests = 0;
+	UInt16		failedTests = 0;
+	
+	
+	++totalTests; if (false == unitTest000_Begin()) ++failedTests;
+	++totalTests; if (false == unitTest001_Begin()) ++failedTests;
+	++totalTests; if (false == unitTest002_Begin()) ++failedTests;
+	
+	Console_WriteUnitTestReport("Link Scanner", failedTests, totalTests);
+}// RunTests
+
+
+/*!
+Destroys a matcher created with LinkScanner_NewMatcher(),
+and sets your copy of the reference to nullptr.
+
+(2021.06)
+*/
+void
+LinkScanner_DisposeMatcher	(LinkScanner_MatcherRef*	inoutRefPtr)
+{
+	if (nullptr != inoutRefPtr)
+	{
+		delete REINTERPRET_CAST(*inoutRefPtr, My_MatcherPtr);
+		*inoutRefPtr = nullptr;
+	}
+}// DisposeMatcher
+
+
+/*!
+Destroys a table created with LinkScanner_NewURITable(),
+and sets your copy of the reference to nullptr.
+
+(2021.06)
+*/
+void
+LinkScanner_DisposeURITable		(LinkScanner_URITableRef*	inoutRefPtr)
+{
+	if (nullptr != inoutRefPtr)
+	{
+		delete REINTERPRET_CAST(*inoutRefPtr, My_URITablePtr);
+		*inoutRefPtr = nullptr;
+	}
+}// DisposeURITable
+
+
+/*!
+Finds every link in the given text, in a single pass.
+
+A link starts with one of the schemes of the matcher (in
+any case), at a letter that does not follow another
+character that can be part of a scheme; so "xhttp://a"
+is not a link, but the part of "(http://a)" inside the
+parentheses is.  The link continues until a space, a
+control character or a character that cannot appear in
+a URI (such as a quotation mark).  Then punctuation is
+removed from the end, as is a closing parenthesis or
+bracket that the link did not open.  A scheme that is
+not followed by at least one letter or digit (such as
+"http://" alone) is not a link.
+
+(2021.06)
+*/
+void
+LinkScanner_FindLinks	(LinkScanner_MatcherRef		inMatcher,
+						 UniChar const*				inText,
+						 UInt16						inLength,
+						 LinkScanner_SpanList&		outSpans)
+{
+	My_MatcherConstPtr	ptr = REINTERPRET_CAST(inMatcher, My_MatcherConstPtr);
+	
+	
+	outSpans.clear();
+	if ((nullptr != ptr) && (nullptr != inText))
+	{
+		UInt16		i = 0;
+		
+		
+		while (i < inLength)
+		{
+			UInt16		linkEnd = i;
+			
+			
+			// a scheme can only start with a letter, at a word boundary
+			if ((returnSchemeSymbol(inText[i]) >= 0) && (returnSchemeSymbol(inText[i]) < kMy_SchemeLetterCount) &&
+				((0 == i) || (kMy_NotSchemeSymbol == returnSchemeSymbol(inText[i - 1]))))
+			{
+				UInt16			schemeLength = 0;
+				SInt16 const	kSchemeIndex = ptr->matchScheme(inText + i, inText + inLength, schemeLength);
+				
+				
+				if (kMy_NoScheme != kSchemeIndex)
+				{
+					UInt16 const	kBodyStart = (i + schemeLength);
+					
+					
+					linkEnd = kBodyStart;
+					while ((linkEnd < inLength) && isLinkCharacter(inText[linkEnd]))
+					{
+						++linkEnd;
+					}
+					linkEnd = returnTrimmedEnd(inText + i, kBodyStart - i, linkEnd - i) + i;
+					if (std::any_of(inText + kBodyStart, inText + linkEnd, isLinkBodyCharacter))
+					{
+						LinkScanner_Span	span;
+						
+						
+						span.startIndex = i;
+						span.pastTheEndIndex = linkEnd;
+						span.schemeIndex = STATIC_CAST(kSchemeIndex, UInt16);
+						outSpans.push_back(span);
+					}
+					else
+					{
+						linkEnd = i;
+					}
+				}
+			}
+			
+			i = ((linkEnd > i) ? linkEnd : (i + 1));
+		}
+	}
+}// FindLinks
+
+
+/*!
+Returns the URI that has the given ID in the table.
+Returns false (and clears the string) if the ID is 0 or
+not valid, or if the URI has been forgotten because the
+table filled up.
+
+(2021.06)
+*/
+Boolean
+LinkScanner_GetURI	(LinkScanner_URITableRef	inTable,
+					 UInt32						inID,
+					 std::string&				outURI)
+{
+	My_URITablePtr	ptr = REINTERPRET_CAST(inTable, My_URITablePtr);
+	Boolean			result = false;
+	
+	
+	outURI.clear();
+	if ((nullptr != ptr) && (0 != inID))
+	{
+		size_t const	kSlot = ((inID - 1) % ptr->idBySlot.size());
+		
+		
+		if (inID == ptr->idBySlot[kSlot])
+		{
+			outURI = ptr->uriBySlot[kSlot];
+			result = true;
+		}
+	}
+	return result;
+}// GetURI
+
+
+/*!
+Returns the ID of the given URI, adding it to the table
+if it is not there already (which may forget the oldest
+URI in the table).  Returns 0 if the URI is empty.
+
+(2021.06)
+*/
+UInt32
+LinkScanner_InternURI	(LinkScanner_URITableRef	inTable,
+						 std::string const&			inURI)
+{
+	My_URITablePtr	ptr = REINTERPRET_CAST(inTable, My_URITablePtr);
+	UInt32			result = 0;
+	
+	
+	if ((nullptr != ptr) && (false == inURI.empty()))
+	{
+		auto	toEntry = ptr->idsByURI.find(inURI);
+		
+		
+		if (ptr->idsByURI.end() != toEntry)
+		{
+			result = toEntry->second;
+		}
+		else
+		{
+			size_t		slot = 0;
+			
+			
+			result = ptr->nextID;
+			ptr->nextID = ((0xFFFFFFFF == ptr->nextID) ? 1 : (ptr->nextID + 1));
+			slot = ((result - 1) % ptr->idBySlot.size());
+			if (0 != ptr->idBySlot[slot])
+			{
+				// forget the oldest URI
+				ptr->idsByURI.erase(ptr->uriBySlot[slot]);
+			}
+			ptr->idBySlot[slot] = result;
+			ptr->uriBySlot[slot] = inURI;
+			ptr->idsByURI[inURI] = result;
+		}
+	}
+	return result;
+}// InternURI
+
+
+/*!
+Compiles the given schemes into a matcher.  Each scheme
+must end with a colon, and contain only lowercase letters,
+digits, "+", "-" and "."; its index in the list is the
+index that is reported for links that start with it.  The
+list ends with nullptr.  Dispose of the matcher with
+LinkScanner_DisposeMatcher().
+
+Returns nullptr if the matcher cannot be created (for
+instance, if a scheme has other characters).
+
+(2021.06)
+*/
+LinkScanner_MatcherRef
+LinkScanner_NewMatcher	(char const* const*		inSchemeNames)
+{
+	LinkScanner_MatcherRef	result = nullptr;
+	
+	
+	try
+	{
+		My_Matcher		matcher;
+		Boolean			isValid = (nullptr != inSchemeNames);
+		
+		
+		matcher.nodes.push_back(My_MatcherNode()); // root
+		for (SInt16 i = 0; (isValid && (nullptr != inSchemeNames[i])); ++i)
+		{
+			char const*		schemeName = inSchemeNames[i];
+			size_t			nodeIndex = 0;
+			
+			
+			isValid = ((0 != schemeName[0]) && (':' == schemeName[std::strlen(schemeName) - 1]));
+			for (char const* charPtr = schemeName; (isValid && (0 != *charPtr)); ++charPtr)
+			{
+				SInt16 const	kSymbol = returnSchemeSymbol(STATIC_CAST(*charPtr, UInt8));
+				
+				
+				isValid = ((kMy_NotSchemeSymbol != kSymbol) && (std::tolower(*charPtr) == *charPtr));
+				if (isValid)
+				{
+					if (kMy_NoTransition == matcher.nodes[nodeIndex].next[kSymbol])
+					{
+						matcher.nodes[nodeIndex].next[kSymbol] = STATIC_CAST(matcher.nodes.size(), UInt16);
+						matcher.nodes.push_back(My_MatcherNode());
+					}
+					nodeIndex = matcher.nodes[nodeIndex].next[kSymbol];
+				}
+			}
+			if (isValid && (kMy_NoScheme == matcher.nodes[nodeIndex].schemeIndex))
+			{
+				matcher.nodes[nodeIndex].schemeIndex = i;
+			}
+		}
+		
+		if (isValid)
+		{
+			result = REINTERPRET_CAST(new My_Matcher(matcher), LinkScanner_MatcherRef);
+		}
+		else
+		{
+			Console_Warning(Console_WriteLine, "unable to compile link schemes");
+		}
+	}
+	catch (std::bad_alloc)
+	{
+		result = nullptr;
+	}
+	return result;
+}// NewMatcher
+
+
+/*!
+Creates a table that remembers up to the given number of
+unique URIs (at least 1).  Dispose of it with
+LinkScanner_DisposeURITable().
+
+Returns nullptr if the table cannot be created.
+
+(2021.06)
+*/
+LinkScanner_URITableRef
+LinkScanner_NewURITable		(UInt16		inCapacity)
+{
+	LinkScanner_URITableRef		result = nullptr;
+	
+	
+	try
+	{
+		result = REINTERPRET_CAST(new My_URITable(std::max< UInt16 >(inCapacity, 1)), LinkScanner_URITableRef);
+	}
+	catch (std::bad_alloc)
+	{
+		result = nullptr;
+	}
+	return result;
+}// NewURITable
+
+
+/*!
+Returns the index of the scheme that the given text starts
+with (in any case), as long as the text has at least one
+character after the scheme; otherwise, returns -1.
+
+(2021.06)
+*/
+SInt16
+LinkScanner_ReturnSchemeAtStart		(LinkScanner_MatcherRef		inMatcher,
+									 char const*				inBegin,
+									 char const*				inPastEnd)
+{
+	My_MatcherConstPtr	ptr = REINTERPRET_CAST(inMatcher, My_MatcherConstPtr);
+	SInt16				result = -1;
+	
+	
+	if ((nullptr != ptr) && (inBegin < inPastEnd))
+	{
+		std::vector< UniChar >	text;
+		UInt16					schemeLength = 0;
+		
+		
+		// schemes are short, so only the start of the text matters
+		for (char const* charPtr = inBegin; ((charPtr != inPastEnd) && (text.size() < 32)); ++charPtr)
+		{
+			text.push_back(STATIC_CAST(*charPtr, UInt8));
+		}
+		result = ptr->matchScheme(text.data(), text.data() + text.size(), schemeLength);
+		if ((kMy_NoScheme != result) && ((inPastEnd - inBegin) <= schemeLength))
+		{
+			result = -1;
+		}
+	}
+	return result;
+}// ReturnSchemeAtStart
+
+
+#pragma mark Internal Methods
+namespace {
+
+/*!
+Creates a node that has no transitions and no scheme.
+
+(2021.06)
+*/
+My_MatcherNode::
+My_MatcherNode ()
+:
+next(),
+schemeIndex(kMy_NoScheme)
+{
+	next.fill(kMy_NoTransition);
+}// My_MatcherNode default constructor
+
+
+/*!
+Follows the trie from the start of the given text, and
+returns the index of the first scheme that matches (with
+its length), or "kMy_NoScheme".
+
+(2021.06)
+*/
+SInt16
+My_Matcher::
+matchScheme		(UniChar const*		inBegin,
+				 UniChar const*		inPastEnd,
+				 UInt16&			outLength)
+const
+{
+	SInt16		result = kMy_NoScheme;
+	size_t		nodeIndex = 0;
+	
+	
+	for (UniChar const* charPtr = inBegin; charPtr != inPastEnd; ++charPtr)
+	{
+		SInt16 const	kSymbol = returnSchemeSymbol(*charPtr);
+		
+		
+		if (kMy_NotSchemeSymbol == kSymbol)
+		{
+			break;
+		}
+		nodeIndex = this->nodes[nodeIndex].next[kSymbol];
+		if (kMy_NoTransition == nodeIndex)
+		{
+			break;
+		}
+		if (kMy_NoScheme != this->nodes[nodeIndex].schemeIndex)
+		{
+			result = this->nodes[nodeIndex].schemeIndex;
+			outLength = STATIC_CAST(charPtr - inBegin + 1, UInt16);
+			break;
+		}
+	}
+	return result;
+}// My_Matcher::matchScheme
+
+
+/*!
+Creates an empty table with the given number of slots.
+
+(2021.06)
+*/
+My_URITable::
+My_URITable		(UInt16		inCapacity)
+:
+idsByURI(),
+uriBySlot(inCapacity),
+idBySlot(inCapacity, 0),
+nextID(1)
+{
+}// My_URITable 1-argument constructor
+
+
+/*!
+Returns true only if the given character is a letter or
+digit (or any character outside ASCII); a link must have
+at least one of these after its scheme.
+
+(2021.06)
+*/
+Boolean
+isLinkBodyCharacter		(UniChar	inCharacter)
+{
+	return ((inCharacter >= 0x80) || std::isalnum(inCharacter));
+}// isLinkBodyCharacter
+
+
+/*!
+Returns true only if the given character can be part of
+a link that was found by scanning.  Spaces (including
+non-breaking spaces), control characters and characters
+that RFC 3986 does not allow in a URI (such as quotation
+marks and angle brackets, which often surround links)
+end a link.
+
+(2021.06)
+*/
+Boolean
+isLinkCharacter		(UniChar	inCharacter)
+{
+	Boolean		result = true;
+	
+	
+	if ((inCharacter <= ' ') || ((inCharacter >= 0x7F) && (inCharacter <= 0xA0)))
+	{
+		result = false;
+	}
+	else if (inCharacter < 0x80)
+	{
+		result = (nullptr == std::strchr("\"<>\\^`{|}", STATIC_CAST(inCharacter, char)));
+	}
+	return result;
+}// isLinkCharacter
+
+
+/*!
+Returns true only if the given character is punctuation
+that is assumed to belong to the surrounding text when it
+ends a link (such as the period at the end of a sentence).
+
+(2021.06)
+*/
+Boolean
+isLinkTrailer	(UniChar	inCharacter)
+{
+	return ((inCharacter < 0x80) && (nullptr != std::strchr(".,:;!?'*", STATIC_CAST(inCharacter, char))));
+}// isLinkTrailer
+
+
+/*!
+Returns the index of the given character in the alphabet
+of schemes (letters in either case, then digits, then
+"+", "-", "." and ":"), or "kMy_NotSchemeSymbol".
+
+(2021.06)
+*/
+SInt16
+returnSchemeSymbol	(UniChar	inCharacter)
+{
+	SInt16		result = kMy_NotSchemeSymbol;
+	
+	
+	if ((inCharacter >= 'a') && (inCharacter <= 'z'))
+	{
+		result = (inCharacter - 'a');
+	}
+	else if ((inCharacter >= 'A') && (inCharacter <= 'Z'))
+	{
+		result = (inCharacter - 'A');
+	}
+	else if ((inCharacter >= '0') && (inCharacter <= '9'))
+	{
+		result = (26 + inCharacter - '0');
+	}
+	else if ('+' == inCharacter)
+	{
+		result = 36;
+	}
+	else if ('-' == inCharacter)
+	{
+		result = 37;
+	}
+	else if ('.' == inCharacter)
+	{
+		result = 38;
+	}
+	else if (':' == inCharacter)
+	{
+		result = 39;
+	}
+	return result;
+}// returnSchemeSymbol
+
+
+/*!
+Given a link from the start of the text to the given end,
+returns the end after removing trailing punctuation and
+any closing parenthesis or bracket that has no partner in
+the link.  The result is never less than the given body
+start (the length of the scheme).
+
+(2021.06)
+*/
+UInt16
+returnTrimmedEnd	(UniChar const*		inLinkText,
+					 UInt16				inBodyStart,
+					 UInt16				inPastEnd)
+{
+	UInt16		result = inPastEnd;
+	Boolean		isTrimmed = true;
+	
+	
+	while (isTrimmed && (result > inBodyStart))
+	{
+		UniChar const	kLast = inLinkText[result - 1];
+		
+		
+		isTrimmed = isLinkTrailer(kLast);
+		if ((false == isTrimmed) && ((')' == kLast) || (']' == kLast)))
+		{
+			UniChar const	kOpening = ((')' == kLast) ? '(' : '[');
+			
+			
+			isTrimmed = (std::count(inLinkText, inLinkText + result, kOpening) <
+							std::count(inLinkText, inLinkText + result, kLast));
+		}
+		if (isTrimmed)
+		{
+			--result;
+		}
+	}
+	return result;
+}// returnTrimmedEnd
+
+
+/*!
+Finds the links in the given ASCII text and returns them
+as "start-end:scheme" separated by spaces, for tests.
+
+(2021.06)
+*/
+std::string
+returnTestLinks		(LinkScanner_MatcherRef		inMatcher,
+					 char const*				inText)
+{
+	std::vector< UniChar >	text(inText, inText + std::strlen(inText));
+	LinkScanner_SpanList	spans;
+	std::string				result;
+	
+	
+	LinkScanner_FindLinks(inMatcher, text.data(), STATIC_CAST(text.size(), UInt16), spans);
+	for (auto const& span : spans)
+	{
+		if (false == result.empty())
+		{
+			result += ' ';
+		}
+		result += std::to_string(span.startIndex) + '-' + std::to_string(span.pastTheEndIndex) + ':' + std::to_string(span.schemeIndex);
+	}
+	return result;
+}// returnTestLinks
+
+
+/*!
+Tests finding links in text: schemes that share prefixes,
+word boundaries, case, and the end of a link.
+
+Returns "true" if ALL assertions pass; "false" is
+returned if any fail, however messages should be
+printed for ALL assertion failures regardless.
+
+(2021.06)
+*/
+Boolean
+unitTest000_Begin ()
+{
+	char const*				schemes[] = { "http:", "https:", "ssh:", "sftp:", "x-man-page:", nullptr };
+	LinkScanner_MatcherRef	matcher = LinkScanner_NewMatcher(schemes);
+	std::string				links;
+	Boolean					result = true;
+	
+	
+	Console_TestAssertUpdate(result, nullptr != matcher, Console_WriteLine, "matcher was not created");
+	
+	links = returnTestLinks(matcher, "see http://a.com/x and https://b.org");
+	Console_TestAssertUpdate(result, "4-18:0 23-36:1" == links, Console_WriteValueStdString, "two links", links);
+	links = returnTestLinks(matcher, "ssh://host sftp://host x-man-page://ls");
+	Console_TestAssertUpdate(result, "0-10:2 11-22:3 23-38:4" == links, Console_WriteValueStdString, "other schemes", links);
+	links = returnTestLinks(matcher, "HTTP://A.COM");
+	Console_TestAssertUpdate(result, "0-12:0" == links, Console_WriteValueStdString, "uppercase scheme", links);
+	links = returnTestLinks(matcher, "xhttp://a 1http://a http: ftp://a http//a");
+	Console_TestAssertUpdate(result, links.empty(), Console_WriteValueStdString, "not links", links);
+	links = returnTestLinks(matcher, "url=http://a;b|x");
+	Console_TestAssertUpdate(result, "4-14:0" == links, Console_WriteValueStdString, "link after punctuation", links);
+	links = returnTestLinks(matcher, "\"http://a\" <http://b>");
+	Console_TestAssertUpdate(result, "1-9:0 12-20:0" == links, Console_WriteValueStdString, "quoted links", links);
+	LinkScanner_DisposeMatcher(&matcher);
+	Console_TestAssertUpdate(result, nullptr == matcher, Console_WriteLine, "matcher was not cleared");
+	
+	{
+		char const*		invalidSchemes[] = { "http:", "ht tp:", nullptr };
+		char const*		uppercaseSchemes[] = { "HTTP:", nullptr };
+		char const*		noColonSchemes[] = { "http", nullptr };
+		
+		
+		Console_TestAssertUpdate(result, nullptr == LinkScanner_NewMatcher(invalidSchemes), Console_WriteLine, "scheme with a space was accepted");
+		Console_TestAssertUpdate(result, nullptr == LinkScanner_NewMatcher(uppercaseSchemes), Console_WriteLine, "uppercase scheme was accepted");
+		Console_TestAssertUpdate(result, nullptr == LinkScanner_NewMatcher(noColonSchemes), Console_WriteLine, "scheme without a colon was accepted");
+	}
+	
+	return result;
+}// unitTest000_Begin
+
+
+/*!
+Tests the removal of punctuation from the end of links,
+and LinkScanner_ReturnSchemeAtStart().
+
+Returns "true" if ALL assertions pass; "false" is
+returned if any fail, however messages should be
+printed for ALL assertion failures regardless.
+
+(2021.06)
+*/
+Boolean
+unitTest001_Begin ()
+{
+	char const*				schemes[] = { ":", "file:", "http:", nullptr };
+	LinkScanner_MatcherRef	matcher = LinkScanner_NewMatcher(schemes);
+	std::string				links;
+	Boolean					result = true;
+	
+	
+	links = returnTestLinks(matcher, "Go to http://a.com/x.");
+	Console_TestAssertUpdate(result, "6-20:2" == links, Console_WriteValueStdString, "period at end", links);
+	links = returnTestLinks(matcher, "(see http://a.com/x), or http://w/A_(b)!");
+	Console_TestAssertUpdate(result, "5-19:2 25-39:2" == links, Console_WriteValueStdString, "parentheses", links);
+	links = returnTestLinks(matcher, "[http://a/[1]] http://...");
+	Console_TestAssertUpdate(result, "1-13:2" == links, Console_WriteValueStdString, "brackets and nothing but punctuation", links);
+	links = returnTestLinks(matcher, "file:///tmp/x: http: :x");
+	Console_TestAssertUpdate(result, "0-13:1" == links, Console_WriteValueStdString, "file link, empty links", links);
+	
+	{
+		char const	kText[] = "http://x";
+		char const	kEmptyLink[] = "http:";
+		char const	kColonOnly[] = ":x";
+		
+		
+		Console_TestAssertUpdate(result, 2 == LinkScanner_ReturnSchemeAtStart(matcher, kText, kText + 8),
+									Console_WriteValue, "scheme at start", LinkScanner_ReturnSchemeAtStart(matcher, kText, kText + 8));
+		Console_TestAssertUpdate(result, -1 == LinkScanner_ReturnSchemeAtStart(matcher, kEmptyLink, kEmptyLink + 5),
+									Console_WriteLine, "scheme alone should not match");
+		Console_TestAssertUpdate(result, 0 == LinkScanner_ReturnSchemeAtStart(matcher, kColonOnly, kColonOnly + 2),
+									Console_WriteLine, "empty scheme should match a colon");
+		Console_TestAssertUpdate(result, -1 == LinkScanner_ReturnSchemeAtStart(matcher, kText, kText),
+									Console_WriteLine, "empty text should not match");
+	}
+	LinkScanner_DisposeMatcher(&matcher);
+	
+	return result;
+}// unitTest001_Begin
+
+
+/*!
+Tests URI tables: the same URI has the same ID, and the
+oldest URI is forgotten when the table is full.
+
+Returns "true" if ALL assertions pass; "false" is
+returned if any fail, however messages should be
+printed for ALL assertion failures regardless.
+
+(2021.06)
+*/
+Boolean
+unitTest002_Begin ()
+{
+	LinkScanner_URITableRef		table = LinkScanner_NewURITable(2);
+	std::string					uri;
+	UInt32						idA = 0;
+	UInt32						idB = 0;
+	UInt32						idC = 0;
+	Boolean						result = true;
+	
+	
+	Console_TestAssertUpdate(result, 0 == LinkScanner_InternURI(table, ""), Console_WriteLine, "empty URI should have no ID");
+	idA = LinkScanner_InternURI(table, "http://a");
+	idB = LinkScanner_InternURI(table, "http://b");
+	Console_TestAssertUpdate(result, (0 != idA) && (0 != idB) && (idA != idB), Console_WriteValuePair, "IDs", idA, idB);
+	Console_TestAssertUpdate(result, idA == LinkScanner_InternURI(table, "http://a"), Console_WriteLine, "same URI should have the same ID");
+	Console_TestAssertUpdate(result, LinkScanner_GetURI(table, idB, uri) && ("http://b" == uri), Console_WriteValueStdString, "URI B", uri);
+	
+	// a third URI replaces the oldest one, whose ID is then invalid
+	idC = LinkScanner_InternURI(table, "http://c");
+	Console_TestAssertUpdate(result, (idC != idA) && (idC != idB), Console_WriteValue, "ID C", idC);
+	Console_TestAssertUpdate(result, false == LinkScanner_GetURI(table, idA, uri), Console_WriteValueStdString, "forgotten URI", uri);
+	Console_TestAssertUpdate(result, uri.empty(), Console_WriteLine, "string should be cleared for a forgotten URI");
+	Console_TestAssertUpdate(result, LinkScanner_GetURI(table, idC, uri) && ("http://c" == uri), Console_WriteValueStdString, "URI C", uri);
+	Console_TestAssertUpdate(result, idA != LinkScanner_InternURI(table, "http://a"), Console_WriteLine, "forgotten URI should have a new ID");
+	Console_TestAssertUpdate(result, false == LinkScanner_GetURI(table, 0, uri), Console_WriteLine, "ID 0 should have no URI");
+	LinkScanner_DisposeURITable(&table);
+	Console_TestAssertUpdate(result, nullptr == table, Console_WriteLine, "table was not cleared");
+	
+	return result;
+}// unitTest002_Begin
+
+} // anonymous namespace
+
+// BELOW IS REQUIRED NEWLINE TO END FILE
@@ -0,0 +1,148 @@
+/*!	\file LinkScanner.h
+	\brief Finds links in terminal text, and remembers the
+	targets of hyperlinks that applications define.
+	
+	A matcher is compiled once from a list of URL schemes
+	(such as "http:" and "ssh:") into a table-driven trie,
+	so that every scheme is tried in a single pass over the
+	text instead of comparing each scheme in turn.  A link
+	must start at a word boundary, and it continues until a
+	character that cannot appear in a link; punctuation at
+	the end is not included (unless it closes a parenthesis
+	or bracket that the link opened), so that links in
+	sentences do not include the period.
+	
+	A URI table gives each unique target of a hyperlink (as
+	defined by the "OSC 8" sequence) a number, so that every
+	cell of a link does not have to store the whole string.
+	Tables have a fixed capacity: when full, the oldest URI
+	is forgotten, and its number is never reused; a caller
+	that still has the old number simply finds no URI.
+	
+	Text is given in UniChar units, which the terminal also
+	uses for cells; link ranges are indices into the text.
+*/
+/*###############################################################
+
+	MacTerm
+		© 1998-2021 by Kevin Grant.
+		© 2001-2003 by Ian Anderson.
+		© 1986-1994 University of Illinois Board of Trustees
+		(see About box for full list of U of I contributors).
+	
+	This program is free software; you can redistribute it or
+	modify it under the terms of the GNU General Public License
+	as published by the Free Software Foundation; either version
+	2 of the License, or (at your option) any later version.
+	
+	This program is distributed in the hope that it will be
+	useful, but WITHOUT ANY WARRANTY; without even the implied
+	warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+	PURPOSE.  See the GNU General Public License for more
+	details.
+	
+	You should have received a copy of the GNU General Public
+	License along with this program; if not, write to:
+	
+		Free Software Foundation, Inc.
+		59 Temple Place, Suite 330
+		Boston, MA  02111-1307
+		USA
+
+###############################################################*/
+
+#include <UniversalDefines.h>
+
+#pragma once
+
+// standard-C++ includes
+#include <string>
+#include <vector>
+
+// Mac includes
+#include <CoreServices/CoreServices.h>
+
+
+
+#pragma mark Types
+
+typedef struct LinkScanner_OpaqueMatcher*		LinkScanner_MatcherRef;
+typedef struct LinkScanner_OpaqueURITable*		LinkScanner_URITableRef;
+
+/*!
+A link that was found in text.  The scheme index refers
+to the list that was given to LinkScanner_NewMatcher().
+*/
+struct LinkScanner_Span
+{
+	UInt16	startIndex;			//!< zero-based index of the first character of the link
+	UInt16	pastTheEndIndex;	//!< index after the last character of the link
+	UInt16	schemeIndex;		//!< which scheme the link starts with
+};
+typedef std::vector< LinkScanner_Span >		LinkScanner_SpanList;
+
+
+
+#pragma mark Public Methods
+
+//!\name Module Tests
+//@{
+
+void
+	LinkScanner_RunTests				();
+
+//@}
+
+//!\name Creating and Destroying Matchers
+//@{
+
+// SCHEMES ARE LOWERCASE AND END WITH A COLON (E.G. "http:"); THE LIST ENDS WITH nullptr
+LinkScanner_MatcherRef
+	LinkScanner_NewMatcher				(char const* const*			inSchemeNames);
+
+void
+	LinkScanner_DisposeMatcher			(LinkScanner_MatcherRef*	inoutRefPtr);
+
+//@}
+
+//!\name Finding Links
+//@{
+
+// REPLACES THE CONTENTS OF THE LIST; LINKS ARE IN ORDER AND NEVER OVERLAP
+void
+	LinkScanner_FindLinks				(LinkScanner_MatcherRef		inMatcher,
+										 UniChar const*				inText,
+										 UInt16						inLength,
+										 LinkScanner_SpanList&		outSpans);
+
+// RETURNS -1 UNLESS THE TEXT STARTS WITH A SCHEME AND HAS MORE AFTER IT
+SInt16
+	LinkScanner_ReturnSchemeAtStart		(LinkScanner_MatcherRef		inMatcher,
+										 char const*				inBegin,
+										 char const*				inPastEnd);
+
+//@}
+
+//!\name Remembering Hyperlink Targets
+//@{
+
+LinkScanner_URITableRef
+	LinkScanner_NewURITable				(UInt16						inCapacity);
+
+void
+	LinkScanner_DisposeURITable			(LinkScanner_URITableRef*	inoutRefPtr);
+
+// RETURNS false IF THE ID IS 0 OR THE URI HAS BEEN FORGOTTEN
+Boolean
+	LinkScanner_GetURI					(LinkScanner_URITableRef	inTable,
+										 UInt32						inID,
+										 std::string&				outURI);
+
+// RETURNS 0 FOR AN EMPTY URI; THE SAME URI HAS THE SAME ID (UNTIL IT IS FORGOTTEN)
+UInt32
+	LinkScanner_InternURI				(LinkScanner_URITableRef	inTable,
+										 std::string const&			inURI);
+
+//@}
+
+// BELOW IS REQUIRED NEWLINE TO END FILE
@@ -38,11 +38,15 @@
 // standard-C includes
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 
 // standard-C++ includes
+#include <algorithm>
 #include <map>
+#include <memory>
 #include <set>
 #include <string>
+#include <vector>
 
 // UNIX includes
 //struct pthread_rwlock_t;
@@ -53,9 +57,11 @@ extern "C"
 #	include <fcntl.h>
 #	include <grp.h>
 #	include <netdb.h>
+#	include <poll.h>
 #	include <pthread.h>
 #	include <pwd.h>
 #	include <signal.h>
+#	include <spawn.h>
 #	include <sysexits.h>
 #	include <termios.h>
 #	include <unistd.h>
@@ -68,6 +74,7 @@ extern "C"
 #	include <sys/types.h>
 #	include <sys/wait.h>
 #	include <util.h>
+	extern char**	environ;
 }
 
 // Mac includes (TEMPORARY)
@@ -81,6 +88,8 @@ extern "C"
 #include <Console.h>
 #include <MemoryBlockPtrLocker.template.h>
 #include <MemoryBlocks.h>
+#include <ProcessSpawn.h>
+#include <TraceSpan.h>
 
 // application includes
 #include "AppResources.h"
@@ -88,6 +97,7 @@ extern "C"
 #include "DebugInterface.h"
 #include "QuillsSession.h"
 #include "Session.h"
+#include "SessionServer.h"
 #include "Terminal.h"
 #include "UIStrings.h"
 
@@ -121,6 +131,11 @@ struct My_DataLoopThreadContext
 	SessionRef			session;
 	My_TTYMasterID		masterTTY;
 	size_t				blockSize;
+	CFAbsoluteTime		requestTime;		// when the user asked for the process (see threadForLocalProcessDataLoop())
+	Boolean				isWarmProcess;		// true if the process was started in advance (see Local_NewWarmProcess())
+	int					outputFD;			// where output is read; the same as "masterTTY" unless the session server runs the process
+	std::string			replayedOutput;		// output from the session server that is processed before anything is read
+	std::shared_ptr< UInt64 >	processedOutputOffset;	// if defined, total bytes of session server output that the session has processed
 };
 typedef My_DataLoopThreadContext*			My_DataLoopThreadContextPtr;
 typedef My_DataLoopThreadContext const*		My_DataLoopThreadContextConstPtr;
@@ -137,10 +152,13 @@ struct My_Process
 	pid_t				_processID;			// the process directly spawned by this session
 	Boolean				_stopped;			// true only if XOFF/suspend has occurred with no XON/resume yet
 	Local_TerminalID	_pseudoTerminal;	// file descriptor of pseudo-terminal master
-	char const*			_slaveDeviceName;	// e.g. "/dev/ttyp0", data sent here goes to the terminal emulator (not the process)
+	std::string			_slaveDeviceName;	// e.g. "/dev/ttyp0", data sent here goes to the terminal emulator (not the process)
 	CFRetainRelease		_commandLine;		// array of strings for parent process’ command line arguments (first is program name)
 	CFRetainRelease		_recentDirectory;	// empty until a query is done to determine the value
 	CFRetainRelease		_originalDirectory;	// empty if no chdir() was used, otherwise the chdir() value at spawn time
+	SessionServer_SessionID		_serverSessionID;		// unless invalid, the session server runs the process (see Local_SpawnDetachableProcess())
+	int							_serverOutputFD;		// copy of the output socket from the session server, used only to detach
+	std::shared_ptr< UInt64 >	_processedOutputOffset;	// total bytes of session server output that the session has processed
 };
 typedef My_Process*			My_ProcessPtr;
 typedef My_Process const*	My_ProcessConstPtr;
@@ -150,18 +168,45 @@ typedef std::map< pid_t, Local_ProcessRef >		My_ProcessByID;
 typedef MemoryBlockPtrLocker< Local_ProcessRef, My_Process >	My_ProcessPtrLocker;
 typedef LockAcquireRelease< Local_ProcessRef, My_Process >		My_ProcessAutoLocker;
 
+/*!
+Information retained about a process that was started before
+any session needed it.  Known externally as a
+Local_WarmProcessRef.
+*/
+struct My_WarmProcess
+{
+	CFRetainRelease		commandLine;		// array of strings for the command line (first is program name)
+	CFRetainRelease		workingDirectory;	// directory that the process started in
+	CFRetainRelease		terminalName;		// value of TERM for the process
+	My_TTYMasterID		masterTTY;			// file descriptor of pseudo-terminal master
+	std::string			slaveDeviceName;	// e.g. "/dev/ttys004"
+	pid_t				processID;			// the process that was spawned
+	CFAbsoluteTime		spawnTime;			// when the process was started
+};
+typedef My_WarmProcess*		My_WarmProcessPtr;
+
 } // anonymous namespace
 
 #pragma mark Internal Method Prototypes
 namespace {
 
 void			fillInTerminalControlStructure		(struct termios*);
+Local_Result	prepareProcessSpawn					(CFArrayRef, CFStringRef, CFStringRef, std::vector< std::string >&,
+													 std::vector< std::string >&, std::string&, CFRetainRelease&, struct termios&);
 void			printTerminalControlStructure		(struct termios const*);
 Local_Result	putTTYInOriginalMode				(Local_TerminalID);
 void			putTTYInOriginalModeAtExit			();
 Local_Result	putTTYInRawMode						(Local_TerminalID);
 void			receiveSignal						(int);
+SessionServer_ClientRef	returnSessionServerClient	(Boolean);
 Local_Result	sendTerminalResizeMessage			(Local_TerminalID, struct winsize const*);
+void			sessionServerRequestFailed			(SessionServer_Result);
+Local_Result	spawnProcessInPseudoTerminal		(CFArrayRef, CFStringRef, CFStringRef, UInt16, UInt16,
+													 CFRetainRelease&, My_TTYMasterID&, std::string&, pid_t&);
+Local_Result	startProcessDataLoop				(SessionRef, CFArrayRef, CFStringRef, My_TTYMasterID, char const*,
+													 pid_t, CFAbsoluteTime, Boolean, SessionServer_SessionID,
+													 SessionServer_Attachment*);
+Boolean			startSessionServer					(std::string const&);
 void			threadForLocalProcessDataLoop		(void*);
 
 } // anonymous namespace
@@ -179,12 +224,14 @@ Boolean						gPrintedRawMode = false; //!< true after the first console dump of
 Local_TerminalID			gTerminalToRestore = 0;
 My_UnixProcessIDSet&		gChildProcessIDs ()		{ static My_UnixProcessIDSet x; return x; }
 My_ProcessByID&				gProcessesByID ()		{ static My_ProcessByID x; return x; }
+SessionServer_ClientRef		gSessionServerClient = nullptr;	//!< connection to the server of detachable processes (see returnSessionServerClient())
+std::string&				gSessionServerPath ()	{ static std::string x; return x; } //!< program that is started if no session server is running
 sigset_t&					gSignalsBlockedInThreads	(Boolean	inBlock = true)
 							{
 								// call this from the main thread, to prevent any other thread from being
 								// chosen as the handler of signals, by setting a mask up front (any threads
-								// spawned hereafter will inherit the same mask); or, call this from a
-								// child process after a fork with "inBlock = false" to undo the changes
+								// spawned hereafter will inherit the same mask); processes started by
+								// spawnProcessInPseudoTerminal() do not inherit the mask
 								static sigset_t		x = 0;
 								
 								
@@ -428,6 +475,139 @@ Local_CheckForProcessExits ()
 }// CheckForProcessExits
 
 
+/*!
+Ends the connection of a session to a process that the session
+server runs (see Local_SpawnDetachableProcess()), WITHOUT ending
+the process; disposes of the data and sets your copy of the
+reference to nullptr.  The process keeps running until a later
+Local_SpawnProcessFromDetachedProcess() adopts it, or until it
+exits by itself.
+
+The given state (normally, from Terminal_SerializeState()) is
+kept by the server, along with the amount of output that the
+session has processed; so the session that reattaches starts
+with this state, and sees only output that the state lacks.
+
+If anything fails, the process reference is still valid (for
+instance, it can be given to Local_KillProcess()).
+
+\retval kLocal_ResultOK
+if the process is detached
+
+\retval kLocal_ResultParameterError
+if the reference is nullptr or the session server does not
+run the process
+
+\retval kLocal_ResultSocketError
+if the session server could not be told (for instance,
+because the process has already exited)
+
+(2021.06)
+*/
+Local_Result
+Local_DetachProcess		(Local_ProcessRef*				inoutRefPtr,
+						 std::vector< UInt8 > const&	inSavedState)
+{
+	Local_Result	result = kLocal_ResultOK;
+	
+	
+	if ((nullptr == inoutRefPtr) || (nullptr == *inoutRefPtr))
+	{
+		result = kLocal_ResultParameterError;
+	}
+	else
+	{
+		{
+			My_ProcessAutoLocker	ptr(gProcessPtrLocks(), *inoutRefPtr);
+			
+			
+			if (kSessionServer_InvalidSessionID == ptr->_serverSessionID)
+			{
+				result = kLocal_ResultParameterError;
+			}
+			else
+			{
+				// the server ends the output soon after this, which ends the
+				// loop of threadForLocalProcessDataLoop(); without any state,
+				// all of the output that the server still has is replayed
+				UInt64 const			kStateOffset = (inSavedState.empty()) ? 0 : *(ptr->_processedOutputOffset);
+				SessionServer_Result	serverResult = SessionServer_DetachOutput(ptr->_serverOutputFD, kStateOffset,
+																				std::string(inSavedState.begin(), inSavedState.end()));
+				
+				
+				if (kSessionServer_ResultOK != serverResult)
+				{
+					Console_Warning(Console_WriteValue, "unable to detach from process of session server, result", serverResult);
+					result = kLocal_ResultSocketError;
+				}
+				else
+				{
+					Console_WriteValue("detached process ID", ptr->_processID);
+				}
+			}
+		}
+		
+		if (kLocal_ResultOK == result)
+		{
+			if (gProcessPtrLocks().isLocked(*inoutRefPtr))
+			{
+				Console_Warning(Console_WriteValue, "attempt to dispose of locked process data; outstanding locks",
+								gProcessPtrLocks().returnLockCount(*inoutRefPtr));
+			}
+			else
+			{
+				delete *(REINTERPRET_CAST(inoutRefPtr, My_ProcessPtr*)), *inoutRefPtr = nullptr;
+			}
+		}
+	}
+	return result;
+}// DetachProcess
+
+
+/*!
+Ends a process created with Local_NewWarmProcess() that is no
+longer needed: the process is hung up (as if its window had
+closed), its pseudo-terminal is closed, and the reference is
+set to nullptr.  The process is reaped later by
+Local_CheckForProcessExits(), without any notification.
+
+(2021.06)
+*/
+void
+Local_DisposeWarmProcess	(Local_WarmProcessRef*		inoutRefPtr)
+{
+	if (nullptr != inoutRefPtr)
+	{
+		My_WarmProcessPtr	ptr = REINTERPRET_CAST(*inoutRefPtr, My_WarmProcessPtr);
+		
+		
+		if (nullptr != ptr)
+		{
+			if ((ptr->processID > 0) && (-1 == kill(ptr->processID, SIGHUP)))
+			{
+				int const	kActualError = errno;
+				
+				
+				// ignore “no such process” errors
+				if (ESRCH != kActualError)
+				{
+					Console_Warning(Console_WriteValue, "unable to hang up warm process: Unix error", kActualError);
+				}
+			}
+			if (-1 == close(ptr->masterTTY))
+			{
+				int const	kActualError = errno;
+				
+				
+				Console_Warning(Console_WriteValue, "failed to close the master TTY of warm process, errno", kActualError);
+			}
+			delete ptr;
+		}
+		*inoutRefPtr = nullptr;
+	}
+}// DisposeWarmProcess
+
+
 /*!
 Constructs a command line based on the current user’s
 preferred shell, or the "SHELL" environment variable if
@@ -469,6 +649,62 @@ Local_GetDefaultShellCommandLine	(CFArrayRef&	outNewArgumentsArray)
 }// GetDefaultShellCommandLine
 
 
+/*!
+Returns the IDs of all processes of the session server that
+are still running but have no session attached (for instance,
+because Local_DetachProcess() was used, or because an earlier
+instance of this application quit).  Any of them can be given
+to Local_SpawnProcessFromDetachedProcess().
+
+This never starts the session server.
+
+\retval kLocal_ResultOK
+if the list is complete (it may be empty)
+
+\retval kLocal_ResultSocketError
+if no session server is running (so there are no processes)
+
+(2021.06)
+*/
+Local_Result
+Local_GetDetachedProcesses	(std::vector< Local_DetachedProcessID >&	outProcessIDs)
+{
+	SessionServer_ClientRef		client = returnSessionServerClient(false/* start if necessary */);
+	Local_Result				result = kLocal_ResultOK;
+	
+	
+	outProcessIDs.clear();
+	if (nullptr == client)
+	{
+		result = kLocal_ResultSocketError;
+	}
+	else
+	{
+		std::vector< SessionServer_SessionInfo >	sessions;
+		SessionServer_Result						serverResult = SessionServer_ClientListSessions(client, sessions);
+		
+		
+		if (kSessionServer_ResultOK != serverResult)
+		{
+			Console_Warning(Console_WriteValue, "unable to list processes of session server, result", serverResult);
+			sessionServerRequestFailed(serverResult);
+			result = kLocal_ResultSocketError;
+		}
+		else
+		{
+			for (auto const&	info : sessions)
+			{
+				if ((info.isRunning) && (0 == info.attachedClientCount))
+				{
+					outProcessIDs.push_back(info.sessionID);
+				}
+			}
+		}
+	}
+	return result;
+}// GetDetachedProcesses
+
+
 /*!
 Constructs a command line of "/usr/bin/login -p -f $USER"
 for whatever the current user’s ID is, allocating a new
@@ -510,6 +746,11 @@ The given process’ ID is not allowed to be less than
 or equal to zero, as this has special significance
 to the system (kills multiple processes).
 
+If the session server runs the process (see the routine
+Local_SpawnDetachableProcess()), the server kills it.  To
+keep such a process running instead, use the routine
+Local_DetachProcess().
+
 (3.1)
 */
 void
@@ -522,7 +763,26 @@ Local_KillProcess	(Local_ProcessRef*	inoutRefPtr)
 		
 		if (nullptr != ptr)
 		{
-			if (ptr->_processID > 0)
+			if (kSessionServer_InvalidSessionID != ptr->_serverSessionID)
+			{
+				// the session server is the parent of the process, so it
+				// must end it (and it does not start, just to do that)
+				SessionServer_ClientRef		client = returnSessionServerClient(false/* start if necessary */);
+				
+				
+				if (nullptr != client)
+				{
+					SessionServer_Result	serverResult = SessionServer_ClientKillSession(client, ptr->_serverSessionID);
+					
+					
+					if (kSessionServer_ResultOK != serverResult)
+					{
+						Console_Warning(Console_WriteValue, "unable to kill process of session server, result", serverResult);
+						sessionServerRequestFailed(serverResult);
+					}
+				}
+			}
+			else if (ptr->_processID > 0)
 			{
 				int		killResult = kill(ptr->_processID, SIGKILL);
 				
@@ -563,6 +823,79 @@ Local_KillProcess	(Local_ProcessRef*	inoutRefPtr)
 }// KillProcess
 
 
+/*!
+Starts the given command line in a new pseudo-terminal before
+any session needs it, so that a later session can use the
+process immediately (see Local_SpawnProcessFromWarmProcess()).
+The process starts in the user’s home directory.  Its output
+(typically a shell prompt) waits in the pseudo-terminal until
+a session reads it.
+
+The terminal name and size are used in the same way as the
+emulator name and screen size of the container given to
+Local_SpawnProcess(); the size is updated when the process is
+adopted by a session.
+
+\retval kLocal_ResultOK
+if the process was created successfully
+
+\retval kLocal_ResultParameterError
+if the argument array is empty or the home directory is not
+found
+
+\retval kLocal_ResultForkError
+if the process cannot be spawned
+
+(2021.06)
+*/
+Local_Result
+Local_NewWarmProcess	(CFArrayRef				inArgumentArray,
+						 CFStringRef			inTerminalName,
+						 UInt16					inColumnCount,
+						 UInt16					inRowCount,
+						 Local_WarmProcessRef&	outProcess)
+{
+	My_WarmProcessPtr	ptr = new My_WarmProcess();
+	Local_Result		result = kLocal_ResultOK;
+	
+	
+	outProcess = nullptr;
+	ptr->spawnTime = CFAbsoluteTimeGetCurrent();
+	result = spawnProcessInPseudoTerminal(inArgumentArray, nullptr/* working directory */, inTerminalName,
+											inColumnCount, inRowCount, ptr->workingDirectory,
+											ptr->masterTTY, ptr->slaveDeviceName, ptr->processID);
+	if (kLocal_ResultOK != result)
+	{
+		delete ptr;
+	}
+	else
+	{
+		ptr->commandLine.setWithRetain(inArgumentArray);
+		ptr->terminalName.setWithRetain(inTerminalName);
+		outProcess = REINTERPRET_CAST(ptr, Local_WarmProcessRef);
+	}
+	return result;
+}// NewWarmProcess
+
+
+/*!
+Returns true only if the session server runs the specified
+process (see Local_SpawnDetachableProcess()), so that it can
+be given to Local_DetachProcess().
+
+(2021.06)
+*/
+Boolean
+Local_ProcessIsDetachable	(Local_ProcessRef	inProcess)
+{
+	My_ProcessAutoLocker	ptr(gProcessPtrLocks(), inProcess);
+	Boolean					result = (kSessionServer_InvalidSessionID != ptr->_serverSessionID);
+	
+	
+	return result;
+}// ProcessIsDetachable
+
+
 /*!
 Returns true only if the terminal associated with the specified
 process is apparently waiting for password input.  This can be
@@ -719,7 +1052,7 @@ Local_ProcessReturnSlaveDeviceName		(Local_ProcessRef	inProcess)
 	char const*				result = nullptr;
 	
 	
-	result = ptr->_slaveDeviceName;
+	result = ptr->_slaveDeviceName.c_str();
 	return result;
 }// ProcessReturnSlaveDeviceName
 
@@ -743,7 +1076,121 @@ Local_ProcessReturnUnixID	(Local_ProcessRef	inProcess)
 
 
 /*!
-Forks a new process and arranges for its output and input to be
+Specifies the program to start when a detachable process is
+needed and no session server is running (normally, the program
+"MacTermSessionServer" from the bundle); see the routine
+Local_SpawnDetachableProcess().  If nullptr, no server starts.
+
+(2021.06)
+*/
+void
+Local_SetSessionServerPath	(char const*	inPathOrNull)
+{
+	gSessionServerPath() = (nullptr != inPathOrNull) ? inPathOrNull : "";
+}// SetSessionServerPath
+
+
+/*!
+Like Local_SpawnProcess(), except that the session server runs
+the process (see "SessionServer.h"), starting the server first
+if necessary; so the process can keep running after its session
+ends (see Local_DetachProcess()), even if this application quits.
+
+The process has exactly the same command line, environment,
+working directory and terminal modes that Local_SpawnProcess()
+would give it, and the session writes input and resizes its
+pseudo-terminal directly; only output comes from the server.
+
+\retval kLocal_ResultOK
+if the process was created successfully
+
+\retval kLocal_ResultParameterError
+if the argument array is empty, or the given working directory
+does not exist
+
+\retval kLocal_ResultSocketError
+if the session server cannot be started or reached
+
+\retval kLocal_ResultForkError
+if the session server cannot spawn the process
+
+(2021.06)
+*/
+Local_Result
+Local_SpawnDetachableProcess	(SessionRef			inUninitializedSession,
+								 TerminalScreenRef	inContainer,
+								 CFArrayRef			inArgumentArray,
+								 CFStringRef		inWorkingDirectoryOrNull)
+{
+	CFAbsoluteTime const		kRequestTime = CFAbsoluteTimeGetCurrent();
+	std::vector< std::string >	arguments;
+	std::vector< std::string >	environmentSettings;
+	std::string					targetDir;
+	CFRetainRelease				workingDirectory;
+	struct termios				terminalControl;
+	Local_Result				result = prepareProcessSpawn(inArgumentArray, inWorkingDirectoryOrNull,
+																Terminal_EmulatorReturnName(inContainer),
+																arguments, environmentSettings, targetDir, workingDirectory,
+																terminalControl);
+	
+	
+	if (kLocal_ResultOK == result)
+	{
+		SessionServer_ClientRef		client = returnSessionServerClient(true/* start if necessary */);
+		
+		
+		if (nullptr == client)
+		{
+			result = kLocal_ResultSocketError;
+		}
+		else
+		{
+			SessionServer_SessionID		sessionID = kSessionServer_InvalidSessionID;
+			SessionServer_Attachment	attachment;
+			SessionServer_Result		serverResult = SessionServer_ClientCreateSession
+														(client, arguments, environmentSettings, targetDir.c_str(),
+															&terminalControl, Terminal_ReturnColumnCount(inContainer),
+															Terminal_ReturnRowCount(inContainer), sessionID);
+			
+			
+			if (kSessionServer_ResultOK == serverResult)
+			{
+				serverResult = SessionServer_ClientAttach(client, sessionID, attachment);
+				if (kSessionServer_ResultOK != serverResult)
+				{
+					// do not leave behind a process that no session can find
+					UNUSED_RETURN(SessionServer_Result)SessionServer_ClientKillSession(client, sessionID);
+				}
+			}
+			
+			if (kSessionServer_ResultOK != serverResult)
+			{
+				Console_Warning(Console_WriteValue, "unable to spawn process in session server, result", serverResult);
+				sessionServerRequestFailed(serverResult);
+				result = (kSessionServer_ResultSpawnError == serverResult)
+							? kLocal_ResultForkError
+							: kLocal_ResultSocketError;
+			}
+			else
+			{
+				Console_WriteValue("spawned process ID (session server)", attachment.processID);
+				
+				// prevent threads from being the receivers of signals
+				gSignalsBlockedInThreads();
+				
+				result = startProcessDataLoop(inUninitializedSession, inArgumentArray, workingDirectory.returnCFStringRef(),
+												attachment.terminalFD, attachment.deviceName.c_str(), attachment.processID,
+												kRequestTime, false/* is warm process */, sessionID, &attachment);
+			}
+		}
+	}
+	
+	return result;
+}// SpawnDetachableProcess
+
+
+/*!
+Starts a new process and arranges for its output and input to be
 channeled through the specified screen.  The Unix command line is
 defined using the given argument array, the first element of
 which must either be a program name (resolved by the PATH) or
@@ -752,10 +1199,14 @@ a POSIX pathname to the location of the program to run.
 The specified session’s data will be updated with whatever
 information is available for the created process.
 
-The specified working directory is targeted only in the child
+The specified working directory is targeted only in the new
 process, meaning the caller’s working directory is unchanged.
-If it is not possible to change to that directory, the child
-process exits as a precaution.
+If it is not possible to change to that directory, the process
+is not started, as a precaution.
+
+This process is never forked (see the internal routine
+spawnProcessInPseudoTerminal()), so the time to start a
+process does not grow with the memory use of MacTerm.
 
 \retval kLocal_ResultOK
 if the process was created successfully
@@ -783,384 +1234,267 @@ Local_SpawnProcess	(SessionRef			inUninitializedSession,
 					 CFArrayRef			inArgumentArray,
 					 CFStringRef		inWorkingDirectoryOrNull)
 {
-	CFStringEncoding const	kPathEncoding = kCFStringEncodingUTF8;
-	CFIndex const			kArgumentCount = CFArrayGetCount(inArgumentArray);
-	char**					argvCopy = new char*[1 + kArgumentCount];
-	char const*				targetDir = nullptr;
-	CFRetainRelease			targetDirCFString(inWorkingDirectoryOrNull, CFRetainRelease::kNotYetRetained);
-	Boolean					deleteTargetDir = false;
+	CFAbsoluteTime const	kRequestTime = CFAbsoluteTimeGetCurrent();
+	CFRetainRelease			workingDirectory;
+	My_TTYMasterID			masterTTY = 0;
+	std::string				slaveDeviceName;
+	pid_t					processID = -1;
 	Local_Result			result = kLocal_ResultOK;
 	
 	
-	if (kArgumentCount > 0)
-	{					
-		// construct an argument array of the form expected by the system call
-		CFStringEncoding const	kArgumentEncoding = kCFStringEncodingUTF8;
-		UInt16					j = 0;
-		
-		
-		for (UInt16 i = 0; i < kArgumentCount; ++i)
-		{
-			CFStringRef		argumentCFString = CFUtilities_StringCast
-												(CFArrayGetValueAtIndex(inArgumentArray, i));
-			
-			
-			// ignore completely empty strings (generally caused by
-			// a bad split on multiple whitespace characters)
-			if (CFStringGetLength(argumentCFString) > 0)
-			{
-				size_t const	kBufferSize = 1 + CFStringGetMaximumSizeForEncoding
-													(CFStringGetLength(argumentCFString), kArgumentEncoding);
-				
-				
-				// this memory is not leaked because execvp() is about to occur
-				argvCopy[j] = new char[kBufferSize];
-				CFStringGetCString(argumentCFString, argvCopy[j], kBufferSize, kArgumentEncoding);
-				++j;
-			}
-		}
-		argvCopy[j] = nullptr;
+	result = spawnProcessInPseudoTerminal(inArgumentArray, inWorkingDirectoryOrNull, Terminal_EmulatorReturnName(inContainer),
+											Terminal_ReturnColumnCount(inContainer), Terminal_ReturnRowCount(inContainer),
+											workingDirectory, masterTTY, slaveDeviceName, processID);
+	if (kLocal_ResultOK == result)
+	{
+		result = startProcessDataLoop(inUninitializedSession, inArgumentArray, workingDirectory.returnCFStringRef(),
+										masterTTY, slaveDeviceName.c_str(), processID, kRequestTime, false/* is warm process */,
+										kSessionServer_InvalidSessionID, nullptr/* attachment */);
 	}
 	
-	// determine the directory to be in when the command is run
-	if ((false == targetDirCFString.exists()) || (0 == CFStringGetLength(targetDirCFString.returnCFStringRef())))
+	// with the preemptive thread handling data transfer
+	// to and from the process, return immediately
+	return result;
+}// SpawnProcess
+
+
+/*!
+A convenient way for other modules to call system()
+without including any Unix headers.
+
+\retval kLocal_ResultOK
+if the process was created successfully
+
+\retval kLocal_ResultParameterError
+if the command is nullptr
+
+\retval kLocal_ResultForkError
+if the process cannot be spawned
+
+(3.1)
+*/
+Local_Result
+Local_SpawnProcessAndWaitForTermination		(char const*	inCommand)
+{
+	Local_Result	result = kLocal_ResultOK;
+	
+	
+	if (nullptr == inCommand) result = kLocal_ResultParameterError;
+	else
 	{
-		struct passwd*	userInfoPtr = getpwuid(getuid());
+		int		commandResult = system(inCommand);
 		
 		
-		if (nullptr != userInfoPtr)
+		// the result will be 127 if a shell cannot be invoked;
+		// any nonzero value is an error of some kind, as defined
+		// by the shell that is run
+		if (0 != commandResult)
 		{
-			targetDir = userInfoPtr->pw_dir;
-		}
-		else
-		{
-			// revert to the $HOME method, which usually works but is less reliable...
-			targetDir = getenv("HOME");
-		}
-		
-		targetDirCFString.setWithNoRetain(CFStringCreateWithCString(kCFAllocatorDefault, targetDir, kPathEncoding));
-	}
-	else
-	{
-		// convert path to a form that is accepted by chdir()
-		targetDir = CFStringGetCStringPtr(targetDirCFString.returnCFStringRef(), kPathEncoding);
-		if (nullptr == targetDir)
-		{
-			size_t const	kBufferSize = 1 + CFStringGetMaximumSizeForEncoding
-												(CFStringGetLength(targetDirCFString.returnCFStringRef()),
-													kPathEncoding);
-			char*			valueString = new char[kBufferSize];
-			
-			
-			CFStringGetCString(targetDirCFString.returnCFStringRef(), valueString, kBufferSize, kPathEncoding);
-			targetDir = valueString;
-			deleteTargetDir = true;
+			result = kLocal_ResultForkError;
 		}
 	}
 	
-	// require any target working directory to exist before bothering to
-	// spawn the process; note that this is only a slight optimization
-	// to save time in the case of common failures, and is NOT meant to
-	// be the only validation ever performed (for example, even after
-	// this check, the directory might disappear before the process is
-	// spawned; the only way to really know it will work is to use it!!!)
-	if (kLocal_ResultOK == result)
-	{
-		struct stat		dirInfo;
-		
-		
-		bzero(&dirInfo, sizeof(dirInfo));
-		
-		// NOTE: stat() follows symbolic links implicitly, so a link to a
-		// directory will still be considered a directory and not a link
-		if (0 != stat(targetDir, &dirInfo))
-		{
-			Console_WriteValueCString("failed to stat target working directory", targetDir);
-			result = kLocal_ResultParameterError;
-		}
-		else if (S_ISDIR(dirInfo.st_mode))
-		{
-			// this is OK, a directory is what is required!
-			result = kLocal_ResultOK;
-		}
-		else
-		{
-			Console_WriteValueCString("target working directory is not a directory", targetDir);
-			result = kLocal_ResultParameterError;
-		}
-	}
+	return result;
+}// SpawnProcessAndWaitForTermination
+
+
+/*!
+Gives the specified session a process of the session server
+that no session is attached to (see the routines
+Local_GetDetachedProcesses() and Local_DetachProcess()).
+
+If the process was detached from a session that saved its
+state, the given screen is restored from that state (see
+Terminal_DeserializeState()), and then it processes all of the
+output that the state does not include; so the screen appears
+as if the process had never been detached.  The pseudo-terminal
+is then resized to match the screen.
+
+\retval kLocal_ResultOK
+if the session now owns the process
+
+\retval kLocal_ResultParameterError
+if the session server does not have the given process
+
+\retval kLocal_ResultSocketError
+if the session server cannot be reached
+
+(2021.06)
+*/
+Local_Result
+Local_SpawnProcessFromDetachedProcess	(SessionRef					inUninitializedSession,
+										 TerminalScreenRef			inContainer,
+										 Local_DetachedProcessID	inProcessID)
+{
+	CFAbsoluteTime const		kRequestTime = CFAbsoluteTimeGetCurrent();
+	SessionServer_ClientRef		client = returnSessionServerClient(false/* start if necessary */);
+	Local_Result				result = kLocal_ResultOK;
+	
 	
-	if ((nullptr == inArgumentArray) || (kArgumentCount < 1) || (nullptr == argvCopy[0]))
+	if (nullptr == client)
 	{
-		result = kLocal_ResultParameterError;
+		result = kLocal_ResultSocketError;
 	}
-	else if (kLocal_ResultOK == result)
+	else
 	{
-		My_TTYMasterID		masterTTY = 0;
-		char				slaveDeviceName[20/* arbitrary */];
-		pid_t				processID = -1;
-		struct termios		terminalControl;
+		std::vector< SessionServer_SessionInfo >	sessions;
+		SessionServer_Attachment					attachment;
+		CFRetainRelease								argumentArray(CFArrayCreateMutable(kCFAllocatorDefault, 0/* capacity */,
+																					&kCFTypeArrayCallBacks),
+																	CFRetainRelease::kAlreadyRetained);
+		SessionServer_Result						serverResult = SessionServer_ClientListSessions(client, sessions);
 		
 		
-		// set the answer-back message
+		// the command line is only for display, so it is acceptable
+		// that arguments with spaces appear to be split
+		if (kSessionServer_ResultOK == serverResult)
 		{
-			CFStringRef		answerBackCFString = Terminal_EmulatorReturnName(inContainer);
-			
-			
-			if (nullptr != answerBackCFString)
+			serverResult = kSessionServer_ResultNoSuchSession;
+			for (auto const&	info : sessions)
 			{
-				size_t const	kAnswerBackSize = CFStringGetLength(answerBackCFString) + 1/* terminator */;
-				char*			answerBackCString = new char[kAnswerBackSize];
-				
-				
-				if (CFStringGetCString(answerBackCFString, answerBackCString, kAnswerBackSize, kCFStringEncodingASCII))
+				if (inProcessID == info.sessionID)
 				{
-					UNUSED_RETURN(int)setenv("TERM", answerBackCString, true/* overwrite */);
+					std::string::size_type		wordStart = 0;
+					
+					
+					while (wordStart < info.commandLine.size())
+					{
+						std::string::size_type const	kWordEnd = std::min(info.commandLine.find(' ', wordStart), info.commandLine.size());
+						CFRetainRelease					wordCFString(CFStringCreateWithBytes(kCFAllocatorDefault,
+																								REINTERPRET_CAST(info.commandLine.data() + wordStart, UInt8 const*),
+																								STATIC_CAST(kWordEnd - wordStart, CFIndex),
+																								kCFStringEncodingUTF8, false/* is external representation */),
+																		CFRetainRelease::kAlreadyRetained);
+						
+						
+						if (wordCFString.exists())
+						{
+							CFArrayAppendValue(argumentArray.returnCFMutableArrayRef(), wordCFString.returnCFStringRef());
+						}
+						wordStart = kWordEnd + 1;
+					}
+					serverResult = kSessionServer_ResultOK;
 				}
-				delete [] answerBackCString;
 			}
 		}
 		
-		// Apple’s Terminal sets the variables TERM_PROGRAM and
-		// TERM_PROGRAM_VERSION for some reason; it is possible
-		// that scripts could start to rely on these, so it seems
-		// harmless enough to set them correctly for MacTerm
+		if (kSessionServer_ResultOK == serverResult)
 		{
-			CFBundleRef		mainBundle = AppResources_ReturnBundleForInfo();
-			CFStringRef		valueCFString = nullptr;
-			
-			
-			valueCFString = CFUtilities_StringCast
-							(CFBundleGetValueForInfoDictionaryKey(mainBundle, kCFBundleNameKey));
-			if (nullptr != valueCFString)
-			{
-				size_t const	kStringSize = CFStringGetLength(valueCFString) + 1/* terminator */;
-				char*			valueCString = new char[kStringSize];
-				
-				
-				if (CFStringGetCString(valueCFString, valueCString, kStringSize, kCFStringEncodingASCII))
-				{
-					UNUSED_RETURN(int)setenv("TERM_PROGRAM", valueCString, true/* overwrite */);
-				}
-				delete [] valueCString;
-			}
-			valueCFString = CFUtilities_StringCast
-							(CFBundleGetValueForInfoDictionaryKey(mainBundle, kCFBundleVersionKey));
-			if (nullptr != valueCFString)
-			{
-				size_t const	kStringSize = CFStringGetLength(valueCFString) + 1/* terminator */;
-				char*			valueCString = new char[kStringSize];
-				
-				
-				if (CFStringGetCString(valueCFString, valueCString, kStringSize, kCFStringEncodingASCII))
-				{
-					UNUSED_RETURN(int)setenv("TERM_PROGRAM_VERSION", valueCString, true/* overwrite */);
-				}
-				delete [] valueCString;
-			}
+			serverResult = SessionServer_ClientAttach(client, inProcessID, attachment);
 		}
 		
-		// TEMPORARY - the UNIX structures are filled in with defaults that work,
-		//             but eventually MacTerm has to map user preferences, etc.
-		//             to these so that they affect “local” terminals in the same
-		//             way as they affect remote ones
-		std::memset(&terminalControl, 0, sizeof(terminalControl));
-		fillInTerminalControlStructure(&terminalControl); // TEMP
-		
-		// spawn a child process attached to a pseudo-terminal device; the child
-		// will be used to run the shell, and the shell’s I/O will be handled in
-		// a separate preemptive thread by MacTerm’s awesome terminal emulator
-		// and main event loop
+		if (kSessionServer_ResultOK != serverResult)
 		{
-			struct winsize		terminalSize; // defined in "/usr/include/sys/ttycom.h"
-			
-			
-			terminalSize.ws_col = Terminal_ReturnColumnCount(inContainer);
-			terminalSize.ws_row = Terminal_ReturnRowCount(inContainer);
-			
-			// TEMPORARY; the TerminalView_GetTheoreticalScreenDimensions() API would be useful for this
-			terminalSize.ws_xpixel = 0;	// terminal width, in pixels; UNKNOWN
-			terminalSize.ws_ypixel = 0;	// terminal height, in pixels; UNKNOWN
-			
-			if (gInDebuggingMode && DebugInterface_LogsTeletypewriterState())
-			{
-				// in debugging mode, show the terminal configuration
-				Console_WriteLine("printing initial terminal configuration for process");
-				printTerminalControlStructure(&terminalControl);
-			}
-			
-			processID = forkpty(&masterTTY, slaveDeviceName, &terminalControl, &terminalSize);
+			Console_Warning(Console_WriteValue, "unable to attach to process of session server, result", serverResult);
+			sessionServerRequestFailed(serverResult);
+			result = (kSessionServer_ResultNoSuchSession == serverResult)
+						? kLocal_ResultParameterError
+						: kLocal_ResultSocketError;
 		}
-		
-		if (-1 == processID) result = kLocal_ResultForkError;
 		else
 		{
-			if (0 == processID)
+			unless (attachment.savedState.empty())
 			{
-				//
-				// this is executed inside the child process; note that any
-				// console print-outs at this point will actually go to the
-				// child terminal (rendered by a MacTerm window!)
-				//
+				// the state must be 8-byte aligned (see Terminal_DeserializeState())
+				size_t const				kStateSize = attachment.savedState.size();
+				std::vector< UInt64 >		alignedState((kStateSize + sizeof(UInt64) - 1) / sizeof(UInt64), 0);
+				Terminal_Result				terminalResult = kTerminal_ResultOK;
 				
-				// IMPORTANT: There are limitations on what a child process can do.
-				// For example, global data and framework calls are generally unsafe.
-				// See the "fork" man page for more information.
 				
-				// undo the effects on signals, because the user might be running
-				// a program like "bash" that inherits signal behavior from the
-				// parent; if this step were not performed, then "bash" would do
-				// odd things like ignore all control-C (interrupt) sequences
-				gSignalsBlockedInThreads(false);
-				
-				// set the current working directory...abort if this fails
-				// because presumably it is important that a command not
-				// start in the wrong directory
-				if (0 != chdir(targetDir))
+				std::memcpy(alignedState.data(), attachment.savedState.data(), kStateSize);
+				terminalResult = Terminal_DeserializeState(inContainer, alignedState.data(), kStateSize);
+				if (kTerminal_ResultOK != terminalResult)
 				{
-					Console_WriteValueCString("aborting, failed to chdir(), target directory", targetDir);
-					exit(EX_NOINPUT); // could abort(), but an exit() is easier to report gracefully to the user
+					// the replay still shows the most recent output
+					Console_Warning(Console_WriteValue, "unable to restore state of detached process, terminal error", terminalResult);
 				}
-				
-				// run a Unix terminal-based application program; this is accomplished
-				// using an execvp() call, which DOES NOT RETURN UNLESS there is an
-				// error; technically the return value is -1 on error, but really it’s
-				// a problem if any return value is received, so never exit with a 0
-				// in this situation!
-				UNUSED_RETURN(int)execvp(argvCopy[0], argvCopy); // should not return
-				
-				// almost no chance this line will be run, but if it does, just kill the child process
-				Console_WriteLine("aborting, failed to exec()");
-				exit(EX_UNAVAILABLE); // could abort(), but an exit() is easier to report gracefully to the user
 			}
-			
-			//
-			// this is executed inside the parent process
-			//
-			
-			Console_WriteValue("spawned process ID", processID);
-			
-			// prevent threads from being the receivers of signals
-			gSignalsBlockedInThreads();
-			
-			// avoid special processing of data, allow the terminal to see it all (raw mode)
-			if (0)
+			unless (attachment.isReplayComplete)
 			{
-				// arrange for user’s TTY to be fixed at exit time
-				gTerminalToRestore = STDIN_FILENO;
-				if (-1 == atexit(putTTYInOriginalModeAtExit))
-				{
-					int const		kActualError = errno;
-					
-					
-					Console_Warning(Console_WriteValue, "unable to register atexit() routine for TTY mode", kActualError);
-				}
-				
-				// set user’s TTY to raw mode
-				{
-					Local_Result	rawSwitchResult = putTTYInRawMode(gTerminalToRestore);
-					
-					
-					if (kLocal_ResultOK != rawSwitchResult)
-					{
-						Console_Warning(Console_WriteValue, "error entering TTY raw-mode", rawSwitchResult);
-					}
-				}
+				Console_WriteLine("session server discarded some older output of the detached process");
 			}
 			
-			// start a thread for data processing so that MacTerm’s main event loop can still run
-			auto	threadContextPtr = new My_DataLoopThreadContext();
-			if (nullptr == threadContextPtr) result = kLocal_ResultInsufficientBufferSpace;
-			else
+			// the process may have been detached from a window of another size;
+			// this also sends SIGWINCH so that the display can be redrawn
+			if (attachment.terminalFD >= 0)
 			{
-				// store process information for session
-				{
-					auto				newProcessPtr = new My_Process(inArgumentArray,
-																		targetDirCFString.returnCFStringRef(),
-																		masterTTY, slaveDeviceName, processID);
-					Local_ProcessRef	newProcess = REINTERPRET_CAST(newProcessPtr, Local_ProcessRef);
-					
-					
-					Session_SetProcess(inUninitializedSession, newProcess);
-				}
-				
-				// set up context
-				static int		gQueueCounter = 0;
-				char			nameBuffer[256];
-				char const*		queueName = nameBuffer;
-				auto			formatStatus = snprintf(nameBuffer, sizeof(nameBuffer), "net.macterm.queues.sessions.%d", (int)++gQueueCounter);
-				
-				
-				if (formatStatus < 0)
-				{
-					Console_Warning(Console_WriteValue, "unable to create formatted string for terminal queue name, error", formatStatus);
-					queueName = nullptr;
-				}
-				threadContextPtr->dispatchQueue = dispatch_queue_create(queueName, DISPATCH_QUEUE_CONCURRENT);
-				threadContextPtr->session = inUninitializedSession;
-				threadContextPtr->masterTTY = masterTTY;
-				threadContextPtr->blockSize = 4096; // TEMPORARY; could make this a user preference
-				
-				// put the session in the initialized state, to indicate it is complete
-				Session_SetState(threadContextPtr->session, kSession_StateInitialized);
-				
-				// create and run thread with data-processing loop
-				dispatch_async_f(threadContextPtr->dispatchQueue, STATIC_CAST(threadContextPtr, void*), threadForLocalProcessDataLoop);
+				UNUSED_RETURN(Local_Result)Local_TerminalResize(attachment.terminalFD, Terminal_ReturnColumnCount(inContainer),
+																Terminal_ReturnRowCount(inContainer), 0/* pixel width */,
+																0/* pixel height */);
 			}
+			
+			Console_WriteValue("reattached process ID", attachment.processID);
+			result = startProcessDataLoop(inUninitializedSession, argumentArray.returnCFArrayRef(), CFSTR("")/* working directory */,
+											attachment.terminalFD, attachment.deviceName.c_str(), attachment.processID,
+											kRequestTime, false/* is warm process */, inProcessID, &attachment);
 		}
 	}
-	
-	// WARNING: this cleanup is not exception-safe, and should change
-	delete [] argvCopy, argvCopy = nullptr;
-	if (deleteTargetDir)
-	{
-		delete [] targetDir, targetDir = nullptr;
-	}
-	
-	// with the preemptive thread handling data transfer
-	// to and from the process, return immediately
 	return result;
-}// SpawnProcess
+}// SpawnProcessFromDetachedProcess
 
 
 /*!
-A convenient way for other modules to call system()
-without including any Unix headers.
+Like Local_SpawnProcess(), except that the process is one that
+was already started by Local_NewWarmProcess(); so the session
+sees its first output (such as a shell prompt) immediately.
+The pseudo-terminal is resized to match the given screen, and
+the warm process reference is set to nullptr because it now
+belongs to the session.
+
+Use Local_WarmProcessIsCompatible() first, to ensure that the
+process is running the command that the session requires.
 
 \retval kLocal_ResultOK
-if the process was created successfully
+if the session now owns the process
 
 \retval kLocal_ResultParameterError
-if the command is nullptr
+if the warm process reference is nullptr
 
-\retval kLocal_ResultForkError
-if the process cannot be spawned
+\retval kLocal_ResultInsufficientBufferSpace
+if the session data cannot be allocated
 
-(3.1)
+(2021.06)
 */
 Local_Result
-Local_SpawnProcessAndWaitForTermination		(char const*	inCommand)
+Local_SpawnProcessFromWarmProcess	(SessionRef				inUninitializedSession,
+									 TerminalScreenRef		inContainer,
+									 Local_WarmProcessRef*	inoutWarmProcessPtr)
 {
-	Local_Result	result = kLocal_ResultOK;
+	CFAbsoluteTime const	kRequestTime = CFAbsoluteTimeGetCurrent();
+	Local_Result			result = kLocal_ResultOK;
 	
 	
-	if (nullptr == inCommand) result = kLocal_ResultParameterError;
+	if ((nullptr == inoutWarmProcessPtr) || (nullptr == *inoutWarmProcessPtr))
+	{
+		result = kLocal_ResultParameterError;
+	}
 	else
 	{
-		int		commandResult = system(inCommand);
+		My_WarmProcessPtr	ptr = REINTERPRET_CAST(*inoutWarmProcessPtr, My_WarmProcessPtr);
 		
 		
-		// the result will be 127 if a shell cannot be invoked;
-		// any nonzero value is an error of some kind, as defined
-		// by the shell that is run
-		if (0 != commandResult)
+		// the process may have been started with a different screen size;
+		// this also sends SIGWINCH so that the prompt can be redrawn
+		UNUSED_RETURN(Local_Result)Local_TerminalResize(ptr->masterTTY, Terminal_ReturnColumnCount(inContainer),
+														Terminal_ReturnRowCount(inContainer), 0/* pixel width */,
+														0/* pixel height */);
+		
+		Console_WriteValue("adopted warm process ID", ptr->processID);
+		Console_WriteValue("warm process age (milliseconds)", STATIC_CAST((kRequestTime - ptr->spawnTime) * 1000.0, SInt32));
+		result = startProcessDataLoop(inUninitializedSession, ptr->commandLine.returnCFArrayRef(),
+										ptr->workingDirectory.returnCFStringRef(), ptr->masterTTY,
+										ptr->slaveDeviceName.c_str(), ptr->processID, kRequestTime,
+										true/* is warm process */, kSessionServer_InvalidSessionID,
+										nullptr/* attachment */);
+		if (kLocal_ResultOK == result)
 		{
-			result = kLocal_ResultForkError;
+			// the session now owns the pseudo-terminal and the process
+			delete ptr;
+			*inoutWarmProcessPtr = nullptr;
 		}
 	}
-	
 	return result;
-}// SpawnProcessAndWaitForTermination
+}// SpawnProcessFromWarmProcess
 
 
 /*!
@@ -1500,6 +1834,70 @@ Local_UpdateCurrentDirectoryCache ()
 }// UpdateCurrentDirectoryCache
 
 
+/*!
+Returns true only if the given process, created by
+Local_NewWarmProcess(), runs the same command line in the
+same directory and with the same terminal name that a new
+session is asking for.  A working directory of nullptr or
+an empty string means the user’s home directory.
+
+(2021.06)
+*/
+Boolean
+Local_WarmProcessIsCompatible	(Local_WarmProcessRef	inProcess,
+								 CFArrayRef				inArgumentArray,
+								 CFStringRef			inWorkingDirectoryOrNull,
+								 CFStringRef			inTerminalName)
+{
+	My_WarmProcessPtr	ptr = REINTERPRET_CAST(inProcess, My_WarmProcessPtr);
+	Boolean				result = false;
+	
+	
+	if ((nullptr != ptr) && (nullptr != inArgumentArray) && (nullptr != inTerminalName))
+	{
+		result = (CFEqual(ptr->commandLine.returnCFArrayRef(), inArgumentArray) &&
+					CFEqual(ptr->terminalName.returnCFStringRef(), inTerminalName));
+		if (result && (nullptr != inWorkingDirectoryOrNull) && (CFStringGetLength(inWorkingDirectoryOrNull) > 0))
+		{
+			result = CFEqual(ptr->workingDirectory.returnCFStringRef(), inWorkingDirectoryOrNull);
+		}
+	}
+	return result;
+}// WarmProcessIsCompatible
+
+
+/*!
+Returns true only if the given process, created by
+Local_NewWarmProcess(), has not exited or hung up.
+
+(2021.06)
+*/
+Boolean
+Local_WarmProcessIsRunning	(Local_WarmProcessRef	inProcess)
+{
+	My_WarmProcessPtr	ptr = REINTERPRET_CAST(inProcess, My_WarmProcessPtr);
+	Boolean				result = false;
+	
+	
+	if ((nullptr != ptr) && (0 == kill(ptr->processID, 0/* only check that the process exists */)))
+	{
+		struct pollfd	pollInfo;
+		
+		
+		// a process that has exited may remain as a zombie for awhile,
+		// but the master side of its pseudo-terminal reports a hang-up
+		pollInfo.fd = ptr->masterTTY;
+		pollInfo.events = POLLIN;
+		pollInfo.revents = 0;
+		if (-1 != poll(&pollInfo, 1, 0/* timeout; do not wait */))
+		{
+			result = (0 == (pollInfo.revents & (POLLHUP | POLLERR | POLLNVAL)));
+		}
+	}
+	return result;
+}// WarmProcessIsRunning
+
+
 #pragma mark Internal Methods
 namespace {
 
@@ -1517,7 +1915,10 @@ _pseudoTerminal(inMasterTerminal),
 _slaveDeviceName(inSlaveDeviceName),
 _commandLine(inArgumentArray, CFRetainRelease::kNotYetRetained),
 _recentDirectory(CFSTR(""), CFRetainRelease::kNotYetRetained),
-_originalDirectory(inWorkingDirectory, CFRetainRelease::kNotYetRetained)
+_originalDirectory(inWorkingDirectory, CFRetainRelease::kNotYetRetained),
+_serverSessionID(kSessionServer_InvalidSessionID),
+_serverOutputFD(-1),
+_processedOutputOffset()
 {
 #if 0
 	Console_WriteLine("process created with argument array:");
@@ -1535,6 +1936,10 @@ My_Process::
 {
 	gChildProcessIDs().erase(_processID);
 	gProcessesByID().erase(_processID);
+	if (_serverOutputFD >= 0)
+	{
+		UNUSED_RETURN(int)close(_serverOutputFD), _serverOutputFD = -1;
+	}
 }// My_Process destructor
 
 
@@ -1655,6 +2060,8 @@ fillInTerminalControlStructure	(struct termios*	outTerminalControlPtr)
 }// fillInTerminalControlStructure
 
 
+
+
 /*!
 For debugging - prints the data in a UNIX "termios"
 structure.
@@ -1926,6 +2333,43 @@ receiveSignal	(int	UNUSED_ARGUMENT(inSignal))
 }// receiveSignal
 
 
+/*!
+Returns the connection to the session server (see the routine
+Local_SpawnDetachableProcess()), connecting first if necessary.
+If no server is running and the flag is set, the server is
+started (see startSessionServer()) and this waits briefly for
+it to accept connections.  Returns nullptr on failure.
+
+(2021.06)
+*/
+SessionServer_ClientRef
+returnSessionServerClient	(Boolean	inStartIfNecessary)
+{
+	if (nullptr == gSessionServerClient)
+	{
+		std::string const		kSocketPath = SessionServer_ReturnDefaultSocketPath();
+		SessionServer_Result	connectResult = kSessionServer_ResultOK;
+		
+		
+		gSessionServerClient = SessionServer_NewClient(kSocketPath.c_str(), connectResult);
+		if ((nullptr == gSessionServerClient) && (inStartIfNecessary) && startSessionServer(kSocketPath))
+		{
+			// the new server needs a moment to create its socket
+			for (UInt16 i = 0; ((nullptr == gSessionServerClient) && (i < 40/* arbitrary; 2 seconds */)); ++i)
+			{
+				UNUSED_RETURN(int)usleep(50000/* microseconds */);
+				gSessionServerClient = SessionServer_NewClient(kSocketPath.c_str(), connectResult);
+			}
+			if (nullptr == gSessionServerClient)
+			{
+				Console_Warning(Console_WriteValue, "unable to connect to new session server, result", connectResult);
+			}
+		}
+	}
+	return gSessionServerClient;
+}// returnSessionServerClient
+
+
 /*!
 Internal version of Local_TerminalResize().
 
@@ -1959,11 +2403,514 @@ sendTerminalResizeMessage   (Local_TerminalID			inTTY,
 }// sendTerminalResizeMessage
 
 
+/*!
+Responds to a failed request of the session server: if the
+connection was lost (for instance, because the server was
+ended), it is closed so that the next request reconnects
+(see returnSessionServerClient()).
+
+(2021.06)
+*/
+void
+sessionServerRequestFailed	(SessionServer_Result	inResult)
+{
+	if (kSessionServer_ResultDisconnected == inResult)
+	{
+		SessionServer_DisposeClient(&gSessionServerClient);
+	}
+}// sessionServerRequestFailed
+
+
+/*!
+Prepares everything that a new process needs in order to
+run the given command line (see Local_SpawnProcess() for
+details on the arguments and results): the arguments, the
+settings that are added to the environment (such as TERM,
+from the given terminal name), the directory to start in
+(the user’s home directory if no directory was given) and
+the initial modes of the pseudo-terminal.
+
+This is shared by spawnProcessInPseudoTerminal() and by
+Local_SpawnDetachableProcess(), so that a process has the
+same environment whether or not the session server runs it.
+
+(2021.06)
+*/
+Local_Result
+prepareProcessSpawn		(CFArrayRef						inArgumentArray,
+						 CFStringRef					inWorkingDirectoryOrNull,
+						 CFStringRef					inTerminalNameOrNull,
+						 std::vector< std::string >&	outArguments,
+						 std::vector< std::string >&	outEnvironmentSettings,
+						 std::string&					outTargetDir,
+						 CFRetainRelease&				outWorkingDirectory,
+						 struct termios&				outTerminalControl)
+{
+	CFStringEncoding const		kPathEncoding = kCFStringEncodingUTF8;
+	CFIndex const				kArgumentCount = (nullptr != inArgumentArray) ? CFArrayGetCount(inArgumentArray) : 0;
+	CFRetainRelease				targetDirCFString(inWorkingDirectoryOrNull, CFRetainRelease::kNotYetRetained);
+	Local_Result				result = kLocal_ResultOK;
+	
+	
+	outArguments.clear();
+	outEnvironmentSettings.clear();
+	
+	// construct an argument array of the form expected by the system call
+	for (CFIndex i = 0; i < kArgumentCount; ++i)
+	{
+		CFStringRef		argumentCFString = CFUtilities_StringCast
+											(CFArrayGetValueAtIndex(inArgumentArray, i));
+		
+		
+		// ignore completely empty strings (generally caused by
+		// a bad split on multiple whitespace characters)
+		if (CFStringGetLength(argumentCFString) > 0)
+		{
+			size_t const	kBufferSize = 1 + CFStringGetMaximumSizeForEncoding
+												(CFStringGetLength(argumentCFString), kCFStringEncodingUTF8);
+			std::vector< char >		buffer(kBufferSize, '\0');
+			
+			
+			if (CFStringGetCString(argumentCFString, buffer.data(), kBufferSize, kCFStringEncodingUTF8))
+			{
+				outArguments.push_back(buffer.data());
+			}
+		}
+	}
+	
+	// determine the directory to be in when the command is run
+	if ((false == targetDirCFString.exists()) || (0 == CFStringGetLength(targetDirCFString.returnCFStringRef())))
+	{
+		struct passwd*	userInfoPtr = getpwuid(getuid());
+		
+		
+		if (nullptr != userInfoPtr)
+		{
+			outTargetDir = userInfoPtr->pw_dir;
+		}
+		else
+		{
+			// revert to the $HOME method, which usually works but is less reliable...
+			char const*		homeDir = getenv("HOME");
+			
+			
+			outTargetDir = (nullptr != homeDir) ? homeDir : "/";
+		}
+		
+		targetDirCFString.setWithNoRetain(CFStringCreateWithCString(kCFAllocatorDefault, outTargetDir.c_str(), kPathEncoding));
+	}
+	else
+	{
+		// convert path to a form that is accepted by chdir()
+		size_t const			kBufferSize = 1 + CFStringGetMaximumSizeForEncoding
+												(CFStringGetLength(targetDirCFString.returnCFStringRef()),
+													kPathEncoding);
+		std::vector< char >		buffer(kBufferSize, '\0');
+		
+		
+		CFStringGetCString(targetDirCFString.returnCFStringRef(), buffer.data(), kBufferSize, kPathEncoding);
+		outTargetDir = buffer.data();
+	}
+	
+	// require any target working directory to exist before bothering to
+	// spawn the process; note that this is only a slight optimization
+	// to save time in the case of common failures, and is NOT meant to
+	// be the only validation ever performed (for example, even after
+	// this check, the directory might disappear before the process is
+	// spawned; the only way to really know it will work is to use it!!!)
+	if (kLocal_ResultOK == result)
+	{
+		struct stat		dirInfo;
+		
+		
+		bzero(&dirInfo, sizeof(dirInfo));
+		
+		// NOTE: stat() follows symbolic links implicitly, so a link to a
+		// directory will still be considered a directory and not a link
+		if (0 != stat(outTargetDir.c_str(), &dirInfo))
+		{
+			Console_WriteValueCString("failed to stat target working directory", outTargetDir.c_str());
+			result = kLocal_ResultParameterError;
+		}
+		else if (S_ISDIR(dirInfo.st_mode))
+		{
+			// this is OK, a directory is what is required!
+			result = kLocal_ResultOK;
+		}
+		else
+		{
+			Console_WriteValueCString("target working directory is not a directory", outTargetDir.c_str());
+			result = kLocal_ResultParameterError;
+		}
+	}
+	
+	if (outArguments.empty())
+	{
+		result = kLocal_ResultParameterError;
+	}
+	else if (kLocal_ResultOK == result)
+	{
+		// set the answer-back message
+		if (nullptr != inTerminalNameOrNull)
+		{
+			CFIndex const	kAnswerBackSize = CFStringGetLength(inTerminalNameOrNull) + 1/* terminator */;
+			std::vector< char >		answerBackCString(kAnswerBackSize, '\0');
+			
+			
+			if (CFStringGetCString(inTerminalNameOrNull, answerBackCString.data(), kAnswerBackSize, kCFStringEncodingASCII))
+			{
+				outEnvironmentSettings.push_back(std::string("TERM=") + answerBackCString.data());
+			}
+		}
+		
+		// Apple’s Terminal sets the variables TERM_PROGRAM and
+		// TERM_PROGRAM_VERSION for some reason; it is possible
+		// that scripts could start to rely on these, so it seems
+		// harmless enough to set them correctly for MacTerm
+		{
+			CFBundleRef		mainBundle = AppResources_ReturnBundleForInfo();
+			CFStringRef		valueCFString = nullptr;
+			
+			
+			valueCFString = CFUtilities_StringCast
+							(CFBundleGetValueForInfoDictionaryKey(mainBundle, kCFBundleNameKey));
+			if (nullptr != valueCFString)
+			{
+				CFIndex const			kStringSize = CFStringGetLength(valueCFString) + 1/* terminator */;
+				std::vector< char >		valueCString(kStringSize, '\0');
+				
+				
+				if (CFStringGetCString(valueCFString, valueCString.data(), kStringSize, kCFStringEncodingASCII))
+				{
+					outEnvironmentSettings.push_back(std::string("TERM_PROGRAM=") + valueCString.data());
+				}
+			}
+			valueCFString = CFUtilities_StringCast
+							(CFBundleGetValueForInfoDictionaryKey(mainBundle, kCFBundleVersionKey));
+			if (nullptr != valueCFString)
+			{
+				CFIndex const			kStringSize = CFStringGetLength(valueCFString) + 1/* terminator */;
+				std::vector< char >		valueCString(kStringSize, '\0');
+				
+				
+				if (CFStringGetCString(valueCFString, valueCString.data(), kStringSize, kCFStringEncodingASCII))
+				{
+					outEnvironmentSettings.push_back(std::string("TERM_PROGRAM_VERSION=") + valueCString.data());
+				}
+			}
+		}
+		
+		// TEMPORARY - the UNIX structures are filled in with defaults that work,
+		//             but eventually MacTerm has to map user preferences, etc.
+		//             to these so that they affect “local” terminals in the same
+		//             way as they affect remote ones
+		std::memset(&outTerminalControl, 0, sizeof(outTerminalControl));
+		fillInTerminalControlStructure(&outTerminalControl); // TEMP
+		
+		outWorkingDirectory.setWithRetain(targetDirCFString.returnCFStringRef());
+	}
+	
+	return result;
+}// prepareProcessSpawn
+
+
+/*!
+Starts a new process that runs the given command line,
+attached to a new pseudo-terminal device (see the routine
+Local_SpawnProcess() for details on the arguments and
+results).  The given terminal name is used for the TERM
+environment variable, and the size is the initial window
+size of the device.  The new device is not read until
+startProcessDataLoop() is called for it, so any output
+from the process waits in the device.
+
+The process is started with posix_spawn() (see the module
+"ProcessSpawn.h"), NOT fork(): this process is large and
+has many threads, so a fork() would take time in proportion
+to its memory use and would restrict what the child could
+safely do.  Everything the child needs is prepared first
+(see prepareProcessSpawn()).
+
+The working directory of the process is returned (the user’s
+home directory if no directory was given), along with the
+master device, slave device name and process ID.
+
+(2021.06)
+*/
+Local_Result
+spawnProcessInPseudoTerminal	(CFArrayRef			inArgumentArray,
+								 CFStringRef		inWorkingDirectoryOrNull,
+								 CFStringRef		inTerminalNameOrNull,
+								 UInt16				inColumnCount,
+								 UInt16				inRowCount,
+								 CFRetainRelease&	outWorkingDirectory,
+								 My_TTYMasterID&	outMasterTTY,
+								 std::string&		outSlaveDeviceName,
+								 pid_t&				outProcessID)
+{
+	std::vector< std::string >	arguments;
+	std::vector< std::string >	environmentSettings;
+	std::string					targetDir;
+	CFRetainRelease				workingDirectory;
+	struct termios				terminalControl;
+	Local_Result				result = prepareProcessSpawn(inArgumentArray, inWorkingDirectoryOrNull, inTerminalNameOrNull,
+																arguments, environmentSettings, targetDir, workingDirectory,
+																terminalControl);
+	
+	
+	if (kLocal_ResultOK == result)
+	{
+		ProcessSpawn_Process	process;
+		ProcessSpawn_Result		spawnResult = kProcessSpawn_ResultOK;
+		struct winsize			terminalSize; // defined in "/usr/include/sys/ttycom.h"
+		
+		
+		std::memset(&terminalSize, 0, sizeof(terminalSize));
+		terminalSize.ws_col = inColumnCount;
+		terminalSize.ws_row = inRowCount;
+		
+		// TEMPORARY; the TerminalView_GetTheoreticalScreenDimensions() API would be useful for this
+		terminalSize.ws_xpixel = 0;	// terminal width, in pixels; UNKNOWN
+		terminalSize.ws_ypixel = 0;	// terminal height, in pixels; UNKNOWN
+		
+		if (gInDebuggingMode && DebugInterface_LogsTeletypewriterState())
+		{
+			// in debugging mode, show the terminal configuration
+			Console_WriteLine("printing initial terminal configuration for process");
+			printTerminalControlStructure(&terminalControl);
+		}
+		
+		// start a process attached to a pseudo-terminal device; the process
+		// will be used to run the shell, and the shell’s I/O will be handled
+		// in a separate preemptive thread by MacTerm’s awesome terminal
+		// emulator and main event loop; note that the new process starts
+		// with no blocked signals, because the user might be running a
+		// program like "bash" that inherits signal behavior from the parent
+		// (otherwise "bash" would do odd things like ignore all control-C
+		// (interrupt) sequences)
+		spawnResult = ProcessSpawn_InPseudoTerminal(arguments, environmentSettings, targetDir.c_str(),
+													&terminalControl, &terminalSize, process);
+		if (kProcessSpawn_ResultOK != spawnResult)
+		{
+			Console_Warning(Console_WriteValue, "unable to spawn process, result", spawnResult);
+			result = (kProcessSpawn_ResultParameterError == spawnResult)
+						? kLocal_ResultParameterError
+						: kLocal_ResultForkError;
+		}
+		else
+		{
+			Console_WriteValue("spawned process ID", process.processID);
+			
+			// prevent threads from being the receivers of signals
+			gSignalsBlockedInThreads();
+			
+			// avoid special processing of data, allow the terminal to see it all (raw mode)
+			if (0)
+			{
+				// arrange for user’s TTY to be fixed at exit time
+				gTerminalToRestore = STDIN_FILENO;
+				if (-1 == atexit(putTTYInOriginalModeAtExit))
+				{
+					int const		kActualError = errno;
+					
+					
+					Console_Warning(Console_WriteValue, "unable to register atexit() routine for TTY mode", kActualError);
+				}
+				
+				// set user’s TTY to raw mode
+				{
+					Local_Result	rawSwitchResult = putTTYInRawMode(gTerminalToRestore);
+					
+					
+					if (kLocal_ResultOK != rawSwitchResult)
+					{
+						Console_Warning(Console_WriteValue, "error entering TTY raw-mode", rawSwitchResult);
+					}
+				}
+			}
+			
+			// return information about the new process
+			outWorkingDirectory.setWithRetain(workingDirectory.returnCFStringRef());
+			outMasterTTY = process.masterFD;
+			outSlaveDeviceName = process.slaveDeviceName;
+			outProcessID = process.processID;
+		}
+	}
+	
+	return result;
+}// spawnProcessInPseudoTerminal
+
+
+/*!
+Associates a process created by spawnProcessInPseudoTerminal()
+with the given session, and starts reading its pseudo-terminal
+device on a new queue (see threadForLocalProcessDataLoop()).
+The request time is used only to report how long the process
+took to produce its first output.
+
+If the session server runs the process, its session ID and
+attachment are given; then the output socket is read instead
+(after the replayed output, which is taken from the attachment),
+and the master device is used only for input.
+
+(2021.06)
+*/
+Local_Result
+startProcessDataLoop	(SessionRef					inSession,
+						 CFArrayRef					inArgumentArray,
+						 CFStringRef				inWorkingDirectory,
+						 My_TTYMasterID				inMasterTTY,
+						 char const*				inSlaveDeviceName,
+						 pid_t						inProcessID,
+						 CFAbsoluteTime				inRequestTime,
+						 Boolean					inIsWarmProcess,
+						 SessionServer_SessionID	inServerSessionID,
+						 SessionServer_Attachment*	inAttachmentOrNull)
+{
+	Local_Result	result = kLocal_ResultOK;
+	
+	
+	// start a thread for data processing so that MacTerm’s main event loop can still run
+	auto	threadContextPtr = new My_DataLoopThreadContext();
+	if (nullptr == threadContextPtr) result = kLocal_ResultInsufficientBufferSpace;
+	else
+	{
+		// store process information for session
+		{
+			auto				newProcessPtr = new My_Process(inArgumentArray, inWorkingDirectory,
+																inMasterTTY, inSlaveDeviceName, inProcessID);
+			Local_ProcessRef	newProcess = REINTERPRET_CAST(newProcessPtr, Local_ProcessRef);
+			
+			
+			threadContextPtr->outputFD = inMasterTTY;
+			if (nullptr != inAttachmentOrNull)
+			{
+				// the offset starts at the first byte of the replay, and counts
+				// every byte that the session processes (see Local_DetachProcess())
+				newProcessPtr->_serverSessionID = inServerSessionID;
+				newProcessPtr->_serverOutputFD = fcntl(inAttachmentOrNull->outputFD, F_DUPFD_CLOEXEC, 0);
+				newProcessPtr->_processedOutputOffset = std::make_shared< UInt64 >(inAttachmentOrNull->outputOffset -
+																					inAttachmentOrNull->replayedOutput.size());
+				threadContextPtr->outputFD = inAttachmentOrNull->outputFD;
+				threadContextPtr->replayedOutput.swap(inAttachmentOrNull->replayedOutput);
+				threadContextPtr->processedOutputOffset = newProcessPtr->_processedOutputOffset;
+			}
+			Session_SetProcess(inSession, newProcess);
+		}
+		
+		// set up context
+		static int		gQueueCounter = 0;
+		char			nameBuffer[256];
+		char const*		queueName = nameBuffer;
+		auto			formatStatus = snprintf(nameBuffer, sizeof(nameBuffer), "net.macterm.queues.sessions.%d", (int)++gQueueCounter);
+		
+		
+		if (formatStatus < 0)
+		{
+			Console_Warning(Console_WriteValue, "unable to create formatted string for terminal queue name, error", formatStatus);
+			queueName = nullptr;
+		}
+		threadContextPtr->dispatchQueue = dispatch_queue_create(queueName, DISPATCH_QUEUE_CONCURRENT);
+		threadContextPtr->session = inSession;
+		threadContextPtr->masterTTY = inMasterTTY;
+		threadContextPtr->blockSize = 4096; // TEMPORARY; could make this a user preference
+		threadContextPtr->requestTime = inRequestTime;
+		threadContextPtr->isWarmProcess = inIsWarmProcess;
+		
+		// put the session in the initialized state, to indicate it is complete
+		Session_SetState(threadContextPtr->session, kSession_StateInitialized);
+		
+		// create and run thread with data-processing loop
+		dispatch_async_f(threadContextPtr->dispatchQueue, STATIC_CAST(threadContextPtr, void*), threadForLocalProcessDataLoop);
+	}
+	
+	return result;
+}// startProcessDataLoop
+
+
+/*!
+Starts the session server program (see the routine
+Local_SetSessionServerPath()) to listen on the given socket,
+and returns true if it is running.  The server is a new
+session with no terminal, so it does not end when this
+application does; if another server is already running,
+the new one just exits.
+
+(2021.06)
+*/
+Boolean
+startSessionServer	(std::string const&		inSocketPath)
+{
+	Boolean		result = false;
+	
+	
+	if (gSessionServerPath().empty())
+	{
+		Console_Warning(Console_WriteLine, "session server not found; detachable processes are not available");
+	}
+	else
+	{
+		char const*					argumentPointers[] = { gSessionServerPath().c_str(), "--socket", inSocketPath.c_str(), nullptr };
+		posix_spawn_file_actions_t	fileActions;
+		posix_spawnattr_t			attributes;
+		sigset_t					noSignals;
+		sigset_t					allSignals;
+		pid_t						processID = -1;
+		int							spawnError = 0;
+		
+		
+		// the server must respond to SIGTERM even though this
+		// process blocks it (see gSignalsBlockedInThreads())
+		sigemptyset(&noSignals);
+		sigfillset(&allSignals);
+		sigdelset(&allSignals, SIGKILL);
+		sigdelset(&allSignals, SIGSTOP);
+		
+		posix_spawnattr_init(&attributes);
+		UNUSED_RETURN(int)posix_spawnattr_setsigmask(&attributes, &noSignals);
+		UNUSED_RETURN(int)posix_spawnattr_setsigdefault(&attributes, &allSignals);
+		UNUSED_RETURN(int)posix_spawnattr_setflags(&attributes, POSIX_SPAWN_SETSID | POSIX_SPAWN_SETSIGMASK | POSIX_SPAWN_SETSIGDEF
+																	| POSIX_SPAWN_CLOEXEC_DEFAULT);
+		posix_spawn_file_actions_init(&fileActions);
+		UNUSED_RETURN(int)posix_spawn_file_actions_addopen(&fileActions, STDIN_FILENO, "/dev/null", O_RDONLY, 0);
+		UNUSED_RETURN(int)posix_spawn_file_actions_addopen(&fileActions, STDOUT_FILENO, "/dev/null", O_WRONLY, 0);
+		UNUSED_RETURN(int)posix_spawn_file_actions_addopen(&fileActions, STDERR_FILENO, "/dev/null", O_WRONLY, 0);
+		
+		// the server is reaped by Local_CheckForProcessExits(), without
+		// any notification, if it ever exits while this process runs
+		spawnError = posix_spawn(&processID, argumentPointers[0], &fileActions, &attributes,
+									CONST_CAST(argumentPointers, char* const*), environ);
+		
+		posix_spawn_file_actions_destroy(&fileActions);
+		posix_spawnattr_destroy(&attributes);
+		
+		if (0 != spawnError)
+		{
+			Console_Warning(Console_WriteValue, "unable to start session server, error", spawnError);
+		}
+		else
+		{
+			Console_WriteValue("started session server, process ID", processID);
+			result = true;
+		}
+	}
+	return result;
+}// startSessionServer
+
+
 /*!
 This is the data processing loop for a particular
 pseudo-terminal device, and it runs on a dedicated
 concurrent queue.  See Local_SpawnProcess().
 
+If the session server runs the process, its replayed output
+is processed first, and then the output socket is read (see
+startProcessDataLoop()).
+
+The time from the request for the process to its first
+output is written to the console, so that the effect of
+warm processes can be seen (see Local_NewWarmProcess()).
+
 (2019.12)
 */
 void
@@ -1977,6 +2924,8 @@ threadForLocalProcessDataLoop	(void*		inDataLoopThreadContextPtr)
 	__block bool					endLoop = false;
 	__block UInt8*					processingBegin = bufferBegin;
 	UInt8*							processingPastEnd = processingBegin;
+	size_t							replayOffset = 0;
+	Boolean							isFirstRead = true;
 	
 	
 	for (;;)
@@ -1993,11 +2942,29 @@ threadForLocalProcessDataLoop	(void*		inDataLoopThreadContextPtr)
 		// the data that is in the buffer already.  If the processing
 		// buffer is smaller than the data buffer, then this loop will
 		// effectively stall reads until the processor catchs up.
-		if (processingPastEnd == processingBegin)
+		if ((processingPastEnd == processingBegin) && (replayOffset < contextPtr->replayedOutput.size()))
+		{
+			// the replay is processed in the same blocks as anything read
+			size_t const	kReplayBlockSize = std::min(kBufferSize, contextPtr->replayedOutput.size() - replayOffset);
+			
+			
+			std::memcpy(bufferBegin, contextPtr->replayedOutput.data() + replayOffset, kReplayBlockSize);
+			replayOffset += kReplayBlockSize;
+			processingBegin = bufferBegin;
+			processingPastEnd = processingBegin + kReplayBlockSize;
+		}
+		else if (processingPastEnd == processingBegin)
 		{
 			// each time through the loop, read a bit more data from the
 			// pseudo-terminal device, up to the maximum limit of the buffer
-			numberOfBytesRead = read(contextPtr->masterTTY, bufferBegin, kBufferSize);
+			// (the span includes any time spent waiting for the process)
+			{
+				TraceSpan_Scope("PTY read");
+				
+				
+				numberOfBytesRead = read(contextPtr->outputFD, bufferBegin, kBufferSize);
+				TraceSpan_SetByteCount(numberOfBytesRead);
+			}
 			
 			// TEMPORARY HACK - REMOVE HIGH ASCII
 			//for (unsigned char* foo = (unsigned char*)bufferBegin; (char*)foo != (bufferBegin + kBufferSize); ++foo) { if (*foo > 127) *foo = '?'; }
@@ -2009,6 +2976,20 @@ threadForLocalProcessDataLoop	(void*		inDataLoopThreadContextPtr)
 			}
 			else
 			{
+				if (isFirstRead)
+				{
+					// report the delay that the user sees before the first output
+					// (typically a prompt); this is the main benefit of warm processes
+					SInt32 const	kDelayInMilliseconds = STATIC_CAST((CFAbsoluteTimeGetCurrent() - contextPtr->requestTime) * 1000.0, SInt32);
+					
+					
+					isFirstRead = false;
+					Console_WriteValue((contextPtr->isWarmProcess)
+										? "time to first output from warm process (milliseconds)"
+										: "time to first output from process (milliseconds)",
+										kDelayInMilliseconds);
+				}
+				
 				// adjust the total number of bytes remaining to be processed
 				processingBegin = bufferBegin;
 				processingPastEnd = processingBegin + numberOfBytesRead;
@@ -2030,7 +3011,14 @@ threadForLocalProcessDataLoop	(void*		inDataLoopThreadContextPtr)
 								
 								if (sessionResult.ok())
 								{
-									processingBegin = (processingPastEnd - unprocessedSize);
+									UInt8* const	kNewProcessingBegin = (processingPastEnd - unprocessedSize);
+									
+									
+									if (nullptr != contextPtr->processedOutputOffset)
+									{
+										*(contextPtr->processedOutputOffset) += STATIC_CAST(kNewProcessingBegin - processingBegin, UInt64);
+									}
+									processingBegin = kNewProcessingBegin;
 								}
 								else
 								{
@@ -2041,7 +3029,13 @@ threadForLocalProcessDataLoop	(void*		inDataLoopThreadContextPtr)
 		}
 	}
 	
-	// loop terminated, ensure TTY is closed
+	// loop terminated, ensure TTY is closed (the session server
+	// gives no device for a process that has already exited)
+	if (contextPtr->outputFD != contextPtr->masterTTY)
+	{
+		UNUSED_RETURN(int)close(contextPtr->outputFD);
+	}
+	if (contextPtr->masterTTY >= 0)
 	{
 		int		sysResult = close(contextPtr->masterTTY);
 		
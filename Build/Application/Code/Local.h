@@ -38,6 +38,7 @@
 
 // standard-C++ includes
 #include <map>
+#include <vector>
 
 // UNIX includes
 extern "C"
@@ -64,7 +65,7 @@ enum
 {
 	kLocal_ResultOK							= 0,	//!< no error
 	kLocal_ResultParameterError				= 1,	//!< invalid input (e.g. null pointer provided)
-	kLocal_ResultForkError					= 2,	//!< fork() failed
+	kLocal_ResultForkError					= 2,	//!< the process could not be started (e.g. posix_spawn() failed)
 	kLocal_ResultThreadError				= 3,	//!< unable to create a thread
 	kLocal_ResultIOControlError				= 4,	//!< ioctl() failed
 	kLocal_ResultTermCapError				= 5,	//!< terminal capabilities interface routine failed
@@ -86,6 +87,10 @@ enum
 
 typedef struct Local_OpaqueProcess*		Local_ProcessRef;
 
+typedef struct Local_OpaqueWarmProcess*	Local_WarmProcessRef;	//!< a process started before any session needs it
+
+typedef UInt32							Local_DetachedProcessID;	//!< a process of the session server that no session is attached to
+
 typedef std::map< Local_ProcessRef, CFStringRef >	Local_PathByProcess;
 
 
@@ -112,6 +117,69 @@ Local_Result
 
 //@}
 
+//!\name Starting Processes in Advance
+//@{
+
+// PROCESS STARTS IN THE HOME DIRECTORY; ITS OUTPUT WAITS UNTIL Local_SpawnProcessFromWarmProcess()
+Local_Result
+	Local_NewWarmProcess					(CFArrayRef					inArgumentArray,
+											 CFStringRef				inTerminalName,
+											 UInt16						inColumnCount,
+											 UInt16						inRowCount,
+											 Local_WarmProcessRef&		outProcess);
+
+void
+	Local_DisposeWarmProcess				(Local_WarmProcessRef*		inoutRefPtr);
+
+// ON SUCCESS, THE SESSION OWNS THE PROCESS AND THE REFERENCE IS SET TO nullptr
+Local_Result
+	Local_SpawnProcessFromWarmProcess		(SessionRef					inUninitializedSession,
+											 TerminalScreenRef			inContainer,
+											 Local_WarmProcessRef*		inoutWarmProcessPtr);
+
+Boolean
+	Local_WarmProcessIsCompatible			(Local_WarmProcessRef		inProcess,
+											 CFArrayRef					inArgumentArray,
+											 CFStringRef				inWorkingDirectoryOrNull,
+											 CFStringRef				inTerminalName);
+
+Boolean
+	Local_WarmProcessIsRunning				(Local_WarmProcessRef		inProcess);
+
+//@}
+
+//!\name Detaching and Reattaching Processes
+//@{
+
+void
+	Local_SetSessionServerPath				(char const*				inPathOrNull);
+
+// SESSION SERVER RUNS THE PROCESS, SO IT CAN BE DETACHED; STARTS THE SERVER IF NECESSARY
+Local_Result
+	Local_SpawnDetachableProcess			(SessionRef					inUninitializedSession,
+											 TerminalScreenRef			inContainer,
+											 CFArrayRef					inArgumentArray,
+											 CFStringRef				inWorkingDirectoryOrNull = nullptr);
+
+Boolean
+	Local_ProcessIsDetachable				(Local_ProcessRef			inProcess);
+
+// PROCESS KEEPS RUNNING; ON SUCCESS, THE REFERENCE IS SET TO nullptr
+Local_Result
+	Local_DetachProcess						(Local_ProcessRef*			inoutRefPtr,
+											 std::vector< UInt8 > const&	inSavedState);
+
+// NEVER STARTS THE SESSION SERVER
+Local_Result
+	Local_GetDetachedProcesses				(std::vector< Local_DetachedProcessID >&	outProcessIDs);
+
+Local_Result
+	Local_SpawnProcessFromDetachedProcess	(SessionRef					inUninitializedSession,
+											 TerminalScreenRef			inContainer,
+											 Local_DetachedProcessID	inProcessID);
+
+//@}
+
 //!\name Manipulating Processes
 //@{
 
@@ -0,0 +1,856 @@
+/*!	\file PasteStream.cp
+	\brief Converts text to be pasted into a terminal into
+	chunks of bounded size, one at a time.
+*/
+/*###############################################################
+
+	MacTerm
+		© 1998-2021 by Kevin Grant.
+		© 2001-2003 by Ian Anderson.
+		© 1986-1994 University of Illinois Board of Trustees
+		(see About box for full list of U of I contributors).
+	
+	This program is free software; you can redistribute it or
+	modify it under the terms of the GNU General Public License
+	as published by the Free Software Foundation; either version
+	2 of the License, or (at your option) any later version.
+	
+	This program is distributed in the hope that it will be
+	useful, but WITHOUT ANY WARRANTY; without even the implied
+	warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+	PURPOSE.  See the GNU General Public License for more
+	details.
+	
+	You should have received a copy of the GNU General Public
+	License along with this program; if not, write to:
+	
+		Free Software Foundation, Inc.
+		59 Temple Place, Suite 330
+		Boston, MA  02111-1307
+		USA
+
+###############################################################*/
+
+#include "PasteStream.h"
+#include <UniversalDefines.h>
+
+// standard-C++ includes
+#include <algorithm>
+#include <string>
+#include <vector>
+
+// library includes
+#include <Console.h>
+
+
+
+#pragma mark Constants
+namespace {
+
+CFIndex const	kMy_SourceWindowLength = 1024;		//!< characters of the original text that are converted at a time
+CFIndex const	kMy_MarkerLength = 6;				//!< length of each bracketed-paste marker
+UniChar const	kMy_StartMarker[kMy_MarkerLength] = { 0x1B, '[', '2', '0', '0', '~' };	//!< ESC [ 2 0 0 ~
+UniChar const	kMy_EndMarker[kMy_MarkerLength] = { 0x1B, '[', '2', '0', '1', '~' };	//!< ESC [ 2 0 1 ~
+
+} // anonymous namespace
+
+#pragma mark Types
+namespace {
+
+/*!
+Internal representation of a PasteStream_Ref.  Only a
+small window of the original text is copied at a time.
+*/
+struct My_PasteStream
+{
+	My_PasteStream	(CFStringRef, UniChar const*, UInt16, PasteStream_Options);
+	~My_PasteStream	();
+	
+	Boolean
+	isComplete () const;
+	
+	Boolean
+	isMarkerAt	(CFIndex, UniChar const*);
+	
+	UniChar
+	returnCharacter		(CFIndex);
+	
+	CFIndex
+	returnNewLineLength		(CFIndex, UniChar);
+	
+	CFStringRef		sourceText;								//!< original text (retained)
+	CFIndex			sourceLength;							//!< number of UTF-16 units in the original text
+	CFIndex			sourceIndex;							//!< offset of the next character that has not been read
+	CFIndex			windowStart;							//!< offset in the original text of "window[0]"
+	CFIndex			windowLength;							//!< number of valid characters in "window"
+	UniChar			window[kMy_SourceWindowLength];			//!< copy of part of the original text
+	UniChar			newLine[kPasteStream_MaximumNewLineLength];	//!< replaces each new-line sequence
+	UInt16			newLineLength;							//!< number of valid characters in "newLine"
+	Boolean			isBracketed;							//!< if true, markers enclose the text
+	Boolean			isChunkPerLine;							//!< if true, a chunk ends after each new-line
+	Boolean			startMarkerPending;						//!< true until the start marker has been read
+	Boolean			endMarkerPending;						//!< true until the end marker has been read
+};
+typedef My_PasteStream*		My_PasteStreamPtr;
+
+} // anonymous namespace
+
+#pragma mark Internal Method Prototypes
+namespace {
+
+CFStringRef		newTestString			(char16_t const*);
+std::string		readTestChunks			(PasteStream_Ref, CFIndex, UInt32*);
+Boolean			unitTest000_Begin		();
+Boolean			unitTest001_Begin		();
+Boolean			unitTest002_Begin		();
+
+} // anonymous namespace
+
+
+
+#pragma mark Public Methods
+
+/*!
+A unit test for this module.  This should always
+be run before a release, after any substantial
+changes are made, or if you suspect bugs!  It
+should also be EXPANDED as new functionality is
+proposed (ideally, a test is written before the
+functionality is added).
+
+(2021.06)
+*/
+void
+PasteStream_RunTests ()
+{
+	UInt16		totalTests = 0;
+	UInt16		failedTests = 0;
+	
+	
+	++totalTests; if (false == unitTest000_Begin()) ++failedTests;
+	++totalTests; if (false == unitTest001_Begin()) ++failedTests;
+	++totalTests; if (false == unitTest002_Begin()) ++failedTests;
+	
+	Console_WriteUnitTestReport("Paste Stream", failedTests, totalTests);
+}// RunTests
+
+
+/*!
+Discards the text that has not been read yet, so that the
+stream completes early.  If the stream is bracketed and its
+start marker has been read, the next chunk is still the end
+marker, so that the application receiving the Paste knows
+that it has ended; if nothing has been read at all, there
+is nothing more to read.
+
+(2021.06)
+*/
+void
+PasteStream_Cancel	(PasteStream_Ref	inRef)
+{
+	My_PasteStreamPtr	ptr = REINTERPRET_CAST(inRef, My_PasteStreamPtr);
+	
+	
+	if (nullptr != ptr)
+	{
+		ptr->sourceIndex = ptr->sourceLength;
+		if (ptr->startMarkerPending)
+		{
+			ptr->startMarkerPending = false;
+			ptr->endMarkerPending = false;
+		}
+	}
+}// Cancel
+
+
+/*!
+Destroys a stream created with PasteStream_New(), and
+sets your copy of the reference to nullptr.
+
+(2021.06)
+*/
+void
+PasteStream_Dispose		(PasteStream_Ref*	inoutRefPtr)
+{
+	if (nullptr != inoutRefPtr)
+	{
+		delete REINTERPRET_CAST(*inoutRefPtr, My_PasteStreamPtr);
+		*inoutRefPtr = nullptr;
+	}
+}// Dispose
+
+
+/*!
+Returns true only if every chunk of the stream has been
+read (in other words, PasteStream_ReadChunk() would return
+"kPasteStream_ResultComplete").
+
+(2021.06)
+*/
+Boolean
+PasteStream_IsComplete	(PasteStream_Ref	inRef)
+{
+	My_PasteStreamPtr	ptr = REINTERPRET_CAST(inRef, My_PasteStreamPtr);
+	Boolean				result = true;
+	
+	
+	if (nullptr != ptr)
+	{
+		result = ptr->isComplete();
+	}
+	return result;
+}// IsComplete
+
+
+/*!
+Creates a stream that will return the given text in chunks
+(see PasteStream_ReadChunk()), with each new-line sequence
+replaced by the given sequence.  Any of the sequences that
+CFStringGetLineBounds() considers a new-line is replaced;
+but a new-line at the very end of the text is removed, so
+that pasting a line does not also run it as a command.
+
+The text is retained and not copied, so it must not be
+changed while the stream exists.  Dispose of the stream
+with PasteStream_Dispose().
+
+Returns nullptr if the text is nullptr or the sequence is
+longer than "kPasteStream_MaximumNewLineLength".
+
+(2021.06)
+*/
+PasteStream_Ref
+PasteStream_New		(CFStringRef			inText,
+					 UniChar const*			inNewLineSequence,
+					 UInt16					inNewLineSequenceLength,
+					 PasteStream_Options	inOptions)
+{
+	PasteStream_Ref		result = nullptr;
+	
+	
+	if ((nullptr != inText) && (inNewLineSequenceLength <= kPasteStream_MaximumNewLineLength) &&
+		((nullptr != inNewLineSequence) || (0 == inNewLineSequenceLength)))
+	{
+		try
+		{
+			result = REINTERPRET_CAST(new My_PasteStream(inText, inNewLineSequence, inNewLineSequenceLength, inOptions),
+										PasteStream_Ref);
+		}
+		catch (std::bad_alloc)
+		{
+			result = nullptr;
+		}
+	}
+	return result;
+}// New
+
+
+/*!
+Copies as much of the remaining text as will fit into the
+given buffer, after translating new-lines and adding any
+markers (see PasteStream_New()).  The chunk never ends in
+the middle of a surrogate pair, a new-line sequence or a
+marker; and if the option "kPasteStream_OptionChunkPerLine"
+was given, it ends after the first new-line sequence.
+
+The buffer must have room for at least
+"kPasteStream_MinimumChunkLength" characters.  Memory use
+does not depend on the length of the original text.
+
+\retval kPasteStream_ResultOK
+if at least one character was copied
+
+\retval kPasteStream_ResultComplete
+if the entire stream has been read already (or everything
+that remained was removed, such as a final new-line)
+
+\retval kPasteStream_ResultInvalidReference
+if the stream is nullptr
+
+\retval kPasteStream_ResultParameterError
+if the buffer is nullptr or too small
+
+(2021.06)
+*/
+PasteStream_Result
+PasteStream_ReadChunk	(PasteStream_Ref	inRef,
+						 UniChar*			outBuffer,
+						 CFIndex			inBufferLength,
+						 CFIndex&			outChunkLength)
+{
+	My_PasteStreamPtr		ptr = REINTERPRET_CAST(inRef, My_PasteStreamPtr);
+	PasteStream_Result		result = kPasteStream_ResultOK;
+	
+	
+	outChunkLength = 0;
+	if (nullptr == ptr)
+	{
+		result = kPasteStream_ResultInvalidReference;
+	}
+	else if ((nullptr == outBuffer) || (inBufferLength < kPasteStream_MinimumChunkLength))
+	{
+		result = kPasteStream_ResultParameterError;
+	}
+	else
+	{
+		UniChar*		outPtr = outBuffer;
+		UniChar* const	kPastEndPtr = (outBuffer + inBufferLength);
+		Boolean			endChunk = false;
+		
+		
+		if (ptr->startMarkerPending)
+		{
+			outPtr = std::copy(kMy_StartMarker, kMy_StartMarker + kMy_MarkerLength, outPtr);
+			ptr->startMarkerPending = false;
+		}
+		
+		while ((false == endChunk) && (ptr->sourceIndex < ptr->sourceLength))
+		{
+			UniChar const	kCharacter = ptr->returnCharacter(ptr->sourceIndex);
+			CFIndex const	kNewLineLength = ptr->returnNewLineLength(ptr->sourceIndex, kCharacter);
+			
+			
+			if (kNewLineLength > 0)
+			{
+				if ((ptr->sourceIndex + kNewLineLength) >= ptr->sourceLength)
+				{
+					// a new-line at the very end is not pasted
+					ptr->sourceIndex += kNewLineLength;
+				}
+				else if ((kPastEndPtr - outPtr) < ptr->newLineLength)
+				{
+					endChunk = true;
+				}
+				else
+				{
+					outPtr = std::copy(ptr->newLine, ptr->newLine + ptr->newLineLength, outPtr);
+					ptr->sourceIndex += kNewLineLength;
+					endChunk = ptr->isChunkPerLine;
+				}
+			}
+			else if (ptr->isBracketed && (0x1B == kCharacter) && ptr->isMarkerAt(ptr->sourceIndex, kMy_EndMarker))
+			{
+				// an end marker in the text would end the paste early
+				// and allow the rest of the text to be run as commands
+				ptr->sourceIndex += kMy_MarkerLength;
+			}
+			else
+			{
+				CFIndex const	kCharacterLength = ((CFStringIsSurrogateHighCharacter(kCharacter) &&
+													((ptr->sourceIndex + 1) < ptr->sourceLength))
+													? 2
+													: 1);
+				
+				
+				if ((kPastEndPtr - outPtr) < kCharacterLength)
+				{
+					endChunk = true;
+				}
+				else
+				{
+					*outPtr++ = kCharacter;
+					if (2 == kCharacterLength)
+					{
+						*outPtr++ = ptr->returnCharacter(ptr->sourceIndex + 1);
+					}
+					ptr->sourceIndex += kCharacterLength;
+				}
+			}
+		}
+		
+		if ((ptr->sourceIndex >= ptr->sourceLength) && ptr->endMarkerPending &&
+			((kPastEndPtr - outPtr) >= kMy_MarkerLength))
+		{
+			outPtr = std::copy(kMy_EndMarker, kMy_EndMarker + kMy_MarkerLength, outPtr);
+			ptr->endMarkerPending = false;
+		}
+		
+		outChunkLength = (outPtr - outBuffer);
+		if (0 == outChunkLength)
+		{
+			result = kPasteStream_ResultComplete;
+		}
+	}
+	return result;
+}// ReadChunk
+
+
+/*!
+Returns the fraction of the original text that has been
+read so far, from 0 to 1 (which is only returned once the
+stream is complete).
+
+(2021.06)
+*/
+Float32
+PasteStream_ReturnProgress	(PasteStream_Ref	inRef)
+{
+	My_PasteStreamPtr	ptr = REINTERPRET_CAST(inRef, My_PasteStreamPtr);
+	Float32				result = 1.0;
+	
+	
+	if ((nullptr != ptr) && (false == ptr->isComplete()))
+	{
+		result = ((0 == ptr->sourceLength)
+					? 0.0
+					: std::min(STATIC_CAST(ptr->sourceIndex, Float32) / STATIC_CAST(ptr->sourceLength, Float32), 0.999f));
+	}
+	return result;
+}// ReturnProgress
+
+
+/*!
+Returns true only if the given text would be pasted as more
+than one line.  A new-line at the very end does not count,
+since it is never pasted (see PasteStream_New()).
+
+The text is examined a small part at a time, so this does
+not allocate memory in proportion to the text.
+
+(2021.06)
+*/
+Boolean
+PasteStream_TextHasMultipleLines	(CFStringRef	inText)
+{
+	Boolean		result = false;
+	
+	
+	if (nullptr != inText)
+	{
+		My_PasteStream		scanner(inText, nullptr, 0, kPasteStream_OptionsNone);
+		
+		
+		for (scanner.sourceIndex = 0; scanner.sourceIndex < scanner.sourceLength; ++(scanner.sourceIndex))
+		{
+			CFIndex const	kNewLineLength = scanner.returnNewLineLength(scanner.sourceIndex,
+																			scanner.returnCharacter(scanner.sourceIndex));
+			
+			
+			if ((kNewLineLength > 0) && ((scanner.sourceIndex + kNewLineLength) < scanner.sourceLength))
+			{
+				result = true;
+				break;
+			}
+		}
+	}
+	return result;
+}// TextHasMultipleLines
+
+
+#pragma mark Internal Methods
+namespace {
+
+/*!
+Constructor.  See PasteStream_New().
+
+(2021.06)
+*/
+My_PasteStream::
+My_PasteStream	(CFStringRef			inText,
+				 UniChar const*			inNewLineSequence,
+				 UInt16					inNewLineSequenceLength,
+				 PasteStream_Options	inOptions)
+:
+sourceText(inText),
+sourceLength(CFStringGetLength(inText)),
+sourceIndex(0),
+windowStart(0),
+windowLength(0),
+newLineLength(inNewLineSequenceLength),
+isBracketed(0 != (inOptions & kPasteStream_OptionBracketed)),
+isChunkPerLine(0 != (inOptions & kPasteStream_OptionChunkPerLine)),
+startMarkerPending(isBracketed),
+endMarkerPending(isBracketed)
+{
+	CFRetain(sourceText);
+	std::copy(inNewLineSequence, inNewLineSequence + inNewLineSequenceLength, newLine);
+}// My_PasteStream 4-argument constructor
+
+
+/*!
+Destructor.
+
+(2021.06)
+*/
+My_PasteStream::
+~My_PasteStream ()
+{
+	CFRelease(sourceText), sourceText = nullptr;
+}// My_PasteStream destructor
+
+
+/*!
+Returns true only if every chunk has been read.
+
+(2021.06)
+*/
+Boolean
+My_PasteStream::
+isComplete ()
+const
+{
+	return ((false == startMarkerPending) && (sourceIndex >= sourceLength) && (false == endMarkerPending));
+}// My_PasteStream::isComplete
+
+
+/*!
+Returns true only if the original text contains the given
+marker (of length "kMy_MarkerLength") at the given offset.
+
+(2021.06)
+*/
+Boolean
+My_PasteStream::
+isMarkerAt	(CFIndex			inIndex,
+			 UniChar const*		inMarker)
+{
+	Boolean		result = ((inIndex + kMy_MarkerLength) <= sourceLength);
+	
+	
+	for (CFIndex i = 0; (result && (i < kMy_MarkerLength)); ++i)
+	{
+		result = (inMarker[i] == returnCharacter(inIndex + i));
+	}
+	return result;
+}// My_PasteStream::isMarkerAt
+
+
+/*!
+Returns the character at the given offset in the original
+text, or 0 if the offset is past the end.  If necessary,
+the window is moved so that it contains the character; it
+starts at the unread part of the text when possible, so
+that looking ahead does not discard what is about to be
+read.
+
+(2021.06)
+*/
+UniChar
+My_PasteStream::
+returnCharacter		(CFIndex	inIndex)
+{
+	UniChar		result = 0;
+	
+	
+	if (inIndex < sourceLength)
+	{
+		if ((inIndex < windowStart) || (inIndex >= (windowStart + windowLength)))
+		{
+			windowStart = (((inIndex >= sourceIndex) && ((inIndex - sourceIndex) < (kMy_SourceWindowLength / 2)))
+							? sourceIndex
+							: inIndex);
+			windowLength = std::min(kMy_SourceWindowLength, sourceLength - windowStart);
+			CFStringGetCharacters(sourceText, CFRangeMake(windowStart, windowLength), window);
+		}
+		result = window[inIndex - windowStart];
+	}
+	return result;
+}// My_PasteStream::returnCharacter
+
+
+/*!
+Returns the number of characters in the new-line sequence
+at the given offset in the original text, or 0 if there is
+no new-line there.  The character at the offset is given,
+since the caller has always read it already.  A carriage return followed by a line
+feed is one sequence.
+
+(2021.06)
+*/
+CFIndex
+My_PasteStream::
+returnNewLineLength		(CFIndex	inIndex,
+						 UniChar	inCharacter)
+{
+	CFIndex		result = 0;
+	
+	
+	switch (inCharacter)
+	{
+	case 0x000D: // carriage return
+		result = ((0x000A == returnCharacter(inIndex + 1)) ? 2 : 1);
+		break;
+	
+	case 0x000A: // line feed
+	case 0x0085: // next line
+	case 0x2028: // line separator
+	case 0x2029: // paragraph separator
+		result = 1;
+		break;
+	
+	default:
+		break;
+	}
+	return result;
+}// My_PasteStream::returnNewLineLength
+
+
+/*!
+Returns a new string with the given characters, for tests.
+
+(2021.06)
+*/
+CFStringRef
+newTestString	(char16_t const*	inCharacters)
+{
+	std::vector< UniChar >	buffer;
+	
+	
+	for (char16_t const* charPtr = inCharacters; 0 != *charPtr; ++charPtr)
+	{
+		buffer.push_back(STATIC_CAST(*charPtr, UniChar));
+	}
+	return CFStringCreateWithCharacters(kCFAllocatorDefault, buffer.data(), buffer.size());
+}// newTestString
+
+
+/*!
+Reads every chunk of the given stream with a buffer of the
+given length, and returns the text with each character as
+one byte (characters above 0x7F become "?") and with a "|"
+after each chunk.  If a count is given, it is set to the
+number of chunks.
+
+(2021.06)
+*/
+std::string
+readTestChunks	(PasteStream_Ref	inRef,
+				 CFIndex			inBufferLength,
+				 UInt32*			outChunkCountOrNull)
+{
+	std::vector< UniChar >	buffer(inBufferLength);
+	std::string				result;
+	UInt32					chunkCount = 0;
+	CFIndex					chunkLength = 0;
+	
+	
+	while (kPasteStream_ResultOK == PasteStream_ReadChunk(inRef, buffer.data(), buffer.size(), chunkLength))
+	{
+		for (CFIndex i = 0; i < chunkLength; ++i)
+		{
+			result += ((buffer[i] > 0x7F) ? '?' : STATIC_CAST(buffer[i], char));
+		}
+		result += '|';
+		++chunkCount;
+	}
+	if (nullptr != outChunkCountOrNull)
+	{
+		*outChunkCountOrNull = chunkCount;
+	}
+	return result;
+}// readTestChunks
+
+
+/*!
+Tests the translation of new-lines, including the removal
+of a final new-line and the detection of multiple lines.
+
+Returns "true" if ALL assertions pass; "false" is
+returned if any fail, however messages should be
+printed for ALL assertion failures regardless.
+
+(2021.06)
+*/
+Boolean
+unitTest000_Begin ()
+{
+	UniChar const		kCarriageReturn[] = { '\r' };
+	UniChar const		kSpace[] = { ' ' };
+	CFStringRef			text = newTestString(u"one\r\ntwo\rthree\nfour five\n");
+	PasteStream_Ref		stream = PasteStream_New(text, kCarriageReturn, 1);
+	std::string			output;
+	Boolean				result = true;
+	
+	
+	output = readTestChunks(stream, 64, nullptr);
+	Console_TestAssertUpdate(result, "one\rtwo\rthree\rfour\rfive|" == output,
+								Console_WriteValueStdString, "new-lines as carriage returns", output);
+	Console_TestAssertUpdate(result, PasteStream_IsComplete(stream), Console_WriteLine, "stream should be complete");
+	Console_TestAssertUpdate(result, 1.0 == PasteStream_ReturnProgress(stream),
+								Console_WriteValue, "progress at end (x 100)", STATIC_CAST(100 * PasteStream_ReturnProgress(stream), SInt32));
+	PasteStream_Dispose(&stream);
+	
+	// joined lines; only the very last new-line is removed
+	{
+		CFStringRef		text2 = newTestString(u"a\nb\n\n");
+		
+		
+		stream = PasteStream_New(text2, kSpace, 1);
+		output = readTestChunks(stream, 64, nullptr);
+		Console_TestAssertUpdate(result, "a b |" == output, Console_WriteValueStdString, "joined lines", output);
+		PasteStream_Dispose(&stream);
+		CFRelease(text2);
+	}
+	
+	// one chunk per line; the last line has no new-line
+	{
+		UInt32		chunkCount = 0;
+		
+		
+		stream = PasteStream_New(text, kCarriageReturn, 1, kPasteStream_OptionChunkPerLine);
+		output = readTestChunks(stream, 64, &chunkCount);
+		Console_TestAssertUpdate(result, "one\r|two\r|three\r|four\r|five|" == output,
+									Console_WriteValueStdString, "chunk per line", output);
+		Console_TestAssertUpdate(result, 5 == chunkCount, Console_WriteValue, "chunk count", chunkCount);
+		PasteStream_Dispose(&stream);
+	}
+	
+	// multiple lines
+	{
+		CFStringRef		oneLine = newTestString(u"just one line\r\n");
+		CFStringRef		twoLines = newTestString(u"line\r\n\r\n");
+		
+		
+		Console_TestAssertUpdate(result, PasteStream_TextHasMultipleLines(text), Console_WriteLine, "text should have multiple lines");
+		Console_TestAssertUpdate(result, false == PasteStream_TextHasMultipleLines(oneLine),
+									Console_WriteLine, "a final new-line should not count");
+		Console_TestAssertUpdate(result, PasteStream_TextHasMultipleLines(twoLines),
+									Console_WriteLine, "an empty last line should count");
+		CFRelease(oneLine);
+		CFRelease(twoLines);
+	}
+	
+	CFRelease(text);
+	
+	return result;
+}// unitTest000_Begin
+
+
+/*!
+Tests bracketed paste markers, the removal of end markers
+from the text, and chunks that are too small for all of
+the text (including text that is longer than the window
+of the stream).
+
+Returns "true" if ALL assertions pass; "false" is
+returned if any fail, however messages should be
+printed for ALL assertion failures regardless.
+
+(2021.06)
+*/
+Boolean
+unitTest001_Begin ()
+{
+	UniChar const		kCarriageReturnLineFeed[] = { '\r', '\n' };
+	CFStringRef			text = newTestString(u"ab\x1B[201~cd\nefgh\U0001F600");
+	PasteStream_Ref		stream = PasteStream_New(text, kCarriageReturnLineFeed, 2, kPasteStream_OptionBracketed);
+	std::string			output;
+	Boolean				result = true;
+	
+	
+	// an 8-character buffer fits the start marker and 2 more,
+	// and the surrogate pair does not fit after "efgh"
+	output = readTestChunks(stream, 8, nullptr);
+	Console_TestAssertUpdate(result, "\033[200~ab|cd\r\nefgh|??\033[201~|" == output,
+								Console_WriteValueStdString, "bracketed chunks", output);
+	PasteStream_Dispose(&stream);
+	CFRelease(text);
+	
+	// an end marker across a window boundary is still removed,
+	// and arbitrary chunk lengths reproduce the whole text
+	{
+		std::u16string		longText(1020, u'x');
+		std::string			expectedOutput;
+		CFIndex				chunkLength = 0;
+		UniChar				buffer[13];
+		
+		
+		longText += u"\x1B[201~";
+		longText += std::u16string(2000, u'y');
+		text = newTestString(longText.c_str());
+		stream = PasteStream_New(text, kCarriageReturnLineFeed, 2, kPasteStream_OptionBracketed);
+		expectedOutput = "\033[200~" + std::string(1020, 'x') + std::string(2000, 'y') + "\033[201~";
+		output.clear();
+		while (kPasteStream_ResultOK == PasteStream_ReadChunk(stream, buffer, sizeof(buffer) / sizeof(UniChar), chunkLength))
+		{
+			output.append(buffer, buffer + chunkLength);
+			if ((PasteStream_ReturnProgress(stream) <= 0.0) || (PasteStream_ReturnProgress(stream) >= 1.0))
+			{
+				Console_TestAssertUpdate(result, PasteStream_IsComplete(stream),
+											Console_WriteValue, "progress while reading (x 100)",
+											STATIC_CAST(100 * PasteStream_ReturnProgress(stream), SInt32));
+			}
+		}
+		Console_TestAssertUpdate(result, expectedOutput == output,
+									Console_WriteValue, "long text length", output.size());
+		Console_TestAssertUpdate(result, kPasteStream_ResultComplete == PasteStream_ReadChunk(stream, buffer, 13, chunkLength),
+									Console_WriteLine, "stream should be complete");
+		Console_TestAssertUpdate(result, kPasteStream_ResultParameterError == PasteStream_ReadChunk(stream, buffer, 4, chunkLength),
+									Console_WriteLine, "small buffer should be rejected");
+		PasteStream_Dispose(&stream);
+		CFRelease(text);
+	}
+	
+	return result;
+}// unitTest001_Begin
+
+
+/*!
+Tests a Paste that is cancelled partway through: the rest
+of the text must not be read, but a bracketed paste that
+has started must still end with its end marker.
+
+Returns "true" if ALL assertions pass; "false" is
+returned if any fail, however messages should be
+printed for ALL assertion failures regardless.
+
+(2021.06)
+*/
+Boolean
+unitTest002_Begin ()
+{
+	UniChar const		kCarriageReturn[] = { '\r' };
+	CFStringRef			text = newTestString(u"first line\nsecond line\nthird line");
+	PasteStream_Ref		stream = PasteStream_New(text, kCarriageReturn, 1, kPasteStream_OptionBracketed | kPasteStream_OptionChunkPerLine);
+	UniChar				buffer[64];
+	CFIndex				chunkLength = 0;
+	std::string			output;
+	Boolean				result = true;
+	
+	
+	// a bracketed paste that has started ends with its marker
+	Console_TestAssertUpdate(result, (kPasteStream_ResultOK == PasteStream_ReadChunk(stream, buffer, 64, chunkLength)) &&
+										(17 == chunkLength),
+								Console_WriteValue, "first chunk length", chunkLength);
+	Console_TestAssertUpdate(result, (PasteStream_ReturnProgress(stream) > 0.0) && (PasteStream_ReturnProgress(stream) < 1.0),
+								Console_WriteValue, "progress before cancelling (x 100)",
+								STATIC_CAST(100 * PasteStream_ReturnProgress(stream), SInt32));
+	PasteStream_Cancel(stream);
+	Console_TestAssertUpdate(result, false == PasteStream_IsComplete(stream),
+								Console_WriteLine, "cancelled stream should not be complete before its end marker");
+	output = readTestChunks(stream, 64, nullptr);
+	Console_TestAssertUpdate(result, "\033[201~|" == output,
+								Console_WriteValueStdString, "chunks after cancelling a bracketed paste", output);
+	Console_TestAssertUpdate(result, PasteStream_IsComplete(stream) && (1.0 == PasteStream_ReturnProgress(stream)),
+								Console_WriteLine, "cancelled stream should be complete");
+	PasteStream_Dispose(&stream);
+	
+	// a bracketed paste that has not started sends nothing at all
+	stream = PasteStream_New(text, kCarriageReturn, 1, kPasteStream_OptionBracketed);
+	PasteStream_Cancel(stream);
+	Console_TestAssertUpdate(result, PasteStream_IsComplete(stream) &&
+										(kPasteStream_ResultComplete == PasteStream_ReadChunk(stream, buffer, 64, chunkLength)),
+								Console_WriteValue, "chunk length after cancelling before reading", chunkLength);
+	PasteStream_Dispose(&stream);
+	
+	// other text simply stops
+	stream = PasteStream_New(text, kCarriageReturn, 1, kPasteStream_OptionChunkPerLine);
+	output = readTestChunks(stream, 64, nullptr);
+	PasteStream_Dispose(&stream);
+	stream = PasteStream_New(text, kCarriageReturn, 1, kPasteStream_OptionChunkPerLine);
+	UNUSED_RETURN(PasteStream_Result)PasteStream_ReadChunk(stream, buffer, 64, chunkLength);
+	PasteStream_Cancel(stream);
+	Console_TestAssertUpdate(result, "first line\r|second line\r|third line|" == output,
+								Console_WriteValueStdString, "chunks without cancelling", output);
+	Console_TestAssertUpdate(result, kPasteStream_ResultComplete == PasteStream_ReadChunk(stream, buffer, 64, chunkLength),
+								Console_WriteValue, "chunk length after cancelling", chunkLength);
+	PasteStream_Dispose(&stream);
+	
+	CFRelease(text);
+	
+	return result;
+}// unitTest002_Begin
+
+} // anonymous namespace
+
+// BELOW IS REQUIRED NEWLINE TO END FILE
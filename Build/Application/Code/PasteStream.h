@@ -0,0 +1,154 @@
+/*!	\file PasteStream.h
+	\brief Converts text to be pasted into a terminal into
+	chunks of bounded size, one at a time.
+	
+	A paste used to be split into one string per line up
+	front, with a scheduled block for every line; so a very
+	large paste was duplicated in memory and could create
+	millions of pending blocks.  A stream instead keeps only
+	a reference to the original text and a position in it.
+	Each request for a chunk reads and converts just enough
+	of the text to fill the given buffer: new-line sequences
+	become the sequence that the session sends for new-lines
+	(or spaces, if the lines are being joined), and optionally
+	the whole paste is enclosed in the markers of bracketed
+	paste mode (XTerm mode 2004).
+	
+	The output is still UTF-16 so that the session can encode
+	it with its own text encoding.
+*/
+/*###############################################################
+
+	MacTerm
+		© 1998-2021 by Kevin Grant.
+		© 2001-2003 by Ian Anderson.
+		© 1986-1994 University of Illinois Board of Trustees
+		(see About box for full list of U of I contributors).
+	
+	This program is free software; you can redistribute it or
+	modify it under the terms of the GNU General Public License
+	as published by the Free Software Foundation; either version
+	2 of the License, or (at your option) any later version.
+	
+	This program is distributed in the hope that it will be
+	useful, but WITHOUT ANY WARRANTY; without even the implied
+	warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+	PURPOSE.  See the GNU General Public License for more
+	details.
+	
+	You should have received a copy of the GNU General Public
+	License along with this program; if not, write to:
+	
+		Free Software Foundation, Inc.
+		59 Temple Place, Suite 330
+		Boston, MA  02111-1307
+		USA
+
+###############################################################*/
+
+#include <UniversalDefines.h>
+
+#pragma once
+
+// Mac includes
+#include <CoreServices/CoreServices.h>
+
+
+
+#pragma mark Constants
+
+/*!
+Possible return values from Paste Stream module routines.
+*/
+typedef long PasteStream_Result;
+enum
+{
+	kPasteStream_ResultOK					= 0,	//!< no error; a chunk was returned
+	kPasteStream_ResultInvalidReference		= 1,	//!< given PasteStream_Ref is not valid
+	kPasteStream_ResultParameterError		= 2,	//!< invalid input (e.g. a buffer that is too small)
+	kPasteStream_ResultComplete				= 3		//!< there is nothing left to read (no chunk was returned)
+};
+
+/*!
+Options for PasteStream_New().
+*/
+typedef UInt32 PasteStream_Options;
+enum
+{
+	kPasteStream_OptionsNone				= 0,
+	kPasteStream_OptionBracketed			= (1 << 0),		//!< enclose the text in bracketed-paste markers, and remove
+															//!  any end marker from the text itself
+	kPasteStream_OptionChunkPerLine			= (1 << 1)		//!< end each chunk after a new-line, so that lines can be
+															//!  sent with delays in between
+};
+
+enum
+{
+	kPasteStream_MinimumChunkLength		= 8,	//!< smallest buffer (in UTF-16 units) for PasteStream_ReadChunk()
+	kPasteStream_MaximumNewLineLength	= 2		//!< longest sequence that may replace new-lines
+};
+
+#pragma mark Types
+
+typedef struct PasteStream_OpaqueStream*	PasteStream_Ref;
+
+
+
+#pragma mark Public Methods
+
+//!\name Module Tests
+//@{
+
+void
+	PasteStream_RunTests				();
+
+//@}
+
+//!\name Examining Text
+//@{
+
+// A NEW-LINE AT THE VERY END DOES NOT COUNT (IT IS NEVER PASTED)
+Boolean
+	PasteStream_TextHasMultipleLines	(CFStringRef			inText);
+
+//@}
+
+//!\name Creating and Destroying Streams
+//@{
+
+// THE TEXT IS RETAINED AND MUST NOT BE CHANGED; NEW-LINES ARE REPLACED BY THE GIVEN SEQUENCE (E.g. "\r" OR " ")
+PasteStream_Ref
+	PasteStream_New						(CFStringRef			inText,
+										 UniChar const*			inNewLineSequence,
+										 UInt16					inNewLineSequenceLength,
+										 PasteStream_Options	inOptions = kPasteStream_OptionsNone);
+
+void
+	PasteStream_Dispose					(PasteStream_Ref*		inoutRefPtr);
+
+//@}
+
+//!\name Reading Chunks
+//@{
+
+// DISCARDS THE REST OF THE TEXT; A BRACKETED PASTE THAT HAS STARTED STILL RETURNS ITS END MARKER
+void
+	PasteStream_Cancel					(PasteStream_Ref		inRef);
+
+Boolean
+	PasteStream_IsComplete				(PasteStream_Ref		inRef);
+
+// NEVER SPLITS A SURROGATE PAIR, NEW-LINE SEQUENCE OR MARKER ACROSS CHUNKS
+PasteStream_Result
+	PasteStream_ReadChunk				(PasteStream_Ref		inRef,
+										 UniChar*				outBuffer,
+										 CFIndex				inBufferLength,
+										 CFIndex&				outChunkLength);
+
+// FRACTION OF THE ORIGINAL TEXT THAT HAS BEEN READ, FROM 0 TO 1
+Float32
+	PasteStream_ReturnProgress			(PasteStream_Ref		inRef);
+
+//@}
+
+// BELOW IS REQUIRED NEWLINE TO END FILE
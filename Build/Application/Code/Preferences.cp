@@ -36,6 +36,7 @@
 
 // standard-C++ includes
 #include <algorithm>
+#include <cstring>
 #include <functional>
 #include <iostream>
 #include <set>
@@ -91,6 +92,7 @@
 #include "MacroManager.h"
 #include "Session.h"
 #include "SessionFactory.h"
+#include "StreamCapture.h"
 #include "Terminal.h"
 #include "TerminalView.h"
 #include "UIStrings.h"
@@ -109,6 +111,8 @@ CFStringRef const			kMy_PreferencesSubDomainSessions = CFSTR("net.macterm.MacTer
 CFStringRef const			kMy_PreferencesSubDomainTerminals = CFSTR("net.macterm.MacTerm.terminals");
 CFStringRef const			kMy_PreferencesSubDomainTranslations = CFSTR("net.macterm.MacTerm.translations");
 CFStringRef const			kMy_PreferencesSubDomainWorkspaces = CFSTR("net.macterm.MacTerm.workspaces");
+size_t const				kMy_ValueCacheMaximumValueSize = 16;	//!< largest plain value that a context will cache (bytes)
+size_t const				kMy_ValueCacheSlotCount = 64;			//!< number of direct-mapped cache slots in each context
 
 } // anonymous namespace
 
@@ -174,6 +178,24 @@ namespace {
 typedef MemoryBlockReferenceTracker< Preferences_ContextRef >				My_ContextReferenceTracker;
 typedef Registrar< Preferences_ContextRef, My_ContextReferenceTracker >		My_ContextReferenceRegistrar;
 
+/*!
+A decoded preference value that a context has remembered
+for Preferences_ContextGetCachedData().  The slot is only
+valid while its generation matches the global generation
+(which changes whenever ANY setting is modified, since a
+read may have fallen back on a default context).
+*/
+struct My_CachedValue
+{
+	UInt32				generation;			//!< 0 means unused; compared against gMyValueCacheGeneration
+	Preferences_Tag		tag;				//!< which setting the value is for
+	UInt8				byteCount;			//!< size of the stored value
+	Boolean				searchDefaults;		//!< true if the value may have come from a default context
+	Boolean				isDefault;			//!< result “is default” flag of the original read
+	UInt8				valueBytes[kMy_ValueCacheMaximumValueSize];	//!< a copy of the data in its native type
+};
+typedef std::vector< My_CachedValue >		My_CachedValueList;
+
 /*!
 Provides uniform access to context information no
 matter how it is really stored.
@@ -282,6 +304,7 @@ public:
 	deleteValue		(CFStringRef	inKey)
 	{
 		_implementorPtr->deleteValue(inKey);
+		invalidateCachedValues();
 	}
 	
 	//! delete this key-value set from application preferences
@@ -295,6 +318,10 @@ public:
 		return _implementorPtr->exists(inKey);
 	}
 	
+	//! forgets the cached values of ALL contexts; done automatically when any setting changes
+	static void
+	invalidateCachedValues ();
+	
 	//! invokes callbacks for an event; usually done automatically
 	void
 	notifyListeners	(Preferences_Tag);
@@ -315,6 +342,10 @@ public:
 		return _implementorPtr->returnArrayCopy(inKey);
 	}
 	
+	//! copies a remembered value and returns true, or returns false if it must be read again
+	Boolean
+	returnCachedValue	(Preferences_Tag, Boolean, size_t, void*, Boolean*) const;
+	
 	//! the category of this context
 	inline Quills::Prefs::Class
 	returnClass () const;
@@ -376,6 +407,10 @@ public:
 	virtual Preferences_Result
 	save () NO_METHOD_IMPL = 0;
 	
+	//! remembers a value that was just read, for returnCachedValue()
+	void
+	setCachedValue		(Preferences_Tag, Boolean, size_t, void const*, Boolean);
+	
 	//! test routine
 	static Boolean
 	unitTest	(My_ContextInterface*);
@@ -390,6 +425,10 @@ private:
 	Quills::Prefs::Class	_preferencesClass;	//!< hint as to what keys are likely to be present
 	ListenerModel_Ref		_listenerModel;		//!< if monitors are used, handles change notifications
 	CFKeyValueInterface*	_implementorPtr;	//!< how settings are saved (e.g. application preferences, an in-memory dictionary...)
+	My_CachedValueList		_cachedValues;		//!< decoded values of frequently-read settings (allocated on first use)
+	
+	static size_t
+	returnCacheSlot		(Preferences_Tag);
 };
 typedef My_ContextInterface const*	My_ContextInterfaceConstPtr;
 typedef My_ContextInterface*		My_ContextInterfacePtr;
@@ -560,7 +599,8 @@ protected:
 	createDomainName	(Quills::Prefs::Class, CFStringRef);
 
 private:
-	CFRetainRelease			_contextName;	//!< CFStringRef; a display name for this context
+	mutable CFRetainRelease	_contextName;	//!< CFStringRef; a display name for this context
+	mutable Boolean			_nameResolved;	//!< false if the name has not yet been read from the sub-domain
 	CFRetainRelease			_domainName;	//!< CFStringRef; an arbitrary but class-based sub-domain for settings
 	CFKeyValuePreferences	_dictionary;	//!< handles key value lookups in the chosen sub-domain
 };
@@ -666,10 +706,10 @@ public:
 	
 	Preferences_TagSetRef	selfRef;		//!< convenient, redundant self-reference
 	CFRetainRelease			contextKeys;	//!< CFMutableArrayRef; the keys for which preferences are defined
-
+	
 	static void
 	extendKeyListWithKeyList	(CFMutableArrayRef, CFArrayRef);
-
+	
 	static void
 	extendKeyListWithTags		(CFMutableArrayRef, std::vector< Preferences_Tag > const&);
 
@@ -732,6 +772,7 @@ void					readApplicationArrayPreference			(CFStringRef, CFArrayRef&);
 Boolean					readPreferencesDictionary				(CFDictionaryRef, Boolean);
 Boolean					readPreferencesDictionaryInContext		(My_ContextInterfacePtr, CFDictionaryRef, Boolean,
 																 Quills::Prefs::Class*, CFStringRef*);
+void					removeShadowedFavorites					(My_FavoriteContextList&);
 void					setApplicationPreference				(CFStringRef, CFPropertyListRef);
 Preferences_Result		setFormatPreference						(My_ContextInterfacePtr, Preferences_Tag,
 																 size_t, void const*);
@@ -755,6 +796,7 @@ Boolean					unitTest000_Begin						();
 Boolean					unitTest001_Begin						();
 Boolean					unitTest002_Begin						();
 Boolean					unitTest003_Begin						();
+Boolean					unitTest004_Begin						();
 
 } // anonymous namespace
 
@@ -762,6 +804,7 @@ Boolean					unitTest003_Begin						();
 namespace {
 
 ListenerModel_Ref			gPreferenceEventListenerModel = nullptr;
+UInt32						gMyValueCacheGeneration = 1;	//!< see My_ContextInterface::invalidateCachedValues()
 Boolean						gInitializing = false;
 Boolean						gInitialized = false;
 My_ContextPtrLocker&		gMyContextPtrLocks ()	{ static My_ContextPtrLocker x; return x; }
@@ -783,6 +826,7 @@ My_ContextInterface&		gTranslationDefaultContext ()	{ static My_ContextDefault x
 My_FavoriteContextList&		gTranslationNamedContexts ()	{ static My_FavoriteContextList x; return x; }
 My_ContextInterface&		gWorkspaceDefaultContext ()	{ static My_ContextDefault x(Quills::Prefs::WORKSPACE); return x; }
 My_FavoriteContextList&		gWorkspaceNamedContexts ()	{ static My_FavoriteContextList x; return x; }
+std::set< Quills::Prefs::Class >&	gUncheckedFavoriteClasses ()	{ static std::set< Quills::Prefs::Class > x; return x; }	//!< see removeShadowedFavorites()
 My_TagSetPtrLocker&			gMyTagSetPtrLocks ()	{ static My_TagSetPtrLocker x; return x; }
 
 } // anonymous namespace
@@ -919,9 +963,23 @@ Preferences_Init ()
 									sizeof(CFStringRef), Quills::Prefs::SESSION);
 	My_PreferenceDefinition::createFlag(kPreferences_TagCaptureFileNameAllowsSubstitutions,
 										CFSTR("terminal-capture-file-name-is-generated"), Quills::Prefs::SESSION);
+	My_PreferenceDefinition::createFlag(kPreferences_TagCaptureFileCompression,
+										CFSTR("terminal-capture-file-gzip"), Quills::Prefs::GENERAL);
+	My_PreferenceDefinition::create(kPreferences_TagCaptureFileContent,
+									CFSTR("terminal-capture-file-content"), kPreferences_DataTypeCFStringRef,
+									sizeof(StreamCapture_Content), Quills::Prefs::GENERAL);
 	My_PreferenceDefinition::create(kPreferences_TagCaptureFileLineEndings,
 									CFSTR("terminal-capture-file-line-endings"), kPreferences_DataTypeCFStringRef,
 									sizeof(Session_LineEnding), Quills::Prefs::GENERAL);
+	My_PreferenceDefinition::create(kPreferences_TagCaptureFileRotationMegabytes,
+									CFSTR("terminal-capture-file-rotate-megabytes"), kPreferences_DataTypeCFNumberRef,
+									sizeof(UInt32), Quills::Prefs::GENERAL);
+	My_PreferenceDefinition::create(kPreferences_TagCaptureFileRotationSeconds,
+									CFSTR("terminal-capture-file-rotate-seconds"), kPreferences_DataTypeCFNumberRef,
+									sizeof(UInt32), Quills::Prefs::GENERAL);
+	My_PreferenceDefinition::create(kPreferences_TagCaptureFileSyncPolicy,
+									CFSTR("terminal-capture-file-sync"), kPreferences_DataTypeCFStringRef,
+									sizeof(StreamCapture_SyncPolicy), Quills::Prefs::GENERAL);
 	My_PreferenceDefinition::create(kPreferences_TagCommandLine,
 									CFSTR("command-line-token-strings"), kPreferences_DataTypeCFArrayRef,
 									sizeof(CFArrayRef), Quills::Prefs::SESSION);
@@ -1027,10 +1085,14 @@ Preferences_Init ()
 										CFSTR("kiosk-scroll-bar-visible"), Quills::Prefs::GENERAL);
 	My_PreferenceDefinition::createFlag(kPreferences_TagKioskShowsWindowFrame,
 										CFSTR("kiosk-window-frame-visible"), Quills::Prefs::GENERAL);
+	My_PreferenceDefinition::createFlag(kPreferences_TagLocalSessionsDetachable,
+										CFSTR("local-sessions-detachable"), Quills::Prefs::GENERAL);
 	My_PreferenceDefinition::createFlag(kPreferences_TagLineModeEnabled,
 										CFSTR("line-mode-enabled"), Quills::Prefs::SESSION);
 	My_PreferenceDefinition::createFlag(kPreferences_TagLocalEchoEnabled,
 										CFSTR("data-send-local-echo-enabled"), Quills::Prefs::SESSION);
+	My_PreferenceDefinition::createFlag(kPreferences_TagLocalEchoPredictive,
+										CFSTR("data-send-local-echo-predictive"), Quills::Prefs::SESSION);
 	My_PreferenceDefinition::create(kPreferences_TagMapArrowsForEmacs,
 									CFSTR("command-key-emacs-move-down"), kPreferences_DataTypeCFStringRef,
 									sizeof(Boolean), Quills::Prefs::SESSION);
@@ -1222,6 +1284,9 @@ Preferences_Init ()
 	My_PreferenceDefinition::create(kPreferences_TagVisualBell,
 									CFSTR("terminal-when-bell"), kPreferences_DataTypeCFStringRef/* "visual" or "audio+visual" */,
 									sizeof(Boolean), Quills::Prefs::GENERAL);
+	My_PreferenceDefinition::create(kPreferences_TagWarmShellCount,
+									CFSTR("new-session-warm-shell-count"), kPreferences_DataTypeCFNumberRef,
+									sizeof(UInt16), Quills::Prefs::GENERAL);
 	My_PreferenceDefinition::createFlag(kPreferences_TagWasClipboardShowing,
 										CFSTR("window-clipboard-visible"), Quills::Prefs::GENERAL);
 	My_PreferenceDefinition::createFlag(kPreferences_TagWasCommandLineShowing,
@@ -1424,6 +1489,7 @@ Preferences_RunTests ()
 	++totalTests; if (false == unitTest001_Begin()) ++failedTests;
 	++totalTests; if (false == unitTest002_Begin()) ++failedTests;
 	++totalTests; if (false == unitTest003_Begin()) ++failedTests;
+	++totalTests; if (false == unitTest004_Begin()) ++failedTests;
 	
 	Console_WriteUnitTestReport("Preferences", failedTests, totalTests);
 }// RunTests
@@ -2146,6 +2212,74 @@ Preferences_ContextDeleteFromFavorites	(Preferences_ContextRef		inContext)
 }// ContextDeleteFromFavorites
 
 
+/*!
+Like Preferences_ContextGetData(), except that a successful
+read is remembered by the context and repeated reads of the
+same setting are served by copying the remembered bytes
+(instead of looking up and converting a dictionary value).
+Any change to any setting discards all remembered values.
+
+Only use this for settings whose data is a plain value of
+no more than a few bytes; in particular, never use it with
+Core Foundation types because the caller would not receive
+a new reference.  It is best to call the type-safe wrapper
+Preferences_ContextGetValue(), which enforces this.
+
+(2021.06)
+*/
+Preferences_Result
+Preferences_ContextGetCachedData	(Preferences_ContextRef		inContext,
+									 Preferences_Tag			inDataPreferenceTag,
+									 size_t						inDataStorageSize,
+									 void*						outDataStorage,
+									 Boolean					inSearchDefaults,
+									 Boolean*					outIsDefaultOrNull)
+{
+	Preferences_Result		result = kPreferences_ResultOK;
+	Boolean					isCached = false;
+	
+	
+	// look for a remembered value first
+	{
+		My_ContextAutoLocker	ptr(gMyContextPtrLocks(), inContext);
+		
+		
+		if (nullptr != ptr)
+		{
+			isCached = ptr->returnCachedValue(inDataPreferenceTag, inSearchDefaults, inDataStorageSize,
+												outDataStorage, outIsDefaultOrNull);
+		}
+	}
+	
+	if (false == isCached)
+	{
+		Boolean		isDefault = false;
+		
+		
+		result = Preferences_ContextGetData(inContext, inDataPreferenceTag, inDataStorageSize, outDataStorage,
+											inSearchDefaults, &isDefault);
+		if (kPreferences_ResultOK == result)
+		{
+			My_ContextAutoLocker	ptr(gMyContextPtrLocks(), inContext);
+			
+			
+			if (nullptr != ptr)
+			{
+				ptr->setCachedValue(inDataPreferenceTag, inSearchDefaults, inDataStorageSize,
+									outDataStorage, isDefault);
+			}
+		}
+		
+		if (nullptr != outIsDefaultOrNull)
+		{
+			*outIsDefaultOrNull = isDefault;
+		}
+	}
+	
+	return result;
+}// ContextGetCachedData
+
+
 /*!
 Returns preference data corresponding to the specified tag,
 starting with the specified context.
@@ -2378,7 +2512,7 @@ Preferences_ContextIsValid	(Preferences_ContextRef		inContext)
 	Boolean		result = false;
 	
 	
-	if ((nullptr != inContext) && (gMyContextValidRefs().end() != gMyContextValidRefs().find(inContext)))
+	if ((nullptr != inContext) && (gMyContextValidRefs().contains(inContext)))
 	{
 		result = true;
 	}
@@ -3373,6 +3507,41 @@ Preferences_DebugDumpContext	(Preferences_ContextRef		inContext)
 }// DebugDumpContext
 
 
+/*!
+Calls Preferences_ContextGetCachedData() using the global
+context for the class of data associated with the given
+tag.  It is best to call the type-safe wrapper
+Preferences_GetValue(), instead of calling this directly.
+
+(2021.06)
+*/
+Preferences_Result
+Preferences_GetCachedData	(Preferences_Tag	inDataPreferenceTag,
+							 size_t				inDataStorageSize,
+							 void*				outDataStorage)
+{
+	Preferences_Result			result = kPreferences_ResultOK;
+	Preferences_ContextRef		context = nullptr;
+	CFStringRef					keyName = nullptr;
+	FourCharCode				keyValueType = '----';
+	size_t						actualSize = 0;
+	Quills::Prefs::Class		dataClass = Quills::Prefs::GENERAL;
+	
+	
+	result = getPreferenceDataInfo(inDataPreferenceTag, keyName, keyValueType, actualSize, dataClass);
+	if (kPreferences_ResultOK == result)
+	{
+		result = Preferences_GetDefaultContext(&context, dataClass);
+		if (kPreferences_ResultOK == result)
+		{
+			result = Preferences_ContextGetCachedData(context, inDataPreferenceTag, inDataStorageSize,
+														outDataStorage, false/* search defaults too */);
+		}
+	}
+	return result;
+}// GetCachedData
+
+
 /*!
 Provides a list of all created contexts in the specified
 preferences class.  The first context in the list is the
@@ -3793,6 +3962,7 @@ Preferences_StartMonitoring		(ListenerModel_ListenerRef	inListener,
 	case kPreferences_TagTerminalMousePointerColor:
 	case kPreferences_TagTerminalResizeAffectsFontSize:
 	case kPreferences_TagTerminalShowMarginAtColumn:
+	case kPreferences_TagWarmShellCount:
 	case kPreferences_ChangeContextName:
 	case kPreferences_ChangeNumberOfContexts:
 		result = assertInitialized();
@@ -3867,6 +4037,7 @@ Preferences_StopMonitoring	(ListenerModel_ListenerRef	inListener,
 	case kPreferences_TagTerminalMousePointerColor:
 	case kPreferences_TagTerminalResizeAffectsFontSize:
 	case kPreferences_TagTerminalShowMarginAtColumn:
+	case kPreferences_TagWarmShellCount:
 	case kPreferences_ChangeContextName:
 	case kPreferences_ChangeNumberOfContexts:
 		result = assertInitialized();
@@ -3932,7 +4103,8 @@ refValidator(REINTERPRET_CAST(this, Preferences_ContextRef), gMyContextValidRefs
 selfRef(REINTERPRET_CAST(this, Preferences_ContextRef)),
 _preferencesClass(inClass),
 _listenerModel(nullptr/* constructed as needed */),
-_implementorPtr(nullptr)
+_implementorPtr(nullptr),
+_cachedValues()
 {
 }// My_ContextInterface 1-argument constructor
 
@@ -3985,6 +4157,32 @@ addListener		(ListenerModel_ListenerRef	inListener,
 }// My_ContextInterface::addListener
 
 
+/*!
+Discards every value remembered by returnCachedValue() in
+every context.  Since a cached read can come from a default
+context, a change to any context can affect any other one;
+rather than tracking those relationships, a single global
+generation number is advanced and all slots that carry an
+older generation are ignored from then on.
+
+This is called automatically by anything that modifies a
+context, and by change notifications.
+
+(2021.06)
+*/
+void
+My_ContextInterface::
+invalidateCachedValues ()
+{
+	++gMyValueCacheGeneration;
+	if (0 == gMyValueCacheGeneration)
+	{
+		// 0 marks unused slots; skip it on wrap-around
+		gMyValueCacheGeneration = 1;
+	}
+}// My_ContextInterface::invalidateCachedValues
+
+
 /*!
 If there are any monitors on this context, notifies them all
 that something has changed.
@@ -3999,6 +4197,9 @@ void
 My_ContextInterface::
 notifyListeners		(Preferences_Tag	inWhatChanged)
 {
+	// even a “silent” change (tag of 0) modifies data
+	invalidateCachedValues();
+	
 	if ((nullptr != _listenerModel) && (0 != inWhatChanged))
 	{
 		ListenerModel_NotifyListenersOfEvent(_listenerModel, inWhatChanged, this->selfRef);
@@ -4032,6 +4233,65 @@ removeListener	(ListenerModel_ListenerRef	inListener,
 }// My_ContextInterface::removeListener
 
 
+/*!
+Returns true and copies the value of the given setting into
+the buffer if it was remembered by setCachedValue() since
+the last change to any setting, and the size and “search
+defaults” mode match the original read.  Otherwise, returns
+false and the caller must read the value normally.
+
+(2021.06)
+*/
+Boolean
+My_ContextInterface::
+returnCachedValue	(Preferences_Tag	inTag,
+					 Boolean			inSearchDefaults,
+					 size_t				inDataSize,
+					 void*				outDataPtr,
+					 Boolean*			outIsDefaultOrNull)
+const
+{
+	Boolean		result = false;
+	
+	
+	if (false == _cachedValues.empty())
+	{
+		My_CachedValue const&	slot = _cachedValues[returnCacheSlot(inTag)];
+		
+		
+		if ((gMyValueCacheGeneration == slot.generation) && (inTag == slot.tag) &&
+			(inSearchDefaults == slot.searchDefaults) && (inDataSize == slot.byteCount))
+		{
+			std::memcpy(outDataPtr, slot.valueBytes, inDataSize);
+			if (nullptr != outIsDefaultOrNull)
+			{
+				*outIsDefaultOrNull = slot.isDefault;
+			}
+			result = true;
+		}
+	}
+	return result;
+}// My_ContextInterface::returnCachedValue
+
+
+/*!
+Returns the index into the cache that is used by the
+given tag.  Tags are four-character codes that often
+share characters so they are mixed before reducing.
+
+(2021.06)
+*/
+size_t
+My_ContextInterface::
+returnCacheSlot		(Preferences_Tag	inTag)
+{
+	UInt32 const	kMixedTag = (STATIC_CAST(inTag, UInt32) * 2654435761U/* Knuth multiplicative hash */);
+	
+	
+	return ((kMixedTag >> 16) % kMy_ValueCacheSlotCount);
+}// My_ContextInterface::returnCacheSlot
+
+
 /*!
 Returns a constant indicating the category to which
 this context belongs.  The category generally
@@ -4048,6 +4308,46 @@ const
 }// My_ContextInterface::returnClass
 
 
+/*!
+Remembers the value of a setting that was just read
+successfully, so that returnCachedValue() can return it
+until the next change.  Values larger than the maximum
+cache size are ignored.
+
+(2021.06)
+*/
+void
+My_ContextInterface::
+setCachedValue	(Preferences_Tag	inTag,
+				 Boolean			inSearchDefaults,
+				 size_t				inDataSize,
+				 void const*		inDataPtr,
+				 Boolean			inIsDefault)
+{
+	if (inDataSize <= kMy_ValueCacheMaximumValueSize)
+	{
+		if (_cachedValues.empty())
+		{
+			My_CachedValue		emptySlot;
+			
+			
+			std::memset(&emptySlot, 0, sizeof(emptySlot));
+			_cachedValues.resize(kMy_ValueCacheSlotCount, emptySlot);
+		}
+		
+		My_CachedValue&		slot = _cachedValues[returnCacheSlot(inTag)];
+		
+		
+		slot.generation = gMyValueCacheGeneration;
+		slot.tag = inTag;
+		slot.byteCount = STATIC_CAST(inDataSize, UInt8);
+		slot.searchDefaults = inSearchDefaults;
+		slot.isDefault = inIsDefault;
+		std::memcpy(slot.valueBytes, inDataPtr, inDataSize);
+	}
+}// My_ContextInterface::setCachedValue
+
+
 /*!
 Specifies the delegate instance supporting the
 CFKeyValueInterface API that will be asked to perform
@@ -4059,6 +4359,7 @@ My_ContextInterface::
 setImplementor	(CFKeyValueInterface*	inImplementorPtr)
 {
 	_implementorPtr = inImplementorPtr;
+	invalidateCachedValues();
 }// My_ContextInterface::setImplementor
 
 
@@ -4571,6 +4872,7 @@ My_ContextFavorite	(Quills::Prefs::Class	inClass,
 :
 My_ContextInterface(inClass),
 _contextName(inFavoriteName, CFRetainRelease::kNotYetRetained),
+_nameResolved((nullptr != inFavoriteName) || (nullptr == inDomainName)),
 _domainName((nullptr != inDomainName) ? inDomainName : createDomainName(inClass, inFavoriteName),
 			CFRetainRelease::kNotYetRetained),
 _dictionary(_domainName.returnCFStringRef())
@@ -4742,6 +5044,7 @@ My_ContextFavorite::
 rename	(CFStringRef	inNewName)
 {
 	_contextName.setWithRetain(inNewName);
+	_nameResolved = true;
 	return kPreferences_ResultOK;
 }// My_ContextFavorite::rename
 
@@ -4807,6 +5110,12 @@ returnClassDomainNamePrefix		(Quills::Prefs::Class	inClass)
 Returns the name of this context.  This is often
 used in user interface elements.
 
+Contexts registered at startup only know their domain,
+so the name is read from disk the first time that it
+is needed.  If the domain has no name, a unique one is
+generated (as Preferences_NewContextFromFavorites()
+would have done).
+
 (3.1)
 */
 CFStringRef
@@ -4814,6 +5123,25 @@ My_ContextFavorite::
 returnName ()
 const
 {
+	unless (_nameResolved)
+	{
+		// set this first; finding a unique name will scan every
+		// context in the class, including this one
+		_nameResolved = true;
+		_contextName.setWithNoRetain(copyDomainUserSpecifiedName(_domainName.returnCFStringRef()));
+		if (false == _contextName.exists())
+		{
+			CFStringRef		generatedName = nullptr;
+			
+			
+			Console_Warning(Console_WriteValueCFString, "sister domain has no user-specified name; generating one for domain",
+							_domainName.returnCFStringRef());
+			if (kPreferences_ResultOK == Preferences_CreateUniqueContextName(this->returnClass(), generatedName))
+			{
+				_contextName.setWithNoRetain(generatedName);
+			}
+		}
+	}
 	return _contextName.returnCFStringRef();
 }// My_ContextFavorite::returnName
 
@@ -5446,6 +5774,10 @@ changeNotify	(Preferences_Change			inWhatChanged,
 	
 	context.contextRef = inContextOrNull;
 	context.firstCall = inIsInitialValue;
+	if (false == inIsInitialValue)
+	{
+		My_ContextInterface::invalidateCachedValues();
+	}
 	// invoke listener callback routines appropriately, from the preferences listener model
 	ListenerModel_NotifyListenersOfEvent(gPreferenceEventListenerModel, inWhatChanged, &context);
 }// changeNotify
@@ -6067,27 +6399,51 @@ createAllPreferencesContextsFromDisk ()
 			prefsResult = copyClassDomainCFArray(prefsClass, namesInClass);
 		}
 		
-		// create contexts for every domain that was found for this class
+		// register a context for every domain that was found for this class;
+		// to keep startup fast, nothing is read from a domain here (names
+		// and settings are read from disk on first use, which for most
+		// collections is only when a menu or a new session needs them)
 		if (kPreferences_ResultOK == prefsResult)
 		{
-			CFIndex const	kNumberOfFavorites = CFArrayGetCount(namesInClass);
+			CFIndex const				kNumberOfFavorites = CFArrayGetCount(namesInClass);
+			My_FavoriteContextList*		listPtr = nullptr;
 			
 			
-			for (CFIndex i = 0; i < kNumberOfFavorites; ++i)
+			if (getMutableListOfContexts(prefsClass, listPtr))
 			{
-				// simply creating a context will ensure it is retained
-				// internally; so, the return value can be ignored (save
-				// for verifying that it was created successfully)
-				CFStringRef const		kDomainName = CFUtilities_StringCast(CFArrayGetValueAtIndex
-																				(namesInClass, i));
-				CFRetainRelease			favoriteNameCFString(copyDomainUserSpecifiedName(kDomainName), CFRetainRelease::kAlreadyRetained);
-				Preferences_ContextRef	newContext = Preferences_NewContextFromFavorites(prefsClass, favoriteNameCFString.returnCFStringRef(), kDomainName);
-				
+				listPtr->reserve(listPtr->size() + kNumberOfFavorites);
+				for (CFIndex i = 0; i < kNumberOfFavorites; ++i)
+				{
+					CFStringRef const		kDomainName = CFUtilities_StringCast(CFArrayGetValueAtIndex
+																					(namesInClass, i));
+					
+					
+					try
+					{
+						// as with Preferences_NewContextFromFavorites(), the
+						// list holds an implicit reference and the context
+						// is also retained (this is never released)
+						My_ContextFavoritePtr	newContextPtr = new My_ContextFavorite(prefsClass, nullptr/* name is read on demand */,
+																						kDomainName);
+						
+						
+						listPtr->push_back(newContextPtr);
+						Preferences_RetainContext(newContextPtr->selfRef);
+					}
+					catch (std::exception const&	inException)
+					{
+						Console_Warning(Console_WriteValueCFString, "sister domain could not be registered; core application preferences refer to domain", kDomainName);
+						Console_Warning(Console_WriteLine, inException.what());
+					}
+				}
 				
-				if (nullptr == newContext)
+				if (kNumberOfFavorites > 0)
 				{
-					Console_Warning(Console_WriteValueCFString, "sister domain could not be loaded; core application preferences refer to missing domain", kDomainName);
-					Console_Warning(Console_WriteValueCFString, "user-specified name for missing domain", favoriteNameCFString.returnCFStringRef());
+					// since names were not read, a collection that is named
+					// Default or that repeats another name is only found
+					// later (see getListOfContexts())
+					gUncheckedFavoriteClasses().insert(prefsClass);
+					changeNotify(kPreferences_ChangeNumberOfContexts);
 				}
 			}
 			CFRelease(namesInClass), namesInClass = nullptr;
@@ -6612,6 +6968,96 @@ getGeneralPreference	(My_ContextInterfaceConstPtr	inContextPtr,
 					}
 					break;
 				
+				case kPreferences_TagCaptureFileRotationMegabytes:
+				case kPreferences_TagCaptureFileRotationSeconds:
+					assert(kPreferences_DataTypeCFNumberRef == keyValueType);
+					if (false == inContextPtr->exists(keyName))
+					{
+						result = kPreferences_ResultBadVersionDataNotAvailable;
+					}
+					else
+					{
+						SInt32		valueInteger = inContextPtr->returnLong(keyName);
+						
+						
+						// negative values are not meaningful; treat them as “no limit”
+						*(REINTERPRET_CAST(outDataPtr, UInt32*)) = (valueInteger < 0) ? 0 : STATIC_CAST(valueInteger, UInt32);
+					}
+					break;
+				
+				case kPreferences_TagCaptureFileContent:
+					assert(kPreferences_DataTypeCFStringRef == keyValueType);
+					{
+						CFStringRef		valueCFString = inContextPtr->returnStringCopy(keyName);
+						
+						
+						if (nullptr == valueCFString)
+						{
+							result = kPreferences_ResultBadVersionDataNotAvailable;
+						}
+						else
+						{
+							StreamCapture_Content*	storedValuePtr = REINTERPRET_CAST(outDataPtr, StreamCapture_Content*);
+							
+							
+							if (kCFCompareEqualTo == CFStringCompare(valueCFString, CFSTR("text"), kCFCompareCaseInsensitive))
+							{
+								*storedValuePtr = kStreamCapture_ContentRenderedText;
+							}
+							else if (kCFCompareEqualTo == CFStringCompare(valueCFString, CFSTR("raw"), kCFCompareCaseInsensitive))
+							{
+								*storedValuePtr = kStreamCapture_ContentRawBytes;
+							}
+							else if (kCFCompareEqualTo == CFStringCompare(valueCFString, CFSTR("plain-text"), kCFCompareCaseInsensitive))
+							{
+								*storedValuePtr = kStreamCapture_ContentPlainText;
+							}
+							else
+							{
+								result = kPreferences_ResultBadVersionDataNotAvailable;
+							}
+							CFRelease(valueCFString), valueCFString = nullptr;
+						}
+					}
+					break;
+				
+				case kPreferences_TagCaptureFileSyncPolicy:
+					assert(kPreferences_DataTypeCFStringRef == keyValueType);
+					{
+						CFStringRef		valueCFString = inContextPtr->returnStringCopy(keyName);
+						
+						
+						if (nullptr == valueCFString)
+						{
+							result = kPreferences_ResultBadVersionDataNotAvailable;
+						}
+						else
+						{
+							StreamCapture_SyncPolicy*	storedValuePtr = REINTERPRET_CAST(outDataPtr, StreamCapture_SyncPolicy*);
+							
+							
+							if (kCFCompareEqualTo == CFStringCompare(valueCFString, CFSTR("close"), kCFCompareCaseInsensitive))
+							{
+								*storedValuePtr = kStreamCapture_SyncPolicyOnClose;
+							}
+							else if (kCFCompareEqualTo == CFStringCompare(valueCFString, CFSTR("always"), kCFCompareCaseInsensitive))
+							{
+								*storedValuePtr = kStreamCapture_SyncPolicyAlways;
+							}
+							else if (kCFCompareEqualTo == CFStringCompare(valueCFString, CFSTR("never"), kCFCompareCaseInsensitive))
+							{
+								*storedValuePtr = kStreamCapture_SyncPolicyNever;
+							}
+							else
+							{
+								result = kPreferences_ResultBadVersionDataNotAvailable;
+							}
+							CFRelease(valueCFString), valueCFString = nullptr;
+						}
+					}
+					break;
+				
+				case kPreferences_TagCaptureFileCompression:
 				case kPreferences_TagCopySelectedText:
 				case kPreferences_TagCursorBlinks:
 				case kPreferences_TagCursorMovesPriorToDrops:
@@ -6659,6 +7105,7 @@ getGeneralPreference	(My_ContextInterfaceConstPtr	inContextPtr,
 				case kPreferences_TagKioskShowsMenuBar:
 				case kPreferences_TagKioskShowsScrollBar:
 				case kPreferences_TagKioskShowsWindowFrame:
+				case kPreferences_TagLocalSessionsDetachable:
 				case kPreferences_TagNoAnimations:
 					if (false == inContextPtr->exists(keyName))
 					{
@@ -6920,6 +7367,23 @@ getGeneralPreference	(My_ContextInterfaceConstPtr	inContextPtr,
 					}
 					break;
 				
+				case kPreferences_TagWarmShellCount:
+					assert(kPreferences_DataTypeCFNumberRef == keyValueType);
+					if (false == inContextPtr->exists(keyName))
+					{
+						result = kPreferences_ResultBadVersionDataNotAvailable;
+					}
+					else
+					{
+						SInt16		valueInteger = inContextPtr->returnInteger(keyName);
+						
+						
+						// negative values are not meaningful; treat them as “off”, and
+						// keep the number of idle processes reasonable
+						*(REINTERPRET_CAST(outDataPtr, UInt16*)) = STATIC_CAST(std::max< SInt16 >(0, std::min< SInt16 >(valueInteger, 8/* arbitrary */)), UInt16);
+					}
+					break;
+				
 				case kPreferences_TagWasClipboardShowing:
 				case kPreferences_TagWasCommandLineShowing:
 				case kPreferences_TagWasControlKeypadShowing:
@@ -7035,6 +7499,10 @@ Retrieves the list that stores any in-memory settings for the
 specified class (only works for classes that can be collections).
 Returns true unless this fails.
 
+The first time that the list of a class is retrieved after its
+collections are registered at startup, removeShadowedFavorites()
+is called to drop any that cannot be reached by name.
+
 See also getMutableListOfContexts() and
 Preferences_CreateContextNameArray().
 
@@ -7049,6 +7517,12 @@ getListOfContexts	(Quills::Prefs::Class				inClass,
 	Boolean						result = getMutableListOfContexts(inClass, mutablePtr);
 	
 	
+	if (result && (gUncheckedFavoriteClasses().end() != gUncheckedFavoriteClasses().find(inClass)))
+	{
+		// erase first; reading names may scan this list again
+		gUncheckedFavoriteClasses().erase(inClass);
+		removeShadowedFavorites(*mutablePtr);
+	}
 	outListPtr = mutablePtr;
 	return result;
 }// getListOfContexts
@@ -7532,6 +8006,7 @@ getSessionPreference	(My_ContextInterfaceConstPtr	inContextPtr,
 				case kPreferences_TagCaptureFileNameAllowsSubstitutions:
 				case kPreferences_TagLineModeEnabled:
 				case kPreferences_TagLocalEchoEnabled:
+				case kPreferences_TagLocalEchoPredictive:
 				case kPreferences_TagNoPasteWarning:
 				case kPreferences_TagTektronixPAGEClearsScreen:
 					// all of these keys have Core Foundation Boolean values
@@ -8979,6 +9454,73 @@ readPreferencesDictionaryInContext	(My_ContextInterfacePtr		inContextPtr,
 }// readPreferencesDictionaryInContext
 
 
+/*!
+Removes collections from the given list that are named
+Default or that have the same name as a collection that
+is earlier in the list.  These cannot be found by name
+(Preferences_NewContextFromFavorites() would return the
+Default context or the earlier collection instead) so,
+as before collections were registered without reading
+their names, they are not offered at all.  Their data
+on disk is left alone.
+
+Since every name in the list is read, this is only done
+the first time that names are needed (see
+getListOfContexts()).
+
+(2021.06)
+*/
+void
+removeShadowedFavorites		(My_FavoriteContextList&	inoutList)
+{
+	CFRetainRelease				defaultName(UIStrings_ReturnCopy(kUIStrings_PreferencesWindowDefaultFavoriteName),
+											CFRetainRelease::kAlreadyRetained);
+	My_FavoriteContextList		keptList;
+	My_FavoriteContextList		removedList;
+	
+	
+	// read every name before the list changes; if a name must
+	// be generated, the list is scanned to find a unique one
+	for (My_ContextFavoritePtr contextPtr : inoutList)
+	{
+		UNUSED_RETURN(CFStringRef)contextPtr->returnName();
+	}
+	
+	keptList.reserve(inoutList.size());
+	for (My_ContextFavoritePtr contextPtr : inoutList)
+	{
+		CFStringRef const	kName = contextPtr->returnName();
+		
+		
+		if ((nullptr != kName) &&
+			((kCFCompareEqualTo == CFStringCompare(defaultName.returnCFStringRef(), kName, 0/* options */)) ||
+				(keptList.end() != std::find_if(keptList.begin(), keptList.end(), contextNameEqualTo(kName)))))
+		{
+			Console_Warning(Console_WriteValueCFString, "ignoring collection that is named Default or that repeats another name", kName);
+			removedList.push_back(contextPtr);
+		}
+		else
+		{
+			keptList.push_back(contextPtr);
+		}
+	}
+	
+	if (false == removedList.empty())
+	{
+		inoutList.swap(keptList);
+		for (My_ContextFavoritePtr contextPtr : removedList)
+		{
+			// release the reference from registration; since the
+			// context is no longer in the list, this deletes it
+			Preferences_ContextRef		ref = contextPtr->selfRef;
+			
+			
+			Preferences_ReleaseContext(&ref);
+		}
+	}
+}// removeShadowedFavorites
+
+
 /*!
 Modifies the indicated font or color preference using
 the given data (see Preferences.h and the definition of
@@ -9217,6 +9759,71 @@ setGeneralPreference	(My_ContextInterfacePtr		inContextPtr,
 				}
 				break;
 			
+			case kPreferences_TagCaptureFileRotationMegabytes:
+			case kPreferences_TagCaptureFileRotationSeconds:
+				{
+					SInt32 const	data = STATIC_CAST(*(REINTERPRET_CAST(inDataPtr, UInt32 const*)), SInt32);
+					CFNumberRef		numberRef = CFNumberCreate(kCFAllocatorDefault, kCFNumberSInt32Type, &data);
+					
+					
+					if (nullptr != numberRef)
+					{
+						assert(kPreferences_DataTypeCFNumberRef == keyValueType);
+						setApplicationPreference(keyName, numberRef);
+						CFRelease(numberRef), numberRef = nullptr;
+					}
+				}
+				break;
+			
+			case kPreferences_TagCaptureFileContent:
+				{
+					StreamCapture_Content const		data = *(REINTERPRET_CAST(inDataPtr, StreamCapture_Content const*));
+					
+					
+					assert(kPreferences_DataTypeCFStringRef == keyValueType);
+					switch (data)
+					{
+					case kStreamCapture_ContentRawBytes:
+						setApplicationPreference(keyName, CFSTR("raw"));
+						break;
+					
+					case kStreamCapture_ContentPlainText:
+						setApplicationPreference(keyName, CFSTR("plain-text"));
+						break;
+					
+					case kStreamCapture_ContentRenderedText:
+					default:
+						setApplicationPreference(keyName, CFSTR("text"));
+						break;
+					}
+				}
+				break;
+			
+			case kPreferences_TagCaptureFileSyncPolicy:
+				{
+					StreamCapture_SyncPolicy const	data = *(REINTERPRET_CAST(inDataPtr, StreamCapture_SyncPolicy const*));
+					
+					
+					assert(kPreferences_DataTypeCFStringRef == keyValueType);
+					switch (data)
+					{
+					case kStreamCapture_SyncPolicyAlways:
+						setApplicationPreference(keyName, CFSTR("always"));
+						break;
+					
+					case kStreamCapture_SyncPolicyNever:
+						setApplicationPreference(keyName, CFSTR("never"));
+						break;
+					
+					case kStreamCapture_SyncPolicyOnClose:
+					default:
+						setApplicationPreference(keyName, CFSTR("close"));
+						break;
+					}
+				}
+				break;
+			
+			case kPreferences_TagCaptureFileCompression:
 			case kPreferences_TagCopySelectedText:
 				{
 					Boolean const	data = *(REINTERPRET_CAST(inDataPtr, Boolean const*));
@@ -9329,6 +9936,7 @@ setGeneralPreference	(My_ContextInterfacePtr		inContextPtr,
 			case kPreferences_TagKioskShowsMenuBar:
 			case kPreferences_TagKioskShowsScrollBar:
 			case kPreferences_TagKioskShowsWindowFrame:
+			case kPreferences_TagLocalSessionsDetachable:
 			case kPreferences_TagNoAnimations:
 				{
 					Boolean const	data = *(REINTERPRET_CAST(inDataPtr, Boolean const*));
@@ -9512,6 +10120,22 @@ setGeneralPreference	(My_ContextInterfacePtr		inContextPtr,
 				}
 				break;
 			
+			case kPreferences_TagWarmShellCount:
+				{
+					UInt16 const	data = *(REINTERPRET_CAST(inDataPtr, UInt16 const*));
+					CFNumberRef		numberRef = CFNumberCreate(kCFAllocatorDefault, kCFNumberSInt16Type, &data);
+					
+					
+					if (nullptr != numberRef)
+					{
+						assert(kPreferences_DataTypeCFNumberRef == keyValueType);
+						setApplicationPreference(keyName, numberRef);
+						CFRelease(numberRef), numberRef = nullptr;
+						changeNotify(inDataPreferenceTag, inContextPtr->selfRef);
+					}
+				}
+				break;
+			
 			case kPreferences_TagWasClipboardShowing:
 				{
 					Boolean const	data = *(REINTERPRET_CAST(inDataPtr, Boolean const*));
@@ -9855,6 +10479,7 @@ setApplicationPreference	(CFStringRef		inKey,
 							 CFPropertyListRef	inValue)
 {
 	CFPreferencesSetAppValue(inKey, inValue, kCFPreferencesCurrentApplication);
+	My_ContextInterface::invalidateCachedValues();
 #if 1
 	{
 		// for debugging
@@ -10008,6 +10633,7 @@ setSessionPreference	(My_ContextInterfacePtr		inContextPtr,
 			case kPreferences_TagCaptureFileNameAllowsSubstitutions:
 			case kPreferences_TagLineModeEnabled:
 			case kPreferences_TagLocalEchoEnabled:
+			case kPreferences_TagLocalEchoPredictive:
 			case kPreferences_TagNoPasteWarning:
 			case kPreferences_TagTektronixPAGEClearsScreen:
 				{
@@ -11249,6 +11875,66 @@ unitTest003_Begin ()
 	return result;
 }// unitTest003_Begin
 
+
+/*!
+Tests the cache used by Preferences_ContextGetValue():
+repeated reads must return the same value and any
+change must be visible to the next read.
+
+Returns "true" if ALL assertions pass; "false" is
+returned if any fail, however messages should be
+printed for ALL assertion failures regardless.
+
+(2021.06)
+*/
+Boolean
+unitTest004_Begin ()
+{
+	Boolean					result = true;
+	Preferences_ContextRef	testContext = Preferences_NewContext(Quills::Prefs::TERMINAL);
+	
+	
+	result &= Console_Assert("test context exists", nullptr != testContext);
+	if (nullptr != testContext)
+	{
+		UInt16 const	kRows1 = 31;
+		UInt16 const	kRows2 = 42;
+		UInt16			rows = 0;
+		Boolean			isDefault = true;
+		
+		
+		result &= Console_Assert("set rows", kPreferences_ResultOK ==
+											Preferences_ContextSetData(testContext, kPreferences_TagTerminalScreenRows,
+																		sizeof(kRows1), &kRows1));
+		result &= Console_Assert("first read succeeds", kPreferences_ResultOK ==
+														Preferences_ContextGetValue< kPreferences_TagTerminalScreenRows >
+														(testContext, rows, false/* search defaults */, &isDefault));
+		result &= Console_Assert("first read is correct", kRows1 == rows);
+		result &= Console_Assert("first read is not default", false == isDefault);
+		rows = 0;
+		isDefault = true;
+		result &= Console_Assert("cached read succeeds", kPreferences_ResultOK ==
+															Preferences_ContextGetValue< kPreferences_TagTerminalScreenRows >
+															(testContext, rows, false/* search defaults */, &isDefault));
+		result &= Console_Assert("cached read is correct", kRows1 == rows);
+		result &= Console_Assert("cached read is not default", false == isDefault);
+		result &= Console_Assert("change rows", kPreferences_ResultOK ==
+												Preferences_ContextSetData(testContext, kPreferences_TagTerminalScreenRows,
+																			sizeof(kRows2), &kRows2));
+		result &= Console_Assert("read after change succeeds", kPreferences_ResultOK ==
+																Preferences_ContextGetValue< kPreferences_TagTerminalScreenRows >
+																(testContext, rows));
+		result &= Console_Assert("read after change is correct", kRows2 == rows);
+		result &= Console_Assert("delete rows", kPreferences_ResultOK ==
+												Preferences_ContextDeleteData(testContext, kPreferences_TagTerminalScreenRows));
+		result &= Console_Assert("read after delete fails", kPreferences_ResultOK !=
+															Preferences_ContextGetValue< kPreferences_TagTerminalScreenRows >
+															(testContext, rows));
+		Preferences_ReleaseContext(&testContext);
+	}
+	return result;
+}// unitTest004_Begin
+
 } // anonymous namespace
 
 // BELOW IS REQUIRED NEWLINE TO END FILE
@@ -60,6 +60,7 @@
 #pragma once
 
 // standard-C++ includes
+#include <type_traits>
 #include <vector>
 
 // Mac includes
@@ -210,7 +211,12 @@ Tags for use with Quills::Prefs::GENERAL.
 enum
 {
 	kPreferences_TagBellSound							= 'bsnd',	//!< data: "CFStringRef" ("off", or the basename of sound file in a Sounds library folder)
+	kPreferences_TagCaptureFileCompression				= 'cfgz',	//!< data: "Boolean", true to write gzip-compressed capture files
+	kPreferences_TagCaptureFileContent					= 'cfct',	//!< data: "StreamCapture_Content"
 	kPreferences_TagCaptureFileLineEndings				= 'cple',	//!< data: "Session_LineEnding"
+	kPreferences_TagCaptureFileRotationMegabytes		= 'cfrm',	//!< data: "UInt32", capture file size that starts a new file (0 = unlimited)
+	kPreferences_TagCaptureFileRotationSeconds			= 'cfrs',	//!< data: "UInt32", capture file age that starts a new file (0 = unlimited)
+	kPreferences_TagCaptureFileSyncPolicy				= 'cfsy',	//!< data: "StreamCapture_SyncPolicy"
 	kPreferences_TagCopySelectedText					= 'cpsl',	//!< data: "Boolean"
 	kPreferences_TagCopyTableThreshold					= 'ctth',	//!< data: "UInt16", the number of spaces per tab
 	kPreferences_TagCursorBlinks						= 'curf',	//!< data: "Boolean"
@@ -225,6 +231,7 @@ enum
 	kPreferences_TagKioskShowsMenuBar					= 'kmnb',	//!< data: "Boolean"
 	kPreferences_TagKioskShowsScrollBar					= 'kscr',	//!< data: "Boolean"
 	kPreferences_TagKioskShowsWindowFrame				= 'kwnf',	//!< data: "Boolean"
+	kPreferences_TagLocalSessionsDetachable				= 'ldet',	//!< data: "Boolean"
 	kPreferences_TagMapBackquote						= 'map`',	//!< data: "Boolean"
 	kPreferences_TagNewCommandShortcutEffect			= 'new?',	//!< data: "SessionFactory_SpecialSession"
 	kPreferences_TagNoAnimations						= 'nanm',	//!< data: "Boolean"
@@ -236,6 +243,7 @@ enum
 	kPreferences_TagTerminalResizeAffectsFontSize		= 'rszf',	//!< data: "Boolean"
 	kPreferences_TagTerminalShowMarginAtColumn			= 'smar',	//!< data: "UInt16"; 0 turns off, 1 is first column, etc.
 	kPreferences_TagVisualBell							= 'visb',	//!< data: "Boolean"
+	kPreferences_TagWarmShellCount						= 'wshc',	//!< data: "UInt16", number of default sessions started in advance (0 = off)
 	kPreferences_TagWasClipboardShowing					= 'wvcl',	//!< data: "Boolean"
 	kPreferences_TagWasCommandLineShowing				= 'wvcm',	//!< data: "Boolean"
 	kPreferences_TagWasControlKeypadShowing				= 'wvck',	//!< data: "Boolean"
@@ -290,6 +298,7 @@ enum
 	kPreferences_TagKeySuspendOutput					= 'ksus',	//!< data: "char" (actual non-printable ASCII control character)
 	kPreferences_TagLineModeEnabled						= 'linm',	//!< data: "Boolean"
 	kPreferences_TagLocalEchoEnabled					= 'echo',	//!< data: "Boolean"
+	kPreferences_TagLocalEchoPredictive					= 'echp',	//!< data: "Boolean"
 	kPreferences_TagMapDeleteToBackspace				= 'delb',	//!< data: "Boolean"
 	kPreferences_TagNewLineMapping						= 'newl',	//!< data: "UInt16" (Session_NewlineMode)
 	kPreferences_TagNoPasteWarning						= 'npwr',	//!< data: "Boolean"
@@ -607,6 +616,15 @@ Preferences_Result
 Preferences_Result
 	Preferences_ContextDeleteFromFavorites	(Preferences_ContextRef				inContext);
 
+// USE Preferences_ContextGetValue() INSTEAD
+Preferences_Result
+	Preferences_ContextGetCachedData		(Preferences_ContextRef				inStartingContext,
+											 Preferences_Tag					inDataPreferenceTag,
+											 size_t								inDataStorageSize,
+											 void*								outDataStorage,
+											 Boolean							inSearchDefaults = false,
+											 Boolean*							outIsDefaultOrNull = nullptr);
+
 Preferences_Result
 	Preferences_ContextGetData				(Preferences_ContextRef				inStartingContext,
 											 Preferences_Tag					inDataPreferenceTag,
@@ -716,6 +734,12 @@ Preferences_Result
 Preferences_Result
 	Preferences_Save						();
 
+// USE Preferences_GetValue() INSTEAD
+Preferences_Result
+	Preferences_GetCachedData				(Preferences_Tag					inDataPreferenceTag,
+											 size_t								inDataStorageSize,
+											 void*								outDataStorage);
+
 // DEPRECATED
 Preferences_Result
 	Preferences_GetData						(Preferences_Tag					inDataPreferenceTag,
@@ -803,4 +827,100 @@ allocated) contexts too.
 */
 typedef RetainRelease< _Preferences_ContextRefMgr >		Preferences_ContextWrap;
 
+/*!
+Maps a preference tag to the C++ type of its data, so
+that Preferences_ContextGetValue() and Preferences_GetValue()
+can check the storage type at compile time.  Only tags
+whose data is a plain value (no Core Foundation objects,
+no pointers) have traits; add a specialization as needed
+to make another tag readable through the cached APIs.
+
+(2021.06)
+*/
+template < Preferences_Tag kTag >
+struct Preferences_TagTraits; // only specializations are defined
+
+#define PREFERENCES_TAG_TRAITS(inTag, inType)	\
+	template <> struct Preferences_TagTraits< inTag > { typedef inType ValueType; }
+
+PREFERENCES_TAG_TRAITS(kPreferences_TagAutoSetCursorColor,					Boolean);
+PREFERENCES_TAG_TRAITS(kPreferences_TagCaptureFileCompression,				Boolean);
+PREFERENCES_TAG_TRAITS(kPreferences_TagCaptureFileRotationMegabytes,		UInt32);
+PREFERENCES_TAG_TRAITS(kPreferences_TagCaptureFileRotationSeconds,			UInt32);
+PREFERENCES_TAG_TRAITS(kPreferences_TagCopySelectedText,					Boolean);
+PREFERENCES_TAG_TRAITS(kPreferences_TagCursorBlinks,						Boolean);
+PREFERENCES_TAG_TRAITS(kPreferences_TagCursorMovesPriorToDrops,				Boolean);
+PREFERENCES_TAG_TRAITS(kPreferences_TagDontDimBackgroundScreens,			Boolean);
+PREFERENCES_TAG_TRAITS(kPreferences_TagFontCharacterWidthMultiplier,		Float32);
+PREFERENCES_TAG_TRAITS(kPreferences_TagFontSize,							Float64);
+PREFERENCES_TAG_TRAITS(kPreferences_TagIdleAfterInactivityInSeconds,		UInt16);
+PREFERENCES_TAG_TRAITS(kPreferences_TagITermGraphicsEnabled,				Boolean);
+PREFERENCES_TAG_TRAITS(kPreferences_TagKeepAlivePeriodInMinutes,			UInt16);
+PREFERENCES_TAG_TRAITS(kPreferences_TagKioskAllowsForceQuit,				Boolean);
+PREFERENCES_TAG_TRAITS(kPreferences_TagLocalSessionsDetachable,			Boolean);
+PREFERENCES_TAG_TRAITS(kPreferences_TagNotifyOfBeeps,						Boolean);
+PREFERENCES_TAG_TRAITS(kPreferences_TagPureInverse,							Boolean);
+PREFERENCES_TAG_TRAITS(kPreferences_TagSixelGraphicsEnabled,				Boolean);
+PREFERENCES_TAG_TRAITS(kPreferences_TagTerminal24BitColorEnabled,			Boolean);
+PREFERENCES_TAG_TRAITS(kPreferences_TagTerminalClearSavesLines,				Boolean);
+PREFERENCES_TAG_TRAITS(kPreferences_TagTerminalMarginBottom,				Float32);
+PREFERENCES_TAG_TRAITS(kPreferences_TagTerminalMarginLeft,					Float32);
+PREFERENCES_TAG_TRAITS(kPreferences_TagTerminalMarginRight,					Float32);
+PREFERENCES_TAG_TRAITS(kPreferences_TagTerminalMarginTop,					Float32);
+PREFERENCES_TAG_TRAITS(kPreferences_TagTerminalPaddingBottom,				Float32);
+PREFERENCES_TAG_TRAITS(kPreferences_TagTerminalPaddingLeft,					Float32);
+PREFERENCES_TAG_TRAITS(kPreferences_TagTerminalPaddingRight,				Float32);
+PREFERENCES_TAG_TRAITS(kPreferences_TagTerminalPaddingTop,					Float32);
+PREFERENCES_TAG_TRAITS(kPreferences_TagTerminalResizeAffectsFontSize,		Boolean);
+PREFERENCES_TAG_TRAITS(kPreferences_TagTerminalScreenColumns,				UInt16);
+PREFERENCES_TAG_TRAITS(kPreferences_TagTerminalScreenRows,					UInt16);
+PREFERENCES_TAG_TRAITS(kPreferences_TagTerminalScreenScrollbackRows,		UInt32);
+PREFERENCES_TAG_TRAITS(kPreferences_TagTerminalShowMarginAtColumn,			UInt16);
+PREFERENCES_TAG_TRAITS(kPreferences_TagWarmShellCount,						UInt16);
+PREFERENCES_TAG_TRAITS(kPreferences_TagXTerm256ColorsEnabled,				Boolean);
+PREFERENCES_TAG_TRAITS(kPreferences_TagXTermBackgroundColorEraseEnabled,	Boolean);
+PREFERENCES_TAG_TRAITS(kPreferences_TagXTermReportedPatchLevel,				UInt16);
+PREFERENCES_TAG_TRAITS(kPreferences_TagXTermWindowAlterationEnabled,		Boolean);
+
+#undef PREFERENCES_TAG_TRAITS
+
+/*!
+Typed equivalent of Preferences_ContextGetData() for tags
+that have Preferences_TagTraits.  The value is decoded once
+and then served from a small cache in the context until any
+preference change invalidates it, so this is appropriate
+for code that reads the same setting repeatedly.
+
+(2021.06)
+*/
+template < Preferences_Tag kTag >
+inline Preferences_Result
+	Preferences_ContextGetValue		(Preferences_ContextRef										inStartingContext,
+									 typename Preferences_TagTraits< kTag >::ValueType&			outValue,
+									 Boolean													inSearchDefaults = false,
+									 Boolean*													outIsDefaultOrNull = nullptr)
+	{
+		typedef typename Preferences_TagTraits< kTag >::ValueType	ValueType;
+		static_assert(std::is_trivially_copyable< ValueType >::value, "cached preference values must be plain data");
+		static_assert(false == std::is_pointer< ValueType >::value, "cached preference values cannot be pointers");
+		return Preferences_ContextGetCachedData(inStartingContext, kTag, sizeof(outValue), &outValue,
+												inSearchDefaults, outIsDefaultOrNull);
+	}
+
+/*!
+Typed equivalent of Preferences_GetData(); see also
+Preferences_ContextGetValue().
+
+(2021.06)
+*/
+template < Preferences_Tag kTag >
+inline Preferences_Result
+	Preferences_GetValue			(typename Preferences_TagTraits< kTag >::ValueType&			outValue)
+	{
+		typedef typename Preferences_TagTraits< kTag >::ValueType	ValueType;
+		static_assert(std::is_trivially_copyable< ValueType >::value, "cached preference values must be plain data");
+		static_assert(false == std::is_pointer< ValueType >::value, "cached preference values cannot be pointers");
+		return Preferences_GetCachedData(kTag, sizeof(outValue), &outValue);
+	}
+
 // BELOW IS REQUIRED NEWLINE TO END FILE
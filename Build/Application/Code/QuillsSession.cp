@@ -147,6 +147,29 @@ _session(nullptr)
 }// default constructor
 
 
+/*!
+See header or "pydoc" for Python docstrings.
+
+(2021.06)
+*/
+unsigned int
+Session::broadcast_group ()
+{
+	unsigned int	result = 0;
+	
+	
+	if (nullptr == _session)
+	{
+		QUILLS_THROW_MSG("specified session does not have this information");
+	}
+	else
+	{
+		result = Session_ReturnBroadcastGroup(_session);
+	}
+	return result;
+}// broadcast_group
+
+
 /*!
 See header or "pydoc" for Python docstrings.
 
@@ -199,6 +222,31 @@ Session::resource_location_string ()
 }// resource_location_string
 
 
+/*!
+See header or "pydoc" for Python docstrings.
+
+(2021.06)
+*/
+void
+Session::set_broadcast_group	(unsigned int	inGroupNumber)
+{
+	if (nullptr == _session)
+	{
+		QUILLS_THROW_MSG("specified session cannot join a broadcast group");
+	}
+	else
+	{
+		Session_Result	sessionResult = Session_SetBroadcastGroup(_session, inGroupNumber);
+		
+		
+		if (false == sessionResult.ok())
+		{
+			QUILLS_THROW_MSG("unable to change the broadcast group of the session (it may have no running process); error " << sessionResult.code());
+		}
+	}
+}// set_broadcast_group
+
+
 /*!
 See header or "pydoc" for Python docstrings.
 
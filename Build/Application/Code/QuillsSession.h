@@ -71,6 +71,26 @@ terminated by the user or the command finishes.\n\
 	Session	(std::vector< std::string >		argv,
 			 std::string					cwd = "");
 	
+#if SWIG
+%feature("docstring",
+"Return the number of the broadcast group that the session\n\
+belongs to, or 0 if it is not in a group.  See\n\
+set_broadcast_group().\n\
+") broadcast_group;
+
+// raise Python exception if C++ throws anything
+%exception broadcast_group
+{
+	try
+	{
+		$action
+	}
+	SWIG_CATCH_STDEXCEPT // catch various std::exception derivatives
+	QUILLS_CATCH_ALL
+}
+#endif
+	unsigned int broadcast_group ();
+	
 #if SWIG
 %feature("docstring",
 "Return the path of the pseudo-terminal device connected to the\n\
@@ -114,6 +134,32 @@ The character encoding is UTF-8.\n\
 #endif
 	std::string resource_location_string ();
 	
+#if SWIG
+%feature("docstring",
+"Add the session to a broadcast group, or remove it from its\n\
+current group if the number is 0.  Keys, text and Pastes that\n\
+are typed into any session in a group are sent to every session\n\
+in the group, each in the form that its own terminal expects.\n\
+\n\
+A session whose process falls too far behind in reading its\n\
+input is removed from its group automatically.\n\
+\n\
+Raises an exception if the session has no running process.\n\
+") set_broadcast_group;
+
+// raise Python exception if C++ throws anything
+%exception set_broadcast_group
+{
+	try
+	{
+		$action
+	}
+	SWIG_CATCH_STDEXCEPT // catch various std::exception derivatives
+	QUILLS_CATCH_ALL
+}
+#endif
+	void set_broadcast_group (unsigned int	group);
+	
 #if SWIG
 %feature("docstring",
 "Return a simple string description of the current state of the\n\
@@ -34,14 +34,19 @@
 #include <UniversalDefines.h>
 
 // standard-C++ includes
+#include <algorithm>
 #include <stdexcept>
 #include <string>
 #include <utility>
 #include <vector>
 
 // library includes
+#include <CFRetainRelease.h>
 #include <Console.h>
 
+// application includes
+#include "WordBoundary.h"
+
 
 
 #pragma mark variables
@@ -70,6 +75,29 @@ Terminal::set_dumb_string_for_char	(unsigned short		unicode,
 }
 
 
+/*!
+See header or "pydoc" for Python docstrings.
+
+(2021.06)
+*/
+void
+Terminal::set_word_characters	(std::string	characters_utf8)
+{
+	CFRetainRelease		charactersCFString(CFStringCreateWithCString(kCFAllocatorDefault, characters_utf8.c_str(), kCFStringEncodingUTF8),
+											CFRetainRelease::kAlreadyRetained);
+	
+	
+	if (false == charactersCFString.exists())
+	{
+		throw std::invalid_argument("word characters must use UTF-8 encoding");
+	}
+	unless (WordBoundary_SetSharedWordCharacters(charactersCFString.returnCFStringRef()))
+	{
+		throw std::runtime_error("unable to change word characters");
+	}
+}
+
+
 /*!
 See header or "pydoc" for Python docstrings.
 
@@ -96,10 +124,62 @@ Terminal::word_of_char_in_string	(std::string	text_utf8,
 		
 		delete [] mutableTextCopy;
 	}
+	else
+	{
+		// use the same word finder as terminal views; offsets count
+		// characters, so a surrogate pair counts as one offset
+		CFRetainRelease		textCFString(CFStringCreateWithCString(kCFAllocatorDefault, text_utf8.c_str(), kCFStringEncodingUTF8),
+											CFRetainRelease::kAlreadyRetained);
+		
+		
+		if (textCFString.exists())
+		{
+			UInt16 const			kLength = STATIC_CAST(std::min< CFIndex >(CFStringGetLength(textCFString.returnCFStringRef()), 0xFFFF), UInt16);
+			std::vector< UniChar >	text(kLength);
+			std::vector< long >		offsetForIndex(kLength + 1);
+			long					characterOffset = 0;
+			UInt16					offsetIndex = kLength;
+			UInt16					startIndex = 0;
+			UInt16					pastTheEndIndex = 0;
+			
+			
+			CFStringGetCharacters(textCFString.returnCFStringRef(), CFRangeMake(0, kLength), text.data());
+			for (UInt16 i = 0; i < kLength; ++i)
+			{
+				if ((text[i] < 0xDC00) || (text[i] > 0xDFFF))
+				{
+					if (characterOffset == offset)
+					{
+						offsetIndex = i;
+					}
+					++characterOffset;
+				}
+				offsetForIndex[i + 1] = characterOffset;
+			}
+			if (WordBoundary_FindWord(WordBoundary_ReturnSharedClassifier(), text.data(), kLength, offsetIndex,
+										startIndex, pastTheEndIndex))
+			{
+				result.first = offsetForIndex[startIndex];
+				result.second = (offsetForIndex[pastTheEndIndex] - offsetForIndex[startIndex]);
+			}
+		}
+	}
 	return result;
 }// word_of_char_in_string
 
 
+/*!
+See header.
+
+(2021.06)
+*/
+bool
+Terminal::_has_seekword_call ()
+{
+	return (nullptr != gTerminalSeekWordCallbackInvoker);
+}// _has_seekword_call
+
+
 /*!
 See header or "pydoc" for Python docstrings.
 
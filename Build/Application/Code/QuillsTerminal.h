@@ -74,6 +74,31 @@ just prints the numerical value in angle brackets.\n\
 	static void set_dumb_string_for_char	(unsigned short		unicode,
 											 std::string		rendering_utf8);
 	
+#if SWIG
+%feature("docstring",
+"Specify which characters (besides letters and digits) are part\n\
+of words, when MacTerm finds the word that the user double-clicks.\n\
+These characters join adjacent words, so for instance if \"/\" is\n\
+given then a double-click selects an entire file path.  The given\n\
+string must use UTF-8 encoding.  The default is \"-+/\\~_\".\n\
+\n\
+This has no effect if a function was registered with\n\
+on_seekword_call().\n\
+") set_word_characters;
+
+// raise Python exception if C++ throws anything
+%exception set_word_characters
+{
+	try
+	{
+		$action
+	}
+	SWIG_CATCH_STDEXCEPT // catch various std::exception derivatives
+	QUILLS_CATCH_ALL
+}
+#endif
+	static void set_word_characters		(std::string		characters_utf8);
+	
 #if SWIG
 %feature("docstring",
 "Return a pair of integers as a tuple, that locates a word in\n\
@@ -88,8 +113,10 @@ first element, and the second element is 1.\n\
 \n\
 The character encoding of the given string must be UTF-8.\n\
 \n\
-Note that this calls what was registered with on_seekword_call(),\n\
-and MacTerm installs its own routine by default.\n\
+Note that this calls what was registered with on_seekword_call();\n\
+if nothing was registered, MacTerm finds the word itself, using\n\
+Unicode word boundaries and the characters given to\n\
+set_word_characters().\n\
 ") word_of_char_in_string;
 
 // raise Python exception if C++ throws anything
@@ -106,6 +133,9 @@ and MacTerm installs its own routine by default.\n\
 	static std::pair<long, long> word_of_char_in_string		(std::string	text_utf8,
 															 long			offset);
 	
+	// only intended for direct use by MacTerm; true if on_seekword_call() was used
+	static bool _has_seekword_call		();
+	
 	// only intended for direct use by the SWIG wrapper
 	static void _on_seekword_call_py 	(Quills::FunctionReturnLongPairArg1VoidPtrArg2CharPtrArg3Long, void*);
 };
@@ -96,6 +96,9 @@ enum
 	kSession_AllChanges					= '****',	//!< wildcard to indicate all events (context:
 													//!  varies)
 	
+	kSession_ChangePasteProgress		= 'Pste',	//!< a Paste has started, ended or made progress (see
+													//!  Session_ReturnPasteProgress()) (context: SessionRef)
+	
 	kSession_ChangeResourceLocation		= 'SURL',	//!< the URL of a monitored Session has been updated
 													//!  (context: SessionRef)
 	
@@ -377,6 +380,21 @@ Session_Result
 	Session_UserInputPaste					(SessionRef							inRef,
 											 NSPasteboard*						inSourceOrNull = nullptr);
 
+void
+	Session_UserInputPasteCancel			(SessionRef							inRef);
+
+//@}
+
+//!\name Broadcasting Input
+//@{
+
+UInt32
+	Session_ReturnBroadcastGroup			(SessionRef							inRef);
+
+Session_Result
+	Session_SetBroadcastGroup				(SessionRef							inRef,
+											 UInt32								inGroupNumberOrZero);
+
 //@}
 
 //!\name Write-Targeting Routines
@@ -474,6 +492,11 @@ void
 void
 	Session_SetLocalEchoHalfDuplex			(SessionRef							inRef);
 
+// HAS NO EFFECT UNLESS THE SESSION IS SLOW (SEE Session_ReturnEchoRoundTripMilliseconds())
+void
+	Session_SetLocalEchoPredictive			(SessionRef							inRef,
+											 Boolean							inIsEnabled);
+
 void
 	Session_SetNetworkSuspended				(SessionRef							inRef,
 											 Boolean							inScrollLock);
@@ -520,9 +543,15 @@ Boolean
 Boolean
 	Session_LocalEchoIsHalfDuplex			(SessionRef							inRef);
 
+Boolean
+	Session_LocalEchoIsPredictive			(SessionRef							inRef);
+
 Boolean
 	Session_NetworkIsSuspended				(SessionRef							inRef);
 
+Boolean
+	Session_PasteIsInProgress				(SessionRef							inRef);
+
 NSWindow*
 	Session_ReturnActiveNSWindow			(SessionRef							inRef);
 
@@ -539,12 +568,20 @@ CFArrayRef
 Preferences_ContextRef
 	Session_ReturnConfiguration				(SessionRef							inRef);
 
+// ZERO IF UNKNOWN (INCLUDING WHEN PREDICTIVE LOCAL ECHO IS OFF)
+UInt32
+	Session_ReturnEchoRoundTripMilliseconds	(SessionRef							inRef);
+
 Session_EventKeys
 	Session_ReturnEventKeys					(SessionRef							inRef);
 
 CFStringRef
 	Session_ReturnOriginalWorkingDirectory	(SessionRef							inRef);
 
+// FRACTION FROM 0 TO 1
+Float32
+	Session_ReturnPasteProgress				(SessionRef							inRef);
+
 CFStringRef
 	Session_ReturnPseudoTerminalDeviceNameCFString	(SessionRef					inRef);
 
@@ -44,6 +44,7 @@
 
 // standard-C++ includes
 #import <algorithm>
+#import <chrono>
 #import <map>
 #import <set>
 #import <vector>
@@ -58,6 +59,7 @@
 
 // library includes
 #import <AlertMessages.h>
+#import <AsyncWriter.h>
 #import <CFRetainRelease.h>
 #import <CFUtilities.h>
 #import <CocoaAnimation.h>
@@ -71,15 +73,20 @@
 #import <RegionUtilities.h>
 #import <SoundSystem.h>
 #import <StringUtilities.h>
+#import <TimerWheel.h>
+#import <TraceSpan.h>
 #import <WindowTitleDialog.h>
 
 // application includes
 #import "AppResources.h"
+#import "BroadcastGroup.h"
 #import "Clipboard.h"
 #import "Commands.h"
+#import "EchoPredictor.h"
 #import "GenericDialog.h"
 #import "Local.h"
 #import "MacroManager.h"
+#import "PasteStream.h"
 #import "Preferences.h"
 #import "PrefPanelSessions.h"
 #import "QuillsSession.h"
@@ -116,6 +123,13 @@ enum My_SessionSheetType
 	kMy_SessionSheetTypeSpecialKeySequences		= 1
 };
 
+CFIndex const	kMy_PasteChunkLength = 4096;						// characters of a paste that are converted at a time
+CFIndex const	kMy_PasteCharactersPerBatch = 65536;				// characters of a paste that are sent before other events are handled
+int64_t const	kMy_PasteRetryDelayInNanoseconds = 10000000;		// time to wait when the process is not reading (10 milliseconds)
+UInt16 const	kMy_PasteRetryLimit = 1000;							// number of waits with no progress before a paste is abandoned
+size_t const	kMy_BroadcastBacklogLimit = 65536;					// bytes of unwritten input above which a session leaves its broadcast group
+UInt32 const	kMy_KeySignatureEmacsArrows = (1U << 31);			// added to Terminal_KeyModes when arrows are remapped (see broadcastKey())
+
 } // anonymous namespace
 
 
@@ -199,13 +213,15 @@ struct My_Session
 	ListenerModel_ListenerWrap	terminalViewListener;		// responds when terminal view or screen states change
 	ListenerModel_ListenerWrap	vectorWindowListener;		// responds when vector graphics window states change
 	ListenerModel_ListenerWrap	preferencesListener;		// responds when certain preference values are initialized or changed
-	NSTimer* __strong			longLifeTimer;				// called when a session has been open 15 seconds; retain in order to invalidate at destruction time
-	NSTimer* __strong			respawnSessionTimer;		// called when a session should be respawned; retain in order to invalidate at destruction time
+	TimerWheel_TimerRef			longLifeTimer;				// called when a session has been open 15 seconds
+	TimerWheel_TimerRef			respawnSessionTimer;		// called when a session should be respawned
 	MemoryBlocks_WeakPairWrap
 	< SessionRef,
 		GenericDialog_Ref >		currentDialog;				// weak reference while a sheet is still open so a 2nd sheet is not displayed
 	TerminalWindowRef			terminalWindow;				// terminal window housing this session
 	Local_ProcessRef			mainProcess;				// the command whose output is directly attached to the terminal
+	AsyncWriter_Ref				inputWriter;				// if defined, writes data to "mainProcess" in the background (see Session_SendData())
+	UInt32						broadcastGroup;				// if nonzero, user input is sent to every session in the group (see Session_SetBroadcastGroup())
 	Session_EventKeys			eventKeys;					// information on keyboard short-cuts for major events
 	My_TEKGraphicList			targetVectorGraphics;		// list of TEK graphics attached to this session
 	My_TerminalScreenList		targetDumbTerminals;		// list of DUMB terminals to which incoming data is being copied
@@ -223,7 +239,15 @@ struct My_Session
 	std::unique_ptr< UInt8[] >	readBufferPtr;				// buffer space for processing data
 	CFStringEncoding			writeEncoding;				// the character set that text (data) sent to a session should be using
 	Session_Watch				activeWatch;				// if any, what notification is currently set up for internal data events
-	NSTimer* __strong			inactivityWatchTimer;		// called if data has not arrived after awhile; retain in order to invalidate at destruction time
+	TimerWheel_TimerRef			inactivityWatchTimer;		// called if data has not arrived after awhile; re-armed as data arrives
+	PasteStream_Ref				pasteStream;				// if defined, text that is being pasted (see pasteStreamContinue())
+	std::vector< UniChar >		pasteChunk;					// current part of the paste; empty when there is no paste
+	CFIndex						pasteChunkLength;			// number of characters in "pasteChunk" that are valid
+	CFIndex						pasteChunkOffset;			// number of characters in "pasteChunk" that have been sent
+	int64_t						pasteLineDelay;				// if nonzero, nanoseconds to wait after each line of the paste
+	UInt32						pasteSerialNumber;			// changes when a paste ends, so that blocks scheduled for it do nothing
+	UInt16						pasteStallCount;			// number of waits in a row during which none of the paste could be sent
+	SInt16						pasteReportedPercent;		// progress in the last "kSession_ChangePasteProgress" notification
 	Preferences_ContextWrap		recentSheetContext;			// defined temporarily while a Preferences-dependent sheet (such as key sequences) is up
 	My_SessionSheetType			sheetType;					// if "kMy_SessionSheetTypeNone", no significant sheet is currently open
 	WindowTitleDialog_Ref __strong	renameDialog;			// if defined, the user interface for renaming the terminal window
@@ -235,6 +259,8 @@ struct My_Session
 		Boolean		enabled;		//!< is local echo enabled?
 		Boolean		halfDuplex;		//!< data is echoed and sent immediately, instead of waiting for
 									//!  a control key (as in full duplex)
+		EchoPredictor_Ref	predictor;	//!< if defined, typed characters are displayed before the
+										//!  server echoes them (see Session_SetLocalEchoPredictive())
 	} echo;
 	
 	struct
@@ -256,6 +282,10 @@ typedef MemoryBlockReferenceTracker< SessionRef >		My_SessionRefTracker;
 namespace {
 
 Boolean						autoCaptureSessionToFile			(My_SessionPtr);
+void						broadcastGroupLeave					(My_SessionPtr, Boolean);
+void						broadcastKey						(My_SessionPtr, UInt8, UInt64);
+void						broadcastPaste						(My_SessionPtr, CFStringRef, Boolean);
+void						broadcastString						(My_SessionPtr, CFStringRef);
 Boolean						captureToFile						(My_SessionPtr, CFURLRef, CFStringRef);
 void						changeNotifyForSession				(My_SessionPtr, Session_Change, void*);
 void						changeStateAttributes				(My_SessionPtr, Session_StateAttributes,
@@ -264,14 +294,31 @@ void						closeTerminalWindow					(My_SessionPtr);
 UInt16						copyAutoCapturePreferences			(My_SessionPtr, Preferences_ContextRef, Boolean);
 UInt16						copyEventKeyPreferences				(My_SessionPtr, Preferences_ContextRef, Boolean);
 UInt16						copyVectorGraphicsPreferences		(My_SessionPtr, Preferences_ContextRef, Boolean);
+void						enqueueInput						(My_SessionPtr, AsyncWriter_Buffer const&);
 void						handleSaveFromPanel					(My_SessionPtr, NSSavePanel*);
 Boolean						isReadOnly							(My_SessionPtr);
 void						localEchoKey						(My_SessionPtr, UInt8);
 void						localEchoString						(My_SessionPtr, CFStringRef);
+void						localEchoVTKey						(My_SessionPtr, UInt8);
+void						longLifeTimerFired					(TimerWheel_TimerRef, void*);
+AsyncWriter_Buffer			newEncodedInput						(CFStringRef, CFStringEncoding);
+AsyncWriter_Buffer			newKeyInput							(UInt8, UInt64, UInt32);
+void						pasteStreamContinue					(My_SessionPtr);
+void						pasteStreamSchedule					(My_SessionPtr, int64_t);
+void						pasteStreamStart					(My_SessionPtr, CFStringRef, Boolean);
+void						pasteStreamStop						(My_SessionPtr);
+void						predictionAddInput					(My_SessionPtr, CFStringRef);
+void						predictionAddOtherInput				(My_SessionPtr);
+void						predictionTerminalChanged			(My_SessionPtr);
+void						predictionUpdateDisplay				(My_SessionPtr);
 void						preferenceChanged					(ListenerModel_Ref, ListenerModel_Event,
 																 void*, void*);
 void						processMoreData						(My_SessionPtr);
+void						respawnTimerFired					(TimerWheel_TimerRef, void*);
 NSWindow*					returnActiveNSWindow				(My_SessionPtr);
+std::vector< SessionRef >	returnBroadcastMembers				(My_SessionPtr);
+std::string					returnEmacsArrowSequence			(UInt8, UInt64);
+UInt64						returnMonotonicNanoseconds			();
 void						setIconFromState					(My_SessionPtr);
 void						sheetClosed							(GenericDialog_Ref, Boolean);
 Preferences_ContextRef		sheetContextBegin					(My_SessionPtr, Quills::Prefs::Class,
@@ -290,6 +337,7 @@ void						vectorGraphicsWindowChanged			(ListenerModel_Ref, ListenerModel_Event,
 																 void*, void*);
 void						watchClearForSession				(My_SessionPtr);
 void						watchNotifyForSession				(My_SessionPtr, Session_Watch);
+void						watchTimerFired						(TimerWheel_TimerRef, void*);
 void						watchTimerResetForSession			(My_SessionPtr, Session_Watch);
 void						windowValidationStateChanged		(ListenerModel_Ref, ListenerModel_Event,
 																 void*, void*);
@@ -621,6 +669,7 @@ Session_AppendDataForProcessing		(SessionRef		inRef,
 									 size_t			inSize,
 									 size_t*		outUnprocessedSizePtr)
 {
+	TraceSpan_ScopeWithByteCount("Session_AppendDataForProcessing", inSize);
 	Session_Result			result = kSession_ResultInvalidReference;
 	size_t					unprocessedSize = inSize;
 	My_SessionAutoLocker	ptr(gSessionPtrLocks(), inRef);
@@ -1372,7 +1421,7 @@ destroyed at any time).
 Boolean
 Session_IsValid		(SessionRef		inRef)
 {
-	Boolean		result = ((nullptr != inRef) && (gInvalidSessions().find(inRef) == gInvalidSessions().end()));
+	Boolean		result = ((nullptr != inRef) && (false == gInvalidSessions().contains(inRef)));
 	
 	
 	return result;
@@ -1417,6 +1466,23 @@ Session_LocalEchoIsHalfDuplex	(SessionRef		inRef)
 }// LocalEchoIsHalfDuplex
 
 
+/*!
+Returns "true" only if predictive local echo is enabled
+for the given session.  See Session_SetLocalEchoPredictive().
+
+(2021.06)
+*/
+Boolean
+Session_LocalEchoIsPredictive	(SessionRef		inRef)
+{
+	My_SessionAutoLocker	ptr(gSessionPtrLocks(), inRef);
+	Boolean					result = (nullptr != ptr->echo.predictor);
+	
+	
+	return result;
+}// LocalEchoIsPredictive
+
+
 /*!
 Returns "true" only if the specified connection is disabled;
 that is, its network activity has not been suspended by a
@@ -1439,6 +1505,23 @@ Session_NetworkIsSuspended		(SessionRef		inRef)
 }// NetworkIsSuspended
 
 
+/*!
+Returns "true" only if text from Session_UserInputPaste()
+is still being sent to the specified session.
+
+(2021.06)
+*/
+Boolean
+Session_PasteIsInProgress	(SessionRef		inRef)
+{
+	My_SessionAutoLocker	ptr(gSessionPtrLocks(), inRef);
+	Boolean					result = (nullptr != ptr->pasteStream);
+	
+	
+	return result;
+}// PasteIsInProgress
+
+
 /*!
 Causes the specified target to no longer be considered for
 writes to the given session.
@@ -1559,6 +1642,28 @@ Session_ReturnActiveTerminalWindow	(SessionRef		inRef)
 }// ReturnActiveTerminalWindow
 
 
+/*!
+Returns the number of the broadcast group that the session
+belongs to, or 0 if it is not in a group.  See
+Session_SetBroadcastGroup().
+
+(2021.06)
+*/
+UInt32
+Session_ReturnBroadcastGroup	(SessionRef		inRef)
+{
+	My_SessionAutoLocker	ptr(gSessionPtrLocks(), inRef);
+	UInt32					result = 0;
+	
+	
+	if (nullptr != ptr)
+	{
+		result = ptr->broadcastGroup;
+	}
+	return result;
+}// ReturnBroadcastGroup
+
+
 /*!
 Returns the POSIX path of the directory that was current as of
 the most recent call to Local_UpdateCurrentDirectoryCache().
@@ -1712,6 +1817,29 @@ Session_ReturnConfiguration		(SessionRef		inRef)
 }// ReturnConfiguration
 
 
+/*!
+Returns the smoothed time between typing a character and
+seeing the server echo it, in milliseconds, as measured by
+predictive local echo.  If predictive local echo is off,
+or no echo has been measured yet, the result is zero.
+
+(2021.06)
+*/
+UInt32
+Session_ReturnEchoRoundTripMilliseconds		(SessionRef		inRef)
+{
+	My_SessionAutoLocker	ptr(gSessionPtrLocks(), inRef);
+	UInt32					result = 0;
+	
+	
+	if (nullptr != ptr->echo.predictor)
+	{
+		result = STATIC_CAST(EchoPredictor_ReturnRoundTripNanoseconds(ptr->echo.predictor) / 1000000, UInt32);
+	}
+	return result;
+}// ReturnEchoRoundTripMilliseconds
+
+
 /*!
 Returns the keys used as short-cuts for various events.
 See the documentation on Session_EventKeys for more
@@ -1753,6 +1881,28 @@ Session_ReturnOriginalWorkingDirectory		(SessionRef		inRef)
 }// ReturnOriginalWorkingDirectory
 
 
+/*!
+Returns the fraction of the current Paste that has been
+sent to the specified session, from 0 to 1; or, 0 if no
+Paste is in progress (see Session_PasteIsInProgress()).
+
+(2021.06)
+*/
+Float32
+Session_ReturnPasteProgress		(SessionRef		inRef)
+{
+	My_SessionAutoLocker	ptr(gSessionPtrLocks(), inRef);
+	Float32					result = 0;
+	
+	
+	if (nullptr != ptr->pasteStream)
+	{
+		result = PasteStream_ReturnProgress(ptr->pasteStream);
+	}
+	return result;
+}// ReturnPasteProgress
+
+
 /*!
 Returns a pathname for the slave pseudo-terminal device
 attached to the given session.  This can be displayed in
@@ -1941,9 +2091,31 @@ Session_SendData	(SessionRef		inRef,
 	
 	if (nullptr != ptr->mainProcess)
 	{
-		result = STATIC_CAST(Local_TerminalWriteBytes(Local_ProcessReturnMasterTerminal(ptr->mainProcess),
-														inBufferPtr, inByteCount),
-								SInt16);
+		TraceSpan_ScopeWithByteCount("PTY write", inByteCount);
+		
+		
+		// a session that left its broadcast group keeps writing in
+		// the background until its backlog is empty, so that later
+		// input never arrives before what was typed in the group
+		if (0 == ptr->broadcastGroup)
+		{
+			UNUSED_RETURN(Boolean)AsyncWriter_DisposeIfWritten(&ptr->inputWriter);
+		}
+		
+		// a session in a broadcast group never waits for its process
+		// (and everything it sends must stay in order, so even data
+		// that is not broadcast goes through the same writer)
+		if ((nullptr != ptr->inputWriter) &&
+			(kAsyncWriter_ResultOK == AsyncWriter_EnqueueBytes(ptr->inputWriter, inBufferPtr, inByteCount)))
+		{
+			result = STATIC_CAST(inByteCount, SInt16);
+		}
+		else
+		{
+			result = STATIC_CAST(Local_TerminalWriteBytes(Local_ProcessReturnMasterTerminal(ptr->mainProcess),
+															inBufferPtr, inByteCount),
+									SInt16);
+		}
 	}
 	return result;
 }// SendData
@@ -2117,6 +2289,12 @@ Session_SendDeleteBackward	(SessionRef		inRef,
 		localEchoKey(ptr, deleteChar[0]);
 	}
 	
+	if (nullptr != ptr->echo.predictor)
+	{
+		EchoPredictor_UserInputErase(ptr->echo.predictor);
+		predictionUpdateDisplay(ptr);
+	}
+	
 	Session_SendData(inRef, deleteChar, sizeof(deleteChar));
 }// SendDeleteBackward
 
@@ -2161,6 +2339,8 @@ Session_SendNewline		(SessionRef		inRef,
 	Boolean					echo = false;
 	
 	
+	predictionAddOtherInput(ptr);
+	
 	// send any local echo first
 	switch (inEcho)
 	{
@@ -2218,6 +2398,71 @@ Session_SendNewline		(SessionRef		inRef,
 }// SendNewline
 
 
+/*!
+Adds the session to a broadcast group (or, if the group
+number is 0, removes it from its current group).  Typed
+keys, text and Pastes for any session in a group are sent to
+every session in the group, each in the form that its own
+terminal expects (for instance, arrow keys respect each
+terminal’s cursor key mode).
+
+Sessions in a group do not wait for their processes to read
+input; it is written in the background, separately for each
+session.  A session that falls too far behind (for instance,
+because its remote host has stopped responding) is removed
+from its group, so that it cannot slow down the others and
+never receives only part of what was typed afterwards.
+
+\retval kSession_ResultOK
+if the session is now in the given group
+
+\retval kSession_ResultInvalidReference
+if "inRef" is invalid
+
+\retval kSession_ResultNotReady
+if the session has no running process (it is not added)
+
+(2021.06)
+*/
+Session_Result
+Session_SetBroadcastGroup	(SessionRef		inRef,
+							 UInt32			inGroupNumberOrZero)
+{
+	My_SessionAutoLocker	ptr(gSessionPtrLocks(), inRef);
+	Session_Result			result = kSession_ResultOK;
+	
+	
+	if (nullptr == ptr)
+	{
+		result = kSession_ResultInvalidReference;
+	}
+	else if (inGroupNumberOrZero != ptr->broadcastGroup)
+	{
+		broadcastGroupLeave(ptr, false/* discard input */);
+		if (0 != inGroupNumberOrZero)
+		{
+			// a writer that is still draining is reused, to keep the input in order
+			if ((nullptr == ptr->inputWriter) && (nullptr != ptr->mainProcess))
+			{
+				ptr->inputWriter = AsyncWriter_New(Local_ProcessReturnMasterTerminal(ptr->mainProcess),
+													kMy_BroadcastBacklogLimit, "net.macterm.queues.input");
+			}
+			
+			if (nullptr == ptr->inputWriter)
+			{
+				result = kSession_ResultNotReady;
+			}
+			else
+			{
+				ptr->broadcastGroup = inGroupNumberOrZero;
+				UNUSED_RETURN(BroadcastGroup_Result)BroadcastGroup_AddMember(inGroupNumberOrZero, inRef, ptr->inputWriter);
+			}
+		}
+	}
+	return result;
+}// SetBroadcastGroup
+
+
 /*!
 Changes the keys used as short-cuts for various events.
 See the documentation on Session_EventKeys for more
@@ -2291,6 +2536,43 @@ Session_SetLocalEchoHalfDuplex	(SessionRef		inRef)
 }// SetLocalEchoHalfDuplex
 
 
+/*!
+Enables or disables predictive local echo.  Unlike regular
+local echo, the server still echoes every character; but
+on a slow connection, characters that are typed at a shell
+or editor prompt are drawn (underlined) right away, and are
+replaced by the real echo when it arrives.  If the server
+does not echo what was predicted, predictions stop until
+the terminal shows that it is safe to try again.
+
+Predictions are never drawn when the connection is fast,
+so this is safe to leave on.  It has no effect if regular
+local echo is enabled.
+
+(2021.06)
+*/
+void
+Session_SetLocalEchoPredictive	(SessionRef		inRef,
+								 Boolean		inIsEnabled)
+{
+	My_SessionAutoLocker	ptr(gSessionPtrLocks(), inRef);
+	
+	
+	if (inIsEnabled)
+	{
+		if (nullptr == ptr->echo.predictor)
+		{
+			ptr->echo.predictor = EchoPredictor_New();
+		}
+	}
+	else if (nullptr != ptr->echo.predictor)
+	{
+		EchoPredictor_Dispose(&ptr->echo.predictor);
+		predictionUpdateDisplay(ptr);
+	}
+}// SetLocalEchoPredictive
+
+
 /*!
 Specifies whether the given connection is disabled -
 that is, whether its network activity has been
@@ -2570,6 +2852,9 @@ Session_SetState	(SessionRef			inRef,
 			{
 				if (kSession_StateDead == ptr->status)
 				{
+					// the background writer must stop before the device closes
+					broadcastGroupLeave(ptr, true/* discard input */);
+					
 					// killing the process may trigger a state change, but this
 					// is OK as long as the state it chooses is the same as
 					// the state that triggers this call
@@ -2791,6 +3076,7 @@ Session_StartMonitoring		(SessionRef					inRef,
 	if (inForWhatChange == kSession_AllChanges)
 	{
 		// recursively invoke for ALL session change types listed in "Session.h"
+		Session_StartMonitoring(inRef, kSession_ChangePasteProgress, inListener);
 		Session_StartMonitoring(inRef, kSession_ChangeResourceLocation, inListener);
 		Session_StartMonitoring(inRef, kSession_ChangeSelected, inListener);
 		Session_StartMonitoring(inRef, kSession_ChangeState, inListener);
@@ -2988,6 +3274,7 @@ Session_StopMonitoring	(SessionRef					inRef,
 	if (inForWhatChange == kSession_AllChanges)
 	{
 		// recursively invoke for ALL session change types listed in "Session.h"
+		Session_StopMonitoring(inRef, kSession_ChangePasteProgress, inListener);
 		Session_StopMonitoring(inRef, kSession_ChangeResourceLocation, inListener);
 		Session_StopMonitoring(inRef, kSession_ChangeSelected, inListener);
 		Session_StopMonitoring(inRef, kSession_ChangeState, inListener);
@@ -3282,29 +3569,48 @@ Session_UserInputCFString	(SessionRef		inRef,
 	SInt16			loopGuard = 0;
 	
 	
-	// dump to the local terminal first, if this mode is turned on
-	if (Session_LocalEchoIsEnabled(inRef))
+	if (0 != Session_ReturnBroadcastGroup(inRef))
 	{
 		My_SessionAutoLocker	ptr(gSessionPtrLocks(), inRef);
 		
 		
-		localEchoString(ptr, inStringBuffer);
+		// send to every session in the group (never blocks)
+		broadcastString(ptr, inStringBuffer);
 	}
-	
-	// first send any outstanding data in the buffer
-	Session_SendFlush(inRef);
-	
-	// block until every character in the string has been written
-	while (offset < kLength)
+	else
 	{
-		CFIndex		charactersSent = Session_SendDataCFString(inRef, inStringBuffer, offset);
+		// dump to the local terminal first, if this mode is turned on
+		if (Session_LocalEchoIsEnabled(inRef))
+		{
+			My_SessionAutoLocker	ptr(gSessionPtrLocks(), inRef);
+			
+			
+			localEchoString(ptr, inStringBuffer);
+		}
 		
+		// strings sent this way (e.g. by macros) may contain anything
+		{
+			My_SessionAutoLocker	ptr(gSessionPtrLocks(), inRef);
+			
+			
+			predictionAddOtherInput(ptr);
+		}
+		
+		// first send any outstanding data in the buffer
+		Session_SendFlush(inRef);
 		
-		offset += charactersSent;
-		if (++loopGuard > 4/* arbitrary */)
+		// block until every character in the string has been written
+		while (offset < kLength)
 		{
-			Console_Warning(Console_WriteValueCFString, "aborting transmission of string after too many failed attempts", inStringBuffer);
-			break;
+			CFIndex		charactersSent = Session_SendDataCFString(inRef, inStringBuffer, offset);
+			
+			
+			offset += charactersSent;
+			if (++loopGuard > 4/* arbitrary */)
+			{
+				Console_Warning(Console_WriteValueCFString, "aborting transmission of string after too many failed attempts", inStringBuffer);
+				break;
+			}
 		}
 	}
 }// UserInputCFString
@@ -3330,6 +3636,10 @@ Session_UserInputInterruptProcess	(SessionRef		inRef)
 		My_SessionAutoLocker	ptr(gSessionPtrLocks(), inRef);
 		
 		
+		// the rest of any Paste in progress is not wanted either
+		pasteStreamStop(ptr);
+		predictionAddOtherInput(ptr);
+		
 		// display a help tag over the cursor in an unobtrusive location
 		// that confirms for the user that an interrupt has in fact occurred
 		{
@@ -3412,6 +3722,8 @@ Session_UserInputFunctionKey	(SessionRef					inRef,
 		Boolean			sendOK = true;
 		
 		
+		predictionAddOtherInput(ptr);
+		
 		switch (inFunctionKeyNumber)
 		{
 		case 1:
@@ -4335,10 +4647,17 @@ Session_UserInputFunctionKey	(SessionRef					inRef,
 		if (sendOK)
 		{
 			// allow the terminal to send the key back to the listening session
-			// (ultimately this same exact session) 
-			for (auto screenRef : ptr->targetTerminals)
+			// (ultimately this same exact session); in a broadcast group, each
+			// terminal sends the key to its own session (in the background)
+			for (auto memberRef : returnBroadcastMembers(ptr))
 			{
-				UNUSED_RETURN(Terminal_Result)Terminal_UserInputVTFunctionKey(screenRef, keyCode);
+				My_SessionAutoLocker	memberPtr(gSessionPtrLocks(), memberRef);
+				
+				
+				for (auto screenRef : memberPtr->targetTerminals)
+				{
+					UNUSED_RETURN(Terminal_Result)Terminal_UserInputVTFunctionKey(screenRef, keyCode);
+				}
 			}
 		}
 	}
@@ -4383,8 +4702,15 @@ Session_UserInputKey	(SessionRef						inRef,
 	{
 		result = kSession_ResultNotReady;
 	}
+	else if (0 != ptr->broadcastGroup)
+	{
+		// send to every session in the group (never blocks)
+		broadcastKey(ptr, inKeyOrASCII, inEventModifiers);
+	}
 	else
 	{
+		predictionAddOtherInput(ptr);
+		
 		if (inKeyOrASCII < VSF10)
 		{
 			// 7-bit ASCII; send as-is
@@ -4396,126 +4722,14 @@ Session_UserInputKey	(SessionRef						inRef,
 		}
 		else if (ptr->eventKeys.arrowsRemappedForEmacs && (inKeyOrASCII <= VSLT) && (inKeyOrASCII >= VSUP))
 		{
-			UInt8		actualKeySeq[2] = { inKeyOrASCII, '\0' };
-			size_t		sequenceLength = 1;
+			std::string const	kSequence = returnEmacsArrowSequence(inKeyOrASCII, inEventModifiers);
 			
 			
-			// map from arrow keys to Emacs control keys; consider all standard
-			// Mac modes, i.e. option-arrow for words, command-arrows for lines
-			switch (inKeyOrASCII)
+			if (ptr->echo.enabled)
 			{
-			case VSLT:
-				{
-					if (inEventModifiers & NSEventModifierFlagOption)
-					{
-						// move one word backward (meta-b)
-						actualKeySeq[0] = 0x1B; // ESC (meta equivalent)
-						actualKeySeq[1] = 'b';
-						sequenceLength = 2;
-					}
-					else if (inEventModifiers & NSEventModifierFlagCommand)
-					{
-						// move to beginning of line (^A)
-						actualKeySeq[0] = 0x01;
-					}
-					else
-					{
-						// move one character backward (^B)
-						actualKeySeq[0] = 0x02;
-					}
-					
-					if (ptr->echo.enabled)
-					{
-						localEchoKey(ptr, inKeyOrASCII);
-					}
-				}
-				break;
-			
-			case VSRT:
-				{
-					if (inEventModifiers & NSEventModifierFlagOption)
-					{
-						// move one word forward (meta-f)
-						actualKeySeq[0] = 0x1B; // ESC (meta equivalent)
-						actualKeySeq[1] = 'f';
-						sequenceLength = 2;
-					}
-					else if (inEventModifiers & NSEventModifierFlagCommand)
-					{
-						// move to beginning of line (^E)
-						actualKeySeq[0] = 0x05;
-					}
-					else
-					{
-						// move one character forward (^F)
-						actualKeySeq[0] = 0x06;
-					}
-					
-					if (ptr->echo.enabled)
-					{
-						localEchoKey(ptr, inKeyOrASCII);
-					}
-				}
-				break;
-			
-			case VSUP:
-				{
-					if (inEventModifiers & NSEventModifierFlagOption)
-					{
-						// move to beginning of line (^A)
-						actualKeySeq[0] = 0x01;
-					}
-					else if (inEventModifiers & NSEventModifierFlagCommand)
-					{
-						// move to beginning of buffer (meta-<)
-						actualKeySeq[0] = 0x1B; // ESC (meta equivalent)
-						actualKeySeq[1] = '<';
-						sequenceLength = 2;
-					}
-					else
-					{
-						// move one line up (^P)
-						actualKeySeq[0] = 0x10; // ^P
-					}
-					
-					if (ptr->echo.enabled)
-					{
-						localEchoKey(ptr, inKeyOrASCII);
-					}
-				}
-				break;
-			
-			case VSDN:
-				{
-					if (inEventModifiers & NSEventModifierFlagOption)
-					{
-						// move to end of line (^E)
-						actualKeySeq[0] = 0x05;
-					}
-					else if (inEventModifiers & NSEventModifierFlagCommand)
-					{
-						// move to end of buffer (meta-<)
-						actualKeySeq[0] = 0x1B; // ESC (meta equivalent)
-						actualKeySeq[1] = '>';
-						sequenceLength = 2;
-					}
-					else
-					{
-						// move one line down (^N)
-						actualKeySeq[0] = 0x0E;
-					}
-					
-					if (ptr->echo.enabled)
-					{
-						localEchoKey(ptr, inKeyOrASCII);
-					}
-				}
-				break;
-			
-			default:
-				break;
+				localEchoKey(ptr, inKeyOrASCII);
 			}
-			Session_SendData(ptr->selfRef, &actualKeySeq, sequenceLength);
+			Session_SendData(ptr->selfRef, kSequence.data(), kSequence.size());
 		}
 		else
 		{
@@ -4524,74 +4738,7 @@ Session_UserInputKey	(SessionRef						inRef,
 				// if enabled, write a local representation of the keystroke
 				if (ptr->echo.enabled)
 				{
-					// when echoing a key, send only a description (not the actual key sequence)
-					// TEMPORARY; this is handled here because it is currently the only place
-					// that requires descriptions of keys; it might be useful to put this in an
-					// API that is more generally available
-					switch (inKeyOrASCII)
-					{
-					case VSK0:
-					case VSK1:
-					case VSK2:
-					case VSK3:
-					case VSK4:
-					case VSK5:
-					case VSK6:
-					case VSK7:
-					case VSK8:
-					case VSK9:
-					case VSKC:
-					case VSKM:
-					case VSKP:
-						{
-							// IMPORTANT: this should match the numeric order of the key codes
-							char const*		numberStr = "0123456789,-.";
-							
-							
-							localEchoKey(ptr, numberStr[inKeyOrASCII - VSK0]);
-						}
-						break;
-					
-					case VSLT:
-					case VSRT:
-					case VSUP:
-					case VSDN:
-						localEchoKey(ptr, inKeyOrASCII);
-						break;
-					
-					case VSKE:
-					case VSF1:
-					case VSF2:
-					case VSF3:
-					case VSF4:
-					case VSF6:
-					case VSF7:
-					case VSF8:
-					case VSF9:
-					case VSF10:
-					case VSF11:
-					case VSF12:
-					case VSF13:
-					case VSF14:
-					case VSF15_220HELP:
-					case VSF16_220DO:
-					case VSF17:
-					case VSF18:
-					case VSF19:
-					case VSF20:
-					case VSHELP_220FIND:
-					case VSHOME_220INS:
-					case VSPGUP_220DEL:
-					case VSDEL_220SEL:
-					case VSEND_220PGUP:
-					case VSPGDN_220PGDN:
-						localEchoKey(ptr, inKeyOrASCII);
-						break;
-					
-					default:
-						// ???
-						break;
-					}
+					localEchoVTKey(ptr, inKeyOrASCII);
 				}
 				
 				// allow the terminal to perform the appropriate action for the key,
@@ -4621,6 +4768,14 @@ text is multi-line, the user is warned and given options on how
 to perform the Paste.  This also means that this function could
 return before the Paste actually occurs.
 
+The text is sent in chunks, as quickly as the process reads it
+(or with the user’s preferred delay after each line), while
+other events continue to be handled; so the Paste may still be
+in progress long after it starts.  See Session_PasteIsInProgress()
+and Session_UserInputPasteCancel().  If the application in the
+terminal has turned on bracketed paste mode, the text is sent
+without delays and is enclosed in the markers of that mode.
+
 IMPORTANT:	This returns a result immediately based on the
 			viability of the pasteboard data but the actual
 			Paste could happen at any time (for example, it
@@ -4642,23 +4797,23 @@ Session_UserInputPaste	(SessionRef		inRef,
 											? [NSPasteboard generalPasteboard]
 											: inSourceOrNull;
 	My_SessionAutoLocker	ptr(gSessionPtrLocks(), inRef);
-	CFArrayRef				pendingLines = nullptr;
+	CFStringRef				pasteText = nullptr;
 	Session_Result			result = kSession_ResultParameterError;
 	
 	
-	if (Clipboard_CreateCFStringArrayFromPasteboard(pendingLines, kPasteboard))
+	if (Clipboard_CreateCFStringFromPasteboard(pasteText, kPasteboard))
 	{
-		// convert to Objective-C object reference for better implicit behavior in blocks
-		NSArray*	blockPendingLines = BRIDGE_CAST(pendingLines, NSArray*);
-		Boolean		isOneLine = false;
-		Boolean		noWarning = false;
+		// the blocks below keep the text (not a copy) until the Paste starts
+		CFRetainRelease		blockPasteText(pasteText, CFRetainRelease::kAlreadyRetained);
+		Boolean				isOneLine = false;
+		Boolean				noWarning = false;
 		
 		
 		// success...
 		result = kSession_ResultOK;
 		
 		// examine the Clipboard; if the data contains new-lines, warn the user
-		isOneLine = (blockPendingLines.count < 2);
+		isOneLine = (false == PasteStream_TextHasMultipleLines(pasteText));
 		
 		// determine if the user should be warned
 		unless (kPreferences_ResultOK ==
@@ -4673,61 +4828,23 @@ Session_UserInputPaste	(SessionRef		inRef,
 			AlertMessages_BoxWrap	box;
 			auto					joinResponder =
 									^{
-										// first join the text into one line (replace new-line sequences
-										// with single spaces), then Paste
-										NSString*	joinedString = [blockPendingLines componentsJoinedByString:@" "];
-										
-										
-										Session_UserInputCFString(inRef, BRIDGE_CAST(joinedString, CFStringRef));
+										// replace new-line sequences with single spaces
+										if (Session_IsValid(inRef))
+										{
+											My_SessionAutoLocker	blockPtr(gSessionPtrLocks(), inRef);
+											
+											
+											broadcastPaste(blockPtr, blockPasteText.returnCFStringRef(), true/* join lines */);
+										}
 									};
 			auto					normalPasteResponder =
 									^{
-										CFIndex						lineCount = blockPendingLines.count;
-										CFIndex						dispatchIndex = 0;
-										__block CFIndex				lineIndex = 0;
-										Preferences_Result			prefsResult = kPreferences_ResultOK;
-										Preferences_TimeInterval	delayValue = 0;
-										dispatch_queue_t			targetQueue = dispatch_get_main_queue();
-										
-										
-										// determine how long the delay between lines should be
-										prefsResult = Preferences_GetData(kPreferences_TagPasteNewLineDelay, sizeof(delayValue),
-																			&delayValue);
-										if (kPreferences_ResultOK != prefsResult)
-										{
-											// set an arbitrary default value
-											delayValue = 50 * kPreferences_TimeIntervalMillisecond;
-										}
-										
-										// regular Paste; periodically insert each line into the session,
-										// dispatching each line-send at a multiple of the user-preferred
-										// delay time in the same queue; also, in the event of very large
-										// pastes, force an even greater delay at a longer period
-										for (NSString* aString in blockPendingLines)
+										if (Session_IsValid(inRef))
 										{
-											Preferences_TimeInterval	localDelay = 0;
+											My_SessionAutoLocker	blockPtr(gSessionPtrLocks(), inRef);
 											
 											
-											++dispatchIndex;
-											localDelay = (dispatchIndex * STATIC_CAST(delayValue / kPreferences_TimeIntervalNanosecond, int64_t));
-											// TEMPORARY; create low-level preferences for these additional delay intervals
-											if (0 == (dispatchIndex % 40/* arbitrary */))
-											{
-												// for very large pastes, insert an additional delay after every
-												// so many lines (based on if-statement above), in addition to
-												// any user-prescribed per-line delay
-												localDelay += (10 * kPreferences_TimeIntervalMillisecond); // arbitrary
-											}
-											dispatch_after(dispatch_time(DISPATCH_TIME_NOW, localDelay),
-															targetQueue,
-															^{
-																Session_UserInputCFString(inRef, BRIDGE_CAST(aString, CFStringRef));
-																++lineIndex;
-																if (lineCount != lineIndex)
-																{
-																	Session_SendNewline(inRef, kSession_EchoCurrentSessionValue);
-																}
-															});
+											broadcastPaste(blockPtr, blockPasteText.returnCFStringRef(), false/* join lines */);
 										}
 									};
 			
@@ -4790,10 +4907,7 @@ Session_UserInputPaste	(SessionRef		inRef,
 					Alert_SetButtonText(box.returnRef(), kAlert_ItemButton1, joinString.returnCFStringRef());
 					Alert_SetButtonResponseBlock(box.returnRef(), kAlert_ItemButton1, joinResponder);
 					Alert_SetButtonText(box.returnRef(), kAlert_ItemButton3, pasteNormallyString.returnCFStringRef());
-					Alert_SetButtonResponseBlock(box.returnRef(), kAlert_ItemButton3,
-													^{
-														normalPasteResponder();
-													});
+					Alert_SetButtonResponseBlock(box.returnRef(), kAlert_ItemButton3, normalPasteResponder);
 				}
 				
 				// ensure that the relevant window is visible and frontmost
@@ -4804,7 +4918,6 @@ Session_UserInputPaste	(SessionRef		inRef,
 				Alert_Display(box.returnRef()); // retains alert until it is dismissed
 			}
 		}
-		CFRelease(pendingLines), pendingLines = nullptr;
 	}
 	
 	return result;
@@ -4812,16 +4925,47 @@ Session_UserInputPaste	(SessionRef		inRef,
 
 
 /*!
-Returns "true" only if the specified session is being
-watched for a lack of activity over a short period of
-time.
-
-See Session_SetWatch().
+Stops any Paste that is in progress for the specified
+session (see Session_UserInputPaste()).  Text that has
+already been sent is not affected.  If the Paste is
+bracketed, the end marker is still sent so that the
+application does not wait for the rest of the text.
 
-(3.1)
+(2021.06)
 */
-Boolean
-Session_WatchIsForInactivity	(SessionRef		inRef)
+void
+Session_UserInputPasteCancel	(SessionRef		inRef)
+{
+	My_SessionAutoLocker	ptr(gSessionPtrLocks(), inRef);
+	
+	
+	if (nullptr != ptr->pasteStream)
+	{
+		// the unsent part of the current chunk is dropped, and blocks
+		// that were scheduled for the Paste do nothing when they run;
+		// anything that the stream still returns (an end marker) is
+		// sent right away, after which the Paste ends as usual
+		PasteStream_Cancel(ptr->pasteStream);
+		ptr->pasteChunkLength = 0;
+		ptr->pasteChunkOffset = 0;
+		ptr->pasteLineDelay = 0;
+		++(ptr->pasteSerialNumber);
+		pasteStreamContinue(ptr);
+	}
+}// UserInputPasteCancel
+
+
+/*!
+Returns "true" only if the specified session is being
+watched for a lack of activity over a short period of
+time.
+
+See Session_SetWatch().
+
+(3.1)
+*/
+Boolean
+Session_WatchIsForInactivity	(SessionRef		inRef)
 {
 	My_SessionAutoLocker	ptr(gSessionPtrLocks(), inRef);
 	Boolean					result = (kSession_WatchForInactivity == ptr->activeWatch);
@@ -4934,11 +5078,13 @@ vectorWindowListener(ListenerModel_NewStandardListener(vectorGraphicsWindowChang
 						ListenerModel_ListenerWrap::kAlreadyRetained),
 preferencesListener(ListenerModel_NewStandardListener(preferenceChanged, this/* context */),
 					ListenerModel_ListenerWrap::kAlreadyRetained),
-longLifeTimer(nil), // set later
-respawnSessionTimer(nil), // set later
+longLifeTimer(TimerWheel_NewTimer(TimerWheel_ReturnShared(), longLifeTimerFired, this/* context */)),
+respawnSessionTimer(TimerWheel_NewTimer(TimerWheel_ReturnShared(), respawnTimerFired, this/* context */)),
 currentDialog(REINTERPRET_CAST(this, SessionRef)),
 terminalWindow(nullptr), // set at window validation time
 mainProcess(nullptr),
+inputWriter(nullptr),
+broadcastGroup(0),
 // controlKey is initialized below
 targetVectorGraphics(),
 targetDumbTerminals(),
@@ -4956,7 +5102,15 @@ readBufferSizeInUse(0),
 readBufferPtr(std::make_unique<UInt8[]>(this->readBufferSizeMaximum)),
 writeEncoding(kCFStringEncodingUTF8), // initially...
 activeWatch(kSession_WatchNothing),
-inactivityWatchTimer(nil), // set later
+inactivityWatchTimer(TimerWheel_NewTimer(TimerWheel_ReturnShared(), watchTimerFired, this/* context */)),
+pasteStream(nullptr),
+pasteChunk(),
+pasteChunkLength(0),
+pasteChunkOffset(0),
+pasteLineDelay(0),
+pasteSerialNumber(0),
+pasteStallCount(0),
+pasteReportedPercent(-1),
 recentSheetContext(),
 sheetType(kMy_SessionSheetTypeNone),
 renameDialog(nullptr),
@@ -4996,27 +5150,12 @@ selfRef(REINTERPRET_CAST(this, SessionRef))
 	changeNotifyForSession(this, kSession_ChangeState, this->selfRef/* context */);
 	changeNotifyForSession(this, kSession_ChangeStateAttributes, this->selfRef/* context */);
 	
-	// install a one-shot timer to tell interested parties when this session
+	// arm a one-shot timer to tell interested parties when this session
 	// has been opened for 15 seconds, changing the state of an active session
 	// to reflect its stability (this special state is for user interface events
 	// such as confirmation alerts that can be more annoying than useful for
 	// windows that have been asked to close very soon after they’ve opened)
-	SessionRef const	blockSessionRef = this->selfRef;
-	this->longLifeTimer = [NSTimer scheduledTimerWithTimeInterval:kSession_LifetimeMinimumForNoWarningClose/* in seconds */
-	repeats:NO
-	block:^(NSTimer* UNUSED_ARGUMENT(timer))
-	{
-		if (Session_IsValid(blockSessionRef))
-		{
-			//My_SessionAutoLocker	blockSessionPtr(gSessionPtrLocks(), blockSessionRef);
-			
-			
-			if (Session_StateIsActiveUnstable(blockSessionRef))
-			{
-				Session_SetState(blockSessionRef, kSession_StateActiveStable);
-			}
-		}
-	}];
+	UNUSED_RETURN(TimerWheel_Result)TimerWheel_Arm(this->longLifeTimer, STATIC_CAST(kSession_LifetimeMinimumForNoWarningClose * 1000/* milliseconds per second */, UInt32));
 	
 	// create a callback for preferences, then listen for certain preferences
 	// (this will also initialize the preferences cache values)
@@ -5060,6 +5199,20 @@ selfRef(REINTERPRET_CAST(this, SessionRef))
 			Console_Warning(Console_WriteLine, "both background data and idle activity handlers were set; currently the idle handler takes precedence");
 		}
 	}
+	
+	// if a user preference is set, display typed characters before the server echoes them
+	{
+		Boolean				isPredictive = false;
+		Preferences_Result	prefsResult = Preferences_ContextGetData(inConfigurationOrNull, kPreferences_TagLocalEchoPredictive,
+																		sizeof(isPredictive), &isPredictive,
+																		true/* search for defaults */);
+		
+		
+		if ((kPreferences_ResultOK == prefsResult) && isPredictive)
+		{
+			this->echo.predictor = EchoPredictor_New();
+		}
+	}
 }// My_Session default constructor
 
 
@@ -5087,20 +5240,29 @@ My_Session::
 	// by callbacks invoked from this destructor
 	this->terminationAbsoluteTime = CFAbsoluteTimeGetCurrent();
 	
-	if (nil != this->longLifeTimer)
-	{
-		[this->longLifeTimer invalidate];
-		this->longLifeTimer = nil;
-	}
-	if (nil != this->respawnSessionTimer)
-	{
-		[this->respawnSessionTimer invalidate];
-		this->respawnSessionTimer = nil;
-	}
-	if (nil != this->inactivityWatchTimer)
+	TimerWheel_DisposeTimer(&this->longLifeTimer);
+	TimerWheel_DisposeTimer(&this->respawnSessionTimer);
+	TimerWheel_DisposeTimer(&this->inactivityWatchTimer);
+	PasteStream_Dispose(&this->pasteStream);
+	EchoPredictor_Dispose(&this->echo.predictor);
+	broadcastGroupLeave(this, true/* discard input */);
+	
+	// a process of the session server keeps running, along with
+	// the state of the screen, so that it can be reattached later
+	// (see Local_SpawnProcessFromDetachedProcess()); if it has
+	// already exited, detaching fails and it is cleaned up below
+	if ((nullptr != this->mainProcess) && Local_ProcessIsDetachable(this->mainProcess))
 	{
-		[this->inactivityWatchTimer invalidate];
-		this->inactivityWatchTimer = nil;
+		std::vector< UInt8 >	savedState;
+		
+		
+		if ((false == this->targetTerminals.empty()) &&
+			(kTerminal_ResultOK != Terminal_SerializeState(this->targetTerminals.front(), savedState)))
+		{
+			// the output that the server keeps is still replayed
+			savedState.clear();
+		}
+		UNUSED_RETURN(Local_Result)Local_DetachProcess(&this->mainProcess, savedState);
 	}
 	
 	if (nullptr != this->mainProcess)
@@ -5151,6 +5313,179 @@ My_Session::
 }// My_Session destructor
 
 
+/*!
+Removes the session from its broadcast group (if any).
+
+If "inDiscardInput" is true, the session also stops writing
+its input in the background, and any input that has not been
+written yet is discarded; this is ONLY for a session whose
+device is about to close.  Otherwise, input that is still
+queued is written in the background, and Session_SendData()
+keeps using the same writer until it is empty (so that the
+input stays in order), without waiting for the process.
+
+(2021.06)
+*/
+void
+broadcastGroupLeave		(My_SessionPtr		inPtr,
+						 Boolean			inDiscardInput)
+{
+	if (0 != inPtr->broadcastGroup)
+	{
+		BroadcastGroup_RemoveMember(inPtr->selfRef);
+		inPtr->broadcastGroup = 0;
+	}
+	if (inDiscardInput)
+	{
+		AsyncWriter_Dispose(&inPtr->inputWriter);
+	}
+	else
+	{
+		UNUSED_RETURN(Boolean)AsyncWriter_DisposeIfWritten(&inPtr->inputWriter);
+	}
+}// broadcastGroupLeave
+
+
+/*!
+Sends a key to every session in the broadcast group of the
+given session (see Session_UserInputKey()).  The sequence
+for the key depends on the modes of each terminal, but it
+is only encoded once for each distinct set of modes, and
+the same buffer is given to every session that uses it.
+
+(2021.06)
+*/
+void
+broadcastKey	(My_SessionPtr	inPtr,
+				 UInt8			inKeyOrASCII,
+				 UInt64			inEventModifiers)
+{
+	Boolean const							kIsArrow = ((inKeyOrASCII <= VSLT) && (inKeyOrASCII >= VSUP));
+	std::map< UInt32, AsyncWriter_Buffer >	sequencesByModes;
+	
+	
+	for (auto memberRef : returnBroadcastMembers(inPtr))
+	{
+		My_SessionAutoLocker	memberPtr(gSessionPtrLocks(), memberRef);
+		UInt32					keySignature = 0;
+		
+		
+		// as in Session_UserInputKey(), any predicted echo is no longer
+		// reliable, and a VT key is only sent by a terminal
+		predictionAddOtherInput(memberPtr);
+		
+		if ((inKeyOrASCII >= VSF10) && memberPtr->targetTerminals.empty())
+		{
+			continue;
+		}
+		
+		if (inKeyOrASCII >= VSF10)
+		{
+			if (kIsArrow && memberPtr->eventKeys.arrowsRemappedForEmacs)
+			{
+				keySignature = kMy_KeySignatureEmacsArrows;
+			}
+			else
+			{
+				keySignature = Terminal_ReturnKeyModes(memberPtr->targetTerminals.front());
+			}
+		}
+		
+		auto&	sequence = sequencesByModes[keySignature];
+		
+		
+		if (nullptr == sequence)
+		{
+			sequence = newKeyInput(inKeyOrASCII, inEventModifiers, keySignature);
+		}
+		
+		if (nullptr != sequence)
+		{
+			if (memberPtr->echo.enabled)
+			{
+				if ((inKeyOrASCII < VSF10) || (kMy_KeySignatureEmacsArrows == keySignature))
+				{
+					localEchoKey(memberPtr, inKeyOrASCII);
+				}
+				else
+				{
+					localEchoVTKey(memberPtr, inKeyOrASCII);
+				}
+			}
+			enqueueInput(memberPtr, sequence);
+		}
+	}
+}// broadcastKey
+
+
+/*!
+Starts a Paste of the given text in every session in the
+broadcast group of the given session (or, if it is not in a
+group, only in the given session).  The text is shared, not
+copied; each session converts it as it is sent, since the
+text encoding and bracketed-paste mode can differ, and each
+one waits for its own process (see pasteStreamContinue()).
+
+(2021.06)
+*/
+void
+broadcastPaste	(My_SessionPtr	inPtr,
+				 CFStringRef	inText,
+				 Boolean		inJoinLines)
+{
+	for (auto memberRef : returnBroadcastMembers(inPtr))
+	{
+		My_SessionAutoLocker	memberPtr(gSessionPtrLocks(), memberRef);
+		
+		
+		pasteStreamStart(memberPtr, inText, inJoinLines);
+	}
+}// broadcastPaste
+
+
+/*!
+Sends text to every session in the broadcast group of the
+given session (see Session_UserInputCFString()).  The text
+is only converted once for each distinct text encoding.
+
+(2021.06)
+*/
+void
+broadcastString		(My_SessionPtr		inPtr,
+					 CFStringRef		inText)
+{
+	std::map< CFStringEncoding, AsyncWriter_Buffer >	bytesByEncoding;
+	
+	
+	for (auto memberRef : returnBroadcastMembers(inPtr))
+	{
+		My_SessionAutoLocker	memberPtr(gSessionPtrLocks(), memberRef);
+		auto&					bytes = bytesByEncoding[memberPtr->writeEncoding];
+		
+		
+		predictionAddOtherInput(memberPtr);
+		
+		if (nullptr == bytes)
+		{
+			bytes = newEncodedInput(inText, memberPtr->writeEncoding);
+		}
+		
+		if (nullptr == bytes)
+		{
+			Console_Warning(Console_WriteValue, "unable to broadcast text to session with text encoding", memberPtr->writeEncoding);
+		}
+		else
+		{
+			if (memberPtr->echo.enabled)
+			{
+				localEchoString(memberPtr, inText);
+			}
+			enqueueInput(memberPtr, bytes);
+		}
+	}
+}// broadcastString
+
+
 /*!
 Uses the configured file name (optionally as a template) and
 configured directory to start a file capture.
@@ -5575,6 +5910,26 @@ copyVectorGraphicsPreferences	(My_SessionPtr				inPtr,
 }// copyVectorGraphicsPreferences
 
 
+/*!
+Sends data that may also be sent to other sessions (so it
+must not change).  Normally it is written in the background
+(see Session_SetBroadcastGroup()), but without a writer it
+is sent with Session_SendData().
+
+(2021.06)
+*/
+void
+enqueueInput	(My_SessionPtr				inPtr,
+				 AsyncWriter_Buffer const&	inData)
+{
+	unless ((nullptr != inPtr->inputWriter) &&
+			(kAsyncWriter_ResultOK == AsyncWriter_Enqueue(inPtr->inputWriter, inData)))
+	{
+		UNUSED_RETURN(SInt16)Session_SendData(inPtr->selfRef, inData->data(), inData->size());
+	}
+}// enqueueInput
+
+
 /*!
 Responds to an NSSavePanel that closed with the
 user selecting the primary action button.  See
@@ -6007,84 +6362,709 @@ localEchoKey	(My_SessionPtr	inPtr,
 			hoverEcho = true; // avoid insertion, since the local terminal won’t do anything with this key
 			if (hoverEcho)
 			{
-				// TEMPORARY: only makes sense for VT220 terminals
-				terminalHoverLocalEchoString(inPtr, REINTERPRET_CAST("select", UInt8 const*), 6); // LOCALIZE THIS
-				writeVerbatim = false;
+				// TEMPORARY: only makes sense for VT220 terminals
+				terminalHoverLocalEchoString(inPtr, REINTERPRET_CAST("select", UInt8 const*), 6); // LOCALIZE THIS
+				writeVerbatim = false;
+			}
+			break;
+		
+		case VSEND_220PGUP:
+			hoverEcho = true; // avoid insertion, since the local terminal won’t do anything with this key
+			if (hoverEcho)
+			{
+				// TEMPORARY: only makes sense for VT220 terminals
+				terminalHoverLocalEchoString(inPtr, REINTERPRET_CAST("page up", UInt8 const*), 7); // LOCALIZE THIS
+				writeVerbatim = false;
+			}
+			break;
+		
+		case VSPGDN_220PGDN:
+			hoverEcho = true; // avoid insertion, since the local terminal won’t do anything with this key
+			if (hoverEcho)
+			{
+				// TEMPORARY: only makes sense for VT220 terminals
+				terminalHoverLocalEchoString(inPtr, REINTERPRET_CAST("page down", UInt8 const*), 9); // LOCALIZE THIS
+				writeVerbatim = false;
+			}
+			break;
+		
+		default:
+			// ???
+			break;
+		}
+	}
+	
+	if (writeVerbatim)
+	{
+		terminalInsertLocalEchoString(inPtr, &inKeyOrASCII, 1/* byte count */);
+	}
+}// localEchoKey
+
+
+/*!
+Immediately sends the specified string to the local terminal,
+as bytes in its output text encoding (defined by a call to
+Session_SetSendDataEncoding()).
+
+(4.0)
+*/
+void
+localEchoString		(My_SessionPtr		inPtr,
+					 CFStringRef		inStringBuffer)
+{
+	if (nullptr != inStringBuffer)
+	{
+		// convert the stream from UTF-8 into the encoding of the session
+		try
+		{
+			size_t const	kBufferSize = (1 + CFStringGetMaximumSizeForEncoding
+											(CFStringGetLength(inStringBuffer), inPtr->writeEncoding));
+			char*			stringBuffer = new char[kBufferSize];
+			
+			
+			stringBuffer[kBufferSize - 1] = '\0';
+			if (false == CFStringGetCString(inStringBuffer, stringBuffer, kBufferSize, inPtr->writeEncoding))
+			{
+				Console_Warning(Console_WriteValue, "input text does not match terminal with text encoding", inPtr->writeEncoding);
+				Console_Warning(Console_WriteValueCFString, "cannot convert into the encoding used by this terminal, text", inStringBuffer);
+			}
+			else
+			{
+				terminalInsertLocalEchoString(inPtr, REINTERPRET_CAST(stringBuffer, UInt8 const*), CPP_STD::strlen(stringBuffer));
+			}
+			delete [] stringBuffer;
+		}
+		catch (std::bad_alloc)
+		{
+			Console_WriteLine("local echo of string failed, out of memory!");
+		}
+	}
+}// localEchoString
+
+
+/*!
+Echoes a VT key (see "VTKeys.h") locally, as a description
+of the key instead of the sequence that is sent for it.
+
+(2021.06)
+*/
+void
+localEchoVTKey		(My_SessionPtr		inPtr,
+					 UInt8				inVTKey)
+{
+	// TEMPORARY; this is handled here because it is currently the only place
+	// that requires descriptions of keys; it might be useful to put this in an
+	// API that is more generally available
+	switch (inVTKey)
+	{
+	case VSK0:
+	case VSK1:
+	case VSK2:
+	case VSK3:
+	case VSK4:
+	case VSK5:
+	case VSK6:
+	case VSK7:
+	case VSK8:
+	case VSK9:
+	case VSKC:
+	case VSKM:
+	case VSKP:
+		{
+			// IMPORTANT: this should match the numeric order of the key codes
+			char const*		numberStr = "0123456789,-.";
+			
+			
+			localEchoKey(inPtr, numberStr[inVTKey - VSK0]);
+		}
+		break;
+	
+	case VSLT:
+	case VSRT:
+	case VSUP:
+	case VSDN:
+		localEchoKey(inPtr, inVTKey);
+		break;
+	
+	case VSKE:
+	case VSF1:
+	case VSF2:
+	case VSF3:
+	case VSF4:
+	case VSF6:
+	case VSF7:
+	case VSF8:
+	case VSF9:
+	case VSF10:
+	case VSF11:
+	case VSF12:
+	case VSF13:
+	case VSF14:
+	case VSF15_220HELP:
+	case VSF16_220DO:
+	case VSF17:
+	case VSF18:
+	case VSF19:
+	case VSF20:
+	case VSHELP_220FIND:
+	case VSHOME_220INS:
+	case VSPGUP_220DEL:
+	case VSDEL_220SEL:
+	case VSEND_220PGUP:
+	case VSPGDN_220PGDN:
+		localEchoKey(inPtr, inVTKey);
+		break;
+	
+	default:
+		// ???
+		break;
+	}
+}// localEchoVTKey
+
+
+/*!
+Invoked when a session has been open for the minimum time
+that makes it “stable” (see Session_StateIsActiveStable()).
+
+(2021.06)
+*/
+void
+longLifeTimerFired	(TimerWheel_TimerRef	UNUSED_ARGUMENT(inTimer),
+					 void*					inMySessionPtr)
+{
+	SessionRef const	kSessionRef = REINTERPRET_CAST(inMySessionPtr, My_SessionPtr)->selfRef;
+	
+	
+	if (Session_IsValid(kSessionRef) && Session_StateIsActiveUnstable(kSessionRef))
+	{
+		Session_SetState(kSessionRef, kSession_StateActiveStable);
+	}
+}// longLifeTimerFired
+
+
+/*!
+Returns the given text in the given encoding, or nullptr if
+it cannot be converted without loss.
+
+(2021.06)
+*/
+AsyncWriter_Buffer
+newEncodedInput		(CFStringRef		inText,
+					 CFStringEncoding	inEncoding)
+{
+	CFRange const		kRange = CFRangeMake(0, CFStringGetLength(inText));
+	CFIndex				byteCount = 0;
+	AsyncWriter_Buffer	result;
+	
+	
+	// find the size first; the conversion fails if any character cannot be converted
+	if (kRange.length == CFStringGetBytes(inText, kRange, inEncoding, 0/* loss byte, or 0 for no lossy conversion */,
+											false/* is external representation */, nullptr, 0, &byteCount))
+	{
+		std::vector< UInt8 >	bytes(byteCount);
+		
+		
+		UNUSED_RETURN(CFIndex)CFStringGetBytes(inText, kRange, inEncoding, 0/* loss byte, or 0 for no lossy conversion */,
+												false/* is external representation */, bytes.data(), byteCount, &byteCount);
+		result = std::make_shared< std::vector< UInt8 > const >(std::move(bytes));
+	}
+	return result;
+}// newEncodedInput
+
+
+/*!
+Returns the sequence to send for a key, given a signature
+from broadcastKey(): either the modes of the terminal (see
+Terminal_ReturnKeyModes()) or "kMy_KeySignatureEmacsArrows"
+for arrows that are remapped to Emacs commands.  This is
+the same data that Session_UserInputKey() sends.
+
+Returns nullptr if the key has no sequence.
+
+(2021.06)
+*/
+AsyncWriter_Buffer
+newKeyInput		(UInt8		inKeyOrASCII,
+				 UInt64		inEventModifiers,
+				 UInt32		inKeySignature)
+{
+	AsyncWriter_Buffer	result;
+	
+	
+	if (inKeyOrASCII < VSF10)
+	{
+		// 7-bit ASCII; send as-is
+		result = std::make_shared< std::vector< UInt8 > const >(1, inKeyOrASCII);
+	}
+	else if (kMy_KeySignatureEmacsArrows == inKeySignature)
+	{
+		std::string const	kSequence = returnEmacsArrowSequence(inKeyOrASCII, inEventModifiers);
+		
+		
+		result = std::make_shared< std::vector< UInt8 > const >(kSequence.begin(), kSequence.end());
+	}
+	else
+	{
+		std::vector< UInt8 >	sequence;
+		
+		
+		if (kTerminal_ResultOK == Terminal_UserInputVTKeyCopySequence(inKeyOrASCII, inKeySignature, sequence))
+		{
+			result = std::make_shared< std::vector< UInt8 > const >(std::move(sequence));
+		}
+	}
+	return result;
+}// newKeyInput
+
+
+/*!
+Sends as much of the session’s Paste as possible (up to
+"kMy_PasteCharactersPerBatch" characters), then schedules
+itself to send the rest.  The next batch is sent right away
+unless the process is not reading its input (in which case
+there is a short wait) or the user has asked for a delay
+after each line.  The Paste ends when all of its text has
+been sent, or when too many waits pass without progress.
+
+(2021.06)
+*/
+void
+pasteStreamContinue		(My_SessionPtr		inPtr)
+{
+	CFIndex		charactersSent = 0;
+	int64_t		nextDelay = 0;
+	Boolean		stalled = false;
+	
+	
+	while ((nullptr != inPtr->pasteStream) && (charactersSent < kMy_PasteCharactersPerBatch))
+	{
+		// read the next part of the text if everything has been sent
+		if (inPtr->pasteChunkOffset >= inPtr->pasteChunkLength)
+		{
+			if (0 != inPtr->pasteChunkLength)
+			{
+				// in line-by-line mode, each part ends a line (unless the line
+				// is very long); wait before continuing, if appropriate
+				inPtr->pasteChunkLength = 0;
+				inPtr->pasteChunkOffset = 0;
+				if (0 != inPtr->pasteLineDelay)
+				{
+					nextDelay = inPtr->pasteLineDelay;
+					break;
+				}
+			}
+			
+			if (kPasteStream_ResultOK != PasteStream_ReadChunk(inPtr->pasteStream, inPtr->pasteChunk.data(),
+																STATIC_CAST(inPtr->pasteChunk.size(), CFIndex),
+																inPtr->pasteChunkLength))
+			{
+				// nothing is left to send
+				pasteStreamStop(inPtr);
+				break;
+			}
+		}
+		
+		// if the process cannot accept data right now, try again later
+		// (in a broadcast group, input is written in the background; but
+		// a Paste waits for the process to read most of what was sent)
+		if (Session_NetworkIsSuspended(inPtr->selfRef) || AsyncWriter_IsBacklogFull(inPtr->inputWriter))
+		{
+			stalled = true;
+			break;
+		}
+		
+		// send as much of the current part as possible
+		{
+			CFRetainRelease		chunkCFString(CFStringCreateWithCharactersNoCopy(kCFAllocatorDefault, inPtr->pasteChunk.data(),
+																					inPtr->pasteChunkLength, kCFAllocatorNull),
+												CFRetainRelease::kAlreadyRetained);
+			CFIndex				sentNow = 0;
+			
+			
+			if (false == chunkCFString.exists())
+			{
+				Console_Warning(Console_WriteLine, "aborting Paste, unable to create string for part of the text");
+				pasteStreamStop(inPtr);
+				break;
+			}
+			
+			// dump to the local terminal first, if this mode is turned on
+			if ((0 == inPtr->pasteChunkOffset) && inPtr->echo.enabled)
+			{
+				localEchoString(inPtr, chunkCFString.returnCFStringRef());
+			}
+			
+			sentNow = Session_SendDataCFString(inPtr->selfRef, chunkCFString.returnCFStringRef(), inPtr->pasteChunkOffset);
+			if (sentNow < 0)
+			{
+				Console_Warning(Console_WriteLine, "aborting Paste, unable to send data to the process");
+				pasteStreamStop(inPtr);
+				break;
+			}
+			inPtr->pasteChunkOffset += sentNow;
+			charactersSent += sentNow;
+			if (inPtr->pasteChunkOffset < inPtr->pasteChunkLength)
+			{
+				// the process is not reading quickly enough; try again later
+				stalled = true;
+				break;
+			}
+		}
+	}
+	
+	if (nullptr != inPtr->pasteStream)
+	{
+		SInt16 const	kPercent = STATIC_CAST(100 * PasteStream_ReturnProgress(inPtr->pasteStream), SInt16);
+		
+		
+		if (stalled)
+		{
+			if (0 != charactersSent)
+			{
+				inPtr->pasteStallCount = 0;
+			}
+			else if (++(inPtr->pasteStallCount) > kMy_PasteRetryLimit)
+			{
+				Console_Warning(Console_WriteLine, "aborting Paste, process has not read any input for too long");
+				pasteStreamStop(inPtr);
+				return;
+			}
+			nextDelay = kMy_PasteRetryDelayInNanoseconds;
+		}
+		else
+		{
+			inPtr->pasteStallCount = 0;
+		}
+		
+		if (kPercent != inPtr->pasteReportedPercent)
+		{
+			inPtr->pasteReportedPercent = kPercent;
+			changeNotifyForSession(inPtr, kSession_ChangePasteProgress, inPtr->selfRef);
+		}
+		
+		pasteStreamSchedule(inPtr, nextDelay);
+	}
+}// pasteStreamContinue
+
+
+/*!
+Arranges for pasteStreamContinue() to be called on the main
+queue after the given number of nanoseconds, unless the Paste
+ends or the session is destroyed first.
+
+(2021.06)
+*/
+void
+pasteStreamSchedule		(My_SessionPtr		inPtr,
+						 int64_t			inDelayInNanoseconds)
+{
+	SessionRef const	kSessionRef = inPtr->selfRef;
+	UInt32 const		kSerialNumber = inPtr->pasteSerialNumber;
+	
+	
+	dispatch_after(dispatch_time(DISPATCH_TIME_NOW, inDelayInNanoseconds), dispatch_get_main_queue(),
+					^{
+						if (Session_IsValid(kSessionRef))
+						{
+							My_SessionAutoLocker	ptr(gSessionPtrLocks(), kSessionRef);
+							
+							
+							if (kSerialNumber == ptr->pasteSerialNumber)
+							{
+								pasteStreamContinue(ptr);
+							}
+						}
+					});
+}// pasteStreamSchedule
+
+
+/*!
+Begins sending the given text to the session as if it were
+typed, replacing any Paste that was already in progress.  If
+"inJoinLines" is true, each new-line sequence is replaced by
+a single space; otherwise, new-lines are sent the same way
+that the Return key would send them.
+
+If the terminal has enabled bracketed paste mode, the text is
+enclosed in the markers of that mode and is sent without any
+delays between lines (the application can tell where the
+Paste ends so there is no need to slow it down).
+
+(2021.06)
+*/
+void
+pasteStreamStart	(My_SessionPtr		inPtr,
+					 CFStringRef		inText,
+					 Boolean			inJoinLines)
+{
+	UniChar					newLineSequence[kPasteStream_MaximumNewLineLength] = { '\n', '\0' };
+	UInt16					newLineLength = 1;
+	PasteStream_Options		options = kPasteStream_OptionsNone;
+	
+	
+	pasteStreamStop(inPtr);
+	predictionAddOtherInput(inPtr);
+	
+	if (inJoinLines)
+	{
+		newLineSequence[0] = ' ';
+	}
+	else
+	{
+		// send new-lines in the same way as the Return key (see Session_SendNewline())
+		switch (inPtr->eventKeys.newline)
+		{
+		case kSession_NewlineModeMapCR:
+			newLineSequence[0] = '\r';
+			break;
+		
+		case kSession_NewlineModeMapCRLF:
+			newLineSequence[0] = '\r';
+			newLineSequence[1] = '\n';
+			newLineLength = 2;
+			break;
+		
+		case kSession_NewlineModeMapCRNull:
+			newLineSequence[0] = '\r';
+			newLineSequence[1] = '\0';
+			newLineLength = 2;
+			break;
+		
+		case kSession_NewlineModeMapLF:
+		default:
+			break;
+		}
+	}
+	
+	if ((false == inPtr->targetTerminals.empty()) && Terminal_BracketedPasteIsEnabled(inPtr->targetTerminals.front()))
+	{
+		options |= kPasteStream_OptionBracketed;
+	}
+	else if (false == inJoinLines)
+	{
+		Preferences_TimeInterval	delayValue = 0;
+		
+		
+		// determine how long the delay between lines should be
+		unless (kPreferences_ResultOK ==
+				Preferences_GetData(kPreferences_TagPasteNewLineDelay, sizeof(delayValue), &delayValue))
+		{
+			// set an arbitrary default value
+			delayValue = 50 * kPreferences_TimeIntervalMillisecond;
+		}
+		inPtr->pasteLineDelay = STATIC_CAST(delayValue / kPreferences_TimeIntervalNanosecond, int64_t);
+		if (inPtr->pasteLineDelay > 0)
+		{
+			options |= kPasteStream_OptionChunkPerLine;
+		}
+		else
+		{
+			inPtr->pasteLineDelay = 0;
+		}
+	}
+	
+	inPtr->pasteStream = PasteStream_New(inText, newLineSequence, newLineLength, options);
+	if (nullptr == inPtr->pasteStream)
+	{
+		Console_Warning(Console_WriteLine, "unable to start Paste");
+		inPtr->pasteLineDelay = 0;
+	}
+	else
+	{
+		try
+		{
+			inPtr->pasteChunk.resize(kMy_PasteChunkLength);
+		}
+		catch (std::bad_alloc const&)
+		{
+			Console_Warning(Console_WriteLine, "unable to start Paste, out of memory");
+			pasteStreamStop(inPtr);
+			return;
+		}
+		
+		// first send any outstanding data in the buffer
+		Session_SendFlush(inPtr->selfRef);
+		
+		inPtr->pasteReportedPercent = 0;
+		changeNotifyForSession(inPtr, kSession_ChangePasteProgress, inPtr->selfRef);
+		pasteStreamContinue(inPtr);
+	}
+}// pasteStreamStart
+
+
+/*!
+Ends any Paste that is in progress; any text that was not
+already sent is discarded.  Blocks that are still scheduled
+for the Paste do nothing when they run.
+
+(2021.06)
+*/
+void
+pasteStreamStop		(My_SessionPtr		inPtr)
+{
+	if (nullptr != inPtr->pasteStream)
+	{
+		PasteStream_Dispose(&inPtr->pasteStream);
+		std::vector< UniChar >().swap(inPtr->pasteChunk);
+		inPtr->pasteChunkLength = 0;
+		inPtr->pasteChunkOffset = 0;
+		inPtr->pasteLineDelay = 0;
+		inPtr->pasteStallCount = 0;
+		inPtr->pasteReportedPercent = -1;
+		++(inPtr->pasteSerialNumber);
+		changeNotifyForSession(inPtr, kSession_ChangePasteProgress, inPtr->selfRef);
+	}
+}// pasteStreamStop
+
+
+/*!
+Tells the echo predictor (if any) about characters that
+the user typed, and draws any prediction that results.
+
+Predictions are only made for input that is sent as is;
+when regular local echo is on, there is nothing to predict.
+
+(2021.06)
+*/
+void
+predictionAddInput	(My_SessionPtr		inPtr,
+					 CFStringRef		inText)
+{
+	if (nullptr != inPtr->echo.predictor)
+	{
+		if (inPtr->echo.enabled)
+		{
+			EchoPredictor_UserInputOther(inPtr->echo.predictor);
+		}
+		else
+		{
+			CFIndex const	kLength = CFStringGetLength(inText);
+			UInt64 const	kNow = returnMonotonicNanoseconds();
+			
+			
+			for (CFIndex i = 0; i < kLength; ++i)
+			{
+				UNUSED_RETURN(Boolean)EchoPredictor_UserInputCharacter(inPtr->echo.predictor, CFStringGetCharacterAtIndex(inText, i), kNow);
 			}
-			break;
+		}
+		predictionUpdateDisplay(inPtr);
+	}
+}// predictionAddInput
+
+
+/*!
+Tells the echo predictor (if any) that the user sent input
+whose echo cannot be predicted, such as a function key, a
+control character or a Paste.  Any displayed predictions
+remain until the terminal changes.
+
+(2021.06)
+*/
+void
+predictionAddOtherInput		(My_SessionPtr		inPtr)
+{
+	if (nullptr != inPtr->echo.predictor)
+	{
+		EchoPredictor_UserInputOther(inPtr->echo.predictor);
+	}
+}// predictionAddOtherInput
+
+
+/*!
+Compares the first terminal of the session with what the
+echo predictor expects, after new data has been processed;
+confirmed predictions are removed, and wrong ones cause all
+predictions to be discarded.
+
+The text of the cursor row is only copied when predictions
+are outstanding.
+
+(2021.06)
+*/
+void
+predictionTerminalChanged	(My_SessionPtr		inPtr)
+{
+	if ((nullptr != inPtr->echo.predictor) && (false == inPtr->targetTerminals.empty()))
+	{
+		TerminalScreenRef		screen = inPtr->targetTerminals.front();
+		UInt16					cursorColumn = 0;
+		UInt16					cursorRow = 0;
+		std::vector< UniChar >	rowText;
 		
-		case VSEND_220PGUP:
-			hoverEcho = true; // avoid insertion, since the local terminal won’t do anything with this key
-			if (hoverEcho)
-			{
-				// TEMPORARY: only makes sense for VT220 terminals
-				terminalHoverLocalEchoString(inPtr, REINTERPRET_CAST("page up", UInt8 const*), 7); // LOCALIZE THIS
-				writeVerbatim = false;
-			}
-			break;
 		
-		case VSPGDN_220PGDN:
-			hoverEcho = true; // avoid insertion, since the local terminal won’t do anything with this key
-			if (hoverEcho)
+		if (kTerminal_ResultOK == Terminal_CursorGetLocation(screen, &cursorColumn, &cursorRow))
+		{
+			if (EchoPredictor_IsPredicting(inPtr->echo.predictor))
 			{
-				// TEMPORARY: only makes sense for VT220 terminals
-				terminalHoverLocalEchoString(inPtr, REINTERPRET_CAST("page down", UInt8 const*), 9); // LOCALIZE THIS
-				writeVerbatim = false;
+				Terminal_LineStackStorage	lineIteratorData;
+				Terminal_LineRef			lineIterator = Terminal_NewMainScreenLineIterator(screen, cursorRow, &lineIteratorData);
+				
+				
+				if (nullptr != lineIterator)
+				{
+					CFStringRef		lineText = nullptr;
+					CFRange			lineRange = CFRangeMake(0, 0);
+					
+					
+					if ((kTerminal_ResultOK == Terminal_GetLine(screen, lineIterator, lineText, lineRange, 0/* flags */)) &&
+						(nullptr != lineText) && (lineRange.length > 0))
+					{
+						rowText.resize(STATIC_CAST(lineRange.length, size_t));
+						CFStringGetCharacters(lineText, lineRange, rowText.data());
+					}
+					Terminal_DisposeLineIterator(&lineIterator);
+				}
 			}
-			break;
-		
-		default:
-			// ???
-			break;
+			
+			EchoPredictor_TerminalChanged(inPtr->echo.predictor, cursorColumn, cursorRow,
+											Terminal_ReturnColumnCount(screen), Terminal_AlternateScreenIsActive(screen),
+											rowText.data(), STATIC_CAST(std::min< size_t >(rowText.size(), UINT16_MAX), UInt16),
+											returnMonotonicNanoseconds());
 		}
+		predictionUpdateDisplay(inPtr);
 	}
-	
-	if (writeVerbatim)
-	{
-		terminalInsertLocalEchoString(inPtr, &inKeyOrASCII, 1/* byte count */);
-	}
-}// localEchoKey
+}// predictionTerminalChanged
 
 
 /*!
-Immediately sends the specified string to the local terminal,
-as bytes in its output text encoding (defined by a call to
-Session_SetSendDataEncoding()).
+Updates the focused terminal view of the session to show
+the characters that the echo predictor currently wants to
+display, or nothing at all.
 
-(4.0)
+(2021.06)
 */
 void
-localEchoString		(My_SessionPtr		inPtr,
-					 CFStringRef		inStringBuffer)
+predictionUpdateDisplay		(My_SessionPtr		inPtr)
 {
-	if (nullptr != inStringBuffer)
+	if (nullptr != inPtr->terminalWindow)
 	{
-		// convert the stream from UTF-8 into the encoding of the session
-		try
+		TerminalViewRef		view = TerminalWindow_ReturnViewWithFocus(inPtr->terminalWindow);
+		
+		
+		if (nullptr != view)
 		{
-			size_t const	kBufferSize = (1 + CFStringGetMaximumSizeForEncoding
-											(CFStringGetLength(inStringBuffer), inPtr->writeEncoding));
-			char*			stringBuffer = new char[kBufferSize];
+			UInt16					column = 0;
+			UInt16					row = 0;
+			std::vector< UniChar >	displayedText;
 			
 			
-			stringBuffer[kBufferSize - 1] = '\0';
-			if (false == CFStringGetCString(inStringBuffer, stringBuffer, kBufferSize, inPtr->writeEncoding))
+			if ((nullptr != inPtr->echo.predictor) &&
+				EchoPredictor_ReturnDisplay(inPtr->echo.predictor, column, row, displayedText))
 			{
-				Console_Warning(Console_WriteValue, "input text does not match terminal with text encoding", inPtr->writeEncoding);
-				Console_Warning(Console_WriteValueCFString, "cannot convert into the encoding used by this terminal, text", inStringBuffer);
+				CFRetainRelease		textObject(CFStringCreateWithCharacters(kCFAllocatorDefault, displayedText.data(),
+																			STATIC_CAST(displayedText.size(), CFIndex)),
+												CFRetainRelease::kAlreadyRetained);
+				
+				
+				UNUSED_RETURN(TerminalView_Result)TerminalView_SetPredictedText(view, column, row, textObject.returnCFStringRef());
 			}
 			else
 			{
-				terminalInsertLocalEchoString(inPtr, REINTERPRET_CAST(stringBuffer, UInt8 const*), CPP_STD::strlen(stringBuffer));
+				UNUSED_RETURN(TerminalView_Result)TerminalView_SetPredictedText(view, 0, 0, nullptr);
 			}
-			delete [] stringBuffer;
-		}
-		catch (std::bad_alloc)
-		{
-			Console_WriteLine("local echo of string failed, out of memory!");
 		}
 	}
-}// localEchoString
+}// predictionUpdateDisplay
 
 
 /*!
@@ -6234,6 +7214,12 @@ processMoreData		(My_SessionPtr	inPtr)
 			// this is the typical case; send data to a sophisticated terminal emulator
 			std::for_each(inPtr->targetTerminals.begin(), inPtr->targetTerminals.end(),
 							terminalDataWriter(kBuffer, kProcessedByteCount));
+			
+			// compare any predicted echo with what actually arrived
+			if (nullptr != inPtr->echo.predictor)
+			{
+				predictionTerminalChanged(inPtr);
+			}
 		}
 		else
 		{
@@ -6247,6 +7233,34 @@ processMoreData		(My_SessionPtr	inPtr)
 }// processMoreData
 
 
+/*!
+Invoked shortly after a session has been asked to restart,
+to respawn its original command line in the same window
+(this is only armed after the previous process is dead).
+
+(2021.06)
+*/
+void
+respawnTimerFired	(TimerWheel_TimerRef	UNUSED_ARGUMENT(inTimer),
+					 void*					inMySessionPtr)
+{
+	SessionRef const	kSessionRef = REINTERPRET_CAST(inMySessionPtr, My_SessionPtr)->selfRef;
+	
+	
+	if (Session_IsValid(kSessionRef))
+	{
+		Boolean		respawnOK = SessionFactory_RespawnSession(kSessionRef);
+		
+		
+		if (false == respawnOK)
+		{
+			Sound_StandardAlert();
+			Console_Warning(Console_WriteLine, "failed to restart session");
+		}
+	}
+}// respawnTimerFired
+
+
 /*!
 Returns the window most recently used by this session.
 
@@ -6269,6 +7283,184 @@ returnActiveNSWindow	(My_SessionPtr		inPtr)
 }// returnActiveNSWindow
 
 
+/*!
+Returns a copy of the sessions in the broadcast group of
+the given session, or only the given session if it is not
+in a group.  Any other session that has fallen too far
+behind is removed from the group first (see
+BroadcastGroup_ReturnActiveMembers()), so that one slow
+process cannot make the others wait or use an unlimited
+amount of memory.
+
+(2021.06)
+*/
+std::vector< SessionRef >
+returnBroadcastMembers	(My_SessionPtr		inPtr)
+{
+	std::vector< SessionRef >	result;
+	
+	
+	if (0 == inPtr->broadcastGroup)
+	{
+		result.push_back(inPtr->selfRef);
+	}
+	else
+	{
+		std::vector< BroadcastGroup_Member >	removedMembers;
+		
+		
+		// a session that is pacing its own Paste may fall behind
+		// (see pasteStreamContinue()), so it is never removed
+		for (auto member : BroadcastGroup_ReturnActiveMembers(inPtr->broadcastGroup, inPtr->selfRef,
+																[](BroadcastGroup_Member aMember)
+																{
+																	My_SessionAutoLocker	memberPtr(gSessionPtrLocks(), STATIC_CAST(aMember, SessionRef));
+																	
+																	
+																	return (nullptr == memberPtr->pasteStream);
+																}, &removedMembers))
+		{
+			result.push_back(STATIC_CAST(member, SessionRef));
+		}
+		
+		for (auto member : removedMembers)
+		{
+			My_SessionAutoLocker	memberPtr(gSessionPtrLocks(), STATIC_CAST(member, SessionRef));
+			
+			
+			Console_Warning(Console_WriteValue, "removing session from broadcast group because its input backlog is full; bytes",
+							AsyncWriter_ReturnBacklogSize(memberPtr->inputWriter));
+			broadcastGroupLeave(memberPtr, false/* discard input */);
+		}
+	}
+	return result;
+}// returnBroadcastMembers
+
+
+/*!
+Returns the Emacs command that an arrow key is mapped to
+when arrows are remapped for Emacs, given modifier keys.
+
+(2021.06)
+*/
+std::string
+returnEmacsArrowSequence	(UInt8		inArrowKey,
+							 UInt64		inEventModifiers)
+{
+	std::string		result(1, inArrowKey);
+	
+	
+	// map from arrow keys to Emacs control keys; consider all standard
+	// Mac modes, i.e. option-arrow for words, command-arrows for lines
+	switch (inArrowKey)
+	{
+	case VSLT:
+		{
+			if (inEventModifiers & NSEventModifierFlagOption)
+			{
+				// move one word backward (meta-b)
+				result[0] = 0x1B; // ESC (meta equivalent)
+				result.push_back('b');
+			}
+			else if (inEventModifiers & NSEventModifierFlagCommand)
+			{
+				// move to beginning of line (^A)
+				result[0] = 0x01;
+			}
+			else
+			{
+				// move one character backward (^B)
+				result[0] = 0x02;
+			}
+		}
+		break;
+	
+	case VSRT:
+		{
+			if (inEventModifiers & NSEventModifierFlagOption)
+			{
+				// move one word forward (meta-f)
+				result[0] = 0x1B; // ESC (meta equivalent)
+				result.push_back('f');
+			}
+			else if (inEventModifiers & NSEventModifierFlagCommand)
+			{
+				// move to beginning of line (^E)
+				result[0] = 0x05;
+			}
+			else
+			{
+				// move one character forward (^F)
+				result[0] = 0x06;
+			}
+		}
+		break;
+	
+	case VSUP:
+		{
+			if (inEventModifiers & NSEventModifierFlagOption)
+			{
+				// move to beginning of line (^A)
+				result[0] = 0x01;
+			}
+			else if (inEventModifiers & NSEventModifierFlagCommand)
+			{
+				// move to beginning of buffer (meta-<)
+				result[0] = 0x1B; // ESC (meta equivalent)
+				result.push_back('<');
+			}
+			else
+			{
+				// move one line up (^P)
+				result[0] = 0x10; // ^P
+			}
+		}
+		break;
+	
+	case VSDN:
+		{
+			if (inEventModifiers & NSEventModifierFlagOption)
+			{
+				// move to end of line (^E)
+				result[0] = 0x05;
+			}
+			else if (inEventModifiers & NSEventModifierFlagCommand)
+			{
+				// move to end of buffer (meta-<)
+				result[0] = 0x1B; // ESC (meta equivalent)
+				result.push_back('>');
+			}
+			else
+			{
+				// move one line down (^N)
+				result[0] = 0x0E;
+			}
+		}
+		break;
+	
+	default:
+		break;
+	}
+	return result;
+}// returnEmacsArrowSequence
+
+
+/*!
+Returns a time in nanoseconds that only increases, for
+measuring how long the server takes to echo input.
+
+(2021.06)
+*/
+UInt64
+returnMonotonicNanoseconds ()
+{
+	auto const	kSinceEpoch = std::chrono::steady_clock::now().time_since_epoch();
+	
+	
+	return STATIC_CAST(std::chrono::duration_cast< std::chrono::nanoseconds >(kSinceEpoch).count(), UInt64);
+}// returnMonotonicNanoseconds
+
+
 /*!
 Updates the name of the icon file that is stored in
 the session to represent its current state.
@@ -6723,36 +7915,10 @@ terminationWarningClose		(SessionRef&	inoutSessionRef,
 				// this should probably be more explicit
 				Session_TerminalWriteCString(inoutSessionRef, "\033[H\033[J");
 				
-				// install a one-shot timer to rerun the command line after a short delay
+				// arm a one-shot timer to rerun the command line after a short delay
 				// (certain processes, such as shells, do not respawn correctly if the
 				// respawn is attempted immediately after the previous process exits)
-				SessionRef const	blockSessionRef = inoutSessionRef;
-				if (nil != ptr->respawnSessionTimer)
-				{
-					[ptr->respawnSessionTimer invalidate];
-					ptr->respawnSessionTimer = nil;
-				}
-				ptr->respawnSessionTimer = [NSTimer scheduledTimerWithTimeInterval:(200 / 1000.0/* milliseconds per second */)/* in seconds */
-				repeats:NO
-				block:^(NSTimer* UNUSED_ARGUMENT(timer))
-				{
-					if (Session_IsValid(blockSessionRef))
-					{
-						// respawns the original command line for the session, using the
-						// same window (this should only be invoked after the previous
-						// session is dead)
-						//My_SessionAutoLocker	blockSessionPtr(gSessionPtrLocks(), blockSessionRef);
-						Boolean					respawnOK = SessionFactory_RespawnSession(blockSessionRef);
-						
-						
-						if (false == respawnOK)
-						{
-							Sound_StandardAlert();
-							Console_Warning(Console_WriteLine, "failed to restart session");
-						}
-					}
-				}];
-				//NSLog(@"schedule respawn timer %@", ptr->respawnSessionTimer);
+				UNUSED_RETURN(TimerWheel_Result)TimerWheel_Arm(ptr->respawnSessionTimer, 200/* milliseconds */);
 			}
 		}
 	}
@@ -6997,6 +8163,32 @@ watchNotifyForSession	(My_SessionPtr	inPtr,
 }// watchNotifyForSession
 
 
+/*!
+Invoked after a period of inactivity on a session that has
+a keep-alive or inactivity watch.
+
+(2021.06)
+*/
+void
+watchTimerFired		(TimerWheel_TimerRef	UNUSED_ARGUMENT(inTimer),
+					 void*					inMySessionPtr)
+{
+	SessionRef const	kSessionRef = REINTERPRET_CAST(inMySessionPtr, My_SessionPtr)->selfRef;
+	
+	
+	if (Session_IsValid(kSessionRef))
+	{
+		My_SessionAutoLocker	ptr(gSessionPtrLocks(), kSessionRef);
+		
+		
+		// this is invoked after a period of inactivity, and simply sends
+		// notification that the session is now inactive (from the point of
+		// view of the user; not to be confused with session active state)
+		watchNotifyForSession(ptr, ptr->activeWatch);
+	}
+}// watchTimerFired
+
+
 /*!
 If a watch is currently active on the specified session and
 the watch is of a type that fires periodically (idle timers),
@@ -7005,7 +8197,11 @@ when you want to start waiting for the precise duration of
 the watch (usually, immediately after data arrives or some
 other event indicates the watch should start over).
 
-Has no effect for other kinds of watches.
+This is called for every chunk of data that arrives, so it
+only re-arms a shared timer (which normally just records a
+new deadline; see TimerWheel_Arm()).
+
+For other kinds of watches, the timer is cancelled.
 
 (3.1)
 */
@@ -7013,86 +8209,41 @@ void
 watchTimerResetForSession	(My_SessionPtr	inPtr,
 							 Session_Watch	inWatchType)
 {
-	SessionRef const	blockSessionRef = inPtr->selfRef;
-	auto	timerRunBlock =
-			^(NSTimer* UNUSED_ARGUMENT(timer))
-			{
-				if (Session_IsValid(blockSessionRef))
-				{
-					My_SessionAutoLocker	blockSessionPtr(gSessionPtrLocks(), blockSessionRef);
-					
-					
-					// this is invoked after a period of inactivity, and simply sends
-					// notification that the session is now inactive (from the point of
-					// view of the user; not to be confused with session active state)
-					watchNotifyForSession(blockSessionPtr, blockSessionPtr->activeWatch);
-				}
-			};
-	
-	
 	if (kSession_WatchForKeepAlive == inWatchType)
 	{
-		Preferences_Result	prefsResult = kPreferences_ResultOK;
-		UInt16				intValue = 0;
+		UInt16		intValue = 0;
 		
 		
-		prefsResult = Preferences_GetData(kPreferences_TagKeepAlivePeriodInMinutes, sizeof(intValue),
-											&intValue);
-		if (kPreferences_ResultOK != prefsResult)
+		if (kPreferences_ResultOK != Preferences_GetValue< kPreferences_TagKeepAlivePeriodInMinutes >(intValue))
 		{
 			// set an arbitrary default value
 			intValue = 10;
 		}
 		
-		{
-			// an arbitrary length of dead time must elapse before a session
-			// is considered inactive and triggers a notification
-			NSTimeInterval const	kTimeBeforeInactive = (intValue * 60.0/* seconds per minute */);
-			
-			
-			// set timer to trigger the no-activity notification when appropriate
-			if (nil != inPtr->inactivityWatchTimer)
-			{
-				[inPtr->inactivityWatchTimer invalidate];
-				inPtr->inactivityWatchTimer = nil;
-			}
-			inPtr->inactivityWatchTimer = [NSTimer scheduledTimerWithTimeInterval:kTimeBeforeInactive/* in seconds */
-																					repeats:NO
-																					block:timerRunBlock];
-			//NSLog(@"schedule keep-alive watch %@", inPtr->inactivityWatchTimer);
-		}
+		// an arbitrary length of dead time must elapse before a session
+		// is considered inactive and triggers a notification
+		UNUSED_RETURN(TimerWheel_Result)TimerWheel_Arm(inPtr->inactivityWatchTimer,
+														intValue * 60000/* milliseconds per minute */);
 	}
 	else if (kSession_WatchForInactivity == inWatchType)
 	{
-		Preferences_Result	prefsResult = kPreferences_ResultOK;
-		UInt16				intValue = 0;
+		UInt16		intValue = 0;
 		
 		
-		prefsResult = Preferences_GetData(kPreferences_TagIdleAfterInactivityInSeconds, sizeof(intValue),
-											&intValue);
-		if (kPreferences_ResultOK != prefsResult)
+		if (kPreferences_ResultOK != Preferences_GetValue< kPreferences_TagIdleAfterInactivityInSeconds >(intValue))
 		{
 			// set an arbitrary default value
 			intValue = 30;
 		}
 		
-		{
-			// an arbitrary length of dead time must elapse before a session
-			// is considered inactive and triggers a notification
-			NSTimeInterval const	kTimeBeforeInactive = intValue/* in seconds */;
-			
-			
-			// install or reset timer to trigger the no-activity notification when appropriate
-			if (nil != inPtr->inactivityWatchTimer)
-			{
-				[inPtr->inactivityWatchTimer invalidate];
-				inPtr->inactivityWatchTimer = nil;
-			}
-			inPtr->inactivityWatchTimer = [NSTimer scheduledTimerWithTimeInterval:kTimeBeforeInactive/* in seconds */
-																					repeats:NO
-																					block:timerRunBlock];
-			//NSLog(@"schedule inactivity watch %@", inPtr->inactivityWatchTimer);
-		}
+		// an arbitrary length of dead time must elapse before a session
+		// is considered inactive and triggers a notification
+		UNUSED_RETURN(TimerWheel_Result)TimerWheel_Arm(inPtr->inactivityWatchTimer,
+														intValue * 1000/* milliseconds per second */);
+	}
+	else
+	{
+		UNUSED_RETURN(TimerWheel_Result)TimerWheel_Cancel(inPtr->inactivityWatchTimer);
 	}
 }// watchTimerResetForSession
 
@@ -7385,6 +8536,7 @@ receivedDeleteWordBackwardInTerminalView:(TerminalViewRef)		aTerminalViewRef
 			terminalHoverLocalEchoString(ptr, seqUTF8, sizeof(seqUTF8));
 		}
 		
+		predictionAddOtherInput(ptr);
 		Session_SendData(self.sessionRef, actualKeySeq, sequenceLength);
 	}
 }// receivedDeleteWordBackwardInTerminalView:
@@ -7418,6 +8570,8 @@ terminalView:(TerminalViewRef)		aTerminalViewRef
 			terminalHoverLocalEchoString(ptr, REINTERPRET_CAST([keyString UTF8String], UInt8 const*), STATIC_CAST(keyString.length, size_t));
 		}
 		
+		predictionAddOtherInput(ptr);
+		
 		// Emacs respects a prefixing Escape character as being equivalent to meta
 		Session_SendData(self.sessionRef, actualKeySeq, sequenceLength);
 	}
@@ -7473,11 +8627,13 @@ terminalView:(TerminalViewRef)	aTerminalViewRef
 			}
 			else
 			{
+				predictionAddInput(ptr, asCFString);
 				Session_SendDataCFString(self.sessionRef, asCFString);
 			}
 		}
 		else
 		{
+			predictionAddInput(ptr, asCFString);
 			Session_SendDataCFString(self.sessionRef, asCFString);
 		}
 	}
@@ -193,6 +193,10 @@ Boolean
 													 Preferences_ContextRef			inWorkspaceOrNull = nullptr,
 													 UInt16							inWindowIndexInWorkspaceOrZero = 0);
 
+// ONE WINDOW FOR EACH PROCESS FROM Local_GetDetachedProcesses()
+Boolean
+	SessionFactory_NewSessionsFromDetachedProcesses	();
+
 Boolean
 	SessionFactory_NewSessionsUserFavoriteWorkspace	(Preferences_ContextRef			inWorkspaceContext);
 
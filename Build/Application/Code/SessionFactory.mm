@@ -79,10 +79,19 @@
 
 
 
+#pragma mark Constants
+namespace {
+
+int64_t const	kMy_WarmShellFillDelayInNanoseconds = 500 * NSEC_PER_MSEC;		// pause between processes started for the warm shell pool
+int64_t const	kMy_WarmShellStartupDelayInNanoseconds = 3 * NSEC_PER_SEC;		// pause after launch before the pool is first filled
+
+} // anonymous namespace
+
 #pragma mark Types
 
 namespace {
 
+typedef std::vector< Local_WarmProcessRef >				MyWarmProcessList;
 typedef std::vector< SessionRef >						SessionList;
 typedef std::vector< TerminalWindowRef >				TerminalWindowList;
 typedef std::multimap< TerminalWindowRef, SessionRef >	TerminalWindowToSessionsMap;
@@ -137,22 +146,29 @@ Boolean					configureSessionTerminalWindow	(TerminalWindowRef, Preferences_Conte
 Boolean					configureSessionTerminalWindowByClass	(TerminalWindowRef, Preferences_ContextRef, Quills::Prefs::Class);
 void					copySessionTerminalWindowConfiguration	(Preferences_ContextRef, Quills::Prefs::Class,
 														 Preferences_ContextRef&);
+Boolean					copyWarmShellConfiguration		(CFArrayRef&, CFStringRef&, UInt16&, UInt16&);
 TerminalWindowRef		createTerminalWindow			(Preferences_ContextRef = nullptr,
 														 Preferences_ContextRef = nullptr,
 														 Preferences_ContextRef = nullptr,
 														 Boolean = false);
 Workspace_Ref			createWorkspace					();
 Boolean					displayTerminalWindow			(TerminalWindowRef, Preferences_ContextRef = nullptr, UInt16 = 0);
+void					fillWarmShellPool				();
 void					forEachSessionInListDo			(SessionList const&, SessionFactory_SessionBlock);
 void					forEachTerminalWindowInListDo	(TerminalWindowList const&, SessionFactory_TerminalWindowBlock);
 void					handleNewSessionDialogClose		(GenericDialog_Ref, Boolean);
+void					invalidateWarmShellPool			();
 Workspace_Ref			returnActiveWorkspace			();
+void					scheduleWarmShellPoolFill		(int64_t);
 void					sessionChanged					(ListenerModel_Ref, ListenerModel_Event, void*, void*);
 void					sessionStateChanged				(ListenerModel_Ref, ListenerModel_Event, void*, void*);
+Local_Result			spawnLocalProcess				(SessionRef, TerminalScreenRef, CFArrayRef, CFStringRef);
 void					startTrackingSession			(SessionRef, TerminalWindowRef);
 void					startTrackingTerminalWindow		(TerminalWindowRef);
 void					stopTrackingSession				(SessionRef);
 void					stopTrackingTerminalWindow		(TerminalWindowRef);
+Local_WarmProcessRef	takeWarmShell					(CFArrayRef, CFStringRef, CFStringRef);
+void					warmShellPreferenceChanged		(ListenerModel_Ref, ListenerModel_Event, void*, void*);
 
 } // anonymous namespace
 
@@ -170,6 +186,9 @@ TerminalWindowList&				gTerminalWindowListSortedByCreationTime ()	{ static Termi
 MyWorkspaceList&				gWorkspaceListSortedByCreationTime ()	{ static MyWorkspaceList x; return x; }
 TerminalWindowToSessionsMap&	gTerminalWindowToSessions()	{ static TerminalWindowToSessionsMap x; return x; }
 NSTimer*						gSessionFactoryWatchForExitsTimer = nil;
+MyWarmProcessList&				gWarmShellPool ()	{ static MyWarmProcessList x; return x; }
+ListenerModel_ListenerRef		gWarmShellPreferenceListener = nullptr;
+Boolean							gWarmShellFillPending = false;	// true if scheduleWarmShellPoolFill() has a block waiting
 
 } // anonymous namespace
 
@@ -256,6 +275,37 @@ SessionFactory_Init ()
 	{
 		Local_CheckForProcessExits();
 	}];
+	
+	// if the user wants sessions started in advance, watch for changes
+	// to anything that determines how those sessions are started; the
+	// first processes are started after launch has settled down
+	gWarmShellPreferenceListener = ListenerModel_NewStandardListener(warmShellPreferenceChanged);
+	UNUSED_RETURN(Preferences_Result)Preferences_StartMonitoring(gWarmShellPreferenceListener, kPreferences_TagWarmShellCount);
+	UNUSED_RETURN(Preferences_Result)Preferences_StartMonitoring(gWarmShellPreferenceListener, kPreferences_TagNewCommandShortcutEffect);
+	{
+		Preferences_ContextRef		defaultContext = nullptr;
+		
+		
+		if (kPreferences_ResultOK == Preferences_GetDefaultContext(&defaultContext, Quills::Prefs::SESSION))
+		{
+			UNUSED_RETURN(Preferences_Result)Preferences_ContextStartMonitoring(defaultContext, gWarmShellPreferenceListener,
+																				kPreferences_TagCommandLine);
+			UNUSED_RETURN(Preferences_Result)Preferences_ContextStartMonitoring(defaultContext, gWarmShellPreferenceListener,
+																				kPreferences_ChangeContextBatchMode);
+		}
+		if (kPreferences_ResultOK == Preferences_GetDefaultContext(&defaultContext, Quills::Prefs::TERMINAL))
+		{
+			UNUSED_RETURN(Preferences_Result)Preferences_ContextStartMonitoring(defaultContext, gWarmShellPreferenceListener,
+																				kPreferences_TagTerminalAnswerBackMessage);
+			UNUSED_RETURN(Preferences_Result)Preferences_ContextStartMonitoring(defaultContext, gWarmShellPreferenceListener,
+																				kPreferences_TagTerminalScreenColumns);
+			UNUSED_RETURN(Preferences_Result)Preferences_ContextStartMonitoring(defaultContext, gWarmShellPreferenceListener,
+																				kPreferences_TagTerminalScreenRows);
+			UNUSED_RETURN(Preferences_Result)Preferences_ContextStartMonitoring(defaultContext, gWarmShellPreferenceListener,
+																				kPreferences_ChangeContextBatchMode);
+		}
+	}
+	scheduleWarmShellPoolFill(kMy_WarmShellStartupDelayInNanoseconds);
 }// Init
 
 
@@ -275,6 +325,16 @@ SessionFactory_Done ()
 	
 	gSessionWindowWatcher = nil;
 	
+	// end any processes that were started in advance
+	UNUSED_RETURN(Preferences_Result)Preferences_StopMonitoring(gWarmShellPreferenceListener, kPreferences_TagWarmShellCount);
+	UNUSED_RETURN(Preferences_Result)Preferences_StopMonitoring(gWarmShellPreferenceListener, kPreferences_TagNewCommandShortcutEffect);
+	for (auto& warmProcess : gWarmShellPool())
+	{
+		Local_DisposeWarmProcess(&warmProcess);
+	}
+	gWarmShellPool().clear();
+	
+	ListenerModel_ReleaseListener(&gWarmShellPreferenceListener);
 	ListenerModel_ReleaseListener(&gSessionStateChangeListener);
 	ListenerModel_ReleaseListener(&gSessionChangeListenerRef);
 	ListenerModel_Dispose(&gSessionStateChangeListenerModel);
@@ -423,9 +483,43 @@ SessionFactory_NewSessionArbitraryCommand	(TerminalWindowRef			inTerminalWindow,
 			Local_Result	localResult = kLocal_ResultOK;
 			
 			
+			TerminalScreenRef		screen = TerminalWindow_ReturnScreenWithFocus(terminalWindow);
+			Boolean					isDetachable = false;
+			Local_WarmProcessRef	warmProcess = nullptr;
+			Boolean					usedWarmProcess = false;
+			
+			
+			// warm processes are not run by the session server, so they
+			// are not used when local sessions are detachable
+			if (kPreferences_ResultOK != Preferences_GetData(kPreferences_TagLocalSessionsDetachable, sizeof(isDetachable), &isDetachable))
+			{
+				isDetachable = false;
+			}
+			unless (isDetachable)
+			{
+				warmProcess = takeWarmShell(inArgumentArray, inWorkingDirectoryOrNull, Terminal_EmulatorReturnName(screen));
+			}
+			
+			// if a process for the same command was started in advance, use it
+			if (nullptr != warmProcess)
+			{
+				localResult = Local_SpawnProcessFromWarmProcess(result, screen, &warmProcess);
+				if (kLocal_ResultOK == localResult)
+				{
+					usedWarmProcess = true;
+				}
+				else
+				{
+					Console_Warning(Console_WriteValue, "unable to use warm process, error", localResult);
+					Local_DisposeWarmProcess(&warmProcess);
+				}
+			}
+			
 			// see also SessionFactory_RespawnSession(), which must do something similar
-			localResult = Local_SpawnProcess(result, TerminalWindow_ReturnScreenWithFocus(terminalWindow),
-												inArgumentArray, inWorkingDirectoryOrNull);
+			if (false == usedWarmProcess)
+			{
+				localResult = spawnLocalProcess(result, screen, inArgumentArray, inWorkingDirectoryOrNull);
+			}
 			if (kLocal_ResultOK == localResult)
 			{
 				// success!
@@ -860,6 +954,75 @@ SessionFactory_NewSessionWithSpecialCommand		(TerminalWindowRef				inTerminalWin
 }// NewSessionWithSpecialCommand
 
 
+/*!
+Creates a new session, in a new terminal window, for every
+process of the session server that no session is attached to
+(see Local_GetDetachedProcesses()).  Each window is restored
+to the state that its process was detached with, if any.
+
+Returns true only if there were no failures (including the
+case where no session server is running, so there are no
+processes to reattach).
+
+(2021.06)
+*/
+Boolean
+SessionFactory_NewSessionsFromDetachedProcesses ()
+{
+	std::vector< Local_DetachedProcessID >	processIDs;
+	Boolean									result = (kLocal_ResultOK == Local_GetDetachedProcesses(processIDs));
+	
+	
+	for (auto	processID : processIDs)
+	{
+		TerminalWindowRef	terminalWindow = createTerminalWindow();
+		SessionRef			session = nullptr;
+		
+		
+		if ((nullptr == terminalWindow) || (false == displayTerminalWindow(terminalWindow)))
+		{
+			Console_Warning(Console_WriteValue, "unable to display terminal window for detached process", processID);
+			result = false;
+		}
+		else
+		{
+			session = Session_New(nullptr/* context */);
+			if (nullptr == session)
+			{
+				result = false;
+			}
+			else
+			{
+				Local_Result	localResult = Local_SpawnProcessFromDetachedProcess
+												(session, TerminalWindow_ReturnScreenWithFocus(terminalWindow), processID);
+				
+				
+				if (kLocal_ResultOK == localResult)
+				{
+					startTrackingSession(session, terminalWindow);
+				}
+				else
+				{
+					Console_Warning(Console_WriteValue, "unable to reattach detached process, error", localResult);
+					Session_Dispose(&session);
+					result = false;
+				}
+			}
+		}
+		
+		// NOTE: normally destroying a session will also release the terminal
+		// window, but in this case it isn’t associated with the session yet
+		if ((nullptr == session) && (nullptr != terminalWindow))
+		{
+			stopTrackingTerminalWindow(terminalWindow);
+			TerminalWindow_Dispose(&terminalWindow);
+		}
+	}
+	
+	return result;
+}// NewSessionsFromDetachedProcesses
+
+
 /*!
 Creates new sessions for each listed in the given workspace,
 in the order they are stored.  Any other constraints (such as
@@ -1018,7 +1181,7 @@ SessionFactory_RespawnSession	(SessionRef		inSession)
 		CFStringRef				workingDirectory = Session_ReturnOriginalWorkingDirectory(inSession);
 		
 		
-		localResult = Local_SpawnProcess(inSession, screenBuffer, Session_ReturnCommandLine(inSession),
+		localResult = spawnLocalProcess(inSession, screenBuffer, Session_ReturnCommandLine(inSession),
 											workingDirectory);
 		result = (kLocal_ResultOK == localResult);
 		
@@ -1730,6 +1893,95 @@ copySessionTerminalWindowConfiguration	(Preferences_ContextRef		inSessionContext
 }// copySessionTerminalWindowConfiguration
 
 
+/*!
+Determines how the processes in the warm shell pool should be
+started: the command line that a new session from the default
+command-N key equivalent would use (see the preference
+"kPreferences_TagNewCommandShortcutEffect"), and the terminal
+name and screen size from the default Terminal settings.
+
+Returns true only if everything was found; in that case, you
+must release the array and string.
+
+(2021.06)
+*/
+Boolean
+copyWarmShellConfiguration	(CFArrayRef&	outArgumentArray,
+							 CFStringRef&	outTerminalName,
+							 UInt16&		outColumnCount,
+							 UInt16&		outRowCount)
+{
+	SessionFactory_SpecialSession	newSessionType = kSessionFactory_SpecialSessionLogInShell;
+	Preferences_ContextRef			defaultContext = nullptr;
+	Boolean							result = false;
+	
+	
+	outArgumentArray = nullptr;
+	outTerminalName = nullptr;
+	outColumnCount = 80; // arbitrary
+	outRowCount = 24; // arbitrary
+	
+	unless (kPreferences_ResultOK ==
+			Preferences_GetData(kPreferences_TagNewCommandShortcutEffect, sizeof(newSessionType), &newSessionType))
+	{
+		newSessionType = kSessionFactory_SpecialSessionLogInShell; // assume a value, if preference can’t be found
+	}
+	
+	switch (newSessionType)
+	{
+	case kSessionFactory_SpecialSessionShell:
+		UNUSED_RETURN(Local_Result)Local_GetDefaultShellCommandLine(outArgumentArray);
+		break;
+	
+	case kSessionFactory_SpecialSessionDefaultFavorite:
+	case kSessionFactory_SpecialSessionInteractiveSheet:
+		if (kPreferences_ResultOK == Preferences_GetDefaultContext(&defaultContext, Quills::Prefs::SESSION))
+		{
+			unless (kPreferences_ResultOK ==
+					Preferences_ContextGetData(defaultContext, kPreferences_TagCommandLine,
+												sizeof(outArgumentArray), &outArgumentArray))
+			{
+				outArgumentArray = nullptr;
+			}
+		}
+		break;
+	
+	case kSessionFactory_SpecialSessionLogInShell:
+	default:
+		UNUSED_RETURN(Local_Result)Local_GetLoginShellCommandLine(outArgumentArray);
+		break;
+	}
+	
+	if (kPreferences_ResultOK == Preferences_GetDefaultContext(&defaultContext, Quills::Prefs::TERMINAL))
+	{
+		unless (kPreferences_ResultOK ==
+				Preferences_ContextGetData(defaultContext, kPreferences_TagTerminalAnswerBackMessage,
+											sizeof(outTerminalName), &outTerminalName))
+		{
+			outTerminalName = nullptr;
+		}
+		UNUSED_RETURN(Preferences_Result)Preferences_ContextGetData(defaultContext, kPreferences_TagTerminalScreenColumns,
+																	sizeof(outColumnCount), &outColumnCount);
+		UNUSED_RETURN(Preferences_Result)Preferences_ContextGetData(defaultContext, kPreferences_TagTerminalScreenRows,
+																	sizeof(outRowCount), &outRowCount);
+	}
+	
+	result = ((nullptr != outArgumentArray) && (nullptr != outTerminalName));
+	if (false == result)
+	{
+		if (nullptr != outArgumentArray)
+		{
+			CFRelease(outArgumentArray), outArgumentArray = nullptr;
+		}
+		if (nullptr != outTerminalName)
+		{
+			CFRelease(outTerminalName), outTerminalName = nullptr;
+		}
+	}
+	return result;
+}// copyWarmShellConfiguration
+
+
 /*!
 Internal version of SessionFactory_NewTerminalWindowUserFavorite().
 
@@ -1978,6 +2230,85 @@ displayTerminalWindow	(TerminalWindowRef			inTerminalWindow,
 }// displayTerminalWindow
 
 
+/*!
+Starts one process for the warm shell pool, if the pool has
+fewer than the number that the user wants; and, if more are
+needed, schedules another call.  Processes are started one at
+a time so that a large pool does not slow down other work.
+
+(2021.06)
+*/
+void
+fillWarmShellPool ()
+{
+	UInt16		targetCount = 0;
+	
+	
+	unless (kPreferences_ResultOK ==
+			Preferences_GetData(kPreferences_TagWarmShellCount, sizeof(targetCount), &targetCount))
+	{
+		targetCount = 0; // assume a value, if preference can’t be found
+	}
+	
+	// remove any processes that have quit on their own
+	for (auto& warmProcess : gWarmShellPool())
+	{
+		if (false == Local_WarmProcessIsRunning(warmProcess))
+		{
+			Local_DisposeWarmProcess(&warmProcess);
+		}
+	}
+	gWarmShellPool().erase(std::remove(gWarmShellPool().begin(), gWarmShellPool().end(), nullptr),
+							gWarmShellPool().end());
+	
+	if (gWarmShellPool().size() < targetCount)
+	{
+		CFArrayRef		argumentCFArray = nullptr;
+		CFStringRef		terminalName = nullptr;
+		UInt16			columnCount = 0;
+		UInt16			rowCount = 0;
+		
+		
+		if (false == copyWarmShellConfiguration(argumentCFArray, terminalName, columnCount, rowCount))
+		{
+			Console_Warning(Console_WriteLine, "unable to determine the command for warm shells");
+		}
+		else
+		{
+			Local_WarmProcessRef	warmProcess = nullptr;
+			Local_Result			localResult = Local_NewWarmProcess(argumentCFArray, terminalName, columnCount,
+																		rowCount, warmProcess);
+			
+			
+			if (kLocal_ResultOK != localResult)
+			{
+				// do not retry; the same failure would likely occur again
+				Console_Warning(Console_WriteValue, "unable to start warm shell, error", localResult);
+			}
+			else
+			{
+				gWarmShellPool().push_back(warmProcess);
+				if (gWarmShellPool().size() < targetCount)
+				{
+					scheduleWarmShellPoolFill(kMy_WarmShellFillDelayInNanoseconds);
+				}
+			}
+			CFRelease(argumentCFArray), argumentCFArray = nullptr;
+			CFRelease(terminalName), terminalName = nullptr;
+		}
+	}
+	else
+	{
+		// remove any processes beyond the number that the user wants
+		while (gWarmShellPool().size() > targetCount)
+		{
+			Local_DisposeWarmProcess(&gWarmShellPool().back());
+			gWarmShellPool().pop_back();
+		}
+	}
+}// fillWarmShellPool
+
+
 /*!
 Internal version of SessionFactory_ForEachSession(), except
 it operates on the specific list given.
@@ -2112,6 +2443,25 @@ handleNewSessionDialogClose		(GenericDialog_Ref		inDialogThatClosed,
 }// handleNewSessionDialogClose
 
 
+/*!
+Ends every process in the warm shell pool and schedules new
+ones to be started.  This is used when the preferences that
+determine how the processes are started have changed.
+
+(2021.06)
+*/
+void
+invalidateWarmShellPool ()
+{
+	for (auto& warmProcess : gWarmShellPool())
+	{
+		Local_DisposeWarmProcess(&warmProcess);
+	}
+	gWarmShellPool().clear();
+	scheduleWarmShellPoolFill(kMy_WarmShellFillDelayInNanoseconds);
+}// invalidateWarmShellPool
+
+
 /*!
 Returns the most appropriate workspace for a new terminal
 window.  If no workspaces exist, one is created; otherwise,
@@ -2167,6 +2517,28 @@ returnActiveWorkspace ()
 }// returnActiveWorkspace
 
 
+/*!
+Arranges for fillWarmShellPool() to be called on the main
+queue after the given delay, unless a call is already
+waiting.
+
+(2021.06)
+*/
+void
+scheduleWarmShellPoolFill	(int64_t	inDelayInNanoseconds)
+{
+	if (false == gWarmShellFillPending)
+	{
+		gWarmShellFillPending = true;
+		dispatch_after(dispatch_time(DISPATCH_TIME_NOW, inDelayInNanoseconds), dispatch_get_main_queue(),
+						^{
+							gWarmShellFillPending = false;
+							fillWarmShellPool();
+						});
+	}
+}// scheduleWarmShellPoolFill
+
+
 /*!
 Invoked whenever a monitored property of any session
 is changed.  This routine responds to changes by
@@ -2277,6 +2649,48 @@ sessionStateChanged		(ListenerModel_Ref		UNUSED_ARGUMENT(inUnusedModel),
 }// sessionStateChanged
 
 
+/*!
+Starts a new process for the given session, in the way that
+the user prefers: normally with Local_SpawnProcess(), but if
+local sessions are detachable, the session server runs it
+(see Local_SpawnDetachableProcess()).  If the server is not
+available, the process is started normally after all.
+
+(2021.06)
+*/
+Local_Result
+spawnLocalProcess	(SessionRef				inSession,
+					 TerminalScreenRef		inScreen,
+					 CFArrayRef				inArgumentArray,
+					 CFStringRef			inWorkingDirectoryOrNull)
+{
+	Boolean			isDetachable = false;
+	Local_Result	result = kLocal_ResultOK;
+	
+	
+	if (kPreferences_ResultOK != Preferences_GetData(kPreferences_TagLocalSessionsDetachable, sizeof(isDetachable), &isDetachable))
+	{
+		isDetachable = false;
+	}
+	
+	if (isDetachable)
+	{
+		result = Local_SpawnDetachableProcess(inSession, inScreen, inArgumentArray, inWorkingDirectoryOrNull);
+		if (kLocal_ResultSocketError == result)
+		{
+			Console_Warning(Console_WriteLine, "session server is not available; starting a process that cannot detach");
+		}
+	}
+	
+	if ((false == isDetachable) || (kLocal_ResultSocketError == result))
+	{
+		result = Local_SpawnProcess(inSession, inScreen, inArgumentArray, inWorkingDirectoryOrNull);
+	}
+	
+	return result;
+}// spawnLocalProcess
+
+
 /*!
 Invoke this routine from every factory method, to
 start tracking the new SessionRef in this module.
@@ -2443,6 +2857,71 @@ stopTrackingTerminalWindow		(TerminalWindowRef		inTerminalWindow)
 	assert(targetList.end() == std::find(targetList.begin(), targetList.end(), inTerminalWindow));
 }// stopTrackingTerminalWindow
 
+
+/*!
+Removes and returns a process from the warm shell pool that is
+running the given command line, in the given directory, for the
+given terminal name; or, returns nullptr if there is no such
+process.  A replacement process is scheduled so that the pool
+is full again for the next new session.
+
+(2021.06)
+*/
+Local_WarmProcessRef
+takeWarmShell	(CFArrayRef		inArgumentArray,
+				 CFStringRef	inWorkingDirectoryOrNull,
+				 CFStringRef	inTerminalName)
+{
+	Local_WarmProcessRef	result = nullptr;
+	
+	
+	for (auto warmProcessIterator = gWarmShellPool().begin(); warmProcessIterator != gWarmShellPool().end(); ++warmProcessIterator)
+	{
+		if (Local_WarmProcessIsCompatible(*warmProcessIterator, inArgumentArray, inWorkingDirectoryOrNull, inTerminalName) &&
+			Local_WarmProcessIsRunning(*warmProcessIterator))
+		{
+			result = *warmProcessIterator;
+			gWarmShellPool().erase(warmProcessIterator);
+			break;
+		}
+	}
+	
+	if (nullptr != result)
+	{
+		// wait a moment so that the new session can be set up first
+		scheduleWarmShellPoolFill(kMy_WarmShellFillDelayInNanoseconds);
+	}
+	
+	return result;
+}// takeWarmShell
+
+
+/*!
+Invoked whenever a preference that affects the warm shell
+pool is changed.  The pool is restarted so that new sessions
+never use a process that was started in the wrong way.
+
+(2021.06)
+*/
+void
+warmShellPreferenceChanged	(ListenerModel_Ref		UNUSED_ARGUMENT(inUnusedModel),
+							 ListenerModel_Event	inPreferenceTagThatChanged,
+							 void*					UNUSED_ARGUMENT(inPreferencesContext),
+							 void*					UNUSED_ARGUMENT(inListenerContextPtr))
+{
+	switch (inPreferenceTagThatChanged)
+	{
+	case kPreferences_TagWarmShellCount:
+		// the current processes are still valid; only the number changes
+		scheduleWarmShellPoolFill(0);
+		break;
+	
+	default:
+		invalidateWarmShellPool();
+		break;
+	}
+}// warmShellPreferenceChanged
+
 } // anonymous namespace
 
 
@@ -0,0 +1,2762 @@
+/*!	\file SessionServer.cp
+	\brief Keeps local sessions running in a separate process
+	so that windows can close and reattach later.
+*/
+/*###############################################################
+
+	MacTerm
+		© 1998-2021 by Kevin Grant.
+		© 2001-2003 by Ian Anderson.
+		© 1986-1994 University of Illinois Board of Trustees
+		(see About box for full list of U of I contributors).
+	
+	This program is free software; you can redistribute it or
+	modify it under the terms of the GNU General Public License
+	as published by the Free Software Foundation; either version
+	2 of the License, or (at your option) any later version.
+	
+	This program is distributed in the hope that it will be
+	useful, but WITHOUT ANY WARRANTY; without even the implied
+	warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+	PURPOSE.  See the GNU General Public License for more
+	details.
+	
+	You should have received a copy of the GNU General Public
+	License along with this program; if not, write to:
+	
+		Free Software Foundation, Inc.
+		59 Temple Place, Suite 330
+		Boston, MA  02111-1307
+		USA
+
+###############################################################*/
+
+#include "SessionServer.h"
+#include <UniversalDefines.h>
+
+// standard-C includes
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// standard-C++ includes
+#include <algorithm>
+#include <chrono>
+#include <list>
+#include <map>
+#include <memory>
+#include <set>
+#include <thread>
+
+// UNIX includes
+extern "C"
+{
+#	include <fcntl.h>
+#	include <poll.h>
+#	include <signal.h>
+#	include <termios.h>
+#	include <unistd.h>
+#	include <sys/ioctl.h>
+#	include <sys/socket.h>
+#	include <sys/stat.h>
+#	include <sys/uio.h>
+#	include <sys/un.h>
+#	include <sys/wait.h>
+}
+
+// library includes
+#include <Console.h>
+#include <ProcessSpawn.h>
+
+
+
+#pragma mark Constants
+namespace {
+
+UInt32 const	kMy_ProtocolVersion = 2;						//!< sent by clients when they connect; must match the server
+UInt32 const	kMy_MaximumPayloadSize = 1024 * 1024 * 1024;	//!< larger messages are considered corrupt
+size_t const	kMy_MaximumPendingWriteSize = 64 * 1024 * 1024;	//!< clients that fall further behind are disconnected
+size_t const	kMy_MaximumOutputBacklog = 256 * 1024;			//!< a terminal is not read while an attachment has more output than this waiting
+size_t const	kMy_ReplaySize = 2 * 1024 * 1024;				//!< at least this much of the most recent output of a session is kept (at most twice this)
+size_t const	kMy_InputPieceSize = 256;						//!< most bytes written to a terminal at a time (see writeSessionInput())
+size_t const	kMy_ReadSize = 65536;							//!< bytes read from a terminal or socket at a time
+size_t const	kMy_MaximumPassedFDs = 4;						//!< most file descriptors that a client accepts with one read
+int const		kMy_ExitPollMilliseconds = 50;					//!< how often to check for exits that are expected soon
+
+#ifndef MSG_NOSIGNAL
+#	define MSG_NOSIGNAL 0 // SO_NOSIGPIPE is used instead (see setSocketOptions())
+#endif
+
+/*!
+Types of messages.  Each request from a client is answered
+by exactly one "kMy_MessageOK", "kMy_MessageFailed",
+"kMy_MessageAttachment" or "kMy_MessageSessionList" message,
+except for input, resize and detach requests, which are
+never answered.  Once an attachment has been sent, nothing
+else is sent on that connection except the raw output of
+the session, and a detach is the only request accepted.
+*/
+enum My_MessageType : FourCharCode
+{
+	kMy_MessageHello		= 'helo',	//!< client → server: protocol version
+	kMy_MessageCreate		= 'crea',	//!< client → server: size, directory, terminal settings, arguments, environment
+	kMy_MessageList			= 'list',	//!< client → server: no payload
+	kMy_MessageAttach		= 'atch',	//!< client → server: no payload
+	kMy_MessageDetach		= 'dtch',	//!< client → server, on an attached connection: output offset and saved state
+	kMy_MessageKill			= 'kill',	//!< client → server: no payload
+	kMy_MessageInput		= 'inpt',	//!< client → server: bytes for the terminal
+	kMy_MessageResize		= 'rsiz',	//!< client → server: column and row counts
+	kMy_MessageOK			= 'okay',	//!< server → client: request succeeded (for a new session, the header has its ID)
+	kMy_MessageFailed		= 'fail',	//!< server → client: SessionServer_Result
+	kMy_MessageAttachment	= 'attd',	//!< server → client: a SessionServer_Attachment (with the terminal device, if any)
+	kMy_MessageSessionList	= 'sess',	//!< server → client: count and then session descriptions
+};
+
+} // anonymous namespace
+
+#pragma mark Types
+namespace {
+
+/*!
+Precedes every message.  Since both ends are always on the
+same computer, values are in the byte order of the computer.
+*/
+struct My_MessageHeader
+{
+	FourCharCode				messageType;	//!< a "My_MessageType" value
+	SessionServer_SessionID		sessionID;		//!< session that the message is about, if any
+	UInt32						payloadSize;	//!< number of bytes that follow the header
+};
+
+/*!
+The server side of a connection from a client.  Once the
+client attaches to a session, the connection carries only
+the output of that session.
+*/
+struct My_Connection
+{
+	My_Connection	(int);
+	~My_Connection	();
+	
+	int							socketFD;			//!< nonblocking socket
+	std::string					readBuffer;			//!< bytes received that do not yet form a complete message
+	std::string					writeBuffer;		//!< bytes not yet sent, starting at "writeOffset"
+	size_t						writeOffset;		//!< bytes of "writeBuffer" that have been sent
+	int							passedFD;			//!< file descriptor to send with the byte at "passedFDOffset"; -1 if none
+	size_t						passedFDOffset;		//!< position in "writeBuffer" of the message that carries "passedFD"
+	SessionServer_SessionID		outputSessionID;	//!< session whose output the connection carries, if any
+	Boolean						isIdentified;		//!< true once a compatible protocol version has been given
+	Boolean						isClosing;			//!< true if the connection should be closed as soon as possible
+	Boolean						isFinishing;		//!< true if the connection should be closed once everything is sent
+};
+typedef My_Connection*		My_ConnectionPtr;
+
+/*!
+A process with its own pseudo-terminal, and its most recent
+output.  Offsets count every byte of output since the
+process started.
+*/
+struct My_Session
+{
+	My_Session	(SessionServer_SessionID, ProcessSpawn_Process const&, UInt16, UInt16, std::string const&);
+	
+	UInt64
+	returnOutputByteCount () const
+	{
+		return (this->recentOutputOffset + this->recentOutput.size());
+	}
+	
+	SessionServer_SessionID			sessionID;				//!< unique for the life of the server
+	pid_t							processID;				//!< spawned process (also its process group)
+	int								masterFD;				//!< pseudo-terminal master; -1 after all output has been read
+	std::string						deviceName;				//!< name of the pseudo-terminal device
+	std::string						commandLine;			//!< for session lists
+	UInt16							columnCount;			//!< most recent width of the terminal
+	UInt16							rowCount;				//!< most recent height of the terminal
+	std::string						recentOutput;			//!< the most recent output (see "kMy_ReplaySize")
+	UInt64							recentOutputOffset;		//!< offset of the first byte of "recentOutput"
+	std::string						savedState;				//!< opaque state from the client that detached most recently
+	UInt64							savedStateOffset;		//!< offset of the first byte of output that "savedState" does not include
+	std::string						pendingInput;			//!< bytes not yet written to the terminal
+	std::set< My_ConnectionPtr >	attachedConnections;	//!< connections that receive the output
+	SInt32							exitStatus;				//!< valid only when "isReaped" is true
+	Boolean							isReaped;				//!< true once the exit status has been collected
+};
+typedef std::unique_ptr< My_Session >	My_SessionPtr;
+
+typedef std::map< SessionServer_SessionID, My_SessionPtr >	My_SessionByID;
+
+/*!
+Internal representation of a SessionServer_Ref.
+*/
+struct My_Server
+{
+	My_Server	(char const*);
+	~My_Server	();
+	
+	std::string									socketPath;			//!< where the server listens
+	int											listenFD;			//!< nonblocking listening socket
+	int											stopPipe[2];		//!< written by SessionServer_Stop() to interrupt the loop
+	My_SessionByID								sessions;			//!< every session that has not been killed
+	std::list< std::unique_ptr< My_Connection > >	connections;	//!< every connected client
+	std::set< pid_t >							killedProcessIDs;	//!< processes of killed sessions that have not exited yet
+	SessionServer_SessionID						nextSessionID;		//!< ID of the next new session
+};
+typedef My_Server*		My_ServerPtr;
+
+/*!
+Internal representation of a SessionServer_ClientRef.
+*/
+struct My_Client
+{
+	My_Client	(char const*, int);
+	~My_Client	();
+	
+	std::string				socketPath;		//!< where the server listens (for attachments, which need new connections)
+	int						socketFD;		//!< blocking socket
+	std::string				readBuffer;		//!< bytes received that do not yet form a complete message
+	std::vector< int >		receivedFDs;	//!< file descriptors that arrived with messages and have not been claimed
+};
+typedef My_Client*		My_ClientPtr;
+
+} // anonymous namespace
+
+#pragma mark Internal Method Prototypes
+namespace {
+
+void					acceptConnections		(My_ServerPtr);
+template < typename value_type >
+void					appendValue				(std::string&, value_type);
+void					appendString			(std::string&, std::string const&);
+void					closeSessionOutput		(My_Session&);
+void					handleMessage			(My_ServerPtr, My_ConnectionPtr, My_MessageHeader const&, UInt8 const*);
+void					killSession				(My_ServerPtr, My_Session&);
+Boolean					makeSocketAddress		(char const*, struct sockaddr_un&);
+void					queueMessage			(My_ConnectionPtr, FourCharCode, SessionServer_SessionID,
+												 void const* = nullptr, size_t = 0, int = -1);
+void					readConnection			(My_ServerPtr, My_ConnectionPtr);
+void					readSessionOutput		(My_Session&);
+template < typename value_type >
+Boolean					readValue				(UInt8 const*&, UInt8 const*, value_type&);
+Boolean					readString				(UInt8 const*&, UInt8 const*, std::string&);
+void					reapProcesses			(My_ServerPtr);
+SessionServer_Result	receiveMessage			(My_ClientPtr, My_MessageHeader&, std::string&);
+SessionServer_Result	resultOfReply			(My_MessageHeader const&, std::string const&, FourCharCode);
+SessionServer_Result	sendMessage				(int, FourCharCode, SessionServer_SessionID, void const* = nullptr, size_t = 0);
+SessionServer_Result	sendRequest				(My_ClientPtr, FourCharCode, SessionServer_SessionID,
+												 std::string const&, My_MessageHeader&, std::string&);
+void					setSocketOptions		(int, Boolean);
+SessionServer_Result	spawnSession			(My_ServerPtr, std::vector< std::string > const&, std::vector< std::string > const&,
+												 std::string const&, struct termios const*, UInt16, UInt16, SessionServer_SessionID&);
+Boolean					unitTest000_Begin		(char const*);
+Boolean					unitTest001_Begin		(char const*);
+Boolean					unitTest002_Begin		(char const*);
+Boolean					unitTest003_Begin		(char const*);
+Boolean					waitForExit				(SessionServer_ClientRef, SessionServer_SessionID, SessionServer_SessionInfo&);
+Boolean					waitForOutput			(int, std::string&, char const*);
+void					writeConnection			(My_ConnectionPtr);
+void					writeSessionInput		(My_Session&);
+
+} // anonymous namespace
+
+
+
+#pragma mark Public Methods
+
+/*!
+A unit test for this module.  This should always
+be run before a release, after any substantial
+changes are made, or if you suspect bugs!  It
+should also be EXPANDED as new functionality is
+proposed (ideally, a test is written before the
+functionality is added).
+
+This runs a server on another thread, with a socket
+in a new temporary directory, and spawns processes.
+
+(2021.06)
+*/
+void
+SessionServer_RunTests ()
+{
+	UInt16		totalTests = 0;
+	UInt16		failedTests = 0;
+	char		directoryPath[] = "/tmp/MacTermTest.XXXXXX";
+	
+	
+	if (nullptr == mkdtemp(directoryPath))
+	{
+		Console_Warning(Console_WriteValue, "unable to create temporary directory for session server tests, errno", errno);
+		++totalTests;
+		++failedTests;
+	}
+	else
+	{
+		std::string const		kSocketPath = std::string(directoryPath) + "/Sessions.socket";
+		SessionServer_Result	serverResult = kSessionServer_ResultOK;
+		SessionServer_Ref		server = SessionServer_New(kSocketPath.c_str(), serverResult);
+		
+		
+		if (nullptr == server)
+		{
+			Console_Warning(Console_WriteValue, "unable to create server for session server tests, result", serverResult);
+			++totalTests;
+			++failedTests;
+		}
+		else
+		{
+			std::thread		serverThread([server]() { UNUSED_RETURN(SessionServer_Result)SessionServer_Run(server); });
+			
+			
+			++totalTests; if (false == unitTest000_Begin(kSocketPath.c_str())) ++failedTests;
+			++totalTests; if (false == unitTest001_Begin(kSocketPath.c_str())) ++failedTests;
+			++totalTests; if (false == unitTest002_Begin(kSocketPath.c_str())) ++failedTests;
+			++totalTests; if (false == unitTest003_Begin(kSocketPath.c_str())) ++failedTests;
+			
+			SessionServer_Stop(server);
+			serverThread.join();
+			SessionServer_Dispose(&server);
+		}
+		UNUSED_RETURN(int)rmdir(directoryPath);
+	}
+	
+	Console_WriteUnitTestReport("Session Server", failedTests, totalTests);
+}// RunTests
+
+
+/*!
+Attaches to a session: a new connection to the server is
+opened, which from then on carries only the output of the
+session.  The attachment has the state that was saved by
+the client that detached most recently, and the output that
+the state does not include; the output that is read from
+the new connection follows on from that with no gap.  The
+client also receives its own copy of the pseudo-terminal
+device, unless the process has exited (in which case the
+output ends after the replay).
+
+A session can have more than one attachment (for instance,
+in two windows), and they all receive the same output.  An
+attachment ends when SessionServer_DetachOutput() is called
+for it, or when the client closes the output socket.
+
+(2021.06)
+*/
+SessionServer_Result
+SessionServer_ClientAttach		(SessionServer_ClientRef		inClient,
+								 SessionServer_SessionID		inSessionID,
+								 SessionServer_Attachment&		outAttachment)
+{
+	My_ClientPtr			ptr = REINTERPRET_CAST(inClient, My_ClientPtr);
+	SessionServer_Result	result = kSessionServer_ResultOK;
+	
+	
+	outAttachment = SessionServer_Attachment();
+	if (nullptr == ptr) result = kSessionServer_ResultParameterError;
+	else
+	{
+		SessionServer_ClientRef		outputClient = SessionServer_NewClient(ptr->socketPath.c_str(), result);
+		
+		
+		if (nullptr != outputClient)
+		{
+			My_ClientPtr		outputClientPtr = REINTERPRET_CAST(outputClient, My_ClientPtr);
+			My_MessageHeader	replyHeader;
+			std::string			replyPayload;
+			
+			
+			result = sendRequest(outputClientPtr, kMy_MessageAttach, inSessionID, std::string(), replyHeader, replyPayload);
+			if (kSessionServer_ResultOK == result)
+			{
+				result = resultOfReply(replyHeader, replyPayload, kMy_MessageAttachment);
+			}
+			if (kSessionServer_ResultOK == result)
+			{
+				UInt8 const*	bytePtr = REINTERPRET_CAST(replyPayload.data(), UInt8 const*);
+				UInt8 const*	endPtr = bytePtr + replyPayload.size();
+				SInt32			processID = 0;
+				UInt8			isReplayComplete = 0;
+				UInt8			hasTerminal = 0;
+				Boolean			isValid = (readValue(bytePtr, endPtr, processID) &&
+											readValue(bytePtr, endPtr, outAttachment.outputOffset) &&
+											readValue(bytePtr, endPtr, isReplayComplete) &&
+											readValue(bytePtr, endPtr, hasTerminal) &&
+											readString(bytePtr, endPtr, outAttachment.deviceName) &&
+											readString(bytePtr, endPtr, outAttachment.savedState) &&
+											readString(bytePtr, endPtr, outAttachment.replayedOutput));
+				
+				
+				if ((false == isValid) || ((0 != hasTerminal) && outputClientPtr->receivedFDs.empty()))
+				{
+					result = kSessionServer_ResultProtocolError;
+				}
+				else
+				{
+					outAttachment.processID = STATIC_CAST(processID, pid_t);
+					outAttachment.isReplayComplete = (0 != isReplayComplete);
+					if (0 != hasTerminal)
+					{
+						outAttachment.terminalFD = outputClientPtr->receivedFDs.front();
+						outputClientPtr->receivedFDs.erase(outputClientPtr->receivedFDs.begin());
+					}
+					
+					// output that was read along with the reply comes before
+					// anything that can still be read from the socket
+					outAttachment.replayedOutput += outputClientPtr->readBuffer;
+					outAttachment.outputOffset += outputClientPtr->readBuffer.size();
+					outputClientPtr->readBuffer.clear();
+					outAttachment.outputFD = outputClientPtr->socketFD;
+					outputClientPtr->socketFD = -1; // now belongs to the attachment
+				}
+			}
+			SessionServer_DisposeClient(&outputClient);
+		}
+	}
+	return result;
+}// ClientAttach
+
+
+/*!
+Spawns a new process on a pseudo-terminal of the given size
+(see ProcessSpawn_InPseudoTerminal()).  The first argument
+is the program, which is found using the "PATH" of the
+server if it is not a full path.  Environment settings have
+the form "NAME=value" and are added to the environment of
+the server.  If terminal settings are given, the device
+starts with them.
+
+The new session is not attached.
+
+(2021.06)
+*/
+SessionServer_Result
+SessionServer_ClientCreateSession	(SessionServer_ClientRef			inClient,
+									 std::vector< std::string > const&	inArguments,
+									 std::vector< std::string > const&	inEnvironmentSettings,
+									 char const*						inWorkingDirectoryOrNull,
+									 struct termios const*				inTerminalControlOrNull,
+									 UInt16								inColumnCount,
+									 UInt16								inRowCount,
+									 SessionServer_SessionID&			outSessionID)
+{
+	My_ClientPtr			ptr = REINTERPRET_CAST(inClient, My_ClientPtr);
+	SessionServer_Result	result = kSessionServer_ResultOK;
+	
+	
+	outSessionID = kSessionServer_InvalidSessionID;
+	if ((nullptr == ptr) || inArguments.empty()) result = kSessionServer_ResultParameterError;
+	else
+	{
+		My_MessageHeader	replyHeader;
+		std::string			payload;
+		std::string			replyPayload;
+		
+		
+		appendValue(payload, inColumnCount);
+		appendValue(payload, inRowCount);
+		appendString(payload, (nullptr != inWorkingDirectoryOrNull) ? std::string(inWorkingDirectoryOrNull) : std::string());
+		appendValue(payload, STATIC_CAST((nullptr != inTerminalControlOrNull) ? 1 : 0, UInt8));
+		if (nullptr != inTerminalControlOrNull)
+		{
+			appendValue(payload, *inTerminalControlOrNull);
+		}
+		appendValue(payload, STATIC_CAST(inArguments.size(), UInt32));
+		for (auto const&	argument : inArguments)
+		{
+			appendString(payload, argument);
+		}
+		appendValue(payload, STATIC_CAST(inEnvironmentSettings.size(), UInt32));
+		for (auto const&	setting : inEnvironmentSettings)
+		{
+			appendString(payload, setting);
+		}
+		
+		result = sendRequest(ptr, kMy_MessageCreate, kSessionServer_InvalidSessionID, payload, replyHeader, replyPayload);
+		if (kSessionServer_ResultOK == result)
+		{
+			result = resultOfReply(replyHeader, replyPayload, kMy_MessageOK);
+			if (kSessionServer_ResultOK == result)
+			{
+				outSessionID = replyHeader.sessionID;
+			}
+		}
+	}
+	return result;
+}// ClientCreateSession
+
+
+/*!
+Terminates a session: its process receives a hang-up signal
+(as it would if a window were closed) and the session is
+removed from the server.  The output of every attachment
+ends.
+
+(2021.06)
+*/
+SessionServer_Result
+SessionServer_ClientKillSession		(SessionServer_ClientRef	inClient,
+									 SessionServer_SessionID	inSessionID)
+{
+	My_ClientPtr			ptr = REINTERPRET_CAST(inClient, My_ClientPtr);
+	SessionServer_Result	result = kSessionServer_ResultOK;
+	
+	
+	if (nullptr == ptr) result = kSessionServer_ResultParameterError;
+	else
+	{
+		My_MessageHeader	replyHeader;
+		std::string			replyPayload;
+		
+		
+		result = sendRequest(ptr, kMy_MessageKill, inSessionID, std::string(), replyHeader, replyPayload);
+		if (kSessionServer_ResultOK == result)
+		{
+			result = resultOfReply(replyHeader, replyPayload, kMy_MessageOK);
+		}
+	}
+	return result;
+}// ClientKillSession
+
+
+/*!
+Returns every session of the server, in the order that
+they were created.
+
+(2021.06)
+*/
+SessionServer_Result
+SessionServer_ClientListSessions	(SessionServer_ClientRef					inClient,
+									 std::vector< SessionServer_SessionInfo >&	outSessions)
+{
+	My_ClientPtr			ptr = REINTERPRET_CAST(inClient, My_ClientPtr);
+	SessionServer_Result	result = kSessionServer_ResultOK;
+	
+	
+	outSessions.clear();
+	if (nullptr == ptr) result = kSessionServer_ResultParameterError;
+	else
+	{
+		My_MessageHeader	replyHeader;
+		std::string			replyPayload;
+		
+		
+		result = sendRequest(ptr, kMy_MessageList, kSessionServer_InvalidSessionID, std::string(), replyHeader, replyPayload);
+		if (kSessionServer_ResultOK == result)
+		{
+			result = resultOfReply(replyHeader, replyPayload, kMy_MessageSessionList);
+		}
+		if (kSessionServer_ResultOK == result)
+		{
+			UInt8 const*	bytePtr = REINTERPRET_CAST(replyPayload.data(), UInt8 const*);
+			UInt8 const*	endPtr = bytePtr + replyPayload.size();
+			UInt32			sessionCount = 0;
+			Boolean			isValid = readValue(bytePtr, endPtr, sessionCount);
+			
+			
+			for (UInt32 i = 0; (isValid && (i < sessionCount)); ++i)
+			{
+				SessionServer_SessionInfo	info;
+				SInt32						processID = 0;
+				UInt8						isRunning = 0;
+				
+				
+				isValid = (readValue(bytePtr, endPtr, info.sessionID) &&
+							readValue(bytePtr, endPtr, processID) &&
+							readValue(bytePtr, endPtr, info.columnCount) &&
+							readValue(bytePtr, endPtr, info.rowCount) &&
+							readValue(bytePtr, endPtr, isRunning) &&
+							readValue(bytePtr, endPtr, info.exitStatus) &&
+							readValue(bytePtr, endPtr, info.attachedClientCount) &&
+							readString(bytePtr, endPtr, info.commandLine));
+				info.processID = STATIC_CAST(processID, pid_t);
+				info.isRunning = (0 != isRunning);
+				if (isValid)
+				{
+					outSessions.push_back(info);
+				}
+			}
+			unless (isValid)
+			{
+				result = kSessionServer_ResultProtocolError;
+			}
+		}
+	}
+	return result;
+}// ClientListSessions
+
+
+/*!
+Changes the size of the terminal of a session, which also
+notifies its process.  This does not wait for a reply.
+(An attached client can also resize its copy of the
+device directly.)
+
+(2021.06)
+*/
+SessionServer_Result
+SessionServer_ClientResize		(SessionServer_ClientRef	inClient,
+								 SessionServer_SessionID	inSessionID,
+								 UInt16						inColumnCount,
+								 UInt16						inRowCount)
+{
+	My_ClientPtr			ptr = REINTERPRET_CAST(inClient, My_ClientPtr);
+	SessionServer_Result	result = kSessionServer_ResultOK;
+	
+	
+	if (nullptr == ptr) result = kSessionServer_ResultParameterError;
+	else
+	{
+		UInt16 const	kSize[] = { inColumnCount, inRowCount };
+		
+		
+		result = sendMessage(ptr->socketFD, kMy_MessageResize, inSessionID, kSize, sizeof(kSize));
+	}
+	return result;
+}// ClientResize
+
+
+/*!
+Sends bytes to the terminal of a session, as if they were
+typed.  This does not wait for a reply.  (An attached client
+can also write to its copy of the device directly.)
+
+(2021.06)
+*/
+SessionServer_Result
+SessionServer_ClientWriteInput	(SessionServer_ClientRef	inClient,
+								 SessionServer_SessionID	inSessionID,
+								 void const*				inBytes,
+								 size_t						inByteCount)
+{
+	My_ClientPtr			ptr = REINTERPRET_CAST(inClient, My_ClientPtr);
+	SessionServer_Result	result = kSessionServer_ResultOK;
+	
+	
+	if ((nullptr == ptr) || (nullptr == inBytes) || (inByteCount > kMy_MaximumPayloadSize)) result = kSessionServer_ResultParameterError;
+	else
+	{
+		result = sendMessage(ptr->socketFD, kMy_MessageInput, inSessionID, inBytes, inByteCount);
+	}
+	return result;
+}// ClientWriteInput
+
+
+/*!
+Ends an attachment (see SessionServer_ClientAttach()), and
+gives the server a copy of the state of the client, for the
+next client that attaches.  The offset is the number of
+bytes of output that the state includes; it may be less
+than the number of bytes that were read from the output
+socket, because output that was read but not processed is
+simply replayed to the next client.
+
+The server stops sending output and closes its end of the
+socket soon after, so a thread that is reading the socket
+reaches the end of the output.  The caller must still close
+both file descriptors of the attachment.
+
+(2021.06)
+*/
+SessionServer_Result
+SessionServer_DetachOutput	(int					inOutputFD,
+							 UInt64					inOutputOffset,
+							 std::string const&		inSavedState)
+{
+	SessionServer_Result	result = kSessionServer_ResultOK;
+	
+	
+	if ((inOutputFD < 0) || (inSavedState.size() > (kMy_MaximumPayloadSize - sizeof(inOutputOffset) - sizeof(UInt32))))
+	{
+		result = kSessionServer_ResultParameterError;
+	}
+	else
+	{
+		std::string		payload;
+		
+		
+		appendValue(payload, inOutputOffset);
+		appendString(payload, inSavedState);
+		result = sendMessage(inOutputFD, kMy_MessageDetach, kSessionServer_InvalidSessionID, payload.data(), payload.size());
+	}
+	return result;
+}// DetachOutput
+
+
+/*!
+Destroys a server that is not running, and kills any of its
+sessions that have not been killed already.
+
+(2021.06)
+*/
+void
+SessionServer_Dispose	(SessionServer_Ref*		inoutRefPtr)
+{
+	if (nullptr != inoutRefPtr)
+	{
+		delete REINTERPRET_CAST(*inoutRefPtr, My_ServerPtr);
+		*inoutRefPtr = nullptr;
+	}
+}// Dispose
+
+
+/*!
+Closes a connection to a server.  Attachments have their
+own connections, so they are not affected.
+
+(2021.06)
+*/
+void
+SessionServer_DisposeClient		(SessionServer_ClientRef*	inoutRefPtr)
+{
+	if (nullptr != inoutRefPtr)
+	{
+		delete REINTERPRET_CAST(*inoutRefPtr, My_ClientPtr);
+		*inoutRefPtr = nullptr;
+	}
+}// DisposeClient
+
+
+
+/*!
+Creates a server that listens on the given socket path; use
+SessionServer_Run() to start handling clients.  If another
+server is already listening at the same path, this fails
+with "kSessionServer_ResultServerAlreadyRunning"; but a socket
+file that was left by a server that crashed is replaced.
+
+If the directory of the socket does not exist, it is created
+so that only the current user can access it.
+
+(2021.06)
+*/
+SessionServer_Ref
+SessionServer_New	(char const*			inSocketPath,
+					 SessionServer_Result&	outResult)
+{
+	SessionServer_Ref	result = nullptr;
+	struct sockaddr_un	address;
+	
+	
+	outResult = kSessionServer_ResultOK;
+	if ((nullptr == inSocketPath) || (false == makeSocketAddress(inSocketPath, address)))
+	{
+		outResult = kSessionServer_ResultParameterError;
+	}
+	else
+	{
+		std::unique_ptr< My_Server >	serverPtr(new My_Server(inSocketPath));
+		std::string const				kDirectory = serverPtr->socketPath.substr(0, serverPtr->socketPath.rfind('/'));
+		int								bindResult = -1;
+		
+		
+		if (false == kDirectory.empty())
+		{
+			UNUSED_RETURN(int)mkdir(kDirectory.c_str(), 0700);
+		}
+		
+		serverPtr->listenFD = socket(AF_UNIX, SOCK_STREAM, 0);
+		if (serverPtr->listenFD >= 0)
+		{
+			bindResult = bind(serverPtr->listenFD, REINTERPRET_CAST(&address, struct sockaddr*), sizeof(address));
+			if ((0 != bindResult) && (EADDRINUSE == errno))
+			{
+				// if nothing answers, the socket was left by a server that exited
+				// without cleaning up, and can be replaced
+				int		probeFD = socket(AF_UNIX, SOCK_STREAM, 0);
+				
+				
+				if (probeFD >= 0)
+				{
+					if (0 == connect(probeFD, REINTERPRET_CAST(&address, struct sockaddr*), sizeof(address)))
+					{
+						outResult = kSessionServer_ResultServerAlreadyRunning;
+					}
+					else
+					{
+						UNUSED_RETURN(int)unlink(inSocketPath);
+						bindResult = bind(serverPtr->listenFD, REINTERPRET_CAST(&address, struct sockaddr*), sizeof(address));
+					}
+					UNUSED_RETURN(int)close(probeFD);
+				}
+			}
+		}
+		
+		if (kSessionServer_ResultOK == outResult)
+		{
+			if ((0 != bindResult) || (0 != listen(serverPtr->listenFD, 16/* backlog */)) || (0 != pipe(serverPtr->stopPipe)))
+			{
+				Console_Warning(Console_WriteValue, "session server unable to listen on socket, errno", errno);
+				outResult = kSessionServer_ResultSocketError;
+			}
+			else
+			{
+				UNUSED_RETURN(int)chmod(inSocketPath, 0600);
+				setSocketOptions(serverPtr->listenFD, true/* nonblocking */);
+				setSocketOptions(serverPtr->stopPipe[0], true/* nonblocking */);
+				setSocketOptions(serverPtr->stopPipe[1], true/* nonblocking */);
+				result = REINTERPRET_CAST(serverPtr.release(), SessionServer_Ref);
+			}
+		}
+		
+		if ((nullptr == result) && (0 == bindResult))
+		{
+			// the socket file belongs to this server; remove it
+			UNUSED_RETURN(int)unlink(inSocketPath);
+		}
+	}
+	return result;
+}// New
+
+
+/*!
+Connects to the server that is listening on the given
+socket path.  Returns nullptr if there is no server, or if
+it does not use the same protocol version.
+
+(2021.06)
+*/
+SessionServer_ClientRef
+SessionServer_NewClient		(char const*			inSocketPath,
+							 SessionServer_Result&	outResult)
+{
+	SessionServer_ClientRef		result = nullptr;
+	struct sockaddr_un			address;
+	
+	
+	outResult = kSessionServer_ResultOK;
+	if ((nullptr == inSocketPath) || (false == makeSocketAddress(inSocketPath, address)))
+	{
+		outResult = kSessionServer_ResultParameterError;
+	}
+	else
+	{
+		std::unique_ptr< My_Client >	clientPtr(new My_Client(inSocketPath, socket(AF_UNIX, SOCK_STREAM, 0)));
+		
+		
+		if ((clientPtr->socketFD < 0) ||
+			(0 != connect(clientPtr->socketFD, REINTERPRET_CAST(&address, struct sockaddr*), sizeof(address))))
+		{
+			outResult = kSessionServer_ResultSocketError;
+		}
+		else
+		{
+			My_MessageHeader	replyHeader;
+			std::string			payload;
+			std::string			replyPayload;
+			
+			
+			setSocketOptions(clientPtr->socketFD, false/* nonblocking */);
+			appendValue(payload, kMy_ProtocolVersion);
+			outResult = sendRequest(clientPtr.get(), kMy_MessageHello, kSessionServer_InvalidSessionID, payload, replyHeader, replyPayload);
+			if (kSessionServer_ResultOK == outResult)
+			{
+				outResult = resultOfReply(replyHeader, replyPayload, kMy_MessageOK);
+			}
+			if (kSessionServer_ResultOK == outResult)
+			{
+				result = REINTERPRET_CAST(clientPtr.release(), SessionServer_ClientRef);
+			}
+		}
+	}
+	return result;
+}// NewClient
+
+
+/*!
+Returns the socket path that the application uses unless
+another is specified: a file in a directory that is private
+to the current user, in the temporary items folder.
+
+(2021.06)
+*/
+std::string
+SessionServer_ReturnDefaultSocketPath ()
+{
+	char const*		temporaryDirectory = getenv("TMPDIR");
+	std::string		result = ((nullptr != temporaryDirectory) && ('\0' != temporaryDirectory[0]))
+								? std::string(temporaryDirectory)
+								: std::string("/tmp");
+	
+	
+	if ('/' != result.back())
+	{
+		result += '/';
+	}
+	result += "MacTerm-";
+	result += std::to_string(getuid());
+	result += "/Sessions.socket";
+	return result;
+}// ReturnDefaultSocketPath
+
+
+/*!
+Handles clients and sessions until SessionServer_Stop() is
+called.  The sessions keep running after this returns, and
+SessionServer_Run() can be called again.
+
+(2021.06)
+*/
+SessionServer_Result
+SessionServer_Run	(SessionServer_Ref	inServer)
+{
+	My_ServerPtr			ptr = REINTERPRET_CAST(inServer, My_ServerPtr);
+	SessionServer_Result	result = kSessionServer_ResultOK;
+	
+	
+	if (nullptr == ptr) result = kSessionServer_ResultParameterError;
+	else
+	{
+		Boolean		isStopped = false;
+		
+		
+		while (false == isStopped)
+		{
+			std::vector< struct pollfd >			pollSet;
+			std::vector< SessionServer_SessionID >	polledSessionIDs;
+			std::vector< My_ConnectionPtr >			polledConnections;
+			int										timeout = -1;
+			int										pollResult = 0;
+			
+			
+			pollSet.push_back({ ptr->stopPipe[0], POLLIN, 0 });
+			pollSet.push_back({ ptr->listenFD, POLLIN, 0 });
+			for (auto const&	idSessionPair : ptr->sessions)
+			{
+				My_Session const&	session = *(idSessionPair.second);
+				
+				
+				if (session.masterFD >= 0)
+				{
+					short		events = (session.pendingInput.empty()) ? 0 : POLLOUT;
+					
+					
+					// output is not read while any attached client has too
+					// much waiting (in effect, the slowest window sets the
+					// pace, as it would if the window had spawned the process)
+					if (session.attachedConnections.end() ==
+						std::find_if(session.attachedConnections.begin(), session.attachedConnections.end(),
+										[](My_ConnectionPtr inConnectionPtr)
+										{
+											return ((inConnectionPtr->writeBuffer.size() - inConnectionPtr->writeOffset) > kMy_MaximumOutputBacklog);
+										}))
+					{
+						events |= POLLIN;
+					}
+					pollSet.push_back({ session.masterFD, events, 0 });
+					polledSessionIDs.push_back(session.sessionID);
+				}
+				else unless (session.isReaped)
+				{
+					// the terminal was closed so the process should exit soon,
+					// but the server is not notified when it does
+					timeout = kMy_ExitPollMilliseconds;
+				}
+			}
+			for (auto const&	connectionPtr : ptr->connections)
+			{
+				pollSet.push_back({ connectionPtr->socketFD, STATIC_CAST(POLLIN | ((connectionPtr->writeBuffer.empty()) ? 0 : POLLOUT), short), 0 });
+				polledConnections.push_back(connectionPtr.get());
+			}
+			unless (ptr->killedProcessIDs.empty())
+			{
+				timeout = kMy_ExitPollMilliseconds;
+			}
+			
+			pollResult = poll(pollSet.data(), STATIC_CAST(pollSet.size(), nfds_t), timeout);
+			if ((pollResult < 0) && (EINTR != errno))
+			{
+				Console_Warning(Console_WriteValue, "session server unable to poll, errno", errno);
+				result = kSessionServer_ResultSocketError;
+				isStopped = true;
+			}
+			else if (pollResult > 0)
+			{
+				size_t		pollIndex = 2;
+				
+				
+				if (0 != pollSet[0].revents)
+				{
+					char	stopBytes[16];
+					
+					
+					while (read(ptr->stopPipe[0], stopBytes, sizeof(stopBytes)) > 0)
+					{
+					}
+					isStopped = true;
+				}
+				if (0 != pollSet[1].revents)
+				{
+					acceptConnections(ptr);
+				}
+				
+				// sessions are handled before clients, since a client
+				// may kill a session
+				for (auto	sessionID : polledSessionIDs)
+				{
+					short const		kEvents = pollSet[pollIndex++].revents;
+					auto			toSession = ptr->sessions.find(sessionID);
+					
+					
+					if (ptr->sessions.end() != toSession)
+					{
+						if (0 != (kEvents & POLLOUT))
+						{
+							writeSessionInput(*(toSession->second));
+						}
+						if (0 != (kEvents & (POLLIN | POLLHUP | POLLERR)))
+						{
+							readSessionOutput(*(toSession->second));
+						}
+					}
+				}
+				for (auto	connectionPtr : polledConnections)
+				{
+					short const		kEvents = pollSet[pollIndex++].revents;
+					
+					
+					if (0 != (kEvents & POLLOUT))
+					{
+						writeConnection(connectionPtr);
+					}
+					if (0 != (kEvents & (POLLIN | POLLHUP | POLLERR)))
+					{
+						readConnection(ptr, connectionPtr);
+					}
+				}
+			}
+			reapProcesses(ptr);
+			
+			// close connections that failed or fell too far behind, and
+			// connections whose output has ended and has all been sent
+			for (auto toConnection = ptr->connections.begin(); toConnection != ptr->connections.end(); )
+			{
+				if ((*toConnection)->isClosing ||
+					((*toConnection)->isFinishing && ((*toConnection)->writeOffset == (*toConnection)->writeBuffer.size())))
+				{
+					My_ConnectionPtr	connectionPtr = toConnection->get();
+					
+					
+					writeConnection(connectionPtr); // send any final failure message
+					for (auto&	idSessionPair : ptr->sessions)
+					{
+						idSessionPair.second->attachedConnections.erase(connectionPtr);
+					}
+					toConnection = ptr->connections.erase(toConnection);
+				}
+				else
+				{
+					++toConnection;
+				}
+			}
+		}
+	}
+	return result;
+}// Run
+
+
+/*!
+Causes SessionServer_Run() to return soon.  This only writes
+to a pipe, so it can be called from a signal handler.
+
+(2021.06)
+*/
+void
+SessionServer_Stop	(SessionServer_Ref	inServer)
+{
+	My_ServerPtr	ptr = REINTERPRET_CAST(inServer, My_ServerPtr);
+	
+	
+	if (nullptr != ptr)
+	{
+		UInt8 const		kStopByte = 0;
+		
+		
+		UNUSED_RETURN(ssize_t)write(ptr->stopPipe[1], &kStopByte, sizeof(kStopByte));
+	}
+}// Stop
+
+
+
+
+#pragma mark Internal Methods
+namespace {
+
+/*!
+Initializes the server side of a connection.
+
+(2021.06)
+*/
+My_Connection::
+My_Connection	(int	inSocketFD)
+:
+socketFD(inSocketFD),
+readBuffer(),
+writeBuffer(),
+writeOffset(0),
+passedFD(-1),
+passedFDOffset(0),
+outputSessionID(kSessionServer_InvalidSessionID),
+isIdentified(false),
+isClosing(false),
+isFinishing(false)
+{
+}// My_Connection 1-argument constructor
+
+
+/*!
+Closes the socket, and any file descriptor that was not
+sent.
+
+(2021.06)
+*/
+My_Connection::
+~My_Connection ()
+{
+	if (this->passedFD >= 0)
+	{
+		UNUSED_RETURN(int)close(this->passedFD);
+	}
+	UNUSED_RETURN(int)close(this->socketFD);
+}// My_Connection destructor
+
+
+/*!
+Initializes a session for a process that was just spawned.
+
+(2021.06)
+*/
+My_Session::
+My_Session	(SessionServer_SessionID		inSessionID,
+			 ProcessSpawn_Process const&	inProcess,
+			 UInt16							inColumnCount,
+			 UInt16							inRowCount,
+			 std::string const&				inCommandLine)
+:
+sessionID(inSessionID),
+processID(inProcess.processID),
+masterFD(inProcess.masterFD),
+deviceName(inProcess.slaveDeviceName),
+commandLine(inCommandLine),
+columnCount(inColumnCount),
+rowCount(inRowCount),
+recentOutput(),
+recentOutputOffset(0),
+savedState(),
+savedStateOffset(0),
+pendingInput(),
+attachedConnections(),
+exitStatus(-1),
+isReaped(false)
+{
+}// My_Session 5-argument constructor
+
+
+/*!
+Initializes a server that is not yet listening.
+
+(2021.06)
+*/
+My_Server::
+My_Server	(char const*	inSocketPath)
+:
+socketPath(inSocketPath),
+listenFD(-1),
+stopPipe{ -1, -1 },
+sessions(),
+connections(),
+killedProcessIDs(),
+nextSessionID(1)
+{
+}// My_Server 1-argument constructor
+
+
+/*!
+Kills every session, stops listening and removes the
+socket file.
+
+(2021.06)
+*/
+My_Server::
+~My_Server ()
+{
+	// sessions refer to connections, so they are removed first
+	while (false == this->sessions.empty())
+	{
+		killSession(this, *(this->sessions.begin()->second));
+	}
+	this->connections.clear();
+	reapProcesses(this);
+	if (this->listenFD >= 0)
+	{
+		UNUSED_RETURN(int)close(this->listenFD);
+		UNUSED_RETURN(int)unlink(this->socketPath.c_str());
+	}
+	for (int	fd : this->stopPipe)
+	{
+		if (fd >= 0)
+		{
+			UNUSED_RETURN(int)close(fd);
+		}
+	}
+}// My_Server destructor
+
+
+/*!
+Initializes a client for a socket that is not yet
+connected.
+
+(2021.06)
+*/
+My_Client::
+My_Client	(char const*	inSocketPath,
+			 int			inSocketFD)
+:
+socketPath(inSocketPath),
+socketFD(inSocketFD),
+readBuffer(),
+receivedFDs()
+{
+}// My_Client 2-argument constructor
+
+
+/*!
+Closes the socket, and any file descriptors that were
+received but not claimed.
+
+(2021.06)
+*/
+My_Client::
+~My_Client ()
+{
+	if (this->socketFD >= 0)
+	{
+		UNUSED_RETURN(int)close(this->socketFD);
+	}
+	for (int	fd : this->receivedFDs)
+	{
+		UNUSED_RETURN(int)close(fd);
+	}
+}// My_Client destructor
+
+
+/*!
+Accepts every waiting connection.
+
+(2021.06)
+*/
+void
+acceptConnections	(My_ServerPtr	inServerPtr)
+{
+	int		socketFD = -1;
+	
+	
+	while ((socketFD = accept(inServerPtr->listenFD, nullptr, nullptr)) >= 0)
+	{
+		setSocketOptions(socketFD, true/* nonblocking */);
+		inServerPtr->connections.emplace_back(new My_Connection(socketFD));
+	}
+}// acceptConnections
+
+
+/*!
+Appends a string as a 32-bit length and then its bytes.
+
+(2021.06)
+*/
+void
+appendString	(std::string&			inoutBuffer,
+				 std::string const&		inString)
+{
+	appendValue(inoutBuffer, STATIC_CAST(inString.size(), UInt32));
+	inoutBuffer.append(inString);
+}// appendString
+
+
+/*!
+Appends the bytes of a value.
+
+(2021.06)
+*/
+template < typename value_type >
+void
+appendValue		(std::string&	inoutBuffer,
+				 value_type		inValue)
+{
+	inoutBuffer.append(REINTERPRET_CAST(&inValue, char const*), sizeof(inValue));
+}// appendValue
+
+
+/*!
+Responds to the end of the output of a session, which
+means that its process has exited or is about to: the
+terminal is closed, and the output of every attachment
+ends once everything before it has been sent.
+
+(2021.06)
+*/
+void
+closeSessionOutput	(My_Session&	inoutSession)
+{
+	if (inoutSession.masterFD >= 0)
+	{
+		UNUSED_RETURN(int)close(inoutSession.masterFD);
+		inoutSession.masterFD = -1;
+	}
+	inoutSession.pendingInput.clear();
+	for (auto	connectionPtr : inoutSession.attachedConnections)
+	{
+		connectionPtr->isFinishing = true;
+	}
+	inoutSession.attachedConnections.clear();
+}// closeSessionOutput
+
+
+/*!
+Responds to a complete message from a client.
+
+(2021.06)
+*/
+void
+handleMessage	(My_ServerPtr				inServerPtr,
+				 My_ConnectionPtr			inConnectionPtr,
+				 My_MessageHeader const&	inHeader,
+				 UInt8 const*				inPayload)
+{
+	UInt8 const*			bytePtr = inPayload;
+	UInt8 const* const		kEndPtr = inPayload + inHeader.payloadSize;
+	auto					toSession = inServerPtr->sessions.find(inHeader.sessionID);
+	My_Session*				sessionPtr = (inServerPtr->sessions.end() != toSession) ? toSession->second.get() : nullptr;
+	SessionServer_Result	failure = kSessionServer_ResultOK;
+	
+	
+	if (kSessionServer_InvalidSessionID != inConnectionPtr->outputSessionID)
+	{
+		// the connection carries output, so there can be no replies
+		toSession = inServerPtr->sessions.find(inConnectionPtr->outputSessionID);
+		sessionPtr = (inServerPtr->sessions.end() != toSession) ? toSession->second.get() : nullptr;
+		if (kMy_MessageDetach != inHeader.messageType)
+		{
+			Console_Warning(Console_WriteValueFourChars, "session server disconnecting an attached client that sent a request", inHeader.messageType);
+		}
+		else if (nullptr != sessionPtr)
+		{
+			UInt64		outputOffset = 0;
+			
+			
+			if (readValue(bytePtr, kEndPtr, outputOffset) && readString(bytePtr, kEndPtr, sessionPtr->savedState))
+			{
+				sessionPtr->savedStateOffset = std::min(outputOffset, sessionPtr->returnOutputByteCount());
+			}
+			else
+			{
+				sessionPtr->savedState.clear();
+				sessionPtr->savedStateOffset = 0;
+			}
+			sessionPtr->attachedConnections.erase(inConnectionPtr);
+		}
+		inConnectionPtr->isFinishing = true;
+		inConnectionPtr->isClosing = (kMy_MessageDetach != inHeader.messageType);
+	}
+	else if ((false == inConnectionPtr->isIdentified) && (kMy_MessageHello != inHeader.messageType))
+	{
+		failure = kSessionServer_ResultProtocolError;
+		inConnectionPtr->isClosing = true;
+	}
+	else
+	{
+		switch (inHeader.messageType)
+		{
+		case kMy_MessageHello:
+			{
+				UInt32		version = 0;
+				
+				
+				if (readValue(bytePtr, kEndPtr, version) && (kMy_ProtocolVersion == version))
+				{
+					inConnectionPtr->isIdentified = true;
+					queueMessage(inConnectionPtr, kMy_MessageOK, kSessionServer_InvalidSessionID, &kMy_ProtocolVersion, sizeof(kMy_ProtocolVersion));
+				}
+				else
+				{
+					failure = kSessionServer_ResultProtocolError;
+					inConnectionPtr->isClosing = true;
+				}
+			}
+			break;
+		
+		case kMy_MessageCreate:
+			{
+				UInt16						columnCount = 0;
+				UInt16						rowCount = 0;
+				std::string					workingDirectory;
+				UInt8						hasTerminalControl = 0;
+				struct termios				terminalControl;
+				UInt32						argumentCount = 0;
+				UInt32						settingCount = 0;
+				std::vector< std::string >	arguments;
+				std::vector< std::string >	settings;
+				Boolean						isValid = (readValue(bytePtr, kEndPtr, columnCount) &&
+														readValue(bytePtr, kEndPtr, rowCount) &&
+														readString(bytePtr, kEndPtr, workingDirectory) &&
+														readValue(bytePtr, kEndPtr, hasTerminalControl));
+				
+				
+				if (isValid && (0 != hasTerminalControl))
+				{
+					isValid = readValue(bytePtr, kEndPtr, terminalControl);
+				}
+				isValid = (isValid && readValue(bytePtr, kEndPtr, argumentCount));
+				for (UInt32 i = 0; (isValid && (i < argumentCount)); ++i)
+				{
+					arguments.emplace_back();
+					isValid = readString(bytePtr, kEndPtr, arguments.back());
+				}
+				isValid = (isValid && readValue(bytePtr, kEndPtr, settingCount));
+				for (UInt32 i = 0; (isValid && (i < settingCount)); ++i)
+				{
+					settings.emplace_back();
+					isValid = readString(bytePtr, kEndPtr, settings.back());
+				}
+				
+				if ((false == isValid) || arguments.empty())
+				{
+					failure = kSessionServer_ResultParameterError;
+				}
+				else
+				{
+					SessionServer_SessionID		newSessionID = kSessionServer_InvalidSessionID;
+					
+					
+					failure = spawnSession(inServerPtr, arguments, settings, workingDirectory,
+											(0 != hasTerminalControl) ? &terminalControl : nullptr,
+											columnCount, rowCount, newSessionID);
+					if (kSessionServer_ResultOK == failure)
+					{
+						queueMessage(inConnectionPtr, kMy_MessageOK, newSessionID);
+					}
+				}
+			}
+			break;
+		
+		case kMy_MessageList:
+			{
+				std::string		payload;
+				
+				
+				appendValue(payload, STATIC_CAST(inServerPtr->sessions.size(), UInt32));
+				for (auto const&	idSessionPair : inServerPtr->sessions)
+				{
+					My_Session&		session = *(idSessionPair.second);
+					struct winsize	terminalSize;
+					
+					
+					// attached clients may resize the terminal directly
+					if ((session.masterFD >= 0) && (0 == ioctl(session.masterFD, TIOCGWINSZ, &terminalSize)))
+					{
+						session.columnCount = terminalSize.ws_col;
+						session.rowCount = terminalSize.ws_row;
+					}
+					appendValue(payload, session.sessionID);
+					appendValue(payload, STATIC_CAST(session.processID, SInt32));
+					appendValue(payload, session.columnCount);
+					appendValue(payload, session.rowCount);
+					appendValue(payload, STATIC_CAST((session.isReaped && (session.masterFD < 0)) ? 0 : 1, UInt8));
+					appendValue(payload, session.exitStatus);
+					appendValue(payload, STATIC_CAST(session.attachedConnections.size(), UInt32));
+					appendString(payload, session.commandLine);
+				}
+				queueMessage(inConnectionPtr, kMy_MessageSessionList, kSessionServer_InvalidSessionID, payload.data(), payload.size());
+			}
+			break;
+		
+		case kMy_MessageAttach:
+			if (nullptr == sessionPtr)
+			{
+				failure = kSessionServer_ResultNoSuchSession;
+			}
+			else
+			{
+				std::string		payload;
+				UInt64			replayOffset = sessionPtr->savedStateOffset;
+				Boolean			isReplayComplete = true;
+				
+				
+				if (replayOffset < sessionPtr->recentOutputOffset)
+				{
+					// some output that the saved state does not include is gone;
+					// start at a new line so that at least the text is sensible
+					size_t const	kNewLineIndex = sessionPtr->recentOutput.find('\n');
+					
+					
+					isReplayComplete = false;
+					replayOffset = sessionPtr->recentOutputOffset;
+					if (std::string::npos != kNewLineIndex)
+					{
+						replayOffset += (kNewLineIndex + 1);
+					}
+				}
+				appendValue(payload, STATIC_CAST(sessionPtr->processID, SInt32));
+				appendValue(payload, sessionPtr->returnOutputByteCount());
+				appendValue(payload, STATIC_CAST((isReplayComplete) ? 1 : 0, UInt8));
+				appendValue(payload, STATIC_CAST((sessionPtr->masterFD >= 0) ? 1 : 0, UInt8));
+				appendString(payload, sessionPtr->deviceName);
+				appendString(payload, sessionPtr->savedState);
+				appendString(payload, sessionPtr->recentOutput.substr(STATIC_CAST(replayOffset - sessionPtr->recentOutputOffset, size_t)));
+				queueMessage(inConnectionPtr, kMy_MessageAttachment, sessionPtr->sessionID, payload.data(), payload.size(),
+								(sessionPtr->masterFD >= 0) ? fcntl(sessionPtr->masterFD, F_DUPFD_CLOEXEC, 0) : -1);
+				
+				// from now on, the connection carries only output
+				inConnectionPtr->outputSessionID = sessionPtr->sessionID;
+				if (sessionPtr->masterFD >= 0)
+				{
+					sessionPtr->attachedConnections.insert(inConnectionPtr);
+				}
+				else
+				{
+					inConnectionPtr->isFinishing = true;
+				}
+			}
+			break;
+		
+		case kMy_MessageKill:
+			if (nullptr == sessionPtr)
+			{
+				failure = kSessionServer_ResultNoSuchSession;
+			}
+			else
+			{
+				SessionServer_SessionID const	kSessionID = sessionPtr->sessionID;
+				
+				
+				killSession(inServerPtr, *sessionPtr);
+				queueMessage(inConnectionPtr, kMy_MessageOK, kSessionID);
+			}
+			break;
+		
+		case kMy_MessageInput:
+			// no reply (even if the session has ended); the input
+			// is written as the terminal accepts it
+			if ((nullptr != sessionPtr) && (sessionPtr->masterFD >= 0))
+			{
+				sessionPtr->pendingInput.append(REINTERPRET_CAST(inPayload, char const*), inHeader.payloadSize);
+			}
+			break;
+		
+		case kMy_MessageResize:
+			// no reply
+			{
+				UInt16		columnCount = 0;
+				UInt16		rowCount = 0;
+				
+				
+				if ((nullptr != sessionPtr) && readValue(bytePtr, kEndPtr, columnCount) && readValue(bytePtr, kEndPtr, rowCount))
+				{
+					sessionPtr->columnCount = std::max< UInt16 >(columnCount, 1);
+					sessionPtr->rowCount = std::max< UInt16 >(rowCount, 1);
+					if (sessionPtr->masterFD >= 0)
+					{
+						struct winsize		terminalSize;
+						
+						
+						std::memset(&terminalSize, 0, sizeof(terminalSize));
+						terminalSize.ws_col = sessionPtr->columnCount;
+						terminalSize.ws_row = sessionPtr->rowCount;
+						UNUSED_RETURN(int)ioctl(sessionPtr->masterFD, TIOCSWINSZ, &terminalSize);
+					}
+				}
+			}
+			break;
+		
+		default:
+			failure = kSessionServer_ResultProtocolError;
+			break;
+		}
+	}
+	
+	if (kSessionServer_ResultOK != failure)
+	{
+		SInt32 const	kFailure = STATIC_CAST(failure, SInt32);
+		
+		
+		queueMessage(inConnectionPtr, kMy_MessageFailed, inHeader.sessionID, &kFailure, sizeof(kFailure));
+	}
+}// handleMessage
+
+
+/*!
+Sends a hang-up signal to the process group of a session,
+ends the output of every attachment and forgets the
+session.  The process is reaped later if it does not exit
+immediately.
+
+(2021.06)
+*/
+void
+killSession		(My_ServerPtr	inServerPtr,
+				 My_Session&	inoutSession)
+{
+	SessionServer_SessionID const	kSessionID = inoutSession.sessionID;
+	
+	
+	unless (inoutSession.isReaped)
+	{
+		UNUSED_RETURN(int)kill(-inoutSession.processID, SIGHUP);
+		UNUSED_RETURN(int)kill(inoutSession.processID, SIGHUP);
+		inServerPtr->killedProcessIDs.insert(inoutSession.processID);
+	}
+	closeSessionOutput(inoutSession);
+	inoutSession.isReaped = true; // the exit status is no longer of interest
+	inServerPtr->sessions.erase(kSessionID); // destroys the session
+}// killSession
+
+
+/*!
+Fills in the address of a Unix-domain socket.  Returns
+false if the path is too long.
+
+(2021.06)
+*/
+Boolean
+makeSocketAddress	(char const*			inSocketPath,
+					 struct sockaddr_un&	outAddress)
+{
+	Boolean		result = (std::strlen(inSocketPath) < sizeof(outAddress.sun_path));
+	
+	
+	std::memset(&outAddress, 0, sizeof(outAddress));
+	outAddress.sun_family = AF_UNIX;
+	if (result)
+	{
+		std::strncpy(outAddress.sun_path, inSocketPath, sizeof(outAddress.sun_path) - 1);
+	}
+	return result;
+}// makeSocketAddress
+
+
+/*!
+Adds a message to the bytes to be sent on a connection,
+and sends as much as possible right away.  If the client
+has fallen too far behind, the connection is closed
+instead.
+
+If a file descriptor is given, it is sent along with the
+message and then closed; it is also closed if the message
+cannot be sent.
+
+(2021.06)
+*/
+void
+queueMessage	(My_ConnectionPtr			inConnectionPtr,
+				 FourCharCode				inMessageType,
+				 SessionServer_SessionID	inSessionID,
+				 void const*				inPayload,
+				 size_t						inPayloadSize,
+				 int						inPassedFD)
+{
+	if ((inConnectionPtr->writeBuffer.size() - inConnectionPtr->writeOffset) > kMy_MaximumPendingWriteSize)
+	{
+		Console_Warning(Console_WriteLine, "session server disconnecting a client that is not reading its messages");
+		inConnectionPtr->isClosing = true;
+	}
+	else unless ((inConnectionPtr->isClosing && inConnectionPtr->isIdentified) ||
+					((inPassedFD >= 0) && (inConnectionPtr->passedFD >= 0)))
+	{
+		My_MessageHeader	header;
+		
+		
+		if (inPassedFD >= 0)
+		{
+			inConnectionPtr->passedFD = inPassedFD;
+			inConnectionPtr->passedFDOffset = inConnectionPtr->writeBuffer.size();
+			inPassedFD = -1;
+		}
+		header.messageType = inMessageType;
+		header.sessionID = inSessionID;
+		header.payloadSize = STATIC_CAST(inPayloadSize, UInt32);
+		inConnectionPtr->writeBuffer.append(REINTERPRET_CAST(&header, char const*), sizeof(header));
+		if (inPayloadSize > 0)
+		{
+			inConnectionPtr->writeBuffer.append(STATIC_CAST(inPayload, char const*), inPayloadSize);
+		}
+		writeConnection(inConnectionPtr);
+	}
+	
+	if (inPassedFD >= 0)
+	{
+		UNUSED_RETURN(int)close(inPassedFD);
+	}
+}// queueMessage
+
+
+/*!
+Reads everything that a client has sent, and responds to
+each complete message.
+
+(2021.06)
+*/
+void
+readConnection	(My_ServerPtr		inServerPtr,
+				 My_ConnectionPtr	inConnectionPtr)
+{
+	char	buffer[kMy_ReadSize];
+	ssize_t	readResult = 0;
+	size_t	offset = 0;
+	
+	
+	while ((readResult = read(inConnectionPtr->socketFD, buffer, sizeof(buffer))) > 0)
+	{
+		inConnectionPtr->readBuffer.append(buffer, STATIC_CAST(readResult, size_t));
+	}
+	if ((0 == readResult) || ((EAGAIN != errno) && (EWOULDBLOCK != errno) && (EINTR != errno)))
+	{
+		// client has disconnected
+		inConnectionPtr->isClosing = true;
+	}
+	
+	while ((false == inConnectionPtr->isClosing) &&
+			((inConnectionPtr->readBuffer.size() - offset) >= sizeof(My_MessageHeader)))
+	{
+		My_MessageHeader	header;
+		
+		
+		std::memcpy(&header, inConnectionPtr->readBuffer.data() + offset, sizeof(header));
+		if (header.payloadSize > kMy_MaximumPayloadSize)
+		{
+			Console_Warning(Console_WriteValueFourChars, "session server disconnecting a client that sent an oversized message", header.messageType);
+			inConnectionPtr->isClosing = true;
+		}
+		else if ((inConnectionPtr->readBuffer.size() - offset - sizeof(header)) >= header.payloadSize)
+		{
+			handleMessage(inServerPtr, inConnectionPtr, header,
+							REINTERPRET_CAST(inConnectionPtr->readBuffer.data() + offset + sizeof(header), UInt8 const*));
+			offset += (sizeof(header) + header.payloadSize);
+		}
+		else
+		{
+			// the rest of the message has not arrived yet
+			break;
+		}
+	}
+	inConnectionPtr->readBuffer.erase(0, offset);
+}// readConnection
+
+
+/*!
+Reads the next block of output from the terminal of a
+session, keeps it for future attachments and sends it to
+every attached client.  (Only one block is read at a time
+so that very busy sessions do not delay the others; and
+the terminal is shared with clients, so it is not
+nonblocking.)
+
+(2021.06)
+*/
+void
+readSessionOutput	(My_Session&	inoutSession)
+{
+	char		buffer[kMy_ReadSize];
+	ssize_t		readResult = read(inoutSession.masterFD, buffer, sizeof(buffer));
+	
+	
+	if (readResult > 0)
+	{
+		size_t const	kByteCount = STATIC_CAST(readResult, size_t);
+		
+		
+		inoutSession.recentOutput.append(buffer, kByteCount);
+		if (inoutSession.recentOutput.size() > (2 * kMy_ReplaySize))
+		{
+			size_t const	kDiscardedCount = inoutSession.recentOutput.size() - kMy_ReplaySize;
+			
+			
+			inoutSession.recentOutput.erase(0, kDiscardedCount);
+			inoutSession.recentOutputOffset += kDiscardedCount;
+		}
+		for (auto	connectionPtr : inoutSession.attachedConnections)
+		{
+			unless (connectionPtr->isClosing)
+			{
+				connectionPtr->writeBuffer.append(buffer, kByteCount);
+				writeConnection(connectionPtr);
+			}
+		}
+	}
+	else if ((0 == readResult) || ((EAGAIN != errno) && (EWOULDBLOCK != errno) && (EINTR != errno)))
+	{
+		// end of file (or, on some systems, EIO) means that every
+		// process has closed the terminal
+		closeSessionOutput(inoutSession);
+	}
+}// readSessionOutput
+
+
+/*!
+Reads a string that was written by appendString(), and
+advances the pointer past it.  Returns false if there are
+not enough bytes.
+
+(2021.06)
+*/
+Boolean
+readString	(UInt8 const*&		inoutBytePtr,
+			 UInt8 const*		inPastEndPtr,
+			 std::string&		outString)
+{
+	UInt32		length = 0;
+	Boolean		result = readValue(inoutBytePtr, inPastEndPtr, length);
+	
+	
+	if (result)
+	{
+		result = (STATIC_CAST(inPastEndPtr - inoutBytePtr, size_t) >= length);
+		if (result)
+		{
+			outString.assign(REINTERPRET_CAST(inoutBytePtr, char const*), length);
+			inoutBytePtr += length;
+		}
+	}
+	return result;
+}// readString
+
+
+/*!
+Reads a value that was written by appendValue(), and
+advances the pointer past it.  Returns false if there
+are not enough bytes.
+
+(2021.06)
+*/
+template < typename value_type >
+Boolean
+readValue	(UInt8 const*&		inoutBytePtr,
+			 UInt8 const*		inPastEndPtr,
+			 value_type&		outValue)
+{
+	Boolean		result = (STATIC_CAST(inPastEndPtr - inoutBytePtr, size_t) >= sizeof(outValue));
+	
+	
+	if (result)
+	{
+		std::memcpy(&outValue, inoutBytePtr, sizeof(outValue));
+		inoutBytePtr += sizeof(outValue);
+	}
+	return result;
+}// readValue
+
+
+/*!
+Collects the exit status of any session process that has
+exited, and of any killed process.  Other child processes
+of the current process are not affected.
+
+(2021.06)
+*/
+void
+reapProcesses	(My_ServerPtr	inServerPtr)
+{
+	for (auto&	idSessionPair : inServerPtr->sessions)
+	{
+		My_Session&		session = *(idSessionPair.second);
+		int				status = 0;
+		
+		
+		if ((false == session.isReaped) && (session.processID == waitpid(session.processID, &status, WNOHANG)))
+		{
+			session.isReaped = true;
+			if (WIFEXITED(status))
+			{
+				session.exitStatus = WEXITSTATUS(status);
+			}
+			else if (WIFSIGNALED(status))
+			{
+				session.exitStatus = 128 + WTERMSIG(status);
+			}
+		}
+	}
+	for (auto toProcessID = inServerPtr->killedProcessIDs.begin(); toProcessID != inServerPtr->killedProcessIDs.end(); )
+	{
+		int		status = 0;
+		pid_t	waitResult = waitpid(*toProcessID, &status, WNOHANG);
+		
+		
+		if ((*toProcessID == waitResult) || ((waitResult < 0) && (ECHILD == errno)))
+		{
+			toProcessID = inServerPtr->killedProcessIDs.erase(toProcessID);
+		}
+		else
+		{
+			++toProcessID;
+		}
+	}
+}// reapProcesses
+
+
+/*!
+Waits for a complete message from the server.  Any file
+descriptors that arrive are added to the list of the
+client (see SessionServer_ClientAttach()).
+
+(2021.06)
+*/
+SessionServer_Result
+receiveMessage	(My_ClientPtr			inClientPtr,
+				 My_MessageHeader&		outHeader,
+				 std::string&			outPayload)
+{
+	SessionServer_Result	result = kSessionServer_ResultOK;
+	Boolean					isComplete = false;
+	
+	
+	while ((false == isComplete) && (kSessionServer_ResultOK == result))
+	{
+		std::string&	buffer = inClientPtr->readBuffer;
+		
+		
+		if (buffer.size() >= sizeof(outHeader))
+		{
+			std::memcpy(&outHeader, buffer.data(), sizeof(outHeader));
+			if (outHeader.payloadSize > kMy_MaximumPayloadSize)
+			{
+				result = kSessionServer_ResultProtocolError;
+			}
+			else if ((buffer.size() - sizeof(outHeader)) >= outHeader.payloadSize)
+			{
+				outPayload.assign(buffer, sizeof(outHeader), outHeader.payloadSize);
+				buffer.erase(0, sizeof(outHeader) + outHeader.payloadSize);
+				isComplete = true;
+			}
+			else
+			{
+				// make room for the rest of a large message all at once
+				buffer.reserve(sizeof(outHeader) + outHeader.payloadSize);
+			}
+		}
+		
+		if ((false == isComplete) && (kSessionServer_ResultOK == result))
+		{
+			char			readBuffer[kMy_ReadSize * 4];
+			struct iovec	part = { readBuffer, sizeof(readBuffer) };
+			union
+			{
+				struct cmsghdr	header;
+				char			bytes[CMSG_SPACE(sizeof(int) * kMy_MaximumPassedFDs)];
+			}				control;
+			struct msghdr	messageInfo;
+			ssize_t			readResult = 0;
+			
+			
+			std::memset(&messageInfo, 0, sizeof(messageInfo));
+			messageInfo.msg_iov = &part;
+			messageInfo.msg_iovlen = 1;
+			messageInfo.msg_control = control.bytes;
+			messageInfo.msg_controllen = sizeof(control.bytes);
+			readResult = recvmsg(inClientPtr->socketFD, &messageInfo, 0);
+			if (readResult > 0)
+			{
+				buffer.append(readBuffer, STATIC_CAST(readResult, size_t));
+				for (struct cmsghdr* controlPtr = CMSG_FIRSTHDR(&messageInfo); nullptr != controlPtr;
+						controlPtr = CMSG_NXTHDR(&messageInfo, controlPtr))
+				{
+					if ((SOL_SOCKET == controlPtr->cmsg_level) && (SCM_RIGHTS == controlPtr->cmsg_type))
+					{
+						size_t const	kFDCount = (controlPtr->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+						
+						
+						for (size_t i = 0; i < kFDCount; ++i)
+						{
+							int		fd = -1;
+							
+							
+							std::memcpy(&fd, CMSG_DATA(controlPtr) + (i * sizeof(int)), sizeof(fd));
+							UNUSED_RETURN(int)fcntl(fd, F_SETFD, FD_CLOEXEC);
+							inClientPtr->receivedFDs.push_back(fd);
+						}
+					}
+				}
+			}
+			else if ((0 == readResult) || (EINTR != errno))
+			{
+				result = kSessionServer_ResultDisconnected;
+			}
+		}
+	}
+	return result;
+}// receiveMessage
+
+
+/*!
+Returns the result of a reply: success if it has the
+expected type, the result that the server sent if it is a
+failure message, or a protocol error otherwise.
+
+(2021.06)
+*/
+SessionServer_Result
+resultOfReply	(My_MessageHeader const&	inHeader,
+				 std::string const&			inPayload,
+				 FourCharCode				inExpectedType)
+{
+	SessionServer_Result	result = kSessionServer_ResultProtocolError;
+	
+	
+	if (inExpectedType == inHeader.messageType)
+	{
+		result = kSessionServer_ResultOK;
+	}
+	else if ((kMy_MessageFailed == inHeader.messageType) && (sizeof(SInt32) == inPayload.size()))
+	{
+		SInt32		failure = 0;
+		
+		
+		std::memcpy(&failure, inPayload.data(), sizeof(failure));
+		result = failure;
+	}
+	return result;
+}// resultOfReply
+
+
+/*!
+Sends a message on a blocking socket, waiting until it
+has all been sent.
+
+(2021.06)
+*/
+SessionServer_Result
+sendMessage		(int						inSocketFD,
+				 FourCharCode				inMessageType,
+				 SessionServer_SessionID	inSessionID,
+				 void const*				inPayload,
+				 size_t						inPayloadSize)
+{
+	SessionServer_Result	result = kSessionServer_ResultOK;
+	My_MessageHeader		header;
+	struct iovec			parts[2];
+	size_t					partCount = (inPayloadSize > 0) ? 2 : 1;
+	size_t					partIndex = 0;
+	
+	
+	header.messageType = inMessageType;
+	header.sessionID = inSessionID;
+	header.payloadSize = STATIC_CAST(inPayloadSize, UInt32);
+	parts[0].iov_base = &header;
+	parts[0].iov_len = sizeof(header);
+	parts[1].iov_base = CONST_CAST(inPayload, void*);
+	parts[1].iov_len = inPayloadSize;
+	while ((partIndex < partCount) && (kSessionServer_ResultOK == result))
+	{
+		struct msghdr	messageInfo;
+		ssize_t			sendResult = 0;
+		
+		
+		std::memset(&messageInfo, 0, sizeof(messageInfo));
+		messageInfo.msg_iov = parts + partIndex;
+		messageInfo.msg_iovlen = STATIC_CAST(partCount - partIndex, decltype(messageInfo.msg_iovlen));
+		sendResult = sendmsg(inSocketFD, &messageInfo, MSG_NOSIGNAL);
+		if (sendResult < 0)
+		{
+			unless (EINTR == errno)
+			{
+				result = kSessionServer_ResultDisconnected;
+			}
+		}
+		else
+		{
+			size_t		sentSize = STATIC_CAST(sendResult, size_t);
+			
+			
+			// skip the parts (or part of a part) that were sent
+			while ((partIndex < partCount) && (sentSize >= parts[partIndex].iov_len))
+			{
+				sentSize -= parts[partIndex].iov_len;
+				++partIndex;
+			}
+			if (partIndex < partCount)
+			{
+				parts[partIndex].iov_base = STATIC_CAST(parts[partIndex].iov_base, char*) + sentSize;
+				parts[partIndex].iov_len -= sentSize;
+			}
+		}
+	}
+	return result;
+}// sendMessage
+
+
+/*!
+Sends a request and waits for its reply.
+
+(2021.06)
+*/
+SessionServer_Result
+sendRequest		(My_ClientPtr				inClientPtr,
+				 FourCharCode				inMessageType,
+				 SessionServer_SessionID	inSessionID,
+				 std::string const&			inPayload,
+				 My_MessageHeader&			outReplyHeader,
+				 std::string&				outReplyPayload)
+{
+	SessionServer_Result	result = sendMessage(inClientPtr->socketFD, inMessageType, inSessionID, inPayload.data(), inPayload.size());
+	
+	
+	if (kSessionServer_ResultOK == result)
+	{
+		result = receiveMessage(inClientPtr, outReplyHeader, outReplyPayload);
+	}
+	return result;
+}// sendRequest
+
+
+/*!
+Prevents a socket (or pipe) from being inherited by spawned
+processes and from raising SIGPIPE, and optionally makes it
+nonblocking.
+
+(2021.06)
+*/
+void
+setSocketOptions	(int		inFD,
+					 Boolean	inIsNonblocking)
+{
+	UNUSED_RETURN(int)fcntl(inFD, F_SETFD, FD_CLOEXEC);
+	if (inIsNonblocking)
+	{
+		UNUSED_RETURN(int)fcntl(inFD, F_SETFL, fcntl(inFD, F_GETFL) | O_NONBLOCK);
+	}
+#ifdef SO_NOSIGPIPE
+	{
+		int		flag = 1;
+		
+		
+		UNUSED_RETURN(int)setsockopt(inFD, SOL_SOCKET, SO_NOSIGPIPE, &flag, sizeof(flag));
+	}
+#endif
+}// setSocketOptions
+
+
+/*!
+Spawns a process on a new pseudo-terminal and adds a
+session for it.
+
+The process is started by ProcessSpawn_InPseudoTerminal(),
+exactly as the application starts local processes; so its
+environment is built the same way, and a program that
+cannot be run is reported in the same way (on macOS, the
+spawn helper writes a message and exits).
+
+The terminal stays blocking, because attached clients
+share it (and they expect writes to block).
+
+(2021.06)
+*/
+SessionServer_Result
+spawnSession	(My_ServerPtr						inServerPtr,
+				 std::vector< std::string > const&	inArguments,
+				 std::vector< std::string > const&	inEnvironmentSettings,
+				 std::string const&					inWorkingDirectory,
+				 struct termios const*				inTerminalControlOrNull,
+				 UInt16								inColumnCount,
+				 UInt16								inRowCount,
+				 SessionServer_SessionID&			outSessionID)
+{
+	SessionServer_Result	result = kSessionServer_ResultOK;
+	std::string				commandLine;
+	struct winsize			terminalSize;
+	ProcessSpawn_Process	process;
+	ProcessSpawn_Result		spawnResult = kProcessSpawn_ResultOK;
+	
+	
+	for (auto const&	argument : inArguments)
+	{
+		unless (commandLine.empty())
+		{
+			commandLine += ' ';
+		}
+		commandLine += argument;
+	}
+	
+	std::memset(&terminalSize, 0, sizeof(terminalSize));
+	terminalSize.ws_col = std::max< UInt16 >(inColumnCount, 1);
+	terminalSize.ws_row = std::max< UInt16 >(inRowCount, 1);
+	spawnResult = ProcessSpawn_InPseudoTerminal(inArguments, inEnvironmentSettings,
+												(inWorkingDirectory.empty()) ? nullptr : inWorkingDirectory.c_str(),
+												inTerminalControlOrNull, &terminalSize, process);
+	if (kProcessSpawn_ResultOK != spawnResult)
+	{
+		Console_Warning(Console_WriteValue, "session server unable to spawn process, result", spawnResult);
+		result = (kProcessSpawn_ResultParameterError == spawnResult)
+					? kSessionServer_ResultParameterError
+					: kSessionServer_ResultSpawnError;
+	}
+	else
+	{
+		My_SessionPtr	sessionPtr(new My_Session(inServerPtr->nextSessionID++, process,
+													terminalSize.ws_col, terminalSize.ws_row, commandLine));
+		
+		
+		outSessionID = sessionPtr->sessionID;
+		inServerPtr->sessions[outSessionID] = std::move(sessionPtr);
+	}
+	return result;
+}// spawnSession
+
+
+/*!
+Tests attaching to a session, after its process has exited,
+from a new connection; all of the output should be
+replayed, followed by the end of the output.
+
+Returns "true" if ALL assertions pass; "false" is
+returned if any fail, however messages should be
+printed for ALL assertion failures regardless.
+
+(2021.06)
+*/
+Boolean
+unitTest000_Begin	(char const*	inSocketPath)
+{
+	SessionServer_Result		clientResult = kSessionServer_ResultOK;
+	SessionServer_ClientRef		client = SessionServer_NewClient(inSocketPath, clientResult);
+	SessionServer_SessionID		sessionID = kSessionServer_InvalidSessionID;
+	Boolean						result = true;
+	
+	
+	Console_TestAssertUpdate(result, nullptr != client, Console_WriteValue, "connection result", clientResult);
+	if (nullptr != client)
+	{
+		SessionServer_SessionInfo	info;
+		
+		
+		clientResult = SessionServer_ClientCreateSession
+						(client, { "/bin/sh", "-c", "i=1; while [ $i -le 50 ]; do echo line $i; i=$((i+1)); done" },
+							{ "TERM=vt100" }, nullptr/* working directory */, nullptr/* terminal settings */, 80, 24, sessionID);
+		Console_TestAssertUpdate(result, kSessionServer_ResultOK == clientResult, Console_WriteValue, "create result", clientResult);
+		Console_TestAssertUpdate(result, waitForExit(client, sessionID, info), Console_WriteLine, "expected process to exit");
+		Console_TestAssertUpdate(result, 0 == info.exitStatus, Console_WriteValue, "exit status", info.exitStatus);
+		SessionServer_DisposeClient(&client);
+	}
+	
+	// reconnect, as if the application had been restarted
+	client = SessionServer_NewClient(inSocketPath, clientResult);
+	Console_TestAssertUpdate(result, nullptr != client, Console_WriteValue, "reconnection result", clientResult);
+	if (nullptr != client)
+	{
+		std::vector< SessionServer_SessionInfo >	sessions;
+		SessionServer_Attachment					attachment;
+		
+		
+		clientResult = SessionServer_ClientListSessions(client, sessions);
+		Console_TestAssertUpdate(result, (1 == sessions.size()) && (sessionID == sessions.front().sessionID),
+									Console_WriteValue, "session count", sessions.size());
+		
+		clientResult = SessionServer_ClientAttach(client, sessionID, attachment);
+		Console_TestAssertUpdate(result, kSessionServer_ResultOK == clientResult, Console_WriteValue, "attach result", clientResult);
+		Console_TestAssertUpdate(result, -1 == attachment.terminalFD, Console_WriteValue, "terminal of exited process", attachment.terminalFD);
+		Console_TestAssertUpdate(result, attachment.savedState.empty(), Console_WriteValue, "saved state size", attachment.savedState.size());
+		Console_TestAssertUpdate(result, attachment.isReplayComplete, Console_WriteLine, "expected complete replay");
+		Console_TestAssertUpdate(result, 0 == attachment.replayedOutput.compare(0, 16, "line 1\r\nline 2\r\n"),
+									Console_WriteValueStdString, "replayed output", attachment.replayedOutput);
+		if (attachment.outputFD >= 0)
+		{
+			std::string		output = attachment.replayedOutput;
+			
+			
+			// an exited session has no more output
+			Console_TestAssertUpdate(result, waitForOutput(attachment.outputFD, output, nullptr/* read to end */),
+										Console_WriteLine, "expected output to end");
+			Console_TestAssertUpdate(result, std::string::npos != output.find("line 49\r\nline 50\r\n"),
+										Console_WriteValueStdString, "output", output);
+			UNUSED_RETURN(int)close(attachment.outputFD);
+		}
+		
+		clientResult = SessionServer_ClientKillSession(client, sessionID);
+		Console_TestAssertUpdate(result, kSessionServer_ResultOK == clientResult, Console_WriteValue, "kill result", clientResult);
+		clientResult = SessionServer_ClientListSessions(client, sessions);
+		Console_TestAssertUpdate(result, sessions.empty(), Console_WriteValue, "session count after kill", sessions.size());
+		clientResult = SessionServer_ClientAttach(client, sessionID, attachment);
+		Console_TestAssertUpdate(result, kSessionServer_ResultNoSuchSession == clientResult,
+									Console_WriteValue, "attach result after kill", clientResult);
+		SessionServer_DisposeClient(&client);
+	}
+	
+	return result;
+}// unitTest000_Begin
+
+
+/*!
+Tests input, output, resizing and two attachments to the
+same session.
+
+Returns "true" if ALL assertions pass; "false" is
+returned if any fail, however messages should be
+printed for ALL assertion failures regardless.
+
+(2021.06)
+*/
+Boolean
+unitTest001_Begin	(char const*	inSocketPath)
+{
+	SessionServer_Result		clientResult = kSessionServer_ResultOK;
+	SessionServer_ClientRef		client = SessionServer_NewClient(inSocketPath, clientResult);
+	Boolean						result = true;
+	
+	
+	Console_TestAssertUpdate(result, nullptr != client, Console_WriteValue, "connection result", clientResult);
+	if (nullptr != client)
+	{
+		SessionServer_SessionID		sessionID = kSessionServer_InvalidSessionID;
+		SessionServer_Attachment	attachment;
+		SessionServer_Attachment	otherAttachment;
+		std::string					output;
+		std::string					otherOutput;
+		
+		
+		clientResult = SessionServer_ClientCreateSession(client, { "cat" }, {}, "/", nullptr/* terminal settings */, 20, 5, sessionID);
+		Console_TestAssertUpdate(result, kSessionServer_ResultOK == clientResult, Console_WriteValue, "create result", clientResult);
+		clientResult = SessionServer_ClientAttach(client, sessionID, attachment);
+		Console_TestAssertUpdate(result, kSessionServer_ResultOK == clientResult, Console_WriteValue, "attach result", clientResult);
+		Console_TestAssertUpdate(result, (attachment.replayedOutput.empty()) && (0 == attachment.outputOffset),
+									Console_WriteValue, "initial output offset", attachment.outputOffset);
+		Console_TestAssertUpdate(result, (attachment.terminalFD >= 0) && (false == attachment.deviceName.empty()),
+									Console_WriteValue, "terminal", attachment.terminalFD);
+		
+		// the terminal echoes the input, and then "cat" repeats it;
+		// output must arrive in order with no gaps
+		clientResult = SessionServer_ClientWriteInput(client, sessionID, "hello\n", 6);
+		Console_TestAssertUpdate(result, kSessionServer_ResultOK == clientResult, Console_WriteValue, "input result", clientResult);
+		Console_TestAssertUpdate(result, waitForOutput(attachment.outputFD, output, "hello\r\nhello\r\n") && ("hello\r\nhello\r\n" == output),
+									Console_WriteValueStdString, "output", output);
+		
+		// a second window receives what was sent already, and then
+		// the same output as the first window
+		clientResult = SessionServer_ClientAttach(client, sessionID, otherAttachment);
+		Console_TestAssertUpdate(result, kSessionServer_ResultOK == clientResult, Console_WriteValue, "second attach result", clientResult);
+		Console_TestAssertUpdate(result, (output == otherAttachment.replayedOutput) && (output.size() == otherAttachment.outputOffset),
+									Console_WriteValueStdString, "second replayed output", otherAttachment.replayedOutput);
+		Console_TestAssertUpdate(result, (attachment.processID == otherAttachment.processID) &&
+											(attachment.deviceName == otherAttachment.deviceName),
+									Console_WriteValue, "second process ID", otherAttachment.processID);
+		if (otherAttachment.terminalFD >= 0)
+		{
+			// input can be written directly to the terminal
+			UNUSED_RETURN(ssize_t)write(otherAttachment.terminalFD, "again\n", 6);
+			otherOutput = otherAttachment.replayedOutput;
+			Console_TestAssertUpdate(result, waitForOutput(attachment.outputFD, output, "again\r\nagain\r\n"),
+										Console_WriteValueStdString, "output after direct input", output);
+			Console_TestAssertUpdate(result, waitForOutput(otherAttachment.outputFD, otherOutput, "again\r\nagain\r\n") &&
+												(output == otherOutput),
+										Console_WriteValueStdString, "second output after direct input", otherOutput);
+		}
+		
+		// the server resizes the terminal, which every attachment shares
+		{
+			std::vector< SessionServer_SessionInfo >	sessions;
+			struct winsize								terminalSize;
+			
+			
+			clientResult = SessionServer_ClientResize(client, sessionID, 30, 6);
+			Console_TestAssertUpdate(result, kSessionServer_ResultOK == clientResult, Console_WriteValue, "resize result", clientResult);
+			clientResult = SessionServer_ClientListSessions(client, sessions);
+			Console_TestAssertUpdate(result, (1 == sessions.size()) && (30 == sessions.front().columnCount) &&
+												(6 == sessions.front().rowCount) && (2 == sessions.front().attachedClientCount) &&
+												(sessions.front().isRunning) && ("cat" == sessions.front().commandLine),
+										Console_WriteValue, "session count", sessions.size());
+			std::memset(&terminalSize, 0, sizeof(terminalSize));
+			UNUSED_RETURN(int)ioctl(attachment.terminalFD, TIOCGWINSZ, &terminalSize);
+			Console_TestAssertUpdate(result, (30 == terminalSize.ws_col) && (6 == terminalSize.ws_row),
+										Console_WriteValuePair, "terminal size", terminalSize.ws_col, terminalSize.ws_row);
+		}
+		
+		// killing the session ends the output of every attachment
+		clientResult = SessionServer_ClientKillSession(client, sessionID);
+		Console_TestAssertUpdate(result, kSessionServer_ResultOK == clientResult, Console_WriteValue, "kill result", clientResult);
+		Console_TestAssertUpdate(result, waitForOutput(attachment.outputFD, output, nullptr/* read to end */),
+									Console_WriteLine, "expected output to end after kill");
+		Console_TestAssertUpdate(result, waitForOutput(otherAttachment.outputFD, otherOutput, nullptr/* read to end */),
+									Console_WriteLine, "expected second output to end after kill");
+		for (int	fd : { attachment.outputFD, attachment.terminalFD, otherAttachment.outputFD, otherAttachment.terminalFD })
+		{
+			if (fd >= 0)
+			{
+				UNUSED_RETURN(int)close(fd);
+			}
+		}
+		SessionServer_DisposeClient(&client);
+	}
+	
+	return result;
+}// unitTest001_Begin
+
+
+/*!
+Tests detaching with a saved state and then attaching
+again: the new attachment must have the state, and exactly
+the output that the state does not include (whether or not
+the first attachment had read it).
+
+Returns "true" if ALL assertions pass; "false" is
+returned if any fail, however messages should be
+printed for ALL assertion failures regardless.
+
+(2021.06)
+*/
+Boolean
+unitTest002_Begin	(char const*	inSocketPath)
+{
+	SessionServer_Result		clientResult = kSessionServer_ResultOK;
+	SessionServer_ClientRef		client = SessionServer_NewClient(inSocketPath, clientResult);
+	Boolean						result = true;
+	
+	
+	Console_TestAssertUpdate(result, nullptr != client, Console_WriteValue, "connection result", clientResult);
+	if (nullptr != client)
+	{
+		SessionServer_SessionID		sessionID = kSessionServer_InvalidSessionID;
+		SessionServer_Attachment	attachment;
+		std::string					output;
+		UInt64						processedOffset = 0;
+		
+		
+		clientResult = SessionServer_ClientCreateSession(client, { "cat" }, {}, nullptr/* working directory */,
+															nullptr/* terminal settings */, 80, 24, sessionID);
+		Console_TestAssertUpdate(result, kSessionServer_ResultOK == clientResult, Console_WriteValue, "create result", clientResult);
+		clientResult = SessionServer_ClientAttach(client, sessionID, attachment);
+		Console_TestAssertUpdate(result, kSessionServer_ResultOK == clientResult, Console_WriteValue, "attach result", clientResult);
+		
+		// the first line is in the saved state; the second line is
+		// read but (as if the window had closed first) not processed
+		UNUSED_RETURN(SessionServer_Result)SessionServer_ClientWriteInput(client, sessionID, "one\n", 4);
+		Console_TestAssertUpdate(result, waitForOutput(attachment.outputFD, output, "one\r\none\r\n"),
+									Console_WriteValueStdString, "first output", output);
+		processedOffset = attachment.outputOffset + output.size();
+		UNUSED_RETURN(SessionServer_Result)SessionServer_ClientWriteInput(client, sessionID, "two\n", 4);
+		Console_TestAssertUpdate(result, waitForOutput(attachment.outputFD, output, "two\r\ntwo\r\n"),
+									Console_WriteValueStdString, "second output", output);
+		clientResult = SessionServer_DetachOutput(attachment.outputFD, processedOffset, "STATE");
+		Console_TestAssertUpdate(result, kSessionServer_ResultOK == clientResult, Console_WriteValue, "detach result", clientResult);
+		Console_TestAssertUpdate(result, waitForOutput(attachment.outputFD, output, nullptr/* read to end */),
+									Console_WriteLine, "expected output to end after detach");
+		UNUSED_RETURN(int)close(attachment.outputFD);
+		UNUSED_RETURN(int)close(attachment.terminalFD);
+		
+		// the process keeps running, and its output is kept
+		UNUSED_RETURN(SessionServer_Result)SessionServer_ClientWriteInput(client, sessionID, "three\n", 6);
+		{
+			std::vector< SessionServer_SessionInfo >	sessions;
+			
+			
+			clientResult = SessionServer_ClientListSessions(client, sessions);
+			Console_TestAssertUpdate(result, (1 == sessions.size()) && (0 == sessions.front().attachedClientCount) &&
+												(sessions.front().isRunning),
+										Console_WriteValue, "session count after detach", sessions.size());
+		}
+		
+		clientResult = SessionServer_ClientAttach(client, sessionID, attachment);
+		Console_TestAssertUpdate(result, kSessionServer_ResultOK == clientResult, Console_WriteValue, "reattach result", clientResult);
+		Console_TestAssertUpdate(result, "STATE" == attachment.savedState, Console_WriteValueStdString, "saved state", attachment.savedState);
+		Console_TestAssertUpdate(result, attachment.isReplayComplete, Console_WriteLine, "expected complete replay");
+		Console_TestAssertUpdate(result, 0 == attachment.replayedOutput.compare(0, 10, "two\r\ntwo\r\n"),
+									Console_WriteValueStdString, "replayed output", attachment.replayedOutput);
+		output = attachment.replayedOutput;
+		Console_TestAssertUpdate(result, waitForOutput(attachment.outputFD, output, "three\r\nthree\r\n"),
+									Console_WriteValueStdString, "output after reattach", output);
+		Console_TestAssertUpdate(result, std::string::npos == output.find("one"), Console_WriteValueStdString, "output after reattach", output);
+		if (attachment.terminalFD >= 0)
+		{
+			UNUSED_RETURN(ssize_t)write(attachment.terminalFD, "four\n", 5);
+			Console_TestAssertUpdate(result, waitForOutput(attachment.outputFD, output, "four\r\nfour\r\n"),
+										Console_WriteValueStdString, "output after direct input", output);
+			UNUSED_RETURN(int)close(attachment.terminalFD);
+		}
+		
+		clientResult = SessionServer_ClientKillSession(client, sessionID);
+		Console_TestAssertUpdate(result, kSessionServer_ResultOK == clientResult, Console_WriteValue, "kill result", clientResult);
+		UNUSED_RETURN(int)close(attachment.outputFD);
+		SessionServer_DisposeClient(&client);
+	}
+	
+	return result;
+}// unitTest002_Begin
+
+
+/*!
+Tests detaching in the way that a session does when its
+terminal state cannot be saved (see Local_DetachProcess()):
+with no state and an offset of zero, the next attachment
+must replay all of the output that the server still has,
+and the old saved state must not survive.
+
+Returns "true" if ALL assertions pass; "false" is
+returned if any fail, however messages should be
+printed for ALL assertion failures regardless.
+
+(2021.06)
+*/
+Boolean
+unitTest003_Begin	(char const*	inSocketPath)
+{
+	SessionServer_Result		clientResult = kSessionServer_ResultOK;
+	SessionServer_ClientRef		client = SessionServer_NewClient(inSocketPath, clientResult);
+	Boolean						result = true;
+	
+	
+	Console_TestAssertUpdate(result, nullptr != client, Console_WriteValue, "connection result", clientResult);
+	if (nullptr != client)
+	{
+		SessionServer_SessionID		sessionID = kSessionServer_InvalidSessionID;
+		SessionServer_Attachment	attachment;
+		std::string					output;
+		
+		
+		clientResult = SessionServer_ClientCreateSession(client, { "cat" }, {}, nullptr/* working directory */,
+															nullptr/* terminal settings */, 80, 24, sessionID);
+		Console_TestAssertUpdate(result, kSessionServer_ResultOK == clientResult, Console_WriteValue, "create result", clientResult);
+		clientResult = SessionServer_ClientAttach(client, sessionID, attachment);
+		Console_TestAssertUpdate(result, kSessionServer_ResultOK == clientResult, Console_WriteValue, "attach result", clientResult);
+		
+		// the first detachment saves a state; the second one does not
+		UNUSED_RETURN(SessionServer_Result)SessionServer_ClientWriteInput(client, sessionID, "one\n", 4);
+		Console_TestAssertUpdate(result, waitForOutput(attachment.outputFD, output, "one\r\none\r\n"),
+									Console_WriteValueStdString, "first output", output);
+		clientResult = SessionServer_DetachOutput(attachment.outputFD, attachment.outputOffset + output.size(), "STATE");
+		Console_TestAssertUpdate(result, kSessionServer_ResultOK == clientResult, Console_WriteValue, "detach result", clientResult);
+		Console_TestAssertUpdate(result, waitForOutput(attachment.outputFD, output, nullptr/* read to end */),
+									Console_WriteLine, "expected output to end after detach");
+		UNUSED_RETURN(int)close(attachment.outputFD);
+		UNUSED_RETURN(int)close(attachment.terminalFD);
+		
+		clientResult = SessionServer_ClientAttach(client, sessionID, attachment);
+		Console_TestAssertUpdate(result, kSessionServer_ResultOK == clientResult, Console_WriteValue, "second attach result", clientResult);
+		UNUSED_RETURN(SessionServer_Result)SessionServer_ClientWriteInput(client, sessionID, "two\n", 4);
+		output = attachment.replayedOutput;
+		Console_TestAssertUpdate(result, waitForOutput(attachment.outputFD, output, "two\r\ntwo\r\n"),
+									Console_WriteValueStdString, "second output", output);
+		clientResult = SessionServer_DetachOutput(attachment.outputFD, 0/* offset */, ""/* state */);
+		Console_TestAssertUpdate(result, kSessionServer_ResultOK == clientResult, Console_WriteValue, "second detach result", clientResult);
+		Console_TestAssertUpdate(result, waitForOutput(attachment.outputFD, output, nullptr/* read to end */),
+									Console_WriteLine, "expected output to end after second detach");
+		UNUSED_RETURN(int)close(attachment.outputFD);
+		UNUSED_RETURN(int)close(attachment.terminalFD);
+		
+		clientResult = SessionServer_ClientAttach(client, sessionID, attachment);
+		Console_TestAssertUpdate(result, kSessionServer_ResultOK == clientResult, Console_WriteValue, "third attach result", clientResult);
+		Console_TestAssertUpdate(result, attachment.savedState.empty(), Console_WriteValueStdString, "saved state", attachment.savedState);
+		Console_TestAssertUpdate(result, attachment.isReplayComplete, Console_WriteLine, "expected complete replay");
+		Console_TestAssertUpdate(result, "one\r\none\r\ntwo\r\ntwo\r\n" == attachment.replayedOutput,
+									Console_WriteValueStdString, "replayed output", attachment.replayedOutput);
+		Console_TestAssertUpdate(result, (attachment.replayedOutput.size() == attachment.outputOffset),
+									Console_WriteValue, "output offset", STATIC_CAST(attachment.outputOffset, SInt32));
+		
+		clientResult = SessionServer_ClientKillSession(client, sessionID);
+		Console_TestAssertUpdate(result, kSessionServer_ResultOK == clientResult, Console_WriteValue, "kill result", clientResult);
+		UNUSED_RETURN(int)close(attachment.outputFD);
+		UNUSED_RETURN(int)close(attachment.terminalFD);
+		SessionServer_DisposeClient(&client);
+	}
+	
+	return result;
+}// unitTest003_Begin
+
+
+/*!
+Waits up to 5 seconds for the process of a session to exit
+(and for all of its output to be read), and returns its
+final description.
+
+(2021.06)
+*/
+Boolean
+waitForExit		(SessionServer_ClientRef		inClient,
+				 SessionServer_SessionID		inSessionID,
+				 SessionServer_SessionInfo&		outInfo)
+{
+	Boolean		result = false;
+	
+	
+	for (int i = 0; ((false == result) && (i < 500)); ++i)
+	{
+		std::vector< SessionServer_SessionInfo >	sessions;
+		
+		
+		if (kSessionServer_ResultOK == SessionServer_ClientListSessions(inClient, sessions))
+		{
+			for (auto const&	info : sessions)
+			{
+				if ((inSessionID == info.sessionID) && (false == info.isRunning))
+				{
+					outInfo = info;
+					result = true;
+				}
+			}
+		}
+		unless (result)
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		}
+	}
+	return result;
+}// waitForExit
+
+
+/*!
+Reads the output of an attachment for up to 10 seconds, until
+the given text has arrived (or, if the text is nullptr, until
+the output ends).  Returns true only if that happened.
+
+(2021.06)
+*/
+Boolean
+waitForOutput	(int			inOutputFD,
+				 std::string&	inoutOutput,
+				 char const*	inExpectedOrNull)
+{
+	auto const	kDeadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+	Boolean		isEnded = false;
+	Boolean		result = false;
+	
+	
+	while ((false == result) && (false == isEnded) && (std::chrono::steady_clock::now() < kDeadline))
+	{
+		struct pollfd	pollInfo = { inOutputFD, POLLIN, 0 };
+		
+		
+		if (poll(&pollInfo, 1, 100/* milliseconds */) > 0)
+		{
+			char		buffer[kMy_ReadSize];
+			ssize_t		readResult = read(inOutputFD, buffer, sizeof(buffer));
+			
+			
+			if (readResult > 0)
+			{
+				inoutOutput.append(buffer, STATIC_CAST(readResult, size_t));
+			}
+			else if ((0 == readResult) || (EINTR != errno))
+			{
+				isEnded = true;
+			}
+		}
+		result = (nullptr == inExpectedOrNull)
+					? isEnded
+					: (std::string::npos != inoutOutput.find(inExpectedOrNull));
+	}
+	return result;
+}// waitForOutput
+
+
+/*!
+Sends as much of the pending bytes of a connection as
+possible without waiting.  A file descriptor that is to be
+passed with a message is sent along with the first byte of
+that message.
+
+(2021.06)
+*/
+void
+writeConnection		(My_ConnectionPtr	inConnectionPtr)
+{
+	std::string&	buffer = inConnectionPtr->writeBuffer;
+	
+	
+	while (inConnectionPtr->writeOffset < buffer.size())
+	{
+		Boolean const	kIsPassingFD = ((inConnectionPtr->passedFD >= 0) && (inConnectionPtr->passedFDOffset == inConnectionPtr->writeOffset));
+		size_t const	kEndOffset = ((inConnectionPtr->passedFD >= 0) && (inConnectionPtr->passedFDOffset > inConnectionPtr->writeOffset))
+										? inConnectionPtr->passedFDOffset // send the bytes before the descriptor separately
+										: buffer.size();
+		struct iovec	part = { CONST_CAST(buffer.data() + inConnectionPtr->writeOffset, char*), kEndOffset - inConnectionPtr->writeOffset };
+		union
+		{
+			struct cmsghdr	header;
+			char			bytes[CMSG_SPACE(sizeof(int))];
+		}				control;
+		struct msghdr	messageInfo;
+		ssize_t			sendResult = 0;
+		
+		
+		std::memset(&messageInfo, 0, sizeof(messageInfo));
+		messageInfo.msg_iov = &part;
+		messageInfo.msg_iovlen = 1;
+		if (kIsPassingFD)
+		{
+			struct cmsghdr*		controlPtr = nullptr;
+			
+			
+			std::memset(&control, 0, sizeof(control));
+			messageInfo.msg_control = control.bytes;
+			messageInfo.msg_controllen = sizeof(control.bytes);
+			controlPtr = CMSG_FIRSTHDR(&messageInfo);
+			controlPtr->cmsg_level = SOL_SOCKET;
+			controlPtr->cmsg_type = SCM_RIGHTS;
+			controlPtr->cmsg_len = CMSG_LEN(sizeof(int));
+			std::memcpy(CMSG_DATA(controlPtr), &inConnectionPtr->passedFD, sizeof(int));
+		}
+		sendResult = sendmsg(inConnectionPtr->socketFD, &messageInfo, MSG_NOSIGNAL);
+		if (sendResult > 0)
+		{
+			inConnectionPtr->writeOffset += STATIC_CAST(sendResult, size_t);
+			if (kIsPassingFD)
+			{
+				UNUSED_RETURN(int)close(inConnectionPtr->passedFD);
+				inConnectionPtr->passedFD = -1;
+			}
+		}
+		else if ((sendResult < 0) && (EINTR == errno))
+		{
+			// try again
+		}
+		else
+		{
+			if ((EAGAIN != errno) && (EWOULDBLOCK != errno))
+			{
+				inConnectionPtr->isClosing = true;
+			}
+			break;
+		}
+	}
+	
+	if (inConnectionPtr->writeOffset == buffer.size())
+	{
+		buffer.clear();
+		inConnectionPtr->writeOffset = 0;
+	}
+	else if (inConnectionPtr->writeOffset > kMy_ReadSize)
+	{
+		buffer.erase(0, inConnectionPtr->writeOffset);
+		inConnectionPtr->passedFDOffset -= std::min(inConnectionPtr->passedFDOffset, inConnectionPtr->writeOffset);
+		inConnectionPtr->writeOffset = 0;
+	}
+}// writeConnection
+
+
+/*!
+Writes the next piece of pending input to the terminal of
+a session.  The terminal is blocking (see spawnSession()),
+so this is only called when it is ready, and writes only a
+small piece; a process that stops reading its input cannot
+delay the server for long.
+
+(2021.06)
+*/
+void
+writeSessionInput	(My_Session&	inoutSession)
+{
+	if ((false == inoutSession.pendingInput.empty()) && (inoutSession.masterFD >= 0))
+	{
+		ssize_t		writeResult = write(inoutSession.masterFD, inoutSession.pendingInput.data(),
+										std::min(inoutSession.pendingInput.size(), kMy_InputPieceSize));
+		
+		
+		if (writeResult > 0)
+		{
+			inoutSession.pendingInput.erase(0, STATIC_CAST(writeResult, size_t));
+		}
+		else if ((writeResult < 0) && (EINTR != errno) && (EAGAIN != errno))
+		{
+			// the terminal is going away; output will end soon
+			inoutSession.pendingInput.clear();
+		}
+	}
+}// writeSessionInput
+
+} // anonymous namespace
+
+// BELOW IS REQUIRED NEWLINE TO END FILE
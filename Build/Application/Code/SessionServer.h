@@ -0,0 +1,258 @@
+/*!	\file SessionServer.h
+	\brief Keeps local sessions running in a separate process
+	so that windows (or the whole application) can close and
+	reattach later.
+	
+	The session server starts each process on a new pseudo-
+	terminal (see "ProcessSpawn.h") and is the only reader of
+	that device, so the process keeps running while no window
+	is attached.  Clients talk to the server over a Unix-domain
+	socket that only the current user can open.
+	
+	Attaching to a session gives the client its own socket for
+	the output of the process, plus a copy of the pseudo-
+	terminal device itself (passed over the socket), which the
+	client writes input to and resizes directly; so a window
+	of the application treats an attached session almost
+	exactly like a process that it spawned itself.
+	
+	The server does not interpret output.  Instead, a window
+	that detaches gives the server an opaque copy of its own
+	terminal state (for the application, the result of
+	Terminal_SerializeState(), so screen, scrollback, styles
+	and modes all survive), along with the number of bytes of
+	output that the state includes.  The server keeps the most
+	recent output of every session, and the next client that
+	attaches receives the saved state followed by all output
+	that the state does not include.
+	
+	The server is normally a separate program (see the file
+	"SessionServer/Code/MainEntryPoint.cp"); but for testing,
+	it can also run on a thread of the current process.
+*/
+/*###############################################################
+
+	MacTerm
+		© 1998-2021 by Kevin Grant.
+		© 2001-2003 by Ian Anderson.
+		© 1986-1994 University of Illinois Board of Trustees
+		(see About box for full list of U of I contributors).
+	
+	This program is free software; you can redistribute it or
+	modify it under the terms of the GNU General Public License
+	as published by the Free Software Foundation; either version
+	2 of the License, or (at your option) any later version.
+	
+	This program is distributed in the hope that it will be
+	useful, but WITHOUT ANY WARRANTY; without even the implied
+	warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+	PURPOSE.  See the GNU General Public License for more
+	details.
+	
+	You should have received a copy of the GNU General Public
+	License along with this program; if not, write to:
+	
+		Free Software Foundation, Inc.
+		59 Temple Place, Suite 330
+		Boston, MA  02111-1307
+		USA
+
+###############################################################*/
+
+#include <UniversalDefines.h>
+
+#pragma once
+
+// standard-C++ includes
+#include <string>
+#include <vector>
+
+// UNIX includes
+extern "C"
+{
+#	include <termios.h>
+#	include <sys/types.h>
+}
+
+// Mac includes
+#include <CoreServices/CoreServices.h>
+
+
+
+#pragma mark Constants
+
+/*!
+Possible return values from SessionServer module routines.
+*/
+typedef long SessionServer_Result;
+enum
+{
+	kSessionServer_ResultOK						= 0,	//!< no error
+	kSessionServer_ResultParameterError			= 1,	//!< invalid input (e.g. null reference or empty command line)
+	kSessionServer_ResultSocketError			= 2,	//!< the socket could not be created, bound or connected
+	kSessionServer_ResultServerAlreadyRunning	= 3,	//!< another server is already listening on the socket
+	kSessionServer_ResultProtocolError			= 4,	//!< a message was not understood (e.g. different program versions)
+	kSessionServer_ResultNoSuchSession			= 5,	//!< the session ID does not match any session of the server
+	kSessionServer_ResultSpawnError				= 6,	//!< the process or its pseudo-terminal could not be created
+	kSessionServer_ResultDisconnected			= 7		//!< the connection to the server was closed
+};
+
+typedef UInt32 SessionServer_SessionID;
+enum
+{
+	kSessionServer_InvalidSessionID = 0
+};
+
+#pragma mark Types
+
+typedef struct SessionServer_OpaqueServer*		SessionServer_Ref;
+typedef struct SessionServer_OpaqueClient*		SessionServer_ClientRef;
+
+/*!
+Describes one session of a server.
+*/
+struct SessionServer_SessionInfo
+{
+	SessionServer_SessionID		sessionID;				//!< unique for the life of the server
+	pid_t						processID;				//!< process that was spawned for the session
+	UInt16						columnCount;			//!< current width of the terminal
+	UInt16						rowCount;				//!< current height of the terminal
+	Boolean						isRunning;				//!< false once the process has exited and all of its output has been read
+	SInt32						exitStatus;				//!< if not running, the exit status (128 + signal number if killed by a signal; -1 if unknown)
+	UInt32						attachedClientCount;	//!< number of clients that receive the output of the session
+	std::string					commandLine;			//!< arguments of the process, separated by spaces
+};
+
+/*!
+What a client needs in order to take over a session (see
+SessionServer_ClientAttach()).  The client must close both
+file descriptors when it no longer needs them.
+*/
+struct SessionServer_Attachment
+{
+	int				outputFD;			//!< socket that receives all further output of the process, in order; reaches its end when the process exits
+	int				terminalFD;			//!< copy of the pseudo-terminal master for input, resizing and modes; -1 if the process has exited
+	pid_t			processID;			//!< process that was spawned for the session
+	std::string		deviceName;			//!< name of the pseudo-terminal device (e.g. "/dev/ttys004")
+	std::string		savedState;			//!< from the client that detached most recently (see SessionServer_DetachOutput()); empty if none
+	std::string		replayedOutput;		//!< output that the saved state does not include; process it before reading "outputFD"
+	UInt64			outputOffset;		//!< total bytes of output before the first byte that will be read from "outputFD"
+	Boolean			isReplayComplete;	//!< false if older output was discarded (then the replay starts at a line boundary)
+	
+	SessionServer_Attachment ()
+	:
+	outputFD(-1),
+	terminalFD(-1),
+	processID(-1),
+	deviceName(),
+	savedState(),
+	replayedOutput(),
+	outputOffset(0),
+	isReplayComplete(true)
+	{
+	}
+};
+
+
+
+#pragma mark Public Methods
+
+//!\name Module Tests
+//@{
+
+void
+	SessionServer_RunTests					();
+
+//@}
+
+//!\name Running a Server
+//@{
+
+// RETURNS A PATH IN A PRIVATE TEMPORARY DIRECTORY OF THE CURRENT USER
+std::string
+	SessionServer_ReturnDefaultSocketPath	();
+
+SessionServer_Ref
+	SessionServer_New						(char const*						inSocketPath,
+											 SessionServer_Result&				outResult);
+
+// KILLS ANY SESSIONS THAT ARE STILL RUNNING
+void
+	SessionServer_Dispose					(SessionServer_Ref*					inoutRefPtr);
+
+// DOES NOT RETURN UNTIL SessionServer_Stop() IS CALLED
+SessionServer_Result
+	SessionServer_Run						(SessionServer_Ref					inServer);
+
+// SAFE TO CALL FROM ANY THREAD OR SIGNAL HANDLER
+void
+	SessionServer_Stop						(SessionServer_Ref					inServer);
+
+//@}
+
+//!\name Connecting to a Server
+//@{
+
+SessionServer_ClientRef
+	SessionServer_NewClient					(char const*						inSocketPath,
+											 SessionServer_Result&				outResult);
+
+// ATTACHMENTS ARE NOT AFFECTED
+void
+	SessionServer_DisposeClient				(SessionServer_ClientRef*			inoutRefPtr);
+
+//@}
+
+//!\name Managing Sessions
+//@{
+
+SessionServer_Result
+	SessionServer_ClientCreateSession		(SessionServer_ClientRef			inClient,
+											 std::vector< std::string > const&	inArguments,
+											 std::vector< std::string > const&	inEnvironmentSettings,
+											 char const*						inWorkingDirectoryOrNull,
+											 struct termios const*				inTerminalControlOrNull,
+											 UInt16								inColumnCount,
+											 UInt16								inRowCount,
+											 SessionServer_SessionID&			outSessionID);
+
+SessionServer_Result
+	SessionServer_ClientKillSession			(SessionServer_ClientRef			inClient,
+											 SessionServer_SessionID			inSessionID);
+
+SessionServer_Result
+	SessionServer_ClientListSessions		(SessionServer_ClientRef			inClient,
+											 std::vector< SessionServer_SessionInfo >&	outSessions);
+
+//@}
+
+//!\name Using Sessions
+//@{
+
+// OPENS A NEW CONNECTION FOR THE OUTPUT; SESSIONS CAN HAVE MORE THAN ONE ATTACHMENT
+SessionServer_Result
+	SessionServer_ClientAttach				(SessionServer_ClientRef			inClient,
+											 SessionServer_SessionID			inSessionID,
+											 SessionServer_Attachment&			outAttachment);
+
+SessionServer_Result
+	SessionServer_ClientResize				(SessionServer_ClientRef			inClient,
+											 SessionServer_SessionID			inSessionID,
+											 UInt16								inColumnCount,
+											 UInt16								inRowCount);
+
+SessionServer_Result
+	SessionServer_ClientWriteInput			(SessionServer_ClientRef			inClient,
+											 SessionServer_SessionID			inSessionID,
+											 void const*						inBytes,
+											 size_t								inByteCount);
+
+// THE SERVER ENDS THE OUTPUT SOON AFTER; THE CALLER STILL CLOSES THE DESCRIPTORS
+SessionServer_Result
+	SessionServer_DetachOutput				(int								inOutputFD,
+											 UInt64								inOutputOffset,
+											 std::string const&					inSavedState);
+
+//@}
+
+// BELOW IS REQUIRED NEWLINE TO END FILE
@@ -33,6 +33,9 @@
 #include "SixelDecoder.h"
 #include <UniversalDefines.h>
 
+// standard-C includes
+#include <cmath>
+
 // Mac includes
 #include <ApplicationServices/ApplicationServices.h>
 #include <CoreServices/CoreServices.h>
@@ -79,29 +82,6 @@ currentState(kStateInitial)
 }// SixelDecoder_StateMachine default constructor
 
 
-/*!
-Destructor.
-
-(2017.12)
-*/
-SixelDecoder_StateMachine::
-~SixelDecoder_StateMachine ()
-{
-	if (nullptr != colorCreator)
-	{
-		Block_release(colorCreator);
-	}
-	if (nullptr != colorChooser)
-	{
-		Block_release(colorChooser);
-	}
-	if (nullptr != sixelHandler)
-	{
-		Block_release(sixelHandler);
-	}
-}// SixelDecoder_StateMachine destructor
-
-
 /*!
 Returns the values of the (up to 6) pixels indicated by the given
 raw Sixel data.  The exact meaning of the pixels, such as shape,
@@ -222,7 +202,7 @@ handleCommandCharacter	(UInt8		inRawCommandCharacter,
 
 /*!
 Returns the state machine to its initial state and clears stored
-values, except for blocks installed by setColorChooser(), etc.
+values, except for handlers installed by setColorChooser(), etc.
 
 (2017.11)
 */
@@ -246,17 +226,17 @@ reset ()
 	aspectRatioV = 0;
 	suggestedImageWidth = 0;
 	suggestedImageHeight = 0;
-	// (do not reset any of the blocks here)
+	// (do not reset any of the handlers here)
 	currentState = kStateInitial;
 }// SixelDecoder_StateMachine::reset
 
 
 /*!
-Installs a block that will be invoked continuously during parsing
+Installs a handler that will be invoked continuously during parsing
 whenever a color is requested.
 
-If this is called more than once, any previous block is released
-and no longer invoked by the decoder.
+If this is called more than once, any previous handler is
+destroyed and no longer invoked by the decoder.
 
 (2017.12)
 */
@@ -264,20 +244,16 @@ void
 SixelDecoder_StateMachine::
 setColorChooser		(SixelDecoder_ColorChooser		inHandler)
 {
-	if (nullptr != this->colorChooser)
-	{
-		Block_release(this->colorChooser);
-	}
-	this->colorChooser = Block_copy(inHandler);
+	this->colorChooser = inHandler;
 }// setColorChooser
 
 
 /*!
-Installs a block that will be invoked continuously during parsing
+Installs a handler that will be invoked continuously during parsing
 whenever a new color is defined.
 
-If this is called more than once, any previous block is released
-and no longer invoked by the decoder.
+If this is called more than once, any previous handler is
+destroyed and no longer invoked by the decoder.
 
 (2017.12)
 */
@@ -285,21 +261,17 @@ void
 SixelDecoder_StateMachine::
 setColorCreator		(SixelDecoder_ColorCreator	inHandler)
 {
-	if (nullptr != this->colorCreator)
-	{
-		Block_release(this->colorCreator);
-	}
-	this->colorCreator = Block_copy(inHandler);
+	this->colorCreator = inHandler;
 }// setColorCreator
 
 
 /*!
-Installs a block that will be invoked continuously during parsing
+Installs a handler that will be invoked continuously during parsing
 whenever a sixel is defined (either as a single value or a
 repetition sequence).
 
-If this is called more than once, any previous block is released
-and no longer invoked by the decoder.
+If this is called more than once, any previous handler is
+destroyed and no longer invoked by the decoder.
 
 (2017.12)
 */
@@ -307,11 +279,7 @@ void
 SixelDecoder_StateMachine::
 setSixelHandler		(SixelDecoder_SixelHandler		inHandler)
 {
-	if (nullptr != this->sixelHandler)
-	{
-		Block_release(this->sixelHandler);
-	}
-	this->sixelHandler = Block_copy(inHandler);
+	this->sixelHandler = inHandler;
 }// setSixelHandler
 
 
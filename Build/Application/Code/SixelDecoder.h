@@ -36,6 +36,7 @@
 
 // standard-C++ includes
 #include <bitset>
+#include <functional>
 #include <string>
 #include <vector>
 
@@ -60,15 +61,18 @@ enum SixelDecoder_ColorType
 #pragma mark Types
 
 /*!
-A “color chooser block” is invoked each time the parser
+A “color chooser” is invoked each time the parser
 encounters a request for a color.  See also the
-SixelDecoder_ColorCreator block type for creating and
+SixelDecoder_ColorCreator type for creating and
 selecting arbitrary colors.
+
+All callbacks are function objects so that a block, a
+lambda or a function may be given.
 */
-typedef void (^SixelDecoder_ColorChooser)(UInt16 inZeroBasedIndex);
+typedef std::function< void (UInt16 inZeroBasedIndex) >		SixelDecoder_ColorChooser;
 
 /*!
-A “color creator block” is invoked once for each new color
+A “color creator” is invoked once for each new color
 definition encountered by the decoder.  Typically this is
 an opportunity to also create the color in a graphics space,
 e.g. defining an equivalent NSColor object.
@@ -84,10 +88,10 @@ and their ranges match the Sixel specification.  (Currently
 this means a “hue” is 0 to 360 degrees and any other type of
 value is between 0 and 100 percent intensity.)
 */
-typedef void (^SixelDecoder_ColorCreator)(UInt16, SixelDecoder_ColorType, UInt16, UInt16, UInt16);
+typedef std::function< void (UInt16, SixelDecoder_ColorType, UInt16, UInt16, UInt16) >		SixelDecoder_ColorCreator;
 
 /*!
-A “sixel handler block” is invoked once for each raw sixel
+A “sixel handler” is invoked once for each raw sixel
 data character or repetition sequence, along with the count
 of the repetition (at least 1).  Use getSixelBits() on the
 raw value to find the top-to-bottom sixel on/off sequences,
@@ -102,7 +106,7 @@ rely on most of them (such as "suggestedImageWidth").
 
 IMPORTANT:	The graphics cursor 
 */
-typedef void (^SixelDecoder_SixelHandler)(UInt8 inRawCharacter, UInt16 inRepeatCount);
+typedef std::function< void (UInt8 inRawCharacter, UInt16 inRepeatCount) >		SixelDecoder_SixelHandler;
 
 /*!
 Manages the state of decoding a stream of Sixel data.
@@ -148,9 +152,6 @@ struct SixelDecoder_StateMachine
 	//! Constructs state machine.
 	SixelDecoder_StateMachine ();
 	
-	//! Frees blocks stored in the state machine.
-	~SixelDecoder_StateMachine ();
-	
 	//! Returns values of the (up to 6) pixels indicated by a raw Sixel data value.
 	static void
 	getSixelBits	(UInt8, std::bitset<6>&);
@@ -209,10 +210,10 @@ protected:
 	handleCommandCharacter	(UInt8, UInt16 = 0);
 
 private:
-	//! Copy is not allowed (blocks are copied once to start).
+	//! Copy is not allowed (callbacks are copied once to start).
 	SixelDecoder_StateMachine (SixelDecoder_StateMachine const&) = delete;
 	
-	//! Copy is not allowed (blocks are copied once to start).
+	//! Copy is not allowed (callbacks are copied once to start).
 	SixelDecoder_StateMachine&
 	operator =(SixelDecoder_StateMachine const&) = delete;
 	
@@ -4,6 +4,12 @@
 	Creating an object of this type does not initiate a capture
 	to a file; it allows you to retain settings, and then
 	initiate or terminate captures indefinitely.
+	
+	Captured data is appended to a memory buffer and written
+	to the file by a background queue, so the thread that is
+	parsing terminal data does not wait for the disk (unless
+	the disk falls very far behind, at which point writers
+	are briefly blocked so that memory use stays bounded).
 */
 /*###############################################################
 
@@ -55,12 +61,56 @@ enum StreamCapture_Result
 	kStreamCapture_ResultParameterError = -2,	//!< invalid input (e.g. a null pointer)
 };
 
+/*!
+What a capture contains.  Rendered text is written by the
+terminal emulator as it echoes characters (see
+StreamCapture_WriteUTF8Data()); the other types are written
+from the bytes received from the session BEFORE emulation
+(see StreamCapture_WriteReceivedData()).
+*/
+enum StreamCapture_Content
+{
+	kStreamCapture_ContentRenderedText = 0,		//!< text echoed by the emulator, with line endings translated
+	kStreamCapture_ContentRawBytes = 1,			//!< exact bytes received, including all escape sequences
+	kStreamCapture_ContentPlainText = 2			//!< bytes received, with escape sequences and most controls removed
+};
+
+/*!
+Compression applied to captured data as it is written.
+*/
+enum StreamCapture_Compression
+{
+	kStreamCapture_CompressionNone = 0,		//!< file contains plain text
+	kStreamCapture_CompressionGzip = 1		//!< file is a gzip stream (".gz" is appended to the file name if necessary)
+};
+
+/*!
+When to force captured data to the disk (with fsync()).
+This only affects how much data could be lost if the
+computer crashes; data is always written in the
+background regardless.
+*/
+enum StreamCapture_SyncPolicy
+{
+	kStreamCapture_SyncPolicyOnClose = 0,	//!< sync when a file is closed (capture ends or file is rotated)
+	kStreamCapture_SyncPolicyAlways = 1,	//!< sync after each buffer is written (safest, but slowest)
+	kStreamCapture_SyncPolicyNever = 2		//!< never sync explicitly; the system decides
+};
+
 typedef struct StreamCapture_OpaqueStructure*	StreamCapture_Ref;	//!< represents a capture object
 
 
 
 #pragma mark Public Methods
 
+//!\name Module Tests
+//@{
+
+void
+	StreamCapture_RunTests				();
+
+//@}
+
 //!\name Creating and Destroying Stream Capture Objects
 //@{
 
@@ -85,6 +135,14 @@ void
 Boolean
 	StreamCapture_InProgress			(StreamCapture_Ref			inRef);
 
+Boolean
+	StreamCapture_IsCapturingRenderedText	(StreamCapture_Ref		inRef);
+
+void
+	StreamCapture_WriteReceivedData		(StreamCapture_Ref			inRef,
+										 UInt8 const*				inBuffer,
+										 size_t						inLength);
+
 void
 	StreamCapture_WriteUTF8Data			(StreamCapture_Ref			inRef,
 										 UInt8 const*				inBuffer,
@@ -92,4 +150,26 @@ void
 
 //@}
 
+//!\name Capture Settings (Apply to the Next Capture That Begins)
+//@{
+
+void
+	StreamCapture_SetCompression		(StreamCapture_Ref			inRef,
+										 StreamCapture_Compression	inCompression);
+
+void
+	StreamCapture_SetContent			(StreamCapture_Ref			inRef,
+										 StreamCapture_Content		inContent);
+
+void
+	StreamCapture_SetRotation			(StreamCapture_Ref			inRef,
+										 UInt64						inMaximumBytesPerFile,
+										 CFTimeInterval				inMaximumSecondsPerFile);
+
+void
+	StreamCapture_SetSyncPolicy			(StreamCapture_Ref			inRef,
+										 StreamCapture_SyncPolicy	inPolicy);
+
+//@}
+
 // BELOW IS REQUIRED NEWLINE TO END FILE
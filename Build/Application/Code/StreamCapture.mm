@@ -33,6 +33,21 @@
 #import "StreamCapture.h"
 #import <UniversalDefines.h>
 
+// standard-C includes
+#import <cerrno>
+#import <cstring>
+
+// standard-C++ includes
+#import <atomic>
+#import <mutex>
+#import <string>
+#import <vector>
+
+// Unix includes
+#import <fcntl.h>
+#import <unistd.h>
+#import <zlib.h>
+
 // Mac includes
 #import <ApplicationServices/ApplicationServices.h>
 #import <CoreServices/CoreServices.h>
@@ -48,30 +63,157 @@
 
 
 
+#pragma mark Constants
+namespace {
+
+size_t const			kMy_ChunkSize = 256 * 1024;			//!< pending data is sent to the writer once it reaches this many bytes
+long const				kMy_MaximumPendingChunks = 32;		//!< writers block once this many chunks are waiting for the disk
+size_t const			kMy_CompressionBufferSize = 64 * 1024;	//!< size of each block of compressed output
+UInt64 const			kMy_FlushIntervalNanoseconds = NSEC_PER_SEC;	//!< partial chunks are written at least this often
+
+} // anonymous namespace
+
 #pragma mark Types
 namespace {
 
-struct My_StreamCapture
+typedef std::vector< UInt8 >	My_ByteList;
+
+/*!
+Settings that apply to each capture when it begins.
+*/
+struct My_CaptureSettings
+{
+	My_CaptureSettings ()
+	: content(kStreamCapture_ContentRenderedText), compression(kStreamCapture_CompressionNone),
+	  syncPolicy(kStreamCapture_SyncPolicyOnClose), maximumBytesPerFile(0), maximumSecondsPerFile(0)
+	{
+	}
+	
+	StreamCapture_Content		content;				//!< where data comes from
+	StreamCapture_Compression	compression;			//!< how data is encoded in the file
+	StreamCapture_SyncPolicy	syncPolicy;				//!< when fsync() is called
+	UInt64						maximumBytesPerFile;	//!< if nonzero, uncompressed data size that causes a new file to begin
+	CFTimeInterval				maximumSecondsPerFile;	//!< if nonzero, age of a file that causes a new file to begin
+};
+
+/*!
+A lightweight scanner that removes terminal escape sequences
+and most control characters from a byte stream, for captures
+of type "kStreamCapture_ContentPlainText".  This does not
+emulate a terminal (e.g. cursor movement is not applied) but
+it is far cheaper than running the emulator.
+
+Since input arrives in fragments, state persists between
+calls to stripBytes().  Bytes in the 8-bit range are kept as
+text (in UTF-8 they are parts of multi-byte sequences).
+*/
+struct My_EscapeStripper
 {
 public:
-	My_StreamCapture	(Session_LineEnding);
-	~My_StreamCapture ();
+	enum State
+	{
+		kStateText						= 0,	//!< printable data is copied to the output
+		kStateEscape					= 1,	//!< ESC was seen
+		kStateEscapeIntermediate		= 2,	//!< ESC and intermediate bytes were seen; waiting for final byte
+		kStateControlSequence			= 3,	//!< CSI was seen; waiting for final byte
+		kStateCommandString				= 4,	//!< OSC, DCS, APC, PM or SOS was seen; waiting for terminator
+		kStateCommandStringEscape		= 5		//!< ESC was seen inside a command string (possible string terminator)
+	};
+	
+	My_EscapeStripper ()
+	: currentState(kStateText)
+	{
+	}
 	
 	void
-	endCapture ()
+	reset ()
 	{
-		this->captureFileHandle = nil;
+		currentState = kStateText;
 	}
 	
 	void
-	writeNewLine ()
+	stripBytes	(UInt8 const*, size_t, std::string const&, My_ByteList&);
+	
+	State	currentState;	//!< where the scanner is in a sequence
+};
+
+/*!
+The state of the file that is being written.  This is
+ONLY accessed from the writer queue.
+*/
+struct My_CaptureFile
+{
+	My_CaptureFile ()
+	: fileDescriptor(-1), compressionStream(), compressionBuffer(), bytesWritten(0), openTime(0), rotationCount(0)
 	{
-		// IMPORTANT: should call within @try...@catch
-		[this->captureFileHandle writeData:[BRIDGE_CAST(this->writtenNewLineSequence.returnCFStringRef(), NSString*) dataUsingEncoding:NSUTF8StringEncoding]];
 	}
 	
-	NSFileHandle* __strong	captureFileHandle;			//!< target for writing data (retained)
-	CFRetainRelease			writtenNewLineSequence;		//!< the string to write for new-lines
+	int				fileDescriptor;		//!< open file, or -1
+	z_stream		compressionStream;	//!< used only for kStreamCapture_CompressionGzip
+	My_ByteList		compressionBuffer;	//!< holds compressed output before it is written
+	UInt64			bytesWritten;		//!< uncompressed bytes written to the current file
+	CFAbsoluteTime	openTime;			//!< when the current file was opened
+	UInt32			rotationCount;		//!< number of files that have been closed by rotation
+};
+
+struct My_StreamCapture
+{
+public:
+	My_StreamCapture	(Session_LineEnding);
+	~My_StreamCapture ();
+	
+	template < typename append_functor >
+	void
+	appendWith	(append_functor);
+	
+	void
+	appendRawData	(UInt8 const*, size_t);
+	
+	void
+	appendStrippedData	(UInt8 const*, size_t);
+	
+	void
+	appendTranslatedData	(UInt8 const*, size_t);
+	
+	Boolean
+	beginCapture	(CFURLRef);
+	
+	void
+	endCapture ();
+	
+	// writer-queue methods
+	
+	Boolean
+	closeFile ();
+	
+	Boolean
+	openFile ();
+	
+	Boolean
+	rotateFileIfNecessary	(size_t);
+	
+	Boolean
+	writeToDisk		(UInt8 const*, size_t);
+	
+	Boolean
+	writeToFile		(UInt8 const*, size_t);
+	
+	My_CaptureSettings		nextSettings;				//!< settings to use when the next capture begins
+	My_CaptureSettings		settings;					//!< settings of the capture in progress
+	std::string				writtenNewLineSequence;		//!< the bytes to write for new-lines
+	std::string				filePath;					//!< path of the file that is being written
+	std::string				rotatedFilePathPrefix;		//!< path of rotated files, up to the file number
+	std::string				rotatedFilePathSuffix;		//!< path of rotated files, after the file number
+	std::atomic< bool >		isCapturing;				//!< true if a capture is in progress
+	std::atomic< bool >		writeFailed;				//!< set by the writer queue if the file cannot be written
+	std::mutex				pendingDataLock;			//!< protects "pendingData"
+	My_ByteList				pendingData;				//!< translated data that has not been sent to the writer queue
+	My_EscapeStripper		escapeStripper;				//!< for plain-text captures, removes escape sequences (protected by "pendingDataLock")
+	dispatch_queue_t		writerQueue;				//!< serial queue that owns "captureFile"
+	dispatch_semaphore_t	chunkSlots;					//!< counts chunks that may still be queued; provides backpressure
+	dispatch_group_t		chunksInFlight;				//!< entered for each chunk taken from "pendingData", left once it is written
+	dispatch_source_t		flushTimer;					//!< periodically writes partial chunks (and checks rotation times)
+	My_CaptureFile			captureFile;				//!< writer state
 };
 typedef My_StreamCapture*			My_StreamCapturePtr;
 typedef My_StreamCapture const*		My_StreamCaptureConstPtr;
@@ -84,6 +226,14 @@ typedef LockAcquireRelease< StreamCapture_Ref, My_StreamCapture >		My_StreamCapt
 #pragma mark Internal Method Prototypes
 namespace {
 
+void		flushPendingData			(My_StreamCapturePtr);
+Boolean		inflateGzipFile				(std::string const&, My_ByteList&);
+void		queueChunk					(My_StreamCapturePtr, My_ByteList&);
+Boolean		unitTest_Compression_000	();
+Boolean		unitTest_EscapeStripper_000	();
+Boolean		unitTest_EscapeStripper_001	();
+Boolean		unitTest_Rotation_000		();
+
 } // anonymous namespace
 
 #pragma mark Variables
@@ -97,6 +247,32 @@ My_StreamCapturePtrLocker&		gStreamCapturePtrLocks ()	{ static My_StreamCaptureP
 
 #pragma mark Public Methods
 
+/*!
+A unit test for this module.  This should always
+be run before a release, after any substantial
+changes are made, or if you suspect bugs!  It
+should also be EXPANDED as new functionality is
+proposed (ideally, a test is written before the
+functionality is added).
+
+(2021.06)
+*/
+void
+StreamCapture_RunTests ()
+{
+	UInt16		totalTests = 0;
+	UInt16		failedTests = 0;
+	
+	
+	++totalTests; if (false == unitTest_EscapeStripper_000()) ++failedTests;
+	++totalTests; if (false == unitTest_EscapeStripper_001()) ++failedTests;
+	++totalTests; if (false == unitTest_Rotation_000()) ++failedTests;
+	++totalTests; if (false == unitTest_Compression_000()) ++failedTests;
+	
+	Console_WriteUnitTestReport("Stream Capture", failedTests, totalTests);
+}// RunTests
+
+
 /*!
 Creates a new object to manage captures to a file, but does
 not initiate any captures.  Returns "nullptr" if any problem
@@ -155,6 +331,10 @@ Initiates a capture to a file, returning "true" only if
 successful.  Any capture in progress is automatically
 ended.
 
+The most recent settings (such as compression) are used
+for the new capture; see StreamCapture_SetCompression(),
+StreamCapture_SetRotation() and StreamCapture_SetSyncPolicy().
+
 (4.0)
 */
 Boolean
@@ -171,26 +351,10 @@ StreamCapture_Begin		(StreamCapture_Ref		inRef,
 	else
 	{
 		My_StreamCaptureAutoLocker	ptr(gStreamCapturePtrLocks(), inRef);
-		NSError*					error = nil;
 		
 		
 		ptr->endCapture();
-		
-		ptr->captureFileHandle = [NSFileHandle fileHandleForWritingToURL:BRIDGE_CAST(inFileToOverwrite, NSURL*)
-																			error:&error];
-		if (nil != error)
-		{
-			Console_Warning(Console_WriteValueCFString, "failed to create capture-file handle for URL, error", BRIDGE_CAST([error localizedDescription], CFStringRef));
-		}
-		else if (nil == ptr->captureFileHandle)
-		{
-			Console_Warning(Console_WriteValueCFString, "failed to create capture-file handle for URL", CFURLGetString(inFileToOverwrite));
-		}
-		else
-		{
-			[ptr->captureFileHandle truncateFileAtOffset:0];
-			result = true;
-		}
+		result = ptr->beginCapture(inFileToOverwrite);
 	}
 	
 	return result;
@@ -199,7 +363,8 @@ StreamCapture_Begin		(StreamCapture_Ref		inRef,
 
 /*!
 Terminates any file capture in progress that is associated
-with the specified object.
+with the specified object.  All captured data is written
+and the file is closed before this returns.
 
 (4.0)
 */
@@ -226,15 +391,178 @@ StreamCapture_InProgress	(StreamCapture_Ref		inRef)
 	Boolean						result = false;
 	
 	
-	result = (nil != ptr->captureFileHandle);
+	result = ptr->isCapturing;
 	return result;
 }// InProgress
 
 
+/*!
+Returns "true" only if there is a file capture in progress
+that expects StreamCapture_WriteUTF8Data() to be called
+with echoed text.  The terminal uses this to avoid the cost
+of converting text when nothing needs it.
+
+Like StreamCapture_WriteUTF8Data(), this is called very
+frequently so it does not acquire a lock.
+
+(2021.06)
+*/
+Boolean
+StreamCapture_IsCapturingRenderedText	(StreamCapture_Ref		inRef)
+{
+	My_StreamCapture*	ptr = (My_StreamCapture*)inRef; // TEMPORARY (see StreamCapture_WriteUTF8Data())
+	Boolean				result = false;
+	
+	
+	if (nullptr != ptr)
+	{
+		result = ((ptr->isCapturing) && (kStreamCapture_ContentRenderedText == ptr->settings.content));
+	}
+	return result;
+}// IsCapturingRenderedText
+
+
+/*!
+Specifies the compression of future captures; this has
+no effect on any capture in progress.
+
+(2021.06)
+*/
+void
+StreamCapture_SetCompression	(StreamCapture_Ref			inRef,
+								 StreamCapture_Compression	inCompression)
+{
+	My_StreamCaptureAutoLocker	ptr(gStreamCapturePtrLocks(), inRef);
+	
+	
+	ptr->nextSettings.compression = inCompression;
+}// SetCompression
+
+
+/*!
+Specifies the data source of future captures; this has
+no effect on any capture in progress.
+
+For raw or plain-text content, the terminal must call
+StreamCapture_WriteReceivedData(); calls to the routine
+StreamCapture_WriteUTF8Data() are then ignored.
+
+(2021.06)
+*/
+void
+StreamCapture_SetContent	(StreamCapture_Ref			inRef,
+							 StreamCapture_Content		inContent)
+{
+	My_StreamCaptureAutoLocker	ptr(gStreamCapturePtrLocks(), inRef);
+	
+	
+	ptr->nextSettings.content = inContent;
+}// SetContent
+
+
+/*!
+Specifies when future captures should close their current
+file and continue in a new file.  A value of zero disables
+that type of limit.  The byte limit applies to data before
+any compression.
+
+When a file is rotated, it is renamed to include a number
+(for example, “capture.txt” becomes “capture.1.txt”) and a
+new file is started with the original name.  Numbers
+increase over time, so the highest number is the newest
+of the rotated files.
+
+This has no effect on any capture in progress.
+
+(2021.06)
+*/
+void
+StreamCapture_SetRotation	(StreamCapture_Ref		inRef,
+							 UInt64					inMaximumBytesPerFile,
+							 CFTimeInterval			inMaximumSecondsPerFile)
+{
+	My_StreamCaptureAutoLocker	ptr(gStreamCapturePtrLocks(), inRef);
+	
+	
+	ptr->nextSettings.maximumBytesPerFile = inMaximumBytesPerFile;
+	ptr->nextSettings.maximumSecondsPerFile = inMaximumSecondsPerFile;
+}// SetRotation
+
+
+/*!
+Specifies when future captures should force data to the
+disk; this has no effect on any capture in progress.
+
+(2021.06)
+*/
+void
+StreamCapture_SetSyncPolicy		(StreamCapture_Ref			inRef,
+								 StreamCapture_SyncPolicy	inPolicy)
+{
+	My_StreamCaptureAutoLocker	ptr(gStreamCapturePtrLocks(), inRef);
+	
+	
+	ptr->nextSettings.syncPolicy = inPolicy;
+}// SetSyncPolicy
+
+
+/*!
+Writes bytes exactly as they were received from a session
+(before terminal emulation) to the capture file of the given
+object.  Has no effect if the stream is invalid or closed, or
+if the capture is of type "kStreamCapture_ContentRenderedText".
+
+For "kStreamCapture_ContentRawBytes", the data is copied to
+the capture buffer without changes.  For the content type
+"kStreamCapture_ContentPlainText", escape sequences and
+control characters (other than tabs and new-lines) are
+removed as the data is copied; sequences may span calls.
+
+No memory is allocated for each call; the data is appended
+to the capture buffer directly.
+
+(2021.06)
+*/
+void
+StreamCapture_WriteReceivedData		(StreamCapture_Ref		inRef,
+									 UInt8 const*			inBuffer,
+									 size_t					inLength)
+{
+	My_StreamCapture*	ptr = (My_StreamCapture*)inRef; // TEMPORARY (see StreamCapture_WriteUTF8Data())
+	
+	
+	if ((nullptr == ptr) || (false == ptr->isCapturing) ||
+		(kStreamCapture_ContentRenderedText == ptr->settings.content))
+	{
+		// ignore
+	}
+	else if (ptr->writeFailed)
+	{
+		// write errors are not expected; if there is a problem,
+		// abort the entire capture (closing the file if necessary)
+		ptr->endCapture();
+		Sound_StandardAlert();
+		// INCOMPLETE: should trigger user-visible error message
+	}
+	else if (inLength > 0)
+	{
+		if (kStreamCapture_ContentPlainText == ptr->settings.content)
+		{
+			ptr->appendStrippedData(inBuffer, inLength);
+		}
+		else
+		{
+			ptr->appendRawData(inBuffer, inLength);
+		}
+	}
+}// WriteReceivedData
+
+
 /*!
 Writes the specified text, in UTF-8 encoding, to the capture
 file of the given object.  Has no effect if the stream is
-invalid or closed.
+invalid or closed, or if the capture is not of the type
+"kStreamCapture_ContentRenderedText".
 
 The data must already be processed as valid UTF-8; this
 routine does not check for incomplete character sequences.
@@ -242,6 +570,10 @@ routine does not check for incomplete character sequences.
 The data should use line endings consistent with the settings
 given at construction time, since translation may occur.
 
+The data is only copied into a buffer; the file is written
+from a background queue.  If a previous write failed, the
+capture ends and the user is alerted.
+
 (4.0)
 */
 void
@@ -253,92 +585,25 @@ StreamCapture_WriteUTF8Data		(StreamCapture_Ref		inRef,
 	My_StreamCapture*				ptr = (My_StreamCapture*)inRef; // TEMPORARY (should be able to use lock construct above)
 	
 	
-	if ((nullptr == ptr) || (nil == ptr->captureFileHandle))
+	if ((nullptr == ptr) || (false == ptr->isCapturing))
 	{
 		//Console_Warning(Console_WriteLine, "attempt to write to nonexistent or closed capture file"); // debug
 	}
+	else if (kStreamCapture_ContentRenderedText != ptr->settings.content)
+	{
+		// ignore; data is written from StreamCapture_WriteReceivedData()
+	}
+	else if (ptr->writeFailed)
+	{
+		// write errors are not expected; if there is a problem,
+		// abort the entire capture (closing the file if necessary)
+		ptr->endCapture();
+		Sound_StandardAlert();
+		// INCOMPLETE: should trigger user-visible error message
+	}
 	else if (inLength > 0)
 	{
-		// TEMPORARY: "writeData:" is synchronous; future SDKs may
-		// be able to support asynchronous mode (or, this could be
-		// faked by splitting up the data stream into smaller parts
-		// that are each written synchronously with breaks); though,
-		// this is usually called by a string-echoing mechanism
-		// that already breaks text into relatively short chunks
-		@try
-		{
-			if (0)
-			{
-				// source and file line endings are the same; no translation needed
-				// (note: currently cannot assume this; may revisit later)
-				NSData*		writtenData = [NSData dataWithBytesNoCopy:CONST_CAST(inBuffer, UInt8*)/* this const_cast is safe when "freeWhenDone" is NO */
-																		length:inLength freeWhenDone:NO];
-				
-				
-				[ptr->captureFileHandle writeData:writtenData];
-			}
-			else
-			{
-				UInt8 const* const		pastEndBuffer = (inBuffer + inLength);
-				UInt8 const*			totalBufferPtr = nullptr;
-				__block UInt8 const*	localBufferPtr = nullptr;
-				__block size_t			blockSize = 0;
-				
-				
-				// The following block is called multiple times below; it
-				// writes any text range accumulated in part of the loop
-				// (the range resets on each new-line).
-				void (^writeBlock)() = ^()
-				{
-					if (blockSize > 0)
-					{
-						[ptr->captureFileHandle writeData:[NSData dataWithBytes:localBufferPtr length:blockSize]];
-						blockSize = 0;
-						localBufferPtr = nullptr;
-					}
-				};
-				
-				// send all the data to the file, substituting new-line-like sequences
-				// (if CR or LF appear alone, they translate to one new-line; if they
-				// appear in a sequence, the pair translates to one new-line); this
-				// also handles the possibility that the “CR, LF” sequence crosses the
-				// boundary between multiple write requests
-				for (totalBufferPtr = inBuffer; totalBufferPtr != pastEndBuffer; ++totalBufferPtr)
-				{
-					if ('\015' == *totalBufferPtr)
-					{
-						// translate to target new-line sequence; note that
-						// the low-level pseudo-terminal device settings will
-						// already affect what CR and LF can do so this
-						// translation is relatively straightforward (expects
-						// that only CR will have to be translated)
-						writeBlock(); // first write the previously-accumulated text
-						ptr->writeNewLine(); // translate to target new-line sequence
-					}
-					else
-					{
-						// text without new-line characters; gather as much as
-						// possible and write it in a single call (either at
-						// the end of the loop or when a new-line is found)
-						++blockSize;
-						if (nullptr == localBufferPtr)
-						{
-							localBufferPtr = totalBufferPtr;
-						}
-					}
-				}
-				writeBlock(); // write any remaining text that was accumulated
-			}
-		}
-		@catch (NSException* e)
-		{
-			// write errors are not expected; if there is a problem,
-			// abort the entire capture (closing the file if necessary)
-			Console_Warning(Console_WriteValueCFString, "file capture write failed, exception", BRIDGE_CAST([e name], CFStringRef));
-			ptr->endCapture();
-			Sound_StandardAlert();
-			// INCOMPLETE: should trigger user-visible error message
-		}
+		ptr->appendTranslatedData(inBuffer, inLength);
 	}
 }// WriteUTF8Data
 
@@ -361,8 +626,22 @@ My_StreamCapture::
 My_StreamCapture	(Session_LineEnding		inLineEndings)
 :
 // IMPORTANT: THESE ARE EXECUTED IN THE ORDER MEMBERS APPEAR IN THE CLASS.
-captureFileHandle(nil),
-writtenNewLineSequence()
+nextSettings(),
+settings(),
+writtenNewLineSequence(),
+filePath(),
+rotatedFilePathPrefix(),
+rotatedFilePathSuffix(),
+isCapturing(false),
+writeFailed(false),
+pendingDataLock(),
+pendingData(),
+escapeStripper(),
+writerQueue(dispatch_queue_create("net.macterm.queues.capture", DISPATCH_QUEUE_SERIAL)),
+chunkSlots(dispatch_semaphore_create(kMy_MaximumPendingChunks)),
+chunksInFlight(dispatch_group_create()),
+flushTimer(nullptr),
+captureFile()
 {
 	// set up line ending translation
 	// TEMPORARY - this might be set up sooner, for the whole screen,
@@ -370,18 +649,23 @@ writtenNewLineSequence()
 	switch (inLineEndings)
 	{
 	case kSession_LineEndingCR:
-		this->writtenNewLineSequence.setWithRetain(CFSTR("\015"));
+		this->writtenNewLineSequence = "\015";
 		break;
 	
 	case kSession_LineEndingCRLF:
-		this->writtenNewLineSequence.setWithRetain(CFSTR("\015\012"));
+		this->writtenNewLineSequence = "\015\012";
 		break;
 	
 	case kSession_LineEndingLF:
 	default:
-		this->writtenNewLineSequence.setWithRetain(CFSTR("\012"));
+		this->writtenNewLineSequence = "\012";
 		break;
 	}
+	
+	if ((nullptr == this->writerQueue) || (nullptr == this->chunkSlots) || (nullptr == this->chunksInFlight))
+	{
+		throw std::bad_alloc();
+	}
 }// My_StreamCapture 1-argument constructor
 
 
@@ -396,6 +680,1048 @@ My_StreamCapture::
 	endCapture();
 }// My_StreamCapture destructor
 
+
+/*!
+Calls the given function to add data to the pending buffer
+(with the buffer locked); when the buffer is large enough,
+it is given to the writer queue.  Data is dropped if the
+capture has ended (the caller may have checked before the
+capture ended on another thread).
+
+(2021.06)
+*/
+template < typename append_functor >
+void
+My_StreamCapture::
+appendWith	(append_functor		inAppendFunction)
+{
+	My_ByteList		fullChunk;
+	
+	
+	{
+		std::lock_guard< std::mutex >	pendingDataGuard(this->pendingDataLock);
+		
+		
+		if (this->isCapturing)
+		{
+			inAppendFunction(this->pendingData);
+			if (this->pendingData.size() >= kMy_ChunkSize)
+			{
+				fullChunk.swap(this->pendingData);
+				this->pendingData.reserve(kMy_ChunkSize);
+				
+				// endCapture() waits for this chunk from now on
+				dispatch_group_enter(this->chunksInFlight);
+			}
+		}
+	}
+	
+	// hand off the data outside of the lock because this may
+	// block (if the disk is slow and too many chunks are queued)
+	if (false == fullChunk.empty())
+	{
+		queueChunk(this, fullChunk);
+	}
+}// My_StreamCapture::appendWith
+
+
+/*!
+Copies data into the pending buffer without changes.
+
+(2021.06)
+*/
+void
+My_StreamCapture::
+appendRawData	(UInt8 const*	inBuffer,
+				 size_t			inLength)
+{
+	this->appendWith([=] (My_ByteList& inoutPendingData)
+					{
+						inoutPendingData.insert(inoutPendingData.end(), inBuffer, inBuffer + inLength);
+					});
+}// My_StreamCapture::appendRawData
+
+
+/*!
+Copies data into the pending buffer, removing escape sequences
+(see My_EscapeStripper).
+
+(2021.06)
+*/
+void
+My_StreamCapture::
+appendStrippedData	(UInt8 const*	inBuffer,
+					 size_t			inLength)
+{
+	this->appendWith([=] (My_ByteList& inoutPendingData)
+					{
+						this->escapeStripper.stripBytes(inBuffer, inLength, this->writtenNewLineSequence, inoutPendingData);
+					});
+}// My_StreamCapture::appendStrippedData
+
+
+/*!
+Copies data into the pending buffer, translating line endings
+along the way.
+
+If CR or LF appear alone, they translate to one new-line; if
+they appear in a sequence, the pair translates to one new-line.
+Note that the low-level pseudo-terminal device settings will
+already affect what CR and LF can do so this translation is
+relatively straightforward (expects that only CR will have to
+be translated).
+
+(2021.06)
+*/
+void
+My_StreamCapture::
+appendTranslatedData	(UInt8 const*	inBuffer,
+						 size_t			inLength)
+{
+	this->appendWith([=] (My_ByteList& inoutPendingData)
+					{
+						UInt8 const* const	kPastEnd = (inBuffer + inLength);
+						UInt8 const*		segmentStart = inBuffer;
+						
+						
+						while (segmentStart != kPastEnd)
+						{
+							UInt8 const*	newLinePtr = STATIC_CAST(std::memchr(segmentStart, '\015', kPastEnd - segmentStart), UInt8 const*);
+							UInt8 const*	segmentEnd = (nullptr == newLinePtr) ? kPastEnd : newLinePtr;
+							
+							
+							inoutPendingData.insert(inoutPendingData.end(), segmentStart, segmentEnd);
+							if (nullptr != newLinePtr)
+							{
+								inoutPendingData.insert(inoutPendingData.end(), this->writtenNewLineSequence.begin(),
+														this->writtenNewLineSequence.end());
+								++segmentEnd;
+							}
+							segmentStart = segmentEnd;
+						}
+					});
+}// My_StreamCapture::appendTranslatedData
+
+
+/*!
+Opens the file for the given URL (replacing any existing
+file) and starts the writer-queue timer.  Returns "true"
+only if successful.
+
+(2021.06)
+*/
+Boolean
+My_StreamCapture::
+beginCapture	(CFURLRef	inFileToOverwrite)
+{
+	NSString*	filePathString = [BRIDGE_CAST(inFileToOverwrite, NSURL*) path];
+	Boolean		result = false;
+	
+	
+	this->settings = this->nextSettings;
+	if (nil == filePathString)
+	{
+		Console_Warning(Console_WriteValueCFString, "failed to create capture-file handle for URL", CFURLGetString(inFileToOverwrite));
+	}
+	else
+	{
+		NSString*	extension = nil;
+		
+		
+		if ((kStreamCapture_CompressionGzip == this->settings.compression) &&
+			(NO == [[filePathString pathExtension] isEqualToString:@"gz"]))
+		{
+			filePathString = [filePathString stringByAppendingPathExtension:@"gz"];
+		}
+		
+		// rotated files are numbered just before the extension
+		// (e.g. "capture.txt" becomes "capture.1.txt"); for
+		// compressed files, the ".gz" is kept on the end
+		extension = [filePathString pathExtension];
+		if ((kStreamCapture_CompressionGzip == this->settings.compression) &&
+			(0 != [[[filePathString stringByDeletingPathExtension] pathExtension] length]))
+		{
+			extension = [[[filePathString stringByDeletingPathExtension] pathExtension] stringByAppendingPathExtension:extension];
+		}
+		this->filePath = [filePathString fileSystemRepresentation];
+		if (0 == [extension length])
+		{
+			this->rotatedFilePathPrefix = this->filePath + ".";
+			this->rotatedFilePathSuffix.clear();
+		}
+		else
+		{
+			this->rotatedFilePathPrefix = this->filePath.substr(0, this->filePath.size() - strlen([extension fileSystemRepresentation]));
+			this->rotatedFilePathSuffix = std::string(".") + [extension fileSystemRepresentation];
+		}
+		
+		this->writeFailed = false;
+		this->escapeStripper.reset();
+		this->captureFile.rotationCount = 0;
+		dispatch_sync(this->writerQueue,
+		^{
+			UNUSED_RETURN(Boolean)this->openFile();
+		});
+		
+		if (this->writeFailed)
+		{
+			Console_Warning(Console_WriteValueCFString, "failed to create capture-file handle for URL", CFURLGetString(inFileToOverwrite));
+		}
+		else
+		{
+			// write partial chunks periodically so that the file is not
+			// too far behind the terminal when output is slow
+			this->flushTimer = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, this->writerQueue);
+			if (nullptr != this->flushTimer)
+			{
+				dispatch_source_set_timer(this->flushTimer, dispatch_time(DISPATCH_TIME_NOW, kMy_FlushIntervalNanoseconds),
+											kMy_FlushIntervalNanoseconds, kMy_FlushIntervalNanoseconds / 4/* leeway */);
+				dispatch_source_set_event_handler(this->flushTimer,
+				^{
+					flushPendingData(this);
+				});
+				dispatch_resume(this->flushTimer);
+			}
+			this->isCapturing = true;
+			result = true;
+		}
+	}
+	
+	return result;
+}// My_StreamCapture::beginCapture
+
+
+/*!
+Writes all remaining data and closes the file.  Has no
+effect if no capture is in progress.
+
+This does not return until every chunk that was taken from
+the pending buffer has been written, even chunks that other
+threads have not yet given to the writer queue; so, nothing
+is written to the file after it is closed (or to the file
+of a later capture, or after this object is destroyed).
+
+(2021.06)
+*/
+void
+My_StreamCapture::
+endCapture ()
+{
+	if (this->isCapturing)
+	{
+		__block My_ByteList		remainingData;
+		
+		
+		if (nullptr != this->flushTimer)
+		{
+			dispatch_source_cancel(this->flushTimer);
+			this->flushTimer = nullptr;
+		}
+		
+		{
+			std::lock_guard< std::mutex >	pendingDataGuard(this->pendingDataLock);
+			
+			
+			// no data is accepted after this (see appendWith())
+			this->isCapturing = false;
+			remainingData.swap(this->pendingData);
+		}
+		
+		// another thread may have taken a full chunk and be waiting
+		// in queueChunk() for a free slot; wait for every such chunk
+		// to be written so that the remaining data follows it
+		UNUSED_RETURN(long)dispatch_group_wait(this->chunksInFlight, DISPATCH_TIME_FOREVER);
+		
+		// since the queue is serial, this also waits for any flush
+		// that the timer started before the file is closed
+		dispatch_sync(this->writerQueue,
+		^{
+			if ((false == remainingData.empty()) && (false == this->writeFailed))
+			{
+				UNUSED_RETURN(Boolean)this->writeToFile(remainingData.data(), remainingData.size());
+			}
+			UNUSED_RETURN(Boolean)this->closeFile();
+		});
+	}
+}// My_StreamCapture::endCapture
+
+
+/*!
+Closes the current file, finishing any compressed stream
+and synchronizing with the disk according to the policy.
+Returns "true" only if successful.
+
+Call ONLY from the writer queue.
+
+(2021.06)
+*/
+Boolean
+My_StreamCapture::
+closeFile ()
+{
+	Boolean		result = true;
+	
+	
+	if (this->captureFile.fileDescriptor >= 0)
+	{
+		if (kStreamCapture_CompressionGzip == this->settings.compression)
+		{
+			z_stream&	stream = this->captureFile.compressionStream;
+			int			zlibResult = Z_OK;
+			
+			
+			stream.next_in = nullptr;
+			stream.avail_in = 0;
+			do
+			{
+				stream.next_out = this->captureFile.compressionBuffer.data();
+				stream.avail_out = STATIC_CAST(this->captureFile.compressionBuffer.size(), uInt);
+				zlibResult = deflate(&stream, Z_FINISH);
+				if (false == this->writeToDisk(this->captureFile.compressionBuffer.data(),
+												this->captureFile.compressionBuffer.size() - stream.avail_out))
+				{
+					result = false;
+					break;
+				}
+			} while (Z_OK == zlibResult);
+			UNUSED_RETURN(int)deflateEnd(&stream);
+		}
+		
+		if (kStreamCapture_SyncPolicyNever != this->settings.syncPolicy)
+		{
+			UNUSED_RETURN(int)fsync(this->captureFile.fileDescriptor);
+		}
+		if (0 != close(this->captureFile.fileDescriptor))
+		{
+			result = false;
+		}
+		this->captureFile.fileDescriptor = -1;
+	}
+	
+	return result;
+}// My_StreamCapture::closeFile
+
+
+/*!
+Opens (replacing) the file at "filePath", preparing for
+compression if necessary.  Returns "true" only if successful;
+otherwise, "writeFailed" is set.
+
+Call ONLY from the writer queue.
+
+(2021.06)
+*/
+Boolean
+My_StreamCapture::
+openFile ()
+{
+	Boolean		result = false;
+	
+	
+	this->captureFile.fileDescriptor = open(this->filePath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (this->captureFile.fileDescriptor < 0)
+	{
+		Console_Warning(Console_WriteValue, "failed to open capture file, errno", errno);
+	}
+	else
+	{
+		result = true;
+		if (kStreamCapture_CompressionGzip == this->settings.compression)
+		{
+			z_stream&	stream = this->captureFile.compressionStream;
+			
+			
+			std::memset(&stream, 0, sizeof(stream));
+			this->captureFile.compressionBuffer.resize(kMy_CompressionBufferSize);
+			
+			// a window size of (15 + 16) selects the gzip format
+			if (Z_OK != deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8/* memory level */, Z_DEFAULT_STRATEGY))
+			{
+				Console_Warning(Console_WriteLine, "failed to initialize capture-file compression");
+				UNUSED_RETURN(int)close(this->captureFile.fileDescriptor);
+				this->captureFile.fileDescriptor = -1;
+				result = false;
+			}
+		}
+	}
+	
+	this->captureFile.bytesWritten = 0;
+	this->captureFile.openTime = CFAbsoluteTimeGetCurrent();
+	if (false == result)
+	{
+		this->writeFailed = true;
+	}
+	
+	return result;
+}// My_StreamCapture::openFile
+
+
+/*!
+If writing the specified number of additional bytes would
+exceed a rotation limit (or the file is too old), closes
+the current file, renames it with the next file number
+and opens a new file.  Returns "false" only if a file
+operation failed.
+
+Call ONLY from the writer queue.
+
+(2021.06)
+*/
+Boolean
+My_StreamCapture::
+rotateFileIfNecessary	(size_t		inAdditionalByteCount)
+{
+	Boolean		result = true;
+	Boolean		exceedsSize = ((0 != this->settings.maximumBytesPerFile) &&
+								(this->captureFile.bytesWritten > 0) &&
+								((this->captureFile.bytesWritten + inAdditionalByteCount) > this->settings.maximumBytesPerFile));
+	Boolean		exceedsAge = ((0 != this->settings.maximumSecondsPerFile) &&
+								((CFAbsoluteTimeGetCurrent() - this->captureFile.openTime) > this->settings.maximumSecondsPerFile));
+	
+	
+	if (exceedsSize || exceedsAge)
+	{
+		std::string		rotatedPath = (this->rotatedFilePathPrefix + std::to_string(++this->captureFile.rotationCount) +
+										this->rotatedFilePathSuffix);
+		
+		
+		result = this->closeFile();
+		if (result)
+		{
+			if (0 != rename(this->filePath.c_str(), rotatedPath.c_str()))
+			{
+				Console_Warning(Console_WriteValue, "failed to rename rotated capture file, errno", errno);
+			}
+			result = this->openFile();
+		}
+	}
+	
+	return result;
+}// My_StreamCapture::rotateFileIfNecessary
+
+
+/*!
+Writes bytes directly to the file descriptor, handling
+partial writes and interruptions.  Returns "true" only
+if successful.
+
+Call ONLY from the writer queue.
+
+(2021.06)
+*/
+Boolean
+My_StreamCapture::
+writeToDisk		(UInt8 const*	inBuffer,
+				 size_t			inLength)
+{
+	Boolean		result = true;
+	
+	
+	while (inLength > 0)
+	{
+		ssize_t		bytesWritten = write(this->captureFile.fileDescriptor, inBuffer, inLength);
+		
+		
+		if (bytesWritten < 0)
+		{
+			if (EINTR != errno)
+			{
+				Console_Warning(Console_WriteValue, "file capture write failed, errno", errno);
+				result = false;
+				break;
+			}
+		}
+		else
+		{
+			inBuffer += bytesWritten;
+			inLength -= bytesWritten;
+		}
+	}
+	
+	return result;
+}// My_StreamCapture::writeToDisk
+
+
+/*!
+Writes captured data to the current file (compressing it
+if necessary) and rotates files first if a limit has been
+reached.  Returns "true" only if successful; otherwise,
+"writeFailed" is set.
+
+Call ONLY from the writer queue.
+
+(2021.06)
+*/
+Boolean
+My_StreamCapture::
+writeToFile		(UInt8 const*	inBuffer,
+				 size_t			inLength)
+{
+	Boolean		result = this->rotateFileIfNecessary(inLength);
+	
+	
+	if ((result) && (this->captureFile.fileDescriptor >= 0))
+	{
+		if (kStreamCapture_CompressionGzip == this->settings.compression)
+		{
+			z_stream&	stream = this->captureFile.compressionStream;
+			
+			
+			stream.next_in = CONST_CAST(inBuffer, Bytef*);
+			stream.avail_in = STATIC_CAST(inLength, uInt);
+			do
+			{
+				stream.next_out = this->captureFile.compressionBuffer.data();
+				stream.avail_out = STATIC_CAST(this->captureFile.compressionBuffer.size(), uInt);
+				UNUSED_RETURN(int)deflate(&stream, Z_NO_FLUSH);
+				result = this->writeToDisk(this->captureFile.compressionBuffer.data(),
+											this->captureFile.compressionBuffer.size() - stream.avail_out);
+			} while ((result) && (0 == stream.avail_out));
+		}
+		else
+		{
+			result = this->writeToDisk(inBuffer, inLength);
+		}
+		
+		if (result)
+		{
+			this->captureFile.bytesWritten += inLength;
+			if (kStreamCapture_SyncPolicyAlways == this->settings.syncPolicy)
+			{
+				UNUSED_RETURN(int)fsync(this->captureFile.fileDescriptor);
+			}
+		}
+	}
+	
+	if (false == result)
+	{
+		this->writeFailed = true;
+	}
+	
+	return result;
+}// My_StreamCapture::writeToFile
+
+
+/*!
+Appends the text portions of the given bytes to the output,
+removing escape sequences and control characters.  Tabs are
+kept, and each line feed is written as the given new-line
+sequence.
+
+Runs of printable bytes are copied in bulk.
+
+(2021.06)
+*/
+void
+My_EscapeStripper::
+stripBytes	(UInt8 const*		inBuffer,
+			 size_t				inLength,
+			 std::string const&	inNewLineSequence,
+			 My_ByteList&		inoutOutput)
+{
+	UInt8 const* const	kPastEnd = (inBuffer + inLength);
+	UInt8 const*		ptr = inBuffer;
+	
+	
+	while (ptr != kPastEnd)
+	{
+		UInt8 const		kByte = *ptr;
+		
+		
+		switch (this->currentState)
+		{
+		case kStateText:
+			if ((kByte >= 0x20) && (0x7F != kByte))
+			{
+				UInt8 const*	runEnd = ptr + 1;
+				
+				
+				while ((runEnd != kPastEnd) && (*runEnd >= 0x20) && (0x7F != *runEnd))
+				{
+					++runEnd;
+				}
+				inoutOutput.insert(inoutOutput.end(), ptr, runEnd);
+				ptr = runEnd;
+				continue;
+			}
+			else if ('\033' == kByte)
+			{
+				this->currentState = kStateEscape;
+			}
+			else if ('\012' == kByte)
+			{
+				inoutOutput.insert(inoutOutput.end(), inNewLineSequence.begin(), inNewLineSequence.end());
+			}
+			else if ('\011' == kByte)
+			{
+				inoutOutput.push_back(kByte);
+			}
+			else
+			{
+				// other controls (including carriage returns, which
+				// always accompany line feeds in terminal output)
+				// have no meaning in a text file
+			}
+			break;
+		
+		case kStateEscape:
+			if ('[' == kByte)
+			{
+				this->currentState = kStateControlSequence;
+			}
+			else if ((']' == kByte) || ('P' == kByte) || ('_' == kByte) || ('^' == kByte) || ('X' == kByte))
+			{
+				this->currentState = kStateCommandString;
+			}
+			else if ((kByte >= 0x20) && (kByte <= 0x2F))
+			{
+				this->currentState = kStateEscapeIntermediate;
+			}
+			else if ('\033' == kByte)
+			{
+				// restart
+			}
+			else
+			{
+				// any other byte completes a two-byte sequence
+				// (or, for CAN and SUB, cancels it)
+				this->currentState = kStateText;
+			}
+			break;
+		
+		case kStateEscapeIntermediate:
+			if ((kByte >= 0x20) && (kByte <= 0x2F))
+			{
+				// more intermediate bytes
+			}
+			else if ('\033' == kByte)
+			{
+				this->currentState = kStateEscape;
+			}
+			else
+			{
+				this->currentState = kStateText;
+			}
+			break;
+		
+		case kStateControlSequence:
+			if ((kByte >= 0x40) && (kByte <= 0x7E))
+			{
+				// final byte
+				this->currentState = kStateText;
+			}
+			else if ('\033' == kByte)
+			{
+				this->currentState = kStateEscape;
+			}
+			else if ((0x18 == kByte) || (0x1A == kByte))
+			{
+				// CAN or SUB cancels the sequence
+				this->currentState = kStateText;
+			}
+			else
+			{
+				// parameter or intermediate byte
+			}
+			break;
+		
+		case kStateCommandString:
+			if ('\007' == kByte)
+			{
+				// BEL terminates (used by xterm for OSC)
+				this->currentState = kStateText;
+			}
+			else if ('\033' == kByte)
+			{
+				this->currentState = kStateCommandStringEscape;
+			}
+			else if ((0x18 == kByte) || (0x1A == kByte))
+			{
+				// CAN or SUB cancels the sequence
+				this->currentState = kStateText;
+			}
+			else
+			{
+				// string content is discarded
+			}
+			break;
+		
+		case kStateCommandStringEscape:
+			if ('\\' == kByte)
+			{
+				// string terminator (ST)
+				this->currentState = kStateText;
+			}
+			else
+			{
+				// this is the start of some other sequence; reprocess
+				// the current byte as if it followed ESC in text
+				this->currentState = kStateEscape;
+				continue;
+			}
+			break;
+		
+		default:
+			// ???
+			this->currentState = kStateText;
+			break;
+		}
+		++ptr;
+	}
+}// My_EscapeStripper::stripBytes
+
+
+/*!
+Writes any data that is waiting in the pending buffer, even
+if it is not a full chunk, and checks for time-based file
+rotation.  This is called periodically from a timer on the
+writer queue so that a quiet terminal does not leave data
+unwritten indefinitely.
+
+Call ONLY from the writer queue.
+
+(2021.06)
+*/
+void
+flushPendingData	(My_StreamCapturePtr	inPtr)
+{
+	My_ByteList		partialChunk;
+	
+	
+	{
+		std::lock_guard< std::mutex >	pendingDataGuard(inPtr->pendingDataLock);
+		
+		
+		partialChunk.swap(inPtr->pendingData);
+	}
+	
+	if (false == inPtr->writeFailed)
+	{
+		if (false == partialChunk.empty())
+		{
+			UNUSED_RETURN(Boolean)inPtr->writeToFile(partialChunk.data(), partialChunk.size());
+		}
+		else
+		{
+			UNUSED_RETURN(Boolean)inPtr->rotateFileIfNecessary(0);
+		}
+		
+		// for compressed files, complete the current block so
+		// that the file can be decompressed while it grows
+		if ((false == inPtr->writeFailed) && (inPtr->captureFile.fileDescriptor >= 0) &&
+			(kStreamCapture_CompressionGzip == inPtr->settings.compression))
+		{
+			z_stream&	stream = inPtr->captureFile.compressionStream;
+			
+			
+			stream.next_in = nullptr;
+			stream.avail_in = 0;
+			do
+			{
+				stream.next_out = inPtr->captureFile.compressionBuffer.data();
+				stream.avail_out = STATIC_CAST(inPtr->captureFile.compressionBuffer.size(), uInt);
+				UNUSED_RETURN(int)deflate(&stream, Z_SYNC_FLUSH);
+				if (false == inPtr->writeToDisk(inPtr->captureFile.compressionBuffer.data(),
+												inPtr->captureFile.compressionBuffer.size() - stream.avail_out))
+				{
+					inPtr->writeFailed = true;
+					break;
+				}
+			} while (0 == stream.avail_out);
+		}
+	}
+}// flushPendingData
+
+
+/*!
+Reads the given gzip file and appends its decompressed
+contents to the buffer.  Returns "true" only if the file
+exists and is one complete gzip stream.
+
+This is used by the unit tests.
+
+(2021.06)
+*/
+Boolean
+inflateGzipFile		(std::string const&		inFilePath,
+					 My_ByteList&			inoutData)
+{
+	NSData*		fileData = [NSData dataWithContentsOfFile:[NSString stringWithUTF8String:inFilePath.c_str()]];
+	Boolean		result = false;
+	
+	
+	if ((nil != fileData) && ([fileData length] > 2) &&
+		(0x1F == STATIC_CAST([fileData bytes], UInt8 const*)[0]) && (0x8B == STATIC_CAST([fileData bytes], UInt8 const*)[1]))
+	{
+		z_stream	stream;
+		UInt8		buffer[4096];
+		int			zlibResult = Z_OK;
+		
+		
+		std::memset(&stream, 0, sizeof(stream));
+		if (Z_OK == inflateInit2(&stream, 15 + 16/* gzip format only */))
+		{
+			stream.next_in = STATIC_CAST(CONST_CAST([fileData bytes], void*), Bytef*);
+			stream.avail_in = STATIC_CAST([fileData length], uInt);
+			do
+			{
+				stream.next_out = buffer;
+				stream.avail_out = sizeof(buffer);
+				zlibResult = inflate(&stream, Z_NO_FLUSH);
+				inoutData.insert(inoutData.end(), buffer, buffer + (sizeof(buffer) - stream.avail_out));
+			} while (Z_OK == zlibResult);
+			result = ((Z_STREAM_END == zlibResult) && (0 == stream.avail_in));
+			UNUSED_RETURN(int)inflateEnd(&stream);
+		}
+	}
+	
+	return result;
+}// inflateGzipFile
+
+
+/*!
+Gives a chunk of data to the writer queue (taking ownership of
+the buffer contents).  If too many chunks are already waiting
+for the disk, this blocks until one is written; that prevents
+a slow disk from consuming unlimited memory.
+
+The caller must have entered "chunksInFlight" for the chunk;
+it is left once the chunk is written.
+
+(2021.06)
+*/
+void
+queueChunk	(My_StreamCapturePtr	inPtr,
+			 My_ByteList&			inoutChunk)
+{
+	My_ByteList*	chunkPtr = new My_ByteList();
+	
+	
+	chunkPtr->swap(inoutChunk);
+	UNUSED_RETURN(long)dispatch_semaphore_wait(inPtr->chunkSlots, DISPATCH_TIME_FOREVER);
+	dispatch_async(inPtr->writerQueue,
+	^{
+		if (false == inPtr->writeFailed)
+		{
+			UNUSED_RETURN(Boolean)inPtr->writeToFile(chunkPtr->data(), chunkPtr->size());
+		}
+		delete chunkPtr;
+		UNUSED_RETURN(long)dispatch_semaphore_signal(inPtr->chunkSlots);
+		dispatch_group_leave(inPtr->chunksInFlight);
+	});
+}// queueChunk
+
+
+/*!
+Tests My_EscapeStripper with common sequences in a single
+buffer.
+
+Returns "true" if ALL assertions pass; "false" is
+returned if any fail, however messages should be
+printed for ALL assertion failures regardless.
+
+(2021.06)
+*/
+Boolean
+unitTest_EscapeStripper_000 ()
+{
+	char const			kInput[] = "\033[1;31mred\033[0m\ttext\015\012\033]0;title\007next\033(Bline\033P1$r\033\\end\007";
+	std::string const	kExpected = "red\ttext\nnextlineend";
+	My_EscapeStripper	stripper;
+	My_ByteList			output;
+	Boolean				result = true;
+	
+	
+	stripper.stripBytes(REINTERPRET_CAST(kInput, UInt8 const*), sizeof(kInput) - 1, "\n", output);
+	{
+		std::string const	kActual(output.begin(), output.end());
+		
+		
+		Console_TestAssertUpdate(result, kExpected == kActual,
+									Console_WriteValueCString, "stripped text does not match; actual", kActual.c_str());
+	}
+	Console_TestAssertUpdate(result, My_EscapeStripper::kStateText == stripper.currentState,
+								Console_WriteValue, "stripper should end in text state; actual", stripper.currentState);
+	
+	return result;
+}// unitTest_EscapeStripper_000
+
+
+/*!
+Tests My_EscapeStripper with sequences that are split
+across many buffers (one byte at a time).
+
+Returns "true" if ALL assertions pass; "false" is
+returned if any fail, however messages should be
+printed for ALL assertion failures regardless.
+
+(2021.06)
+*/
+Boolean
+unitTest_EscapeStripper_001 ()
+{
+	char const			kInput[] = "a\033[38;2;1;2;3mb\033]8;;http://x\033\\c\033]8;;\033\\\015\012";
+	std::string const	kExpected = "abc\015\012";
+	My_EscapeStripper	stripper;
+	My_ByteList			output;
+	Boolean				result = true;
+	
+	
+	for (size_t i = 0; i < (sizeof(kInput) - 1); ++i)
+	{
+		stripper.stripBytes(REINTERPRET_CAST(kInput + i, UInt8 const*), 1, "\015\012", output);
+	}
+	{
+		std::string const	kActual(output.begin(), output.end());
+		
+		
+		Console_TestAssertUpdate(result, kExpected == kActual,
+									Console_WriteValueCString, "stripped text (split input) does not match; actual", kActual.c_str());
+	}
+	
+	return result;
+}// unitTest_EscapeStripper_001
+
+
+/*!
+Tests compressed captures through the public interface:
+enough data is written for several chunks to be queued
+(and several files to be rotated) and the capture is
+ended at once.  Every file must be a complete gzip stream
+and, in order, they must contain exactly the input.
+
+Returns "true" if ALL assertions pass; "false" is
+returned if any fail, however messages should be
+printed for ALL assertion failures regardless.
+
+(2021.06)
+*/
+Boolean
+unitTest_Compression_000 ()
+{
+	NSString*			basePath = [NSTemporaryDirectory() stringByAppendingPathComponent:
+										[NSString stringWithFormat:@"MacTermCaptureTest-%d.txt", STATIC_CAST(getpid(), int)]];
+	std::string const	kFilePath = std::string([basePath fileSystemRepresentation]) + ".gz";
+	std::string const	kRotatedPathPrefix = kFilePath.substr(0, kFilePath.size() - strlen("txt.gz"));
+	StreamCapture_Ref	capture = StreamCapture_New(kSession_LineEndingLF);
+	My_ByteList			input;
+	My_ByteList			output;
+	UInt32				fileCount = 0;
+	Boolean				result = true;
+	
+	
+	// three full chunks and a bit more, with a file limit that
+	// allows only one full chunk in each file
+	for (size_t i = 0; i < (3 * kMy_ChunkSize + 100); ++i)
+	{
+		input.push_back(STATIC_CAST((0 == (i % 64)) ? '\012' : ('a' + (i % 26)), UInt8));
+	}
+	Console_TestAssertUpdate(result, nullptr != capture, Console_WriteLine, "failed to create capture");
+	if (nullptr != capture)
+	{
+		StreamCapture_SetContent(capture, kStreamCapture_ContentRawBytes);
+		StreamCapture_SetCompression(capture, kStreamCapture_CompressionGzip);
+		StreamCapture_SetRotation(capture, kMy_ChunkSize + 1, 0/* seconds */);
+		Console_TestAssertUpdate(result, StreamCapture_Begin(capture, BRIDGE_CAST([NSURL fileURLWithPath:basePath], CFURLRef)),
+									Console_WriteLine, "failed to begin compressed capture");
+		for (size_t i = 0; i < input.size(); i += 4096)
+		{
+			StreamCapture_WriteReceivedData(capture, input.data() + i, std::min< size_t >(4096, input.size() - i));
+		}
+		StreamCapture_End(capture);
+		StreamCapture_Release(&capture);
+		
+		// rotated files are oldest first, then the current file
+		for (UInt32 i = 1; true; ++i)
+		{
+			std::string const	kRotatedPath = kRotatedPathPrefix + std::to_string(i) + ".txt.gz";
+			
+			
+			if (0 != access(kRotatedPath.c_str(), F_OK))
+			{
+				break;
+			}
+			++fileCount;
+			Console_TestAssertUpdate(result, inflateGzipFile(kRotatedPath, output),
+										Console_WriteValue, "rotated file is not complete gzip data; file number", i);
+			UNUSED_RETURN(int)unlink(kRotatedPath.c_str());
+		}
+		Console_TestAssertUpdate(result, fileCount >= 2, Console_WriteValue, "too few rotated files; count", fileCount);
+		Console_TestAssertUpdate(result, inflateGzipFile(kFilePath, output),
+									Console_WriteLine, "current file is not complete gzip data");
+		UNUSED_RETURN(int)unlink(kFilePath.c_str());
+		Console_TestAssertUpdate(result, input == output,
+									Console_WriteValue, "decompressed data does not match input; decompressed size", output.size());
+	}
+	
+	return result;
+}// unitTest_Compression_000
+
+
+/*!
+Tests that a file is closed and renamed with the next
+number once the byte limit would be exceeded, and that
+a write is never split across files.
+
+Returns "true" if ALL assertions pass; "false" is
+returned if any fail, however messages should be
+printed for ALL assertion failures regardless.
+
+(2021.06)
+*/
+Boolean
+unitTest_Rotation_000 ()
+{
+	NSString*			basePath = [NSTemporaryDirectory() stringByAppendingPathComponent:
+										[NSString stringWithFormat:@"MacTermRotationTest-%d.log", STATIC_CAST(getpid(), int)]];
+	std::string const	kFilePath = [basePath fileSystemRepresentation];
+	std::string const	kRotatedPathPrefix = kFilePath.substr(0, kFilePath.size() - strlen("log"));
+	My_StreamCapture	capture(kSession_LineEndingLF);
+	My_StreamCapturePtr	capturePtr = &capture; // (blocks cannot copy the object)
+	Boolean				result = true;
+	auto				readFile = [] (std::string const& inPath) -> std::string
+						{
+							NSData*		data = [NSData dataWithContentsOfFile:[NSString stringWithUTF8String:inPath.c_str()]];
+							
+							
+							return ((nil == data) ? std::string("(missing)") : std::string(STATIC_CAST([data bytes], char const*), [data length]));
+						};
+	
+	
+	capture.nextSettings.content = kStreamCapture_ContentRawBytes;
+	capture.nextSettings.maximumBytesPerFile = 8;
+	Console_TestAssertUpdate(result, capture.beginCapture(BRIDGE_CAST([NSURL fileURLWithPath:basePath], CFURLRef)),
+								Console_WriteLine, "failed to begin capture");
+	dispatch_sync(capture.writerQueue,
+	^{
+		UNUSED_RETURN(Boolean)capturePtr->writeToFile(REINTERPRET_CAST("12345", UInt8 const*), 5);
+		UNUSED_RETURN(Boolean)capturePtr->writeToFile(REINTERPRET_CAST("678", UInt8 const*), 3); // exactly at the limit
+		UNUSED_RETURN(Boolean)capturePtr->writeToFile(REINTERPRET_CAST("abcde", UInt8 const*), 5);
+		UNUSED_RETURN(Boolean)capturePtr->writeToFile(REINTERPRET_CAST("fghijklmnop", UInt8 const*), 11); // larger than the limit
+	});
+	capture.endCapture();
+	Console_TestAssertUpdate(result, false == capture.writeFailed, Console_WriteLine, "rotation should not fail");
+	
+	{
+		std::string const	kFirst = readFile(kRotatedPathPrefix + "1.log");
+		std::string const	kSecond = readFile(kRotatedPathPrefix + "2.log");
+		std::string const	kCurrent = readFile(kFilePath);
+		
+		
+		Console_TestAssertUpdate(result, "12345678" == kFirst, Console_WriteValueCString, "first rotated file; actual", kFirst.c_str());
+		Console_TestAssertUpdate(result, "abcde" == kSecond, Console_WriteValueCString, "second rotated file; actual", kSecond.c_str());
+		Console_TestAssertUpdate(result, "fghijklmnop" == kCurrent, Console_WriteValueCString, "current file; actual", kCurrent.c_str());
+		Console_TestAssertUpdate(result, 0 != access((kRotatedPathPrefix + "3.log").c_str(), F_OK),
+									Console_WriteLine, "too many files were rotated");
+	}
+	
+	UNUSED_RETURN(int)unlink((kRotatedPathPrefix + "1.log").c_str());
+	UNUSED_RETURN(int)unlink((kRotatedPathPrefix + "2.log").c_str());
+	UNUSED_RETURN(int)unlink(kFilePath.c_str());
+	
+	return result;
+}// unitTest_Rotation_000
+
 } // anonymous namespace
 
 // BELOW IS REQUIRED NEWLINE TO END FILE
@@ -86,6 +86,7 @@ enum Terminal_Result
 	kTerminal_ResultIteratorCannotAdvance = -5,	//!< attempt to advance iterator past the end of its list
 	kTerminal_ResultNoListeningSession = -6,	//!< cannot send result anywhere because no session is currently listening
 	kTerminal_ResultUnsupported = -7,			//!< request cannot be fulfilled for target object
+	kTerminal_ResultFormatError = -8,			//!< saved state is damaged, or is from an incompatible version
 };
 
 /*!
@@ -143,6 +144,22 @@ enum
 
 // NOTE: Terminal_CursorType is declared in "MacTermQuills.h" since it is used by SwiftUI
 
+/*!
+Terminal modes that change the sequences that are sent for
+keys (see Terminal_ReturnKeyModes()).  Terminals that have
+the same modes send the same sequence for any VT key, so a
+key can be encoded once for all of them.
+*/
+typedef UInt32 Terminal_KeyModes;
+enum
+{
+	kTerminal_KeyModesNone					= 0,
+	kTerminal_KeyModeANSI					= (1 << 0),		//!< DECANM: not in VT52 compatibility mode
+	kTerminal_KeyModeApplicationKeypad		= (1 << 1),		//!< DECKPAM: keypad sends application sequences
+	kTerminal_KeyModeApplicationCursor		= (1 << 2),		//!< DECCKM: arrows send application sequences
+	kTerminal_KeyModeEightBitControls		= (1 << 3)		//!< S8C1T: sequences begin with 8-bit codes instead of ESC
+};
+
 /*!
 Controls Terminal_Reset().
 */
@@ -264,6 +281,11 @@ character in the chunk, and *include* any attributes that
 are actually applied to the entire line (double-sized text,
 for instance).
 
+If the attributes have an inline-color bit set (such as
+"kTextAttributes_ColorIsInlineForeground"), the 24-bit
+color for that part of the text is in the given colors;
+otherwise, the colors should be ignored.
+
 IMPORTANT:  The line text buffer may be nullptr, and if it
 			is, you should still pay attention to the
 			length value; it implies a blank area of that
@@ -273,12 +295,21 @@ typedef void (^Terminal_ScreenRunBlock)	(UInt16						inLineTextBufferOrWhitespac
 										 CFStringRef				inLineTextBufferAsCFStringOrNull,
 										 Terminal_LineRef			inRow,
 										 UInt16						inZeroBasedStartColumnNumber,
-										 TextAttributes_Object		inAttributes);
+										 TextAttributes_Object		inAttributes,
+										 TextAttributes_InlineColors	inInlineColors);
 
 
 
 #pragma mark Public Methods
 
+//!\name Module Tests
+//@{
+
+void
+	Terminal_RunTests						();
+
+//@}
+
 //!\name Creating and Destroying Terminal Screen Buffers
 //@{
 
@@ -400,6 +431,15 @@ Terminal_Result
 											 TextAttributes_Object		inAttributesToSet,
 											 TextAttributes_Object		inAttributesToClear);
 
+// THE SCANNED URL OR HYPERLINK TARGET AT THE GIVEN COLUMN; YOU MUST CFRelease() THE URI IF THE RESULT IS OK
+Terminal_Result
+	Terminal_CopyLinkAtColumn				(TerminalScreenRef			inScreen,
+											 Terminal_LineRef			inRow,
+											 UInt16						inZeroBasedColumn,
+											 UInt16&					outStartColumn,
+											 UInt16&					outPastTheEndColumn,
+											 CFStringRef&				outURICFString);
+
 void
 	Terminal_DeleteAllSavedLines			(TerminalScreenRef			inScreen);
 
@@ -434,9 +474,17 @@ Terminal_Result
 //!\name Terminal State
 //@{
 
+// XTERM MODES 47, 1047 AND 1049; USUALLY MEANS A FULL-SCREEN PROGRAM IS RUNNING
+Boolean
+	Terminal_AlternateScreenIsActive		(TerminalScreenRef			inScreen);
+
 Boolean
 	Terminal_BellIsEnabled					(TerminalScreenRef			inScreen);
 
+// XTERM MODE 2004; IF TRUE, PASTED TEXT SHOULD BE ENCLOSED IN "ESC [ 2 0 0 ~" AND "ESC [ 2 0 1 ~"
+Boolean
+	Terminal_BracketedPasteIsEnabled		(TerminalScreenRef			inScreen);
+
 void
 	Terminal_CopyTitleForIcon				(TerminalScreenRef			inRef,
 											 CFStringRef&				outTitle);
@@ -456,6 +504,9 @@ Boolean
 TextAttributes_Object
 	Terminal_CursorReturnAttributes			(TerminalScreenRef			inScreen);
 
+TextAttributes_InlineColors
+	Terminal_CursorReturnInlineColors		(TerminalScreenRef			inScreen);
+
 CFStringRef
 	Terminal_EmulatorReturnDefaultName		(Emulation_FullType			inEmulator);
 
@@ -490,6 +541,9 @@ void
 Preferences_ContextRef
 	Terminal_ReturnConfiguration			(TerminalScreenRef			inScreen);
 
+Terminal_KeyModes
+	Terminal_ReturnKeyModes					(TerminalScreenRef			inScreen);
+
 CFStringEncoding
 	Terminal_ReturnTextEncoding				(TerminalScreenRef			inScreen);
 
@@ -538,6 +592,12 @@ Terminal_Result
 	Terminal_UserInputVTKey					(TerminalScreenRef			inScreen,
 											 UInt8						inVTKey);
 
+// SAME DATA AS Terminal_UserInputVTKey() WOULD SEND FOR A TERMINAL WITH THE GIVEN MODES
+Terminal_Result
+	Terminal_UserInputVTKeyCopySequence		(UInt8						inVTKey,
+											 Terminal_KeyModes			inKeyModes,
+											 std::vector< UInt8 >&		outSequence);
+
 Boolean
 	Terminal_WindowIsToBeMinimized			(TerminalScreenRef			inScreen);
 
@@ -566,6 +626,22 @@ Terminal_Result
 
 //@}
 
+//!\name Saving and Restoring State
+//@{
+
+// APPENDS; RESULT CAN BE WRITTEN TO A FILE AND MAPPED INTO MEMORY LATER
+Terminal_Result
+	Terminal_SerializeState					(TerminalScreenRef			inScreen,
+											 std::vector< UInt8 >&		inoutBuffer);
+
+// DATA MUST BE 8-BYTE ALIGNED; SCREEN IS UNCHANGED UNLESS THE RESULT IS kTerminal_ResultOK
+Terminal_Result
+	Terminal_DeserializeState				(TerminalScreenRef			inScreen,
+											 void const*				inData,
+											 size_t						inByteCount);
+
+//@}
+
 //!\name Direct Interaction With the Emulator (Deprecated)
 //@{
 
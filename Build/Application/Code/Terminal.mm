@@ -75,11 +75,14 @@ extern "C"
 #import <Registrar.template.h>
 #import <SoundSystem.h>
 #import <StringUtilities.h>
+#import <TimerWheel.h>
+#import <TraceSpan.h>
 
 // application includes
 #import "Commands.h"
 #import "DebugInterface.h"
 #import "Emulation.h"
+#import "LinkScanner.h"
 #import "Preferences.h"
 #import "PrintTerminal.h"
 #import "QuillsTerminal.h"
@@ -90,6 +93,7 @@ extern "C"
 #import "TerminalSpeaker.h"
 #import "TextTranslation.h"
 #import "UIStrings.h"
+#import "URL.h"
 #import "UTF8Decoder.h"
 #import "VTKeys.h"
 
@@ -325,11 +329,13 @@ enum
 	kMy_ParserStateSeenESCRightSqBracket2		= 'ES]2',	//!< generic state used to define emulator-specific states, below
 	kMy_ParserStateSeenESCRightSqBracket3		= 'ES]3',	//!< generic state used to define emulator-specific states, below
 	kMy_ParserStateSeenESCRightSqBracket4		= 'ES]4',	//!< generic state used to define emulator-specific states, below
+	kMy_ParserStateSeenESCRightSqBracket8		= 'ES]8',	//!< generic state used to define emulator-specific states, below
 	kMy_ParserStateSeenESCRightSqBracket0Semi	= 'E]0;',	//!< generic state used to define emulator-specific states, below
 	kMy_ParserStateSeenESCRightSqBracket1Semi	= 'E]1;',	//!< generic state used to define emulator-specific states, below
 	kMy_ParserStateSeenESCRightSqBracket2Semi	= 'E]2;',	//!< generic state used to define emulator-specific states, below
 	kMy_ParserStateSeenESCRightSqBracket3Semi	= 'E]3;',	//!< generic state used to define emulator-specific states, below
 	kMy_ParserStateSeenESCRightSqBracket4Semi	= 'E]4;',	//!< generic state used to define emulator-specific states, below
+	kMy_ParserStateSeenESCRightSqBracket8Semi	= 'E]8;',	//!< generic state used to define emulator-specific states, below
 	kMy_ParserStateSeenESCRightSqBracket13		= 'E]13',	//!< generic state used to define emulator-specific states, below
 	kMy_ParserStateSeenESCRightSqBracket133		= ']133',	//!< generic state used to define emulator-specific states, below
 	kMy_ParserStateSeenESCRightSqBracket1337	= '1337',	//!< generic state used to define emulator-specific states, below
@@ -432,6 +438,58 @@ enum My_GraphicsMode
 	kMy_GraphicsModeOn			= 1		//!< non-printable ASCII will become VT graphics characters
 };
 
+/*!
+Selects one of the character remap tables of a character
+set.  Graphics glyphs depend on the emulator (VT52 or ANSI)
+and on whether or not the text is bold.
+*/
+enum My_GraphicsRemap
+{
+	kMy_GraphicsRemapNone		= 0,	//!< text is not graphical; only the rules of the character set apply
+	kMy_GraphicsRemapDEC		= 1,	//!< DEC Special Graphics (ANSI mode)
+	kMy_GraphicsRemapDECBold	= 2,	//!< DEC Special Graphics (ANSI mode) with bold line-drawing glyphs
+	kMy_GraphicsRemapVT52		= 3,	//!< VT52 graphics
+	kMy_GraphicsRemapVT52Bold	= 4,	//!< VT52 graphics with bold line-drawing glyphs
+	kMy_GraphicsRemapCount		= 5		//!< number of tables per character set
+};
+
+UInt16 const	kMy_CharacterRemapTableSize = 256;	//!< number of character codes in each remap table; larger codes are not remapped
+
+UInt32 const	kMy_TrueColorIndexEmptyKey = 0xFFFFFFFF;	//!< marks unused slots in a true-color hash index (no RGB value is this large)
+UInt32 const	kMy_TrueColorNoID = 0xFFFFFFFF;				//!< marks the ends of the true-color usage list (no ID is this large)
+UInt32 const	kMy_TrueColorIndexInitialSize = 256;		//!< number of slots in a new true-color hash index; must be a power of 2
+
+UInt16 const	kMy_MaximumRowCount = 200;					//!< screens cannot be resized to more lines than this
+
+UInt32 const	kMy_LinkScanDelay = 100;					//!< milliseconds after text is written before changed lines are scanned for links
+UInt16 const	kMy_LinkURICapacity = 1024;					//!< number of unique hyperlink targets that a screen remembers
+size_t const	kMy_LinkURIMaximumSize = 8192;				//!< bytes of hyperlink parameters and target that the parser accepts
+
+UInt32 const	kMy_StateSignature = 'MTst';				//!< first field of saved state (see Terminal_SerializeState())
+UInt32 const	kMy_StateByteOrderMark = 0x01020304;		//!< second field of saved state; has a different value if the byte order differs
+UInt16 const	kMy_StateVersion = 1;						//!< increase only if existing fields change meaning (new sections and fields do not)
+size_t const	kMy_StateAlignment = 8;						//!< every section of saved state starts at a multiple of this offset
+
+/*!
+Sections of saved terminal state (see Terminal_SerializeState()).
+The header has the offset and size of each section, in this order;
+readers ignore sections that they do not know about, and treat
+sections that are not present (because they were saved by an
+older version) as empty.
+*/
+enum My_StateSection
+{
+	kMy_StateSectionModes		= 0,	//!< My_StateModes structure; may be shorter or longer in other versions
+	kMy_StateSectionTabStops	= 1,	//!< one byte per column, kMy_TabSet or kMy_TabClear
+	kMy_StateSectionTrueColors	= 2,	//!< UInt32 count, then RGB values by ID, then IDs from least to most recently used
+	kMy_StateSectionTitles		= 3,	//!< UInt32 byte counts of the window and icon titles, then both titles in UTF-8
+	kMy_StateSectionLineOffsets	= 4,	//!< for each line and the end of the last line, UInt32 offset into the lines section
+	kMy_StateSectionLines		= 5,	//!< every line, oldest scrollback line first and bottom screen line last
+										//!  (see TerminalLine_AppendEncoding())
+	kMy_StateSectionXTermColors	= 6,	//!< UInt32 count, then for each changed palette entry its UInt32 index and 0xRRGGBB value
+	kMy_StateSectionCount		= 7		//!< number of sections written by this version
+};
+
 typedef UInt32 My_LEDBits;
 enum
 {
@@ -637,16 +695,274 @@ typedef std::basic_string< UInt8 >				My_ByteString;
 
 typedef std::map< UniChar, CFRetainRelease >	My_PrintableByUniChar;
 
-typedef std::vector< UInt8 >					My_RGBComponentList;
-
 typedef std::map< void const*, char const* >	My_StringByPointer;
 
 typedef std::vector< char >						My_TabStopList;
 
-typedef std::map< UInt32, TextAttributes_TrueColorID >		My_TrueColorIDByComponentKey;
-
 typedef std::list< void const* >				My_VoidPtrList;
 
+typedef std::map< UInt8, UInt32 >				My_XTermColorByIndex;	//!< 0xRRGGBB values of palette entries changed by the application
+
+/*!
+Maps each character code below "kMy_CharacterRemapTableSize"
+to the Unicode character that should be stored in the
+screen buffer.
+*/
+struct My_CharacterRemapTable
+{
+	UniChar		codes[kMy_CharacterRemapTableSize];
+};
+
+/*!
+All the remap tables of one character set, indexed by
+My_GraphicsRemap.  These are generated at compile time
+by constructing this class with a character set (see
+the static instances returned by forCharacterSet()).
+
+The emulator picks a table set when a character set is
+designated (see My_CharacterSetInfo) so that translating
+an echoed character is a single indexed load.
+*/
+struct My_CharacterRemapTableSet
+{
+public:
+	constexpr
+	My_CharacterRemapTableSet	(My_CharacterSet	inCharacterSet)
+	: tables()
+	{
+		for (UInt16 i = 0; i < kMy_GraphicsRemapCount; ++i)
+		{
+			for (UInt16 j = 0; j < kMy_CharacterRemapTableSize; ++j)
+			{
+				UniChar const	kBaseCode = returnCharacterSetCode(inCharacterSet, STATIC_CAST(j, UInt8));
+				
+				
+				tables[i].codes[j] = (kMy_GraphicsRemapNone == i)
+										? kBaseCode
+										: returnGraphicsCode(STATIC_CAST(i, My_GraphicsRemap), STATIC_CAST(j, UInt8), kBaseCode);
+			}
+		}
+	}
+	
+	static My_CharacterRemapTableSet const&
+	forCharacterSet		(My_CharacterSet);
+	
+	//! Returns the table variant for graphics text in the given mode.
+	static inline My_GraphicsRemap
+	returnGraphicsRemap		(Boolean	inVT52,
+							 Boolean	inBold)
+	{
+		return (inVT52)
+				? ((inBold) ? kMy_GraphicsRemapVT52Bold : kMy_GraphicsRemapVT52)
+				: ((inBold) ? kMy_GraphicsRemapDECBold : kMy_GraphicsRemapDEC);
+	}
+	
+	My_CharacterRemapTable		tables[kMy_GraphicsRemapCount];
+
+protected:
+	//! Applies the rules of a national character set.
+	static constexpr UniChar
+	returnCharacterSetCode	(My_CharacterSet	inCharacterSet,
+							 UInt8				inCode)
+	{
+		// the only difference between ASCII and U.K. is that
+		// the pound sign (#) is a British currency symbol (£)
+		return ((kMy_CharacterSetVT100UnitedKingdom == inCharacterSet) && ('#' == inCode))
+				? 0x00A3
+				: inCode;
+	}
+	
+	//! Returns the Unicode character that has the intended glyph
+	//! of a graphics character, or "inDefault" if the code is not
+	//! graphical.  (INCOMPLETE: this might need terminal-emulator-
+	//! specific code.)  IMPORTANT: old drawing code currently
+	//! requires that non-graphical symbols below (e.g. degrees,
+	//! plus-minus, etc.) successfully translate to the Mac Roman
+	//! encoding.
+	static constexpr UniChar
+	returnGraphicsCode	(My_GraphicsRemap	inVariant,
+						 UInt8				inCode,
+						 UniChar			inDefault)
+	{
+		bool const	kIsBold = ((kMy_GraphicsRemapDECBold == inVariant) || (kMy_GraphicsRemapVT52Bold == inVariant));
+		bool const	kVT52 = ((kMy_GraphicsRemapVT52 == inVariant) || (kMy_GraphicsRemapVT52Bold == inVariant));
+		
+		
+		switch (inCode)
+		{
+		case '`':
+			return 0x25CA; // filled diamond; using hollow (lozenge) for now, Unicode 0x2666 is better
+		
+		case 'a':
+			return 0x2592; // checkerboard
+		
+		case 'b':
+			return 0x21E5; // horizontal tab (international symbol is a right-pointing arrow with a terminating line)
+		
+		case 'c':
+			return 0x21DF; // form feed (international symbol is an arrow pointing top to bottom with two horizontal lines through it)
+		
+		case 'd':
+			return 0x2190; // carriage return (international symbol is an arrow pointing right to left)
+		
+		case 'e':
+			return 0x2193; // line feed (international symbol is an arrow pointing top to bottom)
+		
+		case 'f':
+			return 0x00B0; // degrees (same in VT52)
+		
+		case 'g':
+			return 0x00B1; // plus or minus (same in VT52)
+		
+		case 'h':
+			return 0x21B5; // new line (international symbol is an arrow that hooks from mid-top to mid-left)
+		
+		case 'i':
+			return 0x2913; // vertical tab (international symbol is a down-pointing arrow with a terminating line)
+		
+		case 'j':
+			if (kVT52)
+			{
+				return 0x00F7; // division
+			}
+			else
+			{
+				return (kIsBold) ? 0x251B : 0x2518; // hook mid-top to mid-left
+			}
+		
+		case 'k':
+			return (kIsBold) ? 0x2513 : 0x2510; // hook mid-left to mid-bottom
+		
+		case 'l':
+			return (kIsBold) ? 0x250F : 0x250C; // hook mid-right to mid-bottom
+		
+		case 'm':
+			return (kIsBold) ? 0x2517 : 0x2514; // hook mid-top to mid-right
+		
+		case 'n':
+			return (kIsBold) ? 0x254B : 0x253C; // cross
+		
+		case 'o':
+			return 0x23BA; // top line
+		
+		case 'p':
+			return 0x23BB; // line between top and middle regions
+		
+		case 'q':
+			return (kIsBold) ? 0x2501 : 0x2500; // middle line
+		
+		case 'r':
+			return 0x23BC; // line between middle and bottom regions
+		
+		case 's':
+			return 0x23BD; // bottom line
+		
+		case 't':
+			return (kIsBold) ? 0x2523 : 0x251C; // cross minus the left piece
+		
+		case 'u':
+			return (kIsBold) ? 0x252B : 0x2524; // cross minus the right piece
+		
+		case 'v':
+			return (kIsBold) ? 0x253B : 0x2534; // cross minus the bottom piece
+		
+		case 'w':
+			return (kIsBold) ? 0x2533 : 0x252C; // cross minus the top piece
+		
+		case 'x':
+			return (kIsBold) ? 0x2503 : 0x2502; // vertical line
+		
+		case 'y':
+			return 0x2264; // less than or equal to
+		
+		case 'z':
+			return 0x2265; // greater than or equal to
+		
+		case '{':
+			return 0x03C0; // pi
+		
+		case '|':
+			return 0x2260; // not equal to
+		
+		case '}':
+			return 0x00A3; // British pounds (currency) symbol
+		
+		case '~':
+			if (kVT52)
+			{
+				return 0x00B6; // pilcrow (paragraph) sign
+			}
+			else
+			{
+				return 0x2027; // centered dot
+			}
+		
+		case 159:
+			return 0x0192; // small 'f' with hook
+		
+		case 224:
+			return 0x03B1; // alpha
+		
+		case 225:
+			return 0x00DF; // beta
+		
+		case 226:
+			return 0x0393; // capital gamma
+		
+		case 227:
+			return 0x03C0; // pi
+		
+		case 228:
+			return 0x03A3; // capital sigma
+		
+		case 229:
+			return 0x03C3; // sigma
+		
+		case 230:
+			return 0x00B5; // mu
+		
+		case 231:
+			return 0x03C4; // tau
+		
+		case 232:
+			return 0x03A6; // capital phi
+		
+		case 233:
+			return 0x0398; // capital theta
+		
+		case 234:
+			return 0x03A9; // capital omega
+		
+		case 235:
+			return 0x03B4; // delta
+		
+		case 237:
+			return 0x03C6; // phi
+		
+		case 238:
+			return 0x03B5; // epsilon
+		
+		case 251:
+			return 0x221A; // square root left edge
+		
+		default:
+			break;
+		}
+		
+		return inDefault;
+	}
+};
+
+My_CharacterRemapTableSet const&
+My_CharacterRemapTableSet::forCharacterSet	(My_CharacterSet	inCharacterSet)
+{
+	static constexpr My_CharacterRemapTableSet		kUnitedKingdom(kMy_CharacterSetVT100UnitedKingdom);
+	static constexpr My_CharacterRemapTableSet		kUnitedStates(kMy_CharacterSetVT100UnitedStates);
+	
+	
+	return (kMy_CharacterSetVT100UnitedKingdom == inCharacterSet) ? kUnitedKingdom : kUnitedStates;
+}
+
 /*!
 All the information associated with either the G0 or G1
 character sets in a VT terminal.
@@ -657,13 +973,25 @@ public:
 	My_CharacterSetInfo		(My_CharacterSet	inTranslationTable,
 							 My_CharacterROM	inSource,
 							 My_GraphicsMode	inGraphicsMode)
-	: translationTable(inTranslationTable), source(inSource), graphicsMode(inGraphicsMode)
+	: translationTable(inTranslationTable), remapTablesPtr(&My_CharacterRemapTableSet::forCharacterSet(inTranslationTable)),
+	  source(inSource), graphicsMode(inGraphicsMode)
+	{
+	}
+	
+	//! Changes the translation rules; always use this instead of
+	//! setting "translationTable" directly, so that the matching
+	//! remap tables are used by translateCharacter().
+	void
+	setTranslationTable		(My_CharacterSet	inTranslationTable)
 	{
+		translationTable = inTranslationTable;
+		remapTablesPtr = &My_CharacterRemapTableSet::forCharacterSet(inTranslationTable);
 	}
 	
-	My_CharacterSet		translationTable;	//!< what character code translation rules are used?
-	My_CharacterROM		source;				//!< which ROM are characters coming from?
-	My_GraphicsMode		graphicsMode;		//!< can graphics glyphs appear?
+	My_CharacterSet						translationTable;	//!< what character code translation rules are used?
+	My_CharacterRemapTableSet const*	remapTablesPtr;		//!< lookup tables for "translationTable" (see setTranslationTable())
+	My_CharacterROM						source;				//!< which ROM are characters coming from?
+	My_GraphicsMode						graphicsMode;		//!< can graphics glyphs appear?
 };
 typedef My_CharacterSetInfo*			My_CharacterSetInfoPtr;
 typedef My_CharacterSetInfo const*		My_CharacterSetInfoConstPtr;
@@ -805,6 +1133,17 @@ public:
 				: **scrollbackRowIterator;
 	}
 	
+	//! Like currentLine() but returns the handle, so that a caller
+	//! that only reads the line does not allocate unique data for
+	//! a shared blank line (see TerminalLine_Handle).
+	My_ScreenBufferLinePtr&
+	currentLinePtr ()
+	{
+		return (currentBufferType == kBufferTargetScreen)
+				? *screenRowIterator
+				: *scrollbackRowIterator;
+	}
+	
 	//! Returns either the oldest scrollback line, or the topmost
 	//! main screen line when the scrollback is empty.
 	My_ScreenBufferLine&
@@ -930,6 +1269,149 @@ STATIC_ASSERT(sizeof(Terminal_LineStackStorage) == sizeof(My_LineIterator),
 
 typedef My_LineIterator*	My_LineIteratorPtr;
 
+/*!
+Stores the 24-bit colors used by a terminal, assigning each
+one a TextAttributes_TrueColorID so that text attributes
+remain compact.
+
+Colors are found by RGB value in an open-addressed hash
+index (linear probing) and the RGB value of each ID is kept
+in an array that is also a reverse index; when an ID is
+reused, its previous entry is removed from the hash index
+directly instead of by searching.
+
+When every ID is taken, the least recently used ID is
+reused.  Since an ID is “used” whenever it is defined or
+looked up (i.e. drawn), colors that are still visible are
+not recycled while older ones exist.  The usage order is
+a doubly-linked list threaded through arrays indexed by
+ID, so that each use takes constant time.
+*/
+class My_TrueColorTable
+{
+public:
+	My_TrueColorTable ();
+	
+	Boolean
+	getColor	(TextAttributes_TrueColorID, UInt8&, UInt8&, UInt8&);
+	
+	size_t
+	returnColorCount () const
+	{
+		return rgbKeysByID.size();
+	}
+	
+	void
+	copyColors	(std::vector< UInt32 >&, std::vector< UInt32 >&) const;
+	
+	TextAttributes_TrueColorID
+	returnColorID	(UInt8, UInt8, UInt8);
+	
+	Boolean
+	setColors	(UInt32 const*, UInt32 const*, size_t);
+
+protected:
+	struct IndexSlot
+	{
+		UInt32						rgbKey;		//!< RGB value, or "kMy_TrueColorIndexEmptyKey"
+		TextAttributes_TrueColorID	colorID;	//!< ID assigned to the RGB value
+	};
+	
+	size_t
+	findSlot	(UInt32) const;
+	
+	void
+	growIndex ();
+	
+	void
+	removeKey	(UInt32);
+	
+	static UInt32
+	returnHash	(UInt32);
+	
+	void
+	useID	(UInt32);
+
+private:
+	std::vector< IndexSlot >	indexSlots;			//!< hash index of RGB values; size is a power of 2
+	UInt32						indexMask;			//!< one less than the size of "indexSlots"
+	std::vector< UInt32 >		rgbKeysByID;		//!< RGB value of each ID (reverse index)
+	std::vector< UInt32 >		newerIDByID;		//!< for each ID, the next more-recently-used ID (or "kMy_TrueColorNoID")
+	std::vector< UInt32 >		olderIDByID;		//!< for each ID, the next less-recently-used ID (or "kMy_TrueColorNoID")
+	UInt32						newestID;			//!< most recently used ID (or "kMy_TrueColorNoID")
+	UInt32						oldestID;			//!< least recently used ID, the next to be reused (or "kMy_TrueColorNoID")
+};
+
+/*!
+The fixed part of saved terminal state, which is followed
+by a table with the location of each section (indexed by
+My_StateSection values).  Values are in the byte order of
+the computer that saved the state.
+*/
+struct My_StateHeader
+{
+	UInt32		signature;				//!< "kMy_StateSignature"
+	UInt32		byteOrderMark;			//!< "kMy_StateByteOrderMark"
+	UInt16		version;				//!< "kMy_StateVersion" when the state was saved
+	UInt16		sectionCount;			//!< number of entries in the section table that follows
+	UInt16		columnCount;			//!< visible columns of the screen
+	UInt16		rowCount;				//!< lines of the screen
+	UInt32		scrollbackLineCount;	//!< lines above the screen
+	UInt32		reserved;				//!< zero; keeps the section table aligned
+};
+
+/*!
+Where a section of saved terminal state is, relative to the
+start of the header.
+*/
+struct My_StateSectionRange
+{
+	UInt64		offset;		//!< always a multiple of "kMy_StateAlignment"
+	UInt64		byteCount;	//!< zero if the section is empty
+};
+
+/*!
+Cursor, modes and character sets of saved terminal state.
+Fields may only be added at the end; when older state is
+read, any fields that it does not have are zero.
+*/
+struct My_StateModes
+{
+	UInt32		drawingAttributesUpper;			//!< upper word of current attributes for new text
+	UInt32		drawingAttributesLower;			//!< lower word of current attributes for new text
+	UInt32		inlineForegroundRGB;			//!< inline foreground color for new text
+	UInt32		inlineBackgroundRGB;			//!< inline background color for new text
+	UInt32		savedAttributesUpper;			//!< upper word of attributes saved with the cursor
+	UInt32		savedAttributesLower;			//!< lower word of attributes saved with the cursor
+	UInt32		savedInlineForegroundRGB;		//!< inline foreground color saved with the cursor
+	UInt32		savedInlineBackgroundRGB;		//!< inline background color saved with the cursor
+	UInt32		litLEDs;						//!< My_LEDBits
+	UInt16		cursorColumn;					//!< zero-based
+	UInt16		cursorRow;						//!< zero-based, from the top of the screen
+	UInt16		savedCursorColumn;				//!< position saved by the emulator
+	UInt16		savedCursorRow;					//!< position saved by the emulator
+	UInt16		scrollingRegionFirstRow;		//!< custom margins
+	UInt16		scrollingRegionLastRow;			//!< custom margins
+	UInt16		cursorType;						//!< Terminal_CursorType
+	UInt8		activeCharacterSet;				//!< 0 for G0 through 3 for G3
+	UInt8		characterSetTables[4];			//!< My_CharacterSet of G0 through G3
+	UInt8		characterSetSources[4];			//!< My_CharacterROM of G0 through G3
+	UInt8		characterSetGraphics[4];		//!< My_GraphicsMode of G0 through G3
+	UInt8		cursorBlinking;					//!< Boolean
+	UInt8		cursorVisible;					//!< Boolean
+	UInt8		reverseVideo;					//!< Boolean
+	UInt8		saveToScrollbackOnClear;		//!< Boolean
+	UInt8		wrapPending;					//!< Boolean
+	UInt8		modeANSIEnabled;				//!< Boolean
+	UInt8		modeApplicationKeys;			//!< Boolean
+	UInt8		modeAutoWrap;					//!< Boolean
+	UInt8		modeCursorKeysForApp;			//!< Boolean
+	UInt8		modeInsertNotReplace;			//!< Boolean
+	UInt8		modeNewLineOption;				//!< Boolean
+	UInt8		modeOriginRedefined;			//!< Boolean
+	UInt8		modeBracketedPaste;				//!< Boolean
+};
+
 /*!
 Represents the state of a terminal emulator, such as any
 parameters collected and any pending operations.
@@ -1051,11 +1533,7 @@ public:
 	Callbacks							currentCallbacks;		//!< emulator-type-specific handlers to drive the state machine
 	Callbacks							pushedCallbacks;		//!< for emulators that can switch modes, the previous set of callbacks
 	VariantFlags						supportedVariants;		//!< tags identifying minor features, e.g. 256-color support
-	My_TrueColorIDByComponentKey		trueColorIDsByRGB;		//!< maps RGB elements to their table index value (ID), if any
-	My_RGBComponentList*				trueColorTableReds;		//!< red components for all 24-bit colors; allocated only for supporting terminals
-	My_RGBComponentList*				trueColorTableGreens;	//!< green components for all 24-bit colors; allocated only for supporting terminals
-	My_RGBComponentList*				trueColorTableBlues;	//!< blue components for all 24-bit colors; allocated only for supporting terminals
-	TextAttributes_TrueColorID			trueColorTableNextID;	//!< basis for new IDs; current entry for storing new colors in true-color table
+	My_TrueColorTable*					trueColorTable;			//!< all 24-bit colors and their IDs; allocated only for supporting terminals
 	TextAttributes_BitmapID				bitmapTableNextID;		//!< basis for new IDs; current entry for storing new bitmaps in bitmap table
 	NSMutableArray* __strong			bitmapImageTable;		//!< NSArray of NSImage*; shared (“whole image”) bitmap representations by index (ID)
 	NSMutableArray* __strong			bitmapSegmentTable;		//!< NSArray of NSValue* (holding NSRect); single-cell bitmap sub-rectangles by index (ID)
@@ -1153,6 +1631,7 @@ public:
 																	//!  TEMPORARY: the speaker REALLY shouldn’t be part of the terminal data model!
 	CFRetainRelease						windowTitleCFString;		//!< stores the string that the terminal considers its window title
 	CFRetainRelease						iconTitleCFString;			//!< stores the string that the terminal considers its icon title
+	My_XTermColorByIndex				xtermColors;				//!< palette entries (16-255) that the application has changed
 	
 	ListenerModel_Ref					changeListenerModel;		//!< registry of listeners for various terminal events
 	ListenerModel_ListenerWrap			preferenceMonitor;			//!< listener for changes to preferences that affect a particular screen
@@ -1196,6 +1675,11 @@ public:
 	StreamCapture_Ref					captureStream;				//!< used to stream data to a file chosen by the user
 	StreamCapture_Ref					printingStream;				//!< used to stream data to a temporary file for later printing
 	CFRetainRelease						printingFileURL;			//!< URL of the temporary printing file
+	std::vector< UInt8 >				echoConversionBuffer;		//!< reused by echoCFString() when text must be converted for streams
+	LinkScanner_URITableRef				linkURIs;					//!< targets of hyperlinks that the application defined (see "OSC 8");
+																	//!  lines refer to them by ID
+	TimerWheel_TimerRef					linkScanTimer;				//!< armed when text is written, so that changed lines are scanned for links
+																	//!  at most once per "kMy_LinkScanDelay" (see linkScanTimerFired())
 	UInt8								printingModes;				//!< MC private (VT102): true only if terminal-rendered lines are also sent to the printer
 	Boolean								bellDisabled;				//!< if true, all bell signals are completely ignored (no audio or visual)
 	Terminal_CursorType					cursorType;					//!< cursor shape (from viewpoint of program running in terminal)
@@ -1246,11 +1730,15 @@ public:
 	Boolean								reportOnlyOnRequest;		//!< DECREQTPARM mode: determines response format and timing
 	Boolean								wrapPending;				//!< set only when a character is echoed in final column
 	
+	Boolean								modeAlternateScreen;		//!< XTerm modes 47, 1047 and 1049: true only if the application has asked for
+																	//!  the alternate screen (see Terminal_AlternateScreenIsActive())
 	Boolean								modeANSIEnabled;			//!< DECANM mode: true only if in ANSI mode (as opposed to VT52 compatibility
 																	//!  mode); if the former, parameters are only recognized following the CSI
 																	//!  sequence, but if the latter, ESC-character sequences are allowed instead
 	Boolean								modeApplicationKeys;		//!< DECKPAM mode: true only if the keypad is in application mode
 	Boolean								modeAutoWrap;				//!< DECAWM mode: true only if line wrapping is automatic
+	Boolean								modeBracketedPaste;			//!< XTerm mode 2004: true only if the application wants pasted text
+																	//!  to be enclosed in markers (see Terminal_BracketedPasteIsEnabled())
 	Boolean								modeCursorKeysForApp;		//!< DECCKM mode: true only if the keypad should not act as cursor movement arrows
 																	//!  (note also that the VT100 manual states this setting has no effect unless
 																	//!  the terminal is also in ANSI mode and the keypad is in application mode
@@ -1281,7 +1769,8 @@ public:
 		drawingAttributes(),
 		cursorX(0),
 		cursorY(0),
-		characterSetInfoPtr(nullptr)
+		characterSetInfoPtr(nullptr),
+		hyperlinkID(0)
 		{
 		}
 		
@@ -1302,21 +1791,25 @@ public:
 		struct My_ScreenBuffer const&	parent;
 		TextAttributes_Object			cursorAttributes;		//!< text attributes for the position under the cursor; useful for rendering the cursor
 																//!  in a way that does not clash with these attributes (e.g. by choosing opposite colors)
+		TextAttributes_InlineColors		cursorInlineColors;		//!< 24-bit colors for parts of "cursorAttributes" that set an inline-color bit
 		TextAttributes_Object			drawingAttributes;		//!< text attributes for the line the cursor is on; these should be updated as the cursor
 																//!  moves, or as terminal sequences are processed by the emulator
 		TextAttributes_Object			latentAttributes;		//!< used to implement Background Color Erase; records the most recent attribute settings
 																//!  (currently for background color bits ONLY, this is NOT properly updated for other
 																//!  attribute changes)
+		TextAttributes_InlineColors		inlineColors;			//!< 24-bit colors for parts of "drawingAttributes" that set an inline-color bit
 		SInt16							cursorX;				//!< column number of current cursor position;
 																//!  WARNING: do not change this value except with a moveCursor...() routine
 		My_ScreenRowIndex				cursorY;				//!< row number of current cursor position;
 																//!  WARNING: do not change this value except with a moveCursor...() routine
 		My_CharacterSetInfoPtr			characterSetInfoPtr;	//!< pointer to either G0 or G1 character rules, whichever is active
+		UInt32							hyperlinkID;			//!< if nonzero, echoed text is part of this hyperlink (an ID in "linkURIs")
 	} current;
 	
 	struct
 	{
 		TextAttributes_Object		drawingAttributes;	//!< previous bits of corresponding bits in "current" structure
+		TextAttributes_InlineColors	inlineColors;		//!< previous value of corresponding value in "current" structure
 		SInt16						cursorX;			//!< previous value of corresponding value in "current" structure
 		My_ScreenRowIndex			cursorY;			//!< previous value of corresponding value in "current" structure
 	} previous;
@@ -1622,7 +2115,7 @@ public:
 	static void		selectCursorStyle					(My_ScreenBufferPtr);
 	static void		selectiveEraseInDisplay				(My_ScreenBufferPtr);
 	static void		selectiveEraseInLine				(My_ScreenBufferPtr);
-
+	
 	// The names of these constants use the same mnemonics from
 	// the programming manual of the original terminal.
 	enum State
@@ -1785,6 +2278,8 @@ public:
 		kStateSWTAcquireStr		= kMy_ParserStateSeenESCRightSqBracket2Semi,			//!< seen ESC]2, gathering characters of string
 		kStateSetColor			= kMy_ParserStateSeenESCRightSqBracket4,				//!< subsequent string is a color specification
 		kStateColorAcquireStr	= kMy_ParserStateSeenESCRightSqBracket4Semi,			//!< seen ESC]4, gathering characters of string
+		kStateHyperlink			= kMy_ParserStateSeenESCRightSqBracket8,				//!< subsequent string defines (or ends) a hyperlink
+		kStateHyperlinkAcquireStr	= kMy_ParserStateSeenESCRightSqBracket8Semi,		//!< seen ESC]8, gathering parameters and URI
 	};
 };
 
@@ -1812,6 +2307,7 @@ typedef My_SearchThreadContext const*	My_SearchThreadContextConstPtr;
 #pragma mark Internal Method Prototypes
 namespace {
 
+void						appendStateSection						(std::vector< UInt8 >&, size_t, My_StateSectionRange&, void const*, size_t);
 void						assertScrollingRegion					(My_ScreenBufferPtr);
 void						bufferEraseCursorLine					(My_ScreenBufferPtr, My_BufferChanges);
 void						bufferEraseFromCursorColumn				(My_ScreenBufferPtr, My_BufferChanges, UInt16);
@@ -1850,6 +2346,7 @@ Boolean						defineTrueColor							(My_ScreenBufferPtr, UInt8, UInt8, UInt8, Tex
 void						deleteLinePtr							(My_ScreenBufferLinePtr&);
 void						echoCFString							(My_ScreenBufferPtr, CFStringRef);
 void						eraseRightHalfOfLine					(My_ScreenBufferPtr, My_ScreenBufferLine&);
+Boolean						findStateSection						(UInt8 const*, size_t, My_StateSection, UInt8 const*&, size_t&);
 inline My_LineIteratorPtr	getLineIterator							(Terminal_LineRef);
 void						getParametersFromStringAccumulator		(My_ScreenBufferPtr, ParameterDecoder_StateMachine&,
 																	 std::basic_string< UInt8 >::const_iterator&);
@@ -1858,6 +2355,7 @@ void						getParametersFromStringRange			(std::basic_string< UInt8 >::const_iter
 My_ScreenBufferPtr			getVirtualScreenData					(TerminalScreenRef);
 void						highlightLED							(My_ScreenBufferPtr, SInt16);
 My_StringByPointer			initCallbackIDsByFuncPtr				();
+void						linkScanTimerFired						(TimerWheel_TimerRef, void*);
 void						locateCursorLine						(My_ScreenBufferPtr, My_ScreenBufferLineList::iterator&);
 void						locateScrollingRegion					(My_ScreenBufferPtr, My_ScreenBufferLineList::iterator&,
 																	 My_ScreenBufferLineList::iterator&);
@@ -1878,8 +2376,13 @@ void						moveCursorUp							(My_ScreenBufferPtr);
 void						moveCursorUpOrScroll					(My_ScreenBufferPtr);
 void						moveCursorX								(My_ScreenBufferPtr, SInt16);
 void						moveCursorY								(My_ScreenBufferPtr, My_ScreenRowIndex);
+TerminalScreenRef			newTestScreen							(UInt16, UInt16, UInt32);
+Boolean						readStateXTermColors					(UInt8 const*, size_t, My_XTermColorByIndex&);
 void						resetTerminal							(My_ScreenBufferPtr, Boolean = false);
+TextAttributes_InlineColors	returnInlineColorsAt					(My_ScreenBufferLinePtr const&, SInt16);
+UInt32						returnLineMismatchCount					(My_ScreenBufferLineList const&, My_ScreenBufferLineList const&, UInt16);
 SessionRef					returnListeningSession					(My_ScreenBufferPtr);
+void						scanLineForLinks						(My_ScreenBufferConstPtr, My_ScreenBufferLine&);
 Boolean						screenCopyLinesToScrollback				(My_ScreenBufferPtr);
 Boolean						screenInsertNewLines					(My_ScreenBufferPtr, My_ScreenBufferLineList::size_type);
 Boolean						screenMoveLinesToScrollback				(My_ScreenBufferPtr, My_ScreenBufferLineList::size_type);
@@ -1888,6 +2391,7 @@ void						setCursorVisible						(My_ScreenBufferPtr, Boolean);
 void						setScrollbackSize						(My_ScreenBufferPtr, UInt32);
 Terminal_Result				setVisibleColumnCount					(My_ScreenBufferPtr, UInt16);
 Terminal_Result				setVisibleRowCount						(My_ScreenBufferPtr, UInt16);
+Boolean						shouldRenderAsGraphics					(UnicodeScalarValue);
 CFStringRef					stringByStrippingEndWhitespace			(CFStringRef);
 // IMPORTANT: Attribute bit manipulation is fully described in "TextAttributes.h".
 //            Changes must be kept consistent everywhere.  See below, for usage.
@@ -1901,6 +2405,17 @@ void						tabStopInitialize						(My_ScreenBufferPtr);
 void*						threadForTerminalSearch					(void*);
 UniChar						translateCharacter						(My_ScreenBufferPtr, UnicodeScalarValue, TextAttributes_Object,
 																	 TextAttributes_Object&);
+UniChar						translateCharacterForSet				(My_CharacterSetInfo const&, Boolean, UnicodeScalarValue,
+																	 TextAttributes_Object, TextAttributes_Object&);
+UniChar						translateCharacterReference				(My_CharacterSet, Boolean, UnicodeScalarValue,
+																	 TextAttributes_Object, TextAttributes_Object&);
+Boolean						unitTest_InlineColors_000				();
+Boolean						unitTest_SerializeState_000				();
+Boolean						unitTest_SerializeState_001				();
+Boolean						unitTest_SerializeState_002				();
+Boolean						unitTest_TranslateCharacter_000			();
+Boolean						unitTest_TrueColorTable_000				();
+Boolean						unitTest_TrueColorTable_001				();
 
 } // anonymous namespace
 
@@ -1918,6 +2433,35 @@ My_RefTracker&					gTerminalScreenValidRefs ()	{ static My_RefTracker x; return
 
 #pragma mark Public Methods
 
+/*!
+A unit test for this module.  This should always
+be run before a release, after any substantial
+changes are made, or if you suspect bugs!  It
+should also be EXPANDED as new functionality is
+proposed (ideally, a test is written before the
+functionality is added).
+
+(2021.06)
+*/
+void
+Terminal_RunTests ()
+{
+	UInt16		totalTests = 0;
+	UInt16		failedTests = 0;
+	
+	
+	++totalTests; if (false == unitTest_InlineColors_000()) ++failedTests;
+	++totalTests; if (false == unitTest_SerializeState_000()) ++failedTests;
+	++totalTests; if (false == unitTest_SerializeState_001()) ++failedTests;
+	++totalTests; if (false == unitTest_SerializeState_002()) ++failedTests;
+	++totalTests; if (false == unitTest_TranslateCharacter_000()) ++failedTests;
+	++totalTests; if (false == unitTest_TrueColorTable_000()) ++failedTests;
+	++totalTests; if (false == unitTest_TrueColorTable_001()) ++failedTests;
+	
+	Console_WriteUnitTestReport("Terminal", failedTests, totalTests);
+}// RunTests
+
+
 /*!
 Creates a new terminal screen and initial view according
 to the given specifications.
@@ -2214,6 +2758,29 @@ Terminal_DisposeLineIterator	(Terminal_LineRef*		inoutRefPtr)
 }// DisposeLineIterator
 
 
+/*!
+Returns "true" only if the application running in the
+terminal has asked for the alternate screen (XTerm modes
+47, 1047 and 1049), which usually means that it is a
+full-screen program such as a text editor.
+
+(2021.06)
+*/
+Boolean
+Terminal_AlternateScreenIsActive	(TerminalScreenRef	inRef)
+{
+	My_ScreenBufferPtr	dataPtr = getVirtualScreenData(inRef);
+	Boolean				result = false;
+	
+	
+	if (nullptr != dataPtr)
+	{
+		result = dataPtr->modeAlternateScreen;
+	}
+	return result;
+}// AlternateScreenIsActive
+
+
 /*!
 Returns "true" only if the given terminal’s bell is
 active.  An inactive bell completely ignores all
@@ -2332,11 +2899,36 @@ Terminal_BitmapGetFromID	(TerminalScreenRef			inRef,
 
 
 /*!
-Applies the specified changes to every single attribute
-for a single line of the screen buffer (no effect on
-the display until the next redraw). Also updates the
-“current” attributes, if the cursor happens to be on
-the specified line.
+Returns "true" only if the application running in the
+terminal has turned on bracketed paste mode (XTerm mode
+2004).  In this mode, pasted text should be sent between
+the sequences ESC [ 2 0 0 ~ and ESC [ 2 0 1 ~, so that
+the application can tell it apart from typed text (and,
+for instance, not run each pasted line as a command).
+
+(2021.06)
+*/
+Boolean
+Terminal_BracketedPasteIsEnabled	(TerminalScreenRef	inRef)
+{
+	My_ScreenBufferPtr	dataPtr = getVirtualScreenData(inRef);
+	Boolean				result = false;
+	
+	
+	if (nullptr != dataPtr)
+	{
+		result = dataPtr->modeBracketedPaste;
+	}
+	return result;
+}// BracketedPasteIsEnabled
+
+
+/*!
+Applies the specified changes to every single attribute
+for a single line of the screen buffer (no effect on
+the display until the next redraw). Also updates the
+“current” attributes, if the cursor happens to be on
+the specified line.
 
 The row value may be negative, signifying a scrollback
 buffer row.
@@ -2567,6 +3159,102 @@ Terminal_ChangeRangeAttributes	(TerminalScreenRef			inRef,
 }// ChangeRangeAttributes
 
 
+/*!
+Finds the link that includes the given column of a line,
+and returns its range of columns and its target.  Hyperlinks
+that the application defined (with the "OSC 8" sequence)
+take precedence over URLs in the text; if the text of the
+line changed since it was last scanned, it is scanned now.
+
+IMPORTANT:	If the result is "kTerminal_ResultOK", you must
+			eventually use CFRelease() on the returned URI.
+
+\retval kTerminal_ResultOK
+if there is a link at the given column
+
+\retval kTerminal_ResultInvalidID
+if the specified screen reference is invalid
+
+\retval kTerminal_ResultInvalidIterator
+if the specified row reference is invalid
+
+\retval kTerminal_ResultParameterError
+if there is no link at the given column (or the target of
+the hyperlink is no longer known)
+
+(2021.06)
+*/
+Terminal_Result
+Terminal_CopyLinkAtColumn	(TerminalScreenRef		inRef,
+							 Terminal_LineRef		inRow,
+							 UInt16					inZeroBasedColumn,
+							 UInt16&				outStartColumn,
+							 UInt16&				outPastTheEndColumn,
+							 CFStringRef&			outURICFString)
+{
+	My_ScreenBufferPtr		dataPtr = getVirtualScreenData(inRef);
+	My_LineIteratorPtr		iteratorPtr = getLineIterator(inRow);
+	Terminal_Result			result = kTerminal_ResultParameterError;
+	
+	
+	outURICFString = nullptr;
+	if (nullptr == dataPtr) result = kTerminal_ResultInvalidID;
+	else if (nullptr == iteratorPtr) result = kTerminal_ResultInvalidIterator;
+	else
+	{
+		// only read through a constant handle, so that pointing
+		// at a blank line does not allocate data for the line
+		My_ScreenBufferLinePtr const&	kLinePtr = iteratorPtr->currentLinePtr();
+		auto							findLink = [inZeroBasedColumn] (TerminalLine_LinkList const& inLinks)
+										{
+											return std::find_if(inLinks.begin(), inLinks.end(),
+																[inZeroBasedColumn] (TerminalLine_Link const& inLink)
+																{
+																	return ((inLink.startColumn <= inZeroBasedColumn) &&
+																			(inZeroBasedColumn < inLink.pastTheEndColumn));
+																});
+										};
+		auto const						toExplicitLink = findLink(kLinePtr->returnExplicitLinks());
+		std::string						uriUTF8;
+		
+		
+		if ((kLinePtr->returnExplicitLinks().end() != toExplicitLink) &&
+			LinkScanner_GetURI(dataPtr->linkURIs, toExplicitLink->linkID, uriUTF8))
+		{
+			outURICFString = CFStringCreateWithBytes(kCFAllocatorDefault, REINTERPRET_CAST(uriUTF8.data(), UInt8 const*),
+														uriUTF8.size(), kCFStringEncodingUTF8, false/* is external representation */);
+			outStartColumn = toExplicitLink->startColumn;
+			outPastTheEndColumn = toExplicitLink->pastTheEndColumn;
+		}
+		else
+		{
+			if (kLinePtr->isLinkScanNeeded())
+			{
+				scanLineForLinks(dataPtr, *(iteratorPtr->currentLinePtr()));
+			}
+			
+			auto const	toScannedLink = findLink(kLinePtr->returnScannedLinks());
+			
+			
+			if (kLinePtr->returnScannedLinks().end() != toScannedLink)
+			{
+				// the text of a URL is its own target
+				outURICFString = CFStringCreateWithCharacters(kCFAllocatorDefault, kLinePtr->textVectorBegin + toScannedLink->startColumn,
+																toScannedLink->pastTheEndColumn - toScannedLink->startColumn);
+				outStartColumn = toScannedLink->startColumn;
+				outPastTheEndColumn = toScannedLink->pastTheEndColumn;
+			}
+		}
+		
+		if (nullptr != outURICFString)
+		{
+			result = kTerminal_ResultOK;
+		}
+	}
+	return result;
+}// CopyLinkAtColumn
+
+
 /*!
 Returns the title assigned to the iconified version of this
 terminal.  In MacTerm this is symbolic, as no assumption is
@@ -2704,6 +3392,25 @@ Terminal_CursorReturnAttributes		(TerminalScreenRef		inRef)
 }// CursorReturnAttributes
 
 
+/*!
+Provides the 24-bit colors of the position currently occupied
+by the cursor, for any part of Terminal_CursorReturnAttributes()
+that sets an inline-color bit (otherwise, the colors should be
+ignored).
+
+(2021.06)
+*/
+TextAttributes_InlineColors
+Terminal_CursorReturnInlineColors	(TerminalScreenRef		inRef)
+{
+	My_ScreenBufferPtr				dataPtr = getVirtualScreenData(inRef);
+	TextAttributes_InlineColors		result = dataPtr->current.cursorInlineColors;
+	
+	
+	return result;
+}// CursorReturnInlineColors
+
+
 /*!
 Writes arbitrary debugging information to the console for the
 specified terminal screen.
@@ -2726,6 +3433,7 @@ Terminal_DebugDumpDetailedSnapshot		(TerminalScreenRef		inRef)
 																			dataPtr->originRegionPtr->lastRow);
 	Console_WriteValue("Mode: ANSI", dataPtr->modeANSIEnabled);
 	Console_WriteValue("Mode: auto-wrap", dataPtr->modeAutoWrap);
+	Console_WriteValue("Mode: bracketed paste", dataPtr->modeBracketedPaste);
 	Console_WriteValue("Mode: cursor keys for application", dataPtr->modeCursorKeysForApp);
 	Console_WriteValue("Mode: application keys", dataPtr->modeApplicationKeys);
 	Console_WriteValue("Mode: origin redefined", dataPtr->modeOriginRedefined);
@@ -2800,6 +3508,371 @@ Terminal_DeleteAllSavedLines	(TerminalScreenRef		inRef)
 }// DeleteAllSavedLines
 
 
+/*!
+Replaces the screen, scrollback, cursor, modes, tab stops,
+character sets, titles, true colors and XTerm palette changes
+of a terminal with state that was saved by
+Terminal_SerializeState().  The screen is resized to the
+saved dimensions.  Palette entries that the saved state does
+not change are not reset.
+
+The data is read in place (lines are decoded directly into
+the terminal), so it can be a file that is mapped into
+memory; but it must start at a multiple of 8 bytes.  If the
+saved scrollback is bigger than the terminal allows, only
+the newest lines are restored and the others are not even
+decoded.
+
+Everything is checked before the terminal is changed, so
+if any error is returned the terminal is exactly as it was.
+
+\retval kTerminal_ResultOK
+if the state is restored
+
+\retval kTerminal_ResultInvalidID
+if the given terminal screen reference is invalid
+
+\retval kTerminal_ResultParameterError
+if the data pointer is nullptr or is not aligned
+
+\retval kTerminal_ResultFormatError
+if the data is truncated or damaged, was saved by a computer
+with a different byte order or by a newer version that is
+not compatible, or has dimensions that are not supported
+
+(2021.06)
+*/
+Terminal_Result
+Terminal_DeserializeState	(TerminalScreenRef		inRef,
+							 void const*			inData,
+							 size_t					inByteCount)
+{
+	Terminal_Result			result = kTerminal_ResultOK;
+	My_ScreenBufferPtr		dataPtr = getVirtualScreenData(inRef);
+	UInt8 const*			stateBytes = REINTERPRET_CAST(inData, UInt8 const*);
+	
+	
+	if (nullptr == dataPtr) result = kTerminal_ResultInvalidID;
+	else if ((nullptr == inData) || (0 != (REINTERPRET_CAST(inData, uintptr_t) % kMy_StateAlignment)))
+	{
+		result = kTerminal_ResultParameterError;
+	}
+	else if (inByteCount < sizeof(My_StateHeader))
+	{
+		result = kTerminal_ResultFormatError;
+	}
+	else
+	{
+		My_StateHeader const&				header = *REINTERPRET_CAST(stateBytes, My_StateHeader const*);
+		My_StateModes						modes;
+		My_ScreenBufferLineList				screenLines;
+		My_ScrollbackBufferLineList			scrollbackLines;
+		My_ScrollbackBufferLineList::size_type	scrollbackLineCount = 0;
+		My_TrueColorTable					trueColors;
+		CFRetainRelease						windowTitleCFString;
+		CFRetainRelease						iconTitleCFString;
+		My_XTermColorByIndex				xtermColors;
+		UInt8 const*						tabStopBytes = nullptr;
+		size_t								tabStopCount = 0;
+		UInt8 const*						sectionPtr = nullptr;
+		size_t								sectionSize = 0;
+		
+		
+		bzero(&modes, sizeof(modes));
+		
+		if ((kMy_StateSignature != header.signature) || (kMy_StateByteOrderMark != header.byteOrderMark) ||
+			(header.version > kMy_StateVersion) ||
+			(((inByteCount - sizeof(My_StateHeader)) / sizeof(My_StateSectionRange)) < header.sectionCount) ||
+			(0 == header.columnCount) || (header.columnCount > Terminal_ReturnAllocatedColumnCount()) ||
+			(0 == header.rowCount) || (header.rowCount > kMy_MaximumRowCount))
+		{
+			result = kTerminal_ResultFormatError;
+		}
+		
+		// decode lines; the line offsets make it possible to skip
+		// scrollback lines that this terminal does not have room for
+		if (kTerminal_ResultOK == result)
+		{
+			size_t const	kLineCount = (STATIC_CAST(header.scrollbackLineCount, size_t) + header.rowCount);
+			UInt8 const*	lineBytes = nullptr;
+			size_t			lineByteCount = 0;
+			
+			
+			if ((false == findStateSection(stateBytes, inByteCount, kMy_StateSectionLineOffsets, sectionPtr, sectionSize)) ||
+				(false == findStateSection(stateBytes, inByteCount, kMy_StateSectionLines, lineBytes, lineByteCount)) ||
+				((sectionSize / sizeof(UInt32)) <= kLineCount))
+			{
+				result = kTerminal_ResultFormatError;
+			}
+			else
+			{
+				UInt32 const* const		kLineOffsets = REINTERPRET_CAST(sectionPtr, UInt32 const*);
+				size_t const			kFirstLine = (header.scrollbackLineCount -
+														std::min< size_t >(header.scrollbackLineCount,
+																			dataPtr->text.scrollback.numberOfRowsPermitted));
+				
+				
+				scrollbackLineCount = (header.scrollbackLineCount - kFirstLine);
+				scrollbackLines.resize(scrollbackLineCount);
+				screenLines.resize(header.rowCount);
+				
+				// the front of the scrollback is its newest line, so
+				// it is filled from the back
+				auto	toScrollbackLine = scrollbackLines.rbegin();
+				auto	toScreenLine = screenLines.begin();
+				
+				
+				for (size_t i = kFirstLine; ((kTerminal_ResultOK == result) && (i < kLineCount)); ++i)
+				{
+					My_ScreenBufferLinePtr&		linePtr = (i < header.scrollbackLineCount)
+															? *toScrollbackLine++
+															: *toScreenLine++;
+					UInt8 const*				bytePtr = lineBytes + kLineOffsets[i];
+					UInt8 const* const			kPastEnd = lineBytes + kLineOffsets[i + 1];
+					
+					
+					if ((kLineOffsets[i] > kLineOffsets[i + 1]) || (kLineOffsets[i + 1] > lineByteCount) ||
+						(false == TerminalLine_DecodeLine(bytePtr, kPastEnd, linePtr)) || (kPastEnd != bytePtr))
+					{
+						result = kTerminal_ResultFormatError;
+					}
+				}
+			}
+		}
+		
+		// modes (missing fields are zero, so older state is still valid)
+		if (kTerminal_ResultOK == result)
+		{
+			if ((false == findStateSection(stateBytes, inByteCount, kMy_StateSectionModes, sectionPtr, sectionSize)) ||
+				(0 == sectionSize))
+			{
+				result = kTerminal_ResultFormatError;
+			}
+			else
+			{
+				std::memcpy(&modes, sectionPtr, std::min(sectionSize, sizeof(modes)));
+				if ((modes.cursorColumn >= header.columnCount) || (modes.cursorRow >= header.rowCount) ||
+					(modes.savedCursorColumn >= header.columnCount) || (modes.savedCursorRow >= header.rowCount) ||
+					(modes.scrollingRegionFirstRow > modes.scrollingRegionLastRow) ||
+					(modes.scrollingRegionLastRow >= header.rowCount) ||
+					(modes.activeCharacterSet > 3) || (modes.cursorType > kTerminal_CursorTypeThickVerticalLine))
+				{
+					result = kTerminal_ResultFormatError;
+				}
+				for (UInt8 i = 0; i < 4; ++i)
+				{
+					if ((modes.characterSetTables[i] > kMy_CharacterSetVT100UnitedStates) ||
+						(modes.characterSetSources[i] > kMy_CharacterROMAlternate) ||
+						(modes.characterSetGraphics[i] > kMy_GraphicsModeOn))
+					{
+						result = kTerminal_ResultFormatError;
+					}
+				}
+			}
+		}
+		
+		// tab stops
+		if (kTerminal_ResultOK == result)
+		{
+			if (false == findStateSection(stateBytes, inByteCount, kMy_StateSectionTabStops, tabStopBytes, tabStopCount))
+			{
+				result = kTerminal_ResultFormatError;
+			}
+		}
+		
+		// true colors (ignored if this terminal does not use them)
+		if ((kTerminal_ResultOK == result) && (nullptr != dataPtr->emulator.trueColorTable))
+		{
+			if (false == findStateSection(stateBytes, inByteCount, kMy_StateSectionTrueColors, sectionPtr, sectionSize))
+			{
+				result = kTerminal_ResultFormatError;
+			}
+			else if (sectionSize > 0)
+			{
+				UInt32 const* const		kColorValues = REINTERPRET_CAST(sectionPtr, UInt32 const*);
+				
+				
+				if ((sectionSize < sizeof(UInt32)) ||
+					((((sectionSize / sizeof(UInt32)) - 1) / 2) < kColorValues[0]) ||
+					(false == trueColors.setColors(kColorValues + 1, kColorValues + 1 + kColorValues[0], kColorValues[0])))
+				{
+					result = kTerminal_ResultFormatError;
+				}
+			}
+		}
+		
+		// titles
+		if (kTerminal_ResultOK == result)
+		{
+			if (false == findStateSection(stateBytes, inByteCount, kMy_StateSectionTitles, sectionPtr, sectionSize))
+			{
+				result = kTerminal_ResultFormatError;
+			}
+			else if (sectionSize > 0)
+			{
+				UInt32 const* const		kTitleSizes = REINTERPRET_CAST(sectionPtr, UInt32 const*);
+				
+				
+				if ((sectionSize < (2 * sizeof(UInt32))) ||
+					((sectionSize - (2 * sizeof(UInt32))) < (STATIC_CAST(kTitleSizes[0], size_t) + kTitleSizes[1])))
+				{
+					result = kTerminal_ResultFormatError;
+				}
+				else
+				{
+					UInt8 const* const		kWindowTitleBytes = sectionPtr + (2 * sizeof(UInt32));
+					
+					
+					windowTitleCFString.setWithNoRetain(CFStringCreateWithBytes(kCFAllocatorDefault, kWindowTitleBytes, kTitleSizes[0],
+																				kCFStringEncodingUTF8, false/* is external representation */));
+					iconTitleCFString.setWithNoRetain(CFStringCreateWithBytes(kCFAllocatorDefault, kWindowTitleBytes + kTitleSizes[0],
+																				kTitleSizes[1], kCFStringEncodingUTF8,
+																				false/* is external representation */));
+					if ((false == windowTitleCFString.exists()) || (false == iconTitleCFString.exists()))
+					{
+						result = kTerminal_ResultFormatError;
+					}
+				}
+			}
+		}
+		
+		// XTerm palette
+		if (kTerminal_ResultOK == result)
+		{
+			if (false == findStateSection(stateBytes, inByteCount, kMy_StateSectionXTermColors, sectionPtr, sectionSize))
+			{
+				result = kTerminal_ResultFormatError;
+			}
+			else if ((sectionSize > 0) && (false == readStateXTermColors(sectionPtr, sectionSize, xtermColors)))
+			{
+				result = kTerminal_ResultFormatError;
+			}
+		}
+		
+		// everything is valid; update the terminal
+		if (kTerminal_ResultOK == result)
+		{
+			My_CharacterSetInfo* const		kCharacterSets[] = { &dataPtr->vtG0, &dataPtr->vtG1, &dataPtr->vtG2, &dataPtr->vtG3 };
+			
+			
+			// the dimensions were checked above, so these cannot fail
+			UNUSED_RETURN(Terminal_Result)setVisibleColumnCount(dataPtr, header.columnCount);
+			UNUSED_RETURN(Terminal_Result)setVisibleRowCount(dataPtr, header.rowCount);
+			
+			dataPtr->screenBuffer.swap(screenLines);
+			dataPtr->scrollbackBuffer.swap(scrollbackLines);
+			dataPtr->scrollbackBufferCachedSize = scrollbackLineCount;
+			
+			for (UInt8 i = 0; i < 4; ++i)
+			{
+				kCharacterSets[i]->setTranslationTable(STATIC_CAST(modes.characterSetTables[i], My_CharacterSet));
+				kCharacterSets[i]->source = STATIC_CAST(modes.characterSetSources[i], My_CharacterROM);
+				kCharacterSets[i]->graphicsMode = STATIC_CAST(modes.characterSetGraphics[i], My_GraphicsMode);
+			}
+			dataPtr->current.characterSetInfoPtr = kCharacterSets[modes.activeCharacterSet];
+			
+			dataPtr->customScrollingRegion.firstRow = modes.scrollingRegionFirstRow;
+			dataPtr->customScrollingRegion.lastRow = modes.scrollingRegionLastRow;
+			dataPtr->modeOriginRedefined = (0 != modes.modeOriginRedefined);
+			dataPtr->originRegionPtr = (dataPtr->modeOriginRedefined)
+										? &dataPtr->customScrollingRegion
+										: &dataPtr->visibleBoundary.rows;
+			dataPtr->modeANSIEnabled = (0 != modes.modeANSIEnabled);
+			dataPtr->modeApplicationKeys = (0 != modes.modeApplicationKeys);
+			dataPtr->modeAutoWrap = (0 != modes.modeAutoWrap);
+			dataPtr->modeBracketedPaste = (0 != modes.modeBracketedPaste);
+			dataPtr->modeCursorKeysForApp = (0 != modes.modeCursorKeysForApp);
+			dataPtr->modeInsertNotReplace = (0 != modes.modeInsertNotReplace);
+			dataPtr->modeNewLineOption = (0 != modes.modeNewLineOption);
+			dataPtr->saveToScrollbackOnClear = (0 != modes.saveToScrollbackOnClear);
+			dataPtr->cursorType = STATIC_CAST(modes.cursorType, Terminal_CursorType);
+			dataPtr->cursorBlinking = (0 != modes.cursorBlinking);
+			dataPtr->cursorVisible = (0 != modes.cursorVisible);
+			dataPtr->reverseVideo = (0 != modes.reverseVideo);
+			dataPtr->litLEDs = modes.litLEDs;
+			
+			// the cursor attributes depend on the new lines, so the
+			// cursor is moved after they are in place; drawing state
+			// is restored afterwards since moving the cursor changes it
+			moveCursor(dataPtr, modes.cursorColumn, modes.cursorRow);
+			dataPtr->current.drawingAttributes = TextAttributes_Object(modes.drawingAttributesUpper, modes.drawingAttributesLower);
+			dataPtr->current.inlineColors.foregroundRGB = modes.inlineForegroundRGB;
+			dataPtr->current.inlineColors.backgroundRGB = modes.inlineBackgroundRGB;
+			dataPtr->previous.cursorX = modes.savedCursorColumn;
+			dataPtr->previous.cursorY = modes.savedCursorRow;
+			dataPtr->previous.drawingAttributes = TextAttributes_Object(modes.savedAttributesUpper, modes.savedAttributesLower);
+			dataPtr->previous.inlineColors.foregroundRGB = modes.savedInlineForegroundRGB;
+			dataPtr->previous.inlineColors.backgroundRGB = modes.savedInlineBackgroundRGB;
+			dataPtr->wrapPending = (0 != modes.wrapPending);
+			
+			for (size_t i = 0; i < std::min(tabStopCount, dataPtr->tabSettings.size()); ++i)
+			{
+				dataPtr->tabSettings[i] = (kMy_TabSet == tabStopBytes[i]) ? kMy_TabSet : kMy_TabClear;
+			}
+			
+			if (nullptr != dataPtr->emulator.trueColorTable)
+			{
+				*(dataPtr->emulator.trueColorTable) = std::move(trueColors);
+			}
+			
+			if (windowTitleCFString.exists())
+			{
+				dataPtr->windowTitleCFString = windowTitleCFString;
+				dataPtr->iconTitleCFString = iconTitleCFString;
+			}
+			
+			// palette entries that the restored state does not change
+			// keep their current values, since the defaults are not
+			// known here (they come from the view’s preferences)
+			for (auto const& indexRGBPair : xtermColors)
+			{
+				Terminal_XTermColorDescription		colorInfo;
+				
+				
+				dataPtr->xtermColors[indexRGBPair.first] = indexRGBPair.second;
+				bzero(&colorInfo, sizeof(colorInfo));
+				colorInfo.screen = dataPtr->selfRef;
+				colorInfo.index = indexRGBPair.first;
+				colorInfo.redComponent = STATIC_CAST((indexRGBPair.second >> 16) & 0xFF, UInt8);
+				colorInfo.greenComponent = STATIC_CAST((indexRGBPair.second >> 8) & 0xFF, UInt8);
+				colorInfo.blueComponent = STATIC_CAST(indexRGBPair.second & 0xFF, UInt8);
+				changeNotifyForTerminal(dataPtr, kTerminal_ChangeXTermColor, &colorInfo/* context */);
+			}
+			
+			// notify listeners of everything that may have changed
+			changeNotifyForTerminal(dataPtr, kTerminal_ChangeScreenSize, dataPtr->selfRef/* context */);
+			{
+				Terminal_RangeDescription	range;
+				
+				
+				range.screen = dataPtr->selfRef;
+				range.firstRow = 0;
+				range.firstColumn = 0;
+				range.columnCount = dataPtr->text.visibleScreen.numberOfColumnsPermitted;
+				range.rowCount = STATIC_CAST(dataPtr->screenBuffer.size(), SInt64);
+				changeNotifyForTerminal(dataPtr, kTerminal_ChangeTextEdited, &range/* context */);
+			}
+			{
+				Terminal_ScrollDescription	scrollInfo;
+				
+				
+				bzero(&scrollInfo, sizeof(scrollInfo));
+				scrollInfo.screen = dataPtr->selfRef;
+				scrollInfo.rowDelta = 0;
+				changeNotifyForTerminal(dataPtr, kTerminal_ChangeScrollActivity, &scrollInfo/* context */);
+			}
+			changeNotifyForTerminal(dataPtr, kTerminal_ChangeCursorLocation, dataPtr->selfRef/* context */);
+			changeNotifyForTerminal(dataPtr, kTerminal_ChangeCursorState, dataPtr->selfRef/* context */);
+			changeNotifyForTerminal(dataPtr, kTerminal_ChangeVideoMode, dataPtr->selfRef/* context */);
+			changeNotifyForTerminal(dataPtr, kTerminal_ChangeNewLEDState, dataPtr->selfRef/* context */);
+			changeNotifyForTerminal(dataPtr, kTerminal_ChangeWindowFrameTitle, dataPtr->selfRef/* context */);
+			changeNotifyForTerminal(dataPtr, kTerminal_ChangeWindowIconTitle, dataPtr->selfRef/* context */);
+		}
+	}
+	return result;
+}// DeserializeState
+
+
 /*!
 Sends a stream of characters originating in a
 C-style string to the specified screen’s terminal
@@ -2869,6 +3942,7 @@ Terminal_EmulatorProcessData	(TerminalScreenRef	inRef,
 								 UInt8 const*		inBuffer,
 								 size_t				inLength)
 {
+	TraceSpan_ScopeWithByteCount("Terminal_EmulatorProcessData", inLength);
 	Terminal_Result		result = kTerminal_ResultOK;
 	
 	
@@ -2888,6 +3962,11 @@ Terminal_EmulatorProcessData	(TerminalScreenRef	inRef,
 			UInt32			countRead = 0;
 			
 			
+			// captures of raw or plain-text data see the bytes exactly
+			// as they arrive, before any emulation (this has no effect
+			// on other types of capture)
+			StreamCapture_WriteReceivedData(dataPtr->captureStream, inBuffer, inLength);
+			
 			// hide cursor momentarily
 			setCursorVisible(dataPtr, false);
 			
@@ -3031,6 +4110,11 @@ Terminal_EmulatorProcessData	(TerminalScreenRef	inRef,
 										
 										interrupt = (dataPtr->emulator.stateRepetitions > kMaxBytesPerImage);
 									}
+									else if (states.second == My_XTermCore::kStateHyperlinkAcquireStr)
+									{
+										// hyperlink targets can be much longer than titles
+										interrupt = (dataPtr->emulator.stateRepetitions > kMy_LinkURIMaximumSize);
+									}
 									else if (states.second == My_ITermCore::kStateITermAcquireStr)
 									{
 										// arbitrarily allow massive image data sizes (TEMPORARY; make user-configurable?)
@@ -3501,6 +4585,46 @@ Terminal_FileCaptureBegin	(TerminalScreenRef	inRef,
 	
 	if (nullptr != dataPtr)
 	{
+		// apply the user’s current capture-file settings
+		{
+			Boolean						isCompressed = false;
+			UInt32						rotationMegabytes = 0;
+			UInt32						rotationSeconds = 0;
+			StreamCapture_SyncPolicy	syncPolicy = kStreamCapture_SyncPolicyOnClose;
+			StreamCapture_Content		content = kStreamCapture_ContentRenderedText;
+			
+			
+			if (kPreferences_ResultOK != Preferences_GetValue< kPreferences_TagCaptureFileCompression >(isCompressed))
+			{
+				isCompressed = false; // assume a value if it cannot be found
+			}
+			if (kPreferences_ResultOK != Preferences_GetValue< kPreferences_TagCaptureFileRotationMegabytes >(rotationMegabytes))
+			{
+				rotationMegabytes = 0; // assume a value if it cannot be found
+			}
+			if (kPreferences_ResultOK != Preferences_GetValue< kPreferences_TagCaptureFileRotationSeconds >(rotationSeconds))
+			{
+				rotationSeconds = 0; // assume a value if it cannot be found
+			}
+			if (kPreferences_ResultOK != Preferences_GetData(kPreferences_TagCaptureFileSyncPolicy,
+																sizeof(syncPolicy), &syncPolicy))
+			{
+				syncPolicy = kStreamCapture_SyncPolicyOnClose; // assume a value if it cannot be found
+			}
+			if (kPreferences_ResultOK != Preferences_GetData(kPreferences_TagCaptureFileContent,
+																sizeof(content), &content))
+			{
+				content = kStreamCapture_ContentRenderedText; // assume a value if it cannot be found
+			}
+			StreamCapture_SetContent(dataPtr->captureStream, content);
+			StreamCapture_SetCompression(dataPtr->captureStream, (isCompressed)
+																	? kStreamCapture_CompressionGzip
+																	: kStreamCapture_CompressionNone);
+			StreamCapture_SetRotation(dataPtr->captureStream, STATIC_CAST(rotationMegabytes, UInt64) * 1024 * 1024,
+										STATIC_CAST(rotationSeconds, CFTimeInterval));
+			StreamCapture_SetSyncPolicy(dataPtr->captureStream, syncPolicy);
+		}
+		
 		result = StreamCapture_Begin(dataPtr->captureStream, inFileToOverwrite);
 		changeNotifyForTerminal(dataPtr, kTerminal_ChangeFileCaptureBegun, inRef);
 	}
@@ -3563,6 +4687,10 @@ attributes are all IDENTICAL.  The upper bound on the number of
 iterations is the number of cells in the row (reached only if
 every single cell has different attributes than its neighbor).
 
+If any part of a run uses inline 24-bit colors, the colors are
+also identical for the whole run (and they are given to the
+block); otherwise the block’s colors are meaningless.
+
 \retval kTerminal_ResultOK
 if no error occurred
 
@@ -3594,9 +4722,12 @@ Terminal_ForEachLikeAttributeRun	(TerminalScreenRef			inRef,
 		My_ScreenBufferLine&						currentLine = iteratorPtr->currentLine();
 		TerminalLine_TextIterator					textIterator = nullptr;
 		TerminalLine_TextAttributesList const&		currentAttributeVector = currentLine.returnAttributeVector();
+		TerminalLine_InlineColorList const&			currentInlineColorVector = currentLine.returnInlineColorVector();
 		auto										attrIterator = currentAttributeVector.begin();
 		TextAttributes_Object						previousAttributes;
 		TextAttributes_Object						currentAttributes;
+		TextAttributes_InlineColors					previousColors;
+		TextAttributes_InlineColors					currentColors;
 		SInt16										runStartCharacterIndex = 0;
 		SInt16										characterIndex = 0;
 		size_t										styleRunLength = 0;
@@ -3609,7 +4740,7 @@ Terminal_ForEachLikeAttributeRun	(TerminalScreenRef			inRef,
 					currentLine.returnCFStringRef(),
 					inStartRow,
 					0/* zero-based start column */,
-					currentLine.returnGlobalAttributes());
+					currentLine.returnGlobalAttributes(), TextAttributes_InlineColors());
 	#endif
 		
 		// TEMPORARY - HIGHLY inefficient to search here, need to change this into a cache
@@ -3623,7 +4754,25 @@ Terminal_ForEachLikeAttributeRun	(TerminalScreenRef			inRef,
 				++textIterator, ++attrIterator, ++characterIndex)
 		{
 			currentAttributes = *attrIterator;
+			if (currentAttributes.hasInlineColor() && (false == currentInlineColorVector.empty()))
+			{
+				// only the parts that are actually used can split runs
+				currentColors = currentInlineColorVector[characterIndex];
+				if (false == currentAttributes.hasAttributes(kTextAttributes_ColorIsInlineForeground))
+				{
+					currentColors.foregroundRGB = 0;
+				}
+				if (false == currentAttributes.hasAttributes(kTextAttributes_ColorIsInlineBackground))
+				{
+					currentColors.backgroundRGB = 0;
+				}
+			}
+			else
+			{
+				currentColors = TextAttributes_InlineColors();
+			}
 			if ((currentAttributes != previousAttributes) ||
+				(currentColors != previousColors) ||
 				(characterIndex == STATIC_CAST(CFStringGetLength(currentLine.returnCFStringRef()) - 1, SInt16)) ||
 				(characterIndex == STATIC_CAST(currentAttributeVector.size() - 1, SInt16)))
 			{
@@ -3644,11 +4793,12 @@ Terminal_ForEachLikeAttributeRun	(TerminalScreenRef			inRef,
 								BRIDGE_CAST(styleRunSubstring, CFStringRef),
 								inStartRow,
 								runStartCharacterIndex/* zero-based start column */,
-								rangeAttributes);
+								rangeAttributes, previousColors);
 				}
 				
 				// reset for next run
 				previousAttributes = currentAttributes;
+				previousColors = currentColors;
 				runStartCharacterIndex = characterIndex;
 			}
 		}
@@ -3674,7 +4824,7 @@ Terminal_ForEachLikeAttributeRun	(TerminalScreenRef			inRef,
 							nullptr/* text buffer, for non-blank space */,
 							inStartRow,
 							runStartCharacterIndex/* zero-based start column */,
-							attributesForRemainder);
+							attributesForRemainder, TextAttributes_InlineColors());
 			}
 		}
 	}
@@ -3910,7 +5060,7 @@ if you are handling something indirectly or asynchronously
 Boolean
 Terminal_IsValid        (TerminalScreenRef      inRef)
 {
-	Boolean		result = ((nullptr != inRef) && (gTerminalScreenValidRefs().find(inRef) != gTerminalScreenValidRefs().end()));
+	Boolean		result = ((nullptr != inRef) && (gTerminalScreenValidRefs().contains(inRef)));
 	
 	
 	return result;
@@ -4293,14 +5443,39 @@ Terminal_ReturnInvisibleRowCount	(TerminalScreenRef		inRef)
 
 
 /*!
-Returns the number of lines long the specified
-terminal screen’s main screen area is (minus any
-scrollback lines).
+Returns the terminal modes that change the sequences sent
+for keys (see Terminal_UserInputVTKeyCopySequence()).  For
+an invalid terminal, "kTerminal_KeyModesNone" is returned.
 
-(3.0)
+(2021.06)
 */
-UInt16
-Terminal_ReturnRowCount		(TerminalScreenRef		inRef)
+Terminal_KeyModes
+Terminal_ReturnKeyModes		(TerminalScreenRef		inRef)
+{
+	My_ScreenBufferPtr		dataPtr = getVirtualScreenData(inRef);
+	Terminal_KeyModes		result = kTerminal_KeyModesNone;
+	
+	
+	if (nullptr != dataPtr)
+	{
+		if (dataPtr->modeANSIEnabled) result |= kTerminal_KeyModeANSI;
+		if (dataPtr->modeApplicationKeys) result |= kTerminal_KeyModeApplicationKeypad;
+		if (dataPtr->modeCursorKeysForApp) result |= kTerminal_KeyModeApplicationCursor;
+		if (dataPtr->emulator.is8BitTransmitter()) result |= kTerminal_KeyModeEightBitControls;
+	}
+	return result;
+}// ReturnKeyModes
+
+
+/*!
+Returns the number of lines long the specified
+terminal screen’s main screen area is (minus any
+scrollback lines).
+
+(3.0)
+*/
+UInt16
+Terminal_ReturnRowCount		(TerminalScreenRef		inRef)
 {
 	UInt16						result = 0;
 	My_ScreenBufferConstPtr		dataPtr = getVirtualScreenData(inRef);
@@ -4692,6 +5867,194 @@ Terminal_Search		(TerminalScreenRef							inRef,
 }// Search
 
 
+/*!
+Appends the state of a terminal to the given buffer in a
+compact binary form that Terminal_DeserializeState() can
+restore: the screen and scrollback (text, attributes and
+inline colors), cursor, modes, tab stops, character sets,
+titles, true colors and changes to the XTerm palette.
+Images, the selection and search results are not saved.
+
+The state starts with a header and a table of sections,
+followed by the sections themselves (see My_StateSection),
+each at a multiple of 8 bytes from the start of the state.
+Numbers are in the byte order of the computer, so that the
+state can be used directly after mapping a file into memory.
+Lines are encoded individually, so that a line index can
+point directly to any line (see TerminalLine_AppendEncoding()
+for how each line is compressed).
+
+\retval kTerminal_ResultOK
+if the state is appended
+
+\retval kTerminal_ResultInvalidID
+if the given terminal screen reference is invalid
+
+(2021.06)
+*/
+Terminal_Result
+Terminal_SerializeState		(TerminalScreenRef			inRef,
+							 std::vector< UInt8 >&		inoutBuffer)
+{
+	Terminal_Result			result = kTerminal_ResultOK;
+	My_ScreenBufferPtr		dataPtr = getVirtualScreenData(inRef);
+	
+	
+	if (nullptr == dataPtr) result = kTerminal_ResultInvalidID;
+	else
+	{
+		My_CharacterSetInfo const* const	kCharacterSets[] = { &dataPtr->vtG0, &dataPtr->vtG1, &dataPtr->vtG2, &dataPtr->vtG3 };
+		size_t const						kStateOffset = inoutBuffer.size();
+		My_StateHeader						header;
+		My_StateSectionRange				sections[kMy_StateSectionCount];
+		My_StateModes						modes;
+		std::vector< UInt32 >				lineOffsets;
+		std::vector< UInt8 >				lineBytes;
+		
+		
+		bzero(&header, sizeof(header));
+		bzero(sections, sizeof(sections));
+		bzero(&modes, sizeof(modes));
+		
+		// the header and section table are filled in at the end
+		inoutBuffer.resize(kStateOffset + sizeof(header) + sizeof(sections), 0);
+		
+		// modes
+		{
+			TextAttributes_Object	drawingAttributes = dataPtr->current.drawingAttributes;
+			TextAttributes_Object	savedAttributes = dataPtr->previous.drawingAttributes;
+			
+			
+			drawingAttributes.removeImageRelatedAttributes();
+			savedAttributes.removeImageRelatedAttributes();
+			modes.drawingAttributesUpper = drawingAttributes.returnValueInRange(TextAttributes_Object::BitRange(0xFFFFFFFF, 32));
+			modes.drawingAttributesLower = drawingAttributes.returnValueInRange(TextAttributes_Object::BitRange(0xFFFFFFFF, 0));
+			modes.inlineForegroundRGB = dataPtr->current.inlineColors.foregroundRGB;
+			modes.inlineBackgroundRGB = dataPtr->current.inlineColors.backgroundRGB;
+			modes.savedAttributesUpper = savedAttributes.returnValueInRange(TextAttributes_Object::BitRange(0xFFFFFFFF, 32));
+			modes.savedAttributesLower = savedAttributes.returnValueInRange(TextAttributes_Object::BitRange(0xFFFFFFFF, 0));
+			modes.savedInlineForegroundRGB = dataPtr->previous.inlineColors.foregroundRGB;
+			modes.savedInlineBackgroundRGB = dataPtr->previous.inlineColors.backgroundRGB;
+		}
+		modes.litLEDs = dataPtr->litLEDs;
+		modes.cursorColumn = STATIC_CAST(dataPtr->current.cursorX, UInt16);
+		modes.cursorRow = STATIC_CAST(dataPtr->current.cursorY, UInt16);
+		modes.savedCursorColumn = STATIC_CAST(dataPtr->previous.cursorX, UInt16);
+		modes.savedCursorRow = STATIC_CAST(dataPtr->previous.cursorY, UInt16);
+		modes.scrollingRegionFirstRow = STATIC_CAST(dataPtr->customScrollingRegion.firstRow, UInt16);
+		modes.scrollingRegionLastRow = STATIC_CAST(dataPtr->customScrollingRegion.lastRow, UInt16);
+		modes.cursorType = STATIC_CAST(dataPtr->cursorType, UInt16);
+		for (UInt8 i = 0; i < 4; ++i)
+		{
+			if (kCharacterSets[i] == dataPtr->current.characterSetInfoPtr)
+			{
+				modes.activeCharacterSet = i;
+			}
+			modes.characterSetTables[i] = STATIC_CAST(kCharacterSets[i]->translationTable, UInt8);
+			modes.characterSetSources[i] = STATIC_CAST(kCharacterSets[i]->source, UInt8);
+			modes.characterSetGraphics[i] = STATIC_CAST(kCharacterSets[i]->graphicsMode, UInt8);
+		}
+		modes.cursorBlinking = dataPtr->cursorBlinking;
+		modes.cursorVisible = dataPtr->cursorVisible;
+		modes.reverseVideo = dataPtr->reverseVideo;
+		modes.saveToScrollbackOnClear = dataPtr->saveToScrollbackOnClear;
+		modes.wrapPending = dataPtr->wrapPending;
+		modes.modeANSIEnabled = dataPtr->modeANSIEnabled;
+		modes.modeApplicationKeys = dataPtr->modeApplicationKeys;
+		modes.modeAutoWrap = dataPtr->modeAutoWrap;
+		modes.modeCursorKeysForApp = dataPtr->modeCursorKeysForApp;
+		modes.modeInsertNotReplace = dataPtr->modeInsertNotReplace;
+		modes.modeNewLineOption = dataPtr->modeNewLineOption;
+		modes.modeOriginRedefined = dataPtr->modeOriginRedefined;
+		modes.modeBracketedPaste = dataPtr->modeBracketedPaste;
+		appendStateSection(inoutBuffer, kStateOffset, sections[kMy_StateSectionModes], &modes, sizeof(modes));
+		
+		// tab stops
+		appendStateSection(inoutBuffer, kStateOffset, sections[kMy_StateSectionTabStops],
+							dataPtr->tabSettings.data(), dataPtr->tabSettings.size());
+		
+		// true colors
+		if (nullptr != dataPtr->emulator.trueColorTable)
+		{
+			std::vector< UInt32 >	rgbKeysByID;
+			std::vector< UInt32 >	idsByAge;
+			std::vector< UInt32 >	colorValues;
+			
+			
+			dataPtr->emulator.trueColorTable->copyColors(rgbKeysByID, idsByAge);
+			colorValues.reserve(1 + rgbKeysByID.size() + idsByAge.size());
+			colorValues.push_back(STATIC_CAST(rgbKeysByID.size(), UInt32));
+			colorValues.insert(colorValues.end(), rgbKeysByID.begin(), rgbKeysByID.end());
+			colorValues.insert(colorValues.end(), idsByAge.begin(), idsByAge.end());
+			appendStateSection(inoutBuffer, kStateOffset, sections[kMy_StateSectionTrueColors],
+								colorValues.data(), colorValues.size() * sizeof(UInt32));
+		}
+		
+		// titles
+		{
+			std::string				windowTitle;
+			std::string				iconTitle;
+			std::vector< UInt8 >	titleBytes(2 * sizeof(UInt32));
+			
+			
+			StringUtilities_CFToUTF8(dataPtr->windowTitleCFString.returnCFStringRef(), windowTitle);
+			StringUtilities_CFToUTF8(dataPtr->iconTitleCFString.returnCFStringRef(), iconTitle);
+			REINTERPRET_CAST(titleBytes.data(), UInt32*)[0] = STATIC_CAST(windowTitle.size(), UInt32);
+			REINTERPRET_CAST(titleBytes.data(), UInt32*)[1] = STATIC_CAST(iconTitle.size(), UInt32);
+			titleBytes.insert(titleBytes.end(), windowTitle.begin(), windowTitle.end());
+			titleBytes.insert(titleBytes.end(), iconTitle.begin(), iconTitle.end());
+			appendStateSection(inoutBuffer, kStateOffset, sections[kMy_StateSectionTitles], titleBytes.data(), titleBytes.size());
+		}
+		
+		// XTerm palette
+		{
+			std::vector< UInt32 >	paletteValues;
+			
+			
+			paletteValues.reserve(1 + 2 * dataPtr->xtermColors.size());
+			paletteValues.push_back(STATIC_CAST(dataPtr->xtermColors.size(), UInt32));
+			for (auto const& indexRGBPair : dataPtr->xtermColors)
+			{
+				paletteValues.push_back(indexRGBPair.first);
+				paletteValues.push_back(indexRGBPair.second);
+			}
+			appendStateSection(inoutBuffer, kStateOffset, sections[kMy_StateSectionXTermColors],
+								paletteValues.data(), paletteValues.size() * sizeof(UInt32));
+		}
+		
+		// lines, oldest first; IMPORTANT: lines are only read through
+		// "const" handles, since non-"const" access allocates lines
+		lineOffsets.reserve(dataPtr->scrollbackBufferCachedSize + dataPtr->screenBuffer.size() + 1);
+		for (auto toLine = dataPtr->scrollbackBuffer.crbegin(); toLine != dataPtr->scrollbackBuffer.crend(); ++toLine)
+		{
+			lineOffsets.push_back(STATIC_CAST(lineBytes.size(), UInt32));
+			TerminalLine_AppendEncoding(**toLine, lineBytes);
+		}
+		header.scrollbackLineCount = STATIC_CAST(lineOffsets.size(), UInt32);
+		for (auto toLine = dataPtr->screenBuffer.cbegin(); toLine != dataPtr->screenBuffer.cend(); ++toLine)
+		{
+			lineOffsets.push_back(STATIC_CAST(lineBytes.size(), UInt32));
+			TerminalLine_AppendEncoding(**toLine, lineBytes);
+		}
+		lineOffsets.push_back(STATIC_CAST(lineBytes.size(), UInt32));
+		appendStateSection(inoutBuffer, kStateOffset, sections[kMy_StateSectionLineOffsets],
+							lineOffsets.data(), lineOffsets.size() * sizeof(UInt32));
+		appendStateSection(inoutBuffer, kStateOffset, sections[kMy_StateSectionLines], lineBytes.data(), lineBytes.size());
+		
+		// header
+		header.signature = kMy_StateSignature;
+		header.byteOrderMark = kMy_StateByteOrderMark;
+		header.version = kMy_StateVersion;
+		header.sectionCount = kMy_StateSectionCount;
+		header.columnCount = dataPtr->text.visibleScreen.numberOfColumnsPermitted;
+		header.rowCount = STATIC_CAST(dataPtr->screenBuffer.size(), UInt16);
+		std::memcpy(inoutBuffer.data() + kStateOffset, &header, sizeof(header));
+		std::memcpy(inoutBuffer.data() + kStateOffset + sizeof(header), sections, sizeof(sections));
+	}
+	return result;
+}// SerializeState
+
+
 /*!
 Specifies whether the given terminal’s bell is active.
 An inactive bell completely ignores all bell signals -
@@ -5153,6 +6516,10 @@ the given “true” color, which is defined whenever a
 The TextAttributes_Object type can be used to extract the
 TextAttributes_TrueColorID value for a section of text.
 
+Since this is called to draw text, it also marks the color
+as recently used so that its ID is not reused while the
+color is still visible.
+
 \retval kTerminal_ResultOK
 if no error occurred
 
@@ -5184,27 +6551,25 @@ Terminal_TrueColorGetFromID		(TerminalScreenRef				inRef,
 	}
 	else
 	{
-		auto	redVectorPtr = dataPtr->emulator.trueColorTableReds;
-		auto	greenVectorPtr = dataPtr->emulator.trueColorTableGreens;
-		auto	blueVectorPtr = dataPtr->emulator.trueColorTableBlues;
+		UInt8	redComponent = 0;
+		UInt8	greenComponent = 0;
+		UInt8	blueComponent = 0;
 		
 		
-		if ((nullptr == redVectorPtr) || (nullptr == greenVectorPtr) || (nullptr == blueVectorPtr))
+		if (nullptr == dataPtr->emulator.trueColorTable)
 		{
 			result = kTerminal_ResultUnsupported;
 		}
-		else if ((inIndex >= (*redVectorPtr).size()) ||
-					(inIndex >= (*greenVectorPtr).size()) ||
-					(inIndex >= (*blueVectorPtr).size()))
+		else if (false == dataPtr->emulator.trueColorTable->getColor(inIndex, redComponent, greenComponent, blueComponent))
 		{
 			result = kTerminal_ResultParameterError;
 		}
 		else
 		{
 			// convert the RGB components (each from 0 to 255) into fractions of 1.0
-			outRedComponentFraction = STATIC_CAST((*redVectorPtr)[inIndex], Float32) / 255.0f;
-			outGreenComponentFraction = STATIC_CAST((*greenVectorPtr)[inIndex], Float32) / 255.0f;
-			outBlueComponentFraction = STATIC_CAST((*blueVectorPtr)[inIndex], Float32) / 255.0f;
+			outRedComponentFraction = STATIC_CAST(redComponent, Float32) / 255.0f;
+			outGreenComponentFraction = STATIC_CAST(greenComponent, Float32) / 255.0f;
+			outBlueComponentFraction = STATIC_CAST(blueComponent, Float32) / 255.0f;
 		}
 	}
 	
@@ -5787,146 +7152,147 @@ Terminal_UserInputVTKey		(TerminalScreenRef		inRef,
 	else if (nullptr == dataPtr->listeningSession) result = kTerminal_ResultNoListeningSession;
 	else
 	{
-		if ((inVTKey >= VSK0) && (inVTKey <= VSKE) && (false == dataPtr->modeApplicationKeys))
+		std::vector< UInt8 >	keySequence;
+		
+		
+		// the emulator translates the sequence to 8-bit form if necessary
+		result = Terminal_UserInputVTKeyCopySequence(inVTKey, Terminal_ReturnKeyModes(inRef) & ~kTerminal_KeyModeEightBitControls,
+														keySequence);
+		if (kTerminal_ResultOK == result)
 		{
-			// VT SPECIFIC:
-			// keypad key in numeric mode (as opposed to application key mode)
-			UInt8 const		kVTNumericModeTranslation[] =
-			{
-				// numbers, symbols, Enter, PF1-PF4
-				"0123456789,-.\015"
-			};
-			
-			
-			dataPtr->emulator.sendEscape(dataPtr->listeningSession, &kVTNumericModeTranslation[inVTKey - VSK0], 1);
+			dataPtr->emulator.sendEscape(dataPtr->listeningSession, keySequence.data(), keySequence.size());
 		}
-		else
+	}
+	return result;
+}// UserInputVTKey
+
+
+/*!
+Returns the sequence that Terminal_UserInputVTKey() would
+send for the specified key, from a terminal that has the
+given modes (see Terminal_ReturnKeyModes()).  This does not
+need a terminal, so a key that is sent to many terminals
+can be encoded once for each distinct set of modes.
+
+If the modes include "kTerminal_KeyModeEightBitControls",
+the sequence begins with an 8-bit code instead of ESC (as
+the emulator would send it).
+
+\retval kTerminal_ResultOK
+if the sequence was returned
+
+\retval kTerminal_ResultParameterError
+if the key is not one of the VT key codes (see "VTKeys.h");
+7-bit ASCII is sent as-is, and has no sequence
+
+(2021.06)
+*/
+Terminal_Result
+Terminal_UserInputVTKeyCopySequence		(UInt8					inVTKey,
+										 Terminal_KeyModes		inKeyModes,
+										 std::vector< UInt8 >&	outSequence)
+{
+	Terminal_Result		result = kTerminal_ResultOK;
+	
+	
+	outSequence.clear();
+	if (((inVTKey < VSF10) || (inVTKey > VSF6)) && ((inVTKey < VSUP) || (inVTKey > VSF4)))
+	{
+		result = kTerminal_ResultParameterError;
+	}
+	else if ((inVTKey >= VSK0) && (inVTKey <= VSKE) && (0 == (inKeyModes & kTerminal_KeyModeApplicationKeypad)))
+	{
+		// VT SPECIFIC:
+		// keypad key in numeric mode (as opposed to application key mode)
+		UInt8 const		kVTNumericModeTranslation[] =
 		{
-			// VT SPECIFIC:
-			// keypad key in application mode (as opposed to numeric mode),
-			// or an arrow key or PF-key in either mode
-			char const		kVTApplicationModeTranslation[] =
-			{
-				// arrows, numbers, symbols, Enter, PF1-PF4
-				"ABCDpqrstuvwxylmnMPQRS"
-			};
-			char*		seqPtr = nullptr;
-			size_t		seqLength = 0;
+			// numbers, symbols, Enter, PF1-PF4
+			"0123456789,-.\015"
+		};
+		
+		
+		outSequence.push_back(kVTNumericModeTranslation[inVTKey - VSK0]);
+	}
+	else
+	{
+		// VT SPECIFIC:
+		// keypad key in application mode (as opposed to numeric mode),
+		// or an arrow key or PF-key in either mode
+		char const		kVTApplicationModeTranslation[] =
+		{
+			// arrows, numbers, symbols, Enter, PF1-PF4
+			"ABCDpqrstuvwxylmnMPQRS"
+		};
+		Boolean const	kANSI = (0 != (inKeyModes & kTerminal_KeyModeANSI));
+		
+		
+		outSequence.push_back('\033');
+		if (inVTKey < VSUP)
+		{
+			// construct key code sequences starting from VSF10 (see VTKeys.h);
+			// each sequence is defined starting with the template "ESC [ x y ~",
+			// and then substituting 1 or 2 characters into the sequence template;
+			// the order must exactly match what is in VTKeys.h, because of the
+			// subtraction used to derive the array index
+			static char const	kArrayIndex2Translation[] = "222122?2?3?3?2?3?3123425161";
+			static char const	kArrayIndex3Translation[] = "134956?9?2?3?8?1?4~~~~0~8~7";
 			
 			
-			if (inVTKey < VSUP)
+			outSequence.push_back('[');
+			outSequence.push_back(kArrayIndex2Translation[inVTKey - VSF10]);
+			outSequence.push_back(kArrayIndex3Translation[inVTKey - VSF10]);
+			if ('~' != outSequence.back())
 			{
-				// construct key code sequences starting from VSF10 (see VTKeys.h);
-				// each sequence is defined starting with the template, below, and
-				// then substituting 1 or 2 characters into the sequence template;
-				// the order must exactly match what is in VTKeys.h, because of the
-				// subtraction used to derive the array index
-				static char			seqVT220Keys[] = "\033[  ~";
-				static char const	kArrayIndex2Translation[] = "222122?2?3?3?2?3?3123425161";
-				static char const	kArrayIndex3Translation[] = "134956?9?2?3?8?1?4~~~~0~8~7";
-				
-				
-				seqVT220Keys[2] = kArrayIndex2Translation[inVTKey - VSF10];
-				seqVT220Keys[3] = kArrayIndex3Translation[inVTKey - VSF10];
-				seqPtr = seqVT220Keys;
-				seqLength = CPP_STD::strlen(seqVT220Keys);
-				if ('~' == seqPtr[3]) --seqLength; // a few of the sequences are shorter
+				// a few of the sequences are shorter
+				outSequence.push_back('~');
 			}
-			else if (inVTKey < VSF1)
+		}
+		else if (inVTKey < VSF1)
+		{
+			// arrows or most keypad keys
+			if (kANSI)
 			{
-				// arrows or most keypad keys
-				if (dataPtr->modeANSIEnabled)
+				// non-VT52
+				if (inVTKey < VSK0)
 				{
-					// non-VT52
-					static char		seqKeypadApp[] = "\033O ";
-					static char		seqKeypadCursor[] = "\033[ ";
-					
-					
-					if (inVTKey < VSK0)
-					{
-						// arrows
-						if (dataPtr->modeCursorKeysForApp)
-						{
-							seqPtr = seqKeypadApp;
-							seqLength = CPP_STD::strlen(seqKeypadApp);
-							seqPtr[2] = kVTApplicationModeTranslation[inVTKey - VSUP];
-						}
-						else
-						{
-							seqPtr = seqKeypadCursor;
-							seqLength = CPP_STD::strlen(seqKeypadCursor);
-							seqPtr[2] = kVTApplicationModeTranslation[inVTKey - VSUP];
-						}
-					}
-					else
-					{
-						if (dataPtr->modeApplicationKeys)
-						{
-							// keypad keys have special application behavior, unless
-							// the cursor keys are hit and cursor mode is enabled
-							seqPtr = seqKeypadApp;
-							seqLength = CPP_STD::strlen(seqKeypadApp);
-							seqPtr[2] = kVTApplicationModeTranslation[inVTKey - VSUP];
-						}
-						else
-						{
-							// numerical mode
-							seqPtr = seqKeypadCursor;
-							seqLength = CPP_STD::strlen(seqKeypadCursor);
-							seqPtr[2] = kVTApplicationModeTranslation[inVTKey - VSUP];
-						}
-					}
+					// arrows
+					outSequence.push_back((inKeyModes & kTerminal_KeyModeApplicationCursor) ? 'O' : '[');
 				}
 				else
 				{
-					// VT52
-					static char		seqKeypadVT52[] = "\033? ";
-					static char		seqArrowsVT52[] = "\033 ";
-					
-					
-					if (inVTKey > VSLT)
-					{
-						// non-arrows
-						seqPtr = seqKeypadVT52;
-						seqPtr[2] = kVTApplicationModeTranslation[inVTKey - VSUP];
-						seqLength = CPP_STD::strlen(seqKeypadVT52);
-					}
-					else
-					{
-						// arrows
-						seqPtr = seqArrowsVT52;
-						seqLength = CPP_STD::strlen(seqArrowsVT52);
-						seqPtr[1] = kVTApplicationModeTranslation[inVTKey - VSUP];
-					}
+					// keypad keys have special application behavior, unless
+					// the cursor keys are hit and cursor mode is enabled
+					// (numerical mode is handled above)
+					outSequence.push_back('O');
 				}
 			}
-			else
+			else if (inVTKey > VSLT)
 			{
-				// PF1 through PF4
-				static char		seqFunctionKeysNormal[] = "\033O ";
-				static char		seqFunctionKeysVT52[] = "\033 ";
-				
-				
-				if (dataPtr->modeANSIEnabled)
-				{
-					seqPtr = seqFunctionKeysNormal;
-					seqPtr[2] = kVTApplicationModeTranslation[inVTKey - VSUP];
-					seqLength = CPP_STD::strlen(seqFunctionKeysNormal);
-				}
-				else
-				{
-					seqPtr = seqFunctionKeysVT52;
-					seqPtr[1] = kVTApplicationModeTranslation[inVTKey - VSUP];
-					seqLength = CPP_STD::strlen(seqFunctionKeysVT52);
-				}
+				// VT52 non-arrows
+				outSequence.push_back('?');
 			}
-			
-			// finally, send the key sequence
-			dataPtr->emulator.sendEscape(dataPtr->listeningSession, seqPtr, seqLength);
+			outSequence.push_back(kVTApplicationModeTranslation[inVTKey - VSUP]);
+		}
+		else
+		{
+			// PF1 through PF4
+			if (kANSI)
+			{
+				outSequence.push_back('O');
+			}
+			outSequence.push_back(kVTApplicationModeTranslation[inVTKey - VSUP]);
+		}
+		
+		// VT SPECIFIC:
+		// translate to an 8-bit sequence if possible, as My_Emulator::sendEscape() does
+		if ((inKeyModes & kTerminal_KeyModeEightBitControls) && (outSequence[1] >= 0x40/* @ */) && (outSequence[1] <= 0x5F/* _ */))
+		{
+			outSequence[1] += 0x40;
+			outSequence.erase(outSequence.begin());
 		}
 	}
 	return result;
-}// UserInputVTKey
+}// UserInputVTKeyCopySequence
 
 
 /*!
@@ -5994,10 +7360,7 @@ currentCallbacks(returnDataWriter(inPrimaryEmulation),
 					returnResetHandler(inPrimaryEmulation)),
 pushedCallbacks(),
 supportedVariants(kVariantFlagsNone),
-trueColorTableReds(nullptr),
-trueColorTableGreens(nullptr),
-trueColorTableBlues(nullptr),
-trueColorTableNextID(0),
+trueColorTable(nullptr),
 bitmapTableNextID(0),
 bitmapImageTable(nil),
 bitmapSegmentTable(nil),
@@ -6018,9 +7381,7 @@ My_Emulator::~My_Emulator()
 {
 	// NOTE: constructor initializes these to nullptr and it is
 	// safe to do an unchecked "delete" of nullptr
-	delete trueColorTableReds;
-	delete trueColorTableGreens;
-	delete trueColorTableBlues;
+	delete trueColorTable;
 }// My_Emulator destructor
 
 
@@ -6631,6 +7992,7 @@ listeningSession(nullptr),
 speaker(nullptr),
 windowTitleCFString(),
 iconTitleCFString(),
+xtermColors(),
 changeListenerModel(ListenerModel_New(kListenerModel_StyleStandard, kConstantsRegistry_ListenerModelDescriptorTerminalChanges)),
 preferenceMonitor(ListenerModel_NewStandardListener(preferenceChanged, this/* context */),
 					ListenerModel_ListenerWrap::kAlreadyRetained),
@@ -6646,6 +8008,9 @@ tabSettings(),
 captureStream(StreamCapture_New(returnLineEndings())),
 printingStream(nullptr),
 printingFileURL(),
+echoConversionBuffer(),
+linkURIs(LinkScanner_NewURITable(kMy_LinkURICapacity)),
+linkScanTimer(TimerWheel_NewTimer(TimerWheel_ReturnShared(), linkScanTimerFired, this/* context */)),
 printingModes(0),
 bellDisabled(false),
 cursorType(kTerminal_CursorTypeBlock),
@@ -6666,9 +8031,11 @@ mayNeedToSaveToScrollback(false),
 saveToScrollbackOnClear(true),
 reportOnlyOnRequest(false),
 wrapPending(false),
+modeAlternateScreen(false),
 modeANSIEnabled(true),
 modeApplicationKeys(false),
 modeAutoWrap(false),
+modeBracketedPaste(false),
 modeCursorKeysForApp(false),
 modeInsertNotReplace(false),
 modeNewLineOption(false),
@@ -6728,9 +8095,7 @@ selfRef(REINTERPRET_CAST(this, TerminalScreenRef))
 	if (return24BitColor(inTerminalConfig))
 	{
 		this->emulator.supportedVariants |= My_Emulator::kVariantFlag24BitColor;
-		this->emulator.trueColorTableReds = new My_RGBComponentList();
-		this->emulator.trueColorTableGreens = new My_RGBComponentList();
-		this->emulator.trueColorTableBlues = new My_RGBComponentList();
+		this->emulator.trueColorTable = new My_TrueColorTable();
 	}
 	if (returnITermGraphics(inTerminalConfig))
 	{
@@ -6850,6 +8215,8 @@ My_ScreenBuffer::
 																		kPreferences_ChangeContextBatchMode);
 	TerminalSpeaker_Dispose(&this->speaker);
 	ListenerModel_Dispose(&this->changeListenerModel);
+	TimerWheel_DisposeTimer(&this->linkScanTimer);
+	LinkScanner_DisposeURITable(&this->linkURIs);
 	
 	for (My_ScreenBufferLinePtr& linePtrRef : this->scrollbackBuffer)
 	{
@@ -7025,8 +8392,7 @@ return24BitColor	(Preferences_ContextRef		inTerminalConfig)
 	Boolean					result = true;
 	
 	
-	prefsResult = Preferences_ContextGetData(inTerminalConfig, kPreferences_TagTerminal24BitColorEnabled,
-												sizeof(result), &result);
+	prefsResult = Preferences_ContextGetValue< kPreferences_TagTerminal24BitColorEnabled >(inTerminalConfig, result);
 	if (kPreferences_ResultOK != prefsResult) result = true; // arbitrary
 	
 	return result;
@@ -7094,8 +8460,7 @@ returnForceSave		(Preferences_ContextRef		inTerminalConfig)
 	Boolean					result = true;
 	
 	
-	prefsResult = Preferences_ContextGetData(inTerminalConfig, kPreferences_TagTerminalClearSavesLines,
-												sizeof(result), &result);
+	prefsResult = Preferences_ContextGetValue< kPreferences_TagTerminalClearSavesLines >(inTerminalConfig, result);
 	if (kPreferences_ResultOK != prefsResult) result = true; // arbitrary
 	
 	return result;
@@ -7117,8 +8482,7 @@ returnITermGraphics		(Preferences_ContextRef		inTerminalConfig)
 	Boolean					result = true;
 	
 	
-	prefsResult = Preferences_ContextGetData(inTerminalConfig, kPreferences_TagITermGraphicsEnabled,
-												sizeof(result), &result);
+	prefsResult = Preferences_ContextGetValue< kPreferences_TagITermGraphicsEnabled >(inTerminalConfig, result);
 	if (kPreferences_ResultOK != prefsResult) result = true; // arbitrary
 	
 	return result;
@@ -7167,8 +8531,8 @@ returnScreenColumns		(Preferences_ContextRef		inTerminalConfig,
 	UInt16					result = 80; // arbitrary default
 	
 	
-	prefsResult = Preferences_ContextGetData(inTerminalConfig, kPreferences_TagTerminalScreenColumns,
-												sizeof(result), &result, inFallBackToDefaults);
+	prefsResult = Preferences_ContextGetValue< kPreferences_TagTerminalScreenColumns >
+												(inTerminalConfig, result, inFallBackToDefaults);
 	if (kPreferences_ResultOK != prefsResult)
 	{
 		Console_Warning(Console_WriteValue, "screen buffer failed to read column count from preferences, error", prefsResult);
@@ -7193,8 +8557,8 @@ returnScreenRows	(Preferences_ContextRef		inTerminalConfig,
 	UInt16					result = 24; // arbitrary default
 	
 	
-	prefsResult = Preferences_ContextGetData(inTerminalConfig, kPreferences_TagTerminalScreenRows,
-												sizeof(result), &result, inFallBackToDefaults);
+	prefsResult = Preferences_ContextGetValue< kPreferences_TagTerminalScreenRows >
+												(inTerminalConfig, result, inFallBackToDefaults);
 	if (kPreferences_ResultOK != prefsResult)
 	{
 		Console_Warning(Console_WriteValue, "screen buffer failed to read row count from preferences, error", prefsResult);
@@ -7239,8 +8603,7 @@ returnScrollbackRows	(Preferences_ContextRef		inTerminalConfig,
 	
 	if (kTerminal_ScrollbackTypeFixed == scrollbackType)
 	{
-		prefsResult = Preferences_ContextGetData(inTerminalConfig, kPreferences_TagTerminalScreenScrollbackRows,
-													sizeof(result), &result);
+		prefsResult = Preferences_ContextGetValue< kPreferences_TagTerminalScreenScrollbackRows >(inTerminalConfig, result);
 		if (kPreferences_ResultOK != prefsResult)
 		{
 			Console_Warning(Console_WriteValue, "screen buffer failed to read scrollback row count from preferences, error", prefsResult);
@@ -7266,8 +8629,7 @@ returnSixelGraphics		(Preferences_ContextRef		inTerminalConfig)
 	Boolean					result = true;
 	
 	
-	prefsResult = Preferences_ContextGetData(inTerminalConfig, kPreferences_TagSixelGraphicsEnabled,
-												sizeof(result), &result);
+	prefsResult = Preferences_ContextGetValue< kPreferences_TagSixelGraphicsEnabled >(inTerminalConfig, result);
 	if (kPreferences_ResultOK != prefsResult) result = true; // arbitrary
 	
 	return result;
@@ -7309,8 +8671,7 @@ returnXTerm256	(Preferences_ContextRef		inTerminalConfig)
 	Boolean					result = true;
 	
 	
-	prefsResult = Preferences_ContextGetData(inTerminalConfig, kPreferences_TagXTerm256ColorsEnabled,
-												sizeof(result), &result);
+	prefsResult = Preferences_ContextGetValue< kPreferences_TagXTerm256ColorsEnabled >(inTerminalConfig, result);
 	if (kPreferences_ResultOK != prefsResult) result = true; // arbitrary
 	
 	return result;
@@ -7332,8 +8693,7 @@ returnXTermBackgroundColorErase		(Preferences_ContextRef		inTerminalConfig)
 	Boolean					result = true;
 	
 	
-	prefsResult = Preferences_ContextGetData(inTerminalConfig, kPreferences_TagXTermBackgroundColorEraseEnabled,
-												sizeof(result), &result);
+	prefsResult = Preferences_ContextGetValue< kPreferences_TagXTermBackgroundColorEraseEnabled >(inTerminalConfig, result);
 	if (kPreferences_ResultOK != prefsResult) result = true; // arbitrary
 	
 	return result;
@@ -7356,8 +8716,8 @@ returnXTermPatchLevel	(Preferences_ContextRef		inTerminalConfig,
 	UInt16					result = 95; // arbitrary default (minimum defined by XTerm)
 	
 	
-	prefsResult = Preferences_ContextGetData(inTerminalConfig, kPreferences_TagXTermReportedPatchLevel,
-												sizeof(result), &result, inFallBackToDefaults);
+	prefsResult = Preferences_ContextGetValue< kPreferences_TagXTermReportedPatchLevel >
+												(inTerminalConfig, result, inFallBackToDefaults);
 	if (kPreferences_ResultOK != prefsResult)
 	{
 		Console_Warning(Console_WriteValue, "screen buffer failed to read XTerm patch level from preferences, error", prefsResult);
@@ -7381,8 +8741,7 @@ returnXTermWindowAlteration		(Preferences_ContextRef		inTerminalConfig)
 	Boolean					result = true;
 	
 	
-	prefsResult = Preferences_ContextGetData(inTerminalConfig, kPreferences_TagXTermWindowAlterationEnabled,
-												sizeof(result), &result);
+	prefsResult = Preferences_ContextGetValue< kPreferences_TagXTermWindowAlterationEnabled >(inTerminalConfig, result);
 	if (kPreferences_ResultOK != prefsResult) result = true; // arbitrary
 	
 	return result;
@@ -7390,58 +8749,418 @@ returnXTermWindowAlteration		(Preferences_ContextRef		inTerminalConfig)
 
 
 /*!
-Translates the specified buffer into Unicode (from the input
-text encoding of the terminal), and echoes it to the screen.
-Also pipes the data to additional targets, such as spoken voice,
-if so enabled in the terminal.
+Creates an empty table.
 
-This implementation expects to be used with terminals whose
-state determinants will pre-filter the data stream to not have
-control characters, etc.  It will ignore text that it cannot
-translate correctly!
+(2021.06)
+*/
+My_TrueColorTable::
+My_TrueColorTable ()
+:
+indexSlots(kMy_TrueColorIndexInitialSize, IndexSlot{ kMy_TrueColorIndexEmptyKey, 0 }),
+indexMask(kMy_TrueColorIndexInitialSize - 1),
+rgbKeysByID(),
+newerIDByID(),
+olderIDByID(),
+newestID(kMy_TrueColorNoID),
+oldestID(kMy_TrueColorNoID)
+{
+}// My_TrueColorTable default constructor
 
-Returns the number of characters successfully echoed.
 
-(4.0)
+/*!
+Copies the RGB value of every ID (in order of ID) and every
+ID from least to most recently used, which is all that
+setColors() needs to recreate the table.
+
+(2021.06)
 */
-UInt32
-My_DefaultEmulator::
-echoData	(My_ScreenBufferPtr		inDataPtr,
-			 UInt8 const*			inBuffer,
-			 UInt32					inLength)
+void
+My_TrueColorTable::
+copyColors	(std::vector< UInt32 >&		outRGBKeysByID,
+			 std::vector< UInt32 >&		outIDsByAge)
+const
 {
-	UInt32		result = inLength;
+	outRGBKeysByID = this->rgbKeysByID;
+	outIDsByAge.clear();
+	outIDsByAge.reserve(this->rgbKeysByID.size());
+	for (UInt32 i = this->oldestID; kMy_TrueColorNoID != i; i = this->newerIDByID[i])
+	{
+		outIDsByAge.push_back(i);
+	}
+}// My_TrueColorTable::copyColors
+
+
+/*!
+Returns the index of the slot that holds the given key or,
+if the key is not present, the empty slot where it belongs.
+
+(2021.06)
+*/
+size_t
+My_TrueColorTable::
+findSlot	(UInt32		inRGBKey)
+const
+{
+	size_t		result = (returnHash(inRGBKey) & this->indexMask);
 	
 	
-	if (inLength > 0)
+	while ((kMy_TrueColorIndexEmptyKey != this->indexSlots[result].rgbKey) &&
+			(inRGBKey != this->indexSlots[result].rgbKey))
 	{
-		CFIndex				bytesRequired = 0;
-		CFRetainRelease		bufferAsCFString(TextTranslation_PersistentCFStringCreate
-												(kCFAllocatorDefault, inBuffer, inLength, inDataPtr->emulator.inputTextEncoding,
-													false/* is external representation */, bytesRequired, inLength/* maximum trim/repeat */),
-												CFRetainRelease::kAlreadyRetained);
+		result = ((result + 1) & this->indexMask);
+	}
+	return result;
+}// My_TrueColorTable::findSlot
+
+
+/*!
+Finds the components of the color with the given ID and
+marks the color as recently used.  Returns false if the
+ID is not defined.
+
+(2021.06)
+*/
+Boolean
+My_TrueColorTable::
+getColor	(TextAttributes_TrueColorID		inID,
+			 UInt8&							outRed,
+			 UInt8&							outGreen,
+			 UInt8&							outBlue)
+{
+	Boolean		result = false;
+	
+	
+	if (inID < this->rgbKeysByID.size())
+	{
+		UInt32 const	kRGBKey = this->rgbKeysByID[inID];
 		
 		
-		if (false == bufferAsCFString.exists())
+		outRed = STATIC_CAST((kRGBKey >> 16) & 0xFF, UInt8);
+		outGreen = STATIC_CAST((kRGBKey >> 8) & 0xFF, UInt8);
+		outBlue = STATIC_CAST(kRGBKey & 0xFF, UInt8);
+		useID(inID);
+		result = true;
+	}
+	return result;
+}// My_TrueColorTable::getColor
+
+
+/*!
+Doubles the size of the hash index, moving all entries.
+
+(2021.06)
+*/
+void
+My_TrueColorTable::
+growIndex ()
+{
+	std::vector< IndexSlot >	oldSlots(2 * this->indexSlots.size(), IndexSlot{ kMy_TrueColorIndexEmptyKey, 0 });
+	
+	
+	oldSlots.swap(this->indexSlots);
+	this->indexMask = STATIC_CAST(this->indexSlots.size() - 1, UInt32);
+	for (auto const& kSlot : oldSlots)
+	{
+		if (kMy_TrueColorIndexEmptyKey != kSlot.rgbKey)
 		{
-			// TEMPORARY: this should probably be handled better
-			++(inDataPtr->translationErrorCount);
-			result = 0;
+			this->indexSlots[findSlot(kSlot.rgbKey)] = kSlot;
 		}
-		else
+	}
+}// My_TrueColorTable::growIndex
+
+
+/*!
+Removes the given key from the hash index, if present.
+
+Entries after the removed one are shifted back as needed
+so that no “deleted” markers are required and searches
+never become slower over time.
+
+(2021.06)
+*/
+void
+My_TrueColorTable::
+removeKey	(UInt32		inRGBKey)
+{
+	size_t		holeIndex = findSlot(inRGBKey);
+	
+	
+	if (kMy_TrueColorIndexEmptyKey != this->indexSlots[holeIndex].rgbKey)
+	{
+		size_t		i = holeIndex;
+		
+		
+		while (true)
 		{
-			// send the data wherever it needs to go
-			echoCFString(inDataPtr, bufferAsCFString.returnCFStringRef());
-			
-			// speech implementation; TEMPORARY: handled here because the spoken text must
-			// have access to a post-translation string, free of any meta-characters that
-			// might have been in the original text stream; but text typically arrives too
-			// irregularly and too quickly to allow a useful sentence to be spoken, so it
-			// may be necessary to capture lines and speak them via a timer in a more
-			// orderly fashion
-			unless (TerminalSpeaker_IsMuted(inDataPtr->speaker) || TerminalSpeaker_IsGloballyMuted())
+			i = ((i + 1) & this->indexMask);
+			if (kMy_TrueColorIndexEmptyKey == this->indexSlots[i].rgbKey)
 			{
-				Boolean		doSpeak = false;
+				break;
+			}
+			
+			// an entry may fill the hole only if the hole is
+			// between its preferred slot and its current slot
+			size_t const	kPreferredIndex = (returnHash(this->indexSlots[i].rgbKey) & this->indexMask);
+			
+			
+			if (((i - kPreferredIndex) & this->indexMask) >= ((i - holeIndex) & this->indexMask))
+			{
+				this->indexSlots[holeIndex] = this->indexSlots[i];
+				holeIndex = i;
+			}
+		}
+		this->indexSlots[holeIndex].rgbKey = kMy_TrueColorIndexEmptyKey;
+	}
+}// My_TrueColorTable::removeKey
+
+
+/*!
+Returns the ID of the given color, defining a new one if
+necessary (possibly reusing an old ID).  The color is
+marked as recently used.
+
+(2021.06)
+*/
+TextAttributes_TrueColorID
+My_TrueColorTable::
+returnColorID	(UInt8		inRed,
+				 UInt8		inGreen,
+				 UInt8		inBlue)
+{
+	UInt32 const				kRGBKey = (inBlue | (inGreen << 8) | (inRed << 16));
+	size_t						slotIndex = findSlot(kRGBKey);
+	TextAttributes_TrueColorID	result = 0;
+	
+	
+	if (kRGBKey == this->indexSlots[slotIndex].rgbKey)
+	{
+		// the specified R/G/B combination already has an ID
+		result = this->indexSlots[slotIndex].colorID;
+	}
+	else
+	{
+		if (this->rgbKeysByID.size() <= kTextAttributes_TrueColorIDMaximum)
+		{
+			// table is not yet full; allocate a new ID
+			result = STATIC_CAST(this->rgbKeysByID.size(), TextAttributes_TrueColorID);
+			this->rgbKeysByID.push_back(kRGBKey);
+			this->newerIDByID.push_back(kMy_TrueColorNoID);
+			this->olderIDByID.push_back(kMy_TrueColorNoID);
+			
+			// keep the index at most half full so that searches are short
+			if ((2 * this->rgbKeysByID.size()) > this->indexSlots.size())
+			{
+				growIndex();
+				slotIndex = findSlot(kRGBKey);
+			}
+		}
+		else
+		{
+			// table is full; reuse the least recently used ID, removing
+			// the mapping of its previous color (otherwise, a future
+			// request for the previous color would return this ID)
+			result = STATIC_CAST(this->oldestID, TextAttributes_TrueColorID);
+			removeKey(this->rgbKeysByID[result]);
+			this->rgbKeysByID[result] = kRGBKey;
+			slotIndex = findSlot(kRGBKey); // removal may have moved entries
+		}
+		this->indexSlots[slotIndex].rgbKey = kRGBKey;
+		this->indexSlots[slotIndex].colorID = result;
+	}
+	useID(result);
+	
+	return result;
+}// My_TrueColorTable::returnColorID
+
+
+/*!
+Mixes the bits of an RGB value so that similar colors (such
+as the steps of a gradient) are spread across the index.
+
+(2021.06)
+*/
+UInt32
+My_TrueColorTable::
+returnHash	(UInt32		inRGBKey)
+{
+	UInt32		result = inRGBKey;
+	
+	
+	result ^= (result >> 16);
+	result *= 0x7FEB352D;
+	result ^= (result >> 15);
+	result *= 0x846CA68B;
+	result ^= (result >> 16);
+	return result;
+}// My_TrueColorTable::returnHash
+
+
+/*!
+Replaces all colors with ones from copyColors(), so that
+every ID has the same color and the same order of use.
+Returns false (and leaves the table unchanged) if the
+values are inconsistent: for example, if an RGB value is
+given to two IDs, or if the usage order does not have
+every ID exactly once.
+
+(2021.06)
+*/
+Boolean
+My_TrueColorTable::
+setColors	(UInt32 const*		inRGBKeysByID,
+			 UInt32 const*		inIDsByAge,
+			 size_t				inColorCount)
+{
+	My_TrueColorTable	newTable;
+	Boolean				result = (inColorCount <= (kTextAttributes_TrueColorIDMaximum + 1));
+	
+	
+	for (size_t i = 0; (result && (i < inColorCount)); ++i)
+	{
+		UInt32 const	kRGBKey = inRGBKeysByID[i];
+		
+		
+		result = (kRGBKey <= 0x00FFFFFF);
+		if (result)
+		{
+			newTable.rgbKeysByID.push_back(kRGBKey);
+			newTable.newerIDByID.push_back(kMy_TrueColorNoID);
+			newTable.olderIDByID.push_back(kMy_TrueColorNoID);
+			if ((2 * newTable.rgbKeysByID.size()) > newTable.indexSlots.size())
+			{
+				newTable.growIndex();
+			}
+			
+			size_t const	kSlotIndex = newTable.findSlot(kRGBKey);
+			
+			
+			result = (kRGBKey != newTable.indexSlots[kSlotIndex].rgbKey);
+			newTable.indexSlots[kSlotIndex].rgbKey = kRGBKey;
+			newTable.indexSlots[kSlotIndex].colorID = STATIC_CAST(i, TextAttributes_TrueColorID);
+		}
+	}
+	
+	for (size_t i = 0; (result && (i < inColorCount)); ++i)
+	{
+		UInt32 const	kID = inIDsByAge[i];
+		
+		
+		// an ID that is already in the usage list either is the
+		// newest or has a newer ID, so repeated IDs are detected
+		result = ((kID < inColorCount) && (kID != newTable.newestID) && (kMy_TrueColorNoID == newTable.newerIDByID[kID]));
+		if (result)
+		{
+			newTable.useID(kID);
+		}
+	}
+	
+	if (result)
+	{
+		*this = std::move(newTable);
+	}
+	return result;
+}// My_TrueColorTable::setColors
+
+
+/*!
+Moves the given ID to the most-recently-used end of the
+usage list.  A new ID (not yet in the list) is added.
+
+(2021.06)
+*/
+void
+My_TrueColorTable::
+useID	(UInt32		inID)
+{
+	if (inID != this->newestID)
+	{
+		UInt32 const	kNewerID = this->newerIDByID[inID];
+		UInt32 const	kOlderID = this->olderIDByID[inID];
+		
+		
+		// unlink (if in the list)
+		if (kMy_TrueColorNoID != kNewerID)
+		{
+			this->olderIDByID[kNewerID] = kOlderID;
+		}
+		if (kMy_TrueColorNoID != kOlderID)
+		{
+			this->newerIDByID[kOlderID] = kNewerID;
+		}
+		if (inID == this->oldestID)
+		{
+			this->oldestID = kNewerID;
+		}
+		
+		// link at the most-recent end
+		this->olderIDByID[inID] = this->newestID;
+		this->newerIDByID[inID] = kMy_TrueColorNoID;
+		if (kMy_TrueColorNoID != this->newestID)
+		{
+			this->newerIDByID[this->newestID] = inID;
+		}
+		this->newestID = inID;
+		if (kMy_TrueColorNoID == this->oldestID)
+		{
+			this->oldestID = inID;
+		}
+	}
+}// My_TrueColorTable::useID
+
+
+/*!
+Translates the specified buffer into Unicode (from the input
+text encoding of the terminal), and echoes it to the screen.
+Also pipes the data to additional targets, such as spoken voice,
+if so enabled in the terminal.
+
+This implementation expects to be used with terminals whose
+state determinants will pre-filter the data stream to not have
+control characters, etc.  It will ignore text that it cannot
+translate correctly!
+
+Returns the number of characters successfully echoed.
+
+(4.0)
+*/
+UInt32
+My_DefaultEmulator::
+echoData	(My_ScreenBufferPtr		inDataPtr,
+			 UInt8 const*			inBuffer,
+			 UInt32					inLength)
+{
+	UInt32		result = inLength;
+	
+	
+	if (inLength > 0)
+	{
+		CFIndex				bytesRequired = 0;
+		CFRetainRelease		bufferAsCFString(TextTranslation_PersistentCFStringCreate
+												(kCFAllocatorDefault, inBuffer, inLength, inDataPtr->emulator.inputTextEncoding,
+													false/* is external representation */, bytesRequired, inLength/* maximum trim/repeat */),
+												CFRetainRelease::kAlreadyRetained);
+		
+		
+		if (false == bufferAsCFString.exists())
+		{
+			// TEMPORARY: this should probably be handled better
+			++(inDataPtr->translationErrorCount);
+			result = 0;
+		}
+		else
+		{
+			// send the data wherever it needs to go
+			echoCFString(inDataPtr, bufferAsCFString.returnCFStringRef());
+			
+			// speech implementation; TEMPORARY: handled here because the spoken text must
+			// have access to a post-translation string, free of any meta-characters that
+			// might have been in the original text stream; but text typically arrives too
+			// irregularly and too quickly to allow a useful sentence to be spoken, so it
+			// may be necessary to capture lines and speak them via a timer in a more
+			// orderly fashion
+			unless (TerminalSpeaker_IsMuted(inDataPtr->speaker) || TerminalSpeaker_IsGloballyMuted())
+			{
+				Boolean		doSpeak = false;
 				
 				
 				switch (inDataPtr->speech.mode)
@@ -8285,6 +10004,10 @@ stateDeterminant	(My_EmulatorPtr			inEmulatorPtr,
 				inNowOutNext.second = kMy_ParserStateSeenESCRightSqBracket4;
 				break;
 			
+			case '8':
+				inNowOutNext.second = kMy_ParserStateSeenESCRightSqBracket8;
+				break;
+			
 			default:
 				inNowOutNext.second = kDefaultNextState;
 				result = 0; // do not absorb the unknown
@@ -8408,6 +10131,20 @@ stateDeterminant	(My_EmulatorPtr			inEmulatorPtr,
 			}
 			break;
 		
+		case kMy_ParserStateSeenESCRightSqBracket8:
+			switch (kTriggerChar)
+			{
+			case ';':
+				inNowOutNext.second = kMy_ParserStateSeenESCRightSqBracket8Semi;
+				break;
+			
+			default:
+				inNowOutNext.second = kDefaultNextState;
+				result = 0; // do not absorb the unknown
+				break;
+			}
+			break;
+		
 		case kMy_ParserStateSeenESCPound:
 			switch (kTriggerChar)
 			{
@@ -11464,7 +13201,7 @@ stateTransition		(My_ScreenBufferPtr			inDataPtr,
 			
 			
 			if (kStateSCSG1UK == inOldNew.second) targetCharacterSetPtr = &inDataPtr->vtG1;
-			targetCharacterSetPtr->translationTable = kMy_CharacterSetVT100UnitedKingdom;
+			targetCharacterSetPtr->setTranslationTable(kMy_CharacterSetVT100UnitedKingdom);
 			targetCharacterSetPtr->source = kMy_CharacterROMNormal;
 			targetCharacterSetPtr->graphicsMode = kMy_GraphicsModeOff;
 			inDataPtr->current.drawingAttributes.removeAttributes(kTextAttributes_VTGraphics); // clear graphics attribute
@@ -11480,7 +13217,7 @@ stateTransition		(My_ScreenBufferPtr			inDataPtr,
 			
 			
 			if (kStateSCSG1ASCII == inOldNew.second) targetCharacterSetPtr = &inDataPtr->vtG1;
-			targetCharacterSetPtr->translationTable = kMy_CharacterSetVT100UnitedStates;
+			targetCharacterSetPtr->setTranslationTable(kMy_CharacterSetVT100UnitedStates);
 			targetCharacterSetPtr->source = kMy_CharacterROMNormal;
 			targetCharacterSetPtr->graphicsMode = kMy_GraphicsModeOff;
 			inDataPtr->current.drawingAttributes.removeAttributes(kTextAttributes_VTGraphics); // clear graphics attribute
@@ -11683,14 +13420,34 @@ stateTransition		(My_ScreenBufferPtr			inDataPtr,
 								}
 								else
 								{
-									TextAttributes_TrueColorID		colorID = 0;
+									UInt8 const					kRed = STATIC_CAST(kRedParam, UInt8);
+									UInt8 const					kGreen = STATIC_CAST(kGreenParam, UInt8);
+									UInt8 const					kBlue = STATIC_CAST(kBlueParam, UInt8);
+									TextAttributes_TrueColorID	colorID = 0;
 									
 									
 									//Console_WriteValueFloat4("request to set RGB 24-bit color (R,G,B,fg/bg)",
 									//							kRedParam, kGreenParam, kBlueParam, kSetForeground); // debug
-									if (false == defineTrueColor(inDataPtr, STATIC_CAST(kRedParam, UInt8),
-																	STATIC_CAST(kGreenParam, UInt8),
-																	STATIC_CAST(kBlueParam, UInt8), colorID))
+									if (kSetForeground)
+									{
+										// text colors are stored inline, avoiding the color table entirely
+										inDataPtr->current.inlineColors.setForeground(kRed, kGreen, kBlue);
+										inDataPtr->current.drawingAttributes.colorInlineForegroundSet();
+									}
+									else
+									{
+										inDataPtr->current.inlineColors.setBackground(kRed, kGreen, kBlue);
+										inDataPtr->current.drawingAttributes.colorInlineBackgroundSet();
+									}
+									
+									// erased cells have no inline colors (as that would
+									// allocate colors for lines that have no text), so
+									// Background Color Erase uses a color-table ID
+									if (kSetForeground)
+									{
+										// no erase color
+									}
+									else if (false == defineTrueColor(inDataPtr, kRed, kGreen, kBlue, colorID))
 									{
 										// NOTE: this should not happen because the supportsVariant() method
 										// is called earlier, and the color table should always be allocated
@@ -11702,14 +13459,7 @@ stateTransition		(My_ScreenBufferPtr			inDataPtr,
 									}
 									else
 									{
-										if (kSetForeground)
-										{
-											inDataPtr->current.drawingAttributes.colorIDForegroundSet(colorID);
-										}
-										else
-										{
-											inDataPtr->current.drawingAttributes.colorIDBackgroundSet(colorID);
-										}
+										inDataPtr->current.latentAttributes.colorIDBackgroundSet(colorID);
 									}
 								}
 								skipParameterCount = 4; // skip parameters (2, 3, 4, 5)
@@ -13243,6 +14993,11 @@ requestDECPrivateMode	(My_ScreenBufferPtr		inDataPtr)
 				modeValue = ((inDataPtr->cursorBlinking) ? kModeValueSet : kModeValueReset);
 				break;
 			
+			case 2004:
+				// bracketed paste
+				modeValue = ((inDataPtr->modeBracketedPaste) ? kModeValueSet : kModeValueReset);
+				break;
+			
 			default:
 				// unknown or unsupported
 				modeValue = kModeValueUnrecognized;
@@ -13931,7 +15686,7 @@ stateTransition		(My_ScreenBufferPtr			inDataPtr,
 			
 			
 			if (kStateSCSG3UK == inOldNew.second) targetCharacterSetPtr = &inDataPtr->vtG3;
-			targetCharacterSetPtr->translationTable = kMy_CharacterSetVT100UnitedKingdom;
+			targetCharacterSetPtr->setTranslationTable(kMy_CharacterSetVT100UnitedKingdom);
 			targetCharacterSetPtr->source = kMy_CharacterROMNormal;
 			targetCharacterSetPtr->graphicsMode = kMy_GraphicsModeOff;
 			inDataPtr->current.drawingAttributes.removeAttributes(kTextAttributes_VTGraphics); // clear graphics attribute
@@ -13947,7 +15702,7 @@ stateTransition		(My_ScreenBufferPtr			inDataPtr,
 			
 			
 			if (kStateSCSG3ASCII == inOldNew.second) targetCharacterSetPtr = &inDataPtr->vtG3;
-			targetCharacterSetPtr->translationTable = kMy_CharacterSetVT100UnitedStates;
+			targetCharacterSetPtr->setTranslationTable(kMy_CharacterSetVT100UnitedStates);
 			targetCharacterSetPtr->source = kMy_CharacterROMNormal;
 			targetCharacterSetPtr->graphicsMode = kMy_GraphicsModeOff;
 			inDataPtr->current.drawingAttributes.removeAttributes(kTextAttributes_VTGraphics); // clear graphics attribute
@@ -14273,7 +16028,7 @@ reportCursorStyle	(My_ScreenBufferPtr		inDataPtr)
 				cursorShape = kTerminal_CursorTypeBlock;
 			}
 			
-			prefsResult = Preferences_GetData(kPreferences_TagCursorBlinks, sizeof(cursorBlinks), &cursorBlinks);
+			prefsResult = Preferences_GetValue< kPreferences_TagCursorBlinks >(cursorBlinks);
 			if (kPreferences_ResultOK != prefsResult)
 			{
 				// assume a default if preference can’t be found
@@ -14767,6 +16522,30 @@ stateTransition		(My_ScreenBufferPtr			inDataPtr,
 		horizontalPositionAbsolute(inDataPtr);
 		break;
 	
+	case My_VT100::kStateRM:
+	case My_VT100::kStateSM:
+		// the VT100 handles set/reset, but it does not know XTerm modes
+		outHandled = false;
+		if (kMy_ParamPrivate == inDataPtr->emulator.argList[0])
+		{
+			for (SInt16 i = 1/* skip the meta-parameter */; i <= inDataPtr->emulator.argLastIndex; ++i)
+			{
+				if (2004 == inDataPtr->emulator.argList[i])
+				{
+					// bracketed paste (see Terminal_BracketedPasteIsEnabled())
+					inDataPtr->modeBracketedPaste = (My_VT100::kStateSM == inOldNew.second);
+				}
+				else if ((47 == inDataPtr->emulator.argList[i]) || (1047 == inDataPtr->emulator.argList[i]) ||
+							(1049 == inDataPtr->emulator.argList[i]))
+				{
+					// alternate screen (see Terminal_AlternateScreenIsActive());
+					// only the mode is tracked, the screen is not switched
+					inDataPtr->modeAlternateScreen = (My_VT100::kStateSM == inOldNew.second);
+				}
+			}
+		}
+		break;
+	
 	case kStateSD:
 		scrollDown(inDataPtr);
 		break;
@@ -14988,6 +16767,27 @@ stateDeterminant	(My_EmulatorPtr			inEmulatorPtr,
 		}
 		break;
 	
+	case kStateHyperlinkAcquireStr:
+		// hyperlinks do not depend on any variant; the text is the
+		// same whether or not the terminal knows where it points
+		switch (kTriggerChar)
+		{
+		case '\007':
+			inNowOutNext.second = My_VT220::kStateST;
+			break;
+		
+		case '\033':
+			inNowOutNext.second = kMy_ParserStateSeenESC;
+			break;
+		
+		default:
+			// continue extending the string until a known terminator is found
+			inNowOutNext.second = kStateHyperlinkAcquireStr;
+			result = 0; // do not absorb the unknown
+			break;
+		}
+		break;
+	
 	default:
 		// other states are not handled at all
 		outHandled = false;
@@ -15030,6 +16830,7 @@ stateTransition		(My_ScreenBufferPtr			inDataPtr,
 	case kStateSIT:
 	case kStateSWT:
 	case kStateSetColor:
+	case kStateHyperlink:
 		inDataPtr->emulator.stringAccumulator.clear();
 		inDataPtr->emulator.stringAccumulatorState = inOldNew.second;
 		break;
@@ -15038,6 +16839,7 @@ stateTransition		(My_ScreenBufferPtr			inDataPtr,
 	case kStateSWITAcquireStr:
 	case kStateSITAcquireStr:
 	case kStateSWTAcquireStr:
+	case kStateHyperlinkAcquireStr:
 		// upon first entry to the state, ignore the code point (semicolon)
 		// that caused the state to be selected; only accumulate code points
 		// that occurred while the previous state was also accumulating
@@ -15208,6 +17010,10 @@ stateTransition		(My_ScreenBufferPtr			inDataPtr,
 						colorInfo.greenComponent = STATIC_CAST(g, UInt8);
 						colorInfo.blueComponent = STATIC_CAST(b, UInt8);
 						
+						// remember the change so that it is saved with the terminal state
+						inDataPtr->xtermColors[colorInfo.index] = ((STATIC_CAST(r, UInt32) << 16) | (STATIC_CAST(g, UInt32) << 8) |
+																	STATIC_CAST(b, UInt32));
+						
 						changeNotifyForTerminal(inDataPtr, kTerminal_ChangeXTermColor, &colorInfo/* context */);
 						
 						//Console_WriteValueFloat4("set color at index to red, green, blue", i, r, g, b);
@@ -15229,6 +17035,30 @@ stateTransition		(My_ScreenBufferPtr			inDataPtr,
 			}
 			break;
 		
+		case kStateHyperlink:
+			{
+				// the string has the form "params;URI"; parameters (such as
+				// "id=") are not used, and an empty URI ends the current link;
+				// text that is echoed from now on refers to the link by ID
+				std::string const				kString(REINTERPRET_CAST(inDataPtr->emulator.stringAccumulator.c_str(), char const*),
+														inDataPtr->emulator.stringAccumulator.size());
+				std::string::size_type const	kSeparatorPos = kString.find(';');
+				
+				
+				if (std::string::npos == kSeparatorPos)
+				{
+					Console_Warning(Console_WriteValueStdString, "discarding hyperlink string without parameters", kString);
+				}
+				else
+				{
+					inDataPtr->current.hyperlinkID = LinkScanner_InternURI(inDataPtr->linkURIs, kString.substr(kSeparatorPos + 1));
+				}
+				
+				inDataPtr->emulator.stringAccumulator.clear();
+				inDataPtr->emulator.stringAccumulatorState = kMy_ParserStateInitial;
+			}
+			break;
+		
 		default:
 			// ignore
 			outHandled = false;
@@ -15250,6 +17080,32 @@ stateTransition		(My_ScreenBufferPtr			inDataPtr,
 }// My_XTermCore::stateTransition
 
 
+/*!
+Appends one section of saved terminal state, first adding
+enough padding to start the section at a multiple of
+"kMy_StateAlignment" from the start of the state, and
+records where the section is.
+
+(2021.06)
+*/
+void
+appendStateSection	(std::vector< UInt8 >&		inoutBuffer,
+					 size_t						inStateOffset,
+					 My_StateSectionRange&		outRange,
+					 void const*				inBytes,
+					 size_t						inByteCount)
+{
+	UInt8 const* const		kBytePtr = REINTERPRET_CAST(inBytes, UInt8 const*);
+	size_t const			kAlignedSize = (kMy_StateAlignment - 1 + inoutBuffer.size() - inStateOffset) / kMy_StateAlignment * kMy_StateAlignment;
+	
+	
+	inoutBuffer.resize(inStateOffset + kAlignedSize, 0);
+	outRange.offset = kAlignedSize;
+	outRange.byteCount = inByteCount;
+	inoutBuffer.insert(inoutBuffer.end(), kBytePtr, kBytePtr + inByteCount);
+}// appendStateSection
+
+
 /*!
 Performs various assertions on the current custom scrolling
 region range, to make sure all values are valid.
@@ -15344,6 +17200,7 @@ bufferEraseFromCursorColumn		(My_ScreenBufferPtr		inDataPtr,
 	if (inChanges & kMy_BufferChangesResetCharacterAttributes)
 	{
 		std::fill(attrIterator, endAttrs, (*cursorLineIterator)->returnGlobalAttributes());
+		(*cursorLineIterator)->clearInlineColors(postWrapCursorX, postWrapCursorX + fillDistance);
 	}
 	if (inChanges & kMy_BufferChangesKeepBackgroundColor)
 	{
@@ -15419,6 +17276,7 @@ bufferEraseFromCursorColumnToLineEnd	(My_ScreenBufferPtr		inDataPtr,
 	if (inChanges & kMy_BufferChangesResetCharacterAttributes)
 	{
 		std::fill(attrIterator, endAttrs, (*cursorLineIterator)->returnGlobalAttributes());
+		(*cursorLineIterator)->clearInlineColors(postWrapCursorX, kTerminalLine_MaximumCharacterCount);
 	}
 	if (inChanges & kMy_BufferChangesKeepBackgroundColor)
 	{
@@ -15610,6 +17468,7 @@ bufferEraseFromLineBeginToCursorColumn  (My_ScreenBufferPtr		inDataPtr,
 	if (inChanges & kMy_BufferChangesResetCharacterAttributes)
 	{
 		std::fill(attrIterator, endAttrs, (*cursorLineIterator)->returnGlobalAttributes());
+		(*cursorLineIterator)->clearInlineColors(0, fillDistance);
 	}
 	if (inChanges & kMy_BufferChangesKeepBackgroundColor)
 	{
@@ -15683,6 +17542,7 @@ bufferEraseLineWithoutUpdate	(My_ScreenBufferPtr  	inDataPtr,
 	if (inChanges & kMy_BufferChangesResetCharacterAttributes)
 	{
 		std::fill(attrIterator, endAttrs, inRow.returnGlobalAttributes());
+		inRow.clearInlineColors(0, kTerminalLine_MaximumCharacterCount);
 	}
 	if (inChanges & kMy_BufferChangesKeepBackgroundColor)
 	{
@@ -15892,6 +17752,10 @@ bufferInsertBlankLines	(My_ScreenBufferPtr						inDataPtr,
 			{
 				attributeFlags.removeImageRelatedAttributes();
 			}
+			if (false == (*inInsertionLine)->returnInlineColorVector().empty())
+			{
+				lineTemplate->returnMutableInlineColorVector() = (*inInsertionLine)->returnInlineColorVector();
+			}
 			lineTemplate->returnMutableGlobalAttributes() = (*inInsertionLine)->returnGlobalAttributes();
 			inDataPtr->screenBuffer.insert(inInsertionLine, kMostLines, lineTemplate);
 		}
@@ -16126,6 +17990,7 @@ bufferLineFill	(My_ScreenBufferPtr			UNUSED_ARGUMENT(inDataPtr),
 {
 	inRow.fillWith(inFillCharacter);
 	std::fill(inRow.returnMutableAttributeVector().begin(), inRow.returnMutableAttributeVector().end(), inFillAttributes);
+	inRow.clearInlineColors(0, kTerminalLine_MaximumCharacterCount);
 	if (inUpdateLineGlobalAttributesAlso)
 	{
 		inRow.returnMutableGlobalAttributes() = inFillAttributes;
@@ -16268,6 +18133,10 @@ bufferRemoveLines	(My_ScreenBufferPtr						inDataPtr,
 			{
 				attributeFlags.removeImageRelatedAttributes();
 			}
+			if (false == (*toCopiedLine)->returnInlineColorVector().empty())
+			{
+				lineTemplate->returnMutableInlineColorVector() = (*toCopiedLine)->returnInlineColorVector();
+			}
 			lineTemplate->returnMutableGlobalAttributes() = (*toCopiedLine)->returnGlobalAttributes();
 			inDataPtr->screenBuffer.insert(scrollingRegionEnd, kMostLines, lineTemplate);
 		}
@@ -16423,6 +18292,9 @@ changeNotifyForTerminal		(My_ScreenBufferConstPtr	inPtr,
 							 Terminal_Change			inWhatChanged,
 							 void*						inContextPtr)
 {
+	TraceSpan_Scope("Terminal change notification");
+	
+	
 	// invoke listener callback routines appropriately, from the specified terminal’s listener model
 	ListenerModel_NotifyListenersOfEvent(inPtr->changeListenerModel, inWhatChanged, inContextPtr);
 }// changeNotifyForTerminal
@@ -16461,6 +18333,7 @@ cursorRestore  (My_ScreenBufferPtr		inPtr)
 	
 	// ??? this will clear the current graphics character set too, is that supposed to happen ???
 	inPtr->current.drawingAttributes = inPtr->previous.drawingAttributes;
+	inPtr->current.inlineColors = inPtr->previous.inlineColors;
 }// cursorRestore
 
 
@@ -16477,6 +18350,7 @@ cursorSave  (My_ScreenBufferPtr  inPtr)
 	inPtr->previous.cursorX = inPtr->current.cursorX;
 	inPtr->previous.cursorY = inPtr->current.cursorY;
 	inPtr->previous.drawingAttributes = inPtr->current.drawingAttributes;
+	inPtr->previous.inlineColors = inPtr->current.inlineColors;
 }// cursorSave
 
 
@@ -16599,8 +18473,8 @@ public Terminal_TrueColorGetFromID() API.)  Returns true
 only if successful.
 
 As noted in "TextAttributes.h", there is a limit to the
-number of possible IDs and they will be reused (oldest
-first) when the limit is exceeded.
+number of possible IDs and they will be reused (least
+recently used first) when the limit is exceeded.
 
 The color components are used to find any existing ID
 for the same color however, preventing many individual
@@ -16617,78 +18491,11 @@ defineTrueColor		(My_ScreenBufferPtr				inDataPtr,
 					 TextAttributes_TrueColorID&	outColorID)
 {
 	Boolean		result = false;
-	UInt32		rgbKey = (inBlue | (inGreen << 8) | (inRed << 16));
-	auto&		rgbMap = inDataPtr->emulator.trueColorIDsByRGB;
-	auto		rgbIter = inDataPtr->emulator.trueColorIDsByRGB.find(rgbKey);
 	
 	
-	if (rgbIter != rgbMap.end())
+	if (nullptr != inDataPtr->emulator.trueColorTable)
 	{
-		// the specified R/G/B combination is currently in use
-		// and it has an ID; rather than wasting another ID,
-		// return the existing ID
-		outColorID = rgbIter->second;
-		result = true;
-	}
-	else if (nullptr != inDataPtr->emulator.trueColorTableReds)
-	{
-		outColorID = inDataPtr->emulator.trueColorTableNextID;
-		
-		if (inDataPtr->emulator.trueColorTableReds->size() <= kTextAttributes_TrueColorIDMaximum)
-		{
-			// table is not yet big enough; allocate more space
-			inDataPtr->emulator.trueColorTableReds->push_back(inRed);
-			inDataPtr->emulator.trueColorTableGreens->push_back(inGreen);
-			inDataPtr->emulator.trueColorTableBlues->push_back(inBlue);
-			if (inDataPtr->emulator.trueColorTableNextID == kTextAttributes_TrueColorIDMaximum)
-			{
-				// table has reached its maximum size; next one will overwrite
-				inDataPtr->emulator.trueColorTableNextID = 0;
-			}
-			else
-			{
-				// set next ID to match index of next new element
-				inDataPtr->emulator.trueColorTableNextID = STATIC_CAST(inDataPtr->emulator.trueColorTableReds->size(), UInt16);
-			}
-		}
-		else
-		{
-			// table is at maximum size; reuse the already-allocated space
-			(*(inDataPtr->emulator.trueColorTableReds))[inDataPtr->emulator.trueColorTableNextID] = inRed;
-			(*(inDataPtr->emulator.trueColorTableGreens))[inDataPtr->emulator.trueColorTableNextID] = inGreen;
-			(*(inDataPtr->emulator.trueColorTableBlues))[inDataPtr->emulator.trueColorTableNextID] = inBlue;
-			if (kTextAttributes_TrueColorIDMaximum == inDataPtr->emulator.trueColorTableNextID)
-			{
-				inDataPtr->emulator.trueColorTableNextID = 0;
-			}
-			else
-			{
-				++(inDataPtr->emulator.trueColorTableNextID);
-			}
-			
-			// remove any previous RGB mapping to the ID that is being reused
-			// (otherwise, a future request for the previous key color would
-			// continue to return the same ID)
-			auto	iterPair = inDataPtr->emulator.trueColorIDsByRGB.begin();
-			auto	endPairs = inDataPtr->emulator.trueColorIDsByRGB.end();
-			for (; iterPair != endPairs; ++iterPair)
-			{
-				if (outColorID == iterPair->second)
-				{
-					break;
-				}
-			}
-			if (iterPair != endPairs)
-			{
-				inDataPtr->emulator.trueColorIDsByRGB.erase(iterPair);
-			}
-		}
-		
-		// create a mapping based on the RGB value back to this entry
-		// so that repeated requests for the same color do not exhaust
-		// the limited set of color ID entries
-		rgbMap[rgbKey] = outColorID;
-		
+		outColorID = inDataPtr->emulator.trueColorTable->returnColorID(inRed, inGreen, inBlue);
 		result = true;
 	}
 	
@@ -16729,20 +18536,23 @@ void
 echoCFString	(My_ScreenBufferPtr		inDataPtr,
 				 CFStringRef			inString)
 {
+	TraceSpan_Scope("echoCFString");
 	CFIndex const	kLength = CFStringGetLength(inString);
 	Boolean const	kPrinterOnly = (0 != (inDataPtr->printingModes & kMy_PrintingModePrintController));
 	
 	
+	Boolean const	kCaptureText = ((false == kPrinterOnly) && StreamCapture_IsCapturingRenderedText(inDataPtr->captureStream));
+	
+	
 	// append to capture file, if one is open; try to avoid conversion,
-	// but if necessary convert the bytes into a Unicode format
-	if ((nullptr != inDataPtr->captureStream) || (nullptr != inDataPtr->printingStream))
+	// but if necessary convert the bytes into a Unicode format (the
+	// conversion buffer is reused so that echoes do not allocate)
+	if ((kCaptureText) || (nullptr != inDataPtr->printingStream))
 	{
 		CFStringEncoding const		kDesiredEncoding = kCFStringEncodingUTF8;
 		CFIndex						bytesNeeded = 0;
 		UInt8 const*				bufferReadOnly = REINTERPRET_CAST(CFStringGetCStringPtr(inString, kDesiredEncoding),
 																		UInt8 const*);
-		UInt8*						buffer = nullptr;
-		Boolean						freeBuffer = false;
 		
 		
 		if (nullptr != bufferReadOnly)
@@ -16751,31 +18561,29 @@ echoCFString	(My_ScreenBufferPtr		inDataPtr,
 		}
 		else
 		{
-			CFIndex		conversionResult = CFStringGetBytes(inString, CFRangeMake(0, kLength),
-															kDesiredEncoding, '?'/* loss byte */,
-															true/* is external representation */,
-															nullptr/* buffer; do not use, just find size */, 0/* buffer size, ignored */,
-															&bytesNeeded);
+			// the maximum size is enough for any conversion; a few bytes
+			// are added in case the external representation has a marker
+			CFIndex const	kBufferSize = (CFStringGetMaximumSizeForEncoding(kLength, kDesiredEncoding) + 4);
+			CFIndex			conversionResult = 0;
 			
 			
+			if (inDataPtr->echoConversionBuffer.size() < STATIC_CAST(kBufferSize, size_t))
+			{
+				inDataPtr->echoConversionBuffer.resize(kBufferSize);
+			}
+			conversionResult = CFStringGetBytes(inString, CFRangeMake(0, kLength),
+												kDesiredEncoding, '?'/* loss byte */,
+												true/* is external representation */,
+												inDataPtr->echoConversionBuffer.data(), kBufferSize, &bytesNeeded);
 			if (conversionResult > 0)
 			{
-				buffer = new UInt8[bytesNeeded];
-				freeBuffer = true;
-				
-				conversionResult = CFStringGetBytes(inString, CFRangeMake(0, kLength),
-													kDesiredEncoding, '?'/* loss byte */,
-													true/* is external representation */,
-													buffer, bytesNeeded, &bytesNeeded);
-				assert(conversionResult > 0);
-				
-				bufferReadOnly = buffer;
+				bufferReadOnly = inDataPtr->echoConversionBuffer.data();
 			}
 		}
 		
 		if (nullptr != bufferReadOnly)
 		{
-			if ((false == kPrinterOnly) && (nullptr != inDataPtr->captureStream))
+			if (kCaptureText)
 			{
 				StreamCapture_WriteUTF8Data(inDataPtr->captureStream, bufferReadOnly, bytesNeeded);
 			}
@@ -16784,11 +18592,6 @@ echoCFString	(My_ScreenBufferPtr		inDataPtr,
 				StreamCapture_WriteUTF8Data(inDataPtr->printingStream, bufferReadOnly, bytesNeeded);
 			}
 		}
-		
-		if (freeBuffer)
-		{
-			delete [] buffer, buffer = nullptr;
-		}
 	}
 	
 	// add each character to the terminal at the current cursor position, advancing
@@ -16845,6 +18648,12 @@ echoCFString	(My_ScreenBufferPtr		inDataPtr,
 																									inDataPtr->current.drawingAttributes,
 																									temporaryAttributes);
 			(*cursorLineIterator)->returnMutableAttributeVector()[inDataPtr->current.cursorX] = temporaryAttributes;
+			(*cursorLineIterator)->setLinkForCell(inDataPtr->current.cursorX, inDataPtr->current.hyperlinkID);
+			if (temporaryAttributes.hasInlineColor())
+			{
+				// this allocates colors for the line only if it has none yet
+				(*cursorLineIterator)->returnMutableInlineColorVector()[inDataPtr->current.cursorX] = inDataPtr->current.inlineColors;
+			}
 			
 			if (false == inDataPtr->wrapPending)
 			{
@@ -16906,6 +18715,15 @@ echoCFString	(My_ScreenBufferPtr		inDataPtr,
 			//Console_WriteValuePair("text changed event: add data for #rows, #columns", range.rowCount, range.columnCount);
 			changeNotifyForTerminal(inDataPtr, kTerminal_ChangeTextEdited, &range);
 		}
+		
+		// look for links a short time after the first write; the timer
+		// is not rearmed by later writes, so lines that change in many
+		// pieces are scanned at most once per interval and continuous
+		// output (which never pauses) still has its links found
+		unless (TimerWheel_IsArmed(inDataPtr->linkScanTimer))
+		{
+			UNUSED_RETURN(TimerWheel_Result)TimerWheel_Arm(inDataPtr->linkScanTimer, kMy_LinkScanDelay);
+		}
 	}
 }// echoCFString
 
@@ -16940,9 +18758,52 @@ eraseRightHalfOfLine	(My_ScreenBufferPtr		inDataPtr,
 	std::advance(attrIterator, midColumn);
 	inRow.fillWith(CFSTR(" "), clearedRange);
 	std::fill(attrIterator, inRow.returnMutableAttributeVector().end(), inRow.returnGlobalAttributes());
+	inRow.clearInlineColors(midColumn, kTerminalLine_MaximumCharacterCount);
 }// eraseRightHalfOfLine
 
 
+/*!
+Finds a section of saved terminal state whose header has
+already been checked (including the size of the section
+table).  A section that the state does not have is empty
+("outSectionPtr" is nullptr and the size is zero).
+
+Returns false if the section does not fit in the data or
+is not aligned, which means that the state is damaged.
+
+(2021.06)
+*/
+Boolean
+findStateSection	(UInt8 const*		inStateBytes,
+					 size_t				inByteCount,
+					 My_StateSection	inSection,
+					 UInt8 const*&		outSectionPtr,
+					 size_t&			outSectionByteCount)
+{
+	My_StateHeader const&	header = *REINTERPRET_CAST(inStateBytes, My_StateHeader const*);
+	Boolean					result = true;
+	
+	
+	outSectionPtr = nullptr;
+	outSectionByteCount = 0;
+	if (inSection < header.sectionCount)
+	{
+		My_StateSectionRange const&		range = REINTERPRET_CAST(inStateBytes + sizeof(My_StateHeader),
+																	My_StateSectionRange const*)[inSection];
+		
+		
+		result = ((0 == (range.offset % kMy_StateAlignment)) && (range.offset <= inByteCount) &&
+					(range.byteCount <= (inByteCount - range.offset)));
+		if (result)
+		{
+			outSectionPtr = inStateBytes + range.offset;
+			outSectionByteCount = STATIC_CAST(range.byteCount, size_t);
+		}
+	}
+	return result;
+}// findStateSection
+
+
 /*!
 Returns a pointer to the internal structure, given a
 reference to it.
@@ -17174,6 +19035,40 @@ invokeEmulatorStateTransitionProc	(My_EmulatorStateTransitionProcPtr	inProc,
 }// invokeEmulatorStateTransitionProc
 
 
+/*!
+Invoked "kMy_LinkScanDelay" milliseconds after text is
+first written to a screen (and at most that often while
+output continues); finds the links on every main screen line
+whose text changed since it was last scanned, so that
+links are known before the user points at them.  Lines
+that scroll away before this runs are scanned on demand
+(see Terminal_CopyLinkAtColumn()).
+
+(2021.06)
+*/
+void
+linkScanTimerFired	(TimerWheel_TimerRef	UNUSED_ARGUMENT(inTimer),
+					 void*					inScreenBufferPtr)
+{
+	TraceSpan_Scope("Terminal link scan");
+	My_ScreenBufferPtr		dataPtr = REINTERPRET_CAST(inScreenBufferPtr, My_ScreenBufferPtr);
+	
+	
+	for (My_ScreenBufferLinePtr& linePtrRef : dataPtr->screenBuffer)
+	{
+		My_ScreenBufferLinePtr const&	kConstLinePtr = linePtrRef;
+		
+		
+		// a line that needs a scan is never the shared blank line,
+		// so the mutable reference below does not allocate anything
+		if (kConstLinePtr->isLinkScanNeeded())
+		{
+			scanLineForLinks(dataPtr, *linePtrRef);
+		}
+	}
+}// linkScanTimerFired
+
+
 /*!
 Locates the screen buffer line that the cursor is on,
 providing an iterator into its list (which may be
@@ -17629,6 +19524,7 @@ moveCursorX		(My_ScreenBufferPtr		inDataPtr,
 			
 			locateCursorLine(inDataPtr, cursorLineIterator);
 			inDataPtr->current.cursorAttributes = (*cursorLineIterator)->returnAttributeVector()[inDataPtr->current.cursorX];
+			inDataPtr->current.cursorInlineColors = returnInlineColorsAt(*cursorLineIterator, inDataPtr->current.cursorX);
 		}
 		
 		// reset wrap flag, now that the cursor is moving
@@ -17704,6 +19600,7 @@ moveCursorY		(My_ScreenBufferPtr		inDataPtr,
 		}
 		
 		inDataPtr->current.cursorAttributes = (*cursorLineIterator)->returnAttributeVector()[inDataPtr->current.cursorX];
+		inDataPtr->current.cursorInlineColors = returnInlineColorsAt(*cursorLineIterator, inDataPtr->current.cursorX);
 		
 		// reset wrap flag, now that the cursor is moving
 		inDataPtr->wrapPending = false;
@@ -17721,6 +19618,93 @@ moveCursorY		(My_ScreenBufferPtr		inDataPtr,
 }// moveCursorY
 
 
+/*!
+Creates a terminal screen for tests, with the given size
+and a fixed number of scrollback rows.  Returns nullptr if
+the screen cannot be created; otherwise, release it with
+Terminal_ReleaseScreen().
+
+(2021.06)
+*/
+TerminalScreenRef
+newTestScreen	(UInt16		inColumnCount,
+				 UInt16		inRowCount,
+				 UInt32		inScrollbackRowCount)
+{
+	Preferences_ContextWrap		terminalConfig(Preferences_NewContext(Quills::Prefs::TERMINAL),
+												Preferences_ContextWrap::kAlreadyRetained);
+	Preferences_ContextWrap		translationConfig(Preferences_NewContext(Quills::Prefs::TRANSLATION),
+													Preferences_ContextWrap::kAlreadyRetained);
+	Terminal_ScrollbackType		scrollbackType = kTerminal_ScrollbackTypeFixed;
+	TerminalScreenRef			result = nullptr;
+	
+	
+	UNUSED_RETURN(Preferences_Result)Preferences_ContextSetData(terminalConfig.returnRef(), kPreferences_TagTerminalScreenColumns,
+																sizeof(inColumnCount), &inColumnCount);
+	UNUSED_RETURN(Preferences_Result)Preferences_ContextSetData(terminalConfig.returnRef(), kPreferences_TagTerminalScreenRows,
+																sizeof(inRowCount), &inRowCount);
+	UNUSED_RETURN(Preferences_Result)Preferences_ContextSetData(terminalConfig.returnRef(), kPreferences_TagTerminalScreenScrollbackType,
+																sizeof(scrollbackType), &scrollbackType);
+	UNUSED_RETURN(Preferences_Result)Preferences_ContextSetData(terminalConfig.returnRef(), kPreferences_TagTerminalScreenScrollbackRows,
+																sizeof(inScrollbackRowCount), &inScrollbackRowCount);
+	unless (kTerminal_ResultOK == Terminal_NewScreen(terminalConfig.returnRef(), translationConfig.returnRef(), &result))
+	{
+		result = nullptr;
+	}
+	return result;
+}// newTestScreen
+
+
+/*!
+Reads the XTerm palette section of saved terminal state
+(see kMy_StateSectionXTermColors) into the given map.
+Returns false, and leaves the map empty, if the section is
+truncated or has an entry that cannot be set by an
+application (one of the 16 base ANSI colors, or an index
+or color value that is out of range).
+
+(2021.06)
+*/
+Boolean
+readStateXTermColors	(UInt8 const*				inSectionPtr,
+						 size_t						inByteCount,
+						 My_XTermColorByIndex&		outColors)
+{
+	UInt32 const* const		kPaletteValues = REINTERPRET_CAST(inSectionPtr, UInt32 const*);
+	Boolean					result = true;
+	
+	
+	outColors.clear();
+	if ((inByteCount < sizeof(UInt32)) ||
+		((((inByteCount / sizeof(UInt32)) - 1) / 2) < kPaletteValues[0]))
+	{
+		result = false;
+	}
+	else
+	{
+		for (UInt32 i = 0; i < kPaletteValues[0]; ++i)
+		{
+			UInt32 const	kIndex = kPaletteValues[1 + 2 * i];
+			UInt32 const	kRGB = kPaletteValues[2 + 2 * i];
+			
+			
+			if ((kIndex < 16) || (kIndex > 255) || (kRGB > 0x00FFFFFF))
+			{
+				result = false;
+				break;
+			}
+			outColors[STATIC_CAST(kIndex, UInt8)] = kRGB;
+		}
+		
+		if (false == result)
+		{
+			outColors.clear();
+		}
+	}
+	return result;
+}// readStateXTermColors
+
+
 /*!
 Resets terminal modes to defaults, and (for hard resets) clears
 the screen and returns all settings to factory defaults.
@@ -17740,11 +19724,14 @@ resetTerminal   (My_ScreenBufferPtr		inDataPtr,
 	//inDataPtr->modeAutoWrap = false; // 3.0 - do not touch the auto-wrap setting
 	inDataPtr->modeCursorKeysForApp = false;
 	inDataPtr->modeApplicationKeys = false;
+	inDataPtr->modeAlternateScreen = false;
+	inDataPtr->modeBracketedPaste = false;
 	inDataPtr->modeOriginRedefined = false; // also requires cursor homing (below), according to manual
 	inDataPtr->originRegionPtr = &inDataPtr->visibleBoundary.rows;
 	inDataPtr->previous.drawingAttributes = kTextAttributes_Invalid;
 	inDataPtr->current.drawingAttributes.clear();
 	inDataPtr->current.latentAttributes.clear();
+	inDataPtr->current.hyperlinkID = 0;
 	inDataPtr->modeInsertNotReplace = false;
 	inDataPtr->modeNewLineOption = false;
 	inDataPtr->emulator.isUTF8Encoding = (kCFStringEncodingUTF8 == inDataPtr->emulator.inputTextEncoding);
@@ -17770,6 +19757,85 @@ resetTerminal   (My_ScreenBufferPtr		inDataPtr,
 }// resetTerminal
 
 
+/*!
+Returns the 24-bit colors of the specified cell of a line,
+or black if the line has no inline colors at all.  This is
+only meaningful for attributes of the same cell that set an
+inline-color bit.
+
+(2021.06)
+*/
+TextAttributes_InlineColors
+returnInlineColorsAt	(My_ScreenBufferLinePtr const&	inLinePtr,
+						 SInt16							inColumn)
+{
+	TerminalLine_InlineColorList const&		colorVector = inLinePtr->returnInlineColorVector();
+	TextAttributes_InlineColors				result;
+	
+	
+	if ((inColumn >= 0) && (STATIC_CAST(inColumn, size_t) < colorVector.size()))
+	{
+		result = colorVector[inColumn];
+	}
+	return result;
+}// returnInlineColorsAt
+
+
+/*!
+Compares two lists of lines in order, and returns the number
+of lines that differ in the text, attributes or inline colors
+of their first "inColumnCount" cells, or in their global
+attributes; any difference in the number of lines is also
+counted.  Used by tests.
+
+(2021.06)
+*/
+UInt32
+returnLineMismatchCount		(My_ScreenBufferLineList const&		inLines1,
+							 My_ScreenBufferLineList const&		inLines2,
+							 UInt16								inColumnCount)
+{
+	auto		toLine1 = inLines1.cbegin();
+	auto		toLine2 = inLines2.cbegin();
+	UInt32		result = 0;
+	
+	
+	for (; ((toLine1 != inLines1.cend()) && (toLine2 != inLines2.cend())); ++toLine1, ++toLine2)
+	{
+		My_ScreenBufferLine const&	kLine1 = **toLine1;
+		My_ScreenBufferLine const&	kLine2 = **toLine2;
+		Boolean						isSame = ((kLine1.returnGlobalAttributes() == kLine2.returnGlobalAttributes()) &&
+												std::equal(kLine1.textVectorBegin, kLine1.textVectorBegin + inColumnCount,
+															kLine2.textVectorBegin));
+		
+		
+		for (UInt16 i = 0; (isSame && (i < inColumnCount)); ++i)
+		{
+			TextAttributes_Object const		kAttributes = kLine1.returnAttributeVector()[i];
+			
+			
+			isSame = ((kAttributes == kLine2.returnAttributeVector()[i]) &&
+						((false == kAttributes.hasInlineColor()) ||
+							(returnInlineColorsAt(*toLine1, i) == returnInlineColorsAt(*toLine2, i))));
+		}
+		
+		if (false == isSame)
+		{
+			++result;
+		}
+	}
+	for (; toLine1 != inLines1.cend(); ++toLine1)
+	{
+		++result;
+	}
+	for (; toLine2 != inLines2.cend(); ++toLine2)
+	{
+		++result;
+	}
+	return result;
+}// returnLineMismatchCount
+
+
 /*!
 Returns the currently attached SessionRef, or nullptr
 if none is attached.  This is necessary for a small
@@ -17785,6 +19851,39 @@ returnListeningSession	(My_ScreenBufferPtr		inDataPtr)
 }// returnListeningSession
 
 
+/*!
+Finds the URLs in the visible columns of the given line, and
+replaces its scanned links (see TerminalLine_Object::setScannedLinks());
+the ID of each link is its URL type.
+
+(2021.06)
+*/
+void
+scanLineForLinks	(My_ScreenBufferConstPtr	inDataPtr,
+					 My_ScreenBufferLine&		inoutLine)
+{
+	UInt16 const			kColumnCount = std::min< UInt16 >(inDataPtr->text.visibleScreen.numberOfColumnsPermitted,
+																STATIC_CAST(inoutLine.textVectorEnd - inoutLine.textVectorBegin, UInt16));
+	LinkScanner_SpanList	spans;
+	TerminalLine_LinkList	links;
+	
+	
+	LinkScanner_FindLinks(URL_ReturnLinkMatcher(), inoutLine.textVectorBegin, kColumnCount, spans);
+	links.reserve(spans.size());
+	for (auto const& span : spans)
+	{
+		TerminalLine_Link	link;
+		
+		
+		link.startColumn = span.startIndex;
+		link.pastTheEndColumn = span.pastTheEndIndex;
+		link.linkID = span.schemeIndex;
+		links.push_back(link);
+	}
+	inoutLine.setScannedLinks(links);
+}// scanLineForLinks
+
+
 /*!
 Appends the visible screen to the scrollback buffer, usually in
 preparation for then blanking the visible screen area.
@@ -18276,7 +20375,7 @@ setVisibleRowCount	(My_ScreenBufferPtr		inPtr,
 	
 	
 	//Console_WriteValue("requested new number of lines", inNewNumberOfLinesHigh);
-	if (inNewNumberOfLinesHigh > 200)
+	if (inNewNumberOfLinesHigh > kMy_MaximumRowCount)
 	{
 		Console_WriteLine("refusing to resize on account of ridiculous line size");
 		result = kTerminal_ResultParameterError;
@@ -18366,112 +20465,370 @@ setVisibleRowCount	(My_ScreenBufferPtr		inPtr,
 
 
 /*!
-Returns an autoreleased string that is a substring of the
-given string, keeping all leading whitespace but stopping
-before all trailing whitespace.
-
-This is useful when searching, for example, as there is no
-benefit to scanning beyond the text portion of a line.
-
-TEMPORARY:	Could move this to String Utilities module but
-			that file is pure C++ right now.
-
-(4.1)
-*/
-CFStringRef
-stringByStrippingEndWhitespace		(CFStringRef	inSourceString)
-{
-	CFStringRef		result = inSourceString;
-	
-	
-	if (nullptr != inSourceString)
-	{
-		CFIndex const		kStringLength = CFStringGetLength(inSourceString);
-		NSCharacterSet*		whitespaceSet = [NSCharacterSet whitespaceAndNewlineCharacterSet];
-		NSString*			asNSString = BRIDGE_CAST(inSourceString, NSString*);
-		NSInteger			i = 0;
-		
-		
-		for (i = (kStringLength - 1);
-				((i >= 0) && [whitespaceSet characterIsMember:[asNSString characterAtIndex:i]]); --i)
-		{
-			// empty loop
-		}
-		
-		result = BRIDGE_CAST([asNSString substringToIndex:(i + 1)], CFStringRef);
-	}
-	
-	return result;
-}// stringByStrippingEndWhitespace
-
-
-/*!
-Removes all tab stops.  See also tabStopInitialize(),
-which sets tabs to reasonable default values.
-
-(3.0)
-*/
-void
-tabStopClearAll		(My_ScreenBufferPtr		inDataPtr)
-{
-	for (auto& tabStopChar : inDataPtr->tabSettings)
-	{
-		tabStopChar = kMy_TabClear;
-	}
-}// tabStopClearAll
-
-
-/*!
-Returns the number of spaces until the next tab stop, based on
-the current cursor position of the specified screen.
+Returns true only if the given character should be
+tagged with "kTextAttributes_VTGraphics" when it was
+not already encoded as a graphics character, so that
+a more advanced rendering can be done (default font
+renderings for graphics are not always as nice).
 
-If "inForwardDirection" is true, the distance is returned
-relative to the next stop to the right of the cursor location;
-otherwise, the distance refers to the next stop to the left
-(that is, a backwards tab).
+This includes all characters in the Braille range.
 
-(2.6)
+(2021.06)
 */
-UInt16
-tabStopGetDistanceFromCursor	(My_ScreenBufferConstPtr	inDataPtr,
-								 Boolean					inForwardDirection)
+Boolean
+shouldRenderAsGraphics	(UnicodeScalarValue		inCharacter)
 {
-	UInt16		result = 0;
+	Boolean		result = false;
 	
 	
-	if (inForwardDirection)
+	if ((inCharacter >= 0x2800) && (inCharacter <= 0x28FF))
 	{
-		if (inDataPtr->current.cursorX < (inDataPtr->current.returnNumberOfColumnsPermitted() - 1))
-		{
-			result = inDataPtr->current.cursorX + 1;
-			while ((inDataPtr->tabSettings[result] != kMy_TabSet) &&
-					(result < (inDataPtr->current.returnNumberOfColumnsPermitted() - 1)))
-			{
-				++result;
-			}
-			result = (result - inDataPtr->current.cursorX);
-		}
+		// all characters in the Braille range
+		result = true;
 	}
 	else
 	{
-		if (inDataPtr->current.cursorX > 0)
+		switch (inCharacter)
 		{
-			result = inDataPtr->current.cursorX - 1;
-			while ((inDataPtr->tabSettings[result] != kMy_TabSet) && (result > 0))
-			{
-				--result;
-			}
-			result = (inDataPtr->current.cursorX - result);
-		}
-	}
-	return result;
-}// tabStopGetDistanceFromCursor
-
-
-/*!
-Reset tabs to default stops (one every "kMy_TabStop"
-columns starting at the first column, and one at the
-last column).
+		// this list should generally match the set of Unicode characters that
+		// are handled by the drawVTGraphicsGlyph() internal method in the
+		// Terminal View module
+		case '=': // equal to
+		case 0x2190: // leftwards arrow
+		case 0x2191: // upwards arrow
+		case 0x2192: // rightwards arrow
+		case 0x2193: // downwards arrow
+		case 0x21B5: // new line (international symbol is an arrow that hooks from mid-top to mid-left)
+		case 0x21DF: // form feed (international symbol is an arrow pointing top to bottom with two horizontal lines through it)
+		case 0x21E5: // horizontal tab (international symbol is a right-pointing arrow with a terminating line)
+		case 0x221A: // square root left edge
+		case 0x22EF: // middle ellipsis (three dots, centered)
+		case 0x23B2: // large sigma (summation), top half
+		case 0x23B3: // large sigma (summation), bottom half
+		case 0x23BA: // top line
+		case 0x23BB: // line between top and middle regions
+		case 0x23BC: // line between middle and bottom regions
+		case 0x23BD: // bottom line
+		case 0x2500: // middle line
+		case 0x2501: // middle line, bold version
+		case 0x2502: // vertical line
+		case 0x2503: // vertical line, bold version
+		case 0x2504: // horizontal triple-dashed line
+		case 0x2505: // horizontal triple-dashed line, bold version
+		case 0x2506: // vertical triple-dashed line
+		case 0x2507: // vertical triple-dashed line, bold version
+		case 0x2508: // horizontal quadruple-dashed line
+		case 0x2509: // horizontal quadruple-dashed line, bold version
+		case 0x250A: // vertical quadruple-dashed line
+		case 0x250B: // vertical quadruple-dashed line, bold version
+		case 0x250C: // hook mid-right to mid-bottom
+		case 0x250D: // hook mid-right to mid-bottom, bold right
+		case 0x250E: // hook mid-right to mid-bottom, bold bottom
+		case 0x250F: // hook mid-right to mid-bottom, bold version
+		case 0x2510: // hook mid-left to mid-bottom
+		case 0x2511: // hook mid-left to mid-bottom, bold left
+		case 0x2512: // hook mid-left to mid-bottom, bold bottom
+		case 0x2513: // hook mid-left to mid-bottom, bold version
+		case 0x2514: // hook mid-top to mid-right
+		case 0x2515: // hook mid-top to mid-right, bold right
+		case 0x2516: // hook mid-top to mid-right, bold top
+		case 0x2517: // hook mid-top to mid-right, bold version
+		case 0x2518: // hook mid-top to mid-left
+		case 0x2519: // hook mid-top to mid-left, bold left
+		case 0x251A: // hook mid-top to mid-left, bold top
+		case 0x251B: // hook mid-top to mid-left, bold version
+		case 0x251C: // cross minus the left piece
+		case 0x251D: // cross minus the left piece, bold right
+		case 0x251E: // cross minus the left piece, bold top
+		case 0x251F: // cross minus the left piece, bold bottom
+		case 0x2520: // cross minus the left piece, bold vertical
+		case 0x2521: // cross minus the left piece, bold hook mid-top to mid-right
+		case 0x2522: // cross minus the left piece, bold hook mid-bottom to mid-right
+		case 0x2523: // cross minus the left piece, bold version
+		case 0x2524: // cross minus the right piece
+		case 0x2525: // cross minus the right piece, bold left
+		case 0x2526: // cross minus the right piece, bold top
+		case 0x2527: // cross minus the right piece, bold bottom
+		case 0x2528: // cross minus the right piece, bold vertical
+		case 0x2529: // cross minus the right piece, bold hook mid-top to mid-left
+		case 0x252A: // cross minus the right piece, bold hook mid-bottom to mid-left
+		case 0x252B: // cross minus the right piece, bold version
+		case 0x252C: // cross minus the top piece
+		case 0x252D: // cross minus the top piece, bold left
+		case 0x252E: // cross minus the top piece, bold right
+		case 0x252F: // cross minus the top piece, bold horizontal
+		case 0x2530: // cross minus the top piece, bold bottom
+		case 0x2531: // cross minus the top piece, bold hook mid-bottom to mid-left
+		case 0x2532: // cross minus the top piece, bold hook mid-bottom to mid-right
+		case 0x2533: // cross minus the top piece, bold version
+		case 0x2534: // cross minus the bottom piece
+		case 0x2535: // cross minus the bottom piece, bold left
+		case 0x2536: // cross minus the bottom piece, bold right
+		case 0x2537: // cross minus the bottom piece, bold horizontal
+		case 0x2538: // cross minus the bottom piece, bold top
+		case 0x2539: // cross minus the bottom piece, bold hook mid-top to mid-left
+		case 0x253A: // cross minus the bottom piece, bold hook mid-top to mid-right
+		case 0x253B: // cross minus the bottom piece, bold version
+		case 0x253C: // cross
+		case 0x253D: // cross, bold left
+		case 0x253E: // cross, bold right
+		case 0x253F: // cross, bold horizontal
+		case 0x2540: // cross, bold top
+		case 0x2541: // cross, bold bottom
+		case 0x2542: // cross, bold vertical
+		case 0x2543: // cross, bold hook mid-top to mid-left
+		case 0x2544: // cross, bold hook mid-top to mid-right
+		case 0x2545: // cross, bold hook mid-bottom to mid-left
+		case 0x2546: // cross, bold hook mid-bottom to mid-right
+		case 0x2547: // cross, bold T-up
+		case 0x2548: // cross, bold T-down
+		case 0x2549: // cross, bold T-left
+		case 0x254A: // cross, bold T-right
+		case 0x254B: // cross, bold version
+		case 0x254C: // horizontal double-dashed line
+		case 0x254D: // horizontal double-dashed line, bold version
+		case 0x254E: // vertical double-dashed line
+		case 0x254F: // vertical double-dashed line, bold version
+		case 0x2550: // middle line, double-line version
+		case 0x2551: // vertical line, double-line version
+		case 0x2552: // hook mid-right to mid-bottom, double-horizontal-only version
+		case 0x2553: // hook mid-right to mid-bottom, double-vertical-only version
+		case 0x2554: // hook mid-right to mid-bottom, double-line version
+		case 0x2555: // hook mid-left to mid-bottom, double-horizontal-only version
+		case 0x2556: // hook mid-left to mid-bottom, double-vertical-only version
+		case 0x2557: // hook mid-left to mid-bottom, double-line version
+		case 0x2558: // hook mid-top to mid-right, double-horizontal-only version
+		case 0x2559: // hook mid-top to mid-right, double-vertical-only version
+		case 0x255A: // hook mid-top to mid-right, double-line version
+		case 0x255B: // hook mid-top to mid-left, double-horizontal-only version
+		case 0x255C: // hook mid-top to mid-left, double-vertical-only version
+		case 0x255D: // hook mid-top to mid-left, double-line version
+		case 0x255E: // cross minus the left piece, double-horizontal-only version
+		case 0x255F: // cross minus the left piece, double-vertical-only version
+		case 0x2560: // cross minus the left piece, double-line version
+		case 0x2561: // cross minus the right piece, double-horizontal-only version
+		case 0x2562: // cross minus the right piece, double-vertical-only version
+		case 0x2563: // cross minus the right piece, double-line version
+		case 0x2564: // cross minus the top piece, double-horizontal-only version
+		case 0x2565: // cross minus the top piece, double-vertical-only version
+		case 0x2566: // cross minus the top piece, double-line version
+		case 0x2567: // cross minus the bottom piece, double-horizontal-only version
+		case 0x2568: // cross minus the bottom piece, double-vertical-only version
+		case 0x2569: // cross minus the bottom piece, double-line version
+		case 0x256A: // cross, double-horizontal-only version
+		case 0x256B: // cross, double-vertical-only version
+		case 0x256C: // cross, double-line version
+		case 0x2320: // integral sign (elongated S), top
+		case 0x2321: // integral sign (elongated S), bottom
+		case 0x239B: // left parenthesis, upper
+		case 0x239C: // left parenthesis extension
+		case 0x239D: // left parenthesis, lower
+		case 0x239E: // right parenthesis, upper
+		case 0x239F: // right parenthesis extension
+		case 0x23A0: // right parenthesis, lower
+		case 0x23A1: // left square bracket, upper
+		case 0x23A2: // left square bracket extension
+		case 0x23A3: // left square bracket, lower
+		case 0x23A4: // right square bracket, upper
+		case 0x23A5: // right square bracket extension
+		case 0x23A6: // right square bracket, lower
+		case 0x23A7: // left curly brace, upper
+		case 0x23A8: // left curly brace, middle
+		case 0x23A9: // left curly brace, lower
+		case 0x23AA: // curly brace extension
+		case 0x23AB: // right curly brace, upper
+		case 0x23AC: // right curly brace, middle
+		case 0x23AD: // right curly brace, lower
+		case 0x23AE: // integral extension
+		case 0x23B7: // square root bottom, centered
+		case 0x23B8: // left vertical box line
+		case 0x23B9: // right vertical box line
+		case 0x23D0: // vertical line extension
+		case 0x256D: // curved mid-right to mid-bottom
+		case 0x256E: // curved mid-left to mid-bottom
+		case 0x256F: // curved mid-top to mid-left
+		case 0x2570: // curved mid-top to mid-right
+		case 0x2571: // diagonal line from top-right to bottom-left
+		case 0x2572: // diagonal line from top-left to bottom-right
+		case 0x2573: // diagonal lines from each corner crossing in the center
+		case 0x2574: // cross, left segment only
+		case 0x2575: // cross, top segment only
+		case 0x2576: // cross, right segment only
+		case 0x2577: // cross, bottom segment only
+		case 0x2578: // cross, left segment only, bold version
+		case 0x2579: // cross, top segment only, bold version
+		case 0x257A: // cross, right segment only, bold version
+		case 0x257B: // cross, bottom segment only, bold version
+		case 0x257C: // horizontal line, bold right half
+		case 0x257D: // vertical line, bold bottom half
+		case 0x257E: // horizontal line, bold left half
+		case 0x257F: // vertical line, bold top half
+		case 0x2580: // upper-half block
+		case 0x2581: // 1/8 bottom block
+		case 0x2582: // 2/8 (1/4) bottom block
+		case 0x2583: // 3/8 bottom block
+		case 0x2584: // lower-half block
+		case 0x2585: // 5/8 bottom block
+		case 0x2586: // 6/8 (3/4) bottom block
+		case 0x2587: // 7/8 bottom block
+		case 0x2588: // solid block
+		case 0x2589: // 7/8 left block
+		case 0x258A: // 6/8 (3/4) left block
+		case 0x258B: // 5/8 left block
+		case 0x258C: // left-half block
+		case 0x258D: // 3/8 left block
+		case 0x258E: // 2/8 (1/4) left block
+		case 0x258F: // 1/8 left block
+		case 0x2590: // right-half block
+		case 0x2591: // light gray pattern
+		case 0x2592: // medium gray pattern
+		case 0x2593: // heavy gray pattern or checkerboard
+		case 0x2594: // 1/8 top block
+		case 0x2595: // 1/8 right block
+		case 0x2596: // quadrant lower-left
+		case 0x2597: // quadrant lower-right
+		case 0x2598: // quadrant upper-left
+		case 0x2599: // block minus upper-right quadrant
+		case 0x259A: // quadrants upper-left and lower-right
+		case 0x259B: // block minus lower-right quadrant
+		case 0x259C: // block minus lower-left quadrant
+		case 0x259D: // quadrant upper-right
+		case 0x259E: // quadrants upper-right and lower-left
+		case 0x259F: // block minus upper-left quadrant
+		case 0x2699: // gear
+		case 0x26A1: // online/offline lightning bolt
+		case 0x2713: // check mark
+		case 0x2714: // check mark, bold
+		case 0x2718: // X mark
+		case 0x27A6: // curve-to-right arrow (used for detached-from-head in "powerline")
+		case 0x2913: // vertical tab (international symbol is a down-pointing arrow with a terminating line)
+		case 0xE0A0: // "powerline" version control branch
+		case 0xE0A1: // "powerline" line (LN) marker
+		case 0xE0A2: // "powerline" closed padlock
+		case 0xE0B0: // "powerline" rightward triangle
+		case 0xE0B1: // "powerline" rightward arrowhead
+		case 0xE0B2: // "powerline" leftward triangle
+		case 0xE0B3: // "powerline" leftward arrowhead
+		case 0xFFFD: // replacement character
+			result = true;
+			break;
+		
+		default:
+			break;
+		}
+	}
+	
+	return result;
+}// shouldRenderAsGraphics
+
+
+/*!
+Returns an autoreleased string that is a substring of the
+given string, keeping all leading whitespace but stopping
+before all trailing whitespace.
+
+This is useful when searching, for example, as there is no
+benefit to scanning beyond the text portion of a line.
+
+TEMPORARY:	Could move this to String Utilities module but
+			that file is pure C++ right now.
+
+(4.1)
+*/
+CFStringRef
+stringByStrippingEndWhitespace		(CFStringRef	inSourceString)
+{
+	CFStringRef		result = inSourceString;
+	
+	
+	if (nullptr != inSourceString)
+	{
+		CFIndex const		kStringLength = CFStringGetLength(inSourceString);
+		NSCharacterSet*		whitespaceSet = [NSCharacterSet whitespaceAndNewlineCharacterSet];
+		NSString*			asNSString = BRIDGE_CAST(inSourceString, NSString*);
+		NSInteger			i = 0;
+		
+		
+		for (i = (kStringLength - 1);
+				((i >= 0) && [whitespaceSet characterIsMember:[asNSString characterAtIndex:i]]); --i)
+		{
+			// empty loop
+		}
+		
+		result = BRIDGE_CAST([asNSString substringToIndex:(i + 1)], CFStringRef);
+	}
+	
+	return result;
+}// stringByStrippingEndWhitespace
+
+
+/*!
+Removes all tab stops.  See also tabStopInitialize(),
+which sets tabs to reasonable default values.
+
+(3.0)
+*/
+void
+tabStopClearAll		(My_ScreenBufferPtr		inDataPtr)
+{
+	for (auto& tabStopChar : inDataPtr->tabSettings)
+	{
+		tabStopChar = kMy_TabClear;
+	}
+}// tabStopClearAll
+
+
+/*!
+Returns the number of spaces until the next tab stop, based on
+the current cursor position of the specified screen.
+
+If "inForwardDirection" is true, the distance is returned
+relative to the next stop to the right of the cursor location;
+otherwise, the distance refers to the next stop to the left
+(that is, a backwards tab).
+
+(2.6)
+*/
+UInt16
+tabStopGetDistanceFromCursor	(My_ScreenBufferConstPtr	inDataPtr,
+								 Boolean					inForwardDirection)
+{
+	UInt16		result = 0;
+	
+	
+	if (inForwardDirection)
+	{
+		if (inDataPtr->current.cursorX < (inDataPtr->current.returnNumberOfColumnsPermitted() - 1))
+		{
+			result = inDataPtr->current.cursorX + 1;
+			while ((inDataPtr->tabSettings[result] != kMy_TabSet) &&
+					(result < (inDataPtr->current.returnNumberOfColumnsPermitted() - 1)))
+			{
+				++result;
+			}
+			result = (result - inDataPtr->current.cursorX);
+		}
+	}
+	else
+	{
+		if (inDataPtr->current.cursorX > 0)
+		{
+			result = inDataPtr->current.cursorX - 1;
+			while ((inDataPtr->tabSettings[result] != kMy_TabSet) && (result > 0))
+			{
+				--result;
+			}
+			result = (inDataPtr->current.cursorX - result);
+		}
+	}
+	return result;
+}// tabStopGetDistanceFromCursor
+
+
+/*!
+Reset tabs to default stops (one every "kMy_TabStop"
+columns starting at the first column, and one at the
+last column).
 
 (3.0)
 */
@@ -18662,6 +21019,8 @@ new attributes are returned.  The new attributes
 should ONLY apply to the given character; they do
 not indicate a new default for the character stream.
 
+See translateCharacterForSet().
+
 (4.0)
 */
 inline UniChar
@@ -18669,12 +21028,108 @@ translateCharacter	(My_ScreenBufferPtr			inDataPtr,
 					 UnicodeScalarValue			inCharacter,
 					 TextAttributes_Object		inAttributes,
 					 TextAttributes_Object&		outNewAttributes)
+{
+	return translateCharacterForSet(*(inDataPtr->current.characterSetInfoPtr), (false == inDataPtr->modeANSIEnabled),
+									inCharacter, inAttributes, outNewAttributes);
+}// translateCharacter
+
+
+/*!
+Implements translateCharacter() for the given character
+set, which is typically the one that is currently active
+in a screen buffer.  Set "inVT52" if the terminal is not
+in ANSI mode (VT52 graphics glyphs differ).
+
+Character codes below "kMy_CharacterRemapTableSize" are
+translated with a single lookup into a remap table that
+the character set selected when it was defined (see
+My_CharacterSetInfo::setTranslationTable()); the tables
+are computed at compile time.  Larger codes are never
+changed by a character set so they are only checked for
+substitutions and glyphs that should be tagged graphical.
+
+(2021.06)
+*/
+inline UniChar
+translateCharacterForSet	(My_CharacterSetInfo const&		inCharacterSet,
+							 Boolean						inVT52,
+							 UnicodeScalarValue				inCharacter,
+							 TextAttributes_Object			inAttributes,
+							 TextAttributes_Object&			outNewAttributes)
+{
+	UniChar		result = STATIC_CAST(inCharacter, UniChar);
+	
+	
+	outNewAttributes = inAttributes; // initially...
+	if (inCharacter < kMy_CharacterRemapTableSize)
+	{
+		My_GraphicsRemap	remapVariant = kMy_GraphicsRemapNone;
+		
+		
+		if (inAttributes.hasAttributes(kTextAttributes_VTGraphics))
+		{
+			// if text was originally encoded with graphics attributes, internally
+			// store the equivalent Unicode character so that cool stuff like
+			// copy and paste of text will do the right thing (the renderer may
+			// still choose not to rely on Unicode fonts for rendering them)
+			remapVariant = My_CharacterRemapTableSet::returnGraphicsRemap(inVT52, inAttributes.hasBold());
+		}
+		
+		result = inCharacterSet.remapTablesPtr->tables[remapVariant].codes[inCharacter];
+		
+		// the only code in this range that shouldRenderAsGraphics()
+		// accepts is the equal sign; a full check is not necessary
+		if ((kMy_GraphicsRemapNone == remapVariant) && ('=' == inCharacter))
+		{
+			outNewAttributes.addAttributes(kTextAttributes_VTGraphics);
+		}
+	}
+	else
+	{
+		// TEMPORARY - the renderer does not handle most Unicode characters,
+		// but programs sometimes choose “unnecessarily exotic” variations
+		// of characters that would lead to unknown-character renderings when
+		// it is pretty easy to choose sensible ASCII equivalents...
+		if ((0x2212/* minus sign */ == inCharacter) || (0x2010/* hyphen */ == inCharacter))
+		{
+			result = '-';
+		}
+		
+		// the original character was not explicitly identified as graphical,
+		// but it may still be best to *tag* it as such so that a more
+		// advanced rendering can be done (default font renderings for
+		// graphics are not always as nice)
+		if ((false == inAttributes.hasAttributes(kTextAttributes_VTGraphics)) && shouldRenderAsGraphics(inCharacter))
+		{
+			outNewAttributes.addAttributes(kTextAttributes_VTGraphics);
+		}
+	}
+	
+	return result;
+}// translateCharacterForSet
+
+
+/*!
+The original implementation of translateCharacter(),
+using switch statements instead of remap tables.  This
+is kept ONLY so that unitTest_TranslateCharacter_000()
+can confirm that the tables produce identical results;
+it is not used by the emulator.
+
+(2021.06)
+*/
+UniChar
+translateCharacterReference		(My_CharacterSet			inCharacterSet,
+								 Boolean					inVT52,
+								 UnicodeScalarValue			inCharacter,
+								 TextAttributes_Object		inAttributes,
+								 TextAttributes_Object&		outNewAttributes)
 {
 	UniChar		result = inCharacter;
 	
 	
 	outNewAttributes = inAttributes; // initially...
-	switch (inDataPtr->current.characterSetInfoPtr->translationTable)
+	switch (inCharacterSet)
 	{
 	case kMy_CharacterSetVT100UnitedStates:
 		// this is the default; do nothing
@@ -18709,7 +21164,7 @@ translateCharacter	(My_ScreenBufferPtr			inDataPtr,
 	if (inAttributes.hasAttributes(kTextAttributes_VTGraphics))
 	{
 		Boolean const	kIsBold = inAttributes.hasBold();
-		Boolean const	kVT52 = (false == inDataPtr->modeANSIEnabled);
+		Boolean const	kVT52 = inVT52;
 		
 		
 		// if text was originally encoded with graphics attributes, internally
@@ -18954,249 +21409,635 @@ translateCharacter	(My_ScreenBufferPtr			inDataPtr,
 			break;
 		}
 	}
-	else if ((inCharacter >= 0x2800) && (inCharacter <= 0x28FF))
+	else
+	{
+		// the original character was not explicitly identified as graphical,
+		// but it may still be best to *tag* it as such so that a more
+		// advanced rendering can be done (default font renderings for
+		// graphics are not always as nice)
+		if (shouldRenderAsGraphics(inCharacter))
+		{
+			outNewAttributes.addAttributes(kTextAttributes_VTGraphics);
+		}
+	}
+	
+	return result;
+}// translateCharacterReference
+
+
+/*!
+Tests inline 24-bit colors: lines must not allocate colors
+until a cell needs them, colors must move with attributes
+when cells are inserted or deleted, and any other color
+assignment must clear the inline bits.
+
+Returns "true" if ALL assertions pass; "false" is
+returned if any fail, however messages should be
+printed for ALL assertion failures regardless.
+
+(2021.06)
+*/
+Boolean
+unitTest_InlineColors_000 ()
+{
+	My_ScreenBufferLine				testLine;
+	TextAttributes_Object			inlineAttributes;
+	TextAttributes_InlineColors		testColors;
+	UInt8							red = 0;
+	UInt8							green = 0;
+	UInt8							blue = 0;
+	Boolean							result = true;
+	
+	
+	testColors.setForeground(0x12, 0x34, 0x56);
+	testColors.setBackground(0xAB, 0xCD, 0xEF);
+	testColors.returnBackground(red, green, blue);
+	Console_TestAssertUpdate(result, (0xAB == red) && (0xCD == green) && (0xEF == blue),
+								Console_WriteValue, "background components were not stored, value", testColors.backgroundRGB);
+	
+	inlineAttributes.colorInlineForegroundSet();
+	inlineAttributes.colorInlineBackgroundSet();
+	Console_TestAssertUpdate(result, inlineAttributes.hasAttributes(kTextAttributes_EnableForeground) &&
+										inlineAttributes.hasAttributes(kTextAttributes_EnableBackground),
+								Console_WriteLine, "inline colors should enable foreground and background");
+	
+	// plain lines stay compact
+	Console_TestAssertUpdate(result, testLine.returnInlineColorVector().empty(),
+								Console_WriteValue, "new line should have no inline colors; size", testLine.returnInlineColorVector().size());
+	
+	testLine.returnMutableAttributeVector()[5] = inlineAttributes;
+	testLine.returnMutableInlineColorVector()[5] = testColors;
+	Console_TestAssertUpdate(result, testLine.returnAttributeVector().size() == testLine.returnInlineColorVector().size(),
+								Console_WriteValue, "inline colors should match attribute count; size", testLine.returnInlineColorVector().size());
+	
+	// colors must follow their attributes
+	testLine.insertBlanks(StringUtilities_Cell(2), StringUtilities_Cell(3), TextAttributes_Object(), StringUtilities_Cell(80));
+	Console_TestAssertUpdate(result, testLine.returnAttributeVector()[8].hasInlineColor() &&
+										(testColors == testLine.returnInlineColorVector()[8]),
+								Console_WriteLine, "inline colors should shift right with inserted blanks");
+	testLine.deleteRange(StringUtilities_Cell(0), StringUtilities_Cell(4), TextAttributes_Object(), StringUtilities_Cell(80));
+	Console_TestAssertUpdate(result, testLine.returnAttributeVector()[4].hasInlineColor() &&
+										(testColors == testLine.returnInlineColorVector()[4]),
+								Console_WriteLine, "inline colors should shift left with deleted cells");
+	
+	// other kinds of color replace inline colors
+	inlineAttributes.colorIndexForegroundSet(3);
+	Console_TestAssertUpdate(result, (false == inlineAttributes.hasAttributes(kTextAttributes_ColorIsInlineForeground)) &&
+										inlineAttributes.hasAttributes(kTextAttributes_ColorIsInlineBackground),
+								Console_WriteLine, "setting a foreground index should only clear the inline foreground");
+	inlineAttributes.removeStyleAndColorRelatedAttributes();
+	Console_TestAssertUpdate(result, false == inlineAttributes.hasInlineColor(),
+								Console_WriteLine, "removing colors should clear inline colors");
+	
+	return result;
+}// unitTest_InlineColors_000
+
+
+/*!
+Tests the parts of saved terminal state that do not need a
+terminal: sections must be aligned and must be rejected if
+they do not fit in the data, and true-color tables must be
+recreated with the same IDs and usage order (or rejected if
+the saved colors are inconsistent), and XTerm palette changes
+must be read back (or rejected if they are out of range).
+
+Returns "true" if ALL assertions pass; "false" is
+returned if any fail, however messages should be
+printed for ALL assertion failures regardless.
+
+(2021.06)
+*/
+Boolean
+unitTest_SerializeState_000 ()
+{
+	std::vector< UInt8 >	buffer(3, 0); // state does not have to start at the beginning of the buffer
+	size_t const			kStateOffset = buffer.size();
+	My_StateHeader			header;
+	My_StateSectionRange	sections[kMy_StateSectionCount];
+	UInt8 const				kSectionBytes[] = { 1, 2, 3, 4, 5 };
+	Boolean					result = true;
+	
+	
+	bzero(&header, sizeof(header));
+	bzero(sections, sizeof(sections));
+	header.sectionCount = kMy_StateSectionCount;
+	buffer.resize(kStateOffset + sizeof(header) + sizeof(sections), 0);
+	appendStateSection(buffer, kStateOffset, sections[kMy_StateSectionModes], kSectionBytes, sizeof(kSectionBytes));
+	appendStateSection(buffer, kStateOffset, sections[kMy_StateSectionTabStops], kSectionBytes, sizeof(kSectionBytes));
+	Console_TestAssertUpdate(result, (0 == (sections[kMy_StateSectionTabStops].offset % kMy_StateAlignment)) &&
+										(sections[kMy_StateSectionTabStops].offset >=
+											(sections[kMy_StateSectionModes].offset + sizeof(kSectionBytes))),
+								Console_WriteValue, "section was not aligned, offset", sections[kMy_StateSectionTabStops].offset);
+	std::memcpy(buffer.data() + kStateOffset, &header, sizeof(header));
+	std::memcpy(buffer.data() + kStateOffset + sizeof(header), sections, sizeof(sections));
+	
+	// sections are found in aligned (copied) data, and must fit
+	{
+		std::vector< UInt64 >	alignedState((buffer.size() - kStateOffset + sizeof(UInt64) - 1) / sizeof(UInt64));
+		UInt8* const			stateBytes = REINTERPRET_CAST(alignedState.data(), UInt8*);
+		size_t const			kStateSize = (buffer.size() - kStateOffset);
+		UInt8 const*			sectionPtr = nullptr;
+		size_t					sectionSize = 0;
+		
+		
+		std::memcpy(stateBytes, buffer.data() + kStateOffset, kStateSize);
+		Console_TestAssertUpdate(result, findStateSection(stateBytes, kStateSize, kMy_StateSectionTabStops, sectionPtr, sectionSize) &&
+											(sizeof(kSectionBytes) == sectionSize) && (5 == sectionPtr[4]),
+									Console_WriteValue, "section was not found, size", sectionSize);
+		Console_TestAssertUpdate(result, findStateSection(stateBytes, kStateSize, kMy_StateSectionLines, sectionPtr, sectionSize) &&
+											(0 == sectionSize),
+									Console_WriteValue, "section that was not written should be empty, size", sectionSize);
+		Console_TestAssertUpdate(result, false == findStateSection(stateBytes, kStateSize - 1, kMy_StateSectionTabStops,
+																	sectionPtr, sectionSize),
+									Console_WriteLine, "truncated section was not rejected");
+		Console_TestAssertUpdate(result, kTerminal_ResultInvalidID == Terminal_DeserializeState(nullptr, stateBytes, kStateSize),
+									Console_WriteLine, "invalid terminal was not rejected");
+	}
+	
+	// true colors are restored with the same IDs and usage order
+	{
+		My_TrueColorTable		originalTable;
+		My_TrueColorTable		restoredTable;
+		std::vector< UInt32 >	rgbKeysByID;
+		std::vector< UInt32 >	idsByAge;
+		std::vector< UInt32 >	restoredRGBKeysByID;
+		std::vector< UInt32 >	restoredIDsByAge;
+		
+		
+		for (UInt8 i = 0; i < 100; ++i)
+		{
+			UNUSED_RETURN(TextAttributes_TrueColorID)originalTable.returnColorID(i, 0x80, 0xFF - i);
+		}
+		UNUSED_RETURN(TextAttributes_TrueColorID)originalTable.returnColorID(5, 0x80, 0xFF - 5); // make an old color the newest
+		originalTable.copyColors(rgbKeysByID, idsByAge);
+		Console_TestAssertUpdate(result, restoredTable.setColors(rgbKeysByID.data(), idsByAge.data(), rgbKeysByID.size()),
+									Console_WriteLine, "saved colors were not accepted");
+		restoredTable.copyColors(restoredRGBKeysByID, restoredIDsByAge);
+		Console_TestAssertUpdate(result, (rgbKeysByID == restoredRGBKeysByID) && (idsByAge == restoredIDsByAge) &&
+											(5 == restoredIDsByAge.back()),
+									Console_WriteValue, "restored colors differ; count", restoredRGBKeysByID.size());
+		Console_TestAssertUpdate(result, originalTable.returnColorID(50, 0x80, 0xFF - 50) == restoredTable.returnColorID(50, 0x80, 0xFF - 50),
+									Console_WriteLine, "restored color has a different ID");
+		
+		// inconsistent colors must be rejected without changing the table
+		idsByAge[1] = idsByAge[0];
+		Console_TestAssertUpdate(result, false == restoredTable.setColors(rgbKeysByID.data(), idsByAge.data(), rgbKeysByID.size()),
+									Console_WriteLine, "repeated ID in usage order was not rejected");
+		rgbKeysByID[1] = rgbKeysByID[0];
+		Console_TestAssertUpdate(result, false == restoredTable.setColors(rgbKeysByID.data(), restoredIDsByAge.data(), rgbKeysByID.size()),
+									Console_WriteLine, "repeated color was not rejected");
+		Console_TestAssertUpdate(result, 100 == restoredTable.returnColorCount(),
+									Console_WriteValue, "rejected colors changed the table; count", restoredTable.returnColorCount());
+	}
+	
+	// XTerm palette changes are read back, and only for indices 16-255
+	{
+		std::vector< UInt32 >	paletteValues = { 2, 16, 0x00FF8000, 255, 0x000080FF };
+		My_XTermColorByIndex	restoredColors;
+		
+		
+		Console_TestAssertUpdate(result, readStateXTermColors(REINTERPRET_CAST(paletteValues.data(), UInt8 const*),
+																paletteValues.size() * sizeof(UInt32), restoredColors),
+									Console_WriteLine, "saved palette was not accepted");
+		Console_TestAssertUpdate(result, (2 == restoredColors.size()) && (0x00FF8000 == restoredColors[16]) &&
+											(0x000080FF == restoredColors[255]),
+									Console_WriteValue, "restored palette differs; count", restoredColors.size());
+		Console_TestAssertUpdate(result, false == readStateXTermColors(REINTERPRET_CAST(paletteValues.data(), UInt8 const*),
+																		(paletteValues.size() - 1) * sizeof(UInt32), restoredColors),
+									Console_WriteLine, "truncated palette was not rejected");
+		paletteValues[3] = 15;
+		Console_TestAssertUpdate(result, (false == readStateXTermColors(REINTERPRET_CAST(paletteValues.data(), UInt8 const*),
+																			paletteValues.size() * sizeof(UInt32), restoredColors)) &&
+											restoredColors.empty(),
+									Console_WriteLine, "change to a base ANSI color was not rejected");
+	}
+	
+	return result;
+}// unitTest_SerializeState_000
+
+
+/*!
+Tests saving the state of a real terminal and restoring it
+into another terminal of a different size: the size, every
+line of the screen and scrollback (text, attributes and
+colors), the cursor and modes must all be the same, and
+saving the restored terminal must give exactly the same
+state.
+
+Returns "true" if ALL assertions pass; "false" is
+returned if any fail, however messages should be
+printed for ALL assertion failures regardless.
+
+(2021.06)
+*/
+Boolean
+unitTest_SerializeState_001 ()
+{
+	UInt16 const		kColumnCount = 80;
+	UInt16 const		kRowCount = 24;
+	TerminalScreenRef	originalScreen = newTestScreen(kColumnCount, kRowCount, 1000/* scrollback rows */);
+	TerminalScreenRef	restoredScreen = newTestScreen(40, 10, 1000/* scrollback rows */);
+	Boolean				result = true;
+	
+	
+	Console_TestAssertUpdate(result, (nullptr != originalScreen) && (nullptr != restoredScreen),
+								Console_WriteLine, "failed to create test screens");
+	if (result)
+	{
+		My_ScreenBufferPtr		originalPtr = getVirtualScreenData(originalScreen);
+		My_ScreenBufferPtr		restoredPtr = getVirtualScreenData(restoredScreen);
+		std::vector< UInt8 >	savedState;
+		std::vector< UInt8 >	resavedState;
+		std::vector< UInt64 >	alignedState;
+		UInt16					originalColumn = 0;
+		UInt16					originalRow = 0;
+		UInt16					restoredColumn = 0;
+		UInt16					restoredRow = 0;
+		UInt32					mismatchCount = 0;
+		
+		
+		// styled text that scrolls (so that there is scrollback), and
+		// then a saved cursor, modes and a cursor away from the origin
+		for (UInt16 i = 0; i < 40; ++i)
+		{
+			std::string const	kLine = ("\033[1;31mbold red " + std::to_string(i) + "\033[0m \033[4;42munderlined\033[0m \033[38;2;10;20;" +
+											std::to_string(i) + "mtrue color\033[0m " + std::string(i, 'x') + "\r\n");
+			
+			
+			UNUSED_RETURN(Terminal_Result)Terminal_EmulatorProcessCString(originalScreen, kLine.c_str());
+		}
+		UNUSED_RETURN(Terminal_Result)Terminal_EmulatorProcessCString(originalScreen, "\033[3;3H\0337\033[7mreverse\033[5;10H"
+																						"\033[4h\033[?7l\033[?2004h");
+		Console_TestAssertUpdate(result, originalPtr->scrollbackBufferCachedSize > 0,
+									Console_WriteLine, "test text did not create scrollback");
+		
+		Console_TestAssertUpdate(result, kTerminal_ResultOK == Terminal_SerializeState(originalScreen, savedState),
+									Console_WriteLine, "failed to save state");
+		alignedState.resize((savedState.size() + sizeof(UInt64) - 1) / sizeof(UInt64));
+		std::memcpy(alignedState.data(), savedState.data(), savedState.size());
+		Console_TestAssertUpdate(result, kTerminal_ResultOK == Terminal_DeserializeState(restoredScreen, alignedState.data(), savedState.size()),
+									Console_WriteLine, "failed to restore state");
+		
+		// size and lines
+		Console_TestAssertUpdate(result, (kColumnCount == Terminal_ReturnColumnCount(restoredScreen)) &&
+											(kRowCount == Terminal_ReturnRowCount(restoredScreen)),
+									Console_WriteValuePair, "restored size", Terminal_ReturnColumnCount(restoredScreen),
+									Terminal_ReturnRowCount(restoredScreen));
+		Console_TestAssertUpdate(result, originalPtr->scrollbackBufferCachedSize == restoredPtr->scrollbackBufferCachedSize,
+									Console_WriteValue, "restored scrollback size", restoredPtr->scrollbackBufferCachedSize);
+		mismatchCount = returnLineMismatchCount(originalPtr->scrollbackBuffer, restoredPtr->scrollbackBuffer, kColumnCount);
+		Console_TestAssertUpdate(result, 0 == mismatchCount, Console_WriteValue, "restored scrollback lines that differ", mismatchCount);
+		mismatchCount = returnLineMismatchCount(originalPtr->screenBuffer, restoredPtr->screenBuffer, kColumnCount);
+		Console_TestAssertUpdate(result, 0 == mismatchCount, Console_WriteValue, "restored screen lines that differ", mismatchCount);
+		
+		// cursor and modes
+		UNUSED_RETURN(Terminal_Result)Terminal_CursorGetLocation(originalScreen, &originalColumn, &originalRow);
+		UNUSED_RETURN(Terminal_Result)Terminal_CursorGetLocation(restoredScreen, &restoredColumn, &restoredRow);
+		Console_TestAssertUpdate(result, (9 == originalColumn) && (4 == originalRow) &&
+											(originalColumn == restoredColumn) && (originalRow == restoredRow),
+									Console_WriteValuePair, "restored cursor location", restoredColumn, restoredRow);
+		Console_TestAssertUpdate(result, (originalPtr->previous.cursorX == restoredPtr->previous.cursorX) &&
+											(originalPtr->previous.cursorY == restoredPtr->previous.cursorY),
+									Console_WriteValuePair, "restored saved cursor location", restoredPtr->previous.cursorX,
+									STATIC_CAST(restoredPtr->previous.cursorY, SInt32));
+		Console_TestAssertUpdate(result, Terminal_CursorReturnAttributes(originalScreen) == Terminal_CursorReturnAttributes(restoredScreen),
+									Console_WriteLine, "restored cursor attributes differ");
+		Console_TestAssertUpdate(result, restoredPtr->modeInsertNotReplace && (false == restoredPtr->modeAutoWrap) &&
+											restoredPtr->modeBracketedPaste,
+									Console_WriteLine, "restored modes differ");
+		
+		// nothing was lost or added
+		Console_TestAssertUpdate(result, kTerminal_ResultOK == Terminal_SerializeState(restoredScreen, resavedState),
+									Console_WriteLine, "failed to save restored state");
+		Console_TestAssertUpdate(result, savedState == resavedState,
+									Console_WriteValuePair, "saved and re-saved state sizes", savedState.size(), resavedState.size());
+	}
+	
+	if (nullptr != originalScreen)
+	{
+		Terminal_ReleaseScreen(&originalScreen);
+	}
+	if (nullptr != restoredScreen)
+	{
+		Terminal_ReleaseScreen(&restoredScreen);
+	}
+	
+	return result;
+}// unitTest_SerializeState_001
+
+
+/*!
+A benchmark for Terminal_DeserializeState(), restoring a
+large scrollback of styled lines (as when a session server
+reattaches a busy session).  Every call validates the state,
+decodes every line directly into the terminal and replaces
+the screen, so this measures the full cost of a restore
+rather than just line decoding.
+
+The time required is printed.
+
+Returns "true" if ALL assertions pass; "false" is
+returned if any fail, however messages should be
+printed for ALL assertion failures regardless.
+
+(2021.06)
+*/
+Boolean
+unitTest_SerializeState_002 ()
+{
+	UInt32 const		kLineCount = 50000;
+	UInt16 const		kRestoreCount = 10;
+	TerminalScreenRef	originalScreen = newTestScreen(80, 24, kLineCount/* scrollback rows */);
+	TerminalScreenRef	restoredScreen = newTestScreen(80, 24, kLineCount/* scrollback rows */);
+	Boolean				result = true;
+	
+	
+	Console_TestAssertUpdate(result, (nullptr != originalScreen) && (nullptr != restoredScreen),
+								Console_WriteLine, "failed to create test screens");
+	if (result)
+	{
+		std::string				output;
+		std::vector< UInt8 >	savedState;
+		std::vector< UInt64 >	alignedState;
+		UInt16					failureCount = 0;
+		CFAbsoluteTime			startTime = 0;
+		CFAbsoluteTime			elapsedTime = 0;
+		
+		
+		for (UInt32 i = 0; i < kLineCount; ++i)
+		{
+			output += ("\033[1mline " + std::to_string(i) + "\033[0m " + std::string(40, '-') + " \033[32;44mstatus\033[0m\r\n");
+		}
+		UNUSED_RETURN(Terminal_Result)Terminal_EmulatorProcessData(originalScreen, REINTERPRET_CAST(output.data(), UInt8 const*), output.size());
+		UNUSED_RETURN(Terminal_Result)Terminal_SerializeState(originalScreen, savedState);
+		alignedState.resize((savedState.size() + sizeof(UInt64) - 1) / sizeof(UInt64));
+		std::memcpy(alignedState.data(), savedState.data(), savedState.size());
+		
+		startTime = CFAbsoluteTimeGetCurrent();
+		for (UInt16 i = 0; i < kRestoreCount; ++i)
+		{
+			unless (kTerminal_ResultOK == Terminal_DeserializeState(restoredScreen, alignedState.data(), savedState.size()))
+			{
+				++failureCount;
+			}
+		}
+		elapsedTime = (CFAbsoluteTimeGetCurrent() - startTime);
+		
+		Console_WriteValueFloat4("terminal state restore benchmark: lines, state bytes, seconds per restore, (unused)",
+									STATIC_CAST(getVirtualScreenData(restoredScreen)->scrollbackBufferCachedSize, Float32),
+									STATIC_CAST(savedState.size(), Float32), STATIC_CAST(elapsedTime / kRestoreCount, Float32), 0);
+		
+		Console_TestAssertUpdate(result, 0 == failureCount, Console_WriteValue, "failed restores", failureCount);
+		Console_TestAssertUpdate(result, getVirtualScreenData(originalScreen)->scrollbackBufferCachedSize ==
+											getVirtualScreenData(restoredScreen)->scrollbackBufferCachedSize,
+									Console_WriteValue, "restored scrollback size", getVirtualScreenData(restoredScreen)->scrollbackBufferCachedSize);
+	}
+	
+	if (nullptr != originalScreen)
+	{
+		Terminal_ReleaseScreen(&originalScreen);
+	}
+	if (nullptr != restoredScreen)
+	{
+		Terminal_ReleaseScreen(&restoredScreen);
+	}
+	
+	return result;
+}// unitTest_SerializeState_002
+
+
+/*!
+Tests translateCharacterForSet() by comparing its output
+with the original switch-based implementation (now
+translateCharacterReference()) for every character code
+and every combination of character set, emulator mode
+and relevant text attributes.
+
+Returns "true" if ALL assertions pass; "false" is
+returned if any fail, however messages should be
+printed for ALL assertion failures regardless.
+
+(2021.06)
+*/
+Boolean
+unitTest_TranslateCharacter_000 ()
+{
+	My_CharacterSet const	kCharacterSets[] = { kMy_CharacterSetVT100UnitedKingdom, kMy_CharacterSetVT100UnitedStates };
+	Boolean const			kVT52Modes[] = { false, true };
+	TextAttributes_Object	boldGraphicsAttributes = kTextAttributes_VTGraphics;
+	Boolean					result = true;
+	
+	
+	boldGraphicsAttributes.addAttributes(kTextAttributes_StyleBold);
+	
+	TextAttributes_Object const		kAttributeCombinations[] =
+									{
+										TextAttributes_Object(),
+										kTextAttributes_StyleBold,
+										kTextAttributes_VTGraphics,
+										boldGraphicsAttributes
+									};
+	
+	for (auto aCharacterSet : kCharacterSets)
+	{
+		My_CharacterSetInfo		characterSetInfo(kMy_CharacterSetVT100UnitedStates, kMy_CharacterROMNormal, kMy_GraphicsModeOff);
+		
+		
+		// tables must be selected when the character set changes
+		characterSetInfo.setTranslationTable(aCharacterSet);
+		
+		for (Boolean isVT52 : kVT52Modes)
+		{
+			for (auto const& kAttributes : kAttributeCombinations)
+			{
+				UInt32		mismatchCount = 0;
+				
+				
+				for (UnicodeScalarValue i = 0; i <= 0x10FFFF; ++i)
+				{
+					TextAttributes_Object	expectedAttributes;
+					TextAttributes_Object	actualAttributes;
+					UniChar const			kExpected = translateCharacterReference(aCharacterSet, isVT52, i, kAttributes, expectedAttributes);
+					UniChar const			kActual = translateCharacterForSet(characterSetInfo, isVT52, i, kAttributes, actualAttributes);
+					
+					
+					if ((kExpected != kActual) || (expectedAttributes != actualAttributes))
+					{
+						// only report the first few problems for each combination
+						if (mismatchCount < 5)
+						{
+							Console_Warning(Console_WriteValue, "translated character does not match reference, input", i);
+							Console_Warning(Console_WriteValue, "expected", kExpected);
+							Console_Warning(Console_WriteValue, "actual", kActual);
+						}
+						++mismatchCount;
+					}
+				}
+				Console_TestAssertUpdate(result, 0 == mismatchCount,
+											Console_WriteValue, "character translation tables: number of mismatches", mismatchCount);
+			}
+		}
+	}
+	
+	return result;
+}// unitTest_TranslateCharacter_000
+
+
+/*!
+Tests My_TrueColorTable by defining more colors than there
+are IDs and checking that the hash index and reverse index
+always agree.
+
+Returns "true" if ALL assertions pass; "false" is
+returned if any fail, however messages should be
+printed for ALL assertion failures regardless.
+
+(2021.06)
+*/
+Boolean
+unitTest_TrueColorTable_000 ()
+{
+	UInt32 const		kColorCount = (3 * (kTextAttributes_TrueColorIDMaximum + 1)) / 2;
+	My_TrueColorTable	table;
+	UInt32				mismatchCount = 0;
+	UInt8				red = 0;
+	UInt8				green = 0;
+	UInt8				blue = 0;
+	Boolean				result = true;
+	
+	
+	// repeated requests must not consume more IDs
+	{
+		TextAttributes_TrueColorID const	kFirstID = table.returnColorID(10, 20, 30);
+		TextAttributes_TrueColorID const	kSecondID = table.returnColorID(30, 20, 10);
+		
+		
+		Console_TestAssertUpdate(result, kFirstID != kSecondID,
+									Console_WriteValue, "different colors should have different IDs; ID", kFirstID);
+		Console_TestAssertUpdate(result, kFirstID == table.returnColorID(10, 20, 30),
+									Console_WriteValue, "same color should have same ID; ID", kFirstID);
+		Console_TestAssertUpdate(result, 2 == table.returnColorCount(),
+									Console_WriteValue, "color count", table.returnColorCount());
+		Console_TestAssertUpdate(result, table.getColor(kSecondID, red, green, blue) && (30 == red) && (20 == green) && (10 == blue),
+									Console_WriteValue, "components were not stored for ID", kSecondID);
+		Console_TestAssertUpdate(result, false == table.getColor(2, red, green, blue),
+									Console_WriteValue, "undefined ID should not be found; ID", 2);
+	}
+	
+	// overflow the table so that IDs are reused
+	for (UInt32 i = 0; i < kColorCount; ++i)
+	{
+		UNUSED_RETURN(TextAttributes_TrueColorID)table.returnColorID(STATIC_CAST(i >> 16, UInt8), STATIC_CAST(i >> 8, UInt8),
+																		STATIC_CAST(i, UInt8));
+	}
+	Console_TestAssertUpdate(result, (kTextAttributes_TrueColorIDMaximum + 1) == table.returnColorCount(),
+								Console_WriteValue, "color count after overflow", table.returnColorCount());
+	
+	// every ID must map back to itself through the hash index
+	for (UInt32 i = 0; i <= kTextAttributes_TrueColorIDMaximum; ++i)
+	{
+		TextAttributes_TrueColorID const	kID = STATIC_CAST(i, TextAttributes_TrueColorID);
+		
+		
+		if ((false == table.getColor(kID, red, green, blue)) || (kID != table.returnColorID(red, green, blue)))
+		{
+			++mismatchCount;
+		}
+	}
+	Console_TestAssertUpdate(result, 0 == mismatchCount,
+								Console_WriteValue, "true-color index: number of mismatched IDs", mismatchCount);
+	Console_TestAssertUpdate(result, (kTextAttributes_TrueColorIDMaximum + 1) == table.returnColorCount(),
+								Console_WriteValue, "color count after lookups", table.returnColorCount());
+	
+	return result;
+}// unitTest_TrueColorTable_000
+
+
+/*!
+A benchmark for My_TrueColorTable that resembles a stream
+of 24-bit gradients (as generated by tools that convert
+images to text, for instance): every cell of every frame
+has a different color.  Each frame is “drawn” by looking
+up all of its colors, as a terminal view would.  A status
+line with colors defined at the start is drawn in every
+frame and must never lose its colors, even though many
+more colors than there are IDs pass through the table.
+
+The time required is printed.
+
+Returns "true" if ALL assertions pass; "false" is
+returned if any fail, however messages should be
+printed for ALL assertion failures regardless.
+
+(2021.06)
+*/
+Boolean
+unitTest_TrueColorTable_001 ()
+{
+	UInt16 const						kColumnCount = 160;
+	UInt16 const						kRowCount = 50;
+	UInt16 const						kFrameCount = 200;
+	My_TrueColorTable					table;
+	std::vector< UInt32 >				statusLineRGB(kColumnCount);
+	std::vector< TextAttributes_TrueColorID >	statusLineIDs(kColumnCount);
+	std::vector< TextAttributes_TrueColorID >	frameIDs(kColumnCount * kRowCount);
+	UInt32								mismatchCount = 0;
+	UInt8								red = 0;
+	UInt8								green = 0;
+	UInt8								blue = 0;
+	CFAbsoluteTime						startTime = CFAbsoluteTimeGetCurrent();
+	Boolean								result = true;
+	
+	
+	for (UInt16 i = 0; i < kColumnCount; ++i)
 	{
-		// all characters in the Braille range
-		outNewAttributes.addAttributes(kTextAttributes_VTGraphics);
+		statusLineRGB[i] = (0x00FF0000 | i);
+		statusLineIDs[i] = table.returnColorID(0xFF, 0, STATIC_CAST(i, UInt8));
 	}
-	else
+	
+	for (UInt16 frame = 0; frame < kFrameCount; ++frame)
 	{
-		// the original character was not explicitly identified as graphical,
-		// but it may still be best to *tag* it as such so that a more
-		// advanced rendering can be done (default font renderings for
-		// graphics are not always as nice)
-		switch (inCharacter)
+		// define a new gradient frame
+		for (UInt16 row = 0; row < kRowCount; ++row)
 		{
-		// this list should generally match the set of Unicode characters that
-		// are handled by the drawVTGraphicsGlyph() internal method in the
-		// Terminal View module
-		case '=': // equal to
-		case 0x2190: // leftwards arrow
-		case 0x2191: // upwards arrow
-		case 0x2192: // rightwards arrow
-		case 0x2193: // downwards arrow
-		case 0x21B5: // new line (international symbol is an arrow that hooks from mid-top to mid-left)
-		case 0x21DF: // form feed (international symbol is an arrow pointing top to bottom with two horizontal lines through it)
-		case 0x21E5: // horizontal tab (international symbol is a right-pointing arrow with a terminating line)
-		case 0x221A: // square root left edge
-		case 0x22EF: // middle ellipsis (three dots, centered)
-		case 0x23B2: // large sigma (summation), top half
-		case 0x23B3: // large sigma (summation), bottom half
-		case 0x23BA: // top line
-		case 0x23BB: // line between top and middle regions
-		case 0x23BC: // line between middle and bottom regions
-		case 0x23BD: // bottom line
-		case 0x2500: // middle line
-		case 0x2501: // middle line, bold version
-		case 0x2502: // vertical line
-		case 0x2503: // vertical line, bold version
-		case 0x2504: // horizontal triple-dashed line
-		case 0x2505: // horizontal triple-dashed line, bold version
-		case 0x2506: // vertical triple-dashed line
-		case 0x2507: // vertical triple-dashed line, bold version
-		case 0x2508: // horizontal quadruple-dashed line
-		case 0x2509: // horizontal quadruple-dashed line, bold version
-		case 0x250A: // vertical quadruple-dashed line
-		case 0x250B: // vertical quadruple-dashed line, bold version
-		case 0x250C: // hook mid-right to mid-bottom
-		case 0x250D: // hook mid-right to mid-bottom, bold right
-		case 0x250E: // hook mid-right to mid-bottom, bold bottom
-		case 0x250F: // hook mid-right to mid-bottom, bold version
-		case 0x2510: // hook mid-left to mid-bottom
-		case 0x2511: // hook mid-left to mid-bottom, bold left
-		case 0x2512: // hook mid-left to mid-bottom, bold bottom
-		case 0x2513: // hook mid-left to mid-bottom, bold version
-		case 0x2514: // hook mid-top to mid-right
-		case 0x2515: // hook mid-top to mid-right, bold right
-		case 0x2516: // hook mid-top to mid-right, bold top
-		case 0x2517: // hook mid-top to mid-right, bold version
-		case 0x2518: // hook mid-top to mid-left
-		case 0x2519: // hook mid-top to mid-left, bold left
-		case 0x251A: // hook mid-top to mid-left, bold top
-		case 0x251B: // hook mid-top to mid-left, bold version
-		case 0x251C: // cross minus the left piece
-		case 0x251D: // cross minus the left piece, bold right
-		case 0x251E: // cross minus the left piece, bold top
-		case 0x251F: // cross minus the left piece, bold bottom
-		case 0x2520: // cross minus the left piece, bold vertical
-		case 0x2521: // cross minus the left piece, bold hook mid-top to mid-right
-		case 0x2522: // cross minus the left piece, bold hook mid-bottom to mid-right
-		case 0x2523: // cross minus the left piece, bold version
-		case 0x2524: // cross minus the right piece
-		case 0x2525: // cross minus the right piece, bold left
-		case 0x2526: // cross minus the right piece, bold top
-		case 0x2527: // cross minus the right piece, bold bottom
-		case 0x2528: // cross minus the right piece, bold vertical
-		case 0x2529: // cross minus the right piece, bold hook mid-top to mid-left
-		case 0x252A: // cross minus the right piece, bold hook mid-bottom to mid-left
-		case 0x252B: // cross minus the right piece, bold version
-		case 0x252C: // cross minus the top piece
-		case 0x252D: // cross minus the top piece, bold left
-		case 0x252E: // cross minus the top piece, bold right
-		case 0x252F: // cross minus the top piece, bold horizontal
-		case 0x2530: // cross minus the top piece, bold bottom
-		case 0x2531: // cross minus the top piece, bold hook mid-bottom to mid-left
-		case 0x2532: // cross minus the top piece, bold hook mid-bottom to mid-right
-		case 0x2533: // cross minus the top piece, bold version
-		case 0x2534: // cross minus the bottom piece
-		case 0x2535: // cross minus the bottom piece, bold left
-		case 0x2536: // cross minus the bottom piece, bold right
-		case 0x2537: // cross minus the bottom piece, bold horizontal
-		case 0x2538: // cross minus the bottom piece, bold top
-		case 0x2539: // cross minus the bottom piece, bold hook mid-top to mid-left
-		case 0x253A: // cross minus the bottom piece, bold hook mid-top to mid-right
-		case 0x253B: // cross minus the bottom piece, bold version
-		case 0x253C: // cross
-		case 0x253D: // cross, bold left
-		case 0x253E: // cross, bold right
-		case 0x253F: // cross, bold horizontal
-		case 0x2540: // cross, bold top
-		case 0x2541: // cross, bold bottom
-		case 0x2542: // cross, bold vertical
-		case 0x2543: // cross, bold hook mid-top to mid-left
-		case 0x2544: // cross, bold hook mid-top to mid-right
-		case 0x2545: // cross, bold hook mid-bottom to mid-left
-		case 0x2546: // cross, bold hook mid-bottom to mid-right
-		case 0x2547: // cross, bold T-up
-		case 0x2548: // cross, bold T-down
-		case 0x2549: // cross, bold T-left
-		case 0x254A: // cross, bold T-right
-		case 0x254B: // cross, bold version
-		case 0x254C: // horizontal double-dashed line
-		case 0x254D: // horizontal double-dashed line, bold version
-		case 0x254E: // vertical double-dashed line
-		case 0x254F: // vertical double-dashed line, bold version
-		case 0x2550: // middle line, double-line version
-		case 0x2551: // vertical line, double-line version
-		case 0x2552: // hook mid-right to mid-bottom, double-horizontal-only version
-		case 0x2553: // hook mid-right to mid-bottom, double-vertical-only version
-		case 0x2554: // hook mid-right to mid-bottom, double-line version
-		case 0x2555: // hook mid-left to mid-bottom, double-horizontal-only version
-		case 0x2556: // hook mid-left to mid-bottom, double-vertical-only version
-		case 0x2557: // hook mid-left to mid-bottom, double-line version
-		case 0x2558: // hook mid-top to mid-right, double-horizontal-only version
-		case 0x2559: // hook mid-top to mid-right, double-vertical-only version
-		case 0x255A: // hook mid-top to mid-right, double-line version
-		case 0x255B: // hook mid-top to mid-left, double-horizontal-only version
-		case 0x255C: // hook mid-top to mid-left, double-vertical-only version
-		case 0x255D: // hook mid-top to mid-left, double-line version
-		case 0x255E: // cross minus the left piece, double-horizontal-only version
-		case 0x255F: // cross minus the left piece, double-vertical-only version
-		case 0x2560: // cross minus the left piece, double-line version
-		case 0x2561: // cross minus the right piece, double-horizontal-only version
-		case 0x2562: // cross minus the right piece, double-vertical-only version
-		case 0x2563: // cross minus the right piece, double-line version
-		case 0x2564: // cross minus the top piece, double-horizontal-only version
-		case 0x2565: // cross minus the top piece, double-vertical-only version
-		case 0x2566: // cross minus the top piece, double-line version
-		case 0x2567: // cross minus the bottom piece, double-horizontal-only version
-		case 0x2568: // cross minus the bottom piece, double-vertical-only version
-		case 0x2569: // cross minus the bottom piece, double-line version
-		case 0x256A: // cross, double-horizontal-only version
-		case 0x256B: // cross, double-vertical-only version
-		case 0x256C: // cross, double-line version
-		case 0x2320: // integral sign (elongated S), top
-		case 0x2321: // integral sign (elongated S), bottom
-		case 0x239B: // left parenthesis, upper
-		case 0x239C: // left parenthesis extension
-		case 0x239D: // left parenthesis, lower
-		case 0x239E: // right parenthesis, upper
-		case 0x239F: // right parenthesis extension
-		case 0x23A0: // right parenthesis, lower
-		case 0x23A1: // left square bracket, upper
-		case 0x23A2: // left square bracket extension
-		case 0x23A3: // left square bracket, lower
-		case 0x23A4: // right square bracket, upper
-		case 0x23A5: // right square bracket extension
-		case 0x23A6: // right square bracket, lower
-		case 0x23A7: // left curly brace, upper
-		case 0x23A8: // left curly brace, middle
-		case 0x23A9: // left curly brace, lower
-		case 0x23AA: // curly brace extension
-		case 0x23AB: // right curly brace, upper
-		case 0x23AC: // right curly brace, middle
-		case 0x23AD: // right curly brace, lower
-		case 0x23AE: // integral extension
-		case 0x23B7: // square root bottom, centered
-		case 0x23B8: // left vertical box line
-		case 0x23B9: // right vertical box line
-		case 0x23D0: // vertical line extension
-		case 0x256D: // curved mid-right to mid-bottom
-		case 0x256E: // curved mid-left to mid-bottom
-		case 0x256F: // curved mid-top to mid-left
-		case 0x2570: // curved mid-top to mid-right
-		case 0x2571: // diagonal line from top-right to bottom-left
-		case 0x2572: // diagonal line from top-left to bottom-right
-		case 0x2573: // diagonal lines from each corner crossing in the center
-		case 0x2574: // cross, left segment only
-		case 0x2575: // cross, top segment only
-		case 0x2576: // cross, right segment only
-		case 0x2577: // cross, bottom segment only
-		case 0x2578: // cross, left segment only, bold version
-		case 0x2579: // cross, top segment only, bold version
-		case 0x257A: // cross, right segment only, bold version
-		case 0x257B: // cross, bottom segment only, bold version
-		case 0x257C: // horizontal line, bold right half
-		case 0x257D: // vertical line, bold bottom half
-		case 0x257E: // horizontal line, bold left half
-		case 0x257F: // vertical line, bold top half
-		case 0x2580: // upper-half block
-		case 0x2581: // 1/8 bottom block
-		case 0x2582: // 2/8 (1/4) bottom block
-		case 0x2583: // 3/8 bottom block
-		case 0x2584: // lower-half block
-		case 0x2585: // 5/8 bottom block
-		case 0x2586: // 6/8 (3/4) bottom block
-		case 0x2587: // 7/8 bottom block
-		case 0x2588: // solid block
-		case 0x2589: // 7/8 left block
-		case 0x258A: // 6/8 (3/4) left block
-		case 0x258B: // 5/8 left block
-		case 0x258C: // left-half block
-		case 0x258D: // 3/8 left block
-		case 0x258E: // 2/8 (1/4) left block
-		case 0x258F: // 1/8 left block
-		case 0x2590: // right-half block
-		case 0x2591: // light gray pattern
-		case 0x2592: // medium gray pattern
-		case 0x2593: // heavy gray pattern or checkerboard
-		case 0x2594: // 1/8 top block
-		case 0x2595: // 1/8 right block
-		case 0x2596: // quadrant lower-left
-		case 0x2597: // quadrant lower-right
-		case 0x2598: // quadrant upper-left
-		case 0x2599: // block minus upper-right quadrant
-		case 0x259A: // quadrants upper-left and lower-right
-		case 0x259B: // block minus lower-right quadrant
-		case 0x259C: // block minus lower-left quadrant
-		case 0x259D: // quadrant upper-right
-		case 0x259E: // quadrants upper-right and lower-left
-		case 0x259F: // block minus upper-left quadrant
-		case 0x2699: // gear
-		case 0x26A1: // online/offline lightning bolt
-		case 0x2713: // check mark
-		case 0x2714: // check mark, bold
-		case 0x2718: // X mark
-		case 0x27A6: // curve-to-right arrow (used for detached-from-head in "powerline")
-		case 0x2913: // vertical tab (international symbol is a down-pointing arrow with a terminating line)
-		case 0xE0A0: // "powerline" version control branch
-		case 0xE0A1: // "powerline" line (LN) marker
-		case 0xE0A2: // "powerline" closed padlock
-		case 0xE0B0: // "powerline" rightward triangle
-		case 0xE0B1: // "powerline" rightward arrowhead
-		case 0xE0B2: // "powerline" leftward triangle
-		case 0xE0B3: // "powerline" leftward arrowhead
-		case 0xFFFD: // replacement character
-			outNewAttributes.addAttributes(kTextAttributes_VTGraphics);
-			break;
+			for (UInt16 column = 0; column < kColumnCount; ++column)
+			{
+				UInt32 const	kCellIndex = (row * kColumnCount + column);
+				
+				
+				frameIDs[kCellIndex] = table.returnColorID(STATIC_CAST(frame, UInt8), STATIC_CAST((kCellIndex >> 8) + (frame >> 8), UInt8),
+															STATIC_CAST(kCellIndex, UInt8));
+			}
+		}
 		
-		default:
-			break;
+		// draw the frame and the status line
+		for (auto colorID : frameIDs)
+		{
+			UNUSED_RETURN(Boolean)table.getColor(colorID, red, green, blue);
+		}
+		for (UInt16 i = 0; i < kColumnCount; ++i)
+		{
+			UInt32		rgbKey = 0;
+			
+			
+			UNUSED_RETURN(Boolean)table.getColor(statusLineIDs[i], red, green, blue);
+			rgbKey = ((red << 16) | (green << 8) | blue);
+			if (statusLineRGB[i] != rgbKey)
+			{
+				++mismatchCount;
+			}
 		}
 	}
 	
+	Console_WriteValueFloat4("true-color gradient benchmark: colors defined, seconds, (unused), (unused)",
+								STATIC_CAST(kFrameCount * kColumnCount * kRowCount, Float32),
+								STATIC_CAST(CFAbsoluteTimeGetCurrent() - startTime, Float32), 0, 0);
+	
+	Console_TestAssertUpdate(result, 0 == mismatchCount,
+								Console_WriteValue, "visible true colors that were reused while on screen", mismatchCount);
+	
 	return result;
-}// translateCharacter
+}// unitTest_TrueColorTable_001
 
 } // anonymous namespace
 
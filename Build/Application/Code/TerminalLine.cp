@@ -33,17 +33,62 @@
 #include "TerminalLine.h"
 #include <UniversalDefines.h>
 
+// standard-C++ includes
+#include <algorithm>
+#include <array>
+
 // library includes
 #include <Console.h>
 
 
 
+#pragma mark Constants
+namespace {
+
+UInt8 const		kMy_EncodingFlagGlobalAttributes	= 0x01;		//!< global attributes follow the text
+UInt8 const		kMy_EncodingFlagAttributeRuns		= 0x02;		//!< attribute runs follow the text
+UInt8 const		kMy_EncodingFlagInlineColors		= 0x04;		//!< every attribute run also has inline colors
+UInt8 const		kMy_EncodingFlagsAll				= 0x07;		//!< bits that may be set in the first byte of a line
+UInt8 const		kMy_EncodingRepeatMarker			= 0xFF;		//!< never starts an encoded character; followed by a count and one character
+size_t const	kMy_EncodingMinimumRepeatCount		= 4;		//!< shorter sequences of the same character are not worth a repeat marker
+
+} // anonymous namespace
+
+#pragma mark Types
+namespace {
+
+typedef std::array< UInt32, kTerminalLine_MaximumCharacterCount >	My_LinkIDPerCell;
+
+} // anonymous namespace
+
+#pragma mark Internal Method Prototypes
+namespace {
+
+void					appendAttributes		(std::vector< UInt8 >&, TextAttributes_Object);
+void					appendCharacter			(std::vector< UInt8 >&, UniChar);
+void					appendVarInt			(std::vector< UInt8 >&, UInt32);
+void					expandLinks				(TerminalLine_LinkList const&, My_LinkIDPerCell&);
+void					gatherLinks				(My_LinkIDPerCell const&, TerminalLine_LinkList&);
+Boolean					readAttributes			(UInt8 const*&, UInt8 const*, TextAttributes_Object&);
+Boolean					readCharacter			(UInt8 const*&, UInt8 const*, UniChar&);
+Boolean					readVarInt				(UInt8 const*&, UInt8 const*, UInt32&);
+TextAttributes_Object	returnEncodedAttributes	(TextAttributes_Object);
+size_t					returnRunEnd			(TerminalLine_TextAttributesList const&, TerminalLine_InlineColorList const&,
+												 size_t, size_t);
+Boolean					unitTest000_Begin		();
+Boolean					unitTest001_Begin		();
+Boolean					unitTest002_Begin		();
+Boolean					unitTest003_Begin		();
+
+} // anonymous namespace
+
 #pragma mark Variables
 namespace {
 
 
 TerminalLine_AttributeInfo&		gEmptyLineAttributes ()		{ static TerminalLine_AttributeInfo x; return x; }
 TerminalLine_Object const&		gEmptyLineData ()			{ static TerminalLine_Object x; return x; }
+TerminalLine_LinkList const&	gEmptyLinkList ()			{ static TerminalLine_LinkList x; return x; }
 
 
 } // anonymous namespace
@@ -51,6 +96,279 @@ TerminalLine_Object const&		gEmptyLineData ()			{ static TerminalLine_Object x;
 
 #pragma mark Public Methods
 
+/*!
+A unit test for this module.  This should always
+be run before a release, after any substantial
+changes are made, or if you suspect bugs!  It
+should also be EXPANDED as new functionality is
+proposed (ideally, a test is written before the
+functionality is added).
+
+(2021.06)
+*/
+void
+TerminalLine_RunTests ()
+{
+	UInt16		totalTests = 0;
+	UInt16		failedTests = 0;
+	
+	
+	++totalTests; if (false == unitTest000_Begin()) ++failedTests;
+	++totalTests; if (false == unitTest001_Begin()) ++failedTests;
+	++totalTests; if (false == unitTest002_Begin()) ++failedTests;
+	++totalTests; if (false == unitTest003_Begin()) ++failedTests;
+	
+	Console_WriteUnitTestReport("Terminal Line", failedTests, totalTests);
+}// RunTests
+
+
+/*!
+Appends a compact encoding of the given line to the buffer,
+which TerminalLine_DecodeLine() can turn back into a line.
+
+Blanks at the end of the line and default attributes at the
+end of the line are implied, sequences of the same character
+are stored once with a count, and attributes are stored as
+runs of cells that have the same attributes (and the same
+inline colors, if the line has any).  Characters take one to
+three bytes each, as in UTF-8 (though surrogates are stored
+individually), and other numbers take as few bytes as their
+value requires; so the encoding does not depend on the byte
+order of the computer.  A line that has never been changed
+takes just 2 bytes.
+
+Attributes that refer to state outside the line (images,
+the selection and search results) are not encoded, and
+neither are links: hyperlinks refer to URIs that the
+terminal may forget, and other links are found again by
+scanning the decoded text.
+
+(2021.06)
+*/
+void
+TerminalLine_AppendEncoding		(TerminalLine_Object const&		inLine,
+								 std::vector< UInt8 >&			inoutBuffer)
+{
+	TerminalLine_TextAttributesList const&	attributes = inLine.returnAttributeVector();
+	TerminalLine_InlineColorList const&		colors = inLine.returnInlineColorVector();
+	TextAttributes_Object const				globalAttributes = returnEncodedAttributes(inLine.returnGlobalAttributes());
+	TextAttributes_InlineColors const		defaultColors;
+	size_t									textCount = kTerminalLine_MaximumCharacterCount;
+	size_t									attributeCount = attributes.size();
+	UInt8									flags = 0;
+	
+	
+	while ((textCount > 0) && (' ' == inLine.textVectorBegin[textCount - 1]))
+	{
+		--textCount;
+	}
+	
+	while ((attributeCount > 0) && (TextAttributes_Object() == returnEncodedAttributes(attributes[attributeCount - 1])) &&
+			(colors.empty() || (defaultColors == colors[attributeCount - 1])))
+	{
+		--attributeCount;
+	}
+	
+	if (TextAttributes_Object() != globalAttributes)
+	{
+		flags |= kMy_EncodingFlagGlobalAttributes;
+	}
+	if (attributeCount > 0)
+	{
+		flags |= kMy_EncodingFlagAttributeRuns;
+		if (false == colors.empty())
+		{
+			flags |= kMy_EncodingFlagInlineColors;
+		}
+	}
+	
+	inoutBuffer.push_back(flags);
+	
+	// text
+	appendVarInt(inoutBuffer, STATIC_CAST(textCount, UInt32));
+	for (size_t i = 0; i < textCount; )
+	{
+		UniChar const	character = inLine.textVectorBegin[i];
+		size_t			repeatCount = 1;
+		
+		
+		while (((i + repeatCount) < textCount) && (repeatCount < 0xFF) && (character == inLine.textVectorBegin[i + repeatCount]))
+		{
+			++repeatCount;
+		}
+		
+		if (repeatCount >= kMy_EncodingMinimumRepeatCount)
+		{
+			inoutBuffer.push_back(kMy_EncodingRepeatMarker);
+			inoutBuffer.push_back(STATIC_CAST(repeatCount, UInt8));
+			appendCharacter(inoutBuffer, character);
+		}
+		else
+		{
+			for (size_t j = 0; j < repeatCount; ++j)
+			{
+				appendCharacter(inoutBuffer, character);
+			}
+		}
+		i += repeatCount;
+	}
+	
+	// attributes
+	if (flags & kMy_EncodingFlagGlobalAttributes)
+	{
+		appendAttributes(inoutBuffer, globalAttributes);
+	}
+	if (flags & kMy_EncodingFlagAttributeRuns)
+	{
+		UInt32		runCount = 0;
+		
+		
+		for (size_t i = 0; i < attributeCount; i = returnRunEnd(attributes, colors, i, attributeCount))
+		{
+			++runCount;
+		}
+		appendVarInt(inoutBuffer, runCount);
+		for (size_t i = 0; i < attributeCount; )
+		{
+			size_t const	runEnd = returnRunEnd(attributes, colors, i, attributeCount);
+			
+			
+			appendVarInt(inoutBuffer, STATIC_CAST(runEnd - i, UInt32));
+			appendAttributes(inoutBuffer, returnEncodedAttributes(attributes[i]));
+			if (flags & kMy_EncodingFlagInlineColors)
+			{
+				appendVarInt(inoutBuffer, colors[i].foregroundRGB);
+				appendVarInt(inoutBuffer, colors[i].backgroundRGB);
+			}
+			i = runEnd;
+		}
+	}
+}// AppendEncoding
+
+
+/*!
+Decodes one line that was encoded by the routine
+TerminalLine_AppendEncoding(), replacing the contents of
+the given line, and advances the pointer to the byte that
+follows the line.
+
+If the encoded line is blank and has no attributes, a
+handle that refers to the shared empty line is not changed
+(so no memory is allocated for such lines).
+
+Returns false if the data is truncated or invalid; in that
+case the pointer is unchanged but the line may have been
+partially replaced.
+
+(2021.06)
+*/
+Boolean
+TerminalLine_DecodeLine		(UInt8 const*&					inoutBytePtr,
+							 UInt8 const*					inPastEndPtr,
+							 TerminalLine_Handle&			inoutLine)
+{
+	UInt8 const*	bytePtr = inoutBytePtr;
+	UInt32			textCount = 0;
+	UInt8			flags = 0;
+	Boolean			result = (bytePtr < inPastEndPtr);
+	
+	
+	if (result)
+	{
+		flags = *bytePtr++;
+		result = ((0 == (flags & ~kMy_EncodingFlagsAll)) &&
+					((0 == (flags & kMy_EncodingFlagInlineColors)) || (flags & kMy_EncodingFlagAttributeRuns)) &&
+					readVarInt(bytePtr, inPastEndPtr, textCount) &&
+					(textCount <= kTerminalLine_MaximumCharacterCount));
+	}
+	
+	if (result && ((0 != flags) || (0 != textCount) || (false == inoutLine.isDefault())))
+	{
+		Boolean const			isNewLine = inoutLine.isDefault();
+		TerminalLine_Object&	line = *inoutLine; // allocates a unique line if necessary
+		
+		
+		if (false == isNewLine)
+		{
+			line.structureInitialize();
+		}
+		
+		// text
+		for (UInt32 i = 0; (result && (i < textCount)); )
+		{
+			UniChar		character = ' ';
+			UInt32		repeatCount = 1;
+			
+			
+			if ((bytePtr < inPastEndPtr) && (kMy_EncodingRepeatMarker == *bytePtr))
+			{
+				++bytePtr;
+				result = ((bytePtr < inPastEndPtr) && (*bytePtr <= (textCount - i)));
+				if (result)
+				{
+					repeatCount = *bytePtr++;
+				}
+			}
+			result = (result && readCharacter(bytePtr, inPastEndPtr, character));
+			if (result)
+			{
+				std::fill(line.textVectorBegin + i, line.textVectorBegin + i + repeatCount, character);
+				i += repeatCount;
+			}
+		}
+		line.invalidateLinkScan();
+		
+		// attributes
+		if (result && (flags & kMy_EncodingFlagGlobalAttributes))
+		{
+			result = readAttributes(bytePtr, inPastEndPtr, line.returnMutableGlobalAttributes());
+		}
+		if (result && (flags & kMy_EncodingFlagAttributeRuns))
+		{
+			TerminalLine_TextAttributesList&	attributes = line.returnMutableAttributeVector();
+			TerminalLine_InlineColorList*		colorsPtr = (flags & kMy_EncodingFlagInlineColors)
+															? &line.returnMutableInlineColorVector()
+															: nullptr;
+			UInt32								runCount = 0;
+			size_t								cellIndex = 0;
+			
+			
+			result = readVarInt(bytePtr, inPastEndPtr, runCount);
+			for (UInt32 i = 0; (result && (i < runCount)); ++i)
+			{
+				TextAttributes_Object		runAttributes;
+				TextAttributes_InlineColors	runColors;
+				UInt32						runLength = 0;
+				
+				
+				result = (readVarInt(bytePtr, inPastEndPtr, runLength) &&
+							(runLength <= (attributes.size() - cellIndex)) &&
+							readAttributes(bytePtr, inPastEndPtr, runAttributes) &&
+							((nullptr == colorsPtr) ||
+								(readVarInt(bytePtr, inPastEndPtr, runColors.foregroundRGB) &&
+									readVarInt(bytePtr, inPastEndPtr, runColors.backgroundRGB))));
+				if (result)
+				{
+					std::fill(attributes.begin() + cellIndex, attributes.begin() + cellIndex + runLength, runAttributes);
+					if (nullptr != colorsPtr)
+					{
+						std::fill(colorsPtr->begin() + cellIndex, colorsPtr->begin() + cellIndex + runLength, runColors);
+					}
+					cellIndex += runLength;
+				}
+			}
+		}
+	}
+	
+	if (result)
+	{
+		inoutBytePtr = bytePtr;
+	}
+	
+	return result;
+}// DecodeLine
+
+
 /*!
 Creates a new screen buffer line.
 
@@ -65,7 +383,9 @@ textCFString(CFStringCreateMutableWithExternalCharactersNoCopy
 				(kCFAllocatorDefault, textVectorBegin, kTerminalLine_MaximumCharacterCount,
 					kTerminalLine_MaximumCharacterCount/* capacity */, kCFAllocatorMalloc/* reallocator/deallocator */),
 				CFRetainRelease::kAlreadyRetained),
-attributeInfo(nullptr)
+attributeInfo(nullptr),
+linkInfo(),
+linkScanNeeded(false)
 {
 	assert(textCFString.exists());
 	clearAttributes();
@@ -88,7 +408,9 @@ textCFString(CFStringCreateMutableWithExternalCharactersNoCopy
 				(kCFAllocatorDefault, textVectorBegin, kTerminalLine_MaximumCharacterCount,
 					kTerminalLine_MaximumCharacterCount/* capacity */, kCFAllocatorMalloc/* reallocator/deallocator */),
 				CFRetainRelease::kAlreadyRetained),
-attributeInfo(nullptr)
+attributeInfo(nullptr),
+linkInfo((nullptr == inCopy.linkInfo) ? nullptr : new TerminalLine_LinkInfo(*inCopy.linkInfo)),
+linkScanNeeded(inCopy.linkScanNeeded)
 {
 	assert(textCFString.exists());
 	this->copyAttributes(inCopy.attributeInfo);
@@ -131,6 +453,9 @@ operator =	(TerminalLine_Object const&		inCopy)
 		// also, since the lines are all the same size, there is no need to
 		// copy the start/end and size information
 		std::copy(inCopy.textVectorBegin, inCopy.textVectorEnd, this->textVectorBegin);
+		
+		this->linkInfo.reset((nullptr == inCopy.linkInfo) ? nullptr : new TerminalLine_LinkInfo(*inCopy.linkInfo));
+		this->linkScanNeeded = inCopy.linkScanNeeded;
 	}
 	return *this;
 }// TerminalLine_Object::operator =
@@ -160,6 +485,43 @@ clearAttributes ()
 }// TerminalLine_Object::clearAttributes
 
 
+/*!
+Resets the inline colors of the given range of cells (such
+as cells that are erased, or that are blank after text is
+shifted), so that stale colors do not stay in the line.
+The attributes of these cells should no longer have any
+inline-color bits set.
+
+If no cells on the line have inline colors afterwards, the
+color storage is freed.
+
+(2021.06)
+*/
+void
+TerminalLine_Object::
+clearInlineColors	(UInt16		inStartColumn,
+					 UInt16		inPastEndColumn)
+{
+	if (false == returnInlineColorVector().empty())
+	{
+		TerminalLine_InlineColorList&		colors = returnMutableInlineColorVector();
+		TextAttributes_InlineColors const	kNoColors;
+		size_t const						kPastEnd = std::min< size_t >(inPastEndColumn, colors.size());
+		
+		
+		if (inStartColumn < kPastEnd)
+		{
+			std::fill(colors.begin() + inStartColumn, colors.begin() + kPastEnd, kNoColors);
+		}
+		if (colors.end() == std::find_if(colors.begin(), colors.end(),
+											[&kNoColors] (TextAttributes_InlineColors const& inColors) { return (kNoColors != inColors); }))
+		{
+			TerminalLine_InlineColorList().swap(colors);
+		}
+	}
+}// TerminalLine_Object::clearInlineColors
+
+
 /*!
 Unlike createAttributes(), this will check the address of the
 source and perform a shallow copy of any known shared sets
@@ -219,6 +581,30 @@ createAttributes	(TerminalLine_AttributeInfo const*		inSourceOrNull)
 }// TerminalLine_Object::createAttributes
 
 
+/*!
+Removes hyperlinks from the given range of cells (such as
+cells that are erased).
+
+(2021.06)
+*/
+void
+TerminalLine_Object::
+eraseExplicitLinks	(UInt16		inStartColumn,
+					 UInt16		inPastEndColumn)
+{
+	if ((nullptr != this->linkInfo) && (false == this->linkInfo->explicitLinks.empty()))
+	{
+		My_LinkIDPerCell	linkIDs;
+		
+		
+		expandLinks(this->linkInfo->explicitLinks, linkIDs);
+		std::fill(linkIDs.begin() + std::min< UInt16 >(inStartColumn, linkIDs.size()),
+					linkIDs.begin() + std::min< UInt16 >(inPastEndColumn, linkIDs.size()), 0);
+		gatherLinks(linkIDs, this->linkInfo->explicitLinks);
+	}
+}// TerminalLine_Object::eraseExplicitLinks
+
+
 /*!
 Returns true if the specified line attribute storage matches any
 known shared source of attributes (such as the set of attributes
@@ -253,9 +639,162 @@ const
 }// TerminalLine_Object::isSharedAttributeSource
 
 
+/*!
+Returns the hyperlinks that the application defined for
+cells of this line, in column order.  The IDs refer to
+URIs that the terminal remembers.
+
+(2021.06)
+*/
+TerminalLine_LinkList const&
+TerminalLine_Object::
+returnExplicitLinks ()
+const
+{
+	return (nullptr == this->linkInfo) ? gEmptyLinkList() : this->linkInfo->explicitLinks;
+}// TerminalLine_Object::returnExplicitLinks
+
+
+/*!
+Returns the links that were most recently found by scanning
+the text, in column order.  The IDs are URL types.  If the
+text has changed since then (see isLinkScanNeeded()), the
+links may be wrong.
+
+(2021.06)
+*/
+TerminalLine_LinkList const&
+TerminalLine_Object::
+returnScannedLinks ()
+const
+{
+	return (nullptr == this->linkInfo) ? gEmptyLinkList() : this->linkInfo->scannedLinks;
+}// TerminalLine_Object::returnScannedLinks
+
+
+/*!
+Changes the hyperlink of one cell (0 means no hyperlink).
+Extending the last hyperlink of the line by one cell is
+the common case, and does not rebuild the list.
+
+(2021.06)
+*/
+void
+TerminalLine_Object::
+setExplicitLink		(UInt16		inColumn,
+					 UInt32		inLinkID)
+{
+	if (inColumn < kTerminalLine_MaximumCharacterCount)
+	{
+		if (nullptr == this->linkInfo)
+		{
+			this->linkInfo.reset(new TerminalLine_LinkInfo());
+		}
+		
+		TerminalLine_LinkList&	links = this->linkInfo->explicitLinks;
+		
+		
+		if ((0 != inLinkID) && ((links.empty()) || (links.back().pastTheEndColumn < inColumn)))
+		{
+			// new link after all others
+			TerminalLine_Link	newLink;
+			
+			
+			newLink.startColumn = inColumn;
+			newLink.pastTheEndColumn = inColumn + 1;
+			newLink.linkID = inLinkID;
+			links.push_back(newLink);
+		}
+		else if ((0 != inLinkID) && (links.back().pastTheEndColumn == inColumn) && (links.back().linkID == inLinkID))
+		{
+			// the last link continues
+			++(links.back().pastTheEndColumn);
+		}
+		else
+		{
+			My_LinkIDPerCell	linkIDs;
+			
+			
+			expandLinks(links, linkIDs);
+			linkIDs[inColumn] = inLinkID;
+			gatherLinks(linkIDs, links);
+		}
+	}
+}// TerminalLine_Object::setExplicitLink
+
+
+/*!
+Replaces the links that were found by scanning the text,
+and notes that the text has not changed since.  The links
+must be in column order; their IDs are URL types.
+
+(2021.06)
+*/
+void
+TerminalLine_Object::
+setScannedLinks		(TerminalLine_LinkList const&	inLinks)
+{
+	if (nullptr != this->linkInfo)
+	{
+		this->linkInfo->scannedLinks = inLinks;
+	}
+	else if (false == inLinks.empty())
+	{
+		this->linkInfo.reset(new TerminalLine_LinkInfo());
+		this->linkInfo->scannedLinks = inLinks;
+	}
+	this->linkScanNeeded = false;
+}// TerminalLine_Object::setScannedLinks
+
+
+/*!
+Moves the hyperlinks of the cells from the given column up
+to (not including) the end limit, by the given number of
+cells, as deleteRange() and insertBlanks() move text: the
+cells that are vacated have no hyperlink, and hyperlinks
+that move past the end limit are removed.
+
+(2021.06)
+*/
+void
+TerminalLine_Object::
+shiftExplicitLinks	(UInt16		inStartColumn,
+					 SInt16		inColumnDelta,
+					 UInt16		inEndLimit)
+{
+	if ((nullptr != this->linkInfo) && (false == this->linkInfo->explicitLinks.empty()) &&
+		(inEndLimit <= kTerminalLine_MaximumCharacterCount) && (inStartColumn < inEndLimit))
+	{
+		My_LinkIDPerCell	linkIDs;
+		auto const			kStart = linkIDs.begin() + inStartColumn;
+		auto const			kEndLimit = linkIDs.begin() + inEndLimit;
+		
+		
+		expandLinks(this->linkInfo->explicitLinks, linkIDs);
+		if (inColumnDelta < 0)
+		{
+			auto const	kCount = std::min< SInt16 >(-inColumnDelta, inEndLimit - inStartColumn);
+			
+			
+			std::copy(kStart + kCount, kEndLimit, kStart);
+			std::fill(kEndLimit - kCount, kEndLimit, 0);
+		}
+		else if (inColumnDelta > 0)
+		{
+			auto const	kCount = std::min< SInt16 >(inColumnDelta, inEndLimit - inStartColumn);
+			
+			
+			std::copy_backward(kStart, kEndLimit - kCount, kEndLimit);
+			std::fill(kStart, kStart + kCount, 0);
+		}
+		gatherLinks(linkIDs, this->linkInfo->explicitLinks);
+	}
+}// TerminalLine_Object::shiftExplicitLinks
+
+
 /*!
 Resets a line to its initial state (clearing all text and
-removing attribute bits).
+removing attribute bits and links).
 
 (3.1)
 */
@@ -265,6 +804,8 @@ structureInitialize ()
 {
 	std::fill(textVectorBegin, textVectorEnd, ' ');
 	clearAttributes();
+	linkInfo.reset();
+	linkScanNeeded = false;
 }// TerminalLine_Object::structureInitialize
 
 
@@ -427,4 +968,580 @@ reset ()
 	assert(this->isDefault());
 }// TerminalLine_Handle::reset
 
+
+#pragma mark Internal Methods
+namespace {
+
+/*!
+Appends the two words of the given attributes, as
+variable-length numbers (see appendVarInt()).
+
+(2021.06)
+*/
+void
+appendAttributes	(std::vector< UInt8 >&		inoutBuffer,
+					 TextAttributes_Object		inAttributes)
+{
+	appendVarInt(inoutBuffer, inAttributes.returnValueInRange(TextAttributes_Object::BitRange(0xFFFFFFFF, 32)));
+	appendVarInt(inoutBuffer, inAttributes.returnValueInRange(TextAttributes_Object::BitRange(0xFFFFFFFF, 0)));
+}// appendAttributes
+
+
+/*!
+Appends one character in 1-3 bytes, as in UTF-8.  Surrogates
+are encoded like any other value, so that a pair occupies
+two cells after decoding, just as it did before encoding.
+
+(2021.06)
+*/
+void
+appendCharacter		(std::vector< UInt8 >&		inoutBuffer,
+					 UniChar					inCharacter)
+{
+	if (inCharacter < 0x80)
+	{
+		inoutBuffer.push_back(STATIC_CAST(inCharacter, UInt8));
+	}
+	else if (inCharacter < 0x800)
+	{
+		inoutBuffer.push_back(STATIC_CAST(0xC0 | (inCharacter >> 6), UInt8));
+		inoutBuffer.push_back(STATIC_CAST(0x80 | (inCharacter & 0x3F), UInt8));
+	}
+	else
+	{
+		inoutBuffer.push_back(STATIC_CAST(0xE0 | (inCharacter >> 12), UInt8));
+		inoutBuffer.push_back(STATIC_CAST(0x80 | ((inCharacter >> 6) & 0x3F), UInt8));
+		inoutBuffer.push_back(STATIC_CAST(0x80 | (inCharacter & 0x3F), UInt8));
+	}
+}// appendCharacter
+
+
+/*!
+Appends a number in 1-5 bytes, 7 bits at a time starting
+with the lowest bits; the high bit of each byte is set if
+more bytes follow.
+
+(2021.06)
+*/
+void
+appendVarInt	(std::vector< UInt8 >&		inoutBuffer,
+				 UInt32						inValue)
+{
+	while (inValue >= 0x80)
+	{
+		inoutBuffer.push_back(STATIC_CAST(0x80 | (inValue & 0x7F), UInt8));
+		inValue >>= 7;
+	}
+	inoutBuffer.push_back(STATIC_CAST(inValue, UInt8));
+}// appendVarInt
+
+
+/*!
+Sets the ID of every cell to the ID of the link that the
+cell is in, or 0.
+
+(2021.06)
+*/
+void
+expandLinks		(TerminalLine_LinkList const&	inLinks,
+				 My_LinkIDPerCell&				outLinkIDs)
+{
+	outLinkIDs.fill(0);
+	for (auto const& link : inLinks)
+	{
+		std::fill(outLinkIDs.begin() + std::min< size_t >(link.startColumn, outLinkIDs.size()),
+					outLinkIDs.begin() + std::min< size_t >(link.pastTheEndColumn, outLinkIDs.size()), link.linkID);
+	}
+}// expandLinks
+
+
+/*!
+The opposite of expandLinks(): replaces the list with one
+link for each run of cells that have the same nonzero ID.
+
+(2021.06)
+*/
+void
+gatherLinks		(My_LinkIDPerCell const&	inLinkIDs,
+				 TerminalLine_LinkList&		outLinks)
+{
+	outLinks.clear();
+	for (size_t i = 0; i < inLinkIDs.size(); )
+	{
+		size_t		runEnd = i + 1;
+		
+		
+		while ((runEnd < inLinkIDs.size()) && (inLinkIDs[runEnd] == inLinkIDs[i]))
+		{
+			++runEnd;
+		}
+		if (0 != inLinkIDs[i])
+		{
+			TerminalLine_Link	link;
+			
+			
+			link.startColumn = STATIC_CAST(i, UInt16);
+			link.pastTheEndColumn = STATIC_CAST(runEnd, UInt16);
+			link.linkID = inLinkIDs[i];
+			outLinks.push_back(link);
+		}
+		i = runEnd;
+	}
+}// gatherLinks
+
+
+/*!
+Reads attributes that were written by appendAttributes().
+Returns false if the data is truncated or invalid.
+
+(2021.06)
+*/
+Boolean
+readAttributes	(UInt8 const*&				inoutBytePtr,
+				 UInt8 const*				inPastEndPtr,
+				 TextAttributes_Object&		outAttributes)
+{
+	UInt32		upper = 0;
+	UInt32		lower = 0;
+	Boolean		result = (readVarInt(inoutBytePtr, inPastEndPtr, upper) && readVarInt(inoutBytePtr, inPastEndPtr, lower));
+	
+	
+	if (result)
+	{
+		outAttributes = TextAttributes_Object(upper, lower);
+	}
+	return result;
+}// readAttributes
+
+
+/*!
+Reads a character that was written by appendCharacter().
+Returns false if the data is truncated or invalid.
+
+(2021.06)
+*/
+Boolean
+readCharacter	(UInt8 const*&		inoutBytePtr,
+				 UInt8 const*		inPastEndPtr,
+				 UniChar&			outCharacter)
+{
+	size_t		continuationCount = 0;
+	UInt32		value = 0;
+	Boolean		result = (inoutBytePtr < inPastEndPtr);
+	
+	
+	if (result)
+	{
+		UInt8 const		leadByte = *inoutBytePtr++;
+		
+		
+		if (leadByte < 0x80)
+		{
+			value = leadByte;
+		}
+		else if (0xC0 == (leadByte & 0xE0))
+		{
+			value = (leadByte & 0x1F);
+			continuationCount = 1;
+		}
+		else if (0xE0 == (leadByte & 0xF0))
+		{
+			value = (leadByte & 0x0F);
+			continuationCount = 2;
+		}
+		else
+		{
+			result = false;
+		}
+	}
+	
+	for (size_t i = 0; (result && (i < continuationCount)); ++i)
+	{
+		result = ((inoutBytePtr < inPastEndPtr) && (0x80 == (*inoutBytePtr & 0xC0)));
+		if (result)
+		{
+			value = ((value << 6) | (*inoutBytePtr++ & 0x3F));
+		}
+	}
+	
+	if (result)
+	{
+		outCharacter = STATIC_CAST(value, UniChar);
+	}
+	return result;
+}// readCharacter
+
+
+/*!
+Reads a number that was written by appendVarInt().
+Returns false if the data is truncated or the number
+does not fit in 32 bits.
+
+(2021.06)
+*/
+Boolean
+readVarInt	(UInt8 const*&		inoutBytePtr,
+			 UInt8 const*		inPastEndPtr,
+			 UInt32&			outValue)
+{
+	UInt32		value = 0;
+	UInt8		shift = 0;
+	Boolean		isDone = false;
+	Boolean		result = true;
+	
+	
+	while (result && (false == isDone))
+	{
+		result = ((inoutBytePtr < inPastEndPtr) && (shift < 32));
+		if (result)
+		{
+			UInt8 const		byteValue = *inoutBytePtr++;
+			
+			
+			value |= (STATIC_CAST(byteValue & 0x7F, UInt32) << shift);
+			shift += 7;
+			isDone = (0 == (byteValue & 0x80));
+		}
+	}
+	
+	if (result)
+	{
+		outValue = value;
+	}
+	return result;
+}// readVarInt
+
+
+/*!
+Returns the given attributes without the bits that only
+make sense while the terminal is running (bitmap IDs, and
+highlighting of the selection and search results).
+
+(2021.06)
+*/
+TextAttributes_Object
+returnEncodedAttributes		(TextAttributes_Object		inAttributes)
+{
+	TextAttributes_Object	result = inAttributes;
+	
+	
+	result.removeImageRelatedAttributes();
+	result.removeAttributes(kTextAttributes_Selected);
+	result.removeAttributes(kTextAttributes_SearchHighlight);
+	return result;
+}// returnEncodedAttributes
+
+
+/*!
+Returns the index past the last cell, starting from the given
+index and not beyond the given limit, that has the same encoded
+attributes (and inline colors, if there are any) as the first.
+
+(2021.06)
+*/
+size_t
+returnRunEnd	(TerminalLine_TextAttributesList const&		inAttributes,
+				 TerminalLine_InlineColorList const&		inColors,
+				 size_t										inStartIndex,
+				 size_t										inEndLimit)
+{
+	TextAttributes_Object const		runAttributes = returnEncodedAttributes(inAttributes[inStartIndex]);
+	size_t							result = inStartIndex + 1;
+	
+	
+	while ((result < inEndLimit) && (runAttributes == returnEncodedAttributes(inAttributes[result])) &&
+			(inColors.empty() || (inColors[inStartIndex] == inColors[result])))
+	{
+		++result;
+	}
+	return result;
+}// returnRunEnd
+
+
+/*!
+Tests encoding and decoding of a line that has text,
+repeated characters, characters outside ASCII, global
+attributes, attribute runs and inline colors.
+
+Returns "true" if ALL assertions pass; "false" is
+returned if any fail, however messages should be
+printed for ALL assertion failures regardless.
+
+(2021.06)
+*/
+Boolean
+unitTest000_Begin ()
+{
+	TerminalLine_Handle		original;
+	TerminalLine_Handle		decoded;
+	std::vector< UInt8 >	buffer;
+	Boolean					result = true;
+	
+	
+	{
+		TerminalLine_Object&				line = *original;
+		TerminalLine_TextAttributesList&	attributes = line.returnMutableAttributeVector();
+		TerminalLine_InlineColorList&		colors = line.returnMutableInlineColorVector();
+		UniChar const						text[] = { 'h', 'e', 'l', 'l', 'o', 0x00E9, 0x2192, 0xD83D, 0xDE00 };
+		
+		
+		std::copy(text, text + (sizeof(text) / sizeof(UniChar)), line.textVectorBegin);
+		std::fill(line.textVectorBegin + 20, line.textVectorBegin + 100, '=');
+		line.returnMutableGlobalAttributes() = kTextAttributes_DoubleWidth;
+		std::fill(attributes.begin() + 2, attributes.begin() + 4, kTextAttributes_StyleBold);
+		std::fill(attributes.begin() + 30, attributes.begin() + 40, kTextAttributes_ColorIsInlineForeground);
+		for (auto i = colors.begin() + 30; i != colors.begin() + 40; ++i)
+		{
+			i->setForeground(0x12, 0x34, 0x56);
+		}
+		attributes[50] = kTextAttributes_Selected; // not encoded
+	}
+	
+	TerminalLine_AppendEncoding(*original, buffer);
+	Console_TestAssertUpdate(result, buffer.size() < 64,
+								Console_WriteValue, "encoded size", buffer.size());
+	
+	{
+		UInt8 const*	bytePtr = buffer.data();
+		
+		
+		Console_TestAssertUpdate(result, TerminalLine_DecodeLine(bytePtr, buffer.data() + buffer.size(), decoded),
+									Console_WriteLine, "line could not be decoded");
+		Console_TestAssertUpdate(result, (buffer.data() + buffer.size()) == bytePtr,
+									Console_WriteValue, "bytes remaining after line", (buffer.data() + buffer.size()) - bytePtr);
+	}
+	
+	{
+		TerminalLine_Object const&		originalLine = *STATIC_CAST(original, TerminalLine_Handle const&);
+		TerminalLine_Object const&		decodedLine = *STATIC_CAST(decoded, TerminalLine_Handle const&);
+		TerminalLine_TextAttributesList	expectedAttributes = originalLine.returnAttributeVector();
+		
+		
+		expectedAttributes[50] = TextAttributes_Object();
+		Console_TestAssertUpdate(result, std::equal(originalLine.textVectorBegin, originalLine.textVectorEnd, decodedLine.textVectorBegin),
+									Console_WriteLine, "decoded text does not match");
+		Console_TestAssertUpdate(result, originalLine.returnGlobalAttributes() == decodedLine.returnGlobalAttributes(),
+									Console_WriteLine, "decoded global attributes do not match");
+		Console_TestAssertUpdate(result, expectedAttributes == decodedLine.returnAttributeVector(),
+									Console_WriteLine, "decoded attributes do not match");
+		Console_TestAssertUpdate(result, originalLine.returnInlineColorVector() == decodedLine.returnInlineColorVector(),
+									Console_WriteLine, "decoded inline colors do not match");
+	}
+	
+	return result;
+}// unitTest000_Begin
+
+
+/*!
+Tests that blank lines are compact and stay shared when
+decoded, that several lines can be decoded in sequence,
+and that truncated data is rejected.
+
+Returns "true" if ALL assertions pass; "false" is
+returned if any fail, however messages should be
+printed for ALL assertion failures regardless.
+
+(2021.06)
+*/
+Boolean
+unitTest001_Begin ()
+{
+	TerminalLine_Handle		blankLine;
+	TerminalLine_Handle		textLine;
+	std::vector< UInt8 >	buffer;
+	Boolean					result = true;
+	
+	
+	std::fill((*textLine).textVectorBegin, (*textLine).textVectorBegin + 3, 'x');
+	TerminalLine_AppendEncoding(*blankLine, buffer);
+	Console_TestAssertUpdate(result, 2 == buffer.size(),
+								Console_WriteValue, "encoded size of blank line", buffer.size());
+	TerminalLine_AppendEncoding(*textLine, buffer);
+	TerminalLine_AppendEncoding(*blankLine, buffer);
+	
+	{
+		UInt8 const*			bytePtr = buffer.data();
+		UInt8 const* const		pastEnd = buffer.data() + buffer.size();
+		TerminalLine_Handle		decoded1;
+		TerminalLine_Handle		decoded2;
+		TerminalLine_Handle		decoded3;
+		
+		
+		Console_TestAssertUpdate(result, TerminalLine_DecodeLine(bytePtr, pastEnd, decoded1) && decoded1.isDefault(),
+									Console_WriteLine, "blank line was not decoded as a shared line");
+		Console_TestAssertUpdate(result, TerminalLine_DecodeLine(bytePtr, pastEnd, decoded2) && ('x' == decoded2->textVectorBegin[2]) &&
+										(' ' == decoded2->textVectorBegin[3]),
+									Console_WriteLine, "second line was not decoded correctly");
+		Console_TestAssertUpdate(result, TerminalLine_DecodeLine(bytePtr, pastEnd, decoded2) && (' ' == decoded2->textVectorBegin[0]),
+									Console_WriteLine, "blank line did not replace the text of an existing line");
+		Console_TestAssertUpdate(result, (pastEnd == bytePtr) && (false == TerminalLine_DecodeLine(bytePtr, pastEnd, decoded3)),
+									Console_WriteLine, "decoding past the end was not rejected");
+	}
+	
+	for (size_t i = 2; i < (buffer.size() - 2); ++i)
+	{
+		UInt8 const*			bytePtr = buffer.data() + 2;
+		TerminalLine_Handle		decoded;
+		
+		
+		Console_TestAssertUpdate(result, false == TerminalLine_DecodeLine(bytePtr, buffer.data() + i, decoded),
+									Console_WriteValue, "truncated line was not rejected, byte count", i);
+	}
+	
+	return result;
+}// unitTest001_Begin
+
+
+/*!
+Tests that hyperlinks are extended as cells are written,
+move with the text when cells are inserted or deleted, are
+removed when cells are erased or overwritten, and are
+copied with the line; and that any change to the text
+requires links to be scanned again.
+
+Returns "true" if ALL assertions pass; "false" is
+returned if any fail, however messages should be
+printed for ALL assertion failures regardless.
+
+(2021.06)
+*/
+Boolean
+unitTest002_Begin ()
+{
+	TerminalLine_Handle		handle;
+	TerminalLine_Object&	line = *handle;
+	Boolean					result = true;
+	auto					returnLinks = [&line] () -> std::string
+							{
+								std::string		links;
+								
+								
+								for (auto const& link : line.returnExplicitLinks())
+								{
+									links += std::to_string(link.startColumn) + '-' + std::to_string(link.pastTheEndColumn) + ':' +
+												std::to_string(link.linkID) + ' ';
+								}
+								return links;
+							};
+	
+	
+	Console_TestAssertUpdate(result, false == line.isLinkScanNeeded(), Console_WriteLine, "new line should not need a scan");
+	
+	// write "abcdefgh" where "bcd" is link 7 and "fg" is link 9
+	for (UInt16 i = 0; i < 8; ++i)
+	{
+		line.textVectorBegin[i] = STATIC_CAST('a' + i, UniChar);
+		line.setLinkForCell(i, ((i >= 1) && (i <= 3)) ? 7 : ((i >= 5) && (i <= 6)) ? 9 : 0);
+	}
+	Console_TestAssertUpdate(result, "1-4:7 5-7:9 " == returnLinks(), Console_WriteValueStdString, "links after writing", returnLinks());
+	Console_TestAssertUpdate(result, line.isLinkScanNeeded(), Console_WriteLine, "writing should require a scan");
+	
+	{
+		TerminalLine_LinkList	scanned(1);
+		
+		
+		scanned[0].startColumn = 0;
+		scanned[0].pastTheEndColumn = 8;
+		scanned[0].linkID = 5;
+		line.setScannedLinks(scanned);
+		Console_TestAssertUpdate(result, (false == line.isLinkScanNeeded()) && (1 == line.returnScannedLinks().size()),
+									Console_WriteLine, "scanned links were not set");
+	}
+	
+	// overwriting the middle of a link splits it
+	line.setLinkForCell(2, 0);
+	Console_TestAssertUpdate(result, "1-2:7 3-4:7 5-7:9 " == returnLinks(), Console_WriteValueStdString, "links after overwrite", returnLinks());
+	Console_TestAssertUpdate(result, line.isLinkScanNeeded(), Console_WriteLine, "overwriting should require a scan");
+	
+	// links move with inserted and deleted cells
+	line.insertBlanks(StringUtilities_Cell(0), StringUtilities_Cell(2), TextAttributes_Object(), StringUtilities_Cell(80));
+	Console_TestAssertUpdate(result, "3-4:7 5-6:7 7-9:9 " == returnLinks(), Console_WriteValueStdString, "links after insert", returnLinks());
+	line.deleteRange(StringUtilities_Cell(4), StringUtilities_Cell(2), TextAttributes_Object(), StringUtilities_Cell(80));
+	Console_TestAssertUpdate(result, "3-4:7 5-7:9 " == returnLinks(), Console_WriteValueStdString, "links after delete", returnLinks());
+	line.insertBlanks(StringUtilities_Cell(0), StringUtilities_Cell(3), TextAttributes_Object(), StringUtilities_Cell(9));
+	Console_TestAssertUpdate(result, "6-7:7 8-9:9 " == returnLinks(), Console_WriteValueStdString, "links pushed past limit", returnLinks());
+	
+	// links are copied with the line
+	{
+		TerminalLine_Object		copiedLine(line);
+		
+		
+		Console_TestAssertUpdate(result, 2 == copiedLine.returnExplicitLinks().size(),
+									Console_WriteValue, "copied link count", copiedLine.returnExplicitLinks().size());
+	}
+	
+	// erasing removes links
+	line.fillWith(CFSTR(" "), CFRangeMake(6, 1));
+	Console_TestAssertUpdate(result, "8-9:9 " == returnLinks(), Console_WriteValueStdString, "links after erase", returnLinks());
+	line.structureInitialize();
+	Console_TestAssertUpdate(result, returnLinks().empty() && line.returnScannedLinks().empty() && (false == line.isLinkScanNeeded()),
+								Console_WriteLine, "reset line should have no links");
+	
+	return result;
+}// unitTest002_Begin
+
+
+/*!
+Tests that inline colors move with cells that are inserted
+or deleted, that cells left blank at either end do not keep
+stale colors, and that the color storage is freed once no
+cell uses it.
+
+Returns "true" if ALL assertions pass; "false" is
+returned if any fail, however messages should be
+printed for ALL assertion failures regardless.
+
+(2021.06)
+*/
+Boolean
+unitTest003_Begin ()
+{
+	TerminalLine_Handle				handle;
+	TerminalLine_Object&			line = *handle;
+	TextAttributes_InlineColors		testColors;
+	TextAttributes_InlineColors		noColors;
+	Boolean							result = true;
+	
+	
+	testColors.setForeground(0x12, 0x34, 0x56);
+	testColors.setBackground(0x65, 0x43, 0x21);
+	
+	// color the last two cells before a limit of 10
+	line.returnMutableInlineColorVector()[8] = testColors;
+	line.returnMutableInlineColorVector()[9] = testColors;
+	
+	// deleting shifts colors left and clears the cells at the limit
+	line.deleteRange(StringUtilities_Cell(0), StringUtilities_Cell(1), TextAttributes_Object(), StringUtilities_Cell(10));
+	Console_TestAssertUpdate(result, (testColors == line.returnInlineColorVector()[7]) && (testColors == line.returnInlineColorVector()[8]),
+								Console_WriteLine, "colors did not move with deleted cells");
+	Console_TestAssertUpdate(result, noColors == line.returnInlineColorVector()[9],
+								Console_WriteLine, "cell blanked by delete kept its color");
+	
+	// inserting shifts colors right and clears the inserted cells
+	line.insertBlanks(StringUtilities_Cell(7), StringUtilities_Cell(2), TextAttributes_Object(), StringUtilities_Cell(10));
+	Console_TestAssertUpdate(result, (noColors == line.returnInlineColorVector()[7]) && (noColors == line.returnInlineColorVector()[8]),
+								Console_WriteLine, "inserted cells kept old colors");
+	Console_TestAssertUpdate(result, testColors == line.returnInlineColorVector()[9],
+								Console_WriteLine, "colors did not move with inserted cells");
+	
+	// pushing the last colored cell past the limit frees the colors
+	line.insertBlanks(StringUtilities_Cell(0), StringUtilities_Cell(1), TextAttributes_Object(), StringUtilities_Cell(10));
+	Console_TestAssertUpdate(result, line.returnInlineColorVector().empty(),
+								Console_WriteValue, "colors were not freed; size", line.returnInlineColorVector().size());
+	
+	// erasing part of a line clears only those cells
+	line.returnMutableInlineColorVector()[3] = testColors;
+	line.returnMutableInlineColorVector()[20] = testColors;
+	line.clearInlineColors(15, kTerminalLine_MaximumCharacterCount);
+	Console_TestAssertUpdate(result, (testColors == line.returnInlineColorVector()[3]) && (noColors == line.returnInlineColorVector()[20]),
+								Console_WriteLine, "partial erase cleared the wrong cells");
+	line.clearInlineColors(0, kTerminalLine_MaximumCharacterCount);
+	Console_TestAssertUpdate(result, line.returnInlineColorVector().empty(),
+								Console_WriteValue, "colors of erased line were not freed; size", line.returnInlineColorVector().size());
+	
+	return result;
+}// unitTest003_Begin
+
+} // anonymous namespace
+
 // BELOW IS REQUIRED NEWLINE TO END FILE
@@ -41,6 +41,7 @@
 
 // standard-C++ includes
 #include <list>
+#include <memory>
 #include <vector>
 
 // library includes
@@ -64,6 +65,44 @@ enum
 
 typedef UniChar*								TerminalLine_TextIterator;
 typedef std::vector< TextAttributes_Object >	TerminalLine_TextAttributesList;
+typedef std::vector< TextAttributes_InlineColors >	TerminalLine_InlineColorList;
+
+
+/*!
+A range of cells on a line that is a link.  The meaning of
+the ID depends on the list that the link is in (see
+TerminalLine_LinkInfo).
+*/
+struct TerminalLine_Link
+{
+	UInt16	startColumn;		//!< zero-based column of the first cell of the link
+	UInt16	pastTheEndColumn;	//!< column after the last cell of the link
+	UInt32	linkID;				//!< what the link refers to
+};
+typedef std::vector< TerminalLine_Link >	TerminalLine_LinkList;
+
+
+/*!
+The links of a line, which are only allocated for lines that
+have (or had) links.  Both lists are in column order, and the
+links of a list never overlap.
+
+Explicit links are hyperlinks that an application defined for
+the text that it wrote (with the "OSC 8" sequence); their IDs
+refer to URIs that the terminal remembers.  They move with the
+text when cells are inserted or deleted, and are removed when
+cells are erased or overwritten.
+
+Scanned links are found by scanning the text for URLs; their
+IDs are URL types.  Any change to the text makes them stale
+(see TerminalLine_Object::isLinkScanNeeded()), and they are
+simply replaced after the next scan.
+*/
+struct TerminalLine_LinkInfo
+{
+	TerminalLine_LinkList	explicitLinks;	//!< hyperlinks defined by the application
+	TerminalLine_LinkList	scannedLinks;	//!< links found in the text
+};
 
 
 /*!
@@ -88,6 +127,8 @@ struct TerminalLine_AttributeInfo
 private:
 	TextAttributes_Object				globalAttributes;   //!< attributes that apply to every character (e.g. double-sized text)
 	TerminalLine_TextAttributesList		attributeVector;	//!< where character attributes exist
+	TerminalLine_InlineColorList		inlineColorVector;	//!< empty unless some attributes use inline 24-bit colors;
+															//!  otherwise, one element per attribute element
 };
 
 
@@ -145,6 +186,9 @@ struct TerminalLine_Object
 	void
 	clearAttributes ();
 	
+	void
+	clearInlineColors (UInt16, UInt16);
+	
 	inline void
 	deleteRange (StringUtilities_Cell, StringUtilities_Cell, TextAttributes_Object const&, StringUtilities_Cell);
 	
@@ -157,12 +201,24 @@ struct TerminalLine_Object
 	inline void
 	insertBlanks (StringUtilities_Cell, StringUtilities_Cell, TextAttributes_Object const&, StringUtilities_Cell);
 	
+	inline void
+	invalidateLinkScan ();
+	
+	inline bool
+	isLinkScanNeeded () const;
+	
 	inline TerminalLine_TextAttributesList const&
 	returnAttributeVector () const;
 	
+	inline TerminalLine_InlineColorList const&
+	returnInlineColorVector () const;
+	
 	inline CFStringRef
 	returnCFStringRef() const;
 	
+	TerminalLine_LinkList const&
+	returnExplicitLinks () const;
+	
 	inline TextAttributes_Object
 	returnGlobalAttributes () const;
 	
@@ -172,6 +228,18 @@ struct TerminalLine_Object
 	inline TextAttributes_Object&
 	returnMutableGlobalAttributes ();
 	
+	inline TerminalLine_InlineColorList&
+	returnMutableInlineColorVector ();
+	
+	TerminalLine_LinkList const&
+	returnScannedLinks () const;
+	
+	inline void
+	setLinkForCell (UInt16, UInt32);
+	
+	void
+	setScannedLinks (TerminalLine_LinkList const&);
+	
 	void
 	structureInitialize ();
 
@@ -179,6 +247,8 @@ private:
 	CFRetainRelease					textCFString;		//!< mutable string object for which "textVectorBegin" is the storage,
 														//!  so the buffer can be manipulated directly if desired
 	TerminalLine_AttributeInfo*		attributeInfo;
+	std::unique_ptr< TerminalLine_LinkInfo >	linkInfo;		//!< nullptr unless the line has (or had) links
+	bool							linkScanNeeded;		//!< true if the text changed since the last call to setScannedLinks()
 	
 	void
 	copyAttributes (TerminalLine_AttributeInfo const*);
@@ -186,6 +256,9 @@ private:
 	void
 	createAttributes (TerminalLine_AttributeInfo const*);
 	
+	void
+	eraseExplicitLinks (UInt16, UInt16);
+	
 	bool
 	isSharedAttributeSource (TerminalLine_AttributeInfo const*,
 							 TerminalLine_AttributeInfo** = nullptr) const;
@@ -195,6 +268,12 @@ private:
 	
 	inline TerminalLine_AttributeInfo&
 	returnMutableAttributeInfo ();
+	
+	void
+	setExplicitLink (UInt16, UInt32);
+	
+	void
+	shiftExplicitLinks (UInt16, SInt16, UInt16);
 };
 
 
@@ -253,6 +332,34 @@ private:
 
 
 
+#pragma mark Public Methods
+
+//!\name Module Tests
+//@{
+
+void
+	TerminalLine_RunTests			();
+
+//@}
+
+//!\name Compact Storage
+//@{
+
+// APPENDS; IMAGES, LINKS, SELECTION AND SEARCH HIGHLIGHTING ARE NOT ENCODED
+void
+	TerminalLine_AppendEncoding		(TerminalLine_Object const&		inLine,
+									 std::vector< UInt8 >&			inoutBuffer);
+
+// ADVANCES THE POINTER PAST THE LINE; RETURNS FALSE IF THE DATA IS TRUNCATED OR INVALID
+Boolean
+	TerminalLine_DecodeLine			(UInt8 const*&					inoutBytePtr,
+									 UInt8 const*					inPastEndPtr,
+									 TerminalLine_Handle&			inoutLine);
+
+//@}
+
+
+
 #pragma mark Inline Methods
 
 /*!
@@ -265,7 +372,8 @@ TerminalLine_AttributeInfo::
 TerminalLine_AttributeInfo ()
 :
 globalAttributes(),
-attributeVector(kTerminalLine_MaximumCharacterCount)
+attributeVector(kTerminalLine_MaximumCharacterCount),
+inlineColorVector()
 {
 }// TerminalLine_AttributeInfo constructor
 
@@ -280,7 +388,8 @@ TerminalLine_AttributeInfo::
 TerminalLine_AttributeInfo	(TerminalLine_AttributeInfo const&	inCopy)
 :
 globalAttributes(inCopy.globalAttributes),
-attributeVector(inCopy.attributeVector)
+attributeVector(inCopy.attributeVector),
+inlineColorVector(inCopy.inlineColorVector)
 {
 }// TerminalLine_AttributeInfo copy constructor
 
@@ -370,6 +479,18 @@ deleteRange		(StringUtilities_Cell			inRangeStartCell,
 		std::fill(pastLastRelocatedAttr, pastVisibleEnd, inCopiedAttributes);
 	}
 	
+	// inline colors (if any) must stay in step with attributes;
+	// the new cells do not use them
+	if (false == returnInlineColorVector().empty())
+	{
+		auto	colorsBegin = returnMutableInlineColorVector().begin();
+		
+		
+		std::copy(colorsBegin + (inRangeStartCell + inRangeCellCount).columns_, colorsBegin + inEndLimit.columns_,
+					colorsBegin + inRangeStartCell.columns_);
+		this->clearInlineColors((inEndLimit - inRangeCellCount).columns_, inEndLimit.columns_);
+	}
+	
 #if 1
 	// for now, access buffer directly (this won’t work for
 	// a multi-character fill but this is legacy anyway)
@@ -397,6 +518,10 @@ deleteRange		(StringUtilities_Cell			inRangeStartCell,
 	CFStringInsert(this->textCFString.returnCFMutableStringRef(), endLimitIndex, blankString.returnCFStringRef());
 	CFStringDelete(this->textCFString.returnCFMutableStringRef(), deletedRange);
 #endif
+	
+	// hyperlinks move with the text
+	this->shiftExplicitLinks(inRangeStartCell.columns_, -STATIC_CAST(inRangeCellCount.columns_, SInt16), inEndLimit.columns_);
+	this->invalidateLinkScan();
 }// TerminalLine_Object::deleteRange
 
 
@@ -416,6 +541,9 @@ fillWith	(CFStringRef	inString)
 #else
 	this->fillWith(inString, CFRangeMake(0, CFStringGetLength(this->textCFString.returnCFStringRef())));
 #endif
+	
+	this->eraseExplicitLinks(0, kTerminalLine_MaximumCharacterCount);
+	this->invalidateLinkScan();
 }// fillWith
 
 
@@ -462,6 +590,9 @@ fillWith	(CFStringRef	inString,
 		CFStringReplace(this->textCFString.returnCFMutableStringRef(), fillRange, fillCFString.returnCFStringRef());
 	}
 #endif
+	
+	this->eraseExplicitLinks(STATIC_CAST(fillRange.location, UInt16), STATIC_CAST(fillRange.location + fillRange.length, UInt16));
+	this->invalidateLinkScan();
 }// TerminalLine_Object::fillWith
 
 
@@ -520,6 +651,18 @@ insertBlanks	(StringUtilities_Cell			inRangeStartCell,
 		std::fill(toCursorAttr, toFirstRelocatedAttr, inCopiedAttributes);
 	}
 	
+	// inline colors (if any) must stay in step with attributes;
+	// the new cells do not use them
+	if (false == returnInlineColorVector().empty())
+	{
+		auto	colorsBegin = returnMutableInlineColorVector().begin();
+		
+		
+		std::copy_backward(colorsBegin + inRangeStartCell.columns_, colorsBegin + (inEndLimit - inRangeCellCount).columns_,
+							colorsBegin + inEndLimit.columns_);
+		this->clearInlineColors(inRangeStartCell.columns_, (inRangeStartCell + inRangeCellCount).columns_);
+	}
+	
 #if 1
 	// for now, access buffer directly (this won’t work for
 	// a multi-character fill but this is legacy anyway)
@@ -548,9 +691,44 @@ insertBlanks	(StringUtilities_Cell			inRangeStartCell,
 	CFStringDelete(this->textCFString.returnCFMutableStringRef(), CFRangeMake(endLimitIndex - deletedUniCharCount, deletedUniCharCount));
 	CFStringInsert(this->textCFString.returnCFMutableStringRef(), shiftedRange.location, blankString.returnCFStringRef());
 #endif
+	
+	// hyperlinks move with the text
+	this->shiftExplicitLinks(inRangeStartCell.columns_, STATIC_CAST(inRangeCellCount.columns_, SInt16), inEndLimit.columns_);
+	this->invalidateLinkScan();
 }// TerminalLine_Object::insertBlanks
 
 
+/*!
+Notes that the text has changed, so the links that were
+found by scanning it are stale.  This is done automatically
+by every method that changes text; call it only after
+changing "textVectorBegin" directly.
+
+(2021.06)
+*/
+void
+TerminalLine_Object::
+invalidateLinkScan ()
+{
+	this->linkScanNeeded = true;
+}// TerminalLine_Object::invalidateLinkScan
+
+
+/*!
+Returns true if the text has changed since links were last
+found by scanning it (see setScannedLinks()).
+
+(2021.06)
+*/
+bool
+TerminalLine_Object::
+isLinkScanNeeded ()
+const
+{
+	return this->linkScanNeeded;
+}// TerminalLine_Object::isLinkScanNeeded
+
+
 /*!
 Returns the character-by-character and line-global attributes that
 apply to this screen buffer line.  The data is not guaranteed to be
@@ -584,6 +762,23 @@ const
 }// TerminalLine_Object::returnAttributeVector
 
 
+/*!
+Returns the 24-bit colors of cells whose attributes have
+inline-color bits set (such as "kTextAttributes_ColorIsInlineForeground").
+If the line has never used inline colors, the list is empty;
+otherwise it is the same size as the attribute vector.
+
+(2021.06)
+*/
+TerminalLine_InlineColorList const&
+TerminalLine_Object::
+returnInlineColorVector ()
+const
+{
+	return this->returnAttributeInfo().inlineColorVector;
+}// TerminalLine_Object::returnInlineColorVector
+
+
 /*!
 Returns a Core Foundation string representation of this line.
 
@@ -679,6 +874,56 @@ returnMutableGlobalAttributes ()
 }// TerminalLine_Object::returnMutableGlobalAttributes
 
 
+/*!
+Returns the 24-bit colors of cells, in a form that can be directly
+modified.  This has the same potential side effects as
+returnMutableAttributeInfo(); in addition, the first call for a
+line allocates a color for every cell.  Therefore, only use this
+when a cell is actually being assigned an inline color; lines
+without such colors remain compact.
+
+See also the read-only version, returnInlineColorVector().
+
+(2021.06)
+*/
+TerminalLine_InlineColorList&
+TerminalLine_Object::
+returnMutableInlineColorVector ()
+{
+	TerminalLine_AttributeInfo&		info = this->returnMutableAttributeInfo();
+	
+	
+	if (info.inlineColorVector.empty())
+	{
+		info.inlineColorVector.resize(info.attributeVector.size());
+	}
+	return info.inlineColorVector;
+}// TerminalLine_Object::returnMutableInlineColorVector
+
+
+/*!
+Records that the given cell was just written, as part of
+the hyperlink with the given ID (a URI ID of the terminal),
+or as part of no hyperlink if the ID is 0.  This is called
+for every character that is written, so it is fast when
+the line has no hyperlinks, and when a hyperlink is being
+extended one cell at a time.
+
+(2021.06)
+*/
+void
+TerminalLine_Object::
+setLinkForCell	(UInt16		inColumn,
+				 UInt32		inLinkID)
+{
+	this->invalidateLinkScan();
+	if ((0 != inLinkID) || ((nullptr != this->linkInfo) && (false == this->linkInfo->explicitLinks.empty())))
+	{
+		this->setExplicitLink(inColumn, inLinkID);
+	}
+}// TerminalLine_Object::setLinkForCell
+
+
 /*!
 Returns the line data that this handle refers to.  If the handle
 is in a reset state, the line is blank and the returned pointer
@@ -59,6 +59,7 @@
 #ifdef __OBJC__
 #include <AppKit/AppKit.h>
 #else
+class NSProgress;
 class NSView;
 class NSWindow;
 #endif
@@ -159,7 +160,8 @@ enum TerminalView_MousePointerColor
 };
 
 /*!
-Options for TerminalView_ReturnSelectedTextCopyAsUnicode().
+Options for TerminalView_ReturnSelectedTextCopyAsUnicode()
+and TerminalView_StartSelectedTextExport().
 */
 typedef UInt16 TerminalView_TextFlags;
 enum
@@ -253,6 +255,13 @@ typedef std::pair< TerminalView_Cell, TerminalView_Cell >	TerminalView_CellRange
 
 typedef std::vector< TerminalView_CellRange >				TerminalView_CellRangeList;
 
+/*!
+Called when an export from TerminalView_StartSelectedTextExport()
+ends.  If the text was not completely written (because the
+export was cancelled or failed), the file has been removed.
+*/
+typedef void (^TerminalView_TextExportBlock)(Boolean inIsWritten);
+
 #ifdef __OBJC__
 
 @class TerminalView_Controller;
@@ -287,7 +296,7 @@ mouse-over cursors to be consistent with its behavior.
 	- (void)
 	didReceiveMouseDraggedEvent:(NSEvent*)_
 	forView:(NSView*)_;
-
+	
 	// notification about a mouse-up event in the specified view
 	- (void)
 	didReceiveMouseUpEvent:(NSEvent*)_
@@ -333,29 +342,29 @@ sub-protocol of NSTextInputClient).
 	- (void)
 	receivedControlWithCharacter:(char)_
 	terminalView:(TerminalViewRef)_;
-
+	
 	// user input of delete key (send appropriate sequence to a session)
 	- (void)
 	receivedDeleteBackwardInTerminalView:(TerminalViewRef)_;
-
+	
 	// user input of delete key with option pressed (send appropriate sequence to a session)
 	- (void)
 	receivedDeleteWordBackwardInTerminalView:(TerminalViewRef)_;
-
+	
 	// user input of defined Emacs meta sequence with given character (e.g. 'x' means meta-X)
 	- (void)
 	receivedMetaWithCharacter:(char)_
 	terminalView:(TerminalViewRef)_;
-
+	
 	// user input newline, except control-M goes to "receivedControlCharacter:terminalView:" 
 	- (void)
 	receivedNewlineInTerminalView:(TerminalViewRef)_;
-
+	
 	// generic fallback; process given string as user input (send to a session)
 	- (void)
 	receivedString:(NSString*)_
 	terminalView:(TerminalViewRef)_;
-
+	
 	// user input of special function key (e.g. F1) not covered by normal text or other case above;
 	// if "didHandle:" is set to NO on return, the virtual key is sent to the system handler
 	- (void)
@@ -586,6 +595,14 @@ void
 
 //@}
 
+//!\name Module Tests
+//@{
+
+void
+	TerminalView_RunTests			();
+
+//@}
+
 //!\name Creating and Destroying Terminal Views
 //@{
 
@@ -644,6 +661,11 @@ TerminalView_Result
 	TerminalView_FindVirtualRange				(TerminalViewRef				inView,
 												 TerminalView_CellRange const&	inSelection);
 
+// BLOCKS UNTIL THE GIVEN EXPORT IS WRITTEN; RETURNS false IF IT WAS NOT (OR IS NO LONGER) IN PROGRESS
+Boolean
+	TerminalView_FinishSelectedTextExport		(TerminalViewRef				inView,
+												 NSProgress*					inExportProgress);
+
 void
 	TerminalView_FlashSelection					(TerminalViewRef				inView);
 
@@ -668,7 +690,7 @@ CFStringRef
 CFArrayRef
 	TerminalView_ReturnSelectedImageArrayCopy	(TerminalViewRef				inView);
 
-// INEFFICIENT, USE WITH CARE; LOOK FOR OTHER APIS THAT CAN READ THE SELECTION WITHOUT COPYING IT
+// INEFFICIENT, USE WITH CARE; TO WRITE A LARGE SELECTION, USE TerminalView_StartSelectedTextExport()
 CFStringRef
 	TerminalView_ReturnSelectedTextCopyAsUnicode	(TerminalViewRef				inView,
 													 UInt16							inNumberOfSpacesToReplaceWithOneTabOrZero,
@@ -706,6 +728,14 @@ TerminalView_Result
 	TerminalView_SetTextSelectionRenderingEnabled	(TerminalViewRef			inView,
 												 Boolean						inIsSelectionEnabled);
 
+// WRITES UTF-8 TEXT IN THE BACKGROUND; CANCEL WITH THE RETURNED (PUBLISHED) PROGRESS
+NSProgress*
+	TerminalView_StartSelectedTextExport		(TerminalViewRef				inView,
+												 CFURLRef						inFileURL,
+												 UInt16							inNumberOfSpacesToReplaceWithOneTabOrZero,
+												 TerminalView_TextFlags			inFlags,
+												 TerminalView_TextExportBlock	inCompletionBlock);
+
 Boolean
 	TerminalView_TextSelectionExists			(TerminalViewRef				inView);
 
@@ -805,6 +835,13 @@ void
 	TerminalView_MoveCursorWithArrowKeys		(TerminalViewRef			inView,
 												 CGPoint					inNSViewLocalMouse);
 
+// SHOWS TYPED TEXT BEFORE IT IS ECHOED (E.G. FOR PREDICTIVE LOCAL ECHO); nullptr REMOVES IT
+TerminalView_Result
+	TerminalView_SetPredictedText				(TerminalViewRef			inView,
+												 UInt16						inColumn,
+												 UInt16						inRow,
+												 CFStringRef				inTextOrNull);
+
 //@}
 
 //!\name Metrics
@@ -41,9 +41,16 @@
 // standard-C includes
 #import <algorithm>
 #import <cctype>
+#import <cerrno>
+#import <map>
+#import <memory>
 #import <set>
 #import <vector>
 
+// Unix includes
+#import <fcntl.h>
+#import <unistd.h>
+
 // Mac includes
 #import <ApplicationServices/ApplicationServices.h>
 #import <Carbon/Carbon.h> // TEMPORARY; some legacy types used below (like EventTime)
@@ -52,6 +59,7 @@
 
 // library includes
 #import <AlertMessages.h>
+#import <AsyncWriter.h>
 #import <CFRetainRelease.h>
 #import <CGContextSaveRestore.h>
 #import <CocoaAnimation.h>
@@ -67,6 +75,7 @@
 #import <RegionUtilities.h>
 #import <SoundSystem.h>
 #import <StringUtilities.h>
+#import <TraceSpan.h>
 
 // application includes
 #import "AppResources.h"
@@ -85,9 +94,11 @@
 #import "Terminal.h"
 #import "TerminalGlyphDrawing.objc++.h"
 #import "TerminalWindow.h"
+#import "TextExport.h"
 #import "TextTranslation.h"
 #import "UIStrings.h"
 #import "URL.h"
+#import "WordBoundary.h"
 
 
 
@@ -96,6 +107,11 @@ namespace {
 
 CGFloat const	kMy_LargeIBeamMinimumFontSize = 16.0;					//!< mouse I-beam cursor is 32x32 only if the font is at least this size
 
+size_t const	kMy_ExportChunkSize = 256 * 1024;						//!< exported text is written in pieces of about this many bytes
+size_t const	kMy_ExportBacklogLimit = 16 * kMy_ExportChunkSize;		//!< exports stop reading rows while this much text is waiting for the disk
+SInt64 const	kMy_ExportRowsPerBatch = 2000;							//!< exports read this many rows at a time, between other main-queue events
+UInt64 const	kMy_ExportRetryNanoseconds = 20 * NSEC_PER_MSEC;		//!< delay before an export checks again if the disk has caught up
+
 /*!
 Indices into the "colors" array of the main structure.
 */
@@ -213,6 +229,65 @@ typedef std::vector< CGFloatRGBColor >			My_CGColorList;
 typedef std::map< UInt16, CGFloatRGBColor >		My_CGColorByIndex; // a map is necessary because "vector" cannot handle 256 sequential color structures
 typedef std::vector< NSTimeInterval >			My_TimeIntervalList;
 
+/*!
+Part of the row being drawn that has attributes which are not
+stored in the terminal buffer, such as the text selection or a
+search result (see drawTerminalScreenRunOverlaid()).
+*/
+struct My_RowOverlay
+{
+	UInt16					startColumn;		// first column covered
+	UInt16					pastTheEndColumn;	// column after the last one covered
+	TextAttributes_Object	attributes;			// added to the attributes of each covered cell
+};
+typedef std::vector< My_RowOverlay >		My_RowOverlayList;
+
+typedef std::pair< UInt16, UInt16 >			My_ColumnInterval; // first column, past-the-end column
+typedef std::vector< My_ColumnInterval >	My_ColumnIntervalList; // sorted by first column
+typedef std::map< TerminalView_RowIndex, My_ColumnIntervalList >	My_ColumnIntervalsByRow;
+
+/*!
+A selection that is being written to a file (see
+TerminalView_StartSelectedTextExport()).  Rows are read in
+batches on the main queue, because the terminal buffer can
+only be read there; the text is converted as it is read,
+and written by an Async Writer on its own queue.
+
+The selection range is copied when the export starts, so
+the user can change the selection in the meantime; but the
+rows move whenever the screen scrolls, like the selection.
+
+A view can have several exports at once (for instance, a
+copy that is still being written for the pasteboard, and a
+selection that is being saved), each identified by its
+progress object.  An export that has not ended is always
+owned by its view, which ends the export if the view is
+destroyed; other code
+(such as a block waiting for the disk) only keeps the export
+alive, and ignores it if it has already ended.
+*/
+struct My_SelectionExport
+{
+	My_SelectionExport	(TerminalViewRef, TerminalView_CellRange const&, Boolean);
+	~My_SelectionExport	();
+	
+	TerminalViewRef					view;				// where the rows are read from
+	TerminalView_CellRange			range;				// rows and columns of the selection when the export started
+	TerminalView_RowIndex			nextRow;			// first row that has not been exported yet
+	Boolean							isRectangular;		// copy of the selection mode when the export started
+	Boolean							isFinishing;		// if true, all rows were read, and the writer is being waited for
+	Boolean							isEnded;			// if true, the completion block was called, and the view has let go
+	Boolean							isWritten;			// if true, the whole text was written, so the file is kept
+	CFRetainRelease					fileURL;			// CFURLRef; where the text is written
+	int								fileDescriptor;		// open file, or -1
+	AsyncWriter_Ref					writer;				// writes to "fileDescriptor" in the background
+	TextExport_Ref					textExport;			// converts rows into chunks for "writer"
+	NSProgress* __strong			progress;			// published progress, in rows; can be cancelled by the user
+	TerminalView_TextExportBlock	completionBlock;	// called once, when the export ends
+};
+typedef std::shared_ptr< My_SelectionExport >	My_SelectionExportPtr;
+typedef std::vector< My_SelectionExportPtr >	My_SelectionExportList;
+
 class My_XTerm256Table;
 
 // TEMPORARY: This structure is transitioning to C++, and so initialization
@@ -292,6 +367,13 @@ struct My_TerminalView
 			Boolean				isCustomColor;	// if true, the cursor color is set by the user instead of being inherited from the screen
 		} cursor;
 		
+		struct
+		{
+			CFRetainRelease		text;		// if defined, typed characters that have not been echoed yet (see TerminalView_SetPredictedText())
+			UInt16				column;		// zero-based column of the first character of "text"
+			UInt16				row;		// zero-based row of "text", in the same coordinates as the cursor
+		} prediction;
+		
 		struct
 		{
 			TerminalView_MousePointerColor	pointerColor;	// customize appearance of mouse cursors (I-beam, etc.)
@@ -303,6 +385,7 @@ TerminalView_RowIndex	topVisibleEdgeInRows;	// 0 if scrolled to the main screen,
 													//   do not change this value directly, use offsetLeftVisibleEdge()
 TerminalView_RowIndex	currentRenderedLine;	// only defined while drawing; the row that is currently being drawn
 		Boolean			currentRenderBlinking;		// only defined while drawing; if true, at least one section is blinking
+		My_RowOverlayList	currentRenderOverlays;	// only defined while drawing; parts of the current row with extra attributes
 		Boolean			currentRenderDragColors;	// only defined while drawing; if true, drag highlight text colors are used
 		Boolean			currentRenderNoBackground;	// only defined while drawing; if true, text is using the ordinary background color
 		CGContextRef	currentRenderContext;		// only defined while drawing; if not nullptr, the context from the view draw event
@@ -330,6 +413,7 @@ TerminalView_RowIndex	currentRenderedLine;	// only defined while drawing; the ro
 	struct
 	{
 		TextAttributes_Object			attributes;		// current text attribute flags, affecting color of terminal text, etc.
+		TextAttributes_InlineColors		inlineColors;	// 24-bit colors for parts of "attributes" that set an inline-color bit
 		NSMutableDictionary* __strong	attributeDict;	// most recent equivalent attributed-string attributes (e.g. fonts, colors)
 		
 		struct
@@ -361,12 +445,19 @@ TerminalView_PixelHeight	heightPerCell;	// number of pixels high each character
 			TerminalView_Cell			clickCell;		// for extending selections with the mouse
 			My_SelectionMode			keyboardMode;	// used for keyboard navigation; determines what is changed by keyboard-select actions
 			Boolean						isRectangular;	// is the text selection unattached from the left and right screen edges?
+			Boolean						isHighlighted;	// is the range drawn as selected? (applied only when rows are drawn; see getSelectedColumnsInRow())
 			Boolean						readOnly;		// does the view respond to clicks and keystrokes that affect text selections?
 			Boolean						inhibited;		// does the view refuse to highlight or manage selections even when API calls are made?
 		} selection;
 		
 		TerminalView_CellRangeList				searchResults;			// regions matching the most recent Find results
+		My_ColumnIntervalsByRow					searchResultsByRow;		// the same regions, indexed by row for drawing; MUST change if "searchResults" changes;
+																		// keys do not change when the text scrolls (see "searchResultsRowOffset")
+		TerminalView_RowIndex					searchResultsRowOffset;	// added to each key of "searchResultsByRow" to find the current row of its regions
 		TerminalView_CellRangeList::iterator	toCurrentSearchResult;	// most recently focused match; MUST change if "searchResults" changes
+		TerminalView_CellRange					hoveredLink;			// link under the mouse while the key to open links is down (it is underlined);
+																		// the range is empty if there is none
+		My_SelectionExportList					selectionExports;		// selected text that is being written to files, in the order the exports started
 	} text;
 };
 typedef My_TerminalView*		My_TerminalViewPtr;
@@ -407,8 +498,10 @@ Boolean				addDataSource						(My_TerminalViewPtr, TerminalScreenRef);
 void				animateBlinkingItems				(NSTimer*, TerminalViewRef);
 void				audioEvent							(ListenerModel_Ref, ListenerModel_Event, void*, void*);
 NSTimeInterval		calculateAnimationStageDelay		(My_TerminalViewPtr, My_TimeIntervalList::size_type);
+void				continueSelectionExport				(TerminalViewRef, std::weak_ptr< My_SelectionExport >);
 UInt16				copyColorPreferences				(My_TerminalViewPtr, Preferences_ContextRef, Boolean);
 UInt16				copyFontPreferences					(My_TerminalViewPtr, Preferences_ContextRef, Boolean);
+Boolean				copyLinkAtCell						(My_TerminalViewPtr, TerminalView_Cell const&, TerminalView_CellRange&, CFStringRef&);
 void				copySelectedTextIfUserPreference	(My_TerminalViewPtr);
 void				copyTranslationPreferences			(My_TerminalViewPtr, Preferences_ContextRef);
 Boolean				createWindowColorPalette			(My_TerminalViewPtr, Preferences_ContextRef, Boolean = true);
@@ -422,13 +515,19 @@ void				drawSingleColorImage				(CGContextRef, CGColorRef, CGRect, id);
 void				drawSingleColorPattern				(CGContextRef, CGColorRef, CGRect, id);
 Boolean				drawSection							(My_TerminalViewPtr, CGContextRef, UInt16, TerminalView_RowIndex,
 														 UInt16, TerminalView_RowIndex);
-void				drawTerminalScreenRunOp				(My_TerminalViewPtr, UInt16, CFStringRef, UInt16, TextAttributes_Object);
+void				drawTerminalScreenRunOp				(My_TerminalViewPtr, UInt16, CFStringRef, UInt16, TextAttributes_Object,
+														 TextAttributes_InlineColors const&);
+void				drawTerminalScreenRunOverlaid		(My_TerminalViewPtr, UInt16, CFStringRef, UInt16, TextAttributes_Object,
+														 TextAttributes_InlineColors const&);
 void				drawTerminalText					(My_TerminalViewPtr, CGContextRef, CGRect const&, CFIndex,
 														 CFStringRef, TextAttributes_Object);
 void				drawVTGraphicsGlyph					(My_TerminalViewPtr, CGContextRef, CGRect const&, UnicodeScalarValue,
 														 CGFloat, TextAttributes_Object);
+void				endSelectionExport					(My_TerminalViewPtr, My_SelectionExportPtr, Boolean);
 void				eraseSection						(My_TerminalViewPtr, CGContextRef, SInt16, SInt16, CGRect&);
 void				eventNotifyForView					(My_TerminalViewConstPtr, TerminalView_Event, void*);
+Boolean				exportSelectedRows					(My_TerminalViewPtr, TerminalView_CellRange const&, Boolean,
+														 TerminalView_RowIndex, TerminalView_RowIndex&, TextExport_Ref);
 Terminal_LineRef	findRowIterator						(My_TerminalViewPtr, TerminalView_RowIndex, Terminal_LineStackStorage*);
 Terminal_LineRef	findRowIteratorRelativeTo			(My_TerminalViewPtr, TerminalView_RowIndex, TerminalView_RowIndex,
 														 Terminal_LineStackStorage*);
@@ -439,9 +538,11 @@ void				getRowBounds						(My_TerminalViewPtr, TerminalView_RowIndex, CGRect&);
 TerminalView_PixelWidth		getRowCharacterWidth		(My_TerminalViewPtr, TerminalView_RowIndex);
 void				getRowSectionBounds					(My_TerminalViewPtr, TerminalView_RowIndex, UInt16, SInt16, CGRect&);
 void				getScreenBaseColor					(My_TerminalViewPtr, TerminalView_ColorIndex, CGFloatRGBColor*);
-void				getScreenColorsForAttributes		(My_TerminalViewPtr, TextAttributes_Object, CGFloatRGBColor*, CGFloatRGBColor*, Boolean*);
+void				getScreenColorsForAttributes		(My_TerminalViewPtr, TextAttributes_Object, TextAttributes_InlineColors const&,
+														 CGFloatRGBColor*, CGFloatRGBColor*, Boolean*);
 Boolean				getScreenCoreColor					(My_TerminalViewPtr, UInt16, CGFloatRGBColor*);
 void				getScreenCustomColor				(My_TerminalViewPtr, TerminalView_ColorIndex, CGFloatRGBColor*);
+Boolean				getSelectedColumnsInRow				(My_TerminalViewPtr, TerminalView_RowIndex, UInt16&, UInt16&);
 HIShapeRef			getSelectedTextAsNewHIShape			(My_TerminalViewPtr, Float32 = 0.0);
 size_t				getSelectedTextSize					(My_TerminalViewPtr);
 HIShapeRef			getVirtualRangeAsNewHIShape			(My_TerminalViewPtr, TerminalView_Cell const&, TerminalView_Cell const&,
@@ -449,9 +550,9 @@ HIShapeRef			getVirtualRangeAsNewHIShape			(My_TerminalViewPtr, TerminalView_Cel
 void				getVirtualVisibleRegion				(My_TerminalViewPtr, UInt16*, TerminalView_RowIndex*, UInt16*, TerminalView_RowIndex*);
 void				handleMultiClick					(My_TerminalViewPtr, UInt16);
 void				highlightCurrentSelection			(My_TerminalViewPtr, Boolean, Boolean);
-void				highlightVirtualRange				(My_TerminalViewPtr, TerminalView_CellRange const&, TextAttributes_Object,
-														 Boolean, Boolean);
+void				indexSearchResult					(My_TerminalViewPtr, TerminalView_CellRange const&);
 void				invalidateRowSection				(My_TerminalViewPtr, TerminalView_RowIndex, UInt16, UInt16);
+void				invalidateVirtualRange				(My_TerminalViewPtr, TerminalView_CellRange const&);
 Boolean				isSmallIBeam						(My_TerminalViewPtr);
 TerminalView_MousePointerColor	mousePointerColor		(My_TerminalViewPtr);
 void				offsetLeftVisibleEdge				(My_TerminalViewPtr, SInt16);
@@ -465,6 +566,8 @@ void				receiveVideoModeChange				(ListenerModel_Ref, ListenerModel_Event, void*
 void				releaseRowIterator					(My_TerminalViewPtr, Terminal_LineRef*);
 Boolean				removeDataSource					(My_TerminalViewPtr, TerminalScreenRef);
 CFStringRef			returnSelectedTextCopyAsUnicode		(My_TerminalViewPtr, UInt16, TerminalView_TextFlags);
+My_SelectionExportPtr	returnSelectionExport			(My_TerminalViewPtr, NSProgress*);
+TextExport_Options	returnTextExportOptions				(TerminalView_TextFlags);
 void				screenBufferChanged					(ListenerModel_Ref, ListenerModel_Event, void*, void*);
 void				screenCursorChanged					(ListenerModel_Ref, ListenerModel_Event, void*, void*);
 Boolean				selectionExists						(My_TerminalViewPtr);
@@ -479,13 +582,19 @@ void				setScreenCustomColor				(My_TerminalViewPtr, TerminalView_ColorIndex, CG
 void				setTextAttributesDictionary			(My_TerminalViewPtr, NSMutableDictionary*, TextAttributes_Object, Boolean = false);
 void				setUpCursorBounds					(My_TerminalViewPtr, SInt16, SInt16, CGRect*, HIMutableShapeRef);
 void				setUpScreenFontMetrics				(My_TerminalViewPtr);
+Boolean				shiftSearchResults					(TerminalView_CellRangeList&, TerminalView_CellRangeList::iterator&, SInt16,
+														 TerminalView_RowIndex, TerminalView_RowIndex, TerminalView_CellRangeList* = nullptr);
 void				sortAnchors							(TerminalView_Cell&, TerminalView_Cell&, Boolean);
 Boolean				startMonitoringDataSource			(My_TerminalViewPtr, TerminalScreenRef);
 Boolean				stopMonitoringDataSource			(My_TerminalViewPtr, TerminalScreenRef);
+void				unindexSearchResult					(My_TerminalViewPtr, TerminalView_CellRange const&);
+Boolean				unitTest_ShiftSearchResults_000		();
 void				updateDisplay						(My_TerminalViewPtr);
 void				updateDisplayInShape				(My_TerminalViewPtr, HIShapeRef);
 OSStatus			updateDisplayInShapeSubRect			(int, HIShapeRef, CGRect const*, void*);
-void				useTerminalTextColors				(My_TerminalViewPtr, CGContextRef, TextAttributes_Object, Boolean, Float32 = 1.0);
+void				updateHoveredLink					(My_TerminalViewPtr, NSPoint, NSEventModifierFlags);
+void				useTerminalTextColors				(My_TerminalViewPtr, CGContextRef, TextAttributes_Object, TextAttributes_InlineColors const&,
+														 Boolean, Float32 = 1.0);
 void				visualBell							(My_TerminalViewPtr);
 
 } // anonymous namespace
@@ -762,6 +871,29 @@ TerminalView_Done ()
 }// Done
 
 
+/*!
+A unit test for this module.  This should always
+be run before a release, after any substantial
+changes are made, or if you suspect bugs!  It
+should also be EXPANDED as new functionality is
+proposed (ideally, a test is written before the
+functionality is added).
+
+(2021.06)
+*/
+void
+TerminalView_RunTests ()
+{
+	UInt16		totalTests = 0;
+	UInt16		failedTests = 0;
+	
+	
+	++totalTests; if (false == unitTest_ShiftSearchResults_000()) ++failedTests;
+	
+	Console_WriteUnitTestReport("Terminal View", failedTests, totalTests);
+}// RunTests
+
+
 /*!
 Creates a new NSView* hierarchy for a terminal view, complete
 with all the methods and data necessary to drive it.  The
@@ -1221,28 +1353,31 @@ TerminalView_DisplaySaveSelectionUI		(TerminalViewRef	inView)
 						{
 							if (NSModalResponseOK == aReturnCode)
 							{
-								CFRetainRelease		textSelection(TerminalView_ReturnSelectedTextCopyAsUnicode
-																	(inView, 0/* spaces equal to one tab, or zero for no substitution */,
-																		kTerminalView_TextFlagLineSeparatorLF |
-																		kTerminalView_TextFlagLastLineHasSeparator),
-																	CFRetainRelease::kAlreadyRetained);
+								// the text is written in the background, so that a large
+								// selection does not stop the application; the progress
+								// is published for the file, where it can be cancelled;
+								// an export of a copied selection for the pasteboard
+								// (if any) continues alongside this one
+								__block NSProgress*		exportProgress = nil;
 								
 								
-								if (textSelection.exists())
+								exportProgress = TerminalView_StartSelectedTextExport
+													(inView, BRIDGE_CAST(savePanel.URL, CFURLRef),
+														0/* spaces equal to one tab, or zero for no substitution */,
+														kTerminalView_TextFlagLineSeparatorLF |
+														kTerminalView_TextFlagLastLineHasSeparator,
+														^(Boolean inIsWritten)
+														{
+															if ((false == inIsWritten) && (NO == exportProgress.cancelled))
+															{
+																Sound_StandardAlert();
+															}
+															exportProgress = nil;
+														});
+								if (nil == exportProgress)
 								{
-									NSString*	asNSString = BRIDGE_CAST
-																(textSelection.returnCFStringRef(), NSString*);
-									NSError*	error = nil;
-									
-									
-									if (NO == [asNSString writeToURL:savePanel.URL atomically:YES
-															encoding:NSUTF8StringEncoding error:&error])
-									{
-										Sound_StandardAlert();
-										Console_Warning(Console_WriteValueCFString,
-														"failed to save selected text to file, error",
-														BRIDGE_CAST([error localizedDescription], CFStringRef));
-									}
+									Sound_StandardAlert();
+									Console_Warning(Console_WriteLine, "failed to start saving selected text to file");
 								}
 							}
 						}];
@@ -1280,16 +1415,15 @@ TerminalView_FindNothing	(TerminalViewRef	inView)
 		Boolean const	kWasCleared = viewPtr->text.searchResults.empty();
 		
 		
-		for (auto cellRange : viewPtr->text.searchResults)
-		{
-			highlightVirtualRange(viewPtr, cellRange, kTextAttributes_SearchHighlight,
-									false/* is highlighted */, true/* redraw */);
-		}
 		viewPtr->text.searchResults.clear();
+		viewPtr->text.searchResultsByRow.clear();
+		viewPtr->text.searchResultsRowOffset = 0;
 		viewPtr->text.toCurrentSearchResult = viewPtr->text.searchResults.end();
 		
 		if (false == kWasCleared)
 		{
+			// results are only drawn, so only the visible rows are affected
+			updateDisplay(viewPtr);
 			eventNotifyForView(viewPtr, kTerminalView_EventSearchResultsExistence, inView/* context */);
 		}
 	}
@@ -1341,9 +1475,8 @@ TerminalView_FindVirtualRange	(TerminalViewRef				inView,
 		viewPtr->text.searchResults.push_back(inSelection);
 		assert(false == viewPtr->text.searchResults.empty());
 		viewPtr->text.toCurrentSearchResult = viewPtr->text.searchResults.begin();
-		highlightVirtualRange(viewPtr, viewPtr->text.searchResults.back(),
-								kTextAttributes_SearchHighlight,
-								true/* is highlighted */, true/* redraw */);
+		indexSearchResult(viewPtr, inSelection);
+		invalidateVirtualRange(viewPtr, inSelection);
 		
 		// TEMPORARY - efficiency may demand a unique type of event for this
 		eventNotifyForView(viewPtr, kTerminalView_EventScrolling, inView/* context */);
@@ -1357,6 +1490,59 @@ TerminalView_FindVirtualRange	(TerminalViewRef				inView,
 }// FindVirtualRange
   
   
+/*!
+Finishes an export started by TerminalView_StartSelectedTextExport()
+right away: all remaining rows are read, and this call blocks until
+the text has been written to the file.  The completion block of the
+export is called before this returns.
+
+This is for callers that need the file immediately (such as a
+pasteboard that is asked for promised data); otherwise, let the
+export finish in the background.
+
+Returns true only if the given export was in progress and the
+whole text was written.
+
+(2021.06)
+*/
+Boolean
+TerminalView_FinishSelectedTextExport	(TerminalViewRef	inView,
+										 NSProgress*		inExportProgress)
+{
+	My_TerminalViewAutoLocker	viewPtr(gTerminalViewPtrLocks(), inView);
+	My_SelectionExportPtr		exportPtr = returnSelectionExport(viewPtr, inExportProgress);
+	Boolean						result = false;
+	
+	
+	if (nullptr != exportPtr)
+	{
+		Boolean		isComplete = true;
+		
+		
+		unless (exportPtr->isFinishing)
+		{
+			isComplete = exportSelectedRows(viewPtr, exportPtr->range, exportPtr->isRectangular, exportPtr->range.second.second,
+											exportPtr->nextRow, exportPtr->textExport);
+			if (isComplete)
+			{
+				UNUSED_RETURN(TextExport_Result)TextExport_Finish(exportPtr->textExport);
+				exportPtr->isFinishing = true;
+			}
+		}
+		
+		// if a background queue is also waiting, it will find that
+		// the export has already ended
+		if (isComplete)
+		{
+			AsyncWriter_WaitUntilWritten(exportPtr->writer);
+		}
+		endSelectionExport(viewPtr, exportPtr, isComplete);
+		result = exportPtr->isWritten;
+	}
+	return result;
+}// FinishSelectedTextExport
+
+
 /*!
 Flashes the selected text, to indicate that it has
 been accepted for a 'GURL' event.
@@ -3280,6 +3466,75 @@ TerminalView_SetFontAndSize		(TerminalViewRef	inView,
 }// SetFontAndSize
 
 
+/*!
+Displays text that is expected to appear soon (such as typed
+characters that the remote host has not echoed yet) over the
+given cells, underlined to show that it is not real output.
+The text replaces any previous prediction; pass nullptr to
+remove it.  Only the affected cells are redrawn, and nothing
+is redrawn if the prediction has not changed.
+
+The location uses the same coordinates as the terminal
+cursor (see Terminal_CursorGetLocation()), and the text
+should fit on that row.
+
+\retval kTerminalView_ResultOK
+if no error occurred
+
+\retval kTerminalView_ResultInvalidID
+if the specified view reference is not valid
+
+(2021.06)
+*/
+TerminalView_Result
+TerminalView_SetPredictedText	(TerminalViewRef	inView,
+								 UInt16				inColumn,
+								 UInt16				inRow,
+								 CFStringRef		inTextOrNull)
+{
+	My_TerminalViewAutoLocker	viewPtr(gTerminalViewPtrLocks(), inView);
+	TerminalView_Result			result = kTerminalView_ResultOK;
+	
+	
+	if (nullptr == viewPtr) result = kTerminalView_ResultInvalidID;
+	else
+	{
+		CFStringRef		oldText = viewPtr->screen.prediction.text.returnCFStringRef();
+		Boolean			isChanged = true;
+		
+		
+		if ((nullptr == oldText) || (nullptr == inTextOrNull))
+		{
+			isChanged = (oldText != inTextOrNull);
+		}
+		else
+		{
+			isChanged = ((inColumn != viewPtr->screen.prediction.column) || (inRow != viewPtr->screen.prediction.row) ||
+							(kCFCompareEqualTo != CFStringCompare(oldText, inTextOrNull, 0/* options */)));
+		}
+		
+		if (isChanged)
+		{
+			// redraw the cells that had the old prediction, and the cells of the new one
+			if (nullptr != oldText)
+			{
+				invalidateRowSection(viewPtr, viewPtr->screen.prediction.row, viewPtr->screen.prediction.column,
+										STATIC_CAST(CFStringGetLength(oldText), UInt16));
+			}
+			viewPtr->screen.prediction.text = CFRetainRelease(inTextOrNull, CFRetainRelease::kNotYetRetained);
+			viewPtr->screen.prediction.column = inColumn;
+			viewPtr->screen.prediction.row = inRow;
+			if (nullptr != inTextOrNull)
+			{
+				invalidateRowSection(viewPtr, inRow, inColumn, STATIC_CAST(CFStringGetLength(inTextOrNull), UInt16));
+			}
+		}
+	}
+	
+	return result;
+}// SetPredictedText
+
+
 /*!
 Specifies whether or not a resize of the view will cause the
 underlying terminal buffer’s screen dimensions to change (to
@@ -3443,6 +3698,113 @@ TerminalView_StartMonitoring	(TerminalViewRef			inView,
 }// StartMonitoring
 
 
+/*!
+Starts writing the selected text to the given file, as UTF-8,
+and returns immediately; rows are read in batches between other
+events, and the text is written in the background, so that even
+a selection of a huge scrollback does not stop the application.
+
+The text is the same as TerminalView_ReturnSelectedTextCopyAsUnicode()
+would return for the given options, at the time the export
+started; changing the selection does not affect the export.  If
+rows are removed from the scrollback before they are read, the
+export ends early.
+
+The file is created (or replaced).  When the export ends, the
+completion block is called on the main queue.  A view can have
+more than one export in progress (such as a copy that is still
+being written for the pasteboard, and a save); each one reads
+its rows in turn, and destroying the view cancels all of them.
+
+The returned progress object counts rows, and is published for
+the file so that the system can display it; cancelling it stops
+the export (and removes the file).  Returns nil if the export
+could not be started (for instance, if there is no selection).
+
+(2021.06)
+*/
+NSProgress*
+TerminalView_StartSelectedTextExport	(TerminalViewRef				inView,
+										 CFURLRef						inFileURL,
+										 UInt16							inMaxSpacesToReplaceWithTabOrZero,
+										 TerminalView_TextFlags			inFlags,
+										 TerminalView_TextExportBlock	inCompletionBlock)
+{
+	My_TerminalViewAutoLocker	viewPtr(gTerminalViewPtrLocks(), inView);
+	NSProgress*					result = nil;
+	
+	
+	if ((nullptr != viewPtr) && (nullptr != inFileURL) && (nil != inCompletionBlock) &&
+		selectionExists(viewPtr))
+	{
+		try
+		{
+			NSURL*						asNSURL = BRIDGE_CAST(inFileURL, NSURL*);
+			My_SelectionExportPtr		exportPtr = std::make_shared< My_SelectionExport >(inView, viewPtr->text.selection.range,
+																							viewPtr->text.selection.isRectangular);
+			
+			
+			exportPtr->fileDescriptor = open(asNSURL.fileSystemRepresentation, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+			if (exportPtr->fileDescriptor < 0)
+			{
+				Console_Warning(Console_WriteValue, "failed to open file for exported text, errno", errno);
+			}
+			else
+			{
+				// (the URL is only set once the file is opened, because
+				// the file is removed if the text is not written)
+				exportPtr->fileURL.setWithRetain(inFileURL);
+				exportPtr->writer = AsyncWriter_New(exportPtr->fileDescriptor, kMy_ExportBacklogLimit, "net.macterm.queues.textexport");
+				if (nullptr != exportPtr->writer)
+				{
+					AsyncWriter_Ref		writer = exportPtr->writer;
+					
+					
+					exportPtr->textExport = TextExport_New(returnTextExportOptions(inFlags), inMaxSpacesToReplaceWithTabOrZero, kMy_ExportChunkSize,
+															[writer] (AsyncWriter_Buffer inChunk)
+															{
+																UNUSED_RETURN(AsyncWriter_Result)AsyncWriter_Enqueue(writer, inChunk);
+															});
+				}
+				
+				if (nullptr == exportPtr->textExport)
+				{
+					Console_Warning(Console_WriteLine, "failed to create writer for exported text");
+					
+					// the destructor closes and removes the file
+				}
+				else
+				{
+					std::weak_ptr< My_SelectionExport >		weakExport = exportPtr;
+					
+					
+					exportPtr->progress = [NSProgress discreteProgressWithTotalUnitCount:(exportPtr->range.second.second - exportPtr->range.first.second)];
+					exportPtr->progress.kind = NSProgressKindFile;
+					exportPtr->progress.fileURL = asNSURL;
+					exportPtr->progress.cancellable = YES;
+					[exportPtr->progress publish];
+					exportPtr->completionBlock = inCompletionBlock;
+					
+					viewPtr->text.selectionExports.push_back(exportPtr);
+					result = exportPtr->progress;
+					
+					// rows are read between other events on the main queue
+					dispatch_async(dispatch_get_main_queue(),
+					^{
+						continueSelectionExport(inView, weakExport);
+					});
+				}
+			}
+		}
+		catch (std::bad_alloc)
+		{
+			Console_Warning(Console_WriteLine, "not enough memory to export selected text");
+		}
+	}
+	return result;
+}// StartSelectedTextExport
+
+
 /*!
 Arranges for a callback to no longer be invoked whenever an
 event occurs for a view (such as scrolling).
@@ -3742,6 +4104,65 @@ setColor	(UInt8		inIndex,
 }// My_XTerm256Table::setColor
 
 
+/*!
+Constructor.  See TerminalView_StartSelectedTextExport().
+
+(2021.06)
+*/
+My_SelectionExport::
+My_SelectionExport	(TerminalViewRef				inView,
+					 TerminalView_CellRange const&	inSelection,
+					 Boolean						inIsRectangular)
+:
+// IMPORTANT: THESE ARE EXECUTED IN THE ORDER MEMBERS APPEAR IN THE CLASS.
+view(inView),
+range(inSelection),
+nextRow(inSelection.first.second),
+isRectangular(inIsRectangular),
+isFinishing(false),
+isEnded(false),
+isWritten(false),
+fileURL(),
+fileDescriptor(-1),
+writer(nullptr),
+textExport(nullptr),
+progress(nil),
+completionBlock(nil)
+{
+}// My_SelectionExport 3-argument constructor
+
+
+/*!
+Destructor.  Closes the file, and removes it unless the
+whole text was written.
+
+This can run on a background queue (the last reference
+may be held by a block that waited for the writer).
+
+(2021.06)
+*/
+My_SelectionExport::
+~My_SelectionExport ()
+{
+	// the text export refers to the writer, so it goes first
+	TextExport_Dispose(&this->textExport);
+	AsyncWriter_Dispose(&this->writer);
+	if (this->fileDescriptor >= 0)
+	{
+		if (0 != close(this->fileDescriptor))
+		{
+			Console_Warning(Console_WriteValue, "failed to close file of exported text, errno", errno);
+		}
+		this->fileDescriptor = -1;
+	}
+	if ((false == this->isWritten) && this->fileURL.exists())
+	{
+		UNUSED_RETURN(BOOL)[[NSFileManager defaultManager] removeItemAtURL:BRIDGE_CAST(this->fileURL.returnCFURLRef(), NSURL*)
+																	error:nil];
+	}
+}// My_SelectionExport destructor
+
+
 /*!
 Constructor for Cocoa windows.
 
@@ -3817,7 +4238,7 @@ initialize		(TerminalScreenRef			inScreenDataSource,
 		
 		
 		if (kPreferences_ResultOK !=
-			Preferences_GetData(kPreferences_TagTerminalResizeAffectsFontSize, sizeof(affectsFontSize), &affectsFontSize))
+			Preferences_GetValue< kPreferences_TagTerminalResizeAffectsFontSize >(affectsFontSize))
 		{
 			// assume a default, if the value cannot be found...
 			affectsFontSize = false;
@@ -3840,6 +4261,7 @@ initialize		(TerminalScreenRef			inScreenDataSource,
 	this->text.selection.range.second.second = 0;
 	this->text.selection.keyboardMode = kMy_SelectionModeUnset;
 	this->text.selection.isRectangular = false;
+	this->text.selection.isHighlighted = false;
 	this->text.selection.readOnly = false;
 	this->text.selection.inhibited = false;
 	this->screen.leftVisibleEdgeInColumns = 0;
@@ -3856,9 +4278,13 @@ initialize		(TerminalScreenRef			inScreenDataSource,
 	this->screen.cursor.updatedShape = HIShapeCreateMutable();
 	this->screen.cursor.inhibited = false;
 	this->screen.cursor.isCustomColor = false;
+	this->screen.prediction.column = 0;
+	this->screen.prediction.row = 0;
 	this->screen.mouse.pointerColor = kTerminalView_MousePointerColorRed; // set later
 	this->screen.currentRenderContext = nullptr;
 	this->text.toCurrentSearchResult = this->text.searchResults.end();
+	this->text.searchResultsRowOffset = 0;
+	this->text.hoveredLink = TerminalView_CellRange(TerminalView_Cell(0, 0), TerminalView_Cell(0, 0));
 	
 	// read user preferences for the spacing around the edges
 	{
@@ -3867,45 +4293,37 @@ initialize		(TerminalScreenRef			inScreenDataSource,
 		
 		
 		// margins
-		preferencesResult = Preferences_ContextGetData(inFormat, kPreferences_TagTerminalMarginLeft,
-														sizeof(preferenceFloatValue), &preferenceFloatValue,
+		preferencesResult = Preferences_ContextGetValue< kPreferences_TagTerminalMarginLeft >(inFormat, preferenceFloatValue,
 														true/* search defaults too */);
 		assert(kPreferences_ResultOK == preferencesResult);
 		this->screen.marginLeftEmScale = preferenceFloatValue;
-		preferencesResult = Preferences_ContextGetData(inFormat, kPreferences_TagTerminalMarginRight,
-														sizeof(preferenceFloatValue), &preferenceFloatValue,
+		preferencesResult = Preferences_ContextGetValue< kPreferences_TagTerminalMarginRight >(inFormat, preferenceFloatValue,
 														true/* search defaults too */);
 		assert(kPreferences_ResultOK == preferencesResult);
 		this->screen.marginRightEmScale = preferenceFloatValue;
-		preferencesResult = Preferences_ContextGetData(inFormat, kPreferences_TagTerminalMarginTop,
-														sizeof(preferenceFloatValue), &preferenceFloatValue,
+		preferencesResult = Preferences_ContextGetValue< kPreferences_TagTerminalMarginTop >(inFormat, preferenceFloatValue,
 														true/* search defaults too */);
 		assert(kPreferences_ResultOK == preferencesResult);
 		this->screen.marginTopEmScale = preferenceFloatValue;
-		preferencesResult = Preferences_ContextGetData(inFormat, kPreferences_TagTerminalMarginBottom,
-														sizeof(preferenceFloatValue), &preferenceFloatValue,
+		preferencesResult = Preferences_ContextGetValue< kPreferences_TagTerminalMarginBottom >(inFormat, preferenceFloatValue,
 														true/* search defaults too */);
 		assert(kPreferences_ResultOK == preferencesResult);
 		this->screen.marginBottomEmScale = preferenceFloatValue;
 		
 		// paddings
-		preferencesResult = Preferences_ContextGetData(inFormat, kPreferences_TagTerminalPaddingLeft,
-														sizeof(preferenceFloatValue), &preferenceFloatValue,
+		preferencesResult = Preferences_ContextGetValue< kPreferences_TagTerminalPaddingLeft >(inFormat, preferenceFloatValue,
 														true/* search defaults too */);
 		assert(kPreferences_ResultOK == preferencesResult);
 		this->screen.paddingLeftEmScale = preferenceFloatValue;
-		preferencesResult = Preferences_ContextGetData(inFormat, kPreferences_TagTerminalPaddingRight,
-														sizeof(preferenceFloatValue), &preferenceFloatValue,
+		preferencesResult = Preferences_ContextGetValue< kPreferences_TagTerminalPaddingRight >(inFormat, preferenceFloatValue,
 														true/* search defaults too */);
 		assert(kPreferences_ResultOK == preferencesResult);
 		this->screen.paddingRightEmScale = preferenceFloatValue;
-		preferencesResult = Preferences_ContextGetData(inFormat, kPreferences_TagTerminalPaddingTop,
-														sizeof(preferenceFloatValue), &preferenceFloatValue,
+		preferencesResult = Preferences_ContextGetValue< kPreferences_TagTerminalPaddingTop >(inFormat, preferenceFloatValue,
 														true/* search defaults too */);
 		assert(kPreferences_ResultOK == preferencesResult);
 		this->screen.paddingTopEmScale = preferenceFloatValue;
-		preferencesResult = Preferences_ContextGetData(inFormat, kPreferences_TagTerminalPaddingBottom,
-														sizeof(preferenceFloatValue), &preferenceFloatValue,
+		preferencesResult = Preferences_ContextGetValue< kPreferences_TagTerminalPaddingBottom >(inFormat, preferenceFloatValue,
 														true/* search defaults too */);
 		assert(kPreferences_ResultOK == preferencesResult);
 		this->screen.paddingBottomEmScale = preferenceFloatValue;
@@ -4021,6 +4439,14 @@ Destructor.
 My_TerminalView::
 ~My_TerminalView ()
 {
+	// exports that have not finished are cancelled (removing their files);
+	// the list is copied, since ending an export removes it from the list
+	for (auto exportPtr : My_SelectionExportList(this->text.selectionExports))
+	{
+		[exportPtr->progress cancel];
+		endSelectionExport(this, exportPtr, false/* is complete */);
+	}
+	
 	if (nil != this->text.font.normalFont)
 	{
 		this->text.font.normalFont = nil;
@@ -4255,6 +4681,92 @@ calculateAnimationStageDelay	(My_TerminalViewPtr					inTerminalViewPtr,
 }// calculateAnimationStageDelay
 
 
+/*!
+Reads the next batch of rows for an export (see
+TerminalView_StartSelectedTextExport()), and schedules the
+next batch on the main queue; or, if the writer has fallen
+behind, tries again after a short delay.  Once every row has
+been read, the export waits for the writer on a background
+queue, and then ends.
+
+Nothing is done if the export has ended (for instance, if
+the view was destroyed) or is already finishing.
+
+(2021.06)
+*/
+void
+continueSelectionExport		(TerminalViewRef						inView,
+							 std::weak_ptr< My_SelectionExport >	inExport)
+{
+	My_SelectionExportPtr	exportPtr = inExport.lock();
+	
+	
+	if ((nullptr != exportPtr) && (false == exportPtr->isEnded) && (false == exportPtr->isFinishing))
+	{
+		// since the export has not ended, the view still exists
+		My_TerminalViewAutoLocker	viewPtr(gTerminalViewPtrLocks(), inView);
+		
+		
+		if ((exportPtr->progress.cancelled) || AsyncWriter_IsFailed(exportPtr->writer))
+		{
+			endSelectionExport(viewPtr, exportPtr, false/* is complete */);
+		}
+		else if (AsyncWriter_IsBacklogFull(exportPtr->writer))
+		{
+			// wait for the disk to catch up before reading any more
+			dispatch_after(dispatch_time(DISPATCH_TIME_NOW, kMy_ExportRetryNanoseconds), dispatch_get_main_queue(),
+			^{
+				continueSelectionExport(inView, inExport);
+			});
+		}
+		else
+		{
+			TerminalView_RowIndex const		kPastEndRow = std::min(exportPtr->range.second.second,
+																	exportPtr->nextRow + kMy_ExportRowsPerBatch);
+			
+			
+			if (false == exportSelectedRows(viewPtr, exportPtr->range, exportPtr->isRectangular, kPastEndRow,
+											exportPtr->nextRow, exportPtr->textExport))
+			{
+				endSelectionExport(viewPtr, exportPtr, false/* is complete */);
+			}
+			else if (exportPtr->nextRow < exportPtr->range.second.second)
+			{
+				exportPtr->progress.completedUnitCount = (exportPtr->nextRow - exportPtr->range.first.second);
+				dispatch_async(dispatch_get_main_queue(),
+				^{
+					continueSelectionExport(inView, inExport);
+				});
+			}
+			else
+			{
+				// every row has been read; wait for the rest of the text
+				// to be written, without blocking the main queue
+				exportPtr->progress.completedUnitCount = exportPtr->progress.totalUnitCount;
+				UNUSED_RETURN(TextExport_Result)TextExport_Finish(exportPtr->textExport);
+				exportPtr->isFinishing = true;
+				dispatch_async(dispatch_get_global_queue(QOS_CLASS_UTILITY, 0),
+				^{
+					AsyncWriter_WaitUntilWritten(exportPtr->writer);
+					dispatch_async(dispatch_get_main_queue(),
+					^{
+						// the export may have been ended in the meantime
+						// (e.g. by TerminalView_FinishSelectedTextExport())
+						unless (exportPtr->isEnded)
+						{
+							My_TerminalViewAutoLocker	finishedViewPtr(gTerminalViewPtrLocks(), exportPtr->view);
+							
+							
+							endSelectionExport(finishedViewPtr, exportPtr, true/* is complete */);
+						}
+					});
+				});
+			}
+		}
+	}
+}// continueSelectionExport
+
+
 /*!
 Attempts to read all supported color tags from the given
 preference context, and any colors that exist will be
@@ -4349,8 +4861,8 @@ copyColorPreferences	(My_TerminalViewPtr			inTerminalViewPtr,
 		Boolean		isAutoSet = false;
 		
 		
-		prefsResult = Preferences_ContextGetData(inSource, kPreferences_TagAutoSetCursorColor,
-													sizeof(isAutoSet), &isAutoSet, inSearchForDefaults);
+		prefsResult = Preferences_ContextGetValue< kPreferences_TagAutoSetCursorColor >
+					(inSource, isAutoSet, inSearchForDefaults);
 		if (kPreferences_ResultOK == prefsResult)
 		{
 			inTerminalViewPtr->screen.cursor.isCustomColor = (false == isAutoSet);
@@ -4565,15 +5077,15 @@ copyFontPreferences		(My_TerminalViewPtr			inTerminalViewPtr,
 	
 	if (inTerminalViewPtr->displayMode != kTerminalView_DisplayModeZoom)
 	{
-		if (kPreferences_ResultOK == Preferences_ContextGetData(inSource, kPreferences_TagFontSize,
-																sizeof(fontSize), &fontSize, inSearchDefaults))
+		if (kPreferences_ResultOK == Preferences_ContextGetValue< kPreferences_TagFontSize >
+								(inSource, fontSize, inSearchDefaults))
 		{
 			++result;
 		}
 	}
 	
-	if (kPreferences_ResultOK == Preferences_ContextGetData(inSource, kPreferences_TagFontCharacterWidthMultiplier,
-															sizeof(charWidthScale), &charWidthScale, inSearchDefaults))
+	if (kPreferences_ResultOK == Preferences_ContextGetValue< kPreferences_TagFontCharacterWidthMultiplier >
+							(inSource, charWidthScale, inSearchDefaults))
 	{
 		++result;
 	}
@@ -4589,6 +5101,49 @@ copyFontPreferences		(My_TerminalViewPtr			inTerminalViewPtr,
 }// copyFontPreferences
 
 
+/*!
+Finds the link that includes the given cell (see
+Terminal_CopyLinkAtColumn()), and returns its range of
+cells and its target.  Returns "true" only if there is
+a link at the cell.
+
+IMPORTANT:	If "true" is returned, you must eventually use
+			CFRelease() on the returned URI.
+
+(2021.06)
+*/
+Boolean
+copyLinkAtCell	(My_TerminalViewPtr			inTerminalViewPtr,
+				 TerminalView_Cell const&	inCell,
+				 TerminalView_CellRange&	outRange,
+				 CFStringRef&				outURICFString)
+{
+	Terminal_LineStackStorage	lineIteratorData;
+	Terminal_LineRef			lineIterator = findRowIteratorRelativeTo(inTerminalViewPtr, inCell.second,
+																			0/* origin row */, &lineIteratorData);
+	Boolean						result = false;
+	
+	
+	outURICFString = nullptr;
+	if (nullptr != lineIterator)
+	{
+		UInt16		startColumn = 0;
+		UInt16		pastTheEndColumn = 0;
+		
+		
+		if (kTerminal_ResultOK == Terminal_CopyLinkAtColumn(inTerminalViewPtr->screen.ref, lineIterator, inCell.first,
+																startColumn, pastTheEndColumn, outURICFString))
+		{
+			outRange.first = TerminalView_Cell(startColumn, inCell.second);
+			outRange.second = TerminalView_Cell(pastTheEndColumn, inCell.second + 1);
+			result = true;
+		}
+		releaseRowIterator(inTerminalViewPtr, &lineIterator);
+	}
+	return result;
+}// copyLinkAtCell
+
+
 /*!
 Copies all of the selected text to the clipboard
 under the condition that the user has set the
@@ -4607,8 +5162,7 @@ copySelectedTextIfUserPreference	(My_TerminalViewPtr		inTerminalViewPtr)
 		
 		
 		unless (kPreferences_ResultOK ==
-				Preferences_GetData(kPreferences_TagCopySelectedText, sizeof(copySelectedText),
-									&copySelectedText))
+				Preferences_GetValue< kPreferences_TagCopySelectedText >(copySelectedText))
 		{
 			copySelectedText = false; // assume text isn’t automatically copied, if preference can’t be found
 		}
@@ -5049,6 +5603,7 @@ drawSection		(My_TerminalViewPtr		inTerminalViewPtr,
 				 UInt16					UNUSED_ARGUMENT(inZeroBasedPastTheRightmostColumnToDraw),
 				 TerminalView_RowIndex	inZeroBasedPastTheBottommostRowToDraw)
 {
+	TraceSpan_Scope("drawSection");
 	Boolean		result = false;
 	
 	
@@ -5097,16 +5652,54 @@ drawSection		(My_TerminalViewPtr		inTerminalViewPtr,
 						break;
 					}
 					
+					// the selection, search results and the link under the mouse are not
+					// stored in the terminal buffer; find the parts of this row that they
+					// cover, so that each run can be split where they begin and end
+					{
+						TerminalView_RowIndex const		kVirtualRow = inTerminalViewPtr->screen.currentRenderedLine +
+																		inTerminalViewPtr->screen.topVisibleEdgeInRows;
+						auto const						toSearchResults = inTerminalViewPtr->text.searchResultsByRow.find
+																		(kVirtualRow - inTerminalViewPtr->text.searchResultsRowOffset);
+						My_RowOverlay					overlay;
+						
+						
+						inTerminalViewPtr->screen.currentRenderOverlays.clear();
+						if (getSelectedColumnsInRow(inTerminalViewPtr, kVirtualRow, overlay.startColumn, overlay.pastTheEndColumn))
+						{
+							overlay.attributes = kTextAttributes_Selected;
+							inTerminalViewPtr->screen.currentRenderOverlays.push_back(overlay);
+						}
+						if (inTerminalViewPtr->text.searchResultsByRow.end() != toSearchResults)
+						{
+							overlay.attributes = kTextAttributes_SearchHighlight;
+							for (auto const& columnInterval : toSearchResults->second)
+							{
+								overlay.startColumn = columnInterval.first;
+								overlay.pastTheEndColumn = columnInterval.second;
+								inTerminalViewPtr->screen.currentRenderOverlays.push_back(overlay);
+							}
+						}
+						if ((kVirtualRow == inTerminalViewPtr->text.hoveredLink.first.second) &&
+							(inTerminalViewPtr->text.hoveredLink.first.first < inTerminalViewPtr->text.hoveredLink.second.first))
+						{
+							overlay.startColumn = inTerminalViewPtr->text.hoveredLink.first.first;
+							overlay.pastTheEndColumn = inTerminalViewPtr->text.hoveredLink.second.first;
+							overlay.attributes = kTextAttributes_StyleUnderline;
+							inTerminalViewPtr->screen.currentRenderOverlays.push_back(overlay);
+						}
+					}
+					
 					iteratorResult = Terminal_ForEachLikeAttributeRun
 										(inTerminalViewPtr->screen.ref, lineIterator,
 											^(UInt16					inLineTextBufferLength,
 											  CFStringRef				inLineTextBufferAsCFStringOrNull,
 											  Terminal_LineRef			UNUSED_ARGUMENT(inRow),
 											  UInt16					inZeroBasedStartColumnNumber,
-											  TextAttributes_Object		inAttributes)
+											  TextAttributes_Object		inAttributes,
+											  TextAttributes_InlineColors	inInlineColors)
 											{
-												drawTerminalScreenRunOp(inTerminalViewPtr, inLineTextBufferLength, inLineTextBufferAsCFStringOrNull,
-																		inZeroBasedStartColumnNumber, inAttributes);
+												drawTerminalScreenRunOverlaid(inTerminalViewPtr, inLineTextBufferLength, inLineTextBufferAsCFStringOrNull,
+																				inZeroBasedStartColumnNumber, inAttributes, inInlineColors);
 											});
 					if (iteratorResult != kTerminal_ResultOK)
 					{
@@ -5124,6 +5717,7 @@ drawSection		(My_TerminalViewPtr		inTerminalViewPtr,
 		
 		// reset these, they shouldn’t have significance outside the above loop
 		inTerminalViewPtr->screen.currentRenderedLine = -1;
+		inTerminalViewPtr->screen.currentRenderOverlays.clear();
 		inTerminalViewPtr->screen.currentRenderContext = nullptr;
 	}
 	return result;
@@ -5268,19 +5862,25 @@ Terminal_ForEachLikeAttributeRun().
 (2017.12)
 */
 void
-drawTerminalScreenRunOp		(My_TerminalViewPtr			inTerminalViewPtr,
-							 UInt16						inLineTextBufferLength,
-							 CFStringRef				inLineTextBufferAsCFStringOrNull,
-							 UInt16						inZeroBasedStartColumnNumber,
-							 TextAttributes_Object		inAttributes)
+drawTerminalScreenRunOp		(My_TerminalViewPtr					inTerminalViewPtr,
+							 UInt16								inLineTextBufferLength,
+							 CFStringRef						inLineTextBufferAsCFStringOrNull,
+							 UInt16								inZeroBasedStartColumnNumber,
+							 TextAttributes_Object				inAttributes,
+							 TextAttributes_InlineColors const&	inInlineColors)
 {
 	CGRect		sectionBounds;
 	
 	
+	// store new 24-bit colors, for anything that refers to the
+	// text attributes (see drawTerminalText())
+	inTerminalViewPtr->text.inlineColors = inInlineColors;
+	
 	// set up context foreground and background colors appropriately
 	// for the specified terminal attributes; this takes into account
 	// things like bold and highlighted text, etc.
-	useTerminalTextColors(inTerminalViewPtr, inTerminalViewPtr->screen.currentRenderContext, inAttributes, false/* is cursor */, 1.0/* alpha */);
+	useTerminalTextColors(inTerminalViewPtr, inTerminalViewPtr->screen.currentRenderContext, inAttributes, inInlineColors,
+							false/* is cursor */, 1.0/* alpha */);
 	
 	// erase and redraw the current rendering line, but only the
 	// specified range (starting column and character count)
@@ -5358,34 +5958,121 @@ drawTerminalScreenRunOp		(My_TerminalViewPtr			inTerminalViewPtr,
 
 
 /*!
-Draws the specified text using the given attributes, at a pen
-location appropriate for fitting within the given boundaries.
-If the cursor falls anywhere in the given area and is in a
-visible state, it is drawn automatically.
-
-WARNING:	For Cocoa-based drawing this routine CANNOT be called
-		outside of the content view’s normal layer drawing code.
-
-Although this function will set up text attributes such as
-font, color, graphics line width, etc., it will NOT set colors.
-The context must already be set up to use the desired stroke
-and fill colors.
+Like drawTerminalScreenRunOp(), but first splits the run
+wherever a part of the row that has extra attributes (see
+"currentRenderOverlays") begins or ends, so that the text
+selection and search results can be drawn without storing
+them in the terminal buffer.
 
-For optimal performance the graphics context state may not be
-saved or restored; it could be returned in any state.
-
-(3.0)
+(2021.06)
 */
 void
-drawTerminalText	(My_TerminalViewPtr			inTerminalViewPtr,
-					 CGContextRef				inDrawingContext,
-					 CGRect const&				inBoundaries,
-					 CFIndex					inCharacterCount,
-					 CFStringRef				inTextBufferAsCFString,
-					 TextAttributes_Object		inAttributes)
+drawTerminalScreenRunOverlaid	(My_TerminalViewPtr					inTerminalViewPtr,
+								 UInt16								inLineTextBufferLength,
+								 CFStringRef						inLineTextBufferAsCFStringOrNull,
+								 UInt16								inZeroBasedStartColumnNumber,
+								 TextAttributes_Object				inAttributes,
+								 TextAttributes_InlineColors const&	inInlineColors)
 {
-	// store new text attributes, for anything that refers to them
-	inTerminalViewPtr->text.attributes = inAttributes;
+	My_RowOverlayList const&	kOverlays = inTerminalViewPtr->screen.currentRenderOverlays;
+	
+	
+	if (kOverlays.empty())
+	{
+		// typical case; nothing on this row is drawn differently
+		drawTerminalScreenRunOp(inTerminalViewPtr, inLineTextBufferLength, inLineTextBufferAsCFStringOrNull,
+								inZeroBasedStartColumnNumber, inAttributes, inInlineColors);
+	}
+	else
+	{
+		UInt16 const			kRunPastEnd = STATIC_CAST(inZeroBasedStartColumnNumber + inLineTextBufferLength, UInt16);
+		std::vector< UInt16 >	pieceBoundaries;
+		
+		
+		// find every column in the run where an overlay begins or ends
+		for (auto const& overlay : kOverlays)
+		{
+			if ((overlay.startColumn > inZeroBasedStartColumnNumber) && (overlay.startColumn < kRunPastEnd))
+			{
+				pieceBoundaries.push_back(overlay.startColumn);
+			}
+			if ((overlay.pastTheEndColumn > inZeroBasedStartColumnNumber) && (overlay.pastTheEndColumn < kRunPastEnd))
+			{
+				pieceBoundaries.push_back(overlay.pastTheEndColumn);
+			}
+		}
+		pieceBoundaries.push_back(inZeroBasedStartColumnNumber);
+		pieceBoundaries.push_back(kRunPastEnd);
+		std::sort(pieceBoundaries.begin(), pieceBoundaries.end());
+		pieceBoundaries.erase(std::unique(pieceBoundaries.begin(), pieceBoundaries.end()), pieceBoundaries.end());
+		
+		// draw each piece with the attributes of every overlay that covers it
+		for (size_t i = 1; i < pieceBoundaries.size(); ++i)
+		{
+			UInt16 const			kPieceStart = pieceBoundaries[i - 1];
+			UInt16 const			kPiecePastEnd = pieceBoundaries[i];
+			TextAttributes_Object	pieceAttributes = inAttributes;
+			CFRetainRelease			pieceText;
+			
+			
+			for (auto const& overlay : kOverlays)
+			{
+				if ((overlay.startColumn <= kPieceStart) && (kPiecePastEnd <= overlay.pastTheEndColumn))
+				{
+					pieceAttributes.addAttributes(overlay.attributes);
+				}
+			}
+			
+			if (2 == pieceBoundaries.size())
+			{
+				// the run is not split
+				pieceText.setWithRetain(inLineTextBufferAsCFStringOrNull);
+			}
+			else if (nullptr != inLineTextBufferAsCFStringOrNull)
+			{
+				pieceText.setWithNoRetain(CFStringCreateWithSubstring(kCFAllocatorDefault, inLineTextBufferAsCFStringOrNull,
+																		CFRangeMake(kPieceStart - inZeroBasedStartColumnNumber,
+																					kPiecePastEnd - kPieceStart)));
+			}
+			drawTerminalScreenRunOp(inTerminalViewPtr, STATIC_CAST(kPiecePastEnd - kPieceStart, UInt16),
+									pieceText.returnCFStringRef(), kPieceStart, pieceAttributes, inInlineColors);
+		}
+	}
+}// drawTerminalScreenRunOverlaid
+
+
+/*!
+Draws the specified text using the given attributes, at a pen
+location appropriate for fitting within the given boundaries.
+If the cursor falls anywhere in the given area and is in a
+visible state, it is drawn automatically.
+
+WARNING:	For Cocoa-based drawing this routine CANNOT be called
+		outside of the content view’s normal layer drawing code.
+
+Although this function will set up text attributes such as
+font, color, graphics line width, etc., it will NOT set colors.
+The context must already be set up to use the desired stroke
+and fill colors.
+
+For optimal performance the graphics context state may not be
+saved or restored; it could be returned in any state.
+
+(3.0)
+*/
+void
+drawTerminalText	(My_TerminalViewPtr			inTerminalViewPtr,
+					 CGContextRef				inDrawingContext,
+					 CGRect const&				inBoundaries,
+					 CFIndex					inCharacterCount,
+					 CFStringRef				inTextBufferAsCFString,
+					 TextAttributes_Object		inAttributes)
+{
+	TraceSpan_Scope("drawTerminalText");
+	
+	
+	// store new text attributes, for anything that refers to them
+	inTerminalViewPtr->text.attributes = inAttributes;
 	
 	// font attributes are set directly on the (attributed) string
 	// of the text storage, not in the graphics context
@@ -5975,6 +6662,58 @@ drawVTGraphicsGlyph		(My_TerminalViewPtr			inTerminalViewPtr,
 }// drawVTGraphicsGlyph
 
 
+/*!
+Ends the given export of the view (unless it has already
+ended): decides if the text was written, calls the completion
+block and removes the export from the list of the view.  If the text was not written, the file is removed
+right away (it is closed when the last reference goes away).
+
+Every row must have been read and written for the export to
+be complete; even so, the text is not considered written if
+the export was cancelled or the writer failed.
+
+(2021.06)
+*/
+void
+endSelectionExport	(My_TerminalViewPtr		inTerminalViewPtr,
+					 My_SelectionExportPtr	inExportPtr,
+					 Boolean				inIsComplete)
+{
+	My_SelectionExportPtr	exportPtr = inExportPtr;
+	
+	
+	if ((nullptr != exportPtr) && (false == exportPtr->isEnded))
+	{
+		TerminalView_TextExportBlock	completionBlock = exportPtr->completionBlock;
+		
+		
+		if (AsyncWriter_IsFailed(exportPtr->writer))
+		{
+			Console_Warning(Console_WriteValueCFString, "failed to write selected text to file",
+							CFURLGetString(exportPtr->fileURL.returnCFURLRef()));
+		}
+		exportPtr->isWritten = ((inIsComplete) && (NO == exportPtr->progress.cancelled) &&
+								(false == AsyncWriter_IsFailed(exportPtr->writer)));
+		exportPtr->isEnded = true;
+		exportPtr->completionBlock = nil;
+		[exportPtr->progress unpublish];
+		unless (exportPtr->isWritten)
+		{
+			UNUSED_RETURN(BOOL)[[NSFileManager defaultManager] removeItemAtURL:BRIDGE_CAST(exportPtr->fileURL.returnCFURLRef(), NSURL*)
+																		error:nil];
+		}
+		inTerminalViewPtr->text.selectionExports.erase(std::remove(inTerminalViewPtr->text.selectionExports.begin(),
+																	inTerminalViewPtr->text.selectionExports.end(), exportPtr),
+														inTerminalViewPtr->text.selectionExports.end());
+		
+		if (nil != completionBlock)
+		{
+			completionBlock(exportPtr->isWritten);
+		}
+	}
+}// endSelectionExport
+
+
 /*!
 Erases a rectangular portion of the current rendering
 line of the screen display, unless the renderer is in
@@ -6042,6 +6781,175 @@ eventNotifyForView	(My_TerminalViewConstPtr	inPtr,
 }// eventNotifyForView
 
 
+/*!
+Adds rows of a selection to a text export, from the row
+"inoutNextRow" up to (but not including) the given row; on
+output, "inoutNextRow" is the row after the last one read.
+The selection decides which columns of each row are read
+(for instance, the first row of a selection that is not
+rectangular is read from the start column to the end).
+
+If a row no longer exists (for instance, because it was
+removed from the scrollback) or the end of the buffer is
+reached, "inoutNextRow" is set to the end of the selection
+so that the export stops early; this is not an error.
+
+Returns false only if text could not be read (a warning is
+logged).
+
+(2021.06)
+*/
+Boolean
+exportSelectedRows	(My_TerminalViewPtr				inTerminalViewPtr,
+					 TerminalView_CellRange const&	inSelection,
+					 Boolean						inIsRectangular,
+					 TerminalView_RowIndex			inPastEndRow,
+					 TerminalView_RowIndex&			inoutNextRow,
+					 TextExport_Ref					inExport)
+{
+	TerminalView_Cell const&	kSelectionStart = inSelection.first;
+	TerminalView_Cell const&	kSelectionPastEnd = inSelection.second;
+	Terminal_LineStackStorage	lineIteratorData;
+	Terminal_LineRef			lineIterator = nullptr;
+	std::vector< UniChar >		lineCharacters;
+	Boolean						result = true;
+	
+	
+	if (inoutNextRow < inPastEndRow)
+	{
+		lineIterator = findRowIteratorRelativeTo(inTerminalViewPtr, inoutNextRow, 0/* origin row */, &lineIteratorData);
+		if (nullptr == lineIterator)
+		{
+			inoutNextRow = kSelectionPastEnd.second;
+		}
+	}
+	
+	// read every line of Unicode characters within this range;
+	// if appropriate, ignore some characters on each line
+	while ((nullptr != lineIterator) && (inoutNextRow < inPastEndRow))
+	{
+		TerminalView_RowIndex const		i = inoutNextRow;
+		CFStringRef						referenceCFString = nullptr;
+		CFRange							stringRange = CFRangeMake(0, 0);
+		TextAttributes_Object			lineGlobalAttributes;
+		Terminal_Result					textGrabResult = kTerminal_ResultOK;
+		Boolean							skipLine = false;
+		
+		
+		if (kTerminal_ResultOK == Terminal_GetLineGlobalAttributes(inTerminalViewPtr->screen.ref, lineIterator, &lineGlobalAttributes))
+		{
+			if (lineGlobalAttributes.hasDoubleHeightTop())
+			{
+				// double-height text is replicated on two lines and the top half
+				// is not rendered at all; skip the top half (the bottom half
+				// will have identical text and this will match the user’s
+				// expectation of seeing the text only appear once)
+				skipLine = true;
+			}
+		}
+		
+		if (false == skipLine)
+		{
+			if ((inIsRectangular) || (1 == (kSelectionPastEnd.second - kSelectionStart.second)))
+			{
+				// for rectangular or one-line selections, copy a specific column range
+				textGrabResult = Terminal_GetLineRange(inTerminalViewPtr->screen.ref, lineIterator,
+														kSelectionStart.first, kSelectionPastEnd.first,
+														referenceCFString, stringRange);
+				if (kTerminal_ResultOK != textGrabResult)
+				{
+					Console_Warning(Console_WriteValue, "one-line text copy failed, terminal error", textGrabResult);
+					result = false;
+					break;
+				}
+			}
+			else
+			{
+				// for standard selections, the first and last lines are different
+				// TEMPORARY: whitespace exclusion flags are mostly a hack to work
+				// around the fact that terminals do not currently know where a
+				// line actually ends; they store whitespace for the full width,
+				// and it is undesirable to pad copied lines with meaningless spaces;
+				// heuristics are employed to arbitrarily strip this end space most
+				// of the time, making an exception for short (~2 line) wraps that
+				// are most likely part of the same, continuing line anyway
+				if (i == kSelectionStart.second)
+				{
+					// first line is anchored at the end (LOCALIZE THIS)
+					textGrabResult = Terminal_GetLineRange(inTerminalViewPtr->screen.ref, lineIterator,
+															kSelectionStart.first, -1/* end column */,
+															referenceCFString, stringRange,
+															(2/* arbitrary */ == (kSelectionPastEnd.second - kSelectionStart.second))
+																? 0/* flags */
+																: kTerminal_TextFilterFlagsNoEndWhitespace);
+					if (kTerminal_ResultOK != textGrabResult)
+					{
+						Console_Warning(Console_WriteValue, "first-line-anchored-at-end text copy failed, terminal error", textGrabResult);
+						result = false;
+						break;
+					}
+				}
+				else if (i == (kSelectionPastEnd.second - 1))
+				{
+					// last line is anchored at the beginning (LOCALIZE THIS)
+					textGrabResult = Terminal_GetLineRange(inTerminalViewPtr->screen.ref, lineIterator,
+															0/* start column */, kSelectionPastEnd.first,
+															referenceCFString, stringRange, kTerminal_TextFilterFlagsNoEndWhitespace);
+					if (kTerminal_ResultOK != textGrabResult)
+					{
+						Console_Warning(Console_WriteValue, "last-line-anchored-at-beginning text copy failed, terminal error", textGrabResult);
+						result = false;
+						break;
+					}
+				}
+				else
+				{
+					// middle lines span the whole width
+					textGrabResult = Terminal_GetLine(inTerminalViewPtr->screen.ref, lineIterator,
+														referenceCFString, stringRange, kTerminal_TextFilterFlagsNoEndWhitespace);
+					if (kTerminal_ResultOK != textGrabResult)
+					{
+						Console_Warning(Console_WriteValue, "middle-spanning-line text copy failed, terminal error", textGrabResult);
+						result = false;
+						break;
+					}
+				}
+			}
+			
+			// add the characters for the line (the export adds new-lines
+			// and replaces spaces with tabs, as it was configured to)
+			{
+				UniChar const*		characters = CFStringGetCharactersPtr(referenceCFString);
+				
+				
+				if (nullptr != characters)
+				{
+					characters += stringRange.location;
+				}
+				else
+				{
+					lineCharacters.resize(stringRange.length);
+					CFStringGetCharacters(referenceCFString, stringRange, lineCharacters.data());
+					characters = lineCharacters.data();
+				}
+				UNUSED_RETURN(TextExport_Result)TextExport_AppendLine(inExport, characters, stringRange.length);
+			}
+		}
+		
+		++inoutNextRow;
+		if ((inoutNextRow < inPastEndRow) &&
+			(kTerminal_ResultIteratorCannotAdvance == Terminal_LineIteratorAdvance(inTerminalViewPtr->screen.ref, lineIterator, +1)))
+		{
+			// last line of the buffer has been reached
+			inoutNextRow = kSelectionPastEnd.second;
+		}
+	}
+	releaseRowIterator(inTerminalViewPtr, &lineIterator);
+	
+	return result;
+}// exportSelectedRows
+
+
 /*!
 Returns the terminal buffer iterator for the specified line,
 which is relative to the currently visible portion of the
@@ -6318,7 +7226,8 @@ getImagesInVirtualRange		(My_TerminalViewPtr				inTerminalViewPtr,
 											  CFStringRef				UNUSED_ARGUMENT(inLineTextBufferAsCFStringOrNull),
 											  Terminal_LineRef			UNUSED_ARGUMENT(inRow),
 											  UInt16					UNUSED_ARGUMENT(inZeroBasedStartColumnNumber),
-											  TextAttributes_Object		inAttributes)
+											  TextAttributes_Object		inAttributes,
+											  TextAttributes_InlineColors	UNUSED_ARGUMENT(inInlineColors))
 											{
 												if (inAttributes.hasBitmap())
 												{
@@ -6546,14 +7455,18 @@ returned background color is normal, which is effectively
 no color if the foreground is rendered over top of a
 background view.
 
+The given 24-bit colors are read directly for any part of
+the attributes that sets an inline-color bit.
+
 (4.0)
 */
 void
-getScreenColorsForAttributes	(My_TerminalViewPtr			inTerminalViewPtr,
-								 TextAttributes_Object		inAttributes,
-								 CGFloatRGBColor*			outForeColorPtr,
-								 CGFloatRGBColor*			outBackColorPtr,
-								 Boolean*					outNoBackgroundPtr)
+getScreenColorsForAttributes	(My_TerminalViewPtr					inTerminalViewPtr,
+								 TextAttributes_Object				inAttributes,
+								 TextAttributes_InlineColors const&	inInlineColors,
+								 CGFloatRGBColor*					outForeColorPtr,
+								 CGFloatRGBColor*					outBackColorPtr,
+								 Boolean*							outNoBackgroundPtr)
 {
 	Boolean		isCustom = false;
 	
@@ -6572,6 +7485,20 @@ getScreenColorsForAttributes	(My_TerminalViewPtr			inTerminalViewPtr,
 			// color bits may be enabled but they have a different purpose in this case
 			isCustom = false;
 		}
+		else if (inAttributes.hasAttributes(kTextAttributes_ColorIsInlineForeground))
+		{
+			// a “true color” was chosen and stored with the text
+			UInt8	redComponent = 0;
+			UInt8	greenComponent = 0;
+			UInt8	blueComponent = 0;
+			
+			
+			inInlineColors.returnForeground(redComponent, greenComponent, blueComponent);
+			outForeColorPtr->red = (STATIC_CAST(redComponent, CGFloat) / 255.0);
+			outForeColorPtr->green = (STATIC_CAST(greenComponent, CGFloat) / 255.0);
+			outForeColorPtr->blue = (STATIC_CAST(blueComponent, CGFloat) / 255.0);
+			isCustom = true;
+		}
 		else if (inAttributes.hasAttributes(kTextAttributes_ColorIndexIsTrueColorID))
 		{
 			// a “true color” was chosen
@@ -6641,7 +7568,21 @@ getScreenColorsForAttributes	(My_TerminalViewPtr			inTerminalViewPtr,
 	isCustom = false; // initially...
 	if (inAttributes.hasAttributes(kTextAttributes_EnableBackground))
 	{
-		if (inAttributes.hasAttributes(kTextAttributes_ColorIndexIsTrueColorID))
+		if (inAttributes.hasAttributes(kTextAttributes_ColorIsInlineBackground))
+		{
+			// a “true color” was chosen and stored with the text
+			UInt8	redComponent = 0;
+			UInt8	greenComponent = 0;
+			UInt8	blueComponent = 0;
+			
+			
+			inInlineColors.returnBackground(redComponent, greenComponent, blueComponent);
+			outBackColorPtr->red = (STATIC_CAST(redComponent, CGFloat) / 255.0);
+			outBackColorPtr->green = (STATIC_CAST(greenComponent, CGFloat) / 255.0);
+			outBackColorPtr->blue = (STATIC_CAST(blueComponent, CGFloat) / 255.0);
+			isCustom = true;
+		}
+		else if (inAttributes.hasAttributes(kTextAttributes_ColorIndexIsTrueColorID))
 		{
 			// a “true color” was chosen
 			TextAttributes_TrueColorID	colorID = inAttributes.colorIDBackground();
@@ -6799,6 +7740,68 @@ getScreenCustomColor	(My_TerminalViewPtr			inTerminalViewPtr,
 }// getScreenCustomColor
 
 
+/*!
+Finds the part of the given row (a virtual row index, where
+0 is the topmost main screen row) that is covered by the
+highlighted text selection.  Returns false if no part of
+the row is selected, in which case the columns are not
+defined.
+
+The selection is kept only as a range, and never written
+into terminal buffer attributes; this is consulted when
+rows are drawn, so that selecting or deselecting text does
+not depend on the size of the range.
+
+(2021.06)
+*/
+Boolean
+getSelectedColumnsInRow		(My_TerminalViewPtr		inTerminalViewPtr,
+							 TerminalView_RowIndex	inVirtualRow,
+							 UInt16&				outStartColumn,
+							 UInt16&				outPastTheEndColumn)
+{
+	Boolean		result = false;
+	
+	
+	if ((inTerminalViewPtr->text.selection.isHighlighted) &&
+		(false == inTerminalViewPtr->text.selection.inhibited) &&
+		(inTerminalViewPtr->text.selection.range.first != inTerminalViewPtr->text.selection.range.second))
+	{
+		TerminalView_CellRange		orderedRange = inTerminalViewPtr->text.selection.range;
+		
+		
+		// require beginning point to be “earlier” than the end point; swap points if not
+		sortAnchors(orderedRange.first, orderedRange.second, inTerminalViewPtr->text.selection.isRectangular);
+		
+		if ((inVirtualRow >= orderedRange.first.second) && (inVirtualRow < orderedRange.second.second))
+		{
+			UInt16 const	kColumnCount = Terminal_ReturnColumnCount(inTerminalViewPtr->screen.ref);
+			
+			
+			// this matches the shape used by pointInSelection()
+			if ((inTerminalViewPtr->text.selection.isRectangular) ||
+				(1 == (orderedRange.second.second - orderedRange.first.second)))
+			{
+				outStartColumn = orderedRange.first.first;
+				outPastTheEndColumn = orderedRange.second.first;
+			}
+			else
+			{
+				outStartColumn = (inVirtualRow == orderedRange.first.second)
+									? orderedRange.first.first
+									: 0;
+				outPastTheEndColumn = (inVirtualRow == (orderedRange.second.second - 1))
+										? orderedRange.second.first
+										: kColumnCount;
+			}
+			outPastTheEndColumn = std::min(outPastTheEndColumn, kColumnCount);
+			result = (outStartColumn < outPastTheEndColumn);
+		}
+	}
+	return result;
+}// getSelectedColumnsInRow
+
+
 /*!
 Like getVirtualRangeAsNewHIShape(), except specifically for the
 current text selection.  Automatically takes into account
@@ -7003,10 +8006,12 @@ Creates a selection appropriate for the specified
 click count.  Only call this method if at least a
 double-click ("inClickCount" == 2) has occurred.
 
-A double-click selects a word.  A triple-click
+A double-click selects a word, as found by the Word
+Boundary module (unless a script has registered a
+word-finding callback with Quills).  A triple-click
 selects an entire line.
 
-(3.0)
+(2021.06)
 */
 void
 handleMultiClick	(My_TerminalViewPtr		inTerminalViewPtr,
@@ -7029,8 +8034,9 @@ handleMultiClick	(My_TerminalViewPtr		inTerminalViewPtr,
 		
 		if (inClickCount == 2)
 		{
-			// double-click; invoke the registered Python word-finding callback
-			// to determine which text should be selected
+			// double-click - select a word; the text of the line is
+			// examined in place, unless a script has registered its
+			// own word-finding callback (which requires a UTF-8 copy)
 			Terminal_LineStackStorage	lineIteratorData;
 			Terminal_LineRef			lineIterator = findRowIteratorRelativeTo(inTerminalViewPtr, selectionStart.second,
 																					0/* origin row */, &lineIteratorData);
@@ -7038,8 +8044,6 @@ handleMultiClick	(My_TerminalViewPtr		inTerminalViewPtr,
 			Terminal_Result				getTextError = Terminal_GetLineCFString(inTerminalViewPtr->screen.ref, lineIterator, textCFString);
 			
 			
-			// double-click - select a word; or, do intelligent double-click
-			// based on the character underneath the cursor
 			// TEMPORARY; only one line is examined, but this is probably
 			// more useful if it joins at least the preceding line, and
 			// possible the following line as well
@@ -7047,7 +8051,7 @@ handleMultiClick	(My_TerminalViewPtr		inTerminalViewPtr,
 			{
 				Console_Warning(Console_WriteValue, "failed to obtain current line of terminal text", getTextError);
 			}
-			else
+			else if (Quills::Terminal::_has_seekword_call())
 			{
 				const char*				ptrUTF8 = [BRIDGE_CAST(textCFString, NSString*) UTF8String];
 				std::string				asUTF8{ (ptrUTF8) ? ptrUTF8 : "" };
@@ -7075,6 +8079,31 @@ handleMultiClick	(My_TerminalViewPtr		inTerminalViewPtr,
 					Console_WriteScriptError(titleCFString, messageCFString.returnCFStringRef());
 				}
 			}
+			else
+			{
+				// the line string is usually backed by the cells, so
+				// there is normally no copy; cells are characters
+				UInt16 const			kLength = STATIC_CAST(std::min< CFIndex >(CFStringGetLength(textCFString), kColumnCount), UInt16);
+				UniChar const*			textPtr = CFStringGetCharactersPtr(textCFString);
+				std::vector< UniChar >	textBuffer;
+				UInt16					startIndex = 0;
+				UInt16					pastTheEndIndex = 0;
+				
+				
+				if (nullptr == textPtr)
+				{
+					textBuffer.resize(kLength);
+					CFStringGetCharacters(textCFString, CFRangeMake(0, kLength), textBuffer.data());
+					textPtr = textBuffer.data();
+				}
+				if ((nullptr != textPtr) &&
+					WordBoundary_FindWord(WordBoundary_ReturnSharedClassifier(), textPtr, kLength, selectionStart.first,
+											startIndex, pastTheEndIndex))
+				{
+					selectionStart.first = startIndex;
+					selectionPastEnd.first = pastTheEndIndex;
+				}
+			}
 			releaseRowIterator(inTerminalViewPtr, &lineIterator);
 		}
 		else
@@ -7094,18 +8123,23 @@ handleMultiClick	(My_TerminalViewPtr		inTerminalViewPtr,
 
 
 /*!
-Like highlightVirtualRange(), but automatically uses
-the current text selection anchors for the specified
-terminal view.  Has no effect if there is no selection.
+Shows or hides the current text selection of the specified
+terminal view.  This does not change the terminal buffer
+at all: the range is only
+flagged, and applied as rows are drawn (see
+getSelectedColumnsInRow()), so the cost is independent of
+the size of the selection.  If "inRedraw" is true, the
+visible part of the range is invalidated.
 
-(3.0)
+(2021.06)
 */
 inline void
 highlightCurrentSelection	(My_TerminalViewPtr		inTerminalViewPtr,
 							 Boolean				inIsHighlighted,
 							 Boolean				inRedraw)
 {
-	if (inTerminalViewPtr->text.selection.range.first != inTerminalViewPtr->text.selection.range.second)
+	inTerminalViewPtr->text.selection.isHighlighted = inIsHighlighted;
+	if (inRedraw && (inTerminalViewPtr->text.selection.range.first != inTerminalViewPtr->text.selection.range.second))
 	{
 	#if 0
 		Console_WriteValueFloat4("Selection range",
@@ -7114,140 +8148,56 @@ highlightCurrentSelection	(My_TerminalViewPtr		inTerminalViewPtr,
 									inTerminalViewPtr->text.selection.range.second.first,
 									inTerminalViewPtr->text.selection.range.second.second);
 	#endif
-		highlightVirtualRange(inTerminalViewPtr, inTerminalViewPtr->text.selection.range,
-								kTextAttributes_Selected, inIsHighlighted, inRedraw);
+		invalidateVirtualRange(inTerminalViewPtr, inTerminalViewPtr->text.selection.range);
 	}
 }// highlightCurrentSelection
 
 
 /*!
-This method highlights text in the specified terminal
-window, from the starting point (inclusive) to the
-ending point (exclusive).
-
-The two anchors do not need to represent the start and
-end per se; this routine automatically draws the region
-between them correctly no matter which anchor is which.
+Adds the columns covered by the given search result to the
+per-row index that is used to draw search results (see
+drawSection()); this is only a change to the view, and the
+terminal buffer is not modified.  The column intervals of
+each row are kept sorted.
 
-IMPORTANT:	This changes ONLY the appearance of the text,
-			it has no effect on important internal state
-			that remembers what is selected, etc.  In
-			general, you should invoke other routines to
-			change the selection “properly” (like
-			TerminalView_SelectVirtualRange()), and let
-			those routines use this method as a helper
-			to alter text rendering.
+A range of more than one row covers the rest of its first
+row, all of any middle rows, and the start of its last row.
 
-LOCALIZE THIS:	The highlighting scheme should be
-				locale-sensitive; namely, the terminal
-				buffer may be rendered right-to-left
-				on certain systems and therefore the
-				first line should flush left and the
-				last line should flush right (reverse
-				of North American English behavior).
+Rows are stored relative to "searchResultsRowOffset", so that
+scrolling only has to change the offset (see the routine
+screenBufferChanged()) instead of rebuilding the index.  To
+remove a result, use unindexSearchResult().
 
-(3.1)
+(2021.06)
 */
 void
-highlightVirtualRange	(My_TerminalViewPtr				inTerminalViewPtr,
-						 TerminalView_CellRange const&	inRange,
-						 TextAttributes_Object			inHighlightingStyle,
-						 Boolean						inIsHighlighted,
-						 Boolean						inRedraw)
+indexSearchResult	(My_TerminalViewPtr				inTerminalViewPtr,
+					 TerminalView_CellRange const&	inRange)
 {
-	TerminalView_CellRange		orderedRange = inRange;
+	TerminalView_CellRange	orderedRange = inRange;
+	UInt16 const			kColumnCount = Terminal_ReturnColumnCount(inTerminalViewPtr->screen.ref);
 	
 	
 	// require beginning point to be “earlier” than the end point; swap points if not
-	sortAnchors(orderedRange.first, orderedRange.second, inTerminalViewPtr->text.selection.isRectangular);
+	sortAnchors(orderedRange.first, orderedRange.second, false/* is rectangular */);
 	
-	// modify selection attributes
+	for (TerminalView_RowIndex i = orderedRange.first.second; i < orderedRange.second.second; ++i)
 	{
-		Terminal_LineStackStorage	lineIteratorData;
-		Terminal_LineRef			lineIterator = findRowIteratorRelativeTo(inTerminalViewPtr, orderedRange.first.second,
-																				0/* origin row */, &lineIteratorData);
-		UInt16 const				kNumberOfRows = STATIC_CAST(orderedRange.second.second - orderedRange.first.second, UInt16);
+		My_ColumnInterval		columnInterval(0, kColumnCount);
+		My_ColumnIntervalList&	rowIntervals = inTerminalViewPtr->text.searchResultsByRow[i - inTerminalViewPtr->text.searchResultsRowOffset];
 		
 		
-		if (nullptr != lineIterator)
+		if (i == orderedRange.first.second)
 		{
-			UNUSED_RETURN(Terminal_Result)Terminal_ChangeRangeAttributes
-											(inTerminalViewPtr->screen.ref, lineIterator, kNumberOfRows,
-												orderedRange.first.first, orderedRange.second.first,
-												inTerminalViewPtr->text.selection.isRectangular,
-												(inIsHighlighted)
-												? inHighlightingStyle
-												: TextAttributes_Object()/* attributes to set */,
-												(inIsHighlighted)
-												? TextAttributes_Object()
-												: inHighlightingStyle/* attributes to clear */);
-			releaseRowIterator(inTerminalViewPtr, &lineIterator);
+			columnInterval.first = orderedRange.first.first;
 		}
-	}
-	
-	if (inRedraw)
-	{
-		// perform a boundary check, since drawSection() doesn’t do one
+		if (i == (orderedRange.second.second - 1))
 		{
-			UInt16					startColumn = 0;
-			UInt16					pastTheEndColumn = 0;
-			TerminalView_RowIndex	startRow = 0;
-			TerminalView_RowIndex	pastTheEndRow = 0;
-			
-			
-			getVirtualVisibleRegion(inTerminalViewPtr, &startColumn, &startRow, &pastTheEndColumn, &pastTheEndRow);
-			
-			// note that these coordinates are local to the visible area,
-			// and are independent of what part of the buffer is shown;
-			// use the size of the visible region to determine these
-			// local coordinates
-			if (orderedRange.second.second >= pastTheEndRow)
-			{
-				orderedRange.second.second = pastTheEndRow;
-			}
-			if (orderedRange.second.first >= pastTheEndColumn)
-			{
-				orderedRange.second.first = pastTheEndColumn;
-			}
-		}
-		
-		// redraw affected area; for rectangular selections it is only
-		// necessary to redraw the actual range, but for normal selections
-		// (which primarily consist of full-width highlighting), the entire
-		// width in the given row range is redrawn
-		if (orderedRange.second.second - orderedRange.first.second > 20/* arbitrary; some large number of rows */)
-		{
-			// just redraw everything
-			updateDisplay(inTerminalViewPtr);
-		}
-		else
-		{
-		#if 0
-			// Core Graphics and QuickDraw tend to clash and introduce
-			// antialiasing artifacts in edge cases; rather than try to
-			// debug all of the places this could happen, a full screen
-			// refresh is forced while tracking text selections
-			updateDisplay(inTerminalViewPtr);
-		#else
-			UInt16 const	kFirstChar = (inTerminalViewPtr->text.selection.isRectangular)
-											? orderedRange.first.first
-											: 0;
-			UInt16 const	kPastLastChar = (inTerminalViewPtr->text.selection.isRectangular)
-											? orderedRange.second.first
-											: Terminal_ReturnColumnCount(inTerminalViewPtr->screen.ref);
-			
-			
-			for (UInt16 rowIndex = orderedRange.first.second - inTerminalViewPtr->screen.topVisibleEdgeInRows;
-					rowIndex < orderedRange.second.second - inTerminalViewPtr->screen.topVisibleEdgeInRows;
-					++rowIndex)
-			{
-				invalidateRowSection(inTerminalViewPtr, rowIndex,
-										kFirstChar, kPastLastChar - kFirstChar/* count */);
-			}
-		#endif
+			columnInterval.second = orderedRange.second.first;
 		}
+		rowIntervals.insert(std::lower_bound(rowIntervals.begin(), rowIntervals.end(), columnInterval), columnInterval);
 	}
-}// highlightVirtualRange
+}// indexSearchResult
 
 
 /*!
@@ -7289,6 +8239,87 @@ invalidateRowSection	(My_TerminalViewPtr		inTerminalViewPtr,
 }// invalidateRowSection
 
 
+/*!
+Marks the visible part of the given range of cells as
+requiring rendering.  The two anchors may be given in
+either order.  For rectangular selections only the range
+itself is redrawn; otherwise, the full width of each row
+is redrawn, and large ranges redraw the whole view.
+
+(2021.06)
+*/
+void
+invalidateVirtualRange	(My_TerminalViewPtr				inTerminalViewPtr,
+						 TerminalView_CellRange const&	inRange)
+{
+	TerminalView_CellRange		orderedRange = inRange;
+	
+	
+	// require beginning point to be “earlier” than the end point; swap points if not
+	sortAnchors(orderedRange.first, orderedRange.second, inTerminalViewPtr->text.selection.isRectangular);
+	
+	// perform a boundary check, since drawSection() doesn’t do one
+	{
+		UInt16					startColumn = 0;
+		UInt16					pastTheEndColumn = 0;
+		TerminalView_RowIndex	startRow = 0;
+		TerminalView_RowIndex	pastTheEndRow = 0;
+		
+		
+		getVirtualVisibleRegion(inTerminalViewPtr, &startColumn, &startRow, &pastTheEndColumn, &pastTheEndRow);
+		
+		// note that these coordinates are local to the visible area,
+		// and are independent of what part of the buffer is shown;
+		// use the size of the visible region to determine these
+		// local coordinates
+		if (orderedRange.second.second >= pastTheEndRow)
+		{
+			orderedRange.second.second = pastTheEndRow;
+		}
+		if (orderedRange.second.first >= pastTheEndColumn)
+		{
+			orderedRange.second.first = pastTheEndColumn;
+		}
+	}
+	
+	// redraw affected area; for rectangular selections it is only
+	// necessary to redraw the actual range, but for normal selections
+	// (which primarily consist of full-width highlighting), the entire
+	// width in the given row range is redrawn
+	if (orderedRange.second.second - orderedRange.first.second > 20/* arbitrary; some large number of rows */)
+	{
+		// just redraw everything
+		updateDisplay(inTerminalViewPtr);
+	}
+	else
+	{
+	#if 0
+		// Core Graphics and QuickDraw tend to clash and introduce
+		// antialiasing artifacts in edge cases; rather than try to
+		// debug all of the places this could happen, a full screen
+		// refresh is forced while tracking text selections
+		updateDisplay(inTerminalViewPtr);
+	#else
+		UInt16 const	kFirstChar = (inTerminalViewPtr->text.selection.isRectangular)
+										? orderedRange.first.first
+										: 0;
+		UInt16 const	kPastLastChar = (inTerminalViewPtr->text.selection.isRectangular)
+										? orderedRange.second.first
+										: Terminal_ReturnColumnCount(inTerminalViewPtr->screen.ref);
+		
+		
+		for (UInt16 rowIndex = orderedRange.first.second - inTerminalViewPtr->screen.topVisibleEdgeInRows;
+				rowIndex < orderedRange.second.second - inTerminalViewPtr->screen.topVisibleEdgeInRows;
+				++rowIndex)
+		{
+			invalidateRowSection(inTerminalViewPtr, rowIndex,
+									kFirstChar, kPastLastChar - kFirstChar/* count */);
+		}
+	#endif
+	}
+}// invalidateVirtualRange
+
+
 /*!
 Returns true only if the specified terminal view
 should use a small-size I-beam mouse pointer.
@@ -7750,8 +8781,7 @@ preferenceChanged	(ListenerModel_Ref		UNUSED_ARGUMENT(inUnusedModel),
 	case kPreferences_TagCursorBlinks:
 		// update global variable with current preference value
 		unless (kPreferences_ResultOK ==
-				Preferences_GetData(kPreferences_TagCursorBlinks, sizeof(gPreferenceProxies.cursorBlinks),
-									&gPreferenceProxies.cursorBlinks))
+				Preferences_GetValue< kPreferences_TagCursorBlinks >(gPreferenceProxies.cursorBlinks))
 		{
 			gPreferenceProxies.cursorBlinks = false; // assume a value, if preference can’t be found
 		}
@@ -7760,8 +8790,7 @@ preferenceChanged	(ListenerModel_Ref		UNUSED_ARGUMENT(inUnusedModel),
 	case kPreferences_TagNotifyOfBeeps:
 		// update global variable with current preference value
 		unless (kPreferences_ResultOK ==
-				Preferences_GetData(kPreferences_TagNotifyOfBeeps, sizeof(gPreferenceProxies.notifyOfBeeps),
-									&gPreferenceProxies.notifyOfBeeps))
+				Preferences_GetValue< kPreferences_TagNotifyOfBeeps >(gPreferenceProxies.notifyOfBeeps))
 		{
 			gPreferenceProxies.notifyOfBeeps = false; // assume a value, if preference can’t be found
 		}
@@ -7770,8 +8799,7 @@ preferenceChanged	(ListenerModel_Ref		UNUSED_ARGUMENT(inUnusedModel),
 	case kPreferences_TagPureInverse:
 		// update global variable with current preference value
 		unless (kPreferences_ResultOK ==
-				Preferences_GetData(kPreferences_TagPureInverse, sizeof(gPreferenceProxies.invertSelections),
-									&gPreferenceProxies.invertSelections))
+				Preferences_GetValue< kPreferences_TagPureInverse >(gPreferenceProxies.invertSelections))
 		{
 			gPreferenceProxies.invertSelections = false; // assume a value, if preference can’t be found
 		}
@@ -7790,8 +8818,7 @@ preferenceChanged	(ListenerModel_Ref		UNUSED_ARGUMENT(inUnusedModel),
 	case kPreferences_TagTerminalShowMarginAtColumn:
 		// update global variable with current preference value
 		unless (kPreferences_ResultOK ==
-				Preferences_GetData(kPreferences_TagTerminalShowMarginAtColumn, sizeof(gPreferenceProxies.renderMarginAtColumn),
-									&gPreferenceProxies.renderMarginAtColumn))
+				Preferences_GetValue< kPreferences_TagTerminalShowMarginAtColumn >(gPreferenceProxies.renderMarginAtColumn))
 		{
 			gPreferenceProxies.renderMarginAtColumn = 0; // assume a value, if preference can’t be found
 		}
@@ -7835,8 +8862,7 @@ preferenceChangedForView	(ListenerModel_Ref		UNUSED_ARGUMENT(inUnusedModel),
 			{
 				// update global variable with current preference value
 				unless (kPreferences_ResultOK ==
-						Preferences_GetData(kPreferences_TagDontDimBackgroundScreens, sizeof(gPreferenceProxies.dontDimTerminals),
-											&gPreferenceProxies.dontDimTerminals))
+						Preferences_GetValue< kPreferences_TagDontDimBackgroundScreens >(gPreferenceProxies.dontDimTerminals))
 				{
 					gPreferenceProxies.dontDimTerminals = false; // assume a value, if preference can’t be found
 				}
@@ -7880,8 +8906,7 @@ preferenceChangedForView	(ListenerModel_Ref		UNUSED_ARGUMENT(inUnusedModel),
 				
 				
 				unless (kPreferences_ResultOK ==
-						Preferences_GetData(kPreferences_TagTerminalResizeAffectsFontSize, sizeof(resizeAffectsFont),
-											&resizeAffectsFont))
+						Preferences_GetValue< kPreferences_TagTerminalResizeAffectsFontSize >(resizeAffectsFont))
 				{
 					resizeAffectsFont = false; // assume a value, if preference can’t be found
 				}
@@ -8024,6 +9049,11 @@ removeDataSource	(My_TerminalViewPtr		inTerminalViewPtr,
 /*!
 Internal version of TerminalView_ReturnSelectedTextCopyAsUnicode().
 
+The text is converted by a Text Export (the same one that
+TerminalView_StartSelectedTextExport() uses, so that copied
+and saved text are identical) into one buffer of UTF-8,
+from which the string is created.
+
 (3.1)
 */
 CFStringRef
@@ -8036,201 +9066,100 @@ returnSelectedTextCopyAsUnicode		(My_TerminalViewPtr			inTerminalViewPtr,
 	
 	if (selectionExists(inTerminalViewPtr))
 	{
-		TerminalView_Cell const&	kSelectionStart = inTerminalViewPtr->text.selection.range.first;
-		TerminalView_Cell const&	kSelectionPastEnd = inTerminalViewPtr->text.selection.range.second;
-		// TEMPORARY: It is probably easy enough to determine what this size should be in advance,
-		// which would save a lot of reallocations.
-		CFMutableStringRef			resultMutable = CFStringCreateMutable(kCFAllocatorDefault, 0/* size limit */);
+		std::vector< UInt8 >	textBytes;
+		TextExport_Ref			textExport = TextExport_New(returnTextExportOptions(inFlags), inMaxSpacesToReplaceWithTabOrZero,
+															kMy_ExportChunkSize,
+															[&textBytes] (AsyncWriter_Buffer inChunk)
+															{
+																textBytes.insert(textBytes.end(), inChunk->begin(), inChunk->end());
+															});
 		
 		
-		if (nullptr != resultMutable)
+		if (nullptr != textExport)
 		{
-			Terminal_LineStackStorage	lineIteratorData;
-			Terminal_LineRef			lineIterator = findRowIteratorRelativeTo(inTerminalViewPtr, 0,
-																					kSelectionStart.second,
-																					&lineIteratorData);
-			Terminal_Result				iteratorAdvanceResult = kTerminal_ResultOK;
-			Terminal_Result				textGrabResult = kTerminal_ResultOK;
-			Terminal_Result				attributeGrabResult = kTerminal_ResultOK;
+			TerminalView_RowIndex	nextRow = inTerminalViewPtr->text.selection.range.first.second;
 			
 			
-			// read every line of Unicode characters within this range;
-			// if appropriate, ignore some characters on each line
-			for (CFIndex i = kSelectionStart.second; i < kSelectionPastEnd.second; ++i)
-			{
-				CFStringRef				referenceCFString = nullptr;
-				CFRange					stringRange = CFRangeMake(0, 0);
-				TextAttributes_Object	lineGlobalAttributes;
-				Boolean					skipLine = false;
-				
-				
-				attributeGrabResult = Terminal_GetLineGlobalAttributes(inTerminalViewPtr->screen.ref, lineIterator, &lineGlobalAttributes);
-				if (kTerminal_ResultOK == attributeGrabResult)
-				{
-					if (lineGlobalAttributes.hasDoubleHeightTop())
-					{
-						// double-height text is replicated on two lines and the top half
-						// is not rendered at all; skip the top half (the bottom half
-						// will have identical text and this will match the user’s
-						// expectation of seeing the text only appear once)
-						skipLine = true;
-					}
-				}
-				
-				if (false == skipLine)
-				{
-					if ((inTerminalViewPtr->text.selection.isRectangular) ||
-						(1 == (kSelectionPastEnd.second - kSelectionStart.second)))
-					{
-						// for rectangular or one-line selections, copy a specific column range
-						textGrabResult = Terminal_GetLineRange(inTerminalViewPtr->screen.ref, lineIterator,
-																kSelectionStart.first, kSelectionPastEnd.first,
-																referenceCFString, stringRange);
-						if (kTerminal_ResultOK != textGrabResult)
-						{
-							Console_Warning(Console_WriteValue, "one-line text copy failed, terminal error", textGrabResult);
-							break;
-						}
-					}
-					else
-					{
-						// for standard selections, the first and last lines are different
-						// TEMPORARY: whitespace exclusion flags are mostly a hack to work
-						// around the fact that terminals do not currently know where a
-						// line actually ends; they store whitespace for the full width,
-						// and it is undesirable to pad copied lines with meaningless spaces;
-						// heuristics are employed to arbitrarily strip this end space most
-						// of the time, making an exception for short (~2 line) wraps that
-						// are most likely part of the same, continuing line anyway
-						if (i == kSelectionStart.second)
-						{
-							// first line is anchored at the end (LOCALIZE THIS)
-							textGrabResult = Terminal_GetLineRange(inTerminalViewPtr->screen.ref, lineIterator,
-																	kSelectionStart.first, -1/* end column */,
-																	referenceCFString, stringRange,
-																	(2/* arbitrary */ == (kSelectionPastEnd.second - kSelectionStart.second))
-																		? 0/* flags */
-																		: kTerminal_TextFilterFlagsNoEndWhitespace);
-							if (kTerminal_ResultOK != textGrabResult)
-							{
-								Console_Warning(Console_WriteValue, "first-line-anchored-at-end text copy failed, terminal error", textGrabResult);
-								break;
-							}
-						}
-						else if (i == (kSelectionPastEnd.second - 1))
-						{
-							// last line is anchored at the beginning (LOCALIZE THIS)
-							textGrabResult = Terminal_GetLineRange(inTerminalViewPtr->screen.ref, lineIterator,
-																	0/* start column */, kSelectionPastEnd.first,
-																	referenceCFString, stringRange, kTerminal_TextFilterFlagsNoEndWhitespace);
-							if (kTerminal_ResultOK != textGrabResult)
-							{
-								Console_Warning(Console_WriteValue, "last-line-anchored-at-beginning text copy failed, terminal error", textGrabResult);
-								break;
-							}
-						}
-						else
-						{
-							// middle lines span the whole width
-							textGrabResult = Terminal_GetLine(inTerminalViewPtr->screen.ref, lineIterator,
-																referenceCFString, stringRange, kTerminal_TextFilterFlagsNoEndWhitespace);
-							if (kTerminal_ResultOK != textGrabResult)
-							{
-								Console_Warning(Console_WriteValue, "middle-spanning-line text copy failed, terminal error", textGrabResult);
-								break;
-							}
-						}
-					}
-					
-					// add the characters for the line...
-					{
-						CFRetainRelease		substringObject(CFStringCreateWithSubstring(kCFAllocatorDefault, referenceCFString, stringRange),
-															CFRetainRelease::kAlreadyRetained);
-						
-						
-						if (substringObject.exists())
-						{
-							CFStringAppend(resultMutable, substringObject.returnCFStringRef());
-							
-							// perform spaces-to-tabs substitution; this could be done while
-							// appending text in the first place but instead it is done as a
-							// lazy post-processing step (also, no effort is made to perform
-							// particularly well...multiple linear searches are done to
-							// iteratively replace ranges of spaces)
-							if (inMaxSpacesToReplaceWithTabOrZero > 0)
-							{
-								// create a string to represent the required whitespace range
-								// (TEMPORARY: there is no reason to do this every time, it
-								// could be cached at the time the user preference changes;
-								// for now however the lazy approach is being taken)
-								CFRetainRelease		spacesString(StringUtilities_ReturnBlankStringCopy(inMaxSpacesToReplaceWithTabOrZero),
-																	CFRetainRelease::kAlreadyRetained);
-								CFStringRef			tabString = CFSTR("\011"); // LOCALIZE THIS?
-								
-								
-								// first replace all “long” series of spaces with single tabs, as per user preference
-								UNUSED_RETURN(CFIndex)CFStringFindAndReplace(resultMutable, spacesString.returnCFStringRef(), tabString,
-																				CFRangeMake(0, CFStringGetLength(resultMutable)),
-																				0/* comparison options */);
-								
-								// replace all smaller ranges of spaces with one tab as well
-								for (UInt16 maxSpaces = (inMaxSpacesToReplaceWithTabOrZero - 1); maxSpaces > 0; --maxSpaces)
-								{
-									// create a string representing the next-smallest range of spaces...
-									CFRetainRelease		smallerSpacesString(StringUtilities_ReturnBlankStringCopy(maxSpaces),
-																			CFRetainRelease::kAlreadyRetained);
-									
-									
-									// ...and turn those spaces into a tab
-									UNUSED_RETURN(CFIndex)CFStringFindAndReplace(resultMutable, smallerSpacesString.returnCFStringRef(), tabString,
-																					CFRangeMake(0, CFStringGetLength(resultMutable)),
-																					0/* comparison options */);
-								}
-							}
-						}
-					}
-					
-					// if requested, add a new-line
-					if (0 == (inFlags & kTerminalView_TextFlagInline))
-					{
-						// do not terminate last line unless requested
-						if ((i < (kSelectionPastEnd.second - 1)) ||
-							(0 != (inFlags & kTerminalView_TextFlagLastLineHasSeparator)))
-						{
-							// TEMPORARY; should this also have the option of capturing
-							// text in other ways, such as the session’s default line-endings?
-							if (inFlags & kTerminalView_TextFlagLineSeparatorLF)
-							{
-								CFStringAppendCString(resultMutable, "\012", kCFStringEncodingASCII);
-							}
-							else
-							{
-								CFStringAppendCString(resultMutable, "\015", kCFStringEncodingASCII);
-							}
-						}
-					}
-				}
-				
-				iteratorAdvanceResult = Terminal_LineIteratorAdvance(inTerminalViewPtr->screen.ref, lineIterator, +1);
-				if (kTerminal_ResultIteratorCannotAdvance == iteratorAdvanceResult)
-				{
-					// last line of the buffer has been reached
-					break;
-				}
-			}
-			releaseRowIterator(inTerminalViewPtr, &lineIterator);
+			// if a line cannot be read, the text up to that line is returned
+			UNUSED_RETURN(Boolean)exportSelectedRows(inTerminalViewPtr, inTerminalViewPtr->text.selection.range,
+														inTerminalViewPtr->text.selection.isRectangular,
+														inTerminalViewPtr->text.selection.range.second.second, nextRow, textExport);
+			UNUSED_RETURN(TextExport_Result)TextExport_Finish(textExport);
+			TextExport_Dispose(&textExport);
 			
-			result = resultMutable;
+			result = CFStringCreateWithBytes(kCFAllocatorDefault, textBytes.data(), textBytes.size(),
+												kCFStringEncodingUTF8, false/* is external representation */);
 		}
 	}
-	else
+	else
+	{
+		result = CFSTR("");
+		CFRetain(result);
+	}
+	
+	return result;
+}// returnSelectedTextCopyAsUnicode
+
+
+/*!
+Returns the export of the given view that publishes the given
+progress, or nullptr if there is no such export (for instance,
+because it has already ended).
+
+(2021.06)
+*/
+My_SelectionExportPtr
+returnSelectionExport	(My_TerminalViewPtr		inTerminalViewPtr,
+						 NSProgress*			inExportProgress)
+{
+	My_SelectionExportPtr	result = nullptr;
+	
+	
+	if ((nullptr != inTerminalViewPtr) && (nil != inExportProgress))
+	{
+		auto	toExport = std::find_if(inTerminalViewPtr->text.selectionExports.begin(),
+										inTerminalViewPtr->text.selectionExports.end(),
+										[inExportProgress] (My_SelectionExportPtr const& anExportPtr)
+										{
+											return (inExportProgress == anExportPtr->progress);
+										});
+		
+		
+		if (toExport != inTerminalViewPtr->text.selectionExports.end())
+		{
+			result = *toExport;
+		}
+	}
+	return result;
+}// returnSelectionExport
+
+
+/*!
+Returns the Text Export options that produce the text that
+the given flags describe.
+
+(2021.06)
+*/
+TextExport_Options
+returnTextExportOptions		(TerminalView_TextFlags		inFlags)
+{
+	TextExport_Options		result = kTextExport_OptionsNone;
+	
+	
+	if (inFlags & kTerminalView_TextFlagInline)
+	{
+		result |= kTextExport_OptionInline;
+	}
+	if (inFlags & kTerminalView_TextFlagLineSeparatorLF)
 	{
-		result = CFSTR("");
-		CFRetain(result);
+		result |= kTextExport_OptionLineSeparatorLF;
+	}
+	if (inFlags & kTerminalView_TextFlagLastLineHasSeparator)
+	{
+		result |= kTextExport_OptionLastLineHasSeparator;
 	}
-	
 	return result;
-}// returnSelectedTextCopyAsUnicode
+}// returnTextExportOptions
 
 
 /*!
@@ -8324,6 +9253,48 @@ screenBufferChanged		(ListenerModel_Ref		UNUSED_ARGUMENT(inUnusedModel),
 			viewPtr->text.selection.range.second.second += rangeInfoPtr->rowDelta;
 			highlightCurrentSelection(viewPtr, true/* highlight */, true/* draw */);
 			
+			// rows that have not been exported yet move in the same way
+			for (auto const& exportPtr : viewPtr->text.selectionExports)
+			{
+				exportPtr->range.first.second += rangeInfoPtr->rowDelta;
+				exportPtr->range.second.second += rangeInfoPtr->rowDelta;
+				exportPtr->nextRow += rangeInfoPtr->rowDelta;
+			}
+			
+			// search results move with the text, and are dropped if
+			// their rows scrolled off the end or were cleared
+			if (false == viewPtr->text.searchResults.empty())
+			{
+				TerminalView_RowIndex const		kFirstValidRow = -STATIC_CAST(Terminal_ReturnInvisibleRowCount(viewPtr->screen.ref),
+																				TerminalView_RowIndex);
+				TerminalView_RowIndex const		kPastLastValidRow = Terminal_ReturnRowCount(viewPtr->screen.ref);
+				
+				
+				TerminalView_CellRangeList		removedResults;
+				
+				
+				// the index is not rebuilt: its rows move by changing the
+				// offset, and only the results that were dropped are removed
+				viewPtr->text.searchResultsRowOffset += rangeInfoPtr->rowDelta;
+				if (shiftSearchResults(viewPtr->text.searchResults, viewPtr->text.toCurrentSearchResult, rangeInfoPtr->rowDelta,
+										kFirstValidRow, kPastLastValidRow, &removedResults) ||
+					(0 != rangeInfoPtr->rowDelta))
+				{
+					for (auto const& resultRange : removedResults)
+					{
+						unindexSearchResult(viewPtr, resultRange);
+					}
+					
+					// TEMPORARY - efficiency may demand a unique type of event for this
+					eventNotifyForView(viewPtr, kTerminalView_EventScrolling, viewPtr->selfRef/* context */);
+					
+					if (viewPtr->text.searchResults.empty())
+					{
+						eventNotifyForView(viewPtr, kTerminalView_EventSearchResultsExistence, viewPtr->selfRef/* context */);
+					}
+				}
+			}
+			
 			updateDisplay(viewPtr);
 		}
 		break;
@@ -9178,7 +10149,7 @@ setTextAttributesDictionary		(My_TerminalViewPtr			inTerminalViewPtr,
 			
 			
 			// find the correct colors in the color table
-			getScreenColorsForAttributes(inTerminalViewPtr, inAttributes,
+			getScreenColorsForAttributes(inTerminalViewPtr, inAttributes, inTerminalViewPtr->text.inlineColors,
 											&foregroundDeviceColor, &backgroundDeviceColor,
 											&inTerminalViewPtr->screen.currentRenderNoBackground);
 			foregroundNSColor = [NSColor colorWithCalibratedRed:foregroundDeviceColor.red
@@ -9456,6 +10427,84 @@ setUpScreenFontMetrics	(My_TerminalViewPtr		inTerminalViewPtr)
 }// setUpScreenFontMetrics
 	
 
+/*!
+Moves every range in the given search results by the given
+number of rows (as the text moved in a scroll), and removes
+any range that is no longer entirely within the valid rows:
+from "inFirstValidRow" (negative for scrollback) up to but
+not including "inPastLastValidRow".  The iterator to the
+current result is kept valid: if that result is removed,
+the next remaining result (or the first one, if there is no
+next one) becomes current; and if no results remain, it
+becomes the end iterator.
+
+If a list is given, each removed range is appended to it (as
+moved), so that only those ranges have to be removed from
+anything else that refers to the results.
+
+Returns true only if any ranges were removed.
+
+(2021.06)
+*/
+Boolean
+shiftSearchResults	(TerminalView_CellRangeList&				inoutResults,
+					 TerminalView_CellRangeList::iterator&		inoutCurrentResult,
+					 SInt16										inRowDelta,
+					 TerminalView_RowIndex						inFirstValidRow,
+					 TerminalView_RowIndex						inPastLastValidRow,
+					 TerminalView_CellRangeList*				outRemovedResultsOrNull)
+{
+	size_t const	kOldCount = inoutResults.size();
+	Boolean const	kCurrentWasEnd = (inoutResults.end() == inoutCurrentResult);
+	size_t			currentIndex = STATIC_CAST(std::distance(inoutResults.begin(), inoutCurrentResult), size_t);
+	size_t			keptCount = 0;
+	Boolean			result = false;
+	
+	
+	for (size_t i = 0; i < kOldCount; ++i)
+	{
+		TerminalView_CellRange&		resultRange = inoutResults[i];
+		
+		
+		resultRange.first.second += inRowDelta;
+		resultRange.second.second += inRowDelta;
+		if ((std::min(resultRange.first.second, resultRange.second.second) >= inFirstValidRow) &&
+			(std::max(resultRange.first.second, resultRange.second.second) <= inPastLastValidRow))
+		{
+			inoutResults[keptCount] = resultRange;
+			++keptCount;
+		}
+		else
+		{
+			if (nullptr != outRemovedResultsOrNull)
+			{
+				outRemovedResultsOrNull->push_back(resultRange);
+			}
+			if (i < currentIndex)
+			{
+				// the current result moves down in the list
+				--currentIndex;
+			}
+		}
+	}
+	
+	result = (keptCount != kOldCount);
+	inoutResults.resize(keptCount);
+	if (kCurrentWasEnd || inoutResults.empty())
+	{
+		currentIndex = keptCount;
+	}
+	else if (currentIndex >= keptCount)
+	{
+		// the current result was the last one; wrap around
+		currentIndex = 0;
+	}
+	inoutCurrentResult = inoutResults.begin() + currentIndex;
+	
+	return result;
+}// shiftSearchResults
+
+
 /*!
 Ensures that the first point given is “sooner” in a
 left-to-right localization than the 2nd point.  In
@@ -9648,6 +10697,139 @@ stopMonitoringDataSource	(My_TerminalViewPtr		inTerminalViewPtr,
 }// stopMonitoringDataSource
 
 
+/*!
+Removes the columns covered by the given search result from
+the per-row index that is used to draw search results; this
+reverses indexSearchResult() for the same range (in current
+rows), and does not affect other results on the same rows.
+A row with no intervals left is removed from the index.
+
+(2021.06)
+*/
+void
+unindexSearchResult		(My_TerminalViewPtr				inTerminalViewPtr,
+						 TerminalView_CellRange const&	inRange)
+{
+	TerminalView_CellRange	orderedRange = inRange;
+	UInt16 const			kColumnCount = Terminal_ReturnColumnCount(inTerminalViewPtr->screen.ref);
+	
+	
+	// require beginning point to be “earlier” than the end point; swap points if not
+	sortAnchors(orderedRange.first, orderedRange.second, false/* is rectangular */);
+	
+	for (TerminalView_RowIndex i = orderedRange.first.second; i < orderedRange.second.second; ++i)
+	{
+		auto	toRowIntervals = inTerminalViewPtr->text.searchResultsByRow.find(i - inTerminalViewPtr->text.searchResultsRowOffset);
+		
+		
+		if (inTerminalViewPtr->text.searchResultsByRow.end() != toRowIntervals)
+		{
+			My_ColumnInterval		columnInterval(0, kColumnCount);
+			My_ColumnIntervalList&	rowIntervals = toRowIntervals->second;
+			
+			
+			if (i == orderedRange.first.second)
+			{
+				columnInterval.first = orderedRange.first.first;
+			}
+			if (i == (orderedRange.second.second - 1))
+			{
+				columnInterval.second = orderedRange.second.first;
+			}
+			
+			{
+				auto	toInterval = std::lower_bound(rowIntervals.begin(), rowIntervals.end(), columnInterval);
+				
+				
+				if ((rowIntervals.end() != toInterval) && (columnInterval == *toInterval))
+				{
+					rowIntervals.erase(toInterval);
+				}
+			}
+			
+			if (rowIntervals.empty())
+			{
+				inTerminalViewPtr->text.searchResultsByRow.erase(toRowIntervals);
+			}
+		}
+	}
+}// unindexSearchResult
+
+
+/*!
+Tests shiftSearchResults(): search results must move with
+the text when it scrolls, results whose rows scroll off the
+end of the scrollback or the bottom of the screen must be
+dropped (and reported, so that they can be removed from the
+index of rows), and the current result must remain valid.
+
+Returns "true" if ALL assertions pass; "false" is
+returned if any fail, however messages should be
+printed for ALL assertion failures regardless.
+
+(2021.06)
+*/
+Boolean
+unitTest_ShiftSearchResults_000 ()
+{
+	TerminalView_CellRangeList				searchResults;
+	TerminalView_CellRangeList::iterator	toCurrentResult;
+	TerminalView_CellRangeList				removedResults;
+	Boolean									result = true;
+	
+	
+	// 3 matches found: one in the scrollback (3 lines), two on the screen (24 lines)
+	searchResults.push_back(TerminalView_CellRange(TerminalView_Cell(5, -3), TerminalView_Cell(9, -2)));
+	searchResults.push_back(TerminalView_CellRange(TerminalView_Cell(0, 0), TerminalView_Cell(4, 1)));
+	searchResults.push_back(TerminalView_CellRange(TerminalView_Cell(2, 23), TerminalView_Cell(6, 24)));
+	toCurrentResult = searchResults.begin() + 1;
+	
+	// scroll 1 line up with room in the scrollback: everything moves, nothing is dropped
+	Console_TestAssertUpdate(result, false == shiftSearchResults(searchResults, toCurrentResult, -1, -4, 24),
+								Console_WriteLine, "results were dropped although all are still valid");
+	Console_TestAssertUpdate(result, (3 == searchResults.size()) && (-4 == searchResults[0].first.second) &&
+										(-1 == searchResults[1].first.second) && (0 == searchResults[1].second.second) &&
+										(22 == searchResults[2].first.second),
+								Console_WriteValue, "results did not move by 1 row; count", searchResults.size());
+	Console_TestAssertUpdate(result, (searchResults.begin() + 1) == toCurrentResult,
+								Console_WriteLine, "current result changed although it was not dropped");
+	
+	// scroll 1 more line up with a full scrollback: the oldest result is dropped
+	Console_TestAssertUpdate(result, shiftSearchResults(searchResults, toCurrentResult, -1, -4, 24, &removedResults),
+								Console_WriteLine, "result that scrolled off the scrollback was not dropped");
+	Console_TestAssertUpdate(result, (1 == removedResults.size()) && (5 == removedResults[0].first.first) &&
+										(-5 == removedResults[0].first.second),
+								Console_WriteValue, "dropped result was not reported as moved; count", removedResults.size());
+	Console_TestAssertUpdate(result, (2 == searchResults.size()) && (-2 == searchResults[0].first.second) &&
+										(21 == searchResults[1].first.second),
+								Console_WriteValue, "wrong results remain; count", searchResults.size());
+	Console_TestAssertUpdate(result, (searchResults.begin() == toCurrentResult) && (0 == toCurrentResult->first.first),
+								Console_WriteLine, "current result did not follow its match");
+	
+	// scroll down so the last result is clipped at the bottom: it is dropped while current
+	toCurrentResult = searchResults.begin() + 1;
+	Console_TestAssertUpdate(result, shiftSearchResults(searchResults, toCurrentResult, 3, -4, 24),
+								Console_WriteLine, "result that scrolled off the screen was not dropped");
+	Console_TestAssertUpdate(result, (1 == searchResults.size()) && (1 == searchResults[0].first.second) &&
+										(searchResults.begin() == toCurrentResult),
+								Console_WriteValue, "current result is not the remaining one; count", searchResults.size());
+	
+	// clearing the scrollback (no scrolling) drops results in the scrollback
+	searchResults.push_back(TerminalView_CellRange(TerminalView_Cell(0, -1), TerminalView_Cell(4, 0)));
+	toCurrentResult = searchResults.begin();
+	Console_TestAssertUpdate(result, shiftSearchResults(searchResults, toCurrentResult, 0, 0, 24) &&
+										(1 == searchResults.size()) && (searchResults.begin() == toCurrentResult),
+								Console_WriteValue, "scrollback result was not dropped; count", searchResults.size());
+	
+	// when nothing remains, the current result is the end
+	Console_TestAssertUpdate(result, shiftSearchResults(searchResults, toCurrentResult, -30, 0, 24) &&
+										searchResults.empty() && (searchResults.end() == toCurrentResult),
+								Console_WriteLine, "current result is not the end after all results were dropped");
+	
+	return result;
+}// unitTest_ShiftSearchResults_000
+
+
 /*!
 Arranges for the entire terminal screen to be redrawn at the
 next opportunity.
@@ -9720,6 +10902,51 @@ updateDisplayInShapeSubRect		(int			inMessage,
 }// updateDisplayInShapeSubRect
 
 
+/*!
+Underlines the link under the given point (in view
+coordinates) while the Command key is down, since that
+key opens a link when it is clicked; otherwise, removes
+any underline.  Only rows that change are redrawn.
+
+(2021.06)
+*/
+void
+updateHoveredLink	(My_TerminalViewPtr		inTerminalViewPtr,
+					 NSPoint				inViewLocation,
+					 NSEventModifierFlags	inModifierFlags)
+{
+	TerminalView_CellRange		newRange(TerminalView_Cell(0, 0), TerminalView_Cell(0, 0));
+	
+	
+	// Command-Option is the modifier for moving the cursor, not for links
+	if ((0 != (inModifierFlags & NSEventModifierFlagCommand)) && (0 == (inModifierFlags & NSEventModifierFlagOption)))
+	{
+		TerminalView_Cell	mouseCell;
+		CFStringRef			uriCFString = nullptr;
+		
+		
+		if (findVirtualCellFromScreenPoint(inTerminalViewPtr, CGPointMake(inViewLocation.x, inViewLocation.y), mouseCell) &&
+			copyLinkAtCell(inTerminalViewPtr, mouseCell, newRange, uriCFString))
+		{
+			CFRelease(uriCFString), uriCFString = nullptr;
+		}
+	}
+	
+	if (newRange != inTerminalViewPtr->text.hoveredLink)
+	{
+		if (inTerminalViewPtr->text.hoveredLink.first != inTerminalViewPtr->text.hoveredLink.second)
+		{
+			invalidateVirtualRange(inTerminalViewPtr, inTerminalViewPtr->text.hoveredLink);
+		}
+		inTerminalViewPtr->text.hoveredLink = newRange;
+		if (newRange.first != newRange.second)
+		{
+			invalidateVirtualRange(inTerminalViewPtr, newRange);
+		}
+	}
+}// updateHoveredLink
+
+
 /*!
 Sets the background color and pattern settings (and ONLY those
 settings) of the current QuickDraw port and the specified
@@ -9742,11 +10969,12 @@ IMPORTANT:	Core Graphics support is INCOMPLETE.  This routine
 (3.1)
 */
 void
-useTerminalTextColors	(My_TerminalViewPtr			inTerminalViewPtr,
-						 CGContextRef				inDrawingContext,
-						 TextAttributes_Object		inAttributes,
-						 Boolean					inIsCursor,
-						 Float32					inDesiredAlpha)
+useTerminalTextColors	(My_TerminalViewPtr					inTerminalViewPtr,
+						 CGContextRef						inDrawingContext,
+						 TextAttributes_Object				inAttributes,
+						 TextAttributes_InlineColors const&	inInlineColors,
+						 Boolean							inIsCursor,
+						 Float32							inDesiredAlpha)
 {
 	// Cocoa and Quartz setup
 	CGFloatRGBColor		backgroundDeviceColor;
@@ -9754,7 +10982,7 @@ useTerminalTextColors	(My_TerminalViewPtr			inTerminalViewPtr,
 	
 	
 	// find the correct colors in the color table
-	getScreenColorsForAttributes(inTerminalViewPtr, inAttributes,
+	getScreenColorsForAttributes(inTerminalViewPtr, inAttributes, inInlineColors,
 									&foregroundDeviceColor, &backgroundDeviceColor,
 									&inTerminalViewPtr->screen.currentRenderNoBackground);
 	
@@ -10196,6 +11424,13 @@ initWithFrame:(NSRect)		aFrame
 											//BRIDGE_CAST(kUTTypeFolder, NSString*), // also a directory
 										]];
 		
+		// the mouse is tracked only to underline links while the
+		// Command key is down (see "mouseMoved:")
+		[self addTrackingArea:[[NSTrackingArea alloc] initWithRect:NSZeroRect
+																options:(NSTrackingMouseMoved | NSTrackingMouseEnteredAndExited |
+																			NSTrackingActiveInKeyWindow | NSTrackingInVisibleRect)
+																owner:self userInfo:nil]];
+		
 		self.refusesFirstResponder = NO;
 		self.wantsLayer = YES;
 	}
@@ -10284,8 +11519,7 @@ performKill:(id)	sender
 	
 	// in Full Screen mode, this command might not always be allowed
 	if (kPreferences_ResultOK !=
-		Preferences_GetData(kPreferences_TagKioskAllowsForceQuit, sizeof(allowForceQuit),
-							&allowForceQuit))
+		Preferences_GetValue< kPreferences_TagKioskAllowsForceQuit >(allowForceQuit))
 	{
 		allowForceQuit = true; // assume a value if the preference cannot be found
 	}
@@ -10325,8 +11559,7 @@ performRestart:(id)		sender
 	
 	// in Full Screen mode, this command might not always be allowed
 	if (kPreferences_ResultOK !=
-		Preferences_GetData(kPreferences_TagKioskAllowsForceQuit, sizeof(allowForceQuit),
-							&allowForceQuit))
+		Preferences_GetValue< kPreferences_TagKioskAllowsForceQuit >(allowForceQuit))
 	{
 		allowForceQuit = true; // assume a value if the preference cannot be found
 	}
@@ -10361,6 +11594,49 @@ canPerformRestart:(id <NSValidatedUserInterfaceItem>)		anItem
 #pragma mark Actions: Commands_SessionThrottling
 
 
+/*!
+Adds the session to the first broadcast group, so that input
+typed into it is also sent to every other session that has
+this command turned on; or, removes it from its group.
+
+(2021.06)
+*/
+- (IBAction)
+performBroadcastInputToggle:(id)	sender
+{
+#pragma unused(sender)
+	SessionRef		session = [self boundSession];
+	UInt32			groupNumber = ((0 == Session_ReturnBroadcastGroup(session)) ? 1 : 0);
+	
+	
+	unless (Session_SetBroadcastGroup(session, groupNumber).ok())
+	{
+		Sound_StandardAlert();
+	}
+}
+- (id)
+canPerformBroadcastInputToggle:(id <NSValidatedUserInterfaceItem>)		anItem
+{
+#pragma unused(anItem)
+	SessionRef		session = [self boundSession];
+	BOOL			isChecked = NO;
+	BOOL			result = NO;
+	
+	
+	if (nullptr != session)
+	{
+		isChecked = (0 != Session_ReturnBroadcastGroup(session));
+		
+		// a session can always leave its group, but only
+		// a session that is still running can join one
+		result = (isChecked || (false == Session_StateIsDead(session)));
+	}
+	MenuUtilities_SetItemCheckMark(anItem, isChecked);
+	
+	return ((result) ? @(YES) : @(NO));
+}
+
+
 - (IBAction)
 performInterruptProcess:(id)	sender
 {
@@ -10646,6 +11922,60 @@ canPerformCopyAndPaste:(id <NSValidatedUserInterfaceItem>)		anItem
 }
 
 
+/*!
+Stops writing a large selection that was copied from this
+view and is not finished yet; the text is then removed from
+the clipboard (see Clipboard_CancelPromisedText()).
+
+(2021.06)
+*/
+- (IBAction)
+performCopyCancel:(id)		sender
+{
+#pragma unused(sender)
+	UNUSED_RETURN(Boolean)Clipboard_CancelPromisedText([self terminalViewRef]);
+}
+- (id)
+canPerformCopyCancel:(id <NSValidatedUserInterfaceItem>)	anItem
+{
+#pragma unused(anItem)
+	BOOL	result = Clipboard_PromisedTextIsInProgress([self terminalViewRef]);
+	
+	
+	return ((result) ? @(YES) : @(NO));
+}
+
+
+/*!
+Stops the Paste that is still sending text to the session
+(see Session_UserInputPasteCancel()).
+
+(2021.06)
+*/
+- (IBAction)
+performPasteCancel:(id)		sender
+{
+#pragma unused(sender)
+	SessionRef		session = [self boundSession];
+	
+	
+	if (nullptr != session)
+	{
+		Session_UserInputPasteCancel(session);
+	}
+}
+- (id)
+canPerformPasteCancel:(id <NSValidatedUserInterfaceItem>)	anItem
+{
+#pragma unused(anItem)
+	SessionRef		session = [self boundSession];
+	BOOL			result = ((nullptr != session) && Session_PasteIsInProgress(session));
+	
+	
+	return ((result) ? @(YES) : @(NO));
+}
+
+
 /*!
 Copies selected text from the terminal view to the clipboard
 except consecutive spaces may be replaced by a single tab
@@ -11785,8 +13115,7 @@ performDragOperation:(id <NSDraggingInfo>)		sender
 	
 	// determine if terminal cursor first moves to drop location
 	unless (kPreferences_ResultOK ==
-			Preferences_GetData(kPreferences_TagCursorMovesPriorToDrops,
-								sizeof(cursorMovesPriorToDrops), &cursorMovesPriorToDrops))
+			Preferences_GetValue< kPreferences_TagCursorMovesPriorToDrops >(cursorMovesPriorToDrops))
 	{
 		cursorMovesPriorToDrops = false; // assume a value, if a preference can’t be found
 	}
@@ -12014,6 +13343,13 @@ flagsChanged:(NSEvent*)		anEvent
 	[super flagsChanged:anEvent];
 	self.modifierFlagsForCursor = [anEvent modifierFlags];
 	[[self window] invalidateCursorRectsForView:self];
+	
+	// the link under the mouse is underlined only while Command is down
+	if (nullptr != self.internalViewPtr)
+	{
+		updateHoveredLink(self.internalViewPtr, [self convertPoint:[self.window mouseLocationOutsideOfEventStream] fromView:nil],
+							self.modifierFlagsForCursor);
+	}
 }// flagsChanged:
 
 
@@ -12191,6 +13527,26 @@ mouseDown:(NSEvent*)	anEvent
 		// single click
 		UNUSED_RETURN(BOOL)findVirtualCellFromScreenPoint(viewPtr, CGPointMake(viewLocation.x, viewLocation.y),
 															mouseDownCell);
+		
+		// Command-click opens a link (the same modifier underlines it; see "mouseMoved:")
+		if ((anEvent.modifierFlags & NSEventModifierFlagCommand) && (0 == (anEvent.modifierFlags & NSEventModifierFlagOption)))
+		{
+			TerminalView_CellRange	linkRange;
+			CFStringRef				uriCFString = nullptr;
+			
+			
+			if (copyLinkAtCell(viewPtr, mouseDownCell, linkRange, uriCFString))
+			{
+				unless (URL_HandleCFString(uriCFString))
+				{
+					Console_Warning(Console_WriteValueCFString, "cannot open link", uriCFString);
+					Sound_StandardAlert();
+				}
+				CFRelease(uriCFString), uriCFString = nullptr;
+				return;
+			}
+		}
+		
 		if (pointInSelection(viewPtr, mouseDownCell))
 		{
 			singleClickInSelection = YES;
@@ -12570,6 +13926,42 @@ mouseDown:(NSEvent*)	anEvent
 }// mouseDown:
 
 
+/*!
+Removes the underline from any link, since the mouse is no
+longer over the view.
+
+(2021.06)
+*/
+- (void)
+mouseExited:(NSEvent*)	anEvent
+{
+	[super mouseExited:anEvent];
+	if (nullptr != self.internalViewPtr)
+	{
+		updateHoveredLink(self.internalViewPtr, NSZeroPoint, 0/* modifiers */);
+	}
+}// mouseExited:
+
+
+/*!
+Underlines the link under the mouse while the Command key
+is down, to show what a click would open.  Links are found
+in advance by the terminal, so this is cheap.
+
+(2021.06)
+*/
+- (void)
+mouseMoved:(NSEvent*)	anEvent
+{
+	[super mouseMoved:anEvent];
+	if (nullptr != self.internalViewPtr)
+	{
+		updateHoveredLink(self.internalViewPtr, [self convertPoint:anEvent.locationInWindow fromView:nil],
+							anEvent.modifierFlags);
+	}
+}// mouseMoved:
+
+
 /*!
 Obtains data from a Services item.
 
@@ -13382,7 +14774,7 @@ drawRect:(NSRect)	aRect
 		}
 		
 		// draw default background
-		useTerminalTextColors(viewPtr, drawingContext, viewPtr->text.attributes,
+		useTerminalTextColors(viewPtr, drawingContext, viewPtr->text.attributes, viewPtr->text.inlineColors,
 								false/* is cursor */, 1.0/* alpha */);
 		//CGContextSetAllowsAntialiasing(drawingContext, false);
 		CGContextFillRect(drawingContext, clipBounds);
@@ -13492,14 +14884,71 @@ drawRect:(NSRect)	aRect
 			CGContextStrokePath(drawingContext);
 		}
 		
+		// draw predicted text (see TerminalView_SetPredictedText())
+		if (viewPtr->screen.prediction.text.exists())
+		{
+			CGContextSaveRestore		_(drawingContext);
+			CFStringRef					predictedText = viewPtr->screen.prediction.text.returnCFStringRef();
+			CFIndex const				kLength = CFStringGetLength(predictedText);
+			TextAttributes_Object		predictionAttributes = Terminal_CursorReturnAttributes(viewPtr->screen.ref);
+			CGRect						predictionBounds;
+			
+			
+			// use the style that the echo would have, but underline it
+			// so that it is clear that this is not real output yet
+			predictionAttributes.addAttributes(kTextAttributes_StyleUnderline);
+			getRowSectionBounds(viewPtr, viewPtr->screen.prediction.row, viewPtr->screen.prediction.column,
+								STATIC_CAST(kLength, SInt16), predictionBounds);
+			useTerminalTextColors(viewPtr, drawingContext, predictionAttributes,
+									Terminal_CursorReturnInlineColors(viewPtr->screen.ref),
+									false/* is cursor */, 1.0/* alpha */);
+			CGContextFillRect(drawingContext, predictionBounds);
+			drawTerminalText(viewPtr, drawingContext, predictionBounds, kLength, predictedText, predictionAttributes);
+			viewPtr->text.attributes = kTextAttributes_Invalid; // forces attributes to reset themselves properly
+		}
+		
 		// draw cursor
 		if (kMyCursorStateVisible == viewPtr->screen.cursor.currentState)
 		{
 			CGContextSaveRestore		_(drawingContext);
 			TextAttributes_Object		cursorAttributes = Terminal_CursorReturnAttributes(viewPtr->screen.ref);
+			TextAttributes_InlineColors	cursorInlineColors = Terminal_CursorReturnInlineColors(viewPtr->screen.ref);
 			CGRect						cursorFloatBounds = viewPtr->screen.cursor.bounds;
 			
 			
+			// the selection and search results are not in the terminal buffer, so
+			// they are not part of the cursor attributes either (see drawSection())
+			{
+				UInt16		cursorColumn = 0;
+				UInt16		cursorRow = 0;
+				UInt16		selectionStartColumn = 0;
+				UInt16		selectionPastEndColumn = 0;
+				
+				
+				if (kTerminal_ResultOK == Terminal_CursorGetLocation(viewPtr->screen.ref, &cursorColumn, &cursorRow))
+				{
+					auto const	toSearchResults = viewPtr->text.searchResultsByRow.find(cursorRow);
+					
+					
+					if (getSelectedColumnsInRow(viewPtr, cursorRow, selectionStartColumn, selectionPastEndColumn) &&
+						(cursorColumn >= selectionStartColumn) && (cursorColumn < selectionPastEndColumn))
+					{
+						cursorAttributes.addAttributes(kTextAttributes_Selected);
+					}
+					if (viewPtr->text.searchResultsByRow.end() != toSearchResults)
+					{
+						for (auto const& columnInterval : toSearchResults->second)
+						{
+							if ((cursorColumn >= columnInterval.first) && (cursorColumn < columnInterval.second))
+							{
+								cursorAttributes.addAttributes(kTextAttributes_SearchHighlight);
+								break;
+							}
+						}
+					}
+				}
+			}
+			
 			// flip colors and paint at the current blink alpha value
 			if (cursorAttributes.hasAttributes(kTextAttributes_StyleInverse))
 			{
@@ -13509,7 +14958,7 @@ drawRect:(NSRect)	aRect
 			{
 				cursorAttributes.addAttributes(kTextAttributes_StyleInverse);
 			}
-			useTerminalTextColors(viewPtr, drawingContext, cursorAttributes,
+			useTerminalTextColors(viewPtr, drawingContext, cursorAttributes, cursorInlineColors,
 									true/* is cursor */,
 									cursorBlinks(viewPtr)
 									? viewPtr->animation.cursor.blinkAlpha
@@ -13543,7 +14992,7 @@ drawRect:(NSRect)	aRect
 					// restore original attributes (that way the disk appears in the
 					// color of the background, not the color of the cursor)
 					cursorAttributes = Terminal_CursorReturnAttributes(viewPtr->screen.ref);
-					useTerminalTextColors(viewPtr, drawingContext, cursorAttributes,
+					useTerminalTextColors(viewPtr, drawingContext, cursorAttributes, cursorInlineColors,
 											true/* is cursor */,
 											cursorBlinks(viewPtr)
 											? viewPtr->animation.cursor.blinkAlpha
@@ -274,6 +274,7 @@ struct My_TerminalWindow
 	Preferences_ContextWrap		recentSheetContext;		// defined temporarily while a Preferences-dependent sheet (such as screen size) is up
 	My_SheetType				sheetType;				// if a sheet is active, this is a hint as to what settings can be put in the context
 	FindDialog_Ref __strong		searchDialog;			// retains the user interface for finding text in the terminal buffer
+	NSTitlebarAccessoryViewController* __strong	pasteProgressAccessory;	// if defined, shows the progress of a Paste in the title bar
 	FindDialog_Options			recentSearchOptions;	// the options used during the last search in the dialog
 	CFRetainRelease				recentSearchStrings;	// CFMutableArrayRef; the CFStrings used in searches since this window was opened
 	CFRetainRelease				baseTitleString;		// user-provided title string; may be adorned prior to becoming the window title
@@ -310,6 +311,7 @@ UInt16					returnScrollBarWidth			(My_TerminalWindowPtr);
 UInt16					returnStatusBarHeight			(My_TerminalWindowPtr);
 UInt16					returnToolbarHeight				(My_TerminalWindowPtr);
 void					sessionStateChanged				(ListenerModel_Ref, ListenerModel_Event, void*, void*);
+void					setPasteProgress				(My_TerminalWindowPtr, SessionRef);
 void					setScreenPreferences			(My_TerminalWindowPtr, Preferences_ContextRef, Boolean = false);
 void					setStandardState				(My_TerminalWindowPtr, CGFloat, CGFloat, Boolean = false);
 void					setUpForFullScreenModal			(My_TerminalWindowPtr, Boolean, Boolean, My_FullScreenState);
@@ -998,7 +1000,7 @@ time).
 Boolean
 TerminalWindow_IsValid	(TerminalWindowRef	inRef)
 {
-	Boolean		result = ((nullptr != inRef) && (gTerminalWindowValidRefs().find(inRef) != gTerminalWindowValidRefs().end()));
+	Boolean		result = ((nullptr != inRef) && (gTerminalWindowValidRefs().contains(inRef)));
 	
 	
 	return result;
@@ -1861,6 +1863,7 @@ viewSizeIndependent(false),
 recentSheetContext(),
 sheetType(kMy_SheetTypeNone),
 searchDialog(nullptr),
+pasteProgressAccessory(nil),
 recentSearchOptions(kFindDialog_OptionsDefault),
 recentSearchStrings(CFArrayCreateMutable(kCFAllocatorDefault, 0/* limit; 0 = no size limit */, &kCFTypeArrayCallBacks),
 					CFRetainRelease::kAlreadyRetained),
@@ -2038,6 +2041,7 @@ allViews()
 	// set up callbacks to receive various state change notifications
 	this->sessionStateChangeEventListener.setWithNoRetain(ListenerModel_NewStandardListener
 															(sessionStateChanged, this->selfRef/* context */));
+	SessionFactory_StartMonitoringSessions(kSession_ChangePasteProgress, this->sessionStateChangeEventListener.returnRef());
 	SessionFactory_StartMonitoringSessions(kSession_ChangeSelected, this->sessionStateChangeEventListener.returnRef());
 	SessionFactory_StartMonitoringSessions(kSession_ChangeState, this->sessionStateChangeEventListener.returnRef());
 	SessionFactory_StartMonitoringSessions(kSession_ChangeStateAttributes, this->sessionStateChangeEventListener.returnRef());
@@ -2123,6 +2127,7 @@ My_TerminalWindow::
 	}
 	
 	// unregister session callbacks
+	SessionFactory_StopMonitoringSessions(kSession_ChangePasteProgress, this->sessionStateChangeEventListener.returnRef());
 	SessionFactory_StopMonitoringSessions(kSession_ChangeSelected, this->sessionStateChangeEventListener.returnRef());
 	SessionFactory_StopMonitoringSessions(kSession_ChangeState, this->sessionStateChangeEventListener.returnRef());
 	SessionFactory_StopMonitoringSessions(kSession_ChangeStateAttributes, this->sessionStateChangeEventListener.returnRef());
@@ -2547,6 +2552,24 @@ sessionStateChanged		(ListenerModel_Ref		UNUSED_ARGUMENT(inUnusedModel),
 	
 	switch (inSessionSettingThatChanged)
 	{
+	case kSession_ChangePasteProgress:
+		// show, update or hide the progress of a Paste
+		{
+			SessionRef		session = REINTERPRET_CAST(inEventContextPtr, SessionRef);
+			
+			
+			// this handler is invoked for changes to ANY session,
+			// but the response is specific to one, so check first
+			if (Session_ReturnActiveTerminalWindow(session) == terminalWindow)
+			{
+				My_TerminalWindowAutoLocker		ptr(gTerminalWindowPtrLocks(), terminalWindow);
+				
+				
+				setPasteProgress(ptr, session);
+			}
+		}
+		break;
+	
 	case kSession_ChangeSelected:
 		// bring the window to the front, unhiding it if necessary
 		{
@@ -2694,6 +2717,51 @@ sessionStateChanged		(ListenerModel_Ref		UNUSED_ARGUMENT(inUnusedModel),
 }// sessionStateChanged
 
 
+/*!
+Shows the progress of the given session’s Paste in the title
+bar of the window, while text is still being sent; removes
+it once the Paste ends or is cancelled (the Edit menu has a
+command to cancel it).
+
+(2021.06)
+*/
+void
+setPasteProgress	(My_TerminalWindowPtr	inPtr,
+					 SessionRef				inSession)
+{
+	if (Session_PasteIsInProgress(inSession))
+	{
+		NSProgressIndicator*	progressBar = nil;
+		
+		
+		if (nil == inPtr->pasteProgressAccessory)
+		{
+			progressBar = [[NSProgressIndicator alloc] initWithFrame:NSMakeRect(0, 0, 120, 16)];
+			progressBar.style = NSProgressIndicatorStyleBar;
+			progressBar.controlSize = NSControlSizeSmall;
+			progressBar.indeterminate = NO;
+			progressBar.minValue = 0;
+			progressBar.maxValue = 1;
+			
+			inPtr->pasteProgressAccessory = [[NSTitlebarAccessoryViewController alloc] init];
+			inPtr->pasteProgressAccessory.view = progressBar;
+			inPtr->pasteProgressAccessory.layoutAttribute = NSLayoutAttributeRight;
+			[inPtr->window addTitlebarAccessoryViewController:inPtr->pasteProgressAccessory];
+		}
+		else
+		{
+			progressBar = STATIC_CAST(inPtr->pasteProgressAccessory.view, NSProgressIndicator*);
+		}
+		progressBar.doubleValue = Session_ReturnPasteProgress(inSession);
+	}
+	else if (nil != inPtr->pasteProgressAccessory)
+	{
+		[inPtr->pasteProgressAccessory removeFromParentViewController];
+		inPtr->pasteProgressAccessory = nil;
+	}
+}// setPasteProgress
+
+
 /*!
 Copies the screen size and scrollback settings from the given
 context to the underlying terminal buffer.  The main view is
@@ -64,15 +64,29 @@ enum
 	kTextAttributes_BitmapIDMaximum			= ((1 << kTextAttributes_BitmapIDBits) - 1)
 };
 
+/*!
+Color index values (for palettes) are stored in a limited
+number of attribute bits.  See the bit-range documentation
+for TextAttributes_Object.
+*/
+enum
+{
+	kTextAttributes_ColorIndexBits			= 11,
+	kTextAttributes_ColorIndexMaximum		= ((1 << kTextAttributes_ColorIndexBits) - 1)
+};
+
 /*!
 The limit on true color is imposed to avoid requiring a
-large number of attribute bits.  See documentation on
-TextAttributes_TrueColorID.
+large number of attribute bits.  An ID is stored in the
+color index field plus a small extension field elsewhere.
+See documentation on TextAttributes_TrueColorID.
 */
 enum
 {
-	kTextAttributes_TrueColorBits			= 11,
-	kTextAttributes_TrueColorIDMaximum		= ((1 << kTextAttributes_TrueColorBits) - 1)
+	kTextAttributes_TrueColorBits			= 16,
+	kTextAttributes_TrueColorIDMaximum		= ((1 << kTextAttributes_TrueColorBits) - 1),
+	kTextAttributes_TrueColorExtensionBits	= (kTextAttributes_TrueColorBits - kTextAttributes_ColorIndexBits),
+	kTextAttributes_TrueColorExtensionMaximum	= ((1 << kTextAttributes_TrueColorExtensionBits) - 1)
 };
 
 #pragma mark Types
@@ -110,7 +124,9 @@ integer type; see "kTextAttributes_TrueColorIDMaximum".
 This is intentionally more compact than the original 24-bit
 specification (therefore limiting the total number of color
 combinations in terminals).  The goal is to consume fewer
-bits to associate a true color with its text.
+bits to associate a true color with its text.  The lower
+bits of an ID share space with the color index and the
+upper bits are in a separate extension range.
 
 NOTE:	Color IDs are reused after a time.  In theory this
 		could mean that text could change its rendering,
@@ -118,10 +134,52 @@ NOTE:	Color IDs are reused after a time.  In theory this
 		where lots of unique colors are seen.  This is
 		considered an acceptable trade-off to avoid a more
 		complex scheme for remembering the true color values
-		of every piece of text in the terminal.
+		of every piece of text in the terminal.  (Terminals
+		avoid reusing IDs of colors that were recently used
+		or drawn, so that visible text is not affected.)
 */
 typedef UInt16 TextAttributes_TrueColorID;
 
+/*!
+In terminals that store 24-bit colors inline, each cell that
+uses a true color has one of these (in a per-line array that
+parallels the attributes of the line).  Components are packed
+as 0x00RRGGBB.  A value only applies to the part of the cell
+(foreground or background) that has the corresponding inline
+attribute bit set, such as "kTextAttributes_ColorIsInlineForeground";
+otherwise the value is meaningless.
+
+This is wider than a TextAttributes_TrueColorID but it avoids
+any table lookups when colors are set or rendered, and it is
+never allocated for lines that have no such colors.
+*/
+struct TextAttributes_InlineColors
+{
+	inline
+	TextAttributes_InlineColors ();
+	
+	inline bool
+	operator ==	(TextAttributes_InlineColors const&) const;
+	
+	inline bool
+	operator !=	(TextAttributes_InlineColors const&) const;
+	
+	inline void
+	returnBackground	(UInt8&, UInt8&, UInt8&) const;
+	
+	inline void
+	returnForeground	(UInt8&, UInt8&, UInt8&) const;
+	
+	inline void
+	setBackground	(UInt8, UInt8, UInt8);
+	
+	inline void
+	setForeground	(UInt8, UInt8, UInt8);
+	
+	UInt32	foregroundRGB;
+	UInt32	backgroundRGB;
+};
+
 /*!
 Terminal Attribute Bits
 
@@ -144,13 +202,17 @@ IMPORTANT:	The bit ranges documented below should match the
 
 Upper 32-bit range ("_upper" field):
 <pre>
-[BACKGROUND]                       [FOREGROUND]                          [B][F]  [T][UNUSED]  [UNUSED][INV.]
+[BACKGROUND]                       [FOREGROUND]                          [B][F]  [T][B][IF][IB] [UNUSED][INV.]
 31 30 29 28  27 26 25 24  23 22 21 20  19 18 17 16    15 14 13 12  11 10  9  8   7  6  5  4   3  2  1  0
 ─┼──┼──┼──┼───┼──┼──┼──┼───┼──┼──┼──┼───┼──┼──┼──┼─────┼──┼──┼──┼───┼──┼──┼──┼───┼──┼──┼──┼───┼──┼──┼──┼─
  │  │  │  │   │  │  │  │   │  │  │  │   │  │  │  │     │  │  │  │   │  │  │  │   │  │  │  │   │  │  │  │
  │  │  │  │   │  │  │  │   │  │  │  │   │  │  │  │     │  │  │  │   │  │  │  │   │  │  │  │   │  │  │  └─── 0: if set, all bits are INVALID
  │  │  │  │   │  │  │  │   │  │  │  │   │  │  │  │     │  │  │  │   │  │  │  │   │  │  │  │   │  │  │
- │  │  │  │   │  │  │  │   │  │  │  │   │  │  │  │     │  │  │  │   │  │  │  │   │  │  └──┴───┴──┴──┴────── 5-1: UNDEFINED; set to 0
+ │  │  │  │   │  │  │  │   │  │  │  │   │  │  │  │     │  │  │  │   │  │  │  │   │  │  │  │   └──┴──┴────── 3-1: UNDEFINED; set to 0
+ │  │  │  │   │  │  │  │   │  │  │  │   │  │  │  │     │  │  │  │   │  │  │  │   │  │  │  │
+ │  │  │  │   │  │  │  │   │  │  │  │   │  │  │  │     │  │  │  │   │  │  │  │   │  │  │  └─── 4: background is inline RGB (see TextAttributes_InlineColors) [4]?
+ │  │  │  │   │  │  │  │   │  │  │  │   │  │  │  │     │  │  │  │   │  │  │  │   │  │  │
+ │  │  │  │   │  │  │  │   │  │  │  │   │  │  │  │     │  │  │  │   │  │  │  │   │  │  └────── 5: foreground is inline RGB (see TextAttributes_InlineColors) [4]?
  │  │  │  │   │  │  │  │   │  │  │  │   │  │  │  │     │  │  │  │   │  │  │  │   │  │
  │  │  │  │   │  │  │  │   │  │  │  │   │  │  │  │     │  │  │  │   │  │  │  │   │  └───────── 6: color index is TextAttributes_BitmapID?
  │  │  │  │   │  │  │  │   │  │  │  │   │  │  │  │     │  │  │  │   │  │  │  │   │
@@ -161,19 +223,19 @@ Upper 32-bit range ("_upper" field):
  │  │  │  │   │  │  │  │   │  │  │  │   │  │  │  │     │  │  │  │   │  │  └────── 9: use custom background color index (bits 31-21)?
  │  │  │  │   │  │  │  │   │  │  │  │   │  │  │  │     │  │  │  │   │  │
  │  │  │  │   │  │  │  │   │  │  │  └───┴──┴──┴──┴─────┴──┴──┴──┴───┴──┴───────── 20-10: index for unique foreground color from a palette [1];
- │  │  │  │   │  │  │  │   │  │  │                                                       or, if bit 7 is set, a TextAttributes_TrueColorID;
+ │  │  │  │   │  │  │  │   │  │  │                                                       or, if bit 7 is set, lower bits of TextAttributes_TrueColorID [3];
  │  │  │  │   │  │  │  │   │  │  │                                                       or, if bit 6 is set, lower bits of TextAttributes_BitmapID
  │  │  │  │   │  │  │  │   │  │  │                                                       (it may not be a combination of these)
  │  │  │  │   │  │  │  │   │  │  │
  └──┴──┴──┴───┴──┴──┴──┴───┴──┴──┴─────────────────── 31-21: index for unique background color from a palette [1];
-                                                             or, if bit 7 is set, a TextAttributes_TrueColorID;
+                                                             or, if bit 7 is set, lower bits of TextAttributes_TrueColorID [3];
                                                              or, if bit 6 is set, upper bits of TextAttributes_BitmapID
                                                              (it may not be a combination of these)
 </pre>
 
 Lower 32-bit range ("_lower" field):
 <pre>
-[UNUSED]     [UNUSED]     [UNUSED]     [UNUSED]     [E][SL][SR][GR] [DBL][UNUSED][STYLE BITS]
+[UNUSED]        [BG. EXT.]         [FG. EXT.]       [E][SL][SR][GR] [DBL][UNUSED][STYLE BITS]
 31 30 29 28  27 26 25 24  23 22 21 20  19 18 17 16    15 14 13 12  11 10  9  8   7  6  5  4   3  2  1  0
 ─┼──┼──┼──┼───┼──┼──┼──┼───┼──┼──┼──┼───┼──┼──┼──┼─────┼──┼──┼──┼───┼──┼──┼──┼───┼──┼──┼──┼───┼──┼──┼──┼─
  │  │  │  │   │  │  │  │   │  │  │  │   │  │  │  │     │  │  │  │   │  │  │  │   │  │  │  │   │  │  │  │
@@ -209,7 +271,13 @@ Lower 32-bit range ("_lower" field):
  │  │  │  │   │  │  │  │   │  │  │  │   │  │  │  │     └──────────── 15: is prohibited from being erased by selective erases
  │  │  │  │   │  │  │  │   │  │  │  │   │  │  │  │
  │  │  │  │   │  │  │  │   │  │  │  │   │  │  │  │
- └──┴──┴──┴───┴──┴──┴──┴───┴──┴──┴──┴───┴──┴──┴──┴─── 31-16: UNDEFINED; set to 0
+ │  │  │  │   │  │  │  │   │  │  │  └───┴──┴──┴──┴─── 20-16: if bit 7 of upper range is set, upper bits of foreground
+ │  │  │  │   │  │  │  │   │  │  │                           TextAttributes_TrueColorID [3]; otherwise, set to 0
+ │  │  │  │   │  │  │  │   │  │  │
+ │  │  │  │   │  │  └──┴───┴──┴──┴─── 25-21: if bit 7 of upper range is set, upper bits of background
+ │  │  │  │   │  │                           TextAttributes_TrueColorID [3]; otherwise, set to 0
+ │  │  │  │   │  │
+ └──┴──┴──┴───┴──┴─── 31-26: UNDEFINED; set to 0
 
 [1] The base 8 colors are 3-bit ANSI color values that can be one
 of the following (the exact RGB components of which may be
@@ -234,6 +302,20 @@ a portion of a bitmap image.
 (but please use defined constants instead of these numbers):
 	00 (0)		normal			10 (2)		text is top half of double height
 	01 (1)		double width	11 (3)		text is bottom half of double height
+
+[3] A TextAttributes_TrueColorID is larger than a color index so
+it is split: the lower "kTextAttributes_ColorIndexBits" bits are
+in the color index field and the remaining bits are in a separate
+extension field.  Use accessors such as colorIDForeground() to
+read or write complete IDs.
+
+[4] In terminals that store 24-bit colors inline, the RGB values
+are not in the attributes at all; the line holds a parallel array
+of TextAttributes_InlineColors that is only allocated when the line
+actually contains such colors.  If an inline bit is set, the color
+index field for the same part of the cell is 0 and should be
+ignored, even if the "kTextAttributes_ColorIndexIsTrueColorID" bit
+is also set (for the other part of the cell).
 </pre>
 */
 struct TextAttributes_Object
@@ -325,6 +407,12 @@ struct TextAttributes_Object
 	inline void
 	colorIndexForegroundSet		(UInt16);
 	
+	inline void
+	colorInlineBackgroundSet ();
+	
+	inline void
+	colorInlineForegroundSet ();
+	
 	inline bool
 	hasAttributes	(TextAttributes_Object) const;
 	
@@ -352,6 +440,9 @@ struct TextAttributes_Object
 	inline bool
 	hasDoubleWidth () const;
 	
+	inline bool
+	hasInlineColor () const;
+	
 	inline bool
 	hasItalic () const;
 	
@@ -388,9 +479,13 @@ TextAttributes_Object::BitRange const	kTextAttributes_MaskDoubleText(0x03, 10 +
 TextAttributes_Object::BitRange const	kTextAttributes_MaskBitmapID(kTextAttributes_BitmapIDMaximum, 64 - kTextAttributes_BitmapIDBits);
 
 //! the mask and shift for the bits required to represent any color index value
-//! (this must be at least as large as TextAttributes_TrueColorID)
-TextAttributes_Object::BitRange const	kTextAttributes_MaskColorIndexBackground(kTextAttributes_TrueColorIDMaximum, 64 - kTextAttributes_TrueColorBits);
-TextAttributes_Object::BitRange const	kTextAttributes_MaskColorIndexForeground(kTextAttributes_TrueColorIDMaximum, 64 - 2 * kTextAttributes_TrueColorBits);
+//! (this also holds the lower bits of any TextAttributes_TrueColorID)
+TextAttributes_Object::BitRange const	kTextAttributes_MaskColorIndexBackground(kTextAttributes_ColorIndexMaximum, 64 - kTextAttributes_ColorIndexBits);
+TextAttributes_Object::BitRange const	kTextAttributes_MaskColorIndexForeground(kTextAttributes_ColorIndexMaximum, 64 - 2 * kTextAttributes_ColorIndexBits);
+
+//! the mask and shift for the upper bits of any TextAttributes_TrueColorID value
+TextAttributes_Object::BitRange const	kTextAttributes_MaskTrueColorExtensionBackground(kTextAttributes_TrueColorExtensionMaximum, 16 + kTextAttributes_TrueColorExtensionBits);
+TextAttributes_Object::BitRange const	kTextAttributes_MaskTrueColorExtensionForeground(kTextAttributes_TrueColorExtensionMaximum, 16);
 
 //
 // IMPORTANT: The constant bit ranges chosen below should match
@@ -413,6 +508,16 @@ TextAttributes_Object const		kTextAttributes_ColorIndexIsBitmapID
 TextAttributes_Object const		kTextAttributes_ColorIndexIsTrueColorID
 								(0x00000080,	0);
 
+//! if set, the background color is in the TextAttributes_InlineColors
+//! for the cell, and the background color index is unused
+TextAttributes_Object const		kTextAttributes_ColorIsInlineBackground
+								(0x00000010,	0);
+
+//! if set, the foreground color is in the TextAttributes_InlineColors
+//! for the cell, and the foreground color index is unused
+TextAttributes_Object const		kTextAttributes_ColorIsInlineForeground
+								(0x00000020,	0);
+
 //! if the bits in the range "kTextAttributes_MaskDoubleText" are
 //! equal to this, the bottom half of double-width and double-height
 //! text is to be rendered
@@ -767,6 +872,7 @@ void
 TextAttributes_Object::bitmapIDSet		(TextAttributes_BitmapID	inID)
 {
 	kTextAttributes_MaskBitmapID.addExclusivelyTo(_upper, _lower, inID);
+	_upper &= ~(kTextAttributes_ColorIsInlineBackground._upper | kTextAttributes_ColorIsInlineForeground._upper);
 	this->addAttributes(kTextAttributes_ColorIndexIsBitmapID);
 	assert(bitmapID() == inID); // debug
 }// bitmapIDSet
@@ -798,7 +904,8 @@ TextAttributes_Object::colorIDBackground ()
 const
 {
 	assert(this->hasAttributes(kTextAttributes_ColorIndexIsTrueColorID));
-	return STATIC_CAST(colorIndexBackground(), TextAttributes_TrueColorID);
+	return STATIC_CAST((this->returnValueInRange(kTextAttributes_MaskTrueColorExtensionBackground) << kTextAttributes_ColorIndexBits) |
+						colorIndexBackground(), TextAttributes_TrueColorID);
 }// colorIDBackground
 
 
@@ -811,7 +918,8 @@ adding the "kTextAttributes_ColorIndexIsTrueColorID" bit.
 void
 TextAttributes_Object::colorIDBackgroundSet		(TextAttributes_TrueColorID		inID)
 {
-	colorIndexBackgroundSet(STATIC_CAST(inID, UInt16));
+	colorIndexBackgroundSet(STATIC_CAST(inID & kTextAttributes_ColorIndexMaximum, UInt16));
+	kTextAttributes_MaskTrueColorExtensionBackground.addExclusivelyTo(_upper, _lower, (inID >> kTextAttributes_ColorIndexBits));
 	this->addAttributes(kTextAttributes_ColorIndexIsTrueColorID);
 	assert(colorIDBackground() == inID);
 }// colorIDBackgroundSet
@@ -830,7 +938,8 @@ TextAttributes_Object::colorIDForeground ()
 const
 {
 	assert(this->hasAttributes(kTextAttributes_ColorIndexIsTrueColorID));
-	return STATIC_CAST(colorIndexForeground(), TextAttributes_TrueColorID);
+	return STATIC_CAST((this->returnValueInRange(kTextAttributes_MaskTrueColorExtensionForeground) << kTextAttributes_ColorIndexBits) |
+						colorIndexForeground(), TextAttributes_TrueColorID);
 }// colorIDForeground
 
 
@@ -843,7 +952,8 @@ adding the "kTextAttributes_ColorIndexIsTrueColorID" bit.
 void
 TextAttributes_Object::colorIDForegroundSet		(TextAttributes_TrueColorID		inID)
 {
-	colorIndexForegroundSet(STATIC_CAST(inID, UInt16));
+	colorIndexForegroundSet(STATIC_CAST(inID & kTextAttributes_ColorIndexMaximum, UInt16));
+	kTextAttributes_MaskTrueColorExtensionForeground.addExclusivelyTo(_upper, _lower, (inID >> kTextAttributes_ColorIndexBits));
 	this->addAttributes(kTextAttributes_ColorIndexIsTrueColorID);
 	assert(colorIDForeground() == inID);
 }// colorIDForegroundSet
@@ -866,15 +976,23 @@ const
 Sets the background-index portion of the attributes by
 copying the relevant bits from another set of attributes.
 
+An inline background color is never copied (there is no
+place to put the color components); the caller must resolve
+the source color into some other form first.
+
 (4.1)
 */
 void
 TextAttributes_Object::colorIndexBackgroundCopyFrom		(TextAttributes_Object		inSourceAttributes)
 {
-	_upper &= ~(kTextAttributes_EnableBackground._upper | kTextAttributes_ColorIndexIsTrueColorID._upper);
+	assert(false == inSourceAttributes.hasAttributes(kTextAttributes_ColorIsInlineBackground));
+	_upper &= ~(kTextAttributes_EnableBackground._upper | kTextAttributes_ColorIndexIsTrueColorID._upper |
+				kTextAttributes_ColorIsInlineBackground._upper);
 	_upper |= (inSourceAttributes._upper & (kTextAttributes_EnableBackground._upper | kTextAttributes_ColorIndexIsTrueColorID._upper));
 	kTextAttributes_MaskColorIndexBackground.addExclusivelyTo(_upper, _lower,
 																inSourceAttributes.returnValueInRange(kTextAttributes_MaskColorIndexBackground));
+	kTextAttributes_MaskTrueColorExtensionBackground.addExclusivelyTo(_upper, _lower,
+																		inSourceAttributes.returnValueInRange(kTextAttributes_MaskTrueColorExtensionBackground));
 }// colorIndexBackgroundCopyFrom
 
 
@@ -889,7 +1007,8 @@ If this should remain true-color, use colorIDBackgroundSet().
 void
 TextAttributes_Object::colorIndexBackgroundSet	(UInt16		inIndex)
 {
-	_upper &= ~(kTextAttributes_ColorIndexIsTrueColorID._upper);
+	_upper &= ~(kTextAttributes_ColorIndexIsTrueColorID._upper | kTextAttributes_ColorIsInlineBackground._upper);
+	kTextAttributes_MaskTrueColorExtensionBackground.clearFrom(_upper, _lower);
 	kTextAttributes_MaskColorIndexBackground.addExclusivelyTo(_upper, _lower, inIndex);
 	_upper |= (kTextAttributes_EnableBackground._upper);
 	assert(colorIndexBackground() == inIndex); // debug
@@ -921,13 +1040,49 @@ void
 TextAttributes_Object::colorIndexForegroundSet	(UInt16		inIndex)
 {
 	_upper &= ~(kTextAttributes_ColorIndexIsBitmapID._upper);
-	_upper &= ~(kTextAttributes_ColorIndexIsTrueColorID._upper);
+	_upper &= ~(kTextAttributes_ColorIndexIsTrueColorID._upper | kTextAttributes_ColorIsInlineForeground._upper);
+	kTextAttributes_MaskTrueColorExtensionForeground.clearFrom(_upper, _lower);
 	kTextAttributes_MaskColorIndexForeground.addExclusivelyTo(_upper, _lower, inIndex);
 	_upper |= (kTextAttributes_EnableForeground._upper);
 	assert(colorIndexForeground() == inIndex); // debug
 }// colorIndexForegroundSet
 
 
+/*!
+Specifies that the background color is stored inline (in a
+TextAttributes_InlineColors value for the cell), adding the
+"kTextAttributes_ColorIsInlineBackground" bit and clearing
+the background-index portion of the attributes.
+
+(2021.06)
+*/
+void
+TextAttributes_Object::colorInlineBackgroundSet ()
+{
+	kTextAttributes_MaskTrueColorExtensionBackground.clearFrom(_upper, _lower);
+	kTextAttributes_MaskColorIndexBackground.clearFrom(_upper, _lower);
+	_upper |= (kTextAttributes_EnableBackground._upper | kTextAttributes_ColorIsInlineBackground._upper);
+}// colorInlineBackgroundSet
+
+
+/*!
+Specifies that the foreground color is stored inline (in a
+TextAttributes_InlineColors value for the cell), adding the
+"kTextAttributes_ColorIsInlineForeground" bit and clearing
+the foreground-index portion of the attributes.
+
+(2021.06)
+*/
+void
+TextAttributes_Object::colorInlineForegroundSet ()
+{
+	_upper &= ~(kTextAttributes_ColorIndexIsBitmapID._upper);
+	kTextAttributes_MaskTrueColorExtensionForeground.clearFrom(_upper, _lower);
+	kTextAttributes_MaskColorIndexForeground.clearFrom(_upper, _lower);
+	_upper |= (kTextAttributes_EnableForeground._upper | kTextAttributes_ColorIsInlineForeground._upper);
+}// colorInlineForegroundSet
+
+
 /*!
 Returns true if this object’s attributes include all of
 the specified attribute bits.
@@ -1053,6 +1208,20 @@ const
 }// hasDoubleWidth
 
 
+/*!
+Returns true if either of the attributes that indicate an
+inline color is set (see TextAttributes_InlineColors).
+
+(2021.06)
+*/
+bool
+TextAttributes_Object::hasInlineColor ()
+const
+{
+	return (0 != (_upper & (kTextAttributes_ColorIsInlineBackground._upper | kTextAttributes_ColorIsInlineForeground._upper)));
+}// hasInlineColor
+
+
 /*!
 Returns true if the "kTextAttributes_StyleItalic" attribute is set.
 
@@ -1149,7 +1318,11 @@ TextAttributes_Object::removeStyleAndColorRelatedAttributes ()
 	// specify ALL bits that control styles or colors
 	kTextAttributes_MaskColorIndexBackground.clearFrom(_upper, _lower);
 	kTextAttributes_MaskColorIndexForeground.clearFrom(_upper, _lower);
+	kTextAttributes_MaskTrueColorExtensionBackground.clearFrom(_upper, _lower);
+	kTextAttributes_MaskTrueColorExtensionForeground.clearFrom(_upper, _lower);
 	_upper &= ~(kTextAttributes_ColorIndexIsTrueColorID._upper |
+				kTextAttributes_ColorIsInlineBackground._upper |
+				kTextAttributes_ColorIsInlineForeground._upper |
 				kTextAttributes_EnableBackground._upper |
 				kTextAttributes_EnableForeground._upper);
 	_lower &= ~(kTextAttributes_StyleBlinking._lower |
@@ -1179,4 +1352,109 @@ const
 	return inRange.returnValue(_upper, _lower);
 }// returnValueInRange
 
+
+/*!
+Creates a pair of colors that are both black.  (The
+attributes of the cell determine which color is used.)
+
+(2021.06)
+*/
+TextAttributes_InlineColors::TextAttributes_InlineColors ()
+: foregroundRGB(0)
+, backgroundRGB(0)
+{
+}// TextAttributes_InlineColors default constructor
+
+
+/*!
+Returns true if both colors are the same as the given ones.
+
+(2021.06)
+*/
+bool
+TextAttributes_InlineColors::operator ==	(TextAttributes_InlineColors const&		inOther)
+const
+{
+	return ((inOther.foregroundRGB == foregroundRGB) && (inOther.backgroundRGB == backgroundRGB));
+}// TextAttributes_InlineColors::operator ==
+
+
+/*!
+Returns the opposite of "operator ==".
+
+(2021.06)
+*/
+bool
+TextAttributes_InlineColors::operator !=	(TextAttributes_InlineColors const&		inOther)
+const
+{
+	return (false == (this->operator ==(inOther)));
+}// TextAttributes_InlineColors::operator !=
+
+
+/*!
+Returns the red, green and blue components of the
+background color.
+
+(2021.06)
+*/
+void
+TextAttributes_InlineColors::returnBackground	(UInt8&		outRed,
+												 UInt8&		outGreen,
+												 UInt8&		outBlue)
+const
+{
+	outRed = STATIC_CAST((backgroundRGB >> 16) & 0xFF, UInt8);
+	outGreen = STATIC_CAST((backgroundRGB >> 8) & 0xFF, UInt8);
+	outBlue = STATIC_CAST(backgroundRGB & 0xFF, UInt8);
+}// TextAttributes_InlineColors::returnBackground
+
+
+/*!
+Returns the red, green and blue components of the
+foreground color.
+
+(2021.06)
+*/
+void
+TextAttributes_InlineColors::returnForeground	(UInt8&		outRed,
+												 UInt8&		outGreen,
+												 UInt8&		outBlue)
+const
+{
+	outRed = STATIC_CAST((foregroundRGB >> 16) & 0xFF, UInt8);
+	outGreen = STATIC_CAST((foregroundRGB >> 8) & 0xFF, UInt8);
+	outBlue = STATIC_CAST(foregroundRGB & 0xFF, UInt8);
+}// TextAttributes_InlineColors::returnForeground
+
+
+/*!
+Changes the red, green and blue components of the
+background color.
+
+(2021.06)
+*/
+void
+TextAttributes_InlineColors::setBackground	(UInt8		inRed,
+											 UInt8		inGreen,
+											 UInt8		inBlue)
+{
+	backgroundRGB = ((STATIC_CAST(inRed, UInt32) << 16) | (STATIC_CAST(inGreen, UInt32) << 8) | inBlue);
+}// TextAttributes_InlineColors::setBackground
+
+
+/*!
+Changes the red, green and blue components of the
+foreground color.
+
+(2021.06)
+*/
+void
+TextAttributes_InlineColors::setForeground	(UInt8		inRed,
+											 UInt8		inGreen,
+											 UInt8		inBlue)
+{
+	foregroundRGB = ((STATIC_CAST(inRed, UInt32) << 16) | (STATIC_CAST(inGreen, UInt32) << 8) | inBlue);
+}// TextAttributes_InlineColors::setForeground
+
 // BELOW IS REQUIRED NEWLINE TO END FILE
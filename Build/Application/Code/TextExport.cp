@@ -0,0 +1,608 @@
+/*!	\file TextExport.cp
+	\brief Converts lines of terminal text into UTF-8 chunks
+	of bounded size, for copying or saving a selection.
+*/
+/*###############################################################
+
+	MacTerm
+		© 1998-2021 by Kevin Grant.
+		© 2001-2003 by Ian Anderson.
+		© 1986-1994 University of Illinois Board of Trustees
+		(see About box for full list of U of I contributors).
+	
+	This program is free software; you can redistribute it or
+	modify it under the terms of the GNU General Public License
+	as published by the Free Software Foundation; either version
+	2 of the License, or (at your option) any later version.
+	
+	This program is distributed in the hope that it will be
+	useful, but WITHOUT ANY WARRANTY; without even the implied
+	warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+	PURPOSE.  See the GNU General Public License for more
+	details.
+	
+	You should have received a copy of the GNU General Public
+	License along with this program; if not, write to:
+	
+		Free Software Foundation, Inc.
+		59 Temple Place, Suite 330
+		Boston, MA  02111-1307
+		USA
+
+###############################################################*/
+
+#include "TextExport.h"
+#include <UniversalDefines.h>
+
+// standard-C++ includes
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+// library includes
+#include <Console.h>
+
+
+
+#pragma mark Types
+namespace {
+
+/*!
+Internal representation of a TextExport_Ref.
+*/
+struct My_TextExport
+{
+	My_TextExport	(TextExport_Options, UInt16, size_t, TextExport_ChunkHandler);
+	
+	void
+	appendCharacter		(UnicodeScalarValue);
+	
+	void
+	appendSpaces	(CFIndex);
+	
+	void
+	handOffChunk ();
+	
+	TextExport_ChunkHandler		chunkHandler;		//!< receives each full chunk
+	std::vector< UInt8 >		chunk;				//!< UTF-8 text that has not been handed off
+	size_t						chunkSize;			//!< number of bytes at which a chunk is handed off
+	UInt64						byteCount;			//!< total bytes of text so far
+	UInt32						lineCount;			//!< number of lines added so far
+	UInt16						spacesPerTab;		//!< if nonzero, runs of spaces become tabs
+	UInt8						separator;			//!< new-line between lines, or 0 if lines are joined
+	Boolean						lastLineHasSeparator;	//!< if true, TextExport_Finish() adds a new-line
+	Boolean						isFinished;			//!< if true, TextExport_Finish() was called
+};
+typedef My_TextExport*			My_TextExportPtr;
+typedef My_TextExport const*	My_TextExportConstPtr;
+
+} // anonymous namespace
+
+#pragma mark Internal Method Prototypes
+namespace {
+
+std::string		exportTestLines		(TextExport_Options, UInt16, size_t, std::vector< std::u16string > const&, UInt32*);
+Boolean			unitTest000_Begin	();
+Boolean			unitTest001_Begin	();
+
+} // anonymous namespace
+
+
+
+#pragma mark Public Methods
+
+/*!
+A unit test for this module.  This should always
+be run before a release, after any substantial
+changes are made, or if you suspect bugs!  It
+should also be EXPANDED as new functionality is
+proposed (ideally, a test is written before the
+functionality is added).
+
+(2021.06)
+*/
+void
+TextExport_RunTests ()
+{
+	UInt16		totalTests = 0;
+	UInt16		failedTests = 0;
+	
+	
+	++totalTests; if (false == unitTest000_Begin()) ++failedTests;
+	++totalTests; if (false == unitTest001_Begin()) ++failedTests;
+	
+	Console_WriteUnitTestReport("Text Export", failedTests, totalTests);
+}// RunTests
+
+
+/*!
+Adds a line of text to the export, after a new-line if it
+is not the first line (unless lines are being joined).
+The text is converted to UTF-8 right away, and every time
+the pending text reaches the chunk size, it is handed to
+the chunk handler.
+
+A surrogate that is not part of a pair is replaced by the
+replacement character (U+FFFD), so that the output is
+always valid UTF-8.
+
+\retval kTextExport_ResultOK
+if the line was added
+
+\retval kTextExport_ResultInvalidReference
+if the export is not valid
+
+\retval kTextExport_ResultParameterError
+if the text is nullptr but the length is not zero
+
+\retval kTextExport_ResultFinished
+if TextExport_Finish() was already called
+
+(2021.06)
+*/
+TextExport_Result
+TextExport_AppendLine	(TextExport_Ref		inRef,
+						 UniChar const*		inText,
+						 CFIndex			inLength)
+{
+	My_TextExportPtr	ptr = REINTERPRET_CAST(inRef, My_TextExportPtr);
+	TextExport_Result	result = kTextExport_ResultOK;
+	
+	
+	if (nullptr == ptr) result = kTextExport_ResultInvalidReference;
+	else if ((nullptr == inText) && (0 != inLength)) result = kTextExport_ResultParameterError;
+	else if (ptr->isFinished) result = kTextExport_ResultFinished;
+	else
+	{
+		CFIndex		spaceCount = 0;
+		
+		
+		if ((ptr->lineCount > 0) && (0 != ptr->separator))
+		{
+			ptr->appendCharacter(ptr->separator);
+		}
+		
+		for (CFIndex i = 0; i < inLength; ++i)
+		{
+			UniChar const	kCharacter = inText[i];
+			
+			
+			if (' ' == kCharacter)
+			{
+				// spaces are counted so that a run can become tabs
+				++spaceCount;
+			}
+			else
+			{
+				ptr->appendSpaces(spaceCount);
+				spaceCount = 0;
+				if ((kCharacter >= 0xD800) && (kCharacter <= 0xDBFF) && ((i + 1) < inLength) &&
+					(inText[i + 1] >= 0xDC00) && (inText[i + 1] <= 0xDFFF))
+				{
+					ptr->appendCharacter(0x10000 + ((STATIC_CAST(kCharacter, UnicodeScalarValue) - 0xD800) << 10) + (inText[i + 1] - 0xDC00));
+					++i;
+				}
+				else if ((kCharacter >= 0xD800) && (kCharacter <= 0xDFFF))
+				{
+					ptr->appendCharacter(0xFFFD);
+				}
+				else
+				{
+					ptr->appendCharacter(kCharacter);
+				}
+			}
+		}
+		ptr->appendSpaces(spaceCount);
+		++(ptr->lineCount);
+		
+		if (ptr->chunk.size() >= ptr->chunkSize)
+		{
+			ptr->handOffChunk();
+		}
+	}
+	return result;
+}// AppendLine
+
+
+/*!
+Destroys an export created with TextExport_New(), and
+sets your copy of the reference to nullptr.  Any text
+that was not handed off is discarded, so call
+TextExport_Finish() first unless the export is being
+cancelled.
+
+(2021.06)
+*/
+void
+TextExport_Dispose	(TextExport_Ref*	inoutRefPtr)
+{
+	if (nullptr != inoutRefPtr)
+	{
+		delete REINTERPRET_CAST(*inoutRefPtr, My_TextExportPtr);
+		*inoutRefPtr = nullptr;
+	}
+}// Dispose
+
+
+/*!
+Ends the export: adds a final new-line (if that option was
+given, and lines are not being joined) and hands off any
+text that is left.  No more lines can be added.
+
+\retval kTextExport_ResultOK
+if the export was finished
+
+\retval kTextExport_ResultInvalidReference
+if the export is not valid
+
+\retval kTextExport_ResultFinished
+if the export was already finished (nothing is done)
+
+(2021.06)
+*/
+TextExport_Result
+TextExport_Finish	(TextExport_Ref		inRef)
+{
+	My_TextExportPtr	ptr = REINTERPRET_CAST(inRef, My_TextExportPtr);
+	TextExport_Result	result = kTextExport_ResultOK;
+	
+	
+	if (nullptr == ptr) result = kTextExport_ResultInvalidReference;
+	else if (ptr->isFinished) result = kTextExport_ResultFinished;
+	else
+	{
+		if ((ptr->lineCount > 0) && (0 != ptr->separator) && (ptr->lastLineHasSeparator))
+		{
+			ptr->appendCharacter(ptr->separator);
+		}
+		ptr->handOffChunk();
+		ptr->isFinished = true;
+	}
+	return result;
+}// Finish
+
+
+/*!
+Creates an export that hands its text to the given
+handler, in chunks of at least the given size (except for
+the last chunk).  A chunk can be larger than that size by
+at most the UTF-8 encoding of one line.
+
+If the number of spaces per tab is nonzero, every run of
+spaces in a line is replaced by one tab for each group of
+that many spaces, plus one tab for any spaces left over.
+
+Dispose of the export with TextExport_Dispose().  Returns
+nullptr if the export cannot be created (for instance, if
+the handler is not defined).
+
+(2021.06)
+*/
+TextExport_Ref
+TextExport_New	(TextExport_Options			inOptions,
+				 UInt16						inSpacesPerTabOrZero,
+				 size_t						inChunkSize,
+				 TextExport_ChunkHandler	inChunkHandler)
+{
+	TextExport_Ref		result = nullptr;
+	
+	
+	if (inChunkHandler)
+	{
+		try
+		{
+			result = REINTERPRET_CAST(new My_TextExport(inOptions, inSpacesPerTabOrZero, inChunkSize, inChunkHandler),
+										TextExport_Ref);
+		}
+		catch (std::bad_alloc)
+		{
+			result = nullptr;
+		}
+	}
+	return result;
+}// New
+
+
+/*!
+Returns the number of bytes of UTF-8 text that the export
+has produced so far, whether or not they were handed off.
+
+(2021.06)
+*/
+UInt64
+TextExport_ReturnByteCount	(TextExport_Ref		inRef)
+{
+	My_TextExportConstPtr	ptr = REINTERPRET_CAST(inRef, My_TextExportConstPtr);
+	UInt64					result = 0;
+	
+	
+	if (nullptr != ptr)
+	{
+		result = ptr->byteCount;
+	}
+	return result;
+}// ReturnByteCount
+
+
+/*!
+Returns the number of lines that have been added to the
+export.
+
+(2021.06)
+*/
+UInt32
+TextExport_ReturnLineCount	(TextExport_Ref		inRef)
+{
+	My_TextExportConstPtr	ptr = REINTERPRET_CAST(inRef, My_TextExportConstPtr);
+	UInt32					result = 0;
+	
+	
+	if (nullptr != ptr)
+	{
+		result = ptr->lineCount;
+	}
+	return result;
+}// ReturnLineCount
+
+
+#pragma mark Internal Methods
+namespace {
+
+/*!
+Creates an export.  See TextExport_New().
+
+(2021.06)
+*/
+My_TextExport::
+My_TextExport	(TextExport_Options			inOptions,
+				 UInt16						inSpacesPerTabOrZero,
+				 size_t						inChunkSize,
+				 TextExport_ChunkHandler	inChunkHandler)
+:
+chunkHandler(inChunkHandler),
+chunk(),
+chunkSize(std::max< size_t >(inChunkSize, 1)),
+byteCount(0),
+lineCount(0),
+spacesPerTab(inSpacesPerTabOrZero),
+separator((inOptions & kTextExport_OptionInline)
+			? 0
+			: ((inOptions & kTextExport_OptionLineSeparatorLF) ? '\012' : '\015')),
+lastLineHasSeparator(0 != (inOptions & kTextExport_OptionLastLineHasSeparator)),
+isFinished(false)
+{
+	chunk.reserve(chunkSize);
+}// My_TextExport constructor
+
+
+/*!
+Adds the UTF-8 encoding of the given character to the
+pending chunk.
+
+(2021.06)
+*/
+void
+My_TextExport::
+appendCharacter		(UnicodeScalarValue		inCharacter)
+{
+	size_t const	kOldSize = chunk.size();
+	
+	
+	if (inCharacter < 0x80)
+	{
+		chunk.push_back(STATIC_CAST(inCharacter, UInt8));
+	}
+	else if (inCharacter < 0x800)
+	{
+		chunk.push_back(STATIC_CAST(0xC0 | (inCharacter >> 6), UInt8));
+		chunk.push_back(STATIC_CAST(0x80 | (inCharacter & 0x3F), UInt8));
+	}
+	else if (inCharacter < 0x10000)
+	{
+		chunk.push_back(STATIC_CAST(0xE0 | (inCharacter >> 12), UInt8));
+		chunk.push_back(STATIC_CAST(0x80 | ((inCharacter >> 6) & 0x3F), UInt8));
+		chunk.push_back(STATIC_CAST(0x80 | (inCharacter & 0x3F), UInt8));
+	}
+	else
+	{
+		chunk.push_back(STATIC_CAST(0xF0 | (inCharacter >> 18), UInt8));
+		chunk.push_back(STATIC_CAST(0x80 | ((inCharacter >> 12) & 0x3F), UInt8));
+		chunk.push_back(STATIC_CAST(0x80 | ((inCharacter >> 6) & 0x3F), UInt8));
+		chunk.push_back(STATIC_CAST(0x80 | (inCharacter & 0x3F), UInt8));
+	}
+	byteCount += (chunk.size() - kOldSize);
+}// My_TextExport::appendCharacter
+
+
+/*!
+Adds a run of spaces to the pending chunk, as tabs if
+that option was given.
+
+(2021.06)
+*/
+void
+My_TextExport::
+appendSpaces	(CFIndex	inCount)
+{
+	if (inCount > 0)
+	{
+		if (spacesPerTab > 0)
+		{
+			CFIndex const	kTabCount = ((inCount + spacesPerTab - 1) / spacesPerTab);
+			
+			
+			chunk.insert(chunk.end(), kTabCount, '\011');
+			byteCount += kTabCount;
+		}
+		else
+		{
+			chunk.insert(chunk.end(), inCount, ' ');
+			byteCount += inCount;
+		}
+	}
+}// My_TextExport::appendSpaces
+
+
+/*!
+Hands the pending chunk (if not empty) to the chunk
+handler, and starts a new one.
+
+(2021.06)
+*/
+void
+My_TextExport::
+handOffChunk ()
+{
+	if (false == chunk.empty())
+	{
+		AsyncWriter_Buffer		buffer = std::make_shared< std::vector< UInt8 > const >(std::move(chunk));
+		
+		
+		chunk = std::vector< UInt8 >();
+		chunk.reserve(chunkSize);
+		chunkHandler(buffer);
+	}
+}// My_TextExport::handOffChunk
+
+
+/*!
+Exports the given lines with the given settings, and
+returns the text with "|" after each chunk, for tests.
+If not nullptr, the chunk count is also returned.
+
+(2021.06)
+*/
+std::string
+exportTestLines		(TextExport_Options						inOptions,
+					 UInt16									inSpacesPerTab,
+					 size_t									inChunkSize,
+					 std::vector< std::u16string > const&	inLines,
+					 UInt32*								outChunkCountOrNull)
+{
+	std::string			result;
+	UInt32				chunkCount = 0;
+	TextExport_Ref		textExport = TextExport_New(inOptions, inSpacesPerTab, inChunkSize,
+													[&] (AsyncWriter_Buffer inBuffer)
+													{
+														result.append(inBuffer->begin(), inBuffer->end());
+														result += '|';
+														++chunkCount;
+													});
+	
+	
+	for (auto const& line : inLines)
+	{
+		UNUSED_RETURN(TextExport_Result)TextExport_AppendLine(textExport, REINTERPRET_CAST(line.data(), UniChar const*), line.size());
+	}
+	UNUSED_RETURN(TextExport_Result)TextExport_Finish(textExport);
+	TextExport_Dispose(&textExport);
+	if (nullptr != outChunkCountOrNull)
+	{
+		*outChunkCountOrNull = chunkCount;
+	}
+	return result;
+}// exportTestLines
+
+
+/*!
+Tests line separators, joined lines, tabs and the UTF-8
+encoding of lines.
+
+Returns "true" if ALL assertions pass; "false" is
+returned if any fail, however messages should be
+printed for ALL assertion failures regardless.
+
+(2021.06)
+*/
+Boolean
+unitTest000_Begin ()
+{
+	std::vector< std::u16string > const		kLines = { u"one  two", u"", u"three" };
+	std::string								output;
+	Boolean									result = true;
+	
+	
+	output = exportTestLines(kTextExport_OptionsNone, 0, 1024, kLines, nullptr);
+	Console_TestAssertUpdate(result, "one  two\r\rthree|" == output, Console_WriteValueStdString, "carriage returns", output);
+	output = exportTestLines(kTextExport_OptionLineSeparatorLF | kTextExport_OptionLastLineHasSeparator, 0, 1024, kLines, nullptr);
+	Console_TestAssertUpdate(result, "one  two\n\nthree\n|" == output, Console_WriteValueStdString, "line feeds, last separator", output);
+	output = exportTestLines(kTextExport_OptionInline | kTextExport_OptionLastLineHasSeparator, 0, 1024, kLines, nullptr);
+	Console_TestAssertUpdate(result, "one  twothree|" == output, Console_WriteValueStdString, "joined lines", output);
+	output = exportTestLines(kTextExport_OptionsNone, 0, 1024, {}, nullptr);
+	Console_TestAssertUpdate(result, output.empty(), Console_WriteValueStdString, "no lines", output);
+	
+	// every run of spaces becomes tabs (one per 4 spaces, rounding up)
+	output = exportTestLines(kTextExport_OptionLineSeparatorLF, 4, 1024, { u"a b    c     d", u"  x" }, nullptr);
+	Console_TestAssertUpdate(result, "a\tb\tc\t\td\n\tx|" == output, Console_WriteValueStdString, "tabs", output);
+	
+	// encoding: 2, 3 and 4 bytes, and a surrogate that is not in a pair
+	output = exportTestLines(kTextExport_OptionsNone, 0, 1024, { u"é─\U0001F600", std::u16string(1, 0xD800) + u"x" }, nullptr);
+	Console_TestAssertUpdate(result, "\xC3\xA9\xE2\x94\x80\xF0\x9F\x98\x80\r\xEF\xBF\xBDx|" == output,
+								Console_WriteValueStdString, "UTF-8", output);
+	
+	return result;
+}// unitTest000_Begin
+
+
+/*!
+Tests chunks, counts and the end of an export.
+
+Returns "true" if ALL assertions pass; "false" is
+returned if any fail, however messages should be
+printed for ALL assertion failures regardless.
+
+(2021.06)
+*/
+Boolean
+unitTest001_Begin ()
+{
+	std::string		output;
+	UInt32			chunkCount = 0;
+	Boolean			result = true;
+	
+	
+	output = exportTestLines(kTextExport_OptionLineSeparatorLF, 0, 6, { u"abc", u"defg", u"h", u"ij" }, &chunkCount);
+	Console_TestAssertUpdate(result, "abc\ndefg|\nh\nij|" == output, Console_WriteValueStdString, "chunks", output);
+	Console_TestAssertUpdate(result, 2 == chunkCount, Console_WriteValue, "chunk count", chunkCount);
+	
+	{
+		UInt32				handledBytes = 0;
+		UniChar const		kText[] = { 'a', 0x00E9 };
+		TextExport_Ref		textExport = TextExport_New(kTextExport_OptionsNone, 0, 1024,
+														[&] (AsyncWriter_Buffer inBuffer) { handledBytes += inBuffer->size(); });
+		TextExport_Result	exportResult = kTextExport_ResultOK;
+		
+		
+		exportResult = TextExport_AppendLine(textExport, kText, 2);
+		Console_TestAssertUpdate(result, kTextExport_ResultOK == exportResult, Console_WriteValue, "append result", exportResult);
+		exportResult = TextExport_AppendLine(textExport, kText, 1);
+		Console_TestAssertUpdate(result, 5 == TextExport_ReturnByteCount(textExport), Console_WriteValue, "byte count",
+									STATIC_CAST(TextExport_ReturnByteCount(textExport), UInt32));
+		Console_TestAssertUpdate(result, 2 == TextExport_ReturnLineCount(textExport), Console_WriteValue, "line count",
+									TextExport_ReturnLineCount(textExport));
+		Console_TestAssertUpdate(result, 0 == handledBytes, Console_WriteValue, "bytes handled before finishing", handledBytes);
+		exportResult = TextExport_AppendLine(textExport, nullptr, 1);
+		Console_TestAssertUpdate(result, kTextExport_ResultParameterError == exportResult, Console_WriteValue, "null text", exportResult);
+		exportResult = TextExport_Finish(textExport);
+		Console_TestAssertUpdate(result, kTextExport_ResultOK == exportResult, Console_WriteValue, "finish result", exportResult);
+		Console_TestAssertUpdate(result, 5 == handledBytes, Console_WriteValue, "bytes handled", handledBytes);
+		exportResult = TextExport_AppendLine(textExport, kText, 1);
+		Console_TestAssertUpdate(result, kTextExport_ResultFinished == exportResult, Console_WriteValue, "append after finishing", exportResult);
+		exportResult = TextExport_Finish(textExport);
+		Console_TestAssertUpdate(result, kTextExport_ResultFinished == exportResult, Console_WriteValue, "second finish", exportResult);
+		TextExport_Dispose(&textExport);
+		Console_TestAssertUpdate(result, nullptr == textExport, Console_WriteLine, "export was not cleared");
+		Console_TestAssertUpdate(result, kTextExport_ResultInvalidReference == TextExport_Finish(textExport),
+									Console_WriteLine, "finishing a null export should fail");
+	}
+	
+	Console_TestAssertUpdate(result, nullptr == TextExport_New(kTextExport_OptionsNone, 0, 1024, nullptr),
+								Console_WriteLine, "export without a handler was created");
+	
+	return result;
+}// unitTest001_Begin
+
+} // anonymous namespace
+
+// BELOW IS REQUIRED NEWLINE TO END FILE
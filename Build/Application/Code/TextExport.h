@@ -0,0 +1,155 @@
+/*!	\file TextExport.h
+	\brief Converts lines of terminal text into UTF-8 chunks
+	of bounded size, for copying or saving a selection.
+	
+	Selected text used to be appended line by line to one
+	string, which was only converted (and written to a file
+	or the pasteboard) at the very end; so a selection of a
+	large scrollback was held in memory twice, and spaces
+	were replaced by tabs with repeated searches of the
+	entire string.  An export instead converts each line as
+	it is given, and hands each full chunk to a handler
+	(which can enqueue it on an Async Writer, for instance);
+	only one chunk is ever held by the export.
+	
+	Lines are separated by new-lines unless they are being
+	joined; and if requested, each run of spaces becomes
+	tabs (one for every N spaces, and one for any spaces
+	left over), which is how tables are copied.
+*/
+/*###############################################################
+
+	MacTerm
+		© 1998-2021 by Kevin Grant.
+		© 2001-2003 by Ian Anderson.
+		© 1986-1994 University of Illinois Board of Trustees
+		(see About box for full list of U of I contributors).
+	
+	This program is free software; you can redistribute it or
+	modify it under the terms of the GNU General Public License
+	as published by the Free Software Foundation; either version
+	2 of the License, or (at your option) any later version.
+	
+	This program is distributed in the hope that it will be
+	useful, but WITHOUT ANY WARRANTY; without even the implied
+	warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+	PURPOSE.  See the GNU General Public License for more
+	details.
+	
+	You should have received a copy of the GNU General Public
+	License along with this program; if not, write to:
+	
+		Free Software Foundation, Inc.
+		59 Temple Place, Suite 330
+		Boston, MA  02111-1307
+		USA
+
+###############################################################*/
+
+#include <UniversalDefines.h>
+
+#pragma once
+
+// standard-C++ includes
+#include <functional>
+
+// Mac includes
+#include <CoreServices/CoreServices.h>
+
+// library includes
+#include <AsyncWriter.h>
+
+
+
+#pragma mark Constants
+
+/*!
+Possible return values from Text Export module routines.
+*/
+typedef long TextExport_Result;
+enum
+{
+	kTextExport_ResultOK					= 0,	//!< no error
+	kTextExport_ResultInvalidReference		= 1,	//!< given TextExport_Ref is not valid
+	kTextExport_ResultParameterError		= 2,	//!< invalid input (e.g. a null buffer)
+	kTextExport_ResultFinished				= 3		//!< TextExport_Finish() was already called, so nothing is added
+};
+
+/*!
+Options for TextExport_New().
+*/
+typedef UInt32 TextExport_Options;
+enum
+{
+	kTextExport_OptionsNone					= 0,
+	kTextExport_OptionInline				= (1 << 0),		//!< join all lines, without any new-lines
+	kTextExport_OptionLineSeparatorLF		= (1 << 1),		//!< separate lines with LF instead of CR
+	kTextExport_OptionLastLineHasSeparator	= (1 << 2)		//!< also end the last line with a new-line (unless inline)
+};
+
+#pragma mark Types
+
+typedef struct TextExport_OpaqueExport*		TextExport_Ref;
+
+/*!
+A chunk handler is invoked with each chunk of UTF-8 text,
+in order, on the thread that adds lines.  Chunks are never
+empty, and never split the encoding of a character.
+*/
+typedef std::function< void (AsyncWriter_Buffer) >		TextExport_ChunkHandler;
+
+
+
+#pragma mark Public Methods
+
+//!\name Module Tests
+//@{
+
+void
+	TextExport_RunTests					();
+
+//@}
+
+//!\name Creating and Destroying Exports
+//@{
+
+// A CHUNK IS HANDED OFF AS SOON AS IT HAS AT LEAST THE GIVEN NUMBER OF BYTES
+TextExport_Ref
+	TextExport_New						(TextExport_Options			inOptions,
+										 UInt16						inSpacesPerTabOrZero,
+										 size_t						inChunkSize,
+										 TextExport_ChunkHandler	inChunkHandler);
+
+// DOES NOT FINISH THE EXPORT; TEXT THAT WAS NOT HANDED OFF IS DISCARDED
+void
+	TextExport_Dispose					(TextExport_Ref*			inoutRefPtr);
+
+//@}
+
+//!\name Adding Text
+//@{
+
+TextExport_Result
+	TextExport_AppendLine				(TextExport_Ref				inRef,
+										 UniChar const*				inText,
+										 CFIndex					inLength);
+
+// HANDS OFF THE LAST CHUNK (IF ANY)
+TextExport_Result
+	TextExport_Finish					(TextExport_Ref				inRef);
+
+//@}
+
+//!\name Checking Progress
+//@{
+
+// INCLUDES TEXT THAT HAS NOT BEEN HANDED OFF YET
+UInt64
+	TextExport_ReturnByteCount			(TextExport_Ref				inRef);
+
+UInt32
+	TextExport_ReturnLineCount			(TextExport_Ref				inRef);
+
+//@}
+
+// BELOW IS REQUIRED NEWLINE TO END FILE
@@ -37,6 +37,7 @@ import SwiftUI
 @objc public protocol UIDebugInterface_ActionHandling : NSObjectProtocol {
 	// implement these functions to bind to button actions
 	func dumpStateOfActiveTerminal()
+	func exportTraceSpans()
 	func launchNewCallPythonClient()
 	func showTestTerminalToolbar()
 	func updateSettingCache()
@@ -45,6 +46,7 @@ import SwiftUI
 class UIDebugInterface_RunnerDummy : NSObject, UIDebugInterface_ActionHandling {
 	// dummy used for debugging in playground (just prints function that is called)
 	func dumpStateOfActiveTerminal() { print(#function) }
+	func exportTraceSpans() { print(#function) }
 	func launchNewCallPythonClient() { print(#function) }
 	func showTestTerminalToolbar() { print(#function) }
 	func updateSettingCache() { print(#function) }
@@ -136,6 +138,30 @@ public class UIDebugInterface_Model : NSObject, ObservableObject {
 			runner.updateSettingCache()
 		}
 	}
+	@Published @objc public var logWarningsOnly = false {
+		willSet(isOn) {
+			if isOn {
+				print("started discarding log messages other than warnings and errors")
+			} else {
+				print("no longer discarding log messages")
+			}
+		}
+		didSet {
+			runner.updateSettingCache()
+		}
+	}
+	@Published @objc public var recordTraceSpans = false {
+		willSet(isOn) {
+			if isOn {
+				print("started recording of trace spans")
+			} else {
+				print("no recording of trace spans")
+			}
+		}
+		didSet {
+			runner.updateSettingCache()
+		}
+	}
 	public var runner: UIDebugInterface_ActionHandling
 
 	@objc public init(runner: UIDebugInterface_ActionHandling) {
@@ -175,6 +201,11 @@ public struct UIDebugInterface_View : View {
 						.fixedSize()
 						.macTermToolTipText("Print information on low-level terminal device, such as enabled control flags.")
 				}
+				UICommon_OptionLineView {
+					Toggle("Log Only Warnings and Errors", isOn: $viewModel.logWarningsOnly)
+						.fixedSize()
+						.macTermToolTipText("Discard all other log messages without formatting them, to reduce the cost of logging (for instance, while measuring performance).")
+				}
 			}
 			Spacer().asMacTermSectionSpacingV()
 			Group {
@@ -195,14 +226,33 @@ public struct UIDebugInterface_View : View {
 				}
 			}
 			Spacer().asMacTermSectionSpacingV()
-			VStack(
-				alignment: .leading
-			) {
-				UICommon_OptionLineView("Active Terminal") {
-					Button(action: { viewModel.runner.dumpStateOfActiveTerminal() }) {
-						Text("Log Detailed Snapshot")
-							.frame(minWidth: 160)
-							.macTermToolTipText("Print debugging summary of frontmost terminal window.")
+			Group {
+				VStack(
+					alignment: .leading
+				) {
+					UICommon_OptionLineView("Active Terminal") {
+						Button(action: { viewModel.runner.dumpStateOfActiveTerminal() }) {
+							Text("Log Detailed Snapshot")
+								.frame(minWidth: 160)
+								.macTermToolTipText("Print debugging summary of frontmost terminal window.")
+						}
+					}
+				}
+				Spacer().asMacTermSectionSpacingV()
+				VStack(
+					alignment: .leading
+				) {
+					UICommon_OptionLineView("Performance") {
+						Toggle("Record Trace Spans", isOn: $viewModel.recordTraceSpans)
+							.fixedSize()
+							.macTermToolTipText("Keep timing information for each stage of data processing and drawing, on every thread (only the most recent activity is kept).")
+					}
+					UICommon_OptionLineView {
+						Button(action: { viewModel.runner.exportTraceSpans() }) {
+							Text("Export Trace…")
+								.frame(minWidth: 160)
+								.macTermToolTipText("Save recorded spans as a JSON file that can be opened in “chrome://tracing” or the Perfetto UI.")
+						}
 					}
 				}
 			}
@@ -595,6 +595,11 @@ UIStrings_Copy	(UIStrings_ClipboardWindowCFString	inWhichString,
 													CFSTR("kUIStrings_ClipboardWindowLabelHeight; used to label the height property of a copied image"));
 		break;
 	
+	case kUIStrings_ClipboardWindowLabelProgress:
+		outString = CFCopyLocalizedStringFromTable(CFSTR("Copied"), CFSTR("ClipboardWindow"),
+													CFSTR("kUIStrings_ClipboardWindowLabelProgress; used to label how much of a large copied selection has been prepared so far"));
+		break;
+	
 	case kUIStrings_ClipboardWindowPixelDimensionTemplate:
 		outString = CFCopyLocalizedStringFromTable(CFSTR("%1$d pixels"), CFSTR("ClipboardWindow"),
 													CFSTR("kUIStrings_ClipboardWindowPixelDimensionTemplate; %1$d is a numeric pixel value"));
@@ -605,6 +610,11 @@ UIStrings_Copy	(UIStrings_ClipboardWindowCFString	inWhichString,
 													CFSTR("kUIStrings_ClipboardWindowOnePixel; used to represent a size of exactly one pixel"));
 		break;
 	
+	case kUIStrings_ClipboardWindowRowProgressTemplate:
+		outString = CFCopyLocalizedStringFromTable(CFSTR("%1$lld of %2$lld lines"), CFSTR("ClipboardWindow"),
+													CFSTR("kUIStrings_ClipboardWindowRowProgressTemplate; %1$lld is the number of lines prepared so far; %2$lld is the total number of lines"));
+		break;
+	
 	case kUIStrings_ClipboardWindowGenericKindText:
 		outString = CFCopyLocalizedStringFromTable(CFSTR("text"), CFSTR("ClipboardWindow"),
 													CFSTR("kUIStrings_ClipboardWindowGenericKindText"));
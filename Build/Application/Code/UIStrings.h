@@ -193,8 +193,10 @@ enum UIStrings_ClipboardWindowCFString
 	kUIStrings_ClipboardWindowIconName					= 'Icon',
 	kUIStrings_ClipboardWindowLabelWidth				= 'LWid',
 	kUIStrings_ClipboardWindowLabelHeight				= 'LHgt',
+	kUIStrings_ClipboardWindowLabelProgress				= 'LPrg',
 	kUIStrings_ClipboardWindowPixelDimensionTemplate	= 'DPix',
 	kUIStrings_ClipboardWindowOnePixel					= '1Pix',
+	kUIStrings_ClipboardWindowRowProgressTemplate		= 'DRow',
 	kUIStrings_ClipboardWindowGenericKindText			= 'Text',
 	kUIStrings_ClipboardWindowGenericKindImage			= 'Imag',
 	kUIStrings_ClipboardWindowDataSizeTemplate			= 'DSiz',
@@ -57,6 +57,7 @@
 
 // application includes
 #include "AppResources.h"
+#include "LinkScanner.h"
 #include "QuillsSession.h"
 #include "TerminalScreenRef.typedef.h"
 #include "TerminalView.h"
@@ -105,6 +106,57 @@ char const*		gURLSchemeNames[] =
 
 #pragma mark Public Methods
 
+/*!
+Opens the given URL, the same way as any URL that the
+user selects: script-based handlers are tried first,
+and Launch Services is the fallback.  This is used for
+links that the user clicks directly, including the
+hyperlinks that applications define.
+
+Returns "true" only if the URL was given to a handler;
+"false" if the string does not start with a known URL
+scheme, or an exception was raised.
+
+(2021.06)
+*/
+Boolean
+URL_HandleCFString		(CFStringRef	inURLCFString)
+{
+	Boolean		result = false;
+	
+	
+	if ((nullptr != inURLCFString) && (kURL_TypeInvalid != URL_ReturnTypeFromCFString(inURLCFString)))
+	{
+		std::string		urlUTF8;
+		
+		
+		// ideally, this should reuse the URL Apple Event handler;
+		// but during the transition to Cocoa, that is more complex
+		// than is convenient, so Quills is just called directly
+		StringUtilities_CFToUTF8(inURLCFString, urlUTF8);
+		if (false == urlUTF8.empty())
+		{
+			try
+			{
+				Quills::Session::handle_url(urlUTF8);
+				result = true;
+			}
+			catch (std::exception const&	e)
+			{
+				CFStringRef			titleCFString = CFSTR("Exception while trying to handle URL"); // LOCALIZE THIS
+				CFRetainRelease		messageCFString(CFStringCreateWithCString
+													(kCFAllocatorDefault, e.what(), kCFStringEncodingUTF8),
+													CFRetainRelease::kAlreadyRetained); // LOCALIZE THIS?
+				
+				
+				Console_WriteScriptError(titleCFString, messageCFString.returnCFStringRef());
+			}
+		}
+	}
+	return result;
+}// HandleCFString
+
+
 /*!
 Examines the currently-selected text of the specified
 terminal view for a valid URL.  If it finds one, the
@@ -123,41 +175,10 @@ URL_HandleForScreenView		(TerminalScreenRef	UNUSED_ARGUMENT(inScreen),
 	Boolean				openFailed = true;
 	
 	
-	if (urlObject.exists())
+	if (urlObject.exists() && (kURL_TypeInvalid != URL_ReturnTypeFromCFString(urlObject.returnCFStringRef())))
 	{
-		CFStringRef		urlAsCFString = urlObject.returnCFStringRef();
-		URL_Type		urlKind = URL_ReturnTypeFromCFString(urlAsCFString);
-		
-		
-		if (kURL_TypeInvalid != urlKind)
-		{
-			std::string		urlUTF8;
-			
-			
-			// ideally, this should reuse the URL Apple Event handler;
-			// but during the transition to Cocoa, that is more complex
-			// than is convenient, so Quills is just called directly
-			StringUtilities_CFToUTF8(urlAsCFString, urlUTF8);
-			if (false == urlUTF8.empty())
-			{
-				TerminalView_ZoomOpenFromSelection(inView);
-				try
-				{
-					Quills::Session::handle_url(urlUTF8);
-					openFailed = false;
-				}
-				catch (std::exception const&	e)
-				{
-					CFStringRef			titleCFString = CFSTR("Exception while trying to handle URL"); // LOCALIZE THIS
-					CFRetainRelease		messageCFString(CFStringCreateWithCString
-														(kCFAllocatorDefault, e.what(), kCFStringEncodingUTF8),
-														CFRetainRelease::kAlreadyRetained); // LOCALIZE THIS?
-					
-					
-					Console_WriteScriptError(titleCFString, messageCFString.returnCFStringRef());
-				}
-			}
-		}
+		TerminalView_ZoomOpenFromSelection(inView);
+		openFailed = (false == URL_HandleCFString(urlObject.returnCFStringRef()));
 	}
 	
 	if (openFailed)
@@ -277,6 +298,26 @@ URL_ParseCFString	(CFStringRef	inURLString)
 }// ParseCFString
 
 
+/*!
+Returns a link matcher for every URL scheme that this
+module recognizes (see LinkScanner_NewMatcher()); the
+scheme index of a link is its URL_Type.  The matcher is
+created the first time, and must not be disposed.
+
+Returns nullptr only if the matcher cannot be created.
+
+(2021.06)
+*/
+LinkScanner_MatcherRef
+URL_ReturnLinkMatcher ()
+{
+	static LinkScanner_MatcherRef	gMatcher = LinkScanner_NewMatcher(gURLSchemeNames);
+	
+	
+	return gMatcher;
+}// ReturnLinkMatcher
+
+
 /*!
 Parses the given Core Foundation string and returns
 what kind of URL it seems to represent.
@@ -331,33 +372,23 @@ string, and returns what kind of URL it seems
 to represent.
 
 Whitespace is NOT stripped in this version of
-the routine.
+the routine.  The scheme may be in any case.
 
-(3.1)
+(2021.06)
 */
 URL_Type
 URL_ReturnTypeFromCharacterRange	(char const*	inBegin,
 									 char const*	inPastEnd)
 {
-	URL_Type	result = kURL_TypeInvalid;
-	SInt16		i = 0;
+	URL_Type		result = kURL_TypeInvalid;
+	SInt16 const	kSchemeIndex = LinkScanner_ReturnSchemeAtStart(URL_ReturnLinkMatcher(), inBegin, inPastEnd);
 	
 	
-	// look for a match on the prefix (e.g. "http:")
-	for (i = 0; (nullptr != gURLSchemeNames[i]); ++i)
+	// look for a match on the prefix (e.g. "http:"), which
+	// must be followed by something
+	if (kSchemeIndex > 0)
 	{
-		char const* const	kCStringPtr = gURLSchemeNames[i];
-		
-		
-		// obviously the URL must be at least as long as its prefix!
-		if ((inPastEnd - inBegin) > STATIC_CAST(std::strlen(kCStringPtr), ptrdiff_t))
-		{
-			if (std::equal(kCStringPtr, kCStringPtr + std::strlen(kCStringPtr), inBegin))
-			{
-				result = STATIC_CAST(i, URL_Type);
-				break;
-			}
-		}
+		result = STATIC_CAST(kSchemeIndex, URL_Type);
 	}
 	return result;
 }// ReturnTypeFromCharacterRange
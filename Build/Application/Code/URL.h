@@ -42,6 +42,7 @@
 #pragma once
 
 // application includes
+#include "LinkScanner.h"
 #include "TerminalScreenRef.typedef.h"
 #include "TerminalViewRef.typedef.h"
 
@@ -87,6 +88,9 @@ enum URL_Type
 
 #pragma mark Public Methods
 
+Boolean
+	URL_HandleCFString					(CFStringRef					inURLCFString);
+
 void
 	URL_HandleForScreenView				(TerminalScreenRef				inScreen,
 										 TerminalViewRef				inView);
@@ -97,6 +101,10 @@ Boolean
 Boolean
 	URL_ParseCFString					(CFStringRef					inURLCFString);
 
+// DO NOT DISPOSE; THE SCHEME INDEX OF EACH LINK IS ITS URL_Type
+LinkScanner_MatcherRef
+	URL_ReturnLinkMatcher				();
+
 URL_Type
 	URL_ReturnTypeFromCFString			(CFStringRef					inURLCFString);
 
@@ -1143,7 +1143,7 @@ an existing interpreter.
 Boolean
 isValidID	(VectorInterpreter_Ref	inRef)
 {
-	return (gVectorInterpreterValidRefs().end() != gVectorInterpreterValidRefs().find(inRef));
+	return (gVectorInterpreterValidRefs().contains(inRef));
 }// isValidID
 
 
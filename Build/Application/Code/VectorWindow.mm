@@ -256,7 +256,7 @@ VectorWindow_ReturnController	(VectorWindow_Ref	inWindow)
 	
 	
 	// a reference that has been released is a bad reference
-	if (gVectorWindowValidRefs().end() != gVectorWindowValidRefs().find(inWindow))
+	if (gVectorWindowValidRefs().contains(inWindow))
 	{
 		result = [VectorWindow_Controller windowControllerForWindowRef:inWindow];
 	}
@@ -0,0 +1,954 @@
+/*!	\file WordBoundary.cp
+	\brief Finds the word around a character in terminal text,
+	such as the word that the user double-clicked.
+*/
+/*###############################################################
+
+	MacTerm
+		© 1998-2021 by Kevin Grant.
+		© 2001-2003 by Ian Anderson.
+		© 1986-1994 University of Illinois Board of Trustees
+		(see About box for full list of U of I contributors).
+	
+	This program is free software; you can redistribute it or
+	modify it under the terms of the GNU General Public License
+	as published by the Free Software Foundation; either version
+	2 of the License, or (at your option) any later version.
+	
+	This program is distributed in the hope that it will be
+	useful, but WITHOUT ANY WARRANTY; without even the implied
+	warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+	PURPOSE.  See the GNU General Public License for more
+	details.
+	
+	You should have received a copy of the GNU General Public
+	License along with this program; if not, write to:
+	
+		Free Software Foundation, Inc.
+		59 Temple Place, Suite 330
+		Boston, MA  02111-1307
+		USA
+
+###############################################################*/
+
+#include "WordBoundary.h"
+#include <UniversalDefines.h>
+
+// standard-C includes
+#include <cstring>
+
+// standard-C++ includes
+#include <algorithm>
+#include <array>
+#include <string>
+#include <vector>
+
+// library includes
+#include <Console.h>
+
+
+
+#pragma mark Constants
+namespace {
+
+/*!
+Word-break properties of characters, from Unicode Standard
+Annex #29 (properties that do not matter to a terminal,
+such as those of regional-indicator symbols, are “other”).
+*/
+enum My_WordClass : UInt8
+{
+	kMy_WordClassOther			= 0,	//!< breaks on both sides (punctuation, symbols, ideographs)
+	kMy_WordClassSpace			= 1,	//!< white space or a new-line; runs of these are kept together
+	kMy_WordClassExtend			= 2,	//!< combining marks and format characters; stays with the previous character
+	kMy_WordClassLetter			= 3,	//!< “ALetter”
+	kMy_WordClassNumeric		= 4,	//!< digits
+	kMy_WordClassKatakana		= 5,	//!< Katakana, which forms words only with Katakana
+	kMy_WordClassMidLetter		= 6,	//!< joins letters only (e.g. ":")
+	kMy_WordClassMidNumber		= 7,	//!< joins digits only (e.g. ",")
+	kMy_WordClassMidNumberLetter	= 8,	//!< joins letters or digits (e.g. "." and "'")
+	kMy_WordClassExtendNumberLetter	= 9		//!< joins anything that forms words (e.g. "_"), including word characters
+};
+
+/*!
+Word characters of the shared classifier, unless they are
+changed with WordBoundary_SetSharedWordCharacters().  These
+keep paths and command-line options together.
+*/
+char const		kMy_DefaultWordCharacters[] = "-+/\\~_";
+
+} // anonymous namespace
+
+#pragma mark Types
+namespace {
+
+/*!
+A range of non-ASCII characters that have the same class.
+Characters that are not in any range are letters.
+*/
+struct My_WordClassRange
+{
+	UniChar			first;		//!< first character of the range
+	UniChar			last;		//!< last character of the range (inclusive)
+	My_WordClass	wordClass;	//!< class of every character in the range
+};
+
+/*!
+Internal representation of a WordBoundary_ClassifierRef.
+*/
+struct My_Classifier
+{
+	My_Classifier	(CFStringRef);
+	
+	My_WordClass
+	returnClass		(UniChar) const;
+	
+	std::array< My_WordClass, 128 >		asciiClasses;			//!< class of every ASCII character, with word characters
+	std::vector< UniChar >				otherWordCharacters;	//!< sorted non-ASCII word characters
+};
+typedef My_Classifier*			My_ClassifierPtr;
+typedef My_Classifier const*	My_ClassifierConstPtr;
+
+} // anonymous namespace
+
+#pragma mark Internal Method Prototypes
+namespace {
+
+Boolean			isBreakBeforeCluster	(My_ClassifierConstPtr, UniChar const*, UInt16, UInt16);
+Boolean			isBreakBetween			(My_WordClass, My_WordClass, My_WordClass, My_WordClass);
+Boolean			isLetterOrNumber		(My_WordClass);
+My_WordClass	returnASCIIClass		(UniChar);
+UInt16			returnClusterEnd		(My_ClassifierConstPtr, UniChar const*, UInt16, UInt16);
+UInt16			returnClusterStart		(My_ClassifierConstPtr, UniChar const*, UInt16);
+My_WordClass	returnNonASCIIClass		(UniChar);
+std::string		returnTestWord			(WordBoundary_ClassifierRef, char const*, UInt16);
+Boolean			unitTest000_Begin		();
+Boolean			unitTest001_Begin		();
+
+} // anonymous namespace
+
+#pragma mark Variables
+namespace {
+
+/*!
+Non-ASCII characters that are not letters, in order.  This
+is an approximation of the Unicode character database that
+covers the scripts and symbols that terminals commonly show
+(for instance, box-drawing characters and private-use icons
+are not letters, and ideographs are each a word).
+*/
+My_WordClassRange const		gNonASCIIClassRanges[] =
+{
+	{ 0x0080, 0x009F, kMy_WordClassOther },				// C1 controls
+	{ 0x00A0, 0x00A9, kMy_WordClassOther },				// Latin-1 punctuation and symbols...
+	{ 0x00AB, 0x00AC, kMy_WordClassOther },
+	{ 0x00AD, 0x00AD, kMy_WordClassExtend },			// soft hyphen
+	{ 0x00AE, 0x00B4, kMy_WordClassOther },
+	{ 0x00B6, 0x00B6, kMy_WordClassOther },
+	{ 0x00B7, 0x00B7, kMy_WordClassMidLetter },			// middle dot
+	{ 0x00B8, 0x00B9, kMy_WordClassOther },
+	{ 0x00BB, 0x00BF, kMy_WordClassOther },
+	{ 0x00D7, 0x00D7, kMy_WordClassOther },				// multiplication sign
+	{ 0x00F7, 0x00F7, kMy_WordClassOther },				// division sign
+	{ 0x0300, 0x036F, kMy_WordClassExtend },			// combining diacritical marks
+	{ 0x037E, 0x037E, kMy_WordClassMidNumber },			// Greek question mark
+	{ 0x0387, 0x0387, kMy_WordClassMidLetter },			// Greek ano teleia
+	{ 0x0483, 0x0489, kMy_WordClassExtend },			// Cyrillic combining marks
+	{ 0x0589, 0x0589, kMy_WordClassMidNumber },			// Armenian full stop
+	{ 0x0591, 0x05BD, kMy_WordClassExtend },			// Hebrew points...
+	{ 0x05BF, 0x05BF, kMy_WordClassExtend },
+	{ 0x05C1, 0x05C2, kMy_WordClassExtend },
+	{ 0x05C4, 0x05C5, kMy_WordClassExtend },
+	{ 0x05C7, 0x05C7, kMy_WordClassExtend },
+	{ 0x0600, 0x0605, kMy_WordClassExtend },			// Arabic format characters
+	{ 0x060C, 0x060D, kMy_WordClassMidNumber },			// Arabic commas
+	{ 0x0610, 0x061A, kMy_WordClassExtend },			// Arabic marks...
+	{ 0x064B, 0x065F, kMy_WordClassExtend },
+	{ 0x0660, 0x0669, kMy_WordClassNumeric },			// Arabic-Indic digits
+	{ 0x066B, 0x066B, kMy_WordClassNumeric },			// Arabic decimal separator
+	{ 0x066C, 0x066C, kMy_WordClassMidNumber },			// Arabic thousands separator
+	{ 0x0670, 0x0670, kMy_WordClassExtend },
+	{ 0x06D6, 0x06DC, kMy_WordClassExtend },
+	{ 0x06DF, 0x06E4, kMy_WordClassExtend },
+	{ 0x06E7, 0x06E8, kMy_WordClassExtend },
+	{ 0x06EA, 0x06ED, kMy_WordClassExtend },
+	{ 0x06F0, 0x06F9, kMy_WordClassNumeric },			// extended Arabic-Indic digits
+	{ 0x0900, 0x0903, kMy_WordClassExtend },			// Devanagari signs...
+	{ 0x093A, 0x093C, kMy_WordClassExtend },
+	{ 0x093E, 0x094F, kMy_WordClassExtend },
+	{ 0x0951, 0x0957, kMy_WordClassExtend },
+	{ 0x0962, 0x0963, kMy_WordClassExtend },
+	{ 0x0964, 0x0965, kMy_WordClassOther },				// dandas
+	{ 0x0966, 0x096F, kMy_WordClassNumeric },			// Devanagari digits
+	{ 0x09E6, 0x09EF, kMy_WordClassNumeric },			// Bengali digits
+	{ 0x0E31, 0x0E31, kMy_WordClassExtend },			// Thai vowel signs and tone marks...
+	{ 0x0E34, 0x0E3A, kMy_WordClassExtend },
+	{ 0x0E47, 0x0E4E, kMy_WordClassExtend },
+	{ 0x0E50, 0x0E59, kMy_WordClassNumeric },			// Thai digits
+	{ 0x1680, 0x1680, kMy_WordClassSpace },				// Ogham space mark
+	{ 0x1AB0, 0x1AFF, kMy_WordClassExtend },			// combining diacritical marks extended
+	{ 0x1DC0, 0x1DFF, kMy_WordClassExtend },			// combining diacritical marks supplement
+	{ 0x2000, 0x2006, kMy_WordClassSpace },				// typographic spaces...
+	{ 0x2007, 0x2007, kMy_WordClassOther },				// figure space (not for breaking)
+	{ 0x2008, 0x200A, kMy_WordClassSpace },
+	{ 0x200B, 0x200B, kMy_WordClassOther },				// zero-width space
+	{ 0x200C, 0x200F, kMy_WordClassExtend },			// joiners and direction marks
+	{ 0x2010, 0x2017, kMy_WordClassOther },				// dashes...
+	{ 0x2018, 0x2019, kMy_WordClassMidNumberLetter },	// single quotation marks (apostrophes)
+	{ 0x201A, 0x2023, kMy_WordClassOther },
+	{ 0x2024, 0x2024, kMy_WordClassMidNumberLetter },	// one dot leader
+	{ 0x2025, 0x2026, kMy_WordClassOther },
+	{ 0x2027, 0x2027, kMy_WordClassMidLetter },			// hyphenation point
+	{ 0x2028, 0x2029, kMy_WordClassSpace },				// line and paragraph separators
+	{ 0x202A, 0x202E, kMy_WordClassExtend },			// direction formatting
+	{ 0x202F, 0x202F, kMy_WordClassExtendNumberLetter },	// narrow no-break space
+	{ 0x2030, 0x203E, kMy_WordClassOther },
+	{ 0x203F, 0x2040, kMy_WordClassExtendNumberLetter },	// tie characters
+	{ 0x2041, 0x2053, kMy_WordClassOther },
+	{ 0x2054, 0x2054, kMy_WordClassExtendNumberLetter },
+	{ 0x2055, 0x205E, kMy_WordClassOther },
+	{ 0x205F, 0x205F, kMy_WordClassSpace },				// medium mathematical space
+	{ 0x2060, 0x206F, kMy_WordClassExtend },			// invisible operators and format characters
+	{ 0x20A0, 0x20CF, kMy_WordClassOther },				// currency symbols
+	{ 0x20D0, 0x20FF, kMy_WordClassExtend },			// combining marks for symbols
+	{ 0x2190, 0x2BFF, kMy_WordClassOther },				// arrows, mathematical and technical symbols, box drawing, shapes, dingbats
+	{ 0x2E00, 0x2FFF, kMy_WordClassOther },				// supplemental punctuation, CJK radicals
+	{ 0x3000, 0x3000, kMy_WordClassSpace },				// ideographic space
+	{ 0x3001, 0x3030, kMy_WordClassOther },				// CJK punctuation
+	{ 0x3031, 0x3035, kMy_WordClassKatakana },			// vertical kana repeat marks
+	{ 0x3036, 0x3098, kMy_WordClassOther },				// CJK symbols, Hiragana
+	{ 0x3099, 0x309A, kMy_WordClassExtend },			// combining sound marks
+	{ 0x309B, 0x309C, kMy_WordClassKatakana },			// sound marks
+	{ 0x309D, 0x309F, kMy_WordClassOther },				// Hiragana iteration marks
+	{ 0x30A0, 0x30FA, kMy_WordClassKatakana },			// Katakana...
+	{ 0x30FB, 0x30FB, kMy_WordClassOther },				// Katakana middle dot
+	{ 0x30FC, 0x30FF, kMy_WordClassKatakana },
+	{ 0x3100, 0x312F, kMy_WordClassOther },				// Bopomofo
+	{ 0x3190, 0x31EF, kMy_WordClassOther },				// Kanbun, CJK strokes
+	{ 0x31F0, 0x31FF, kMy_WordClassKatakana },			// Katakana phonetic extensions
+	{ 0x3200, 0x32CF, kMy_WordClassOther },				// enclosed CJK letters...
+	{ 0x32D0, 0x32FE, kMy_WordClassKatakana },			// circled Katakana
+	{ 0x32FF, 0x32FF, kMy_WordClassOther },
+	{ 0x3300, 0x3357, kMy_WordClassKatakana },			// squared Katakana words
+	{ 0x3358, 0x9FFF, kMy_WordClassOther },				// CJK compatibility, ideographs, hexagrams
+	{ 0xD800, 0xDBFF, kMy_WordClassOther },				// high surrogates (emoji and other supplementary symbols)
+	{ 0xDC00, 0xDFFF, kMy_WordClassExtend },			// low surrogates (keeps each pair together)
+	{ 0xE000, 0xF8FF, kMy_WordClassOther },				// private use (icons)
+	{ 0xF900, 0xFAFF, kMy_WordClassOther },				// CJK compatibility ideographs
+	{ 0xFD3E, 0xFD3F, kMy_WordClassOther },				// ornate parentheses
+	{ 0xFE00, 0xFE0F, kMy_WordClassExtend },			// variation selectors
+	{ 0xFE10, 0xFE10, kMy_WordClassMidNumber },			// vertical forms...
+	{ 0xFE11, 0xFE12, kMy_WordClassOther },
+	{ 0xFE13, 0xFE13, kMy_WordClassMidLetter },
+	{ 0xFE14, 0xFE14, kMy_WordClassMidNumber },
+	{ 0xFE15, 0xFE1F, kMy_WordClassOther },
+	{ 0xFE20, 0xFE2F, kMy_WordClassExtend },			// combining half marks
+	{ 0xFE30, 0xFE32, kMy_WordClassOther },				// CJK compatibility forms...
+	{ 0xFE33, 0xFE34, kMy_WordClassExtendNumberLetter },
+	{ 0xFE35, 0xFE4C, kMy_WordClassOther },
+	{ 0xFE4D, 0xFE4F, kMy_WordClassExtendNumberLetter },
+	{ 0xFE50, 0xFE50, kMy_WordClassMidNumber },			// small form variants...
+	{ 0xFE51, 0xFE51, kMy_WordClassOther },
+	{ 0xFE52, 0xFE52, kMy_WordClassMidNumberLetter },
+	{ 0xFE53, 0xFE53, kMy_WordClassOther },
+	{ 0xFE54, 0xFE54, kMy_WordClassMidNumber },
+	{ 0xFE55, 0xFE55, kMy_WordClassMidLetter },
+	{ 0xFE56, 0xFE6F, kMy_WordClassOther },
+	{ 0xFEFF, 0xFEFF, kMy_WordClassExtend },			// zero-width no-break space
+	{ 0xFF00, 0xFF06, kMy_WordClassOther },				// fullwidth forms...
+	{ 0xFF07, 0xFF07, kMy_WordClassMidNumberLetter },
+	{ 0xFF08, 0xFF0B, kMy_WordClassOther },
+	{ 0xFF0C, 0xFF0C, kMy_WordClassMidNumber },
+	{ 0xFF0D, 0xFF0D, kMy_WordClassOther },
+	{ 0xFF0E, 0xFF0E, kMy_WordClassMidNumberLetter },
+	{ 0xFF0F, 0xFF0F, kMy_WordClassOther },
+	{ 0xFF10, 0xFF19, kMy_WordClassNumeric },
+	{ 0xFF1A, 0xFF1A, kMy_WordClassMidLetter },
+	{ 0xFF1B, 0xFF1B, kMy_WordClassMidNumber },
+	{ 0xFF1C, 0xFF20, kMy_WordClassOther },
+	{ 0xFF3B, 0xFF3E, kMy_WordClassOther },
+	{ 0xFF3F, 0xFF3F, kMy_WordClassExtendNumberLetter },
+	{ 0xFF40, 0xFF40, kMy_WordClassOther },
+	{ 0xFF5B, 0xFF65, kMy_WordClassOther },
+	{ 0xFF66, 0xFF9D, kMy_WordClassKatakana },			// halfwidth Katakana
+	{ 0xFF9E, 0xFF9F, kMy_WordClassExtend },			// halfwidth sound marks
+	{ 0xFFE0, 0xFFFF, kMy_WordClassOther },				// fullwidth symbols, specials
+};
+
+My_ClassifierPtr	gSharedClassifierPtr = nullptr;		//!< see WordBoundary_ReturnSharedClassifier()
+
+} // anonymous namespace
+
+
+
+#pragma mark Public Methods
+
+/*!
+A unit test for this module.  This should always
+be run before a release, after any substantial
+changes are made, or if you suspect bugs!  It
+should also be EXPANDED as new functionality is
+proposed (ideally, a test is written before the
+functionality is added).
+
+(2021.06)
+*/
+void
+WordBoundary_RunTests ()
+{
+	UInt16		totalTests = 0;
+	UInt16		failedTests = 0;
+	
+	
+	++totalTests; if (false == unitTest000_Begin()) ++failedTests;
+	++totalTests; if (false == unitTest001_Begin()) ++failedTests;
+	
+	Console_WriteUnitTestReport("Word Boundary", failedTests, totalTests);
+}// RunTests
+
+
+/*!
+Destroys a classifier created with WordBoundary_NewClassifier(),
+and sets your copy of the reference to nullptr.
+
+(2021.06)
+*/
+void
+WordBoundary_DisposeClassifier	(WordBoundary_ClassifierRef*	inoutRefPtr)
+{
+	if (nullptr != inoutRefPtr)
+	{
+		delete REINTERPRET_CAST(*inoutRefPtr, My_ClassifierPtr);
+		*inoutRefPtr = nullptr;
+	}
+}// DisposeClassifier
+
+
+/*!
+Finds the word that includes the character at the given
+index, and returns its range.  If the character is a space,
+the range includes all the spaces around it; if it is not
+part of any word (such as most punctuation), the range is
+just that character (and any combining marks after it).
+
+Words are found by applying the rules of Unicode Standard
+Annex #29 in both directions from the index, so the cost
+depends on the length of the word and not the length of
+the text.
+
+(2021.06)
+*/
+Boolean
+WordBoundary_FindWord	(WordBoundary_ClassifierRef		inClassifier,
+						 UniChar const*					inText,
+						 UInt16							inLength,
+						 UInt16							inIndex,
+						 UInt16&						outStartIndex,
+						 UInt16&						outPastTheEndIndex)
+{
+	My_ClassifierConstPtr	ptr = REINTERPRET_CAST(inClassifier, My_ClassifierConstPtr);
+	Boolean					result = false;
+	
+	
+	outStartIndex = inIndex;
+	outPastTheEndIndex = inIndex;
+	if ((nullptr != ptr) && (nullptr != inText) && (inIndex < inLength))
+	{
+		UInt16		startIndex = returnClusterStart(ptr, inText, inIndex);
+		UInt16		pastTheEndIndex = returnClusterEnd(ptr, inText, inLength, startIndex);
+		
+		
+		while ((startIndex > 0) && (false == isBreakBeforeCluster(ptr, inText, inLength, startIndex)))
+		{
+			startIndex = returnClusterStart(ptr, inText, startIndex - 1);
+		}
+		while ((pastTheEndIndex < inLength) && (false == isBreakBeforeCluster(ptr, inText, inLength, pastTheEndIndex)))
+		{
+			pastTheEndIndex = returnClusterEnd(ptr, inText, inLength, pastTheEndIndex);
+		}
+		outStartIndex = startIndex;
+		outPastTheEndIndex = pastTheEndIndex;
+		result = true;
+	}
+	return result;
+}// FindWord
+
+
+/*!
+Creates a classifier for finding words.  Any characters in
+the given string are word characters, which join adjacent
+words and each other (for instance, if "/" and "." are
+word characters then "/usr/lib/a.out" is a single word).
+Dispose of the classifier with WordBoundary_DisposeClassifier().
+
+Returns nullptr if the classifier cannot be created.
+
+(2021.06)
+*/
+WordBoundary_ClassifierRef
+WordBoundary_NewClassifier	(CFStringRef	inWordCharacters)
+{
+	WordBoundary_ClassifierRef	result = nullptr;
+	
+	
+	try
+	{
+		result = REINTERPRET_CAST(new My_Classifier(inWordCharacters), WordBoundary_ClassifierRef);
+	}
+	catch (std::bad_alloc)
+	{
+		result = nullptr;
+	}
+	return result;
+}// NewClassifier
+
+
+/*!
+Returns the classifier that terminal views use to find the
+words that the user double-clicks.  Initially, its word
+characters keep paths and command-line options together
+(they are "-+/\~_"); this can be changed with
+WordBoundary_SetSharedWordCharacters().
+
+Do not dispose of the classifier, and do not keep it (it is
+replaced when its word characters change).
+
+(2021.06)
+*/
+WordBoundary_ClassifierRef
+WordBoundary_ReturnSharedClassifier ()
+{
+	if (nullptr == gSharedClassifierPtr)
+	{
+		CFStringRef		wordCharacters = CFStringCreateWithCString(kCFAllocatorDefault, kMy_DefaultWordCharacters, kCFStringEncodingASCII);
+		
+		
+		gSharedClassifierPtr = REINTERPRET_CAST(WordBoundary_NewClassifier(wordCharacters), My_ClassifierPtr);
+		if (nullptr != wordCharacters)
+		{
+			CFRelease(wordCharacters), wordCharacters = nullptr;
+		}
+	}
+	return REINTERPRET_CAST(gSharedClassifierPtr, WordBoundary_ClassifierRef);
+}// ReturnSharedClassifier
+
+
+/*!
+Replaces the word characters of the classifier that terminal
+views use (see WordBoundary_ReturnSharedClassifier()).  This
+is how scripts customize what a double-click selects.
+
+(2021.06)
+*/
+Boolean
+WordBoundary_SetSharedWordCharacters	(CFStringRef	inWordCharacters)
+{
+	WordBoundary_ClassifierRef	newClassifier = WordBoundary_NewClassifier(inWordCharacters);
+	Boolean						result = (nullptr != newClassifier);
+	
+	
+	if (result)
+	{
+		WordBoundary_ClassifierRef	oldClassifier = REINTERPRET_CAST(gSharedClassifierPtr, WordBoundary_ClassifierRef);
+		
+		
+		gSharedClassifierPtr = REINTERPRET_CAST(newClassifier, My_ClassifierPtr);
+		WordBoundary_DisposeClassifier(&oldClassifier);
+	}
+	return result;
+}// SetSharedWordCharacters
+
+
+#pragma mark Internal Methods
+namespace {
+
+/*!
+Creates a classifier with the given word characters (which
+may be nullptr).
+
+(2021.06)
+*/
+My_Classifier::
+My_Classifier	(CFStringRef	inWordCharacters)
+:
+asciiClasses(),
+otherWordCharacters()
+{
+	for (UniChar i = 0; i < asciiClasses.size(); ++i)
+	{
+		asciiClasses[i] = returnASCIIClass(i);
+	}
+	
+	if (nullptr != inWordCharacters)
+	{
+		CFIndex const	kLength = CFStringGetLength(inWordCharacters);
+		
+		
+		for (CFIndex i = 0; i < kLength; ++i)
+		{
+			UniChar const	kCharacter = CFStringGetCharacterAtIndex(inWordCharacters, i);
+			
+			
+			if (kCharacter < asciiClasses.size())
+			{
+				asciiClasses[kCharacter] = kMy_WordClassExtendNumberLetter;
+			}
+			else
+			{
+				otherWordCharacters.push_back(kCharacter);
+			}
+		}
+		std::sort(otherWordCharacters.begin(), otherWordCharacters.end());
+	}
+}// My_Classifier constructor
+
+
+/*!
+Returns the class of the given character, including word
+characters.
+
+(2021.06)
+*/
+My_WordClass
+My_Classifier::
+returnClass		(UniChar	inCharacter)
+const
+{
+	My_WordClass	result = kMy_WordClassOther;
+	
+	
+	if (inCharacter < asciiClasses.size())
+	{
+		result = asciiClasses[inCharacter];
+	}
+	else if ((false == otherWordCharacters.empty()) &&
+				std::binary_search(otherWordCharacters.begin(), otherWordCharacters.end(), inCharacter))
+	{
+		result = kMy_WordClassExtendNumberLetter;
+	}
+	else
+	{
+		result = returnNonASCIIClass(inCharacter);
+	}
+	return result;
+}// My_Classifier::returnClass
+
+
+/*!
+Returns true if there is a word boundary before the cluster
+that starts at the given index (which must be inside the
+text, and not 0).  A cluster is a character and any marks
+after it, which are never separated (rule WB4); its class
+is the class of its first character.
+
+(2021.06)
+*/
+Boolean
+isBreakBeforeCluster	(My_ClassifierConstPtr	inClassifierPtr,
+						 UniChar const*			inText,
+						 UInt16					inLength,
+						 UInt16					inClusterStart)
+{
+	UInt16 const	kBeforeStart = returnClusterStart(inClassifierPtr, inText, inClusterStart - 1);
+	UInt16 const	kAfterEnd = returnClusterEnd(inClassifierPtr, inText, inLength, inClusterStart);
+	My_WordClass	twoBefore = kMy_WordClassOther;
+	My_WordClass	twoAfter = kMy_WordClassOther;
+	
+	
+	if (kBeforeStart > 0)
+	{
+		twoBefore = inClassifierPtr->returnClass(inText[returnClusterStart(inClassifierPtr, inText, kBeforeStart - 1)]);
+	}
+	if (kAfterEnd < inLength)
+	{
+		twoAfter = inClassifierPtr->returnClass(inText[kAfterEnd]);
+	}
+	return isBreakBetween(twoBefore, inClassifierPtr->returnClass(inText[kBeforeStart]),
+							inClassifierPtr->returnClass(inText[inClusterStart]), twoAfter);
+}// isBreakBeforeCluster
+
+
+/*!
+Returns true if the rules of Unicode Standard Annex #29
+put a word boundary between clusters of the given classes
+(the middle two); the outer classes are those of the
+clusters beside them, or “other” at the ends of the text.
+
+The rules for regional indicators, emoji sequences and
+Hebrew letters are not used.
+
+(2021.06)
+*/
+Boolean
+isBreakBetween	(My_WordClass	inTwoBefore,
+				 My_WordClass	inBefore,
+				 My_WordClass	inAfter,
+				 My_WordClass	inTwoAfter)
+{
+	Boolean				result = true;
+	
+	
+	if ((kMy_WordClassSpace == inBefore) && (kMy_WordClassSpace == inAfter))
+	{
+		// WB3, WB3d: spaces (and new-lines) stay together
+		result = false;
+	}
+	else if (isLetterOrNumber(inBefore) && isLetterOrNumber(inAfter))
+	{
+		// WB5, WB8, WB9, WB10: letters and digits
+		result = false;
+	}
+	else if ((kMy_WordClassLetter == inBefore) && (kMy_WordClassLetter == inTwoAfter) &&
+				((kMy_WordClassMidLetter == inAfter) || (kMy_WordClassMidNumberLetter == inAfter)))
+	{
+		// WB6: letter × (MidLetter | MidNumLet) letter
+		result = false;
+	}
+	else if ((kMy_WordClassLetter == inTwoBefore) && (kMy_WordClassLetter == inAfter) &&
+				((kMy_WordClassMidLetter == inBefore) || (kMy_WordClassMidNumberLetter == inBefore)))
+	{
+		// WB7: letter (MidLetter | MidNumLet) × letter
+		result = false;
+	}
+	else if ((kMy_WordClassNumeric == inBefore) && (kMy_WordClassNumeric == inTwoAfter) &&
+				((kMy_WordClassMidNumber == inAfter) || (kMy_WordClassMidNumberLetter == inAfter)))
+	{
+		// WB12: digit × (MidNum | MidNumLet) digit
+		result = false;
+	}
+	else if ((kMy_WordClassNumeric == inTwoBefore) && (kMy_WordClassNumeric == inAfter) &&
+				((kMy_WordClassMidNumber == inBefore) || (kMy_WordClassMidNumberLetter == inBefore)))
+	{
+		// WB11: digit (MidNum | MidNumLet) × digit
+		result = false;
+	}
+	else if ((kMy_WordClassKatakana == inBefore) && (kMy_WordClassKatakana == inAfter))
+	{
+		// WB13: Katakana
+		result = false;
+	}
+	else if ((kMy_WordClassExtendNumberLetter == inAfter) &&
+				(isLetterOrNumber(inBefore) || (kMy_WordClassKatakana == inBefore) || (kMy_WordClassExtendNumberLetter == inBefore)))
+	{
+		// WB13a: joiners after anything in a word
+		result = false;
+	}
+	else if ((kMy_WordClassExtendNumberLetter == inBefore) &&
+				(isLetterOrNumber(inAfter) || (kMy_WordClassKatakana == inAfter)))
+	{
+		// WB13b: anything in a word after joiners
+		result = false;
+	}
+	return result;
+}// isBreakBetween
+
+
+/*!
+Returns true for letters and digits, which the rules
+usually treat the same way.
+
+(2021.06)
+*/
+inline Boolean
+isLetterOrNumber	(My_WordClass	inClass)
+{
+	return ((kMy_WordClassLetter == inClass) || (kMy_WordClassNumeric == inClass));
+}// isLetterOrNumber
+
+
+/*!
+Returns the class of an ASCII character, before any word
+characters are applied.  Null characters are spaces, since
+terminal cells that were never written may contain them.
+
+(2021.06)
+*/
+My_WordClass
+returnASCIIClass	(UniChar	inCharacter)
+{
+	My_WordClass	result = kMy_WordClassOther;
+	
+	
+	if (((inCharacter >= 'A') && (inCharacter <= 'Z')) || ((inCharacter >= 'a') && (inCharacter <= 'z')))
+	{
+		result = kMy_WordClassLetter;
+	}
+	else if ((inCharacter >= '0') && (inCharacter <= '9'))
+	{
+		result = kMy_WordClassNumeric;
+	}
+	else
+	{
+		switch (inCharacter)
+		{
+		case '\0':
+		case '\t':
+		case '\n':
+		case '\v':
+		case '\f':
+		case '\r':
+		case ' ':
+			result = kMy_WordClassSpace;
+			break;
+		
+		case ':':
+			result = kMy_WordClassMidLetter;
+			break;
+		
+		case ',':
+		case ';':
+			result = kMy_WordClassMidNumber;
+			break;
+		
+		case '.':
+		case '\'':
+			result = kMy_WordClassMidNumberLetter;
+			break;
+		
+		case '_':
+			result = kMy_WordClassExtendNumberLetter;
+			break;
+		
+		default:
+			// other punctuation and control characters
+			result = kMy_WordClassOther;
+			break;
+		}
+	}
+	return result;
+}// returnASCIIClass
+
+
+/*!
+Returns the index after the cluster that starts at the
+given index (the next character that is not a mark).
+
+(2021.06)
+*/
+UInt16
+returnClusterEnd	(My_ClassifierConstPtr	inClassifierPtr,
+					 UniChar const*			inText,
+					 UInt16					inLength,
+					 UInt16					inClusterStart)
+{
+	UInt16		result = inClusterStart + 1;
+	
+	
+	while ((result < inLength) && (kMy_WordClassExtend == inClassifierPtr->returnClass(inText[result])))
+	{
+		++result;
+	}
+	return result;
+}// returnClusterEnd
+
+
+/*!
+Returns the index of the start of the cluster that includes
+the given index (the nearest character at or before it that
+is not a mark, or 0).
+
+(2021.06)
+*/
+UInt16
+returnClusterStart	(My_ClassifierConstPtr	inClassifierPtr,
+					 UniChar const*			inText,
+					 UInt16					inIndex)
+{
+	UInt16		result = inIndex;
+	
+	
+	while ((result > 0) && (kMy_WordClassExtend == inClassifierPtr->returnClass(inText[result])))
+	{
+		--result;
+	}
+	return result;
+}// returnClusterStart
+
+
+/*!
+Returns the class of a character that is not ASCII, using
+the table of ranges (which is searched by halves).
+
+(2021.06)
+*/
+My_WordClass
+returnNonASCIIClass		(UniChar	inCharacter)
+{
+	My_WordClass	result = kMy_WordClassLetter;
+	auto const		kPastEnd = gNonASCIIClassRanges + (sizeof(gNonASCIIClassRanges) / sizeof(My_WordClassRange));
+	auto const		toRange = std::lower_bound(gNonASCIIClassRanges, kPastEnd, inCharacter,
+												[] (My_WordClassRange const& inRange, UniChar inValue) { return (inRange.last < inValue); });
+	
+	
+	if ((kPastEnd != toRange) && (toRange->first <= inCharacter))
+	{
+		result = toRange->wordClass;
+	}
+	return result;
+}// returnNonASCIIClass
+
+
+/*!
+Finds the word at the given index of the given UTF-8 text
+and returns it, for tests.  Each non-ASCII character must
+be written as one UTF-16 unit in the text: since this is
+only for tests, the text is converted by Core Foundation.
+
+(2021.06)
+*/
+std::string
+returnTestWord	(WordBoundary_ClassifierRef		inClassifier,
+				 char const*					inTextUTF8,
+				 UInt16							inIndex)
+{
+	CFStringRef				textCFString = CFStringCreateWithCString(kCFAllocatorDefault, inTextUTF8, kCFStringEncodingUTF8);
+	std::vector< UniChar >	text(CFStringGetLength(textCFString));
+	UInt16					startIndex = 0;
+	UInt16					pastTheEndIndex = 0;
+	std::string				result;
+	
+	
+	CFStringGetCharacters(textCFString, CFRangeMake(0, text.size()), text.data());
+	if (WordBoundary_FindWord(inClassifier, text.data(), STATIC_CAST(text.size(), UInt16), inIndex, startIndex, pastTheEndIndex))
+	{
+		CFStringRef		wordCFString = CFStringCreateWithCharacters(kCFAllocatorDefault, text.data() + startIndex, pastTheEndIndex - startIndex);
+		char			buffer[256];
+		
+		
+		if (CFStringGetCString(wordCFString, buffer, sizeof(buffer), kCFStringEncodingUTF8))
+		{
+			result = buffer;
+		}
+		CFRelease(wordCFString), wordCFString = nullptr;
+	}
+	else
+	{
+		result = "(none)";
+	}
+	CFRelease(textCFString), textCFString = nullptr;
+	return result;
+}// returnTestWord
+
+
+/*!
+Tests the Unicode rules without word characters: letters,
+digits, separators inside words, spaces, Katakana,
+ideographs and combining marks.
+
+Returns "true" if ALL assertions pass; "false" is
+returned if any fail, however messages should be
+printed for ALL assertion failures regardless.
+
+(2021.06)
+*/
+Boolean
+unitTest000_Begin ()
+{
+	WordBoundary_ClassifierRef	classifier = WordBoundary_NewClassifier(nullptr);
+	std::string					word;
+	Boolean						result = true;
+	
+	
+	Console_TestAssertUpdate(result, nullptr != classifier, Console_WriteLine, "classifier was not created");
+	
+	word = returnTestWord(classifier, "this is a sentence", 0);
+	Console_TestAssertUpdate(result, "this" == word, Console_WriteValueStdString, "first word", word);
+	word = returnTestWord(classifier, "this is a sentence", 3);
+	Console_TestAssertUpdate(result, "this" == word, Console_WriteValueStdString, "end of first word", word);
+	word = returnTestWord(classifier, "this is a sentence", 17);
+	Console_TestAssertUpdate(result, "sentence" == word, Console_WriteValueStdString, "last word", word);
+	word = returnTestWord(classifier, "  well   spaced  ", 7);
+	Console_TestAssertUpdate(result, "   " == word, Console_WriteValueStdString, "spaces", word);
+	word = returnTestWord(classifier, "\"quoted\" (text) [x1]", 3);
+	Console_TestAssertUpdate(result, "quoted" == word, Console_WriteValueStdString, "quotation marks", word);
+	word = returnTestWord(classifier, "\"quoted\" (text) [x1]", 11);
+	Console_TestAssertUpdate(result, "text" == word, Console_WriteValueStdString, "parentheses", word);
+	word = returnTestWord(classifier, "\"quoted\" (text) [x1]", 18);
+	Console_TestAssertUpdate(result, "x1" == word, Console_WriteValueStdString, "letters and digits", word);
+	word = returnTestWord(classifier, "\"quoted\" (text) [x1]", 9);
+	Console_TestAssertUpdate(result, "(" == word, Console_WriteValueStdString, "punctuation alone", word);
+	word = returnTestWord(classifier, "I can't.", 4);
+	Console_TestAssertUpdate(result, "can't" == word, Console_WriteValueStdString, "apostrophe", word);
+	word = returnTestWord(classifier, "file.txt: 3.14, 1,000.", 0);
+	Console_TestAssertUpdate(result, "file.txt" == word, Console_WriteValueStdString, "period between letters", word);
+	word = returnTestWord(classifier, "file.txt: 3.14, 1,000.", 11);
+	Console_TestAssertUpdate(result, "3.14" == word, Console_WriteValueStdString, "decimal number", word);
+	word = returnTestWord(classifier, "file.txt: 3.14, 1,000.", 20);
+	Console_TestAssertUpdate(result, "1,000" == word, Console_WriteValueStdString, "thousands", word);
+	word = returnTestWord(classifier, "a:b a::b", 1);
+	Console_TestAssertUpdate(result, "a:b" == word, Console_WriteValueStdString, "colon between letters", word);
+	word = returnTestWord(classifier, "a:b a::b", 4);
+	Console_TestAssertUpdate(result, "a" == word, Console_WriteValueStdString, "two colons", word);
+	word = returnTestWord(classifier, "snake_case_name", 7);
+	Console_TestAssertUpdate(result, "snake_case_name" == word, Console_WriteValueStdString, "underscores", word);
+	word = returnTestWord(classifier, "caf\xC3\xA9 cafe\xCC\x81s", 7);
+	Console_TestAssertUpdate(result, "cafe\xCC\x81s" == word, Console_WriteValueStdString, "combining mark", word);
+	word = returnTestWord(classifier, "\xE3\x82\xAB\xE3\x82\xBF\xE3\x82\xAB\xE3\x83\x8A\xE6\xBC\xA2\xE5\xAD\x97", 1);
+	Console_TestAssertUpdate(result, "\xE3\x82\xAB\xE3\x82\xBF\xE3\x82\xAB\xE3\x83\x8A" == word, Console_WriteValueStdString, "Katakana", word);
+	word = returnTestWord(classifier, "\xE3\x82\xAB\xE3\x82\xBF\xE3\x82\xAB\xE3\x83\x8A\xE6\xBC\xA2\xE5\xAD\x97", 5);
+	Console_TestAssertUpdate(result, "\xE5\xAD\x97" == word, Console_WriteValueStdString, "ideograph", word);
+	word = returnTestWord(classifier, "x", 1);
+	Console_TestAssertUpdate(result, "(none)" == word, Console_WriteValueStdString, "index past the end", word);
+	
+	WordBoundary_DisposeClassifier(&classifier);
+	Console_TestAssertUpdate(result, nullptr == classifier, Console_WriteLine, "classifier was not cleared");
+	
+	return result;
+}// unitTest000_Begin
+
+
+/*!
+Tests word characters, and the shared classifier.
+
+Returns "true" if ALL assertions pass; "false" is
+returned if any fail, however messages should be
+printed for ALL assertion failures regardless.
+
+(2021.06)
+*/
+Boolean
+unitTest001_Begin ()
+{
+	WordBoundary_ClassifierRef	classifier = WordBoundary_ReturnSharedClassifier();
+	std::string					word;
+	Boolean						result = true;
+	
+	
+	word = returnTestWord(classifier, "ls ~/src/a.out --all-files", 8);
+	Console_TestAssertUpdate(result, "~/src/a.out" == word, Console_WriteValueStdString, "path", word);
+	word = returnTestWord(classifier, "ls ~/src/a.out --all-files", 16);
+	Console_TestAssertUpdate(result, "--all-files" == word, Console_WriteValueStdString, "option", word);
+	word = returnTestWord(classifier, "(see /etc/hosts).", 10);
+	Console_TestAssertUpdate(result, "/etc/hosts" == word, Console_WriteValueStdString, "path in a sentence", word);
+	word = returnTestWord(classifier, "a+b=c", 0);
+	Console_TestAssertUpdate(result, "a+b" == word, Console_WriteValueStdString, "default word characters", word);
+	
+	{
+		CFStringRef		wordCharacters = CFStringCreateWithCString(kCFAllocatorDefault, "=\xE2\x80\xA2", kCFStringEncodingUTF8);
+		
+		
+		Console_TestAssertUpdate(result, WordBoundary_SetSharedWordCharacters(wordCharacters), Console_WriteLine, "word characters were not changed");
+		classifier = WordBoundary_ReturnSharedClassifier();
+		word = returnTestWord(classifier, "a+b=c", 4);
+		Console_TestAssertUpdate(result, "b=c" == word, Console_WriteValueStdString, "new word characters", word);
+		word = returnTestWord(classifier, "a\xE2\x80\xA2" "b /x", 0);
+		Console_TestAssertUpdate(result, "a\xE2\x80\xA2" "b" == word, Console_WriteValueStdString, "non-ASCII word character", word);
+		word = returnTestWord(classifier, "a\xE2\x80\xA2" "b /x", 4);
+		Console_TestAssertUpdate(result, "/" == word, Console_WriteValueStdString, "no longer a word character", word);
+		CFRelease(wordCharacters), wordCharacters = nullptr;
+	}
+	
+	{
+		CFStringRef		wordCharacters = CFStringCreateWithCString(kCFAllocatorDefault, kMy_DefaultWordCharacters, kCFStringEncodingASCII);
+		
+		
+		UNUSED_RETURN(Boolean)WordBoundary_SetSharedWordCharacters(wordCharacters);
+		CFRelease(wordCharacters), wordCharacters = nullptr;
+	}
+	
+	return result;
+}// unitTest001_Begin
+
+} // anonymous namespace
+
+// BELOW IS REQUIRED NEWLINE TO END FILE
@@ -0,0 +1,117 @@
+/*!	\file WordBoundary.h
+	\brief Finds the word around a character in terminal text,
+	such as the word that the user double-clicked.
+	
+	Words follow the word-boundary rules of Unicode Standard
+	Annex #29: letters and digits form words, as do runs of
+	Katakana; ideographs are words by themselves; combining
+	marks stay with the character before them; and a period
+	or apostrophe between letters (as in "can't") or a comma
+	between digits (as in "1,000") does not end the word.  A
+	run of spaces is also treated as one word, so that spaces
+	can be selected too.
+	
+	Other characters end words unless a classifier is told
+	that they are word characters.  Word characters join any
+	adjacent words and each other, so (for instance) if "/"
+	is a word character then a whole file path is one word.
+	
+	Text is given in UniChar units, which the terminal also
+	uses for cells; ranges are indices into the text.  The
+	Unicode properties are approximated by tables of common
+	ranges, so that no character database is required.
+*/
+/*###############################################################
+
+	MacTerm
+		© 1998-2021 by Kevin Grant.
+		© 2001-2003 by Ian Anderson.
+		© 1986-1994 University of Illinois Board of Trustees
+		(see About box for full list of U of I contributors).
+	
+	This program is free software; you can redistribute it or
+	modify it under the terms of the GNU General Public License
+	as published by the Free Software Foundation; either version
+	2 of the License, or (at your option) any later version.
+	
+	This program is distributed in the hope that it will be
+	useful, but WITHOUT ANY WARRANTY; without even the implied
+	warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+	PURPOSE.  See the GNU General Public License for more
+	details.
+	
+	You should have received a copy of the GNU General Public
+	License along with this program; if not, write to:
+	
+		Free Software Foundation, Inc.
+		59 Temple Place, Suite 330
+		Boston, MA  02111-1307
+		USA
+
+###############################################################*/
+
+#include <UniversalDefines.h>
+
+#pragma once
+
+// Mac includes
+#include <CoreServices/CoreServices.h>
+
+
+
+#pragma mark Types
+
+typedef struct WordBoundary_OpaqueClassifier*	WordBoundary_ClassifierRef;
+
+
+
+#pragma mark Public Methods
+
+//!\name Module Tests
+//@{
+
+void
+	WordBoundary_RunTests					();
+
+//@}
+
+//!\name Creating and Destroying Classifiers
+//@{
+
+// THE STRING MAY BE nullptr OR EMPTY, FOR STRICT UNICODE WORDS
+WordBoundary_ClassifierRef
+	WordBoundary_NewClassifier				(CFStringRef					inWordCharacters);
+
+void
+	WordBoundary_DisposeClassifier			(WordBoundary_ClassifierRef*	inoutRefPtr);
+
+//@}
+
+//!\name Finding Words
+//@{
+
+// RETURNS false ONLY IF THE INDEX IS NOT IN THE TEXT
+Boolean
+	WordBoundary_FindWord					(WordBoundary_ClassifierRef		inClassifier,
+											 UniChar const*					inText,
+											 UInt16							inLength,
+											 UInt16							inIndex,
+											 UInt16&						outStartIndex,
+											 UInt16&						outPastTheEndIndex);
+
+//@}
+
+//!\name Shared Classifier
+//@{
+
+// THE CLASSIFIER THAT TERMINAL VIEWS USE; DO NOT DISPOSE
+WordBoundary_ClassifierRef
+	WordBoundary_ReturnSharedClassifier		();
+
+// RETURNS false (AND KEEPS THE OLD CLASSIFIER) IF A NEW ONE CANNOT BE CREATED
+Boolean
+	WordBoundary_SetSharedWordCharacters	(CFStringRef					inWordCharacters);
+
+//@}
+
+// BELOW IS REQUIRED NEWLINE TO END FILE
@@ -272,11 +272,16 @@ if __name__ == "__main__":
     # if desired, override what string is sent after keep-alive timers expire
     #Session.set_keep_alive_transmission(".")
 
-    try:
-        Terminal.on_seekword_call(pymacterm.term_text.find_word)
-    except Exception as _:
-        warn("Warning, exception while trying to register word finder for",
-             "double clicks:", _)
+    # double-clicked words are found by MacTerm itself; if desired, change
+    # which characters (besides letters and digits) are part of words...
+    #Terminal.set_word_characters("-+/\\~_.")
+    # ...or replace the word finder entirely with a Python function (this
+    # is much slower, as every double-click calls into Python)
+    #try:
+    #    Terminal.on_seekword_call(pymacterm.term_text.find_word)
+    #except Exception as _:
+    #    warn("Warning, exception while trying to register word finder for",
+    #         "double clicks:", _)
 
     for i in range(0, 256):
         try:
@@ -0,0 +1,1337 @@
+/*!	\file CoreFoundationShim.cp
+	\brief Implements the portable stand-in for Core Foundation
+	(see "Portable/Include/CoreFoundation/CoreFoundation.h").
+*/
+/*###############################################################
+
+	Data Access Library
+	© 1998-2021 by Kevin Grant
+	
+	This library is free software; you can redistribute it or
+	modify it under the terms of the GNU Lesser Public License
+	as published by the Free Software Foundation; either version
+	2.1 of the License, or (at your option) any later version.
+	
+	This program is distributed in the hope that it will be
+	useful, but WITHOUT ANY WARRANTY; without even the implied
+	warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+	PURPOSE.  See the GNU Lesser Public License for details.
+	
+	You should have received a copy of the GNU Lesser Public
+	License along with this library; if not, write to:
+	
+		Free Software Foundation, Inc.
+		59 Temple Place, Suite 330
+		Boston, MA  02111-1307
+		USA
+
+###############################################################*/
+
+#include <CoreFoundation/CoreFoundation.h>
+#include <UniversalDefines.h>
+
+// standard-C includes
+#include <cstdlib>
+#include <cstring>
+
+// standard-C++ includes
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+
+
+#pragma mark Constants
+namespace {
+
+enum My_TypeID : CFTypeID
+{
+	kMy_TypeIDString		= 7,
+	kMy_TypeIDArray			= 19,
+	kMy_TypeIDError			= 46,
+	kMy_TypeIDUnavailable	= 1000	// types that are declared but never created
+};
+
+CFAbsoluteTime const	kMy_UnixTimeAtReferenceDate = 978307200.0; // seconds from 1970 to 2001
+
+} // anonymous namespace
+
+#pragma mark Types
+
+/*!
+Allocators only serve as distinct markers; all memory is
+managed by the standard library.
+*/
+struct __CFAllocator
+{
+	char const*		name;	//!< for debugging
+};
+
+/*!
+The base of every object, holding the reference count.
+*/
+struct __CFObject
+{
+	explicit
+	__CFObject	(CFTypeID	inTypeID)
+	: typeID(inTypeID), retainCount(1), isConstant(false)
+	{
+	}
+	
+	virtual
+	~__CFObject ()
+	{
+	}
+	
+	virtual CFHashCode
+	hash () const
+	{
+		return REINTERPRET_CAST(this, CFHashCode);
+	}
+	
+	virtual Boolean
+	isEqual		(__CFObject const*	inOther) const
+	{
+		return (this == inOther);
+	}
+	
+	CFTypeID				typeID;			//!< a "kMy_TypeID..." constant
+	std::atomic< long >		retainCount;	//!< object is deleted when this reaches zero
+	Boolean					isConstant;		//!< if true, created by CFSTR() and never deleted
+};
+
+/*!
+A string of UTF-16 code units.  The storage may belong to
+the caller (see "CFStringCreateMutableWithExternalCharactersNoCopy()"),
+in which case it is read and changed in place as long as
+the capacity allows.
+*/
+struct __CFString : public __CFObject
+{
+	__CFString ()
+	: __CFObject(kMy_TypeIDString), characters(nullptr), length(0), capacity(0),
+		deallocator(kCFAllocatorMalloc), cString(nullptr), isMutable(false)
+	{
+	}
+	
+	~__CFString ()
+	{
+		if (kCFAllocatorNull != deallocator)
+		{
+			std::free(characters);
+		}
+	}
+	
+	CFHashCode
+	hash () const override
+	{
+		CFHashCode	result = STATIC_CAST(length, CFHashCode);
+		
+		
+		for (CFIndex i = 0; i < length; ++i)
+		{
+			result = (result * 31) + characters[i];
+		}
+		return result;
+	}
+	
+	Boolean
+	isEqual		(__CFObject const*	inOther) const override
+	{
+		__CFString const*	otherString = STATIC_CAST(inOther, __CFString const*);
+		
+		
+		return ((length == otherString->length) &&
+				std::equal(characters, characters + length, otherString->characters));
+	}
+	
+	void
+	reserve		(CFIndex	inMinimumCapacity)
+	{
+		if (inMinimumCapacity > capacity)
+		{
+			CFIndex const	kNewCapacity = std::max(inMinimumCapacity, 2 * capacity);
+			
+			
+			if (kCFAllocatorNull == deallocator)
+			{
+				// the caller cannot reallocate storage; switch to a private copy
+				UniChar*	newCharacters = REINTERPRET_CAST(std::malloc(kNewCapacity * sizeof(UniChar)), UniChar*);
+				
+				
+				std::copy(characters, characters + length, newCharacters);
+				characters = newCharacters;
+				deallocator = kCFAllocatorMalloc;
+			}
+			else
+			{
+				characters = REINTERPRET_CAST(std::realloc(characters, kNewCapacity * sizeof(UniChar)), UniChar*);
+			}
+			capacity = kNewCapacity;
+		}
+	}
+	
+	void
+	replace		(CFRange			inRange,
+				 UniChar const*		inNewCharacters,
+				 CFIndex			inNewLength)
+	{
+		CFIndex const	kNewTotalLength = length - inRange.length + inNewLength;
+		
+		
+		// copy first in case the new characters are part of this string
+		std::vector< UniChar >	newCharacters(inNewCharacters, inNewCharacters + inNewLength);
+		
+		
+		reserve(kNewTotalLength);
+		std::copy(characters + inRange.location + inRange.length, characters + length,
+					characters + inRange.location + inNewLength);
+		std::copy(newCharacters.begin(), newCharacters.end(), characters + inRange.location);
+		length = kNewTotalLength;
+	}
+	
+	UniChar*			characters;		//!< UTF-16 code units (not terminated)
+	CFIndex				length;			//!< number of code units in use
+	CFIndex				capacity;		//!< number of code units allocated
+	CFAllocatorRef		deallocator;	//!< "kCFAllocatorMalloc" to free and grow storage, or "kCFAllocatorNull"
+	char const*			cString;		//!< for constant strings, the original literal
+	Boolean				isMutable;		//!< for debugging
+};
+
+/*!
+An ordered list of retained objects.
+*/
+struct __CFArray : public __CFObject
+{
+	__CFArray ()
+	: __CFObject(kMy_TypeIDArray), values()
+	{
+	}
+	
+	~__CFArray ()
+	{
+		for (auto	value : values)
+		{
+			CFRelease(value);
+		}
+	}
+	
+	std::vector< CFTypeRef >	values;		//!< each value is retained by the array
+};
+
+/*!
+Errors cannot be created by the portable modules, so
+this exists only so that the type is complete.
+*/
+struct __CFError : public __CFObject
+{
+	__CFError ()
+	: __CFObject(kMy_TypeIDError)
+	{
+	}
+};
+
+#pragma mark Internal Method Prototypes
+namespace {
+
+void					appendUTF16		(std::vector< UniChar >&, UInt32);
+__CFString*				newString		(UniChar const*, CFIndex);
+Boolean					decodeBytes		(UInt8 const*, CFIndex, CFStringEncoding, std::vector< UniChar >&);
+CFIndex					encodeString	(__CFString const*, CFRange, CFStringEncoding, UInt8, UInt8*, CFIndex, CFIndex*);
+__CFObject*				returnObject	(CFTypeRef);
+
+} // anonymous namespace
+
+#pragma mark Variables
+
+__CFAllocator				gAllocatorMalloc = { "kCFAllocatorMalloc" };
+__CFAllocator				gAllocatorNull = { "kCFAllocatorNull" };
+CFAllocatorRef const		kCFAllocatorDefault = nullptr;
+CFAllocatorRef const		kCFAllocatorMalloc = &gAllocatorMalloc;
+CFAllocatorRef const		kCFAllocatorNull = &gAllocatorNull;
+CFArrayCallBacks const		kCFTypeArrayCallBacks = { 0 };
+
+
+
+#pragma mark Public Methods
+
+/*!
+Returns the number of seconds since the reference date
+(the start of 2001, GMT), like the Mac version.
+
+(2021.06)
+*/
+CFAbsoluteTime
+CFAbsoluteTimeGetCurrent ()
+{
+	return (std::chrono::duration< CFAbsoluteTime >(std::chrono::system_clock::now().time_since_epoch()).count()
+			- kMy_UnixTimeAtReferenceDate);
+}// AbsoluteTimeGetCurrent
+
+
+/*!
+Appends a value to a mutable array, retaining it.
+
+(2021.06)
+*/
+void
+CFArrayAppendValue	(CFMutableArrayRef	inArray,
+					 void const*		inValue)
+{
+	inArray->values.push_back(CFRetain(inValue));
+}// ArrayAppendValue
+
+
+/*!
+Creates an empty array.  Only "kCFTypeArrayCallBacks" is
+supported.
+
+(2021.06)
+*/
+CFMutableArrayRef
+CFArrayCreateMutable	(CFAllocatorRef				UNUSED_ARGUMENT(inAllocator),
+						 CFIndex					UNUSED_ARGUMENT(inCapacity),
+						 CFArrayCallBacks const*	UNUSED_ARGUMENT(inCallBacks))
+{
+	return new __CFArray;
+}// ArrayCreateMutable
+
+
+/*!
+Returns the number of values in the array.
+
+(2021.06)
+*/
+CFIndex
+CFArrayGetCount		(CFArrayRef		inArray)
+{
+	return STATIC_CAST(inArray->values.size(), CFIndex);
+}// ArrayGetCount
+
+
+/*!
+Returns the value at the given index, without retaining it.
+
+(2021.06)
+*/
+void const*
+CFArrayGetValueAtIndex	(CFArrayRef		inArray,
+						 CFIndex		inIndex)
+{
+	return inArray->values.at(inIndex);
+}// ArrayGetValueAtIndex
+
+
+/*!
+Returns a new string naming the given type.
+
+(2021.06)
+*/
+CFStringRef
+CFCopyTypeIDDescription		(CFTypeID	inTypeID)
+{
+	char const*		typeName = "<unknown>";
+	
+	
+	switch (inTypeID)
+	{
+	case kMy_TypeIDString:
+		typeName = "CFString";
+		break;
+	
+	case kMy_TypeIDArray:
+		typeName = "CFArray";
+		break;
+	
+	case kMy_TypeIDError:
+		typeName = "CFError";
+		break;
+	
+	default:
+		break;
+	}
+	return CFStringCreateWithCString(kCFAllocatorDefault, typeName, kCFStringEncodingASCII);
+}// CopyTypeIDDescription
+
+
+/*!
+Returns true only if both objects have the same type and
+value.
+
+(2021.06)
+*/
+Boolean
+CFEqual		(CFTypeRef	inObject1,
+			 CFTypeRef	inObject2)
+{
+	__CFObject const*	object1 = returnObject(inObject1);
+	__CFObject const*	object2 = returnObject(inObject2);
+	
+	
+	return ((object1 == object2) ||
+			((object1->typeID == object2->typeID) && object1->isEqual(object2)));
+}// Equal
+
+
+/*!
+Returns a new string describing the error.
+
+(2021.06)
+*/
+CFStringRef
+CFErrorCopyDescription	(CFErrorRef		UNUSED_ARGUMENT(inError))
+{
+	return CFStringCreateWithCString(kCFAllocatorDefault, "unknown error", kCFStringEncodingASCII);
+}// ErrorCopyDescription
+
+
+/*!
+Returns the current reference count of an object.
+
+(2021.06)
+*/
+CFIndex
+CFGetRetainCount	(CFTypeRef	inObject)
+{
+	return returnObject(inObject)->retainCount.load();
+}// GetRetainCount
+
+
+/*!
+Returns the type of the given object, to compare with the
+result of a function such as CFStringGetTypeID().
+
+(2021.06)
+*/
+CFTypeID
+CFGetTypeID		(CFTypeRef	inObject)
+{
+	return returnObject(inObject)->typeID;
+}// GetTypeID
+
+
+/*!
+Returns a hash code that is the same for equal objects.
+
+(2021.06)
+*/
+CFHashCode
+CFHash	(CFTypeRef	inObject)
+{
+	return returnObject(inObject)->hash();
+}// Hash
+
+
+/*!
+Releases an object, deleting it when no references remain.
+Constant strings are never deleted.
+
+(2021.06)
+*/
+void
+CFRelease	(CFTypeRef	inObject)
+{
+	__CFObject*		object = returnObject(inObject);
+	
+	
+	if ((false == object->isConstant) && (1 == object->retainCount.fetch_sub(1)))
+	{
+		delete object;
+	}
+}// Release
+
+
+/*!
+Adds a reference to an object and returns the object.
+
+(2021.06)
+*/
+CFTypeRef
+CFRetain	(CFTypeRef	inObject)
+{
+	++(returnObject(inObject)->retainCount);
+	return inObject;
+}// Retain
+
+
+CFTypeID	CFArrayGetTypeID ()			{ return kMy_TypeIDArray; }
+CFTypeID	CFBundleGetTypeID ()		{ return kMy_TypeIDUnavailable + 1; }
+CFTypeID	CFDataGetTypeID ()			{ return kMy_TypeIDUnavailable + 2; }
+CFTypeID	CFDictionaryGetTypeID ()	{ return kMy_TypeIDUnavailable + 3; }
+CFTypeID	CFErrorGetTypeID ()			{ return kMy_TypeIDError; }
+CFTypeID	CFReadStreamGetTypeID ()	{ return kMy_TypeIDUnavailable + 4; }
+CFTypeID	CFSetGetTypeID ()			{ return kMy_TypeIDUnavailable + 5; }
+CFTypeID	CFStringGetTypeID ()		{ return kMy_TypeIDString; }
+CFTypeID	CFURLGetTypeID ()			{ return kMy_TypeIDUnavailable + 6; }
+CFTypeID	CFWriteStreamGetTypeID ()	{ return kMy_TypeIDUnavailable + 7; }
+
+
+/*!
+Appends a string to a mutable string.
+
+(2021.06)
+*/
+void
+CFStringAppend	(CFMutableStringRef		inoutString,
+				 CFStringRef			inAppendedString)
+{
+	inoutString->replace(CFRangeMake(inoutString->length, 0), inAppendedString->characters, inAppendedString->length);
+}// StringAppend
+
+
+/*!
+Appends a C string in the given encoding to a mutable string.
+
+(2021.06)
+*/
+void
+CFStringAppendCString	(CFMutableStringRef		inoutString,
+						 char const*			inCString,
+						 CFStringEncoding		inEncoding)
+{
+	std::vector< UniChar >	decoded;
+	
+	
+	if (decodeBytes(REINTERPRET_CAST(inCString, UInt8 const*), STATIC_CAST(std::strlen(inCString), CFIndex), inEncoding, decoded))
+	{
+		inoutString->replace(CFRangeMake(inoutString->length, 0), decoded.data(), STATIC_CAST(decoded.size(), CFIndex));
+	}
+}// StringAppendCString
+
+
+/*!
+Compares two strings by code unit (optionally ignoring
+the case of ASCII letters), like a literal comparison on
+the Mac.
+
+(2021.06)
+*/
+CFComparisonResult
+CFStringCompare		(CFStringRef			inString1,
+					 CFStringRef			inString2,
+					 CFStringCompareFlags	inFlags)
+{
+	auto					foldedCase = [=](UniChar inCharacter) -> UniChar
+							{
+								return ((0 != (inFlags & kCFCompareCaseInsensitive)) && (inCharacter >= 'A') && (inCharacter <= 'Z'))
+										? STATIC_CAST(inCharacter + ('a' - 'A'), UniChar)
+										: inCharacter;
+							};
+	CFIndex const			kCommonLength = std::min(inString1->length, inString2->length);
+	CFComparisonResult		result = kCFCompareEqualTo;
+	
+	
+	for (CFIndex i = 0; ((kCFCompareEqualTo == result) && (i < kCommonLength)); ++i)
+	{
+		UniChar const	kCharacter1 = foldedCase(inString1->characters[i]);
+		UniChar const	kCharacter2 = foldedCase(inString2->characters[i]);
+		
+		
+		if (kCharacter1 < kCharacter2)
+		{
+			result = kCFCompareLessThan;
+		}
+		else if (kCharacter1 > kCharacter2)
+		{
+			result = kCFCompareGreaterThan;
+		}
+	}
+	
+	if (kCFCompareEqualTo == result)
+	{
+		if (inString1->length < inString2->length)
+		{
+			result = kCFCompareLessThan;
+		}
+		else if (inString1->length > inString2->length)
+		{
+			result = kCFCompareGreaterThan;
+		}
+	}
+	return result;
+}// StringCompare
+
+
+/*!
+Returns a new immutable copy of a string.
+
+(2021.06)
+*/
+CFStringRef
+CFStringCreateCopy	(CFAllocatorRef		UNUSED_ARGUMENT(inAllocator),
+					 CFStringRef		inString)
+{
+	return newString(inString->characters, inString->length);
+}// StringCreateCopy
+
+
+/*!
+Returns a new, empty, mutable string.  The maximum length
+is not enforced.
+
+(2021.06)
+*/
+CFMutableStringRef
+CFStringCreateMutable	(CFAllocatorRef		UNUSED_ARGUMENT(inAllocator),
+						 CFIndex			inMaximumLength)
+{
+	__CFString*		result = newString(nullptr, 0);
+	
+	
+	result->reserve(inMaximumLength);
+	result->isMutable = true;
+	return result;
+}// StringCreateMutable
+
+
+/*!
+Returns a new mutable copy of a string.  The maximum length
+is not enforced.
+
+(2021.06)
+*/
+CFMutableStringRef
+CFStringCreateMutableCopy	(CFAllocatorRef		UNUSED_ARGUMENT(inAllocator),
+							 CFIndex			UNUSED_ARGUMENT(inMaximumLength),
+							 CFStringRef		inString)
+{
+	__CFString*		result = newString(inString->characters, inString->length);
+	
+	
+	result->isMutable = true;
+	return result;
+}// StringCreateMutableCopy
+
+
+/*!
+Returns a new mutable string that uses the caller’s buffer
+for storage, so that changes made directly to the buffer
+are seen by the string and vice versa.  If the string must
+grow beyond the capacity, the buffer is reallocated with
+"realloc()" (for "kCFAllocatorMalloc") or the string stops
+using it (for "kCFAllocatorNull").
+
+(2021.06)
+*/
+CFMutableStringRef
+CFStringCreateMutableWithExternalCharactersNoCopy	(CFAllocatorRef		UNUSED_ARGUMENT(inAllocator),
+													 UniChar*			inCharacters,
+													 CFIndex			inLength,
+													 CFIndex			inCapacity,
+													 CFAllocatorRef		inExternalCharactersAllocator)
+{
+	__CFString*		result = new __CFString;
+	
+	
+	result->characters = inCharacters;
+	result->length = inLength;
+	result->capacity = inCapacity;
+	result->deallocator = (kCFAllocatorNull == inExternalCharactersAllocator)
+							? kCFAllocatorNull
+							: kCFAllocatorMalloc;
+	result->isMutable = true;
+	return result;
+}// StringCreateMutableWithExternalCharactersNoCopy
+
+
+/*!
+Returns a new string from bytes in the given encoding, or
+nullptr if the bytes are not valid.  External byte-order
+marks are not supported.
+
+(2021.06)
+*/
+CFStringRef
+CFStringCreateWithBytes		(CFAllocatorRef		UNUSED_ARGUMENT(inAllocator),
+							 UInt8 const*		inBytes,
+							 CFIndex			inByteCount,
+							 CFStringEncoding	inEncoding,
+							 Boolean			UNUSED_ARGUMENT(inIsExternalRepresentation))
+{
+	std::vector< UniChar >	decoded;
+	CFStringRef				result = nullptr;
+	
+	
+	if (decodeBytes(inBytes, inByteCount, inEncoding, decoded))
+	{
+		result = newString(decoded.data(), STATIC_CAST(decoded.size(), CFIndex));
+	}
+	return result;
+}// StringCreateWithBytes
+
+
+/*!
+Returns a new string with a copy of the given code units.
+
+(2021.06)
+*/
+CFStringRef
+CFStringCreateWithCharacters	(CFAllocatorRef		UNUSED_ARGUMENT(inAllocator),
+								 UniChar const*		inCharacters,
+								 CFIndex			inLength)
+{
+	return newString(inCharacters, inLength);
+}// StringCreateWithCharacters
+
+
+/*!
+Returns a new string from a C string in the given encoding,
+or nullptr if the bytes are not valid.
+
+(2021.06)
+*/
+CFStringRef
+CFStringCreateWithCString	(CFAllocatorRef		inAllocator,
+							 char const*		inCString,
+							 CFStringEncoding	inEncoding)
+{
+	return CFStringCreateWithBytes(inAllocator, REINTERPRET_CAST(inCString, UInt8 const*),
+									STATIC_CAST(std::strlen(inCString), CFIndex), inEncoding, false);
+}// StringCreateWithCString
+
+
+/*!
+Returns a new string with a copy of part of another string.
+
+(2021.06)
+*/
+CFStringRef
+CFStringCreateWithSubstring		(CFAllocatorRef		UNUSED_ARGUMENT(inAllocator),
+								 CFStringRef		inString,
+								 CFRange			inRange)
+{
+	return newString(inString->characters + inRange.location, inRange.length);
+}// StringCreateWithSubstring
+
+
+/*!
+Removes part of a mutable string.
+
+(2021.06)
+*/
+void
+CFStringDelete	(CFMutableStringRef		inoutString,
+				 CFRange				inRange)
+{
+	inoutString->replace(inRange, nullptr, 0);
+}// StringDelete
+
+
+/*!
+Converts part of a string into bytes in the given encoding,
+substituting the given byte for characters that cannot be
+represented (or stopping, if the loss byte is zero).  With
+no buffer, only the required size is determined.  Returns
+the number of code units converted.
+
+(2021.06)
+*/
+CFIndex
+CFStringGetBytes	(CFStringRef		inString,
+					 CFRange			inRange,
+					 CFStringEncoding	inEncoding,
+					 UInt8				inLossByte,
+					 Boolean			UNUSED_ARGUMENT(inIsExternalRepresentation),
+					 UInt8*				outBufferOrNull,
+					 CFIndex			inBufferSize,
+					 CFIndex*			outUsedBufferSizeOrNull)
+{
+	return encodeString(inString, inRange, inEncoding, inLossByte, outBufferOrNull, inBufferSize, outUsedBufferSizeOrNull);
+}// StringGetBytes
+
+
+/*!
+Returns one UTF-16 code unit.
+
+(2021.06)
+*/
+UniChar
+CFStringGetCharacterAtIndex		(CFStringRef	inString,
+								 CFIndex		inIndex)
+{
+	return inString->characters[inIndex];
+}// StringGetCharacterAtIndex
+
+
+/*!
+Copies UTF-16 code units into the given buffer.
+
+(2021.06)
+*/
+void
+CFStringGetCharacters	(CFStringRef	inString,
+						 CFRange		inRange,
+						 UniChar*		outBuffer)
+{
+	std::copy(inString->characters + inRange.location, inString->characters + inRange.location + inRange.length, outBuffer);
+}// StringGetCharacters
+
+
+/*!
+Returns the internal UTF-16 storage of a string.
+
+(2021.06)
+*/
+UniChar const*
+CFStringGetCharactersPtr	(CFStringRef	inString)
+{
+	return inString->characters;
+}// StringGetCharactersPtr
+
+
+/*!
+Converts a string into a null-terminated C string in the
+given encoding.  Returns false if the buffer is too small
+or any character cannot be represented.
+
+(2021.06)
+*/
+Boolean
+CFStringGetCString	(CFStringRef		inString,
+					 char*				outBuffer,
+					 CFIndex			inBufferSize,
+					 CFStringEncoding	inEncoding)
+{
+	CFIndex		usedSize = 0;
+	Boolean		result = false;
+	
+	
+	if ((inBufferSize > 0) &&
+		(inString->length == encodeString(inString, CFRangeMake(0, inString->length), inEncoding, 0/* loss byte */,
+											REINTERPRET_CAST(outBuffer, UInt8*), inBufferSize - 1, &usedSize)))
+	{
+		outBuffer[usedSize] = '\0';
+		result = true;
+	}
+	return result;
+}// StringGetCString
+
+
+/*!
+Returns the original literal of a constant string if the
+encoding can represent it, or nullptr (as on the Mac, the
+caller must be prepared to copy the string instead).
+
+(2021.06)
+*/
+char const*
+CFStringGetCStringPtr	(CFStringRef		inString,
+						 CFStringEncoding	inEncoding)
+{
+	char const*		result = nullptr;
+	
+	
+	if ((kCFStringEncodingUTF8 == inEncoding) || (kCFStringEncodingASCII == inEncoding))
+	{
+		result = inString->cString;
+	}
+	return result;
+}// StringGetCStringPtr
+
+
+/*!
+Returns the number of UTF-16 code units in a string.
+
+(2021.06)
+*/
+CFIndex
+CFStringGetLength	(CFStringRef	inString)
+{
+	return inString->length;
+}// StringGetLength
+
+
+/*!
+Finds the boundaries of the line(s) that contain the given
+range: the index of the first character, the index after
+the line terminator and the index of the terminator itself.
+Any of CR, LF, CR-LF, NEL or the Unicode line and paragraph
+separators can end a line.
+
+(2021.06)
+*/
+void
+CFStringGetLineBounds	(CFStringRef	inString,
+						 CFRange		inRange,
+						 CFIndex*		outLineBeginIndexOrNull,
+						 CFIndex*		outLineEndIndexOrNull,
+						 CFIndex*		outContentsEndIndexOrNull)
+{
+	auto		isTerminator = [](UniChar inCharacter) -> bool
+				{
+					return (('\n' == inCharacter) || ('\r' == inCharacter) || (0x0085 == inCharacter) ||
+							(0x2028 == inCharacter) || (0x2029 == inCharacter));
+				};
+	CFIndex		lineBegin = std::min(inRange.location, inString->length);
+	CFIndex		contentsEnd = std::min(inRange.location + inRange.length, inString->length);
+	CFIndex		lineEnd = 0;
+	
+	
+	while ((lineBegin > 0) && (false == isTerminator(inString->characters[lineBegin - 1])))
+	{
+		--lineBegin;
+	}
+	if ((contentsEnd > lineBegin) && isTerminator(inString->characters[contentsEnd - 1]))
+	{
+		// range already ends with a terminator; find the start of it
+		--contentsEnd;
+		if (('\n' == inString->characters[contentsEnd]) && (contentsEnd > lineBegin) &&
+			('\r' == inString->characters[contentsEnd - 1]))
+		{
+			--contentsEnd;
+		}
+	}
+	while ((contentsEnd < inString->length) && (false == isTerminator(inString->characters[contentsEnd])))
+	{
+		++contentsEnd;
+	}
+	lineEnd = contentsEnd;
+	if (lineEnd < inString->length)
+	{
+		if (('\r' == inString->characters[lineEnd]) && ((lineEnd + 1) < inString->length) &&
+			('\n' == inString->characters[lineEnd + 1]))
+		{
+			++lineEnd;
+		}
+		++lineEnd;
+	}
+	
+	if (nullptr != outLineBeginIndexOrNull) *outLineBeginIndexOrNull = lineBegin;
+	if (nullptr != outLineEndIndexOrNull) *outLineEndIndexOrNull = lineEnd;
+	if (nullptr != outContentsEndIndexOrNull) *outContentsEndIndexOrNull = contentsEnd;
+}// StringGetLineBounds
+
+
+/*!
+Returns the most bytes that the given number of UTF-16 code
+units could need in the given encoding.
+
+(2021.06)
+*/
+CFIndex
+CFStringGetMaximumSizeForEncoding	(CFIndex			inLength,
+									 CFStringEncoding	inEncoding)
+{
+	CFIndex		result = inLength;
+	
+	
+	switch (inEncoding)
+	{
+	case kCFStringEncodingUTF8:
+		result = 3 * inLength;
+		break;
+	
+	case kCFStringEncodingUTF16:
+		result = 2 * inLength;
+		break;
+	
+	case kCFStringEncodingUTF32:
+		result = 4 * inLength;
+		break;
+	
+	default:
+		break;
+	}
+	return result;
+}// StringGetMaximumSizeForEncoding
+
+
+/*!
+Inserts a string into a mutable string.
+
+(2021.06)
+*/
+void
+CFStringInsert	(CFMutableStringRef		inoutString,
+				 CFIndex				inIndex,
+				 CFStringRef			inInsertedString)
+{
+	inoutString->replace(CFRangeMake(inIndex, 0), inInsertedString->characters, inInsertedString->length);
+}// StringInsert
+
+
+/*!
+Truncates a mutable string to the given length or extends
+it with repeated copies of the padding string (starting at
+the given offset into the padding).
+
+(2021.06)
+*/
+void
+CFStringPad		(CFMutableStringRef		inoutString,
+				 CFStringRef			inPaddingOrNull,
+				 CFIndex				inLength,
+				 CFIndex				inPaddingIndex)
+{
+	if (inLength <= inoutString->length)
+	{
+		inoutString->length = inLength;
+	}
+	else if ((nullptr != inPaddingOrNull) && (inPaddingOrNull->length > 0))
+	{
+		CFIndex		paddingIndex = inPaddingIndex % inPaddingOrNull->length;
+		
+		
+		inoutString->reserve(inLength);
+		while (inoutString->length < inLength)
+		{
+			inoutString->characters[inoutString->length++] = inPaddingOrNull->characters[paddingIndex];
+			paddingIndex = (paddingIndex + 1) % inPaddingOrNull->length;
+		}
+	}
+}// StringPad
+
+
+/*!
+Replaces part of a mutable string with another string.
+
+(2021.06)
+*/
+void
+CFStringReplace		(CFMutableStringRef		inoutString,
+					 CFRange				inRange,
+					 CFStringRef			inReplacement)
+{
+	inoutString->replace(inRange, inReplacement->characters, inReplacement->length);
+}// StringReplace
+
+
+/*!
+Replaces the entire contents of a mutable string.
+
+(2021.06)
+*/
+void
+CFStringReplaceAll	(CFMutableStringRef		inoutString,
+					 CFStringRef			inReplacement)
+{
+	inoutString->replace(CFRangeMake(0, inoutString->length), inReplacement->characters, inReplacement->length);
+}// StringReplaceAll
+
+
+/*!
+Implements CFSTR(): returns a string for the given literal
+(in UTF-8) that lives for the rest of the program and is
+unaffected by retains and releases.  The same string is
+returned each time for the same literal.
+
+(2021.06)
+*/
+CFStringRef
+__CFStringMakeConstantString	(char const*	inLiteral)
+{
+	static std::mutex											gConstantStringsLock;
+	static auto*												gConstantStrings = new std::unordered_map< char const*, CFStringRef >(); // never deleted
+	std::lock_guard< std::mutex >								constantStringsGuard(gConstantStringsLock);
+	std::unordered_map< char const*, CFStringRef >::iterator	toString = gConstantStrings->find(inLiteral);
+	CFStringRef													result = nullptr;
+	
+	
+	if (gConstantStrings->end() != toString)
+	{
+		result = toString->second;
+	}
+	else
+	{
+		__CFString*		newConstant = REINTERPRET_CAST(CONST_CAST(CFStringCreateWithCString(kCFAllocatorDefault, inLiteral,
+																							kCFStringEncodingUTF8), CFMutableStringRef),
+														__CFString*);
+		
+		
+		newConstant->isConstant = true;
+		newConstant->cString = inLiteral;
+		(*gConstantStrings)[inLiteral] = newConstant;
+		result = newConstant;
+	}
+	return result;
+}// __StringMakeConstantString
+
+
+#pragma mark Internal Methods
+namespace {
+
+/*!
+Appends a Unicode scalar value in UTF-16 form.
+
+(2021.06)
+*/
+void
+appendUTF16		(std::vector< UniChar >&	inoutCharacters,
+				 UInt32						inScalarValue)
+{
+	if (inScalarValue >= 0x10000)
+	{
+		inScalarValue -= 0x10000;
+		inoutCharacters.push_back(STATIC_CAST(0xD800 + (inScalarValue >> 10), UniChar));
+		inoutCharacters.push_back(STATIC_CAST(0xDC00 + (inScalarValue & 0x3FF), UniChar));
+	}
+	else
+	{
+		inoutCharacters.push_back(STATIC_CAST(inScalarValue, UniChar));
+	}
+}// appendUTF16
+
+
+/*!
+Converts bytes in the given encoding to UTF-16 code units.
+Returns false if the bytes are not valid in the encoding
+or the encoding is not supported.  Mac Roman is treated as
+ISO Latin-1, which agrees for all ASCII characters.
+
+(2021.06)
+*/
+Boolean
+decodeBytes		(UInt8 const*				inBytes,
+				 CFIndex					inByteCount,
+				 CFStringEncoding			inEncoding,
+				 std::vector< UniChar >&	outCharacters)
+{
+	Boolean		result = true;
+	
+	
+	outCharacters.clear();
+	outCharacters.reserve(inByteCount);
+	switch (inEncoding)
+	{
+	case kCFStringEncodingUTF8:
+		for (CFIndex i = 0; (result && (i < inByteCount)); )
+		{
+			UInt8 const		kLeadByte = inBytes[i];
+			UInt32			scalarValue = 0;
+			CFIndex			continuationCount = 0;
+			
+			
+			if (kLeadByte < 0x80)
+			{
+				scalarValue = kLeadByte;
+			}
+			else if ((kLeadByte & 0xE0) == 0xC0)
+			{
+				scalarValue = (kLeadByte & 0x1F);
+				continuationCount = 1;
+			}
+			else if ((kLeadByte & 0xF0) == 0xE0)
+			{
+				scalarValue = (kLeadByte & 0x0F);
+				continuationCount = 2;
+			}
+			else if ((kLeadByte & 0xF8) == 0xF0)
+			{
+				scalarValue = (kLeadByte & 0x07);
+				continuationCount = 3;
+			}
+			else
+			{
+				result = false;
+			}
+			
+			++i;
+			for (CFIndex j = 0; (result && (j < continuationCount)); ++j, ++i)
+			{
+				if ((i >= inByteCount) || ((inBytes[i] & 0xC0) != 0x80))
+				{
+					result = false;
+				}
+				else
+				{
+					scalarValue = ((scalarValue << 6) | (inBytes[i] & 0x3F));
+				}
+			}
+			
+			if (result)
+			{
+				appendUTF16(outCharacters, scalarValue);
+			}
+		}
+		break;
+	
+	case kCFStringEncodingASCII:
+		for (CFIndex i = 0; (result && (i < inByteCount)); ++i)
+		{
+			result = (inBytes[i] < 0x80);
+			outCharacters.push_back(inBytes[i]);
+		}
+		break;
+	
+	case kCFStringEncodingMacRoman:
+	case kCFStringEncodingISOLatin1:
+		outCharacters.assign(inBytes, inBytes + inByteCount);
+		break;
+	
+	case kCFStringEncodingUTF16:
+		for (CFIndex i = 0; (i + 1) < inByteCount; i += 2)
+		{
+			UniChar		codeUnit = 0;
+			
+			
+			std::memcpy(&codeUnit, inBytes + i, sizeof(codeUnit));
+			outCharacters.push_back(codeUnit);
+		}
+		break;
+	
+	default:
+		result = false;
+		break;
+	}
+	return result;
+}// decodeBytes
+
+
+/*!
+Implements CFStringGetBytes() and CFStringGetCString().
+
+(2021.06)
+*/
+CFIndex
+encodeString	(__CFString const*	inString,
+				 CFRange			inRange,
+				 CFStringEncoding	inEncoding,
+				 UInt8				inLossByte,
+				 UInt8*				outBufferOrNull,
+				 CFIndex			inBufferSize,
+				 CFIndex*			outUsedBufferSizeOrNull)
+{
+	CFIndex		result = 0;
+	CFIndex		usedSize = 0;
+	Boolean		isDone = false;
+	
+	
+	while ((false == isDone) && (result < inRange.length))
+	{
+		UInt32		scalarValue = inString->characters[inRange.location + result];
+		CFIndex		unitCount = 1;
+		UInt8		encoded[4];
+		CFIndex		encodedSize = 0;
+		
+		
+		if ((scalarValue >= 0xD800) && (scalarValue < 0xDC00) && ((result + 1) < inRange.length))
+		{
+			UInt32 const	kLowSurrogate = inString->characters[inRange.location + result + 1];
+			
+			
+			if ((kLowSurrogate >= 0xDC00) && (kLowSurrogate < 0xE000))
+			{
+				scalarValue = (0x10000 + ((scalarValue - 0xD800) << 10) + (kLowSurrogate - 0xDC00));
+				unitCount = 2;
+			}
+		}
+		
+		switch (inEncoding)
+		{
+		case kCFStringEncodingUTF8:
+			if (scalarValue < 0x80)
+			{
+				encoded[encodedSize++] = STATIC_CAST(scalarValue, UInt8);
+			}
+			else if (scalarValue < 0x800)
+			{
+				encoded[encodedSize++] = STATIC_CAST(0xC0 | (scalarValue >> 6), UInt8);
+				encoded[encodedSize++] = STATIC_CAST(0x80 | (scalarValue & 0x3F), UInt8);
+			}
+			else if (scalarValue < 0x10000)
+			{
+				encoded[encodedSize++] = STATIC_CAST(0xE0 | (scalarValue >> 12), UInt8);
+				encoded[encodedSize++] = STATIC_CAST(0x80 | ((scalarValue >> 6) & 0x3F), UInt8);
+				encoded[encodedSize++] = STATIC_CAST(0x80 | (scalarValue & 0x3F), UInt8);
+			}
+			else
+			{
+				encoded[encodedSize++] = STATIC_CAST(0xF0 | (scalarValue >> 18), UInt8);
+				encoded[encodedSize++] = STATIC_CAST(0x80 | ((scalarValue >> 12) & 0x3F), UInt8);
+				encoded[encodedSize++] = STATIC_CAST(0x80 | ((scalarValue >> 6) & 0x3F), UInt8);
+				encoded[encodedSize++] = STATIC_CAST(0x80 | (scalarValue & 0x3F), UInt8);
+			}
+			break;
+		
+		case kCFStringEncodingASCII:
+		case kCFStringEncodingMacRoman:
+		case kCFStringEncodingISOLatin1:
+			{
+				UInt32 const	kLimit = (kCFStringEncodingASCII == inEncoding) ? 0x80 : 0x100;
+				
+				
+				if (scalarValue < kLimit)
+				{
+					encoded[encodedSize++] = STATIC_CAST(scalarValue, UInt8);
+				}
+				else if (0 != inLossByte)
+				{
+					encoded[encodedSize++] = inLossByte;
+				}
+			}
+			break;
+		
+		case kCFStringEncodingUTF16:
+			unitCount = 1;
+			std::memcpy(encoded, inString->characters + inRange.location + result, sizeof(UniChar));
+			encodedSize = sizeof(UniChar);
+			break;
+		
+		default:
+			break;
+		}
+		
+		if ((0 == encodedSize) || ((nullptr != outBufferOrNull) && ((usedSize + encodedSize) > inBufferSize)))
+		{
+			isDone = true;
+		}
+		else
+		{
+			if (nullptr != outBufferOrNull)
+			{
+				std::copy(encoded, encoded + encodedSize, outBufferOrNull + usedSize);
+			}
+			usedSize += encodedSize;
+			result += unitCount;
+		}
+	}
+	
+	if (nullptr != outUsedBufferSizeOrNull)
+	{
+		*outUsedBufferSizeOrNull = usedSize;
+	}
+	return result;
+}// encodeString
+
+
+/*!
+Allocates a string with a copy of the given code units.
+
+(2021.06)
+*/
+__CFString*
+newString	(UniChar const*		inCharactersOrNull,
+			 CFIndex			inLength)
+{
+	__CFString*		result = new __CFString;
+	
+	
+	result->reserve(std::max(inLength, STATIC_CAST(1, CFIndex)));
+	if (nullptr != inCharactersOrNull)
+	{
+		std::copy(inCharactersOrNull, inCharactersOrNull + inLength, result->characters);
+		result->length = inLength;
+	}
+	return result;
+}// newString
+
+
+/*!
+Returns the object for a reference; every reference that
+is given to these functions is one of the types above.
+
+(2021.06)
+*/
+__CFObject*
+returnObject	(CFTypeRef	inObject)
+{
+	return REINTERPRET_CAST(CONST_CAST(inObject, void*), __CFObject*);
+}// returnObject
+
+} // anonymous namespace
+
+// BELOW IS REQUIRED NEWLINE TO END FILE
@@ -0,0 +1,354 @@
+/*!	\file DispatchShim.cp
+	\brief Implements the portable stand-in for the subset
+	of Grand Central Dispatch used by the core modules
+	(see "Portable/Include/dispatch/dispatch.h").
+	
+	Every queue is serial and runs its work on a dedicated
+	thread, which is enough to reproduce the ordering and
+	threading behavior that the modules rely on.
+*/
+/*###############################################################
+
+	Data Access Library
+	© 1998-2021 by Kevin Grant
+	
+	This library is free software; you can redistribute it or
+	modify it under the terms of the GNU Lesser Public License
+	as published by the Free Software Foundation; either version
+	2.1 of the License, or (at your option) any later version.
+	
+	This program is distributed in the hope that it will be
+	useful, but WITHOUT ANY WARRANTY; without even the implied
+	warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+	PURPOSE.  See the GNU Lesser Public License for details.
+	
+	You should have received a copy of the GNU Lesser Public
+	License along with this library; if not, write to:
+	
+		Free Software Foundation, Inc.
+		59 Temple Place, Suite 330
+		Boston, MA  02111-1307
+		USA
+
+###############################################################*/
+
+#include <dispatch/dispatch.h>
+#include <UniversalDefines.h>
+
+// standard-C++ includes
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+
+// Unix includes
+#include <pthread.h>
+
+
+
+#pragma mark Types
+
+/*!
+A serial queue.  The worker thread holds its own reference,
+so a queue that is released with work pending finishes that
+work before it is deleted (as in Grand Central Dispatch).
+*/
+struct dispatch_queue_s
+{
+	typedef std::pair< dispatch_function_t, void* >		WorkItem;
+	
+	explicit
+	dispatch_queue_s	(char const*	inLabel)
+	: label((nullptr != inLabel) ? inLabel : ""), retainCount(2/* caller and worker */), lock(), condition(),
+		pendingWork(), suspendCount(0), isReleased(false)
+	{
+	}
+	
+	std::string					label;			//!< name given at creation
+	std::atomic< long >			retainCount;	//!< queue is deleted when this reaches zero
+	std::mutex					lock;			//!< protects the members below
+	std::condition_variable		condition;		//!< signaled when work arrives or the queue changes state
+	std::deque< WorkItem >		pendingWork;	//!< functions to call, in order
+	long						suspendCount;	//!< if positive, no work is started
+	Boolean						isReleased;		//!< true once the caller has released every reference
+};
+
+#pragma mark Internal Method Prototypes
+namespace {
+
+void		releaseQueue		(dispatch_queue_t);
+void		runQueue			(dispatch_queue_t);
+
+} // anonymous namespace
+
+#pragma mark Variables
+namespace {
+
+thread_local dispatch_queue_t	gCurrentQueue = nullptr;	// queue whose worker is the calling thread, if any
+
+} // anonymous namespace
+
+
+
+#pragma mark Public Methods
+
+/*!
+Schedules a function to be called on the queue’s thread
+after everything submitted before it.
+
+(2021.06)
+*/
+void
+dispatch_async_f	(dispatch_queue_t		inQueue,
+					 void*					inContext,
+					 dispatch_function_t	inFunction)
+{
+	{
+		std::lock_guard< std::mutex >	queueGuard(inQueue->lock);
+		
+		
+		inQueue->pendingWork.emplace_back(inFunction, inContext);
+	}
+	inQueue->condition.notify_all();
+}// async_f
+
+
+/*!
+Returns the queue that stands in for the main queue.  There
+is no run loop in portable builds, so this is an ordinary
+serial queue, created the first time that it is needed.
+
+(2021.06)
+*/
+dispatch_queue_t
+dispatch_get_main_queue ()
+{
+	static dispatch_queue_t		gMainQueue = dispatch_queue_create("com.apple.main-thread", DISPATCH_QUEUE_SERIAL); // never released
+	
+	
+	return gMainQueue;
+}// get_main_queue
+
+
+/*!
+Creates a serial queue with its own thread.  Release it
+with dispatch_release().
+
+(2021.06)
+*/
+dispatch_queue_t
+dispatch_queue_create	(char const*			inLabel,
+						 dispatch_queue_attr_t	UNUSED_ARGUMENT(inAttributes))
+{
+	dispatch_queue_t	result = new dispatch_queue_s(inLabel);
+	
+	
+	std::thread(runQueue, result).detach();
+	return result;
+}// queue_create
+
+
+/*!
+Returns the label of the given queue or, for the constant
+DISPATCH_CURRENT_QUEUE_LABEL, the queue that is running the
+calling code (or nullptr if there is none).
+
+(2021.06)
+*/
+char const*
+dispatch_queue_get_label	(dispatch_queue_t	inQueueOrNullForCurrent)
+{
+	dispatch_queue_t	queue = (nullptr != inQueueOrNullForCurrent) ? inQueueOrNullForCurrent : gCurrentQueue;
+	
+	
+	return (nullptr != queue) ? queue->label.c_str() : nullptr;
+}// queue_get_label
+
+
+/*!
+Releases a queue; when no references remain, the queue
+finishes any pending work and then is deleted.
+
+(2021.06)
+*/
+void
+dispatch_release	(dispatch_queue_t	inQueue)
+{
+	if (2 == inQueue->retainCount.fetch_sub(1))
+	{
+		// only the worker reference remains
+		{
+			std::lock_guard< std::mutex >	queueGuard(inQueue->lock);
+			
+			
+			inQueue->isReleased = true;
+		}
+		inQueue->condition.notify_all();
+	}
+}// release
+
+
+/*!
+Resumes a queue that was suspended with dispatch_suspend().
+
+(2021.06)
+*/
+void
+dispatch_resume		(dispatch_queue_t	inQueue)
+{
+	{
+		std::lock_guard< std::mutex >	queueGuard(inQueue->lock);
+		
+		
+		--(inQueue->suspendCount);
+	}
+	inQueue->condition.notify_all();
+}// resume
+
+
+/*!
+Adds a reference to a queue.
+
+(2021.06)
+*/
+void
+dispatch_retain		(dispatch_queue_t	inQueue)
+{
+	++(inQueue->retainCount);
+}// retain
+
+
+/*!
+Prevents a queue from starting any more work until it is
+resumed.  Work that is already running is not affected.
+
+(2021.06)
+*/
+void
+dispatch_suspend	(dispatch_queue_t	inQueue)
+{
+	std::lock_guard< std::mutex >	queueGuard(inQueue->lock);
+	
+	
+	++(inQueue->suspendCount);
+}// suspend
+
+
+/*!
+Calls a function on the queue’s thread after everything
+submitted before it, and waits for it to return.  As with
+Grand Central Dispatch, calling this from the same queue
+deadlocks.
+
+(2021.06)
+*/
+void
+dispatch_sync_f		(dispatch_queue_t		inQueue,
+					 void*					inContext,
+					 dispatch_function_t	inFunction)
+{
+	struct SyncContext
+	{
+		void*					context;
+		dispatch_function_t		function;
+		std::mutex				lock;
+		std::condition_variable	condition;
+		Boolean					isDone;
+	};
+	SyncContext		syncContext;
+	
+	
+	syncContext.context = inContext;
+	syncContext.function = inFunction;
+	syncContext.isDone = false;
+	dispatch_async_f(inQueue, &syncContext,
+						[](void* inSyncContext)
+						{
+							SyncContext*	asSyncContext = STATIC_CAST(inSyncContext, SyncContext*);
+							
+							
+							asSyncContext->function(asSyncContext->context);
+							{
+								std::lock_guard< std::mutex >	syncGuard(asSyncContext->lock);
+								
+								
+								asSyncContext->isDone = true;
+							}
+							asSyncContext->condition.notify_all();
+						});
+	
+	std::unique_lock< std::mutex >	syncLock(syncContext.lock);
+	
+	
+	syncContext.condition.wait(syncLock, [&syncContext]() { return syncContext.isDone; });
+}// sync_f
+
+
+#pragma mark Internal Methods
+namespace {
+
+/*!
+Drops the worker’s reference to a queue after its thread
+has finished, deleting the queue.
+
+(2021.06)
+*/
+void
+releaseQueue	(dispatch_queue_t	inQueue)
+{
+	if (1 == inQueue->retainCount.fetch_sub(1))
+	{
+		delete inQueue;
+	}
+}// releaseQueue
+
+
+/*!
+The body of the worker thread of a queue: calls each
+function in order (while the queue is not suspended)
+until the queue has been released and has no more work.
+
+(2021.06)
+*/
+void
+runQueue	(dispatch_queue_t	inQueue)
+{
+	std::string const	kThreadName = inQueue->label.substr(0, 15); // Linux limit, excluding terminator
+	Boolean				isDone = false;
+	
+	
+	UNUSED_RETURN(int)pthread_setname_np(pthread_self(), kThreadName.c_str());
+	gCurrentQueue = inQueue;
+	while (false == isDone)
+	{
+		dispatch_queue_s::WorkItem			workItem(nullptr, nullptr);
+		std::unique_lock< std::mutex >		queueLock(inQueue->lock);
+		
+		
+		inQueue->condition.wait(queueLock, [inQueue]()
+											{
+												return (((inQueue->suspendCount <= 0) && (false == inQueue->pendingWork.empty())) ||
+														(inQueue->isReleased && inQueue->pendingWork.empty()));
+											});
+		if (inQueue->pendingWork.empty())
+		{
+			isDone = true;
+		}
+		else
+		{
+			workItem = inQueue->pendingWork.front();
+			inQueue->pendingWork.pop_front();
+			queueLock.unlock();
+			workItem.first(workItem.second);
+		}
+	}
+	gCurrentQueue = nullptr;
+	releaseQueue(inQueue);
+}// runQueue
+
+} // anonymous namespace
+
+// BELOW IS REQUIRED NEWLINE TO END FILE
@@ -0,0 +1,801 @@
+/*!	\file PortableBenchmarks.cp
+	\brief Measures the throughput of the portable core
+	modules, so that changes to parsers and data structures
+	can be compared without running the application.
+	
+	Build and run with "make -f GNUmakefile portable-benchmarks";
+	give benchmark names as arguments to run only those.
+*/
+/*###############################################################
+
+	MacTerm
+		© 1998-2021 by Kevin Grant.
+		© 2001-2003 by Ian Anderson.
+		© 1986-1994 University of Illinois Board of Trustees
+		(see About box for full list of U of I contributors).
+	
+	This program is free software; you can redistribute it or
+	modify it under the terms of the GNU General Public License
+	as published by the Free Software Foundation; either version
+	2 of the License, or (at your option) any later version.
+	
+	This program is distributed in the hope that it will be
+	useful, but WITHOUT ANY WARRANTY; without even the implied
+	warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+	PURPOSE.  See the GNU General Public License for more
+	details.
+	
+	You should have received a copy of the GNU General Public
+	License along with this program; if not, write to:
+	
+		Free Software Foundation, Inc.
+		59 Temple Place, Suite 330
+		Boston, MA  02111-1307
+		USA
+
+###############################################################*/
+
+#include <UniversalDefines.h>
+
+// standard-C includes
+#include <cstdlib>
+#include <cstring>
+
+// standard-C++ includes
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <list>
+#include <string>
+#include <thread>
+#include <vector>
+
+// UNIX includes
+extern "C"
+{
+#	include <unistd.h>
+#	include <sys/wait.h>
+#if defined(__APPLE__)
+#	include <util.h>
+#else
+#	include <pty.h>
+#endif
+}
+
+// library includes
+#include <CFRetainRelease.h>
+#include <Console.h>
+#include <ListenerModel.h>
+#include <ParameterDecoder.h>
+#include <ProcessSpawn.h>
+#include <TimerWheel.h>
+#include <UTF8Decoder.h>
+
+// application includes
+#include "PasteStream.h"
+#include "SessionServer.h"
+#include "SixelDecoder.h"
+#include "TerminalLine.h"
+
+
+
+#pragma mark Types
+namespace {
+
+/*!
+A benchmark runs its work once per call and returns the
+number of bytes (or other units) that it processed.
+*/
+typedef size_t (*My_BenchmarkProcPtr)	();
+
+struct My_Benchmark
+{
+	char const*				name;		//!< used to select the benchmark from the command line
+	char const*				unitName;	//!< what the return value of the function counts
+	My_BenchmarkProcPtr		function;	//!< runs one iteration
+};
+
+} // anonymous namespace
+
+#pragma mark Internal Method Prototypes
+namespace {
+
+size_t		benchmarkForkPTY					();
+size_t		benchmarkForkPTY1GB					();
+void		benchmarkListenerCallback			(ListenerModel_Ref, ListenerModel_Event, void*, void*);
+size_t		benchmarkListenerModelNotify		();
+size_t		benchmarkParameterDecoder			();
+size_t		benchmarkPasteStreamRead			();
+size_t		benchmarkProcessSpawn				();
+size_t		benchmarkProcessSpawn1GB			();
+size_t		benchmarkSessionAttach				();
+size_t		benchmarkSixelDecoder				();
+size_t		benchmarkTerminalLineDecode			();
+size_t		benchmarkTerminalLineEdit			();
+void		benchmarkTimerCallback				(TimerWheel_TimerRef, void*);
+size_t		benchmarkTimerWheelRearm			();
+size_t		benchmarkUTF8Decoder				();
+void		runBenchmark						(My_Benchmark const&);
+size_t		startProcessAndWait					(Boolean, Boolean);
+
+} // anonymous namespace
+
+#pragma mark Variables
+namespace {
+
+My_Benchmark const		gBenchmarks[] =
+						{
+							{ "ParameterDecoder", "bytes", benchmarkParameterDecoder },
+							{ "PasteStreamRead", "characters", benchmarkPasteStreamRead },
+							{ "UTF8Decoder", "bytes", benchmarkUTF8Decoder },
+							{ "SixelDecoder", "bytes", benchmarkSixelDecoder },
+							{ "TerminalLine", "edits", benchmarkTerminalLineEdit },
+							{ "TerminalLineDecode", "lines", benchmarkTerminalLineDecode },
+							{ "ListenerModel", "notifications", benchmarkListenerModelNotify },
+							{ "TimerWheelRearm", "re-arms", benchmarkTimerWheelRearm },
+							{ "SessionAttach", "lines", benchmarkSessionAttach },
+							{ "ProcessSpawn", "processes", benchmarkProcessSpawn },
+							{ "ForkPTY", "processes", benchmarkForkPTY },
+							{ "ProcessSpawn1GB", "processes", benchmarkProcessSpawn1GB },
+							{ "ForkPTY1GB", "processes", benchmarkForkPTY1GB },
+						};
+UInt64					gBenchmarkSink = 0;		// prevents work from being optimized away
+
+} // anonymous namespace
+
+
+
+#pragma mark Public Methods
+
+/*!
+Runs every benchmark, or only the ones named in the
+arguments.
+
+(2021.06)
+*/
+int
+main	(int		argc,
+		 char*		argv[])
+{
+	Console_Init();
+	
+	for (auto const&	benchmark : gBenchmarks)
+	{
+		Boolean		isSelected = (argc < 2);
+		
+		
+		for (int i = 1; i < argc; ++i)
+		{
+			if (0 == std::strcmp(argv[i], benchmark.name))
+			{
+				isSelected = true;
+			}
+		}
+		
+		if (isSelected)
+		{
+			runBenchmark(benchmark);
+		}
+	}
+	
+	Console_Done();
+	
+	return (0 == gBenchmarkSink) ? EXIT_FAILURE : EXIT_SUCCESS;
+}// main
+
+
+#pragma mark Internal Methods
+namespace {
+
+/*!
+Starts a program in a pseudo-terminal with forkpty(), as
+the application used to, for comparison with the routine
+benchmarkProcessSpawn().
+
+(2021.06)
+*/
+size_t
+benchmarkForkPTY ()
+{
+	return startProcessAndWait(true/* fork */, false/* large */);
+}// benchmarkForkPTY
+
+
+/*!
+Like benchmarkForkPTY(), except that this process first
+grows by 1 GB, which makes every fork() slower.
+
+(2021.06)
+*/
+size_t
+benchmarkForkPTY1GB ()
+{
+	return startProcessAndWait(true/* fork */, true/* large */);
+}// benchmarkForkPTY1GB
+
+
+/*!
+Does almost nothing, so that notification overhead is
+what is measured.
+
+(2021.06)
+*/
+void
+benchmarkListenerCallback	(ListenerModel_Ref		UNUSED_ARGUMENT(inModel),
+							 ListenerModel_Event	UNUSED_ARGUMENT(inEvent),
+							 void*					UNUSED_ARGUMENT(inEventContext),
+							 void*					UNUSED_ARGUMENT(inListenerContext))
+{
+	++gBenchmarkSink;
+}// benchmarkListenerCallback
+
+
+/*!
+Notifies 16 listeners of an event, many times.
+
+(2021.06)
+*/
+size_t
+benchmarkListenerModelNotify ()
+{
+	size_t const	kNotificationCount = 10000;
+	static auto		gModel = ListenerModel_New(kListenerModel_StyleStandard, 'bnch');
+	static auto		gListeners = []()
+					{
+						std::vector< ListenerModel_ListenerWrap >	result(16);
+						
+						
+						for (auto&	listenerWrap : result)
+						{
+							listenerWrap.setWithNoRetain(ListenerModel_NewStandardListener(benchmarkListenerCallback));
+							UNUSED_RETURN(ListenerModel_Result)ListenerModel_AddListenerForEvent(gModel, 'bnch', listenerWrap.returnRef());
+						}
+						return result;
+					}();
+	
+	
+	for (size_t i = 0; i < kNotificationCount; ++i)
+	{
+		UNUSED_RETURN(ListenerModel_Result)ListenerModel_NotifyListenersOfEvent(gModel, 'bnch', nullptr/* context */);
+	}
+	return kNotificationCount;
+}// benchmarkListenerModelNotify
+
+
+/*!
+Decodes a long run of terminal parameters.
+
+(2021.06)
+*/
+size_t
+benchmarkParameterDecoder ()
+{
+	static std::string const	gInput = []()
+								{
+									std::string		result;
+									
+									
+									for (int i = 0; i < 20000; ++i)
+									{
+										result += std::to_string(i % 1000);
+										result += ((i % 8) == 7) ? 'm' : ';';
+									}
+									return result;
+								}();
+	ParameterDecoder_StateMachine	decoder;
+	
+	
+	for (char const	c : gInput)
+	{
+		Boolean		byteNotUsed = false;
+		
+		
+		decoder.goNextState(STATIC_CAST(c, UInt8), byteNotUsed);
+		if (ParameterDecoder_StateMachine::kStateTerminated == decoder.returnState())
+		{
+			gBenchmarkSink += decoder.parameterValues.size();
+			decoder.reset();
+		}
+	}
+	return gInput.size();
+}// benchmarkParameterDecoder
+
+
+/*!
+Reads a 4-million-character paste of 80-column lines in
+chunks, with bracketed-paste markers, as a session does
+when pasting a very large file.
+
+(2021.06)
+*/
+size_t
+benchmarkPasteStreamRead ()
+{
+	static CFStringRef const	gInput = []()
+								{
+									std::vector< UniChar >	characters;
+									
+									
+									characters.reserve(4000000);
+									while (characters.size() < 4000000)
+									{
+										for (int i = 0; i < 79; ++i)
+										{
+											characters.push_back(STATIC_CAST('!' + (i % 90), UniChar));
+										}
+										characters.push_back('\n');
+									}
+									return CFStringCreateWithCharacters(kCFAllocatorDefault, characters.data(), characters.size());
+								}();
+	UniChar const		kNewLine[] = { '\r' };
+	PasteStream_Ref		stream = PasteStream_New(gInput, kNewLine, 1, kPasteStream_OptionBracketed);
+	UniChar				buffer[4096];
+	CFIndex				chunkLength = 0;
+	
+	
+	while (kPasteStream_ResultOK == PasteStream_ReadChunk(stream, buffer, sizeof(buffer) / sizeof(UniChar), chunkLength))
+	{
+		gBenchmarkSink += buffer[chunkLength - 1];
+	}
+	PasteStream_Dispose(&stream);
+	return CFStringGetLength(gInput);
+}// benchmarkPasteStreamRead
+
+
+/*!
+Starts a program in a pseudo-terminal in the same way as a
+new local session (see ProcessSpawn_InPseudoTerminal()).
+
+(2021.06)
+*/
+size_t
+benchmarkProcessSpawn ()
+{
+	return startProcessAndWait(false/* fork */, false/* large */);
+}// benchmarkProcessSpawn
+
+
+/*!
+Like benchmarkProcessSpawn(), except that this process first
+grows by 1 GB; the time should be the same, since nothing is
+copied from this process.
+
+(2021.06)
+*/
+size_t
+benchmarkProcessSpawn1GB ()
+{
+	return startProcessAndWait(false/* fork */, true/* large */);
+}// benchmarkProcessSpawn1GB
+
+
+/*!
+Attaches to (and detaches from) a session whose process has
+written 100,000 lines, as happens when a window is reopened
+for a long-running session; the server replays all of the
+output, over a new connection.  The server runs on a thread of
+this process, but communicates over a socket as usual.
+
+(2021.06)
+*/
+size_t
+benchmarkSessionAttach ()
+{
+	// the server, its session and the client are created once,
+	// and shut down when the program exits
+	struct SessionAttachFixture
+	{
+		SessionAttachFixture ()
+		:
+		directoryPath("/tmp/MacTermBenchmark.XXXXXX"),
+		server(nullptr),
+		serverThread(),
+		client(nullptr),
+		sessionID(kSessionServer_InvalidSessionID)
+		{
+			SessionServer_Result	result = kSessionServer_ResultOK;
+			
+			
+			if (nullptr != mkdtemp(&directoryPath[0]))
+			{
+				socketPath = directoryPath + "/Sessions.socket";
+				server = SessionServer_New(socketPath.c_str(), result);
+			}
+			if (nullptr != server)
+			{
+				serverThread = std::thread([this]() { UNUSED_RETURN(SessionServer_Result)SessionServer_Run(server); });
+				client = SessionServer_NewClient(socketPath.c_str(), result);
+			}
+			if (nullptr != client)
+			{
+				std::vector< SessionServer_SessionInfo >	sessions;
+				
+				
+				result = SessionServer_ClientCreateSession(client, { "/bin/sh", "-c", "seq 1 100000" }, {}, nullptr/* working directory */,
+															nullptr/* terminal settings */, 80, 24, sessionID);
+				while ((kSessionServer_ResultOK == result) &&
+						((kSessionServer_ResultOK != SessionServer_ClientListSessions(client, sessions)) ||
+							sessions.empty() || sessions.front().isRunning))
+				{
+					std::this_thread::sleep_for(std::chrono::milliseconds(10));
+				}
+			}
+		}
+		
+		~SessionAttachFixture ()
+		{
+			SessionServer_DisposeClient(&client);
+			if (nullptr != server)
+			{
+				SessionServer_Stop(server);
+				serverThread.join();
+				SessionServer_Dispose(&server);
+				UNUSED_RETURN(int)rmdir(directoryPath.c_str());
+			}
+		}
+		
+		std::string					directoryPath;
+		std::string					socketPath;
+		SessionServer_Ref			server;
+		std::thread					serverThread;
+		SessionServer_ClientRef		client;
+		SessionServer_SessionID		sessionID;
+	};
+	static SessionAttachFixture		gFixture;
+	SessionServer_Attachment		attachment;
+	size_t							result = 0;
+	
+	
+	if (kSessionServer_ResultOK == SessionServer_ClientAttach(gFixture.client, gFixture.sessionID, attachment))
+	{
+		result = STATIC_CAST(std::count(attachment.replayedOutput.begin(), attachment.replayedOutput.end(), '\n'), size_t);
+		gBenchmarkSink += attachment.replayedOutput.size();
+		UNUSED_RETURN(SessionServer_Result)SessionServer_DetachOutput(attachment.outputFD, attachment.outputOffset, attachment.savedState);
+		UNUSED_RETURN(int)close(attachment.outputFD);
+	}
+	return std::max< size_t >(result, 1);
+}// benchmarkSessionAttach
+
+
+/*!
+Decodes a Sixel image that uses colors, repetition and
+several bands.
+
+(2021.06)
+*/
+size_t
+benchmarkSixelDecoder ()
+{
+	static std::string const	gInput = []()
+								{
+									std::string		result = "\"1;1;400;240#0;2;0;0;0#1;2;100;0;0#2;2;0;100;0";
+									
+									
+									for (int band = 0; band < 40; ++band)
+									{
+										for (int color = 0; color < 3; ++color)
+										{
+											result += '#';
+											result += std::to_string(color);
+											for (int run = 0; run < 40; ++run)
+											{
+												result += "!5";
+												result += STATIC_CAST('?' + ((band + run + color) % 64), char);
+												result += "~@";
+											}
+											result += '$';
+										}
+										result += '-';
+									}
+									return result;
+								}();
+	SixelDecoder_StateMachine	decoder;
+	
+	
+	decoder.setSixelHandler([](UInt8 inRawCharacter, UInt16 inRepeatCount) { gBenchmarkSink += (inRawCharacter * inRepeatCount); });
+	for (char const	c : gInput)
+	{
+		Boolean		byteNotUsed = false;
+		
+		
+		do
+		{
+			decoder.goNextState(STATIC_CAST(c, UInt8), byteNotUsed);
+		} while (byteNotUsed);
+	}
+	return gInput.size();
+}// benchmarkSixelDecoder
+
+
+/*!
+Restores a scrollback of 50,000 lines from their compact
+encoding (see TerminalLine_AppendEncoding()), as happens
+when the saved state of a terminal is restored.  Most of
+the lines have a few words of text; some have styles or
+inline colors, and some are blank.
+
+(2021.06)
+*/
+size_t
+benchmarkTerminalLineDecode ()
+{
+	size_t const						kLineCount = 50000;
+	static std::vector< UInt8 > const	gInput = []()
+										{
+											std::vector< UInt8 >	result;
+											
+											
+											for (size_t i = 0; i < kLineCount; ++i)
+											{
+												TerminalLine_Handle		handle;
+												
+												
+												if (0 != (i % 10))
+												{
+													TerminalLine_Object&	line = *handle;
+													std::string const		text = "line " + std::to_string(i) + ": the quick brown fox jumps over the lazy dog";
+													
+													
+													std::copy(text.begin(), text.end(), line.textVectorBegin);
+													if (0 == (i % 3))
+													{
+														std::fill(line.returnMutableAttributeVector().begin(),
+																	line.returnMutableAttributeVector().begin() + 4, kTextAttributes_StyleBold);
+													}
+													if (0 == (i % 7))
+													{
+														std::fill(line.returnMutableAttributeVector().begin() + 10,
+																	line.returnMutableAttributeVector().begin() + 20, kTextAttributes_ColorIsInlineForeground);
+														line.returnMutableInlineColorVector()[10].setForeground(0xFF, 0x80, 0x00);
+													}
+												}
+												TerminalLine_AppendEncoding(*STATIC_CAST(handle, TerminalLine_Handle const&), result);
+											}
+											return result;
+										}();
+	std::list< TerminalLine_Handle >	lines(kLineCount);
+	UInt8 const*						bytePtr = gInput.data();
+	UInt8 const* const					pastEnd = gInput.data() + gInput.size();
+	size_t								result = 0;
+	
+	
+	for (auto& handle : lines)
+	{
+		if (TerminalLine_DecodeLine(bytePtr, pastEnd, handle))
+		{
+			++result;
+		}
+	}
+	gBenchmarkSink += lines.back()->textVectorBegin[0];
+	return std::max< size_t >(result, 1);
+}// benchmarkTerminalLineDecode
+
+
+/*!
+Fills lines, inserts and deletes blanks, and copies lines,
+as happens when text is written to a terminal screen.
+
+(2021.06)
+*/
+size_t
+benchmarkTerminalLineEdit ()
+{
+	size_t const			kEditCount = 1000;
+	static CFStringRef		gFillText = CFSTR("x");
+	TerminalLine_Object		line;
+	TerminalLine_Object		otherLine;
+	TextAttributes_Object	attributes;
+	
+	
+	for (size_t i = 0; i < kEditCount; ++i)
+	{
+		StringUtilities_Cell const	kColumn(STATIC_CAST(i % 60, UInt16));
+		
+		
+		line.fillWith(gFillText, CFRangeMake(kColumn.columns_, 20));
+		line.insertBlanks(kColumn, StringUtilities_Cell(4), attributes, StringUtilities_Cell(80));
+		line.deleteRange(kColumn, StringUtilities_Cell(2), attributes, StringUtilities_Cell(80));
+		otherLine = line;
+	}
+	gBenchmarkSink += CFStringGetLength(otherLine.returnCFStringRef());
+	return kEditCount;
+}// benchmarkTerminalLineEdit
+
+
+/*!
+Counts timers that go off in benchmarkTimerWheelRearm().
+
+(2021.06)
+*/
+void
+benchmarkTimerCallback	(TimerWheel_TimerRef	UNUSED_ARGUMENT(inTimer),
+						 void*					UNUSED_ARGUMENT(inContext))
+{
+	++gBenchmarkSink;
+}// benchmarkTimerCallback
+
+
+/*!
+Simulates a flood of data arriving for 500 sessions that
+each have a keep-alive or inactivity watch: every chunk of
+data re-arms the watch of its session (as the routine
+Session_AppendDataForProcessing() does), and time moves
+forward by a millisecond every 64 chunks.
+
+(2021.06)
+*/
+size_t
+benchmarkTimerWheelRearm ()
+{
+	size_t const		kSessionCount = 500;
+	size_t const		kChunkCount = 1000000;
+	static auto			gWheel = TimerWheel_New(50, nullptr);
+	static auto			gTimers = []()
+						{
+							std::vector< TimerWheel_TimerRef >	result;
+							
+							
+							for (size_t i = 0; i < kSessionCount; ++i)
+							{
+								result.push_back(TimerWheel_NewTimer(gWheel, benchmarkTimerCallback, nullptr));
+								
+								// half keep-alive watches (10 minutes), half inactivity watches (30 seconds)
+								UNUSED_RETURN(TimerWheel_Result)TimerWheel_Arm(result.back(), (0 == (i % 2)) ? 600000 : 30000);
+							}
+							return result;
+						}();
+	UInt64				time = TimerWheel_ReturnTime(gWheel);
+	
+	
+	for (size_t i = 0; i < kChunkCount; ++i)
+	{
+		if (0 == (i % 64))
+		{
+			UNUSED_RETURN(TimerWheel_Result)TimerWheel_AdvanceTo(gWheel, ++time);
+		}
+		
+		// sessions receive data in bursts, not strictly in turn
+		UNUSED_RETURN(TimerWheel_Result)TimerWheel_Rearm(gTimers[(i / 8) % kSessionCount]);
+	}
+	return kChunkCount;
+}// benchmarkTimerWheelRearm
+
+
+/*!
+Decodes a mixture of ASCII and multi-byte UTF-8 text.
+
+(2021.06)
+*/
+size_t
+benchmarkUTF8Decoder ()
+{
+	static std::string const	gInput = []()
+								{
+									std::string		result;
+									
+									
+									for (int i = 0; i < 10000; ++i)
+									{
+										result += "plain text, \xC3\xA9t\xC3\xA9, \xE2\x98\x82 and \xF0\x9F\x98\x90\n";
+									}
+									return result;
+								}();
+	UTF8Decoder_StateMachine	decoder;
+	
+	
+	for (char const	c : gInput)
+	{
+		UInt32		errorCount = 0;
+		
+		
+		decoder.nextState(STATIC_CAST(c, UInt8), errorCount);
+		if (UTF8Decoder_StateMachine::kStateUTF8ValidSequence == decoder.returnState())
+		{
+			gBenchmarkSink += decoder.multiByteAccumulator.size();
+		}
+	}
+	return gInput.size();
+}// benchmarkUTF8Decoder
+
+
+/*!
+Calls a benchmark repeatedly for at least half a second
+(after one warm-up call) and prints its throughput.
+
+(2021.06)
+*/
+void
+runBenchmark	(My_Benchmark const&	inBenchmark)
+{
+	typedef std::chrono::steady_clock	Clock;
+	auto const		kMinimumDuration = std::chrono::milliseconds(500);
+	size_t			unitCount = 0;
+	size_t			iterationCount = 0;
+	Clock::time_point	startTime;
+	double			elapsedSeconds = 0;
+	
+	
+	UNUSED_RETURN(size_t)inBenchmark.function();
+	startTime = Clock::now();
+	do
+	{
+		unitCount += inBenchmark.function();
+		++iterationCount;
+	} while ((Clock::now() - startTime) < kMinimumDuration);
+	elapsedSeconds = std::chrono::duration< double >(Clock::now() - startTime).count();
+	
+	std::cout << std::left << std::setw(20) << inBenchmark.name << std::right << std::fixed << std::setprecision(1)
+				<< std::setw(12) << (unitCount / elapsedSeconds / 1000000.0) << " M" << inBenchmark.unitName << "/s"
+				<< std::setw(12) << (elapsedSeconds * 1000000000.0 / unitCount) << " ns per unit"
+				<< " (" << iterationCount << " iterations)" << std::endl;
+}// runBenchmark
+
+
+/*!
+Starts "/bin/true" in a new pseudo-terminal, either with
+forkpty() or with the Process Spawn module, and waits for
+it to exit.  If a large process is requested, 1 GB of memory
+is allocated and written first (and kept until the program
+exits, so run these benchmarks last).
+
+Returns the number of processes started (1, or 0 on error).
+
+(2021.06)
+*/
+size_t
+startProcessAndWait		(Boolean	inUseFork,
+						 Boolean	inLarge)
+{
+	static std::vector< char >	gResidentBytes;
+	int							masterFD = -1;
+	pid_t						processID = -1;
+	size_t						result = 0;
+	
+	
+	if (inLarge && gResidentBytes.empty())
+	{
+		gResidentBytes.assign(1024 * 1024 * 1024, 'x');
+	}
+	gBenchmarkSink += gResidentBytes.size();
+	
+	if (inUseFork)
+	{
+		processID = forkpty(&masterFD, nullptr/* name */, nullptr/* terminal settings */, nullptr/* size */);
+		if (0 == processID)
+		{
+			// child process
+			UNUSED_RETURN(int)execl("/bin/true", "true", STATIC_CAST(nullptr, char*));
+			_exit(127);
+		}
+	}
+	else
+	{
+		ProcessSpawn_Process	process;
+		
+		
+		if (kProcessSpawn_ResultOK == ProcessSpawn_InPseudoTerminal({ "/bin/true" }, {}, nullptr/* directory */,
+																	nullptr/* terminal settings */, nullptr/* size */, process))
+		{
+			masterFD = process.masterFD;
+			processID = process.processID;
+		}
+	}
+	
+	if (processID > 0)
+	{
+		int		waitStatus = 0;
+		
+		
+		if (processID == waitpid(processID, &waitStatus, 0))
+		{
+			result = 1;
+		}
+		UNUSED_RETURN(int)close(masterFD);
+	}
+	return result;
+}// startProcessAndWait
+
+} // anonymous namespace
+
+// BELOW IS REQUIRED NEWLINE TO END FILE
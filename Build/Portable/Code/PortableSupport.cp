@@ -0,0 +1,80 @@
+/*!	\file PortableSupport.cp
+	\brief Portable replacements for the few Cocoa-based
+	routines and settings that the core modules refer to.
+*/
+/*###############################################################
+
+	MacTerm
+		© 1998-2021 by Kevin Grant.
+		© 2001-2003 by Ian Anderson.
+		© 1986-1994 University of Illinois Board of Trustees
+		(see About box for full list of U of I contributors).
+	
+	This program is free software; you can redistribute it or
+	modify it under the terms of the GNU General Public License
+	as published by the Free Software Foundation; either version
+	2 of the License, or (at your option) any later version.
+	
+	This program is distributed in the hope that it will be
+	useful, but WITHOUT ANY WARRANTY; without even the implied
+	warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+	PURPOSE.  See the GNU General Public License for more
+	details.
+	
+	You should have received a copy of the GNU General Public
+	License along with this program; if not, write to:
+	
+		Free Software Foundation, Inc.
+		59 Temple Place, Suite 330
+		Boston, MA  02111-1307
+		USA
+
+###############################################################*/
+
+#include <UniversalDefines.h>
+
+// library includes
+#include <CocoaBasic.h>
+#include <Console.h>
+
+// application includes
+#include "DebugInterface.h"
+
+
+
+#pragma mark Variables
+
+// there is no Debugging panel, so logging stays off
+Boolean		gDebugInterface_LogsSixelDecoderErrors = false;
+Boolean		gDebugInterface_LogsSixelDecoderState = false;
+Boolean		gDebugInterface_LogsSixelDecoderSummary = false;
+Boolean		gDebugInterface_LogsSixelInput = false;
+Boolean		gDebugInterface_LogsTerminalInputChar = false;
+Boolean		gDebugInterface_LogsTeletypewriterState = false;
+Boolean		gDebugInterface_LogsTerminalEcho = false;
+Boolean		gDebugInterface_LogsTerminalState = false;
+
+
+
+#pragma mark Public Methods
+
+/*!
+There is no Notification Center, so this writes the
+notification to the console instead.
+
+(2021.06)
+*/
+void
+CocoaBasic_PostUserNotification		(CFStringRef	UNUSED_ARGUMENT(inNotificationName),
+									 CFStringRef	inTitle,
+									 CFStringRef	inInformativeTextOrNull,
+									 CFStringRef	UNUSED_ARGUMENT(inActionButtonTitleOrNull))
+{
+	Console_WriteValueCFString("notification", inTitle);
+	if (nullptr != inInformativeTextOrNull)
+	{
+		Console_WriteValueCFString("notification text", inInformativeTextOrNull);
+	}
+}// PostUserNotification
+
+// BELOW IS REQUIRED NEWLINE TO END FILE
@@ -0,0 +1,114 @@
+/*!	\file PortableTests.cp
+	\brief Runs the unit tests of every portable core module
+	and exits with a nonzero status if any assertion fails.
+	
+	Build and run with "make -f GNUmakefile portable-tests".
+*/
+/*###############################################################
+
+	MacTerm
+		© 1998-2021 by Kevin Grant.
+		© 2001-2003 by Ian Anderson.
+		© 1986-1994 University of Illinois Board of Trustees
+		(see About box for full list of U of I contributors).
+	
+	This program is free software; you can redistribute it or
+	modify it under the terms of the GNU General Public License
+	as published by the Free Software Foundation; either version
+	2 of the License, or (at your option) any later version.
+	
+	This program is distributed in the hope that it will be
+	useful, but WITHOUT ANY WARRANTY; without even the implied
+	warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+	PURPOSE.  See the GNU General Public License for more
+	details.
+	
+	You should have received a copy of the GNU General Public
+	License along with this program; if not, write to:
+	
+		Free Software Foundation, Inc.
+		59 Temple Place, Suite 330
+		Boston, MA  02111-1307
+		USA
+
+###############################################################*/
+
+#include <UniversalDefines.h>
+
+// standard-C includes
+#include <cstdlib>
+
+// library includes
+#include <AsyncWriter.h>
+#include <Console.h>
+#include <ListenerModel.h>
+#include <MemoryBlockPtrLocker.template.h>
+#include <MemoryBlocks.h>
+#include <ParameterDecoder.h>
+#include <ProcessSpawn.h>
+#include <TimerWheel.h>
+#include <TraceSpan.h>
+
+// application includes
+#include "BroadcastGroup.h"
+#include "EchoPredictor.h"
+#include "LinkScanner.h"
+#include "PasteStream.h"
+#include "SessionServer.h"
+#include "TerminalLine.h"
+#include "TextExport.h"
+#include "WordBoundary.h"
+
+
+
+#pragma mark Public Methods
+
+/*!
+Runs the same module tests as a debug build of the
+application (see Initialize.mm), except for the ones
+that depend on Cocoa.  If the path of the spawn helper
+is given, processes are also tested with the helper.
+
+(2021.06)
+*/
+int
+main	(int		argc,
+		 char*		argv[])
+{
+	UInt32		failureCount = 0;
+	
+	
+	Console_Init();
+	
+	Console_RunTests();
+	Memory_RunTests();
+	MemoryBlockPtrLocker_RunTests();
+	ListenerModel_RunTests();
+	AsyncWriter_RunTests();
+	TraceSpan_RunTests();
+	TimerWheel_RunTests();
+	ParameterDecoder_RunTests();
+	ProcessSpawn_RunTests();
+	if (argc > 1)
+	{
+		ProcessSpawn_SetHelperPath(argv[1]);
+		ProcessSpawn_RunTests();
+		ProcessSpawn_SetHelperPath(nullptr);
+	}
+	BroadcastGroup_RunTests();
+	EchoPredictor_RunTests();
+	LinkScanner_RunTests();
+	PasteStream_RunTests();
+	SessionServer_RunTests();
+	TerminalLine_RunTests();
+	TextExport_RunTests();
+	WordBoundary_RunTests();
+	
+	failureCount = Console_ReturnAssertionFailureCount();
+	Console_WriteValue("total assertion failures", failureCount);
+	Console_Done();
+	
+	return (0 == failureCount) ? EXIT_SUCCESS : EXIT_FAILURE;
+}// main
+
+// BELOW IS REQUIRED NEWLINE TO END FILE
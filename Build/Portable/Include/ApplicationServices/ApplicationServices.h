@@ -0,0 +1,51 @@
+/*!	\file ApplicationServices.h
+	\brief Portable stand-in for the Application Services
+	umbrella header; provides Core Foundation and the few
+	geometry types that the core modules refer to.
+*/
+/*###############################################################
+
+	Data Access Library
+	© 1998-2021 by Kevin Grant
+	
+	This library is free software; you can redistribute it or
+	modify it under the terms of the GNU Lesser Public License
+	as published by the Free Software Foundation; either version
+	2.1 of the License, or (at your option) any later version.
+	
+	This program is distributed in the hope that it will be
+	useful, but WITHOUT ANY WARRANTY; without even the implied
+	warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+	PURPOSE.  See the GNU Lesser Public License for details.
+	
+	You should have received a copy of the GNU Lesser Public
+	License along with this library; if not, write to:
+	
+		Free Software Foundation, Inc.
+		59 Temple Place, Suite 330
+		Boston, MA  02111-1307
+		USA
+
+###############################################################*/
+
+#pragma once
+
+// portable includes
+#include <CoreServices/CoreServices.h>
+
+
+
+#pragma mark Types
+
+typedef struct __HIShape const*		HIShapeRef;
+
+#pragma mark Constants
+
+enum
+{
+	kHIShapeEnumerateInit		= 1,
+	kHIShapeEnumerateRect		= 2,
+	kHIShapeEnumerateTerminate	= 3
+};
+
+// BELOW IS REQUIRED NEWLINE TO END FILE
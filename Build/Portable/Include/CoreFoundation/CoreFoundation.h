@@ -0,0 +1,406 @@
+/*!	\file CoreFoundation.h
+	\brief A small stand-in for Core Foundation, used only
+	when building the portable core modules on platforms
+	other than macOS (see "make portable-tests").
+	
+	Only the types and functions that the portable modules
+	actually use are declared, and they behave the same way
+	as the real ones for the cases those modules depend on.
+	Strings are stored as UTF-16, as they are on the Mac,
+	so that character indices mean the same thing.
+	
+	This must NEVER be on the include path of a Mac build.
+*/
+/*###############################################################
+
+	Data Access Library
+	© 1998-2021 by Kevin Grant
+	
+	This library is free software; you can redistribute it or
+	modify it under the terms of the GNU Lesser Public License
+	as published by the Free Software Foundation; either version
+	2.1 of the License, or (at your option) any later version.
+	
+	This program is distributed in the hope that it will be
+	useful, but WITHOUT ANY WARRANTY; without even the implied
+	warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+	PURPOSE.  See the GNU Lesser Public License for details.
+	
+	You should have received a copy of the GNU Lesser Public
+	License along with this library; if not, write to:
+	
+		Free Software Foundation, Inc.
+		59 Temple Place, Suite 330
+		Boston, MA  02111-1307
+		USA
+
+###############################################################*/
+
+#pragma once
+
+#ifdef __APPLE__
+#	error "the portable Core Foundation shim must not be used on macOS"
+#endif
+
+// standard-C includes
+#include <stddef.h>
+#include <stdint.h>
+
+
+
+#pragma mark Types
+
+typedef uint8_t		UInt8;
+typedef int8_t		SInt8;
+typedef uint16_t	UInt16;
+typedef int16_t		SInt16;
+typedef uint32_t	UInt32;
+typedef int32_t		SInt32;
+typedef uint64_t	UInt64;
+typedef int64_t		SInt64;
+typedef float		Float32;
+typedef double		Float64;
+typedef UInt8		Boolean;
+typedef UInt16		UniChar;
+typedef unsigned long	UniCharCount;
+typedef UInt32		UnicodeScalarValue;
+typedef UInt32		FourCharCode;
+typedef FourCharCode	OSType;
+typedef SInt32		OSStatus;
+typedef SInt16		OSErr;
+typedef UInt8*		StringPtr;
+typedef UInt8		Str255[256];
+
+typedef long			CFIndex;
+typedef unsigned long	CFTypeID;
+typedef unsigned long	CFOptionFlags;
+typedef unsigned long	CFHashCode;
+typedef double			CFTimeInterval;
+typedef CFTimeInterval	CFAbsoluteTime;
+typedef UInt32			CFStringEncoding;
+
+typedef void const*						CFTypeRef;
+typedef struct __CFAllocator const*		CFAllocatorRef;
+typedef struct __CFString const*		CFStringRef;
+typedef struct __CFString*				CFMutableStringRef;
+typedef struct __CFArray const*			CFArrayRef;
+typedef struct __CFArray*				CFMutableArrayRef;
+typedef struct __CFData const*			CFDataRef;
+typedef struct __CFData*				CFMutableDataRef;
+typedef struct __CFDictionary const*	CFDictionaryRef;
+typedef struct __CFDictionary*			CFMutableDictionaryRef;
+typedef struct __CFSet const*			CFSetRef;
+typedef struct __CFSet*					CFMutableSetRef;
+typedef struct __CFError*				CFErrorRef;
+typedef struct __CFURL const*			CFURLRef;
+typedef struct __CFBundle*				CFBundleRef;
+typedef struct __CFReadStream*			CFReadStreamRef;
+typedef struct __CFWriteStream*			CFWriteStreamRef;
+typedef struct __CFBoolean const*		CFBooleanRef;
+typedef struct __CFNumber const*		CFNumberRef;
+
+struct CFRange
+{
+	CFIndex		location;
+	CFIndex		length;
+};
+
+/*!
+Only "kCFTypeArrayCallBacks" is supported: array values
+are always retained and released.
+*/
+struct CFArrayCallBacks
+{
+	CFIndex		version;
+};
+
+typedef double		CGFloat;
+
+struct CGPoint
+{
+	CGFloat		x;
+	CGFloat		y;
+};
+
+struct CGSize
+{
+	CGFloat		width;
+	CGFloat		height;
+};
+
+struct CGRect
+{
+	CGPoint		origin;
+	CGSize		size;
+};
+
+typedef struct CGContext*	CGContextRef;
+
+#pragma mark Constants
+
+enum
+{
+	noErr = 0,
+	paramErr = -50,
+	memFullErr = -108
+};
+
+enum
+{
+	kCFNotFound = -1
+};
+
+enum CFComparisonResult
+{
+	kCFCompareLessThan		= -1,
+	kCFCompareEqualTo		= 0,
+	kCFCompareGreaterThan	= 1
+};
+
+typedef CFOptionFlags	CFStringCompareFlags;
+enum
+{
+	kCFCompareCaseInsensitive	= 1,
+	kCFCompareBackwards			= 4,
+	kCFCompareAnchored			= 8,
+	kCFCompareNonliteral		= 16
+};
+
+enum
+{
+	kCFStringEncodingMacRoman		= 0,
+	kCFStringEncodingUTF16			= 0x0100,
+	kCFStringEncodingUnicode		= 0x0100,
+	kCFStringEncodingISOLatin1		= 0x0201,
+	kCFStringEncodingASCII			= 0x0600,
+	kCFStringEncodingNonLossyASCII	= 0x0BFF,
+	kCFStringEncodingUTF8			= 0x08000100,
+	kCFStringEncodingUTF32			= 0x0C000100,
+	kCFStringEncodingInvalidId		= 0xFFFFFFFFU
+};
+
+//! closed enumerations (as used by SwiftUI-shared headers)
+#define CF_CLOSED_ENUM(_type, _name)	enum _name : _type _name; enum _name : _type
+#define CF_ENUM(_type, _name)			enum _name : _type _name; enum _name : _type
+#define CF_OPTIONS(_type, _name)		_type _name; enum : _type
+
+#define CFSTR(cStr)		__CFStringMakeConstantString("" cStr "")
+
+#pragma mark Variables
+
+extern CFAllocatorRef const				kCFAllocatorDefault;
+extern CFAllocatorRef const				kCFAllocatorMalloc;
+extern CFAllocatorRef const				kCFAllocatorNull;
+extern CFArrayCallBacks const			kCFTypeArrayCallBacks;
+
+
+
+#pragma mark Public Methods
+
+//!\name Base Utilities
+//@{
+
+CFAbsoluteTime
+	CFAbsoluteTimeGetCurrent				();
+
+inline CFRange
+	CFRangeMake								(CFIndex	inLocation,
+											 CFIndex	inLength)
+	{
+		CFRange		result = { inLocation, inLength };
+		
+		
+		return result;
+	}
+
+//@}
+
+//!\name Objects
+//@{
+
+CFStringRef
+	CFCopyTypeIDDescription					(CFTypeID);
+
+Boolean
+	CFEqual									(CFTypeRef, CFTypeRef);
+
+CFIndex
+	CFGetRetainCount						(CFTypeRef);
+
+CFTypeID
+	CFGetTypeID								(CFTypeRef);
+
+CFHashCode
+	CFHash									(CFTypeRef);
+
+void
+	CFRelease								(CFTypeRef);
+
+CFTypeRef
+	CFRetain								(CFTypeRef);
+
+CFTypeID	CFArrayGetTypeID				();
+CFTypeID	CFBundleGetTypeID				();
+CFTypeID	CFDataGetTypeID					();
+CFTypeID	CFDictionaryGetTypeID			();
+CFTypeID	CFErrorGetTypeID				();
+CFTypeID	CFReadStreamGetTypeID			();
+CFTypeID	CFSetGetTypeID					();
+CFTypeID	CFStringGetTypeID				();
+CFTypeID	CFURLGetTypeID					();
+CFTypeID	CFWriteStreamGetTypeID			();
+
+//@}
+
+//!\name Strings
+//@{
+
+void
+	CFStringAppend							(CFMutableStringRef, CFStringRef);
+
+void
+	CFStringAppendCString					(CFMutableStringRef, char const*, CFStringEncoding);
+
+CFComparisonResult
+	CFStringCompare							(CFStringRef, CFStringRef, CFStringCompareFlags);
+
+CFStringRef
+	CFStringCreateCopy						(CFAllocatorRef, CFStringRef);
+
+CFMutableStringRef
+	CFStringCreateMutable					(CFAllocatorRef, CFIndex);
+
+CFMutableStringRef
+	CFStringCreateMutableCopy				(CFAllocatorRef, CFIndex, CFStringRef);
+
+CFMutableStringRef
+	CFStringCreateMutableWithExternalCharactersNoCopy	(CFAllocatorRef, UniChar*, CFIndex, CFIndex, CFAllocatorRef);
+
+CFStringRef
+	CFStringCreateWithBytes					(CFAllocatorRef, UInt8 const*, CFIndex, CFStringEncoding, Boolean);
+
+CFStringRef
+	CFStringCreateWithCharacters			(CFAllocatorRef, UniChar const*, CFIndex);
+
+CFStringRef
+	CFStringCreateWithCString				(CFAllocatorRef, char const*, CFStringEncoding);
+
+CFStringRef
+	CFStringCreateWithSubstring				(CFAllocatorRef, CFStringRef, CFRange);
+
+void
+	CFStringDelete							(CFMutableStringRef, CFRange);
+
+CFIndex
+	CFStringGetBytes						(CFStringRef, CFRange, CFStringEncoding, UInt8, Boolean, UInt8*, CFIndex, CFIndex*);
+
+UniChar
+	CFStringGetCharacterAtIndex				(CFStringRef, CFIndex);
+
+void
+	CFStringGetCharacters					(CFStringRef, CFRange, UniChar*);
+
+UniChar const*
+	CFStringGetCharactersPtr				(CFStringRef);
+
+Boolean
+	CFStringGetCString						(CFStringRef, char*, CFIndex, CFStringEncoding);
+
+char const*
+	CFStringGetCStringPtr					(CFStringRef, CFStringEncoding);
+
+CFIndex
+	CFStringGetLength						(CFStringRef);
+
+void
+	CFStringGetLineBounds					(CFStringRef, CFRange, CFIndex*, CFIndex*, CFIndex*);
+
+CFIndex
+	CFStringGetMaximumSizeForEncoding		(CFIndex, CFStringEncoding);
+
+void
+	CFStringInsert							(CFMutableStringRef, CFIndex, CFStringRef);
+
+inline Boolean
+	CFStringIsSurrogateHighCharacter		(UniChar	inCharacter)
+	{
+		return ((inCharacter >= 0xD800) && (inCharacter <= 0xDBFF));
+	}
+
+void
+	CFStringPad								(CFMutableStringRef, CFStringRef, CFIndex, CFIndex);
+
+void
+	CFStringReplace							(CFMutableStringRef, CFRange, CFStringRef);
+
+void
+	CFStringReplaceAll						(CFMutableStringRef, CFStringRef);
+
+CFStringRef
+	__CFStringMakeConstantString			(char const*);
+
+//@}
+
+//!\name Arrays
+//@{
+
+void
+	CFArrayAppendValue						(CFMutableArrayRef, void const*);
+
+CFMutableArrayRef
+	CFArrayCreateMutable					(CFAllocatorRef, CFIndex, CFArrayCallBacks const*);
+
+CFIndex
+	CFArrayGetCount							(CFArrayRef);
+
+void const*
+	CFArrayGetValueAtIndex					(CFArrayRef, CFIndex);
+
+//@}
+
+//!\name Errors
+//@{
+
+CFStringRef
+	CFErrorCopyDescription					(CFErrorRef);
+
+//@}
+
+//!\name Geometry
+//@{
+
+inline CGPoint
+	CGPointMake								(CGFloat	inX,
+											 CGFloat	inY)
+	{
+		CGPoint		result = { inX, inY };
+		
+		
+		return result;
+	}
+
+inline CGSize
+	CGSizeMake								(CGFloat	inWidth,
+											 CGFloat	inHeight)
+	{
+		CGSize		result = { inWidth, inHeight };
+		
+		
+		return result;
+	}
+
+inline CGRect
+	CGRectMake								(CGFloat	inX,
+											 CGFloat	inY,
+											 CGFloat	inWidth,
+											 CGFloat	inHeight)
+	{
+		CGRect		result = { { inX, inY }, { inWidth, inHeight } };
+		
+		
+		return result;
+	}
+
+//@}
+
+// BELOW IS REQUIRED NEWLINE TO END FILE
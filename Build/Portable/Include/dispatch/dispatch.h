@@ -0,0 +1,104 @@
+/*!	\file dispatch.h
+	\brief Portable stand-in for the function-based subset
+	of Grand Central Dispatch that the core modules use.
+	
+	Blocks are not available with every compiler, so only
+	the "_f" variants are provided.
+*/
+/*###############################################################
+
+	Data Access Library
+	© 1998-2021 by Kevin Grant
+	
+	This library is free software; you can redistribute it or
+	modify it under the terms of the GNU Lesser Public License
+	as published by the Free Software Foundation; either version
+	2.1 of the License, or (at your option) any later version.
+	
+	This program is distributed in the hope that it will be
+	useful, but WITHOUT ANY WARRANTY; without even the implied
+	warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+	PURPOSE.  See the GNU Lesser Public License for details.
+	
+	You should have received a copy of the GNU Lesser Public
+	License along with this library; if not, write to:
+	
+		Free Software Foundation, Inc.
+		59 Temple Place, Suite 330
+		Boston, MA  02111-1307
+		USA
+
+###############################################################*/
+
+#pragma once
+
+// standard-C includes
+#include <stdint.h>
+
+
+
+#pragma mark Constants
+
+#define DISPATCH_QUEUE_SERIAL			nullptr
+#define DISPATCH_CURRENT_QUEUE_LABEL	nullptr
+
+#pragma mark Types
+
+typedef struct dispatch_queue_s*	dispatch_queue_t;
+typedef struct dispatch_queue_attr_s*	dispatch_queue_attr_t;
+typedef void (*dispatch_function_t)		(void*);
+
+
+
+#pragma mark Public Methods
+
+//!\name Creating and Destroying Queues
+//@{
+
+// ALWAYS SERIAL; EACH QUEUE HAS ITS OWN WORKER THREAD
+dispatch_queue_t
+	dispatch_queue_create		(char const*				inLabel,
+								 dispatch_queue_attr_t		inAttributes);
+
+// THERE IS NO RUN LOOP; THE “MAIN” QUEUE IS AN ORDINARY SERIAL QUEUE
+dispatch_queue_t
+	dispatch_get_main_queue		();
+
+char const*
+	dispatch_queue_get_label	(dispatch_queue_t			inQueueOrNullForCurrent);
+
+void
+	dispatch_release			(dispatch_queue_t			inQueue);
+
+void
+	dispatch_retain				(dispatch_queue_t			inQueue);
+
+//@}
+
+//!\name Submitting Work
+//@{
+
+void
+	dispatch_async_f			(dispatch_queue_t			inQueue,
+								 void*						inContext,
+								 dispatch_function_t		inFunction);
+
+void
+	dispatch_sync_f				(dispatch_queue_t			inQueue,
+								 void*						inContext,
+								 dispatch_function_t		inFunction);
+
+//@}
+
+//!\name Controlling Queues
+//@{
+
+void
+	dispatch_resume				(dispatch_queue_t			inQueue);
+
+void
+	dispatch_suspend			(dispatch_queue_t			inQueue);
+
+//@}
+
+// BELOW IS REQUIRED NEWLINE TO END FILE
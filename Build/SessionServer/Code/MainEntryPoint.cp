@@ -0,0 +1,176 @@
+/*!	\file MainEntryPoint.cp
+	\brief Front end to the session server, which keeps local
+	sessions running while no window is attached to them.
+*/
+/*###############################################################
+
+	MacTerm
+		© 1998-2021 by Kevin Grant.
+		© 2001-2003 by Ian Anderson.
+		© 1986-1994 University of Illinois Board of Trustees
+		(see About box for full list of U of I contributors).
+	
+	This program is free software; you can redistribute it or
+	modify it under the terms of the GNU General Public License
+	as published by the Free Software Foundation; either version
+	2 of the License, or (at your option) any later version.
+	
+	This program is distributed in the hope that it will be
+	useful, but WITHOUT ANY WARRANTY; without even the implied
+	warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+	PURPOSE.  See the GNU General Public License for more
+	details.
+	
+	You should have received a copy of the GNU General Public
+	License along with this program; if not, write to:
+	
+		Free Software Foundation, Inc.
+		59 Temple Place, Suite 330
+		Boston, MA  02111-1307
+		USA
+
+###############################################################*/
+
+#include <UniversalDefines.h>
+
+// standard-C includes
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+
+// UNIX includes
+extern "C"
+{
+#	include <unistd.h>
+}
+
+// library includes
+#include <Console.h>
+#include <ProcessSpawn.h>
+
+// application includes
+#include "SessionServer.h"
+
+
+
+#pragma mark Internal Method Prototypes
+namespace {
+
+void	handleTerminationSignal		(int);
+
+} // anonymous namespace
+
+#pragma mark Variables
+namespace {
+
+SessionServer_Ref	gServer = nullptr;	//!< the server that signals stop
+
+} // anonymous namespace
+
+
+
+#pragma mark Public Methods
+
+/*!
+Runs a session server until it receives SIGINT or SIGTERM.
+The socket path may be given with "--socket"; otherwise the
+default path is used (see SessionServer_ReturnDefaultSocketPath()).
+
+Processes are started in the same way as local processes of
+the application (see "ProcessSpawn.h"), by the spawn helper
+in the same directory as the server unless another helper is
+given with "--spawn-helper".
+
+Exits with status 2 if another server is already running,
+so that the application can tell that apart from failure.
+
+(2021.06)
+*/
+int
+main	(int		argc,
+		 char*		argv[])
+{
+	std::string				socketPath = SessionServer_ReturnDefaultSocketPath();
+	std::string				helperPath = std::string(argv[0]).substr(0, std::string(argv[0]).rfind('/') + 1) + "MacTermSpawnHelper";
+	SessionServer_Result	serverResult = kSessionServer_ResultOK;
+	int						result = EXIT_SUCCESS;
+	
+	
+	Console_Init();
+	
+	for (int i = 1; i < argc; ++i)
+	{
+		if ((0 == std::strcmp(argv[i], "--socket")) && ((i + 1) < argc))
+		{
+			socketPath = argv[++i];
+		}
+		else if ((0 == std::strcmp(argv[i], "--spawn-helper")) && ((i + 1) < argc))
+		{
+			helperPath = argv[++i];
+		}
+		else
+		{
+			Console_Warning(Console_WriteValueCString, "unrecognized argument", argv[i]);
+			result = EXIT_FAILURE;
+		}
+	}
+	
+	if (EXIT_SUCCESS == result)
+	{
+		// the server watches for errors on its sockets instead
+		UNUSED_RETURN(sig_t)signal(SIGPIPE, SIG_IGN);
+		
+		if (0 == access(helperPath.c_str(), X_OK))
+		{
+			ProcessSpawn_SetHelperPath(helperPath.c_str());
+		}
+		else
+		{
+			Console_Warning(Console_WriteValueCString, "spawn helper not found; processes will have no controlling terminal", helperPath.c_str());
+		}
+		
+		gServer = SessionServer_New(socketPath.c_str(), serverResult);
+		if (nullptr == gServer)
+		{
+			Console_Warning(Console_WriteValue, "unable to start session server, result", serverResult);
+			result = (kSessionServer_ResultServerAlreadyRunning == serverResult) ? 2 : EXIT_FAILURE;
+		}
+		else
+		{
+			UNUSED_RETURN(sig_t)signal(SIGINT, handleTerminationSignal);
+			UNUSED_RETURN(sig_t)signal(SIGTERM, handleTerminationSignal);
+			Console_WriteValueCString("session server listening on socket", socketPath.c_str());
+			serverResult = SessionServer_Run(gServer);
+			if (kSessionServer_ResultOK != serverResult)
+			{
+				Console_Warning(Console_WriteValue, "session server stopped because of an error, result", serverResult);
+				result = EXIT_FAILURE;
+			}
+			SessionServer_Dispose(&gServer);
+		}
+	}
+	
+	Console_Done();
+	
+	return result;
+}// main
+
+
+#pragma mark Internal Methods
+namespace {
+
+/*!
+Stops the server, which kills its sessions and removes the
+socket before the program exits.
+
+(2021.06)
+*/
+void
+handleTerminationSignal		(int	UNUSED_ARGUMENT(inSignal))
+{
+	SessionServer_Stop(gServer);
+}// handleTerminationSignal
+
+} // anonymous namespace
+
+// BELOW IS REQUIRED NEWLINE TO END FILE
@@ -0,0 +1,783 @@
+/*!	\file AsyncWriter.cp
+	\brief Writes data to a file descriptor from a background
+	queue, so that the caller never waits for the reader.
+*/
+/*###############################################################
+
+	Data Access Library
+	© 1998-2021 by Kevin Grant
+	
+	This library is free software; you can redistribute it or
+	modify it under the terms of the GNU Lesser Public License
+	as published by the Free Software Foundation; either version
+	2.1 of the License, or (at your option) any later version.
+	
+	This program is distributed in the hope that it will be
+	useful, but WITHOUT ANY WARRANTY; without even the implied
+	warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+	PURPOSE.  See the GNU Lesser Public License for details.
+	
+	You should have received a copy of the GNU Lesser Public
+	License along with this library; if not, write to:
+	
+		Free Software Foundation, Inc.
+		59 Temple Place, Suite 330
+		Boston, MA  02111-1307
+		USA
+
+###############################################################*/
+
+#include <AsyncWriter.h>
+#include <UniversalDefines.h>
+
+// standard-C includes
+#include <cerrno>
+
+// standard-C++ includes
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+
+// UNIX includes
+extern "C"
+{
+#	include <limits.h>
+#	include <poll.h>
+#	include <unistd.h>
+}
+
+// Mac includes
+#include <dispatch/dispatch.h>
+
+// library includes
+#include <Console.h>
+
+
+
+#pragma mark Constants
+namespace {
+
+size_t const	kMy_WritePieceSize = PIPE_BUF;			//!< after poll(), a write this small does not block on a pipe
+int const		kMy_PollTimeoutMilliseconds = 100;		//!< how often a stalled writer checks if it has been disposed
+
+} // anonymous namespace
+
+#pragma mark Types
+namespace {
+
+/*!
+Internal representation of an AsyncWriter_Ref.  The
+file descriptor is ONLY written from the queue.
+*/
+struct My_AsyncWriter
+{
+	My_AsyncWriter	(int, size_t, char const*);
+	~My_AsyncWriter	();
+	
+	// writer-queue methods
+	void
+	writeBuffer		(AsyncWriter_Buffer const&);
+	
+	int						fileDescriptor;		//!< where data is written (not owned)
+	size_t					backlogLimit;		//!< backlog size above which the backlog is “full”
+	dispatch_queue_t		queue;				//!< serial queue that writes every buffer in turn
+	std::atomic< size_t >	backlogSize;		//!< bytes that have been enqueued but not yet written (or discarded)
+	std::atomic< bool >		isDisposed;			//!< set when the writer is disposed; remaining data is discarded
+	std::atomic< bool >		writeFailed;		//!< set by the queue if the file descriptor cannot be written
+};
+typedef My_AsyncWriter*		My_AsyncWriterPtr;
+
+/*!
+The context of a function that is given to the queue.
+*/
+struct My_WriteRequest
+{
+	My_AsyncWriterPtr		writer;		//!< the writer that enqueued the data
+	AsyncWriter_Buffer		buffer;		//!< data to write (shared with other writers)
+};
+
+} // anonymous namespace
+
+#pragma mark Internal Method Prototypes
+namespace {
+
+void		doNothing					(void*);
+void		readTestData				(int, size_t, std::string*);
+Boolean		unitTest000_Begin			();
+Boolean		unitTest001_Begin			();
+Boolean		unitTest002_Begin			();
+void		writeRequest				(void*);
+
+} // anonymous namespace
+
+
+
+#pragma mark Public Methods
+
+/*!
+A unit test for this module.  This should always
+be run before a release, after any substantial
+changes are made, or if you suspect bugs!  It
+should also be EXPANDED as new functionality is
+proposed (ideally, a test is written before the
+functionality is added).
+
+(2021.06)
+*/
+void
+AsyncWriter_RunTests ()
+{
+	UInt16		totalTests = 0;
+	UInt16		failedTests = 0;
+	
+	
+	++totalTests; if (false == unitTest000_Begin()) ++failedTests;
+	++totalTests; if (false == unitTest001_Begin()) ++failedTests;
+	++totalTests; if (false == unitTest002_Begin()) ++failedTests;
+	
+	Console_WriteUnitTestReport("Async Writer", failedTests, totalTests);
+}// RunTests
+
+
+/*!
+Destroys a writer created with AsyncWriter_New(), and sets
+your copy of the reference to nullptr.  Data that has not
+been written yet is discarded; this only waits for the piece
+that is being written (if any), so it returns quickly even
+if the reader has stopped reading.  After this returns, the
+file descriptor is no longer used and may be closed.
+
+(2021.06)
+*/
+void
+AsyncWriter_Dispose		(AsyncWriter_Ref*	inoutRefPtr)
+{
+	if (nullptr != inoutRefPtr)
+	{
+		delete REINTERPRET_CAST(*inoutRefPtr, My_AsyncWriterPtr);
+		*inoutRefPtr = nullptr;
+	}
+}// Dispose
+
+
+/*!
+Disposes of the given writer (see AsyncWriter_Dispose())
+only if all of its data has been written, or a write has
+failed so that nothing more can be written; otherwise, the
+writer is not changed.  This never waits for the reader, so
+a caller that no longer needs a writer (but must not lose
+its data) can call this before each later write, and keep
+using the writer until it is empty.
+
+Returns "true" if the writer was disposed (and your copy of
+the reference is now nullptr), or if it was already nullptr.
+
+(2021.06)
+*/
+Boolean
+AsyncWriter_DisposeIfWritten	(AsyncWriter_Ref*	inoutRefPtr)
+{
+	Boolean		result = true;
+	
+	
+	if ((nullptr != inoutRefPtr) && (nullptr != *inoutRefPtr))
+	{
+		My_AsyncWriterPtr	ptr = REINTERPRET_CAST(*inoutRefPtr, My_AsyncWriterPtr);
+		
+		
+		if ((0 == ptr->backlogSize) || ptr->writeFailed)
+		{
+			AsyncWriter_Dispose(inoutRefPtr);
+		}
+		else
+		{
+			result = false;
+		}
+	}
+	return result;
+}// DisposeIfWritten
+
+
+/*!
+Arranges for the given data to be written after everything
+that was enqueued before it, and returns immediately.  The
+buffer is shared, not copied, so it must not change; the
+same buffer can be given to any number of writers.
+
+Data is accepted even if the backlog is full, so a caller
+that sends a sequence in several parts can rely on every
+part being sent.  To stop sending data to a slow reader,
+check AsyncWriter_IsBacklogFull() before each sequence.
+
+\retval kAsyncWriter_ResultOK
+if the data will be written
+
+\retval kAsyncWriter_ResultInvalidReference
+if the writer is nullptr
+
+\retval kAsyncWriter_ResultParameterError
+if the buffer is nullptr
+
+\retval kAsyncWriter_ResultWriteFailed
+if an earlier write failed (nothing more will be written)
+
+(2021.06)
+*/
+AsyncWriter_Result
+AsyncWriter_Enqueue		(AsyncWriter_Ref		inRef,
+						 AsyncWriter_Buffer		inBuffer)
+{
+	My_AsyncWriterPtr		ptr = REINTERPRET_CAST(inRef, My_AsyncWriterPtr);
+	AsyncWriter_Result		result = kAsyncWriter_ResultOK;
+	
+	
+	if (nullptr == ptr)
+	{
+		result = kAsyncWriter_ResultInvalidReference;
+	}
+	else if (nullptr == inBuffer)
+	{
+		result = kAsyncWriter_ResultParameterError;
+	}
+	else if (ptr->writeFailed)
+	{
+		result = kAsyncWriter_ResultWriteFailed;
+	}
+	else if (false == inBuffer->empty())
+	{
+		My_WriteRequest*	requestPtr = new My_WriteRequest;
+		
+		
+		requestPtr->writer = ptr;
+		requestPtr->buffer = std::move(inBuffer);
+		ptr->backlogSize += requestPtr->buffer->size();
+		dispatch_async_f(ptr->queue, requestPtr, writeRequest);
+	}
+	return result;
+}// Enqueue
+
+
+/*!
+Copies the given bytes into a new buffer and enqueues it
+(see AsyncWriter_Enqueue()).
+
+(2021.06)
+*/
+AsyncWriter_Result
+AsyncWriter_EnqueueBytes	(AsyncWriter_Ref	inRef,
+							 void const*		inBytes,
+							 size_t				inByteCount)
+{
+	AsyncWriter_Result		result = kAsyncWriter_ResultOK;
+	
+	
+	if ((nullptr == inBytes) && (0 != inByteCount))
+	{
+		result = kAsyncWriter_ResultParameterError;
+	}
+	else
+	{
+		UInt8 const*	asBytes = REINTERPRET_CAST(inBytes, UInt8 const*);
+		
+		
+		result = AsyncWriter_Enqueue(inRef, std::make_shared< std::vector< UInt8 > const >(asBytes, asBytes + inByteCount));
+	}
+	return result;
+}// EnqueueBytes
+
+
+/*!
+Returns "true" only if more bytes are waiting to be written
+than the limit given to AsyncWriter_New(); in other words,
+the reader has fallen behind.
+
+(2021.06)
+*/
+Boolean
+AsyncWriter_IsBacklogFull	(AsyncWriter_Ref	inRef)
+{
+	My_AsyncWriterPtr	ptr = REINTERPRET_CAST(inRef, My_AsyncWriterPtr);
+	Boolean				result = false;
+	
+	
+	if (nullptr != ptr)
+	{
+		result = (ptr->backlogSize > ptr->backlogLimit);
+	}
+	return result;
+}// IsBacklogFull
+
+
+/*!
+Returns "true" only if a write has failed (for instance,
+because the other end of the file descriptor was closed).
+After that, no more data is written.
+
+(2021.06)
+*/
+Boolean
+AsyncWriter_IsFailed	(AsyncWriter_Ref	inRef)
+{
+	My_AsyncWriterPtr	ptr = REINTERPRET_CAST(inRef, My_AsyncWriterPtr);
+	Boolean				result = false;
+	
+	
+	if (nullptr != ptr)
+	{
+		result = ptr->writeFailed;
+	}
+	return result;
+}// IsFailed
+
+
+/*!
+Creates a writer for the given file descriptor, with its own
+serial queue (named with the given label).  The backlog limit
+is the number of unwritten bytes above which the writer is
+considered to be full (see AsyncWriter_IsBacklogFull()).
+
+The file descriptor is not closed by the writer.  Dispose of
+the writer with AsyncWriter_Dispose().
+
+Returns nullptr if the file descriptor is invalid.
+
+(2021.06)
+*/
+AsyncWriter_Ref
+AsyncWriter_New		(int			inFileDescriptor,
+					 size_t			inBacklogLimit,
+					 char const*	inQueueLabel)
+{
+	AsyncWriter_Ref		result = nullptr;
+	
+	
+	if (inFileDescriptor >= 0)
+	{
+		try
+		{
+			result = REINTERPRET_CAST(new My_AsyncWriter(inFileDescriptor, inBacklogLimit, inQueueLabel), AsyncWriter_Ref);
+		}
+		catch (std::bad_alloc)
+		{
+			result = nullptr;
+		}
+	}
+	return result;
+}// New
+
+
+/*!
+Returns the number of bytes that have been enqueued but not
+yet written.
+
+(2021.06)
+*/
+size_t
+AsyncWriter_ReturnBacklogSize	(AsyncWriter_Ref	inRef)
+{
+	My_AsyncWriterPtr	ptr = REINTERPRET_CAST(inRef, My_AsyncWriterPtr);
+	size_t				result = 0;
+	
+	
+	if (nullptr != ptr)
+	{
+		result = ptr->backlogSize;
+	}
+	return result;
+}// ReturnBacklogSize
+
+
+/*!
+Blocks until everything enqueued so far has been written,
+or has been discarded because a write failed.  This is for
+tests, and for writers whose reader is a file (which is
+always ready), such as a file that must be complete before
+it is used; otherwise, applications should not wait for
+readers, and certainly not on the main thread.
+
+(2021.06)
+*/
+void
+AsyncWriter_WaitUntilWritten	(AsyncWriter_Ref	inRef)
+{
+	My_AsyncWriterPtr	ptr = REINTERPRET_CAST(inRef, My_AsyncWriterPtr);
+	
+	
+	if (nullptr != ptr)
+	{
+		dispatch_sync_f(ptr->queue, nullptr, doNothing);
+	}
+}// WaitUntilWritten
+
+
+#pragma mark Internal Methods
+namespace {
+
+/*!
+Constructor.  See AsyncWriter_New().
+
+(2021.06)
+*/
+My_AsyncWriter::
+My_AsyncWriter	(int			inFileDescriptor,
+				 size_t			inBacklogLimit,
+				 char const*	inQueueLabel)
+:
+fileDescriptor(inFileDescriptor),
+backlogLimit(inBacklogLimit),
+queue(dispatch_queue_create((nullptr != inQueueLabel) ? inQueueLabel : "net.macterm.queues.writer", DISPATCH_QUEUE_SERIAL)),
+backlogSize(0),
+isDisposed(false),
+writeFailed(false)
+{
+}// My_AsyncWriter constructor
+
+
+/*!
+Destructor.  See AsyncWriter_Dispose().
+
+(2021.06)
+*/
+My_AsyncWriter::
+~My_AsyncWriter ()
+{
+	// since the queue is serial, this waits until every request
+	// has been seen; the flag makes each one return right away
+	this->isDisposed = true;
+	dispatch_sync_f(this->queue, nullptr, doNothing);
+	dispatch_release(this->queue);
+}// My_AsyncWriter destructor
+
+
+/*!
+Writes the given data in pieces, waiting with poll() before
+each piece, until the data is written, a write fails or the
+writer is disposed.
+
+Call ONLY from the writer queue.
+
+(2021.06)
+*/
+void
+My_AsyncWriter::
+writeBuffer		(AsyncWriter_Buffer const&		inBuffer)
+{
+	size_t		offset = 0;
+	
+	
+	while ((offset < inBuffer->size()) && (false == this->isDisposed) && (false == this->writeFailed))
+	{
+		struct pollfd	pollInfo;
+		int				pollResult = 0;
+		
+		
+		pollInfo.fd = this->fileDescriptor;
+		pollInfo.events = POLLOUT;
+		pollInfo.revents = 0;
+		pollResult = poll(&pollInfo, 1, kMy_PollTimeoutMilliseconds);
+		if (pollResult < 0)
+		{
+			if (EINTR != errno)
+			{
+				this->writeFailed = true;
+			}
+		}
+		else if (0 == pollResult)
+		{
+			// timed out; the reader is not keeping up (check again)
+		}
+		else if (0 == (pollInfo.revents & POLLOUT))
+		{
+			// hang-up or error
+			this->writeFailed = true;
+		}
+		else
+		{
+			ssize_t		bytesWritten = write(this->fileDescriptor, inBuffer->data() + offset,
+												std::min(inBuffer->size() - offset, kMy_WritePieceSize));
+			
+			
+			if (bytesWritten >= 0)
+			{
+				offset += bytesWritten;
+			}
+			else if ((EINTR != errno) && (EAGAIN != errno))
+			{
+				this->writeFailed = true;
+			}
+		}
+	}
+	this->backlogSize -= inBuffer->size();
+}// My_AsyncWriter::writeBuffer
+
+
+/*!
+A function that is given to dispatch_sync_f() in order to
+wait for a queue.
+
+(2021.06)
+*/
+void
+doNothing	(void*		UNUSED_ARGUMENT(inContext))
+{
+}// doNothing
+
+
+/*!
+Reads from the given file descriptor until the given number
+of bytes have been read (or there is an error), appending
+them to the given string.  Used by tests.
+
+(2021.06)
+*/
+void
+readTestData	(int			inFileDescriptor,
+				 size_t			inByteCount,
+				 std::string*	outDataPtr)
+{
+	char	buffer[4096];
+	
+	
+	while (outDataPtr->size() < inByteCount)
+	{
+		ssize_t		bytesRead = read(inFileDescriptor, buffer, std::min(sizeof(buffer), inByteCount - outDataPtr->size()));
+		
+		
+		if (bytesRead <= 0)
+		{
+			break;
+		}
+		outDataPtr->append(buffer, bytesRead);
+	}
+}// readTestData
+
+
+/*!
+Tests that data given to two writers is written to each,
+completely and in order, including a shared buffer that is
+larger than the capacity of a pipe.
+
+Returns "true" if ALL assertions pass; "false" is
+returned if any fail, however messages should be
+printed for ALL assertion failures regardless.
+
+(2021.06)
+*/
+Boolean
+unitTest000_Begin ()
+{
+	int			pipes[2][2] = { { -1, -1 }, { -1, -1 } };
+	Boolean		result = true;
+	
+	
+	Console_TestAssertUpdate(result, 0 == pipe(pipes[0]), Console_WriteValue, "pipe error", errno);
+	Console_TestAssertUpdate(result, 0 == pipe(pipes[1]), Console_WriteValue, "pipe error", errno);
+	if (result)
+	{
+		AsyncWriter_Buffer const	kLargeBuffer = std::make_shared< std::vector< UInt8 > const >(300000, 'x');
+		std::string const			kExpected = "hello " + std::string(kLargeBuffer->size(), 'x') + " world";
+		AsyncWriter_Ref				writers[2] = { nullptr, nullptr };
+		std::string					output[2];
+		std::thread					readers[2];
+		
+		
+		for (UInt16 i = 0; i < 2; ++i)
+		{
+			writers[i] = AsyncWriter_New(pipes[i][1], 1024/* backlog limit */, "net.macterm.queues.writertest");
+			Console_TestAssertUpdate(result, nullptr != writers[i], Console_WriteLine, "failed to create writer");
+			
+			// the readers only start after all the data is enqueued,
+			// to show that enqueueing does not wait for the reader
+			Console_TestAssertUpdate(result, kAsyncWriter_ResultOK == AsyncWriter_EnqueueBytes(writers[i], "hello ", 6),
+										Console_WriteLine, "failed to enqueue first part");
+			Console_TestAssertUpdate(result, kAsyncWriter_ResultOK == AsyncWriter_Enqueue(writers[i], kLargeBuffer),
+										Console_WriteLine, "failed to enqueue shared part");
+			Console_TestAssertUpdate(result, kAsyncWriter_ResultOK == AsyncWriter_EnqueueBytes(writers[i], " world", 6),
+										Console_WriteLine, "failed to enqueue last part");
+			Console_TestAssertUpdate(result, AsyncWriter_IsBacklogFull(writers[i]), Console_WriteValue, "backlog",
+										AsyncWriter_ReturnBacklogSize(writers[i]));
+		}
+		
+		for (UInt16 i = 0; i < 2; ++i)
+		{
+			readers[i] = std::thread(readTestData, pipes[i][0], kExpected.size(), &output[i]);
+		}
+		
+		for (UInt16 i = 0; i < 2; ++i)
+		{
+			AsyncWriter_WaitUntilWritten(writers[i]);
+			readers[i].join();
+			Console_TestAssertUpdate(result, 0 == AsyncWriter_ReturnBacklogSize(writers[i]), Console_WriteValue, "backlog",
+										AsyncWriter_ReturnBacklogSize(writers[i]));
+			Console_TestAssertUpdate(result, false == AsyncWriter_IsBacklogFull(writers[i]), Console_WriteLine, "backlog should not be full");
+			Console_TestAssertUpdate(result, false == AsyncWriter_IsFailed(writers[i]), Console_WriteLine, "writer should not fail");
+			Console_TestAssertUpdate(result, kExpected == output[i], Console_WriteValue, "output size", output[i].size());
+			AsyncWriter_Dispose(&writers[i]);
+			Console_TestAssertUpdate(result, nullptr == writers[i], Console_WriteLine, "expected reference to be cleared");
+		}
+	}
+	
+	for (UInt16 i = 0; i < 2; ++i)
+	{
+		UNUSED_RETURN(int)close(pipes[i][0]);
+		UNUSED_RETURN(int)close(pipes[i][1]);
+	}
+	
+	return result;
+}// unitTest000_Begin
+
+
+/*!
+Tests a reader that never reads: another writer is not
+delayed, and disposing of the stalled writer does not wait
+for the reader.  Also tests invalid input.
+
+Returns "true" if ALL assertions pass; "false" is
+returned if any fail, however messages should be
+printed for ALL assertion failures regardless.
+
+(2021.06)
+*/
+Boolean
+unitTest001_Begin ()
+{
+	int			stalledPipe[2] = { -1, -1 };
+	int			activePipe[2] = { -1, -1 };
+	Boolean		result = true;
+	
+	
+	Console_TestAssertUpdate(result, nullptr == AsyncWriter_New(-1, 0/* backlog limit */, nullptr/* label */),
+								Console_WriteLine, "expected no writer for an invalid file descriptor");
+	Console_TestAssertUpdate(result, kAsyncWriter_ResultInvalidReference == AsyncWriter_EnqueueBytes(nullptr, "x", 1),
+								Console_WriteLine, "expected invalid reference");
+	
+	Console_TestAssertUpdate(result, 0 == pipe(stalledPipe), Console_WriteValue, "pipe error", errno);
+	Console_TestAssertUpdate(result, 0 == pipe(activePipe), Console_WriteValue, "pipe error", errno);
+	if (result)
+	{
+		typedef std::chrono::steady_clock	Clock;
+		AsyncWriter_Buffer const	kBuffer = std::make_shared< std::vector< UInt8 > const >(256 * 1024, 'y');
+		AsyncWriter_Ref				stalledWriter = AsyncWriter_New(stalledPipe[1], 4096/* backlog limit */, nullptr/* label */);
+		AsyncWriter_Ref				activeWriter = AsyncWriter_New(activePipe[1], 4096/* backlog limit */, nullptr/* label */);
+		std::string					output;
+		std::thread					reader(readTestData, activePipe[0], kBuffer->size(), &output);
+		Clock::time_point			startTime;
+		
+		
+		Console_TestAssertUpdate(result, kAsyncWriter_ResultParameterError == AsyncWriter_Enqueue(stalledWriter, nullptr),
+									Console_WriteLine, "expected parameter error");
+		Console_TestAssertUpdate(result, false == AsyncWriter_IsBacklogFull(stalledWriter), Console_WriteLine, "backlog should be empty");
+		Console_TestAssertUpdate(result, kAsyncWriter_ResultOK == AsyncWriter_Enqueue(stalledWriter, kBuffer),
+									Console_WriteLine, "failed to enqueue to stalled writer");
+		Console_TestAssertUpdate(result, kAsyncWriter_ResultOK == AsyncWriter_Enqueue(activeWriter, kBuffer),
+									Console_WriteLine, "failed to enqueue to active writer");
+		
+		// the active writer finishes even though the other one cannot
+		AsyncWriter_WaitUntilWritten(activeWriter);
+		reader.join();
+		Console_TestAssertUpdate(result, kBuffer->size() == output.size(), Console_WriteValue, "output size", output.size());
+		Console_TestAssertUpdate(result, AsyncWriter_IsBacklogFull(stalledWriter), Console_WriteValue, "backlog",
+									AsyncWriter_ReturnBacklogSize(stalledWriter));
+		
+		// disposing of a stalled writer waits for (at most) one poll timeout
+		startTime = Clock::now();
+		AsyncWriter_Dispose(&stalledWriter);
+		Console_TestAssertUpdate(result, (Clock::now() - startTime) < std::chrono::seconds(2),
+									Console_WriteLine, "disposing of a stalled writer took too long");
+		AsyncWriter_Dispose(&activeWriter);
+	}
+	
+	UNUSED_RETURN(int)close(stalledPipe[0]);
+	UNUSED_RETURN(int)close(stalledPipe[1]);
+	UNUSED_RETURN(int)close(activePipe[0]);
+	UNUSED_RETURN(int)close(activePipe[1]);
+	
+	return result;
+}// unitTest001_Begin
+
+
+/*!
+Tests a writer that is no longer needed while data is
+still waiting to be written (for instance, when a session
+leaves a broadcast group): it is not disposed until the
+reader has received everything, in order, including data
+that was enqueued after the first attempt.
+
+Returns "true" if ALL assertions pass; "false" is
+returned if any fail, however messages should be
+printed for ALL assertion failures regardless.
+
+(2021.06)
+*/
+Boolean
+unitTest002_Begin ()
+{
+	int			pipeFDs[2] = { -1, -1 };
+	Boolean		result = true;
+	
+	
+	Console_TestAssertUpdate(result, AsyncWriter_DisposeIfWritten(nullptr), Console_WriteLine, "expected no writer to be disposed");
+	Console_TestAssertUpdate(result, 0 == pipe(pipeFDs), Console_WriteValue, "pipe error", errno);
+	if (result)
+	{
+		AsyncWriter_Buffer const	kBuffer = std::make_shared< std::vector< UInt8 > const >(128 * 1024, 'z');
+		std::string const			kExpected = std::string(kBuffer->size(), 'z') + "after";
+		AsyncWriter_Ref				writer = AsyncWriter_New(pipeFDs[1], 4096/* backlog limit */, nullptr/* label */);
+		std::string					output;
+		
+		
+		// nothing reads yet, so the data is still queued
+		Console_TestAssertUpdate(result, kAsyncWriter_ResultOK == AsyncWriter_Enqueue(writer, kBuffer),
+									Console_WriteLine, "failed to enqueue queued part");
+		Console_TestAssertUpdate(result, false == AsyncWriter_DisposeIfWritten(&writer),
+									Console_WriteLine, "writer with a backlog should not be disposed");
+		Console_TestAssertUpdate(result, nullptr != writer, Console_WriteLine, "expected reference to be kept");
+		
+		// later data goes to the same writer, so it stays in order
+		Console_TestAssertUpdate(result, kAsyncWriter_ResultOK == AsyncWriter_EnqueueBytes(writer, "after", 5),
+									Console_WriteLine, "failed to enqueue later part");
+		
+		{
+			std::thread		reader(readTestData, pipeFDs[0], kExpected.size(), &output);
+			
+			
+			AsyncWriter_WaitUntilWritten(writer);
+			reader.join();
+		}
+		Console_TestAssertUpdate(result, kExpected == output, Console_WriteValue, "output size", output.size());
+		Console_TestAssertUpdate(result, AsyncWriter_DisposeIfWritten(&writer),
+									Console_WriteValue, "writer should be disposed once empty; backlog", AsyncWriter_ReturnBacklogSize(writer));
+		Console_TestAssertUpdate(result, nullptr == writer, Console_WriteLine, "expected reference to be cleared");
+		AsyncWriter_Dispose(&writer);
+	}
+	
+	UNUSED_RETURN(int)close(pipeFDs[0]);
+	UNUSED_RETURN(int)close(pipeFDs[1]);
+	
+	return result;
+}// unitTest002_Begin
+
+
+/*!
+Writes the data of a request that was given to the queue by
+AsyncWriter_Enqueue(), and then deletes the request.
+
+Call ONLY from the writer queue.
+
+(2021.06)
+*/
+void
+writeRequest	(void*		inWriteRequest)
+{
+	My_WriteRequest*	requestPtr = STATIC_CAST(inWriteRequest, My_WriteRequest*);
+	
+	
+	requestPtr->writer->writeBuffer(requestPtr->buffer);
+	delete requestPtr;
+}// writeRequest
+
+} // anonymous namespace
+
+// BELOW IS REQUIRED NEWLINE TO END FILE
@@ -0,0 +1,150 @@
+/*!	\file AsyncWriter.h
+	\brief Writes data to a file descriptor from a background
+	queue, so that the caller never waits for the reader.
+	
+	Each writer has its own serial queue, so data is written
+	in the order that it was given; and a slow reader only
+	delays its own writer.  Buffers are shared and never
+	changed, so the same data can be given to many writers
+	(for instance, input that is broadcast to many sessions)
+	without being copied for each one.
+	
+	A writer counts the bytes that are waiting to be written
+	(its backlog) and reports when that exceeds a limit, so
+	that the caller can stop producing data for a reader that
+	has fallen behind.  The limit is not enforced: data given
+	to a writer is always accepted, so that a caller cannot
+	accidentally send part of a sequence.
+	
+	The file descriptor does not have to be non-blocking, and
+	is not changed; data is written in pieces no larger than
+	PIPE_BUF, after poll() says that the descriptor can be
+	written, so that a writer can stop quickly when it is
+	disposed.
+*/
+/*###############################################################
+
+	Data Access Library
+	© 1998-2021 by Kevin Grant
+	
+	This library is free software; you can redistribute it or
+	modify it under the terms of the GNU Lesser Public License
+	as published by the Free Software Foundation; either version
+	2.1 of the License, or (at your option) any later version.
+	
+	This program is distributed in the hope that it will be
+	useful, but WITHOUT ANY WARRANTY; without even the implied
+	warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+	PURPOSE.  See the GNU Lesser Public License for details.
+	
+	You should have received a copy of the GNU Lesser Public
+	License along with this library; if not, write to:
+	
+		Free Software Foundation, Inc.
+		59 Temple Place, Suite 330
+		Boston, MA  02111-1307
+		USA
+
+###############################################################*/
+
+#include <UniversalDefines.h>
+
+#pragma once
+
+// standard-C++ includes
+#include <memory>
+#include <vector>
+
+// Mac includes
+#include <CoreServices/CoreServices.h>
+
+
+
+#pragma mark Constants
+
+/*!
+Possible return values from Async Writer module routines.
+*/
+enum AsyncWriter_Result
+{
+	kAsyncWriter_ResultOK					= 0,	//!< no error occurred
+	kAsyncWriter_ResultInvalidReference		= 1,	//!< given AsyncWriter_Ref is not valid
+	kAsyncWriter_ResultParameterError		= 2,	//!< invalid input (e.g. a null buffer)
+	kAsyncWriter_ResultWriteFailed			= 3		//!< an earlier write failed, so nothing more is written
+};
+
+#pragma mark Types
+
+typedef struct AsyncWriter_OpaqueWriter*	AsyncWriter_Ref;
+
+/*!
+Data to be written.  The same buffer may be given to any
+number of writers, and must not change after that.
+*/
+typedef std::shared_ptr< std::vector< UInt8 > const >	AsyncWriter_Buffer;
+
+
+
+#pragma mark Public Methods
+
+//!\name Module Tests
+//@{
+
+void
+	AsyncWriter_RunTests				();
+
+//@}
+
+//!\name Creating and Destroying Writers
+//@{
+
+// THE FILE DESCRIPTOR IS NOT CLOSED BY THE WRITER, AND MUST STAY OPEN UNTIL THE WRITER IS DISPOSED
+AsyncWriter_Ref
+	AsyncWriter_New						(int					inFileDescriptor,
+										 size_t					inBacklogLimit,
+										 char const*			inQueueLabel);
+
+// DATA THAT HAS NOT BEEN WRITTEN IS DISCARDED; WAITS ONLY FOR THE PIECE BEING WRITTEN
+void
+	AsyncWriter_Dispose					(AsyncWriter_Ref*		inoutRefPtr);
+
+// DISPOSES ONLY IF NOTHING IS WAITING TO BE WRITTEN (OR A WRITE FAILED); NEVER BLOCKS FOR THE READER
+Boolean
+	AsyncWriter_DisposeIfWritten		(AsyncWriter_Ref*		inoutRefPtr);
+
+//@}
+
+//!\name Writing Data
+//@{
+
+AsyncWriter_Result
+	AsyncWriter_Enqueue					(AsyncWriter_Ref		inRef,
+										 AsyncWriter_Buffer		inBuffer);
+
+// COPIES THE DATA; PREFER AsyncWriter_Enqueue() TO GIVE THE SAME DATA TO SEVERAL WRITERS
+AsyncWriter_Result
+	AsyncWriter_EnqueueBytes			(AsyncWriter_Ref		inRef,
+										 void const*			inBytes,
+										 size_t					inByteCount);
+
+// BLOCKS UNTIL EVERYTHING ENQUEUED SO FAR IS WRITTEN (OR HAS FAILED); AVOID ON THE MAIN THREAD
+void
+	AsyncWriter_WaitUntilWritten		(AsyncWriter_Ref		inRef);
+
+//@}
+
+//!\name Checking Progress
+//@{
+
+Boolean
+	AsyncWriter_IsBacklogFull			(AsyncWriter_Ref		inRef);
+
+Boolean
+	AsyncWriter_IsFailed				(AsyncWriter_Ref		inRef);
+
+size_t
+	AsyncWriter_ReturnBacklogSize		(AsyncWriter_Ref		inRef);
+
+//@}
+
+// BELOW IS REQUIRED NEWLINE TO END FILE
@@ -105,10 +105,12 @@ void
 void
 	CocoaBasic_AboutPanelDisplay					();
 
+#ifdef __BLOCKS__
 Boolean
 	CocoaBasic_FileOpenPanelDisplay					(CFStringRef,
 													 CFArrayRef,
 													 void (^inOpenURLHandler)(CFURLRef));
+#endif
 
 //@}
 
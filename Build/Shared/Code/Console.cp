@@ -34,12 +34,26 @@
 #include <UniversalDefines.h>
 
 // standard-C includes
+#include <cstring>
+
+// standard-C++ includes
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
 #include <iostream>
+#include <memory>
+#include <mutex>
 #include <sstream>
 #include <string>
+#include <thread>
+#include <utility>
+#include <vector>
 
 // Unix includes
 #include <execinfo.h>
+#include <unistd.h>
 
 // Mac includes
 #include <CoreServices/CoreServices.h>
@@ -51,23 +65,162 @@
 
 
 #pragma mark Constants
+namespace {
+
+SInt16 const	kMy_IndentationMaximum = 200;			//!< arbitrary limit on spaces before each line
+SInt16 const	kMy_SpacesPerIndent = 4;				//!< spaces added by each Console_BeginFunction()
+UInt32 const	kMy_LogRecordTextSize = 224;			//!< bytes of text in one record (makes records 256 bytes)
+UInt32 const	kMy_LogRecordsPerMessageMaximum = 64;	//!< longer messages are truncated (about 14 KB)
+UInt32 const	kMy_LogRingRecordCount = 512;			//!< records buffered per thread; must be a power of 2
+UInt32 const	kMy_RateLimitMessagesPerSecond = 10;	//!< messages allowed from one call site in a 1-second window
+SInt64 const	kMy_RateLimitWindowMilliseconds = 1000;	//!< duration of a rate-limit window
+UInt32 const	kMy_DrainIntervalMilliseconds = 50;		//!< maximum time that the drain thread sleeps
+
+/*!
+The kind of message in a record, which determines how the
+values and text are eventually formatted.
+*/
+enum My_LogRecordKind : UInt8
+{
+	kMy_LogRecordKindLine			= 0,	//!< text is the entire line
+	kMy_LogRecordKindValue			= 1,	//!< text is a label; values.integers[0] is the value
+	kMy_LogRecordKindValueAddress	= 2,	//!< text is a label; values.integers[0] is the address
+	kMy_LogRecordKindValueBitFlags	= 3,	//!< text is a label; values.integers[0] holds 32 bits
+	kMy_LogRecordKindValueCharacter	= 4,	//!< text is a label; values.integers[0] is the character
+	kMy_LogRecordKindValueFloat4	= 5,	//!< text is a label; values.floats holds 4 values
+	kMy_LogRecordKindValueFourChars	= 6,	//!< text is a label; values.integers[0] is the code
+	kMy_LogRecordKindValuePair		= 7,	//!< text is a label; values.integers holds 2 values
+	kMy_LogRecordKindValueString	= 8,	//!< text is a label, a zero byte and the value
+	kMy_LogRecordKindValueUnicode	= 9		//!< text is a label; values.integers[0] is the code point
+};
+
+} // anonymous namespace
+
+#pragma mark Types
+namespace {
+
+/*!
+Unformatted data for a message (depending on its kind).
+*/
+union My_LogValues
+{
+	SInt64		integers[2];	//!< integer values, or a character, code or address
+	Float32		floats[4];		//!< floating-point values
+};
+
+/*!
+One message, or part of a long message, in the buffer of
+a thread.  Values are stored unformatted; the drain thread
+formats them later.  Text that does not fit continues in
+the records that follow.
+*/
+struct My_LogRecord
+{
+	UInt64				sequenceNumber;		//!< position of message among messages from all threads
+	My_LogRecordKind	kind;				//!< how to format the message
+	Boolean				isContinued;		//!< true if the next record holds more text for this message
+	SInt16				indentationLevel;	//!< number of spaces to write before the message
+	UInt16				textLength;			//!< number of bytes used in "text"
+	My_LogValues		values;				//!< data to format (depending on the kind)
+	char				text[kMy_LogRecordTextSize];	//!< label or line; NOT null-terminated
+};
 
-#define DEBUGGING_PREFIX_MAX				200
-#define DEBUGGING_SPACES_PER_INDENT			4
+/*!
+A lock-free buffer of records with exactly one writer (the
+thread that owns it) and one reader (the drain thread).
+Indices increase forever and wrap around the array.
+*/
+struct My_LogRing
+{
+	inline
+	My_LogRing ();
+	
+	std::atomic< UInt32 >	readIndex;		//!< advanced only by the drain thread
+	std::atomic< UInt32 >	writeIndex;		//!< advanced only by the owning thread
+	std::atomic< UInt32 >	droppedCount;	//!< messages discarded because the buffer was full
+	My_LogRecord			records[kMy_LogRingRecordCount];
+};
+typedef std::shared_ptr< My_LogRing >	My_LogRingPtr;
+
+/*!
+State of the thread that prints buffered messages.  The
+drain thread is deliberately never destroyed, so that
+other threads can log safely while the program exits.
+*/
+struct My_LogDrain
+{
+	inline
+	My_LogDrain ();
+	
+	std::mutex					lock;				//!< protects all members except "isWakeRequested"
+	std::condition_variable		wakeCondition;		//!< signaled when messages are waiting
+	std::condition_variable		passCondition;		//!< signaled after each pass over all buffers
+	std::vector< My_LogRingPtr >	rings;			//!< buffers of all threads that have logged
+	UInt64						passCount;			//!< number of completed passes over all buffers
+	std::atomic< bool >			isWakeRequested;	//!< true if the drain thread should not sleep
+	bool						isDraining;			//!< true while a pass is in progress
+	bool						isStarted;			//!< true if the drain thread exists
+};
+
+} // anonymous namespace
+
+#pragma mark Internal Method Prototypes
+namespace {
+
+void			appendRecords		(My_LogRecordKind, My_LogValues const&, char const*, char const* = nullptr, size_t = 0);
+void			drainLoop			();
+void			drainRings			();
+std::string		formatMessage		(My_LogRecord const&, std::string const&);
+My_LogValues	returnIntegerValues	(SInt64, SInt64 = 0);
+My_LogRing*		returnThreadRing	();
+void			writeCharacter		(std::ostream&, UInt8);
+Boolean			unitTest000_Begin	();
+void			writeFourChars		(std::ostream&, FourCharCode);
+
+} // anonymous namespace
 
 #pragma mark Variables
 namespace {
 
-SInt16		gIndentationLevel = 0;
-char		gIndentPrefix[DEBUGGING_PREFIX_MAX]; // arbitrary size
-Boolean		gConsoleInitialized = false;
+std::atomic< UInt32 >				gAssertionFailureCount(0);
+std::atomic< bool >					gConsoleInitialized(false);
+std::atomic< SInt16 >				gIndentationLevel(0);
+std::atomic< int >					gMinimumSeverity(kConsole_SeverityDebug);
+std::atomic< UInt64 >				gNextSequenceNumber(0);
+thread_local Console_Severity		gThreadSeverity = kConsole_SeverityInfo;
+thread_local My_LogRingPtr			gThreadRingPtr;
+thread_local bool					gThreadIsDrain = false;
+My_LogDrain&						gLogDrain ()	{ static My_LogDrain* x = new My_LogDrain(); return *x; } // never deleted
 
-}
+} // anonymous namespace
 
 
 
 #pragma mark Public Methods
 
+/*!
+A unit test for this module.  This should always
+be run before a release, after any substantial
+changes are made, or if you suspect bugs!  It
+should also be EXPANDED as new functionality is
+proposed (ideally, a test is written before the
+functionality is added).
+
+(2021.06)
+*/
+void
+Console_RunTests ()
+{
+	UInt16		totalTests = 0;
+	UInt16		failedTests = 0;
+	
+	
+	++totalTests; if (false == unitTest000_Begin()) ++failedTests;
+	
+	Console_WriteUnitTestReport("Console", failedTests, totalTests);
+}// RunTests
+
+
 /*!
 This method sets up the initial configurations for
 the debugging console window.  Call this method
@@ -87,9 +240,27 @@ IMPORTANT:	To turn off debugging completely (and
 void
 Console_Init ()
 {
+	My_LogDrain&	drain = gLogDrain();
+	
+	
 	// set up indentation
-	gIndentPrefix[0] = '\0';
+	gIndentationLevel = 0;
 	gConsoleInitialized = true;
+	
+	// start the thread that prints buffered messages
+	{
+		std::lock_guard< std::mutex >	drainGuard(drain.lock);
+		
+		
+		unless (drain.isStarted)
+		{
+			std::thread(drainLoop).detach();
+			drain.isStarted = true;
+			
+			// do not lose messages that are buffered when the program exits
+			UNUSED_RETURN(int)std::atexit(Console_Flush);
+		}
+	}
 }// Init
 
 
@@ -107,6 +278,7 @@ Console_Done ()
 {
 	if (gConsoleInitialized)
 	{
+		Console_Flush();
 		gConsoleInitialized = false;
 	}
 }// Done
@@ -131,7 +303,11 @@ Console_Assert	(char const*	inAssertionName,
 	
 	unless (inCondition)
 	{
+		Console_SeverityScope	severityScope(kConsole_SeverityError);
+		
+		
 		Console_WriteValueCString("ASSERTION FAILURE", inAssertionName);
+		++gAssertionFailureCount;
 		result = false;
 	}
 	
@@ -139,6 +315,21 @@ Console_Assert	(char const*	inAssertionName,
 }// Assert
 
 
+/*!
+Returns the number of times that Console_Assert() has
+been given a false condition, by any thread, since the
+program started.  This lets a program that only runs
+tests report an overall failure.
+
+(2021.06)
+*/
+UInt32
+Console_ReturnAssertionFailureCount ()
+{
+	return gAssertionFailureCount.load();
+}// ReturnAssertionFailureCount
+
+
 /*!
 Signals the start of a new function in the
 console’s output.  This lets you organize printed
@@ -157,19 +348,7 @@ have no effect.
 void
 Console_BeginFunction ()
 {
-	SInt16		i = 0;
-	
-	
-	if ((gIndentationLevel += DEBUGGING_SPACES_PER_INDENT) > DEBUGGING_PREFIX_MAX)
-	{
-		gIndentationLevel = DEBUGGING_PREFIX_MAX;
-	}
-	
-	gIndentPrefix[0] = '\0';
-	for (i = 0; i < gIndentationLevel; i++)
-	{
-		CPP_STD::strncat(gIndentPrefix, " ", 1);
-	}
+	gIndentationLevel = std::min< SInt16 >(gIndentationLevel + kMy_SpacesPerIndent, kMy_IndentationMaximum);
 }// BeginFunction
 
 
@@ -187,20 +366,69 @@ silently have no effect.
 void
 Console_EndFunction ()
 {
-	SInt16		i = 0;
+	gIndentationLevel = std::max< SInt16 >(gIndentationLevel - kMy_SpacesPerIndent, 0);
+}// EndFunction
+
+
+/*!
+Waits until every message written so far, by any thread,
+has been printed.  This is done automatically before
+assertion failures, stack traces and program exit; it is
+rarely needed otherwise.
+
+To avoid hanging a program that is already in trouble,
+this gives up after about a second.
+
+(2021.06)
+*/
+void
+Console_Flush ()
+{
+	My_LogDrain&	drain = gLogDrain();
 	
 	
-	if ((gIndentationLevel -= DEBUGGING_SPACES_PER_INDENT) < 0)
+	// the drain thread cannot wait for itself
+	unless (gThreadIsDrain)
 	{
-		gIndentationLevel = 0;
-	}
-	
-	gIndentPrefix[0] = '\0';
-	for (i = 0; i < gIndentationLevel; i++)
-	{
-		CPP_STD::strncat(gIndentPrefix, " ", 1);
+		std::unique_lock< std::mutex >	drainLock(drain.lock);
+		
+		
+		if (drain.isStarted)
+		{
+			// a pass that is already in progress may have missed the
+			// latest messages, so in that case wait for one more pass
+			UInt64 const	kTargetPassCount = drain.passCount + ((drain.isDraining) ? 2 : 1);
+			
+			
+			drain.isWakeRequested = true;
+			drain.wakeCondition.notify_one();
+			UNUSED_RETURN(bool)drain.passCondition.wait_for(drainLock, std::chrono::seconds(1),
+															[&drain, kTargetPassCount] ()
+															{
+																return (drain.passCount >= kTargetPassCount);
+															});
+		}
 	}
-}// EndFunction
+}// Flush
+
+
+/*!
+Discards all future messages that are less severe than
+the given level, from all threads.  By default nothing
+is discarded.
+
+Note that warnings are also limited by call site (see
+Console_Warning()).
+
+Returns the previous minimum, so that it can be restored.
+
+(2021.06)
+*/
+Console_Severity
+Console_SetMinimumSeverity	(Console_Severity	inMinimumSeverity)
+{
+	return STATIC_CAST(gMinimumSeverity.exchange(inMinimumSeverity), Console_Severity);
+}// SetMinimumSeverity
 
 
 /*!
@@ -221,25 +449,23 @@ Console_WriteHorizontalRule	()
 
 /*!
 Writes data to the console, followed by a carriage
-return and line feed, and preceded by the identifier
-of the current thread.  Pass an empty string to
-write just a new-line character.
+return and line feed.  Pass an empty string to write
+just a new-line character.
 
 The specified text is automatically indented by the
 appropriate amount, depending on how many times
 Console_BeginFunction() has been called without a
 balancing Console_EndFunction() call.
 
+The text is copied; it is printed later, in order
+with messages from all threads.
+
 (1.0)
 */
 void
 Console_WriteLine	(char const*	inString)
 {
-	if (gConsoleInitialized)
-	{
-		std::cerr << "MacTerm: " << gIndentPrefix << inString << "\015\012";
-		std::cerr.flush();
-	}
+	appendRecords(kMy_LogRecordKindLine, returnIntegerValues(0), inString);
 }// WriteLine
 
 
@@ -329,8 +555,10 @@ Console_WriteStackTrace		(UInt16		inDepth)
 	int				actualSize = backtrace(symbolArray, kArrayLength);
 	
 	
-	// print the trace
+	// print the trace (since it is written directly, first
+	// print all buffered messages so that lines are in order)
 	Console_WriteHorizontalRule();
+	Console_Flush();
 	backtrace_symbols_fd(symbolArray, actualSize, STDERR_FILENO);
 	Console_WriteHorizontalRule();
 	
@@ -380,10 +608,7 @@ void
 Console_WriteValue		(char const*	inLabel,
 						 SInt64			inValue)
 {
-	std::ostringstream	s;
-	s << inLabel << " = " << inValue;
-	std::string		sString = s.str();
-	Console_WriteLine(sString.c_str());
+	appendRecords(kMy_LogRecordKindValue, returnIntegerValues(inValue), inLabel);
 }// WriteValue
 
 
@@ -398,10 +623,7 @@ void
 Console_WriteValueAddress	(char const*	inLabel,
 							 void const*	inAddress)
 {
-	std::ostringstream	s;
-	s << inLabel << " = " << inAddress;
-	std::string		sString = s.str();
-	Console_WriteLine(sString.c_str());
+	appendRecords(kMy_LogRecordKindValueAddress, returnIntegerValues(REINTERPRET_CAST(inAddress, intptr_t)), inLabel);
 }// WriteValueAddress
 
 
@@ -416,21 +638,7 @@ void
 Console_WriteValueBitFlags		(char const*	inLabel,
 								 UInt32			in32BitValue)
 {
-	std::ostringstream	s;
-	
-	
-	s << inLabel << " = ";
-	SInt16		i = 0;
-	for (i = 31; i >= 0; --i)
-	{
-		s << (in32BitValue & (1 << i) ? "1" : "0");
-		if ((i % 4) == 0)
-		{
-			s << " ";
-		}
-	}
-	std::string		sString = s.str();
-	Console_WriteLine(sString.c_str());
+	appendRecords(kMy_LogRecordKindValueBitFlags, returnIntegerValues(in32BitValue), inLabel);
 }// WriteValueBitFlags
 
 
@@ -463,27 +671,26 @@ void
 Console_WriteValueCFString	(char const*	inLabel,
 							 CFStringRef	inValue)
 {
-	std::ostringstream	s;
-	
-	
-	s << inLabel << " = \"";
-	if (inValue != nullptr)
-	{
-		CFStringEncoding const	kEncoding = kCFStringEncodingUTF8;
-		size_t const			kBufferSize = 1 + CFStringGetMaximumSizeForEncoding
-												(CFStringGetLength(inValue), kEncoding);
-		char*					valueString = new char[kBufferSize];
-		CFStringGetCString(inValue, valueString, kBufferSize, kEncoding);
-		s << valueString;
-		delete [] valueString;
-	}
-	else
+	if (__Console_IsSeverityEnabled(gThreadSeverity))
 	{
-		s << "<null>";
+		if (inValue != nullptr)
+		{
+			CFStringEncoding const	kEncoding = kCFStringEncodingUTF8;
+			size_t const			kBufferSize = 1 + CFStringGetMaximumSizeForEncoding
+													(CFStringGetLength(inValue), kEncoding);
+			char*					valueString = new char[kBufferSize];
+			
+			
+			CFStringGetCString(inValue, valueString, kBufferSize, kEncoding);
+			appendRecords(kMy_LogRecordKindValueString, returnIntegerValues(0), inLabel, valueString, CPP_STD::strlen(valueString));
+			delete [] valueString;
+		}
+		else
+		{
+			// the value is unquoted, unlike other strings
+			appendRecords(kMy_LogRecordKindValueString, returnIntegerValues(1/* unquoted */), inLabel, "<null>", 6);
+		}
 	}
-	s << "\"";
-	std::string		sString = s.str();
-	Console_WriteLine(sString.c_str());
 }// Console_WriteValueCFString
 
 
@@ -528,33 +735,7 @@ void
 Console_WriteValueCharacter		(char const*	inLabel,
 								 UInt8			inCharacter)
 {
-	std::ostringstream		s;
-	
-	
-	s << inLabel << " = ";
-	if (inCharacter < ' '/* space */)
-	{
-		std::string		cStr;
-		cStr = inCharacter + '@';
-		s << '^' << cStr.c_str();
-	}
-	else if (inCharacter == ' '/* space */)
-	{
-		s << "<sp>";
-	}
-	else if (inCharacter >= 127)
-	{
-		s << "<" << STATIC_CAST(inCharacter, unsigned int) << ">";
-	}
-	else
-	{
-		std::string		cStr;
-		cStr = inCharacter;
-		s << cStr.c_str();
-	}
-	
-	std::string		sString = s.str();
-	Console_WriteLine(sString.c_str());
+	appendRecords(kMy_LogRecordKindValueCharacter, returnIntegerValues(inCharacter), inLabel);
 }// WriteValueCharacter
 
 
@@ -569,10 +750,7 @@ void
 Console_WriteValueCString	(char const*	inLabel,
 							 char const*	inValue)
 {
-	std::ostringstream	s;
-	s << inLabel << " = \"" << inValue << "\"";
-	std::string		sString = s.str();
-	Console_WriteLine(sString.c_str());
+	appendRecords(kMy_LogRecordKindValueString, returnIntegerValues(0), inLabel, inValue, CPP_STD::strlen(inValue));
 }// WriteValueCString
 
 
@@ -591,13 +769,14 @@ Console_WriteValueFloat4	(char const*	inLabel,
 							 Float32		inValue3,
 							 Float32		inValue4)
 {
-	std::ostringstream	s;
-	s
-	<< inLabel << " = "
-	<< inValue1 << ", " << inValue2 << ", " << inValue3 << ", " << inValue4
-	;
-	std::string		sString = s.str();
-	Console_WriteLine(sString.c_str());
+	My_LogValues	values;
+	
+	
+	values.floats[0] = inValue1;
+	values.floats[1] = inValue2;
+	values.floats[2] = inValue3;
+	values.floats[3] = inValue4;
+	appendRecords(kMy_LogRecordKindValueFloat4, values, inLabel);
 }// WriteValueFloat4
 
 
@@ -617,49 +796,15 @@ Console_WriteValueFourChars		(char const*	inLabel,
 								 FourCharCode	inValue,
 								 std::ostream*	inoutStreamPtrOrNull)
 {
-	std::ostringstream		strStream;
-	std::ostream&			outStream = ((inoutStreamPtrOrNull)
-											? *inoutStreamPtrOrNull
-											: strStream);
-	unsigned char			fourChars[] =
-							{
-								STATIC_CAST(0x000000FFUL & (inValue >> 24), unsigned char),
-								STATIC_CAST(0x000000FFUL & (inValue >> 16), unsigned char),
-								STATIC_CAST(0x000000FFUL & (inValue >> 8), unsigned char),
-								STATIC_CAST(0x000000FFUL & (inValue >> 0), unsigned char),
-							};
-	
-	
-	// write each character in a “printable” fashion
-	outStream << inLabel << " = ";
-	for (UInt16 i = 0; i < sizeof(fourChars) / sizeof(*fourChars); ++i)
+	if (nullptr == inoutStreamPtrOrNull)
 	{
-		if (fourChars[i] < ' '/* space */)
-		{
-			std::string		cStr;
-			cStr = fourChars[i] + '@';
-			outStream << '^' << cStr.c_str();
-		}
-		else if (fourChars[i] == ' '/* space */)
-		{
-			outStream << "<sp>";
-		}
-		else if (fourChars[i] >= 127)
-		{
-			outStream << "<" << STATIC_CAST(fourChars[i], unsigned int) << ">";
-		}
-		else
-		{
-			std::string		cStr;
-			cStr = fourChars[i];
-			outStream << cStr.c_str();
-		}
+		appendRecords(kMy_LogRecordKindValueFourChars, returnIntegerValues(inValue), inLabel);
 	}
-	
-	if (nullptr == inoutStreamPtrOrNull)
+	else
 	{
-		std::string		sString = strStream.str();
-		Console_WriteLine(sString.c_str());
+		// streams are written immediately
+		*inoutStreamPtrOrNull << inLabel << " = ";
+		writeFourChars(*inoutStreamPtrOrNull, inValue);
 	}
 }// WriteValueFourChars
 
@@ -676,10 +821,7 @@ Console_WriteValuePair	(char const*	inLabel,
 						 SInt64			inValue1,
 						 SInt64			inValue2)
 {
-	std::ostringstream	s;
-	s << inLabel << " = " << inValue1 << "," << inValue2;
-	std::string		sString = s.str();
-	Console_WriteLine(sString.c_str());
+	appendRecords(kMy_LogRecordKindValuePair, returnIntegerValues(inValue1, inValue2), inLabel);
 }// WriteValuePair
 
 
@@ -694,10 +836,7 @@ void
 Console_WriteValueStdString	(char const*			inLabel,
 							 std::string const&		inValue)
 {
-	std::ostringstream	s;
-	s << inLabel << " = \"" << inValue << "\"";
-	std::string		sString = s.str();
-	Console_WriteLine(sString.c_str());
+	appendRecords(kMy_LogRecordKindValueString, returnIntegerValues(0), inLabel, inValue.c_str(), inValue.size());
 }// WriteValueStdString
 
 
@@ -711,21 +850,84 @@ void
 Console_WriteValueUnicodePoint	(char const*			inLabel,
 								 UnicodeScalarValue		inCodePoint)
 {
-	if (0 == (inCodePoint & 0xFFFFFF00))
+	appendRecords(kMy_LogRecordKindValueUnicode, returnIntegerValues(inCodePoint), inLabel);
+}// WriteValueUnicodePoint
+
+
+/*!
+Returns true if messages of the given severity would be
+written.  Callers can use this to avoid the cost of
+preparing messages that would be discarded anyway.
+
+(2021.06)
+*/
+Boolean
+__Console_IsSeverityEnabled		(Console_Severity	inSeverity)
+{
+	return (gConsoleInitialized && (STATIC_CAST(inSeverity, int) >= gMinimumSeverity));
+}// IsSeverityEnabled
+
+
+/*!
+Returns true if the call site that owns the given rate
+limit may write another message now.  If so, the number
+of messages that were refused since the last one allowed
+is also returned (and reset), so it can be reported.
+
+Each call site may write a few messages in any 1-second
+window.  This is safe to use from any thread.
+
+(2021.06)
+*/
+Boolean
+__Console_RateLimitAllows	(Console_RateLimit&		inoutLimit,
+							 UInt32*				outSuppressedCountPtr)
+{
+	SInt64 const	kNow = std::chrono::duration_cast< std::chrono::milliseconds >
+							(std::chrono::steady_clock::now().time_since_epoch()).count();
+	SInt64			windowStart = inoutLimit.windowStart.load(std::memory_order_relaxed);
+	Boolean			result = false;
+	
+	
+	// whichever thread notices that the window has ended starts a new one
+	if ((kNow - windowStart) >= kMy_RateLimitWindowMilliseconds)
+	{
+		if (inoutLimit.windowStart.compare_exchange_strong(windowStart, kNow))
+		{
+			inoutLimit.windowCount = 0;
+		}
+	}
+	
+	if (inoutLimit.windowCount.fetch_add(1) < kMy_RateLimitMessagesPerSecond)
 	{
-		Console_WriteValueCharacter(inLabel, STATIC_CAST(inCodePoint, UInt8));
+		*outSuppressedCountPtr = inoutLimit.suppressedCount.exchange(0);
+		result = true;
 	}
 	else
 	{
-		std::ostringstream		s;
-		
-		
-		s << inLabel << " = \\u0x" << std::hex << inCodePoint;
-		
-		std::string		sString = s.str();
-		Console_WriteLine(sString.c_str());
+		++(inoutLimit.suppressedCount);
+		result = false;
 	}
-}// WriteValueUnicodePoint
+	return result;
+}// RateLimitAllows
+
+
+/*!
+Changes the severity of subsequent messages from the
+calling thread, and returns the previous severity.  Use
+a Console_SeverityScope instead of calling this.
+
+(2021.06)
+*/
+Console_Severity
+__Console_SetThreadSeverity		(Console_Severity	inSeverity)
+{
+	Console_Severity	result = gThreadSeverity;
+	
+	
+	gThreadSeverity = inSeverity;
+	return result;
+}// SetThreadSeverity
 
 
 /*!
@@ -751,6 +953,516 @@ __Console_WarningsTriggerCrashTraces ()
 #endif
 }// WarningsTriggerCrashTraces
 
+
+#pragma mark Internal Methods
+namespace {
+
+/*!
+Initializes an empty buffer.
+*/
+My_LogRing::
+My_LogRing ()
+:
+readIndex(0),
+writeIndex(0),
+droppedCount(0)
+{
+}// My_LogRing default constructor
+
+
+/*!
+Initializes the drain state (without starting a thread).
+*/
+My_LogDrain::
+My_LogDrain ()
+:
+lock(),
+wakeCondition(),
+passCondition(),
+rings(),
+passCount(0),
+isWakeRequested(false),
+isDraining(false),
+isStarted(false)
+{
+}// My_LogDrain default constructor
+
+
+/*!
+Copies a message into the buffer of the calling thread, so
+that the drain thread will format and print it later.  The
+message is discarded if the console is not initialized or
+the current severity is filtered out.
+
+Text is a label (or an entire line) and, optionally, a
+second string that is stored after a zero byte.  Text that
+does not fit in one record continues in the next ones; the
+records are published all at once so the drain thread sees
+either the whole message or none of it.
+
+If the buffer is full, the message is counted and dropped;
+logging never waits for the drain thread.
+
+(2021.06)
+*/
+void
+appendRecords	(My_LogRecordKind		inKind,
+				 My_LogValues const&	inValues,
+				 char const*			inText,
+				 char const*			inSecondTextOrNull,
+				 size_t					inSecondTextLength)
+{
+	if (__Console_IsSeverityEnabled(gThreadSeverity))
+	{
+		My_LogRing*		ringPtr = returnThreadRing();
+		size_t const	kFirstTextLength = CPP_STD::strlen(inText);
+		size_t const	kTotalTextLength = kFirstTextLength + ((nullptr == inSecondTextOrNull) ? 0 : (1 + inSecondTextLength));
+		UInt32 const	kRecordCount = std::min< UInt32 >(kMy_LogRecordsPerMessageMaximum,
+															std::max< UInt32 >(1, STATIC_CAST((kTotalTextLength + kMy_LogRecordTextSize - 1)
+																								/ kMy_LogRecordTextSize, UInt32)));
+		UInt32 const	kWriteIndex = ringPtr->writeIndex.load(std::memory_order_relaxed);
+		UInt32 const	kReadIndex = ringPtr->readIndex.load(std::memory_order_acquire);
+		
+		
+		if ((kMy_LogRingRecordCount - (kWriteIndex - kReadIndex)) < kRecordCount)
+		{
+			++(ringPtr->droppedCount);
+		}
+		else
+		{
+			UInt64 const	kSequenceNumber = gNextSequenceNumber.fetch_add(1, std::memory_order_relaxed);
+			SInt16 const	kIndentationLevel = gIndentationLevel;
+			size_t			textOffset = 0; // position in the combined text (first text, zero byte, second text)
+			
+			
+			for (UInt32 i = 0; i < kRecordCount; ++i)
+			{
+				My_LogRecord&	record = ringPtr->records[(kWriteIndex + i) & (kMy_LogRingRecordCount - 1)];
+				UInt16			recordLength = 0;
+				
+				
+				record.sequenceNumber = kSequenceNumber;
+				record.kind = inKind;
+				record.isContinued = ((i + 1) < kRecordCount);
+				record.indentationLevel = kIndentationLevel;
+				record.values = inValues;
+				while ((recordLength < kMy_LogRecordTextSize) && (textOffset < kTotalTextLength))
+				{
+					if (textOffset < kFirstTextLength)
+					{
+						size_t const	kCopySize = std::min< size_t >(kMy_LogRecordTextSize - recordLength,
+																		kFirstTextLength - textOffset);
+						
+						
+						CPP_STD::memcpy(record.text + recordLength, inText + textOffset, kCopySize);
+						recordLength += kCopySize;
+						textOffset += kCopySize;
+					}
+					else if (textOffset == kFirstTextLength)
+					{
+						record.text[recordLength++] = '\0';
+						++textOffset;
+					}
+					else
+					{
+						size_t const	kSecondOffset = textOffset - kFirstTextLength - 1;
+						size_t const	kCopySize = std::min< size_t >(kMy_LogRecordTextSize - recordLength,
+																		inSecondTextLength - kSecondOffset);
+						
+						
+						CPP_STD::memcpy(record.text + recordLength, inSecondTextOrNull + kSecondOffset, kCopySize);
+						recordLength += kCopySize;
+						textOffset += kCopySize;
+					}
+				}
+				record.textLength = recordLength;
+			}
+			
+			// publish the message
+			ringPtr->writeIndex.store(kWriteIndex + kRecordCount, std::memory_order_release);
+			
+			// wake the drain thread (only the first writer notifies, so
+			// that busy threads rarely make system calls; the drain also
+			// wakes up periodically in case the notification is missed)
+			unless (gLogDrain().isWakeRequested.exchange(true))
+			{
+				gLogDrain().wakeCondition.notify_one();
+			}
+		}
+	}
+}// appendRecords
+
+
+/*!
+The body of the thread that prints buffered messages.
+It sleeps until messages are written (or briefly, in
+case a wake-up is missed) and then drains all buffers.
+
+(2021.06)
+*/
+void
+drainLoop ()
+{
+	My_LogDrain&	drain = gLogDrain();
+	
+	
+	gThreadIsDrain = true;
+	while (true)
+	{
+		{
+			std::unique_lock< std::mutex >	drainLock(drain.lock);
+			
+			
+			UNUSED_RETURN(bool)drain.wakeCondition.wait_for(drainLock, std::chrono::milliseconds(kMy_DrainIntervalMilliseconds),
+															[&drain] () { return drain.isWakeRequested.load(); });
+			drain.isWakeRequested = false;
+			drain.isDraining = true;
+		}
+		
+		drainRings();
+		
+		{
+			std::lock_guard< std::mutex >	drainGuard(drain.lock);
+			
+			
+			drain.isDraining = false;
+			++(drain.passCount);
+		}
+		drain.passCondition.notify_all();
+	}
+}// drainLoop
+
+
+/*!
+Formats and prints every message that is in any buffer,
+in the order that the messages were written.  Buffers of
+threads that have exited are released once empty.
+
+(2021.06)
+*/
+void
+drainRings ()
+{
+	My_LogDrain&									drain = gLogDrain();
+	std::vector< My_LogRingPtr >					rings;
+	std::vector< std::pair< UInt64, std::string > >	lines;
+	UInt32											droppedCount = 0;
+	
+	
+	{
+		std::lock_guard< std::mutex >	drainGuard(drain.lock);
+		
+		
+		rings = drain.rings;
+	}
+	
+	for (auto const&	ringPtr : rings)
+	{
+		UInt32 const	kWriteIndex = ringPtr->writeIndex.load(std::memory_order_acquire);
+		UInt32			readIndex = ringPtr->readIndex.load(std::memory_order_relaxed);
+		
+		
+		// (messages are published whole, so continued text is always present)
+		while (readIndex != kWriteIndex)
+		{
+			My_LogRecord const&		firstRecord = ringPtr->records[readIndex & (kMy_LogRingRecordCount - 1)];
+			My_LogRecord const*		recordPtr = &firstRecord;
+			std::string				text(firstRecord.text, firstRecord.textLength);
+			
+			
+			++readIndex;
+			while ((recordPtr->isContinued) && (readIndex != kWriteIndex))
+			{
+				recordPtr = &(ringPtr->records[readIndex & (kMy_LogRingRecordCount - 1)]);
+				text.append(recordPtr->text, recordPtr->textLength);
+				++readIndex;
+			}
+			lines.push_back(std::make_pair(firstRecord.sequenceNumber, formatMessage(firstRecord, text)));
+		}
+		ringPtr->readIndex.store(readIndex, std::memory_order_release);
+		droppedCount += ringPtr->droppedCount.exchange(0);
+	}
+	
+	// messages from different threads are interleaved by age
+	std::sort(lines.begin(), lines.end(),
+				[] (std::pair< UInt64, std::string > const& a, std::pair< UInt64, std::string > const& b)
+				{
+					return (a.first < b.first);
+				});
+	
+	if ((false == lines.empty()) || (droppedCount > 0))
+	{
+		for (auto const&	sequenceAndLine : lines)
+		{
+			std::cerr << "MacTerm: " << sequenceAndLine.second << "\015\012";
+		}
+		if (droppedCount > 0)
+		{
+			std::cerr << "MacTerm: warning, log buffer full; messages dropped = " << droppedCount << "\015\012";
+		}
+		std::cerr.flush();
+	}
+	
+	// release buffers that are no longer owned by any thread
+	{
+		std::lock_guard< std::mutex >	drainGuard(drain.lock);
+		
+		
+		rings.clear();
+		drain.rings.erase(std::remove_if(drain.rings.begin(), drain.rings.end(),
+											[] (My_LogRingPtr const& inRingPtr)
+											{
+												return ((1 == inRingPtr.use_count()) &&
+														(inRingPtr->readIndex.load() == inRingPtr->writeIndex.load()));
+											}),
+							drain.rings.end());
+	}
+}// drainRings
+
+
+/*!
+Returns the text that a message should print, including
+indentation but not the prefix or new-line.  The given
+text is the combined text of all records in the message.
+
+(2021.06)
+*/
+std::string
+formatMessage	(My_LogRecord const&	inFirstRecord,
+				 std::string const&		inText)
+{
+	std::ostringstream	s;
+	size_t const		kLabelEnd = inText.find('\0');
+	std::string const	kLabel = inText.substr(0, kLabelEnd);
+	
+	
+	s << std::string(inFirstRecord.indentationLevel, ' ');
+	if (kMy_LogRecordKindLine == inFirstRecord.kind)
+	{
+		s << inText;
+	}
+	else
+	{
+		s << kLabel << " = ";
+		switch (inFirstRecord.kind)
+		{
+		case kMy_LogRecordKindValue:
+			s << inFirstRecord.values.integers[0];
+			break;
+		
+		case kMy_LogRecordKindValueAddress:
+			s << REINTERPRET_CAST(STATIC_CAST(inFirstRecord.values.integers[0], intptr_t), void const*);
+			break;
+		
+		case kMy_LogRecordKindValueBitFlags:
+			for (SInt16 i = 31; i >= 0; --i)
+			{
+				s << (inFirstRecord.values.integers[0] & (1 << i) ? "1" : "0");
+				if ((i % 4) == 0)
+				{
+					s << " ";
+				}
+			}
+			break;
+		
+		case kMy_LogRecordKindValueCharacter:
+			writeCharacter(s, STATIC_CAST(inFirstRecord.values.integers[0], UInt8));
+			break;
+		
+		case kMy_LogRecordKindValueFloat4:
+			s
+			<< inFirstRecord.values.floats[0] << ", " << inFirstRecord.values.floats[1] << ", "
+			<< inFirstRecord.values.floats[2] << ", " << inFirstRecord.values.floats[3]
+			;
+			break;
+		
+		case kMy_LogRecordKindValueFourChars:
+			writeFourChars(s, STATIC_CAST(inFirstRecord.values.integers[0], FourCharCode));
+			break;
+		
+		case kMy_LogRecordKindValuePair:
+			s << inFirstRecord.values.integers[0] << "," << inFirstRecord.values.integers[1];
+			break;
+		
+		case kMy_LogRecordKindValueString:
+			{
+				std::string const	kValue = (std::string::npos == kLabelEnd) ? std::string() : inText.substr(kLabelEnd + 1);
+				
+				
+				// (a nonzero value means the string is not quoted)
+				if (0 != inFirstRecord.values.integers[0])
+				{
+					s << kValue;
+				}
+				else
+				{
+					s << "\"" << kValue << "\"";
+				}
+			}
+			break;
+		
+		case kMy_LogRecordKindValueUnicode:
+			if (0 == (inFirstRecord.values.integers[0] & 0xFFFFFF00))
+			{
+				writeCharacter(s, STATIC_CAST(inFirstRecord.values.integers[0], UInt8));
+			}
+			else
+			{
+				s << "\\u0x" << std::hex << inFirstRecord.values.integers[0];
+			}
+			break;
+		
+		default:
+			// ???
+			break;
+		}
+	}
+	return s.str();
+}// formatMessage
+
+
+/*!
+Returns values for a message that has up to 2 integers.
+
+(2021.06)
+*/
+My_LogValues
+returnIntegerValues		(SInt64		inValue1,
+						 SInt64		inValue2)
+{
+	My_LogValues	result;
+	
+	
+	result.integers[0] = inValue1;
+	result.integers[1] = inValue2;
+	return result;
+}// returnIntegerValues
+
+
+/*!
+Returns the buffer of the calling thread, creating and
+registering it the first time that the thread logs.  The
+drain thread releases the buffer after the thread exits.
+
+(2021.06)
+*/
+My_LogRing*
+returnThreadRing ()
+{
+	if (nullptr == gThreadRingPtr)
+	{
+		My_LogDrain&					drain = gLogDrain();
+		std::lock_guard< std::mutex >	drainGuard(drain.lock);
+		
+		
+		gThreadRingPtr = std::make_shared< My_LogRing >();
+		drain.rings.push_back(gThreadRingPtr);
+	}
+	return gThreadRingPtr.get();
+}// returnThreadRing
+
+
+/*!
+Tests the minimum severity: less severe messages are
+discarded, and a disabled warning does not even evaluate
+its arguments.
+
+Returns "true" if ALL assertions pass; "false" is
+returned if any fail, however messages should be
+printed for ALL assertion failures regardless.
+
+(2021.06)
+*/
+Boolean
+unitTest000_Begin ()
+{
+	Console_Severity const	kOriginalMinimum = Console_SetMinimumSeverity(kConsole_SeverityError);
+	UInt16					evaluationCount = 0;
+	Boolean					result = true;
+	
+	
+	// assertion failures are errors, so they are still written while this is tested
+	Console_TestAssertUpdate(result, false == __Console_IsSeverityEnabled(kConsole_SeverityInfo),
+								Console_WriteLine, "info should be disabled");
+	Console_TestAssertUpdate(result, false == __Console_IsSeverityEnabled(kConsole_SeverityWarning),
+								Console_WriteLine, "warnings should be disabled");
+	Console_TestAssertUpdate(result, __Console_IsSeverityEnabled(kConsole_SeverityError),
+								Console_WriteLine, "errors should be enabled");
+	Console_Warning(Console_WriteValue, "console test warning (should never appear)", ++evaluationCount);
+	Console_TestAssertUpdate(result, 0 == evaluationCount, Console_WriteValue, "evaluations of disabled warning", evaluationCount);
+	
+	Console_TestAssertUpdate(result, kConsole_SeverityError == Console_SetMinimumSeverity(kConsole_SeverityWarning),
+								Console_WriteLine, "expected the previous minimum to be returned");
+	Console_TestAssertUpdate(result, false == __Console_IsSeverityEnabled(kConsole_SeverityInfo),
+								Console_WriteLine, "info should be disabled");
+	Console_TestAssertUpdate(result, __Console_IsSeverityEnabled(kConsole_SeverityWarning),
+								Console_WriteLine, "warnings should be enabled");
+	
+	UNUSED_RETURN(Console_Severity)Console_SetMinimumSeverity(kOriginalMinimum);
+	Console_TestAssertUpdate(result, __Console_IsSeverityEnabled(kOriginalMinimum),
+								Console_WriteLine, "original minimum should be restored");
+	
+	return result;
+}// unitTest000_Begin
+
+
+/*!
+Writes a character, in particular making control characters
+visible (e.g. "^A").
+
+(2021.06)
+*/
+void
+writeCharacter	(std::ostream&	inoutStream,
+				 UInt8			inCharacter)
+{
+	if (inCharacter < ' '/* space */)
+	{
+		inoutStream << '^' << STATIC_CAST(inCharacter + '@', char);
+	}
+	else if (inCharacter == ' '/* space */)
+	{
+		inoutStream << "<sp>";
+	}
+	else if (inCharacter >= 127)
+	{
+		inoutStream << "<" << STATIC_CAST(inCharacter, unsigned int) << ">";
+	}
+	else
+	{
+		inoutStream << STATIC_CAST(inCharacter, char);
+	}
+}// writeCharacter
+
+
+/*!
+Writes the characters of a four-character code, making
+invisible characters visible.
+
+(2021.06)
+*/
+void
+writeFourChars	(std::ostream&	inoutStream,
+				 FourCharCode	inValue)
+{
+	unsigned char	fourChars[] =
+					{
+						STATIC_CAST(0x000000FFUL & (inValue >> 24), unsigned char),
+						STATIC_CAST(0x000000FFUL & (inValue >> 16), unsigned char),
+						STATIC_CAST(0x000000FFUL & (inValue >> 8), unsigned char),
+						STATIC_CAST(0x000000FFUL & (inValue >> 0), unsigned char),
+					};
+	
+	
+	// write each character in a “printable” fashion
+	for (UInt16 i = 0; i < sizeof(fourChars) / sizeof(*fourChars); ++i)
+	{
+		writeCharacter(inoutStream, fourChars[i]);
+	}
+}// writeFourChars
+
+} // anonymous namespace
+
 #endif /* ifndef NDEBUG */
 
 // BELOW IS REQUIRED NEWLINE TO END FILE
@@ -11,6 +11,11 @@
 	there are also several other specialized variants that make
 	it easy to write comments alongside data that has a common
 	type.
+	
+	Messages are captured in a buffer owned by the calling
+	thread and printed later by a background thread, so that
+	logging costs the caller little more than a copy.  Use
+	Console_Flush() if output must appear immediately.
 */
 /*###############################################################
 
@@ -42,6 +47,7 @@
 #pragma once
 
 // standard-C++ includes
+#include <atomic>
 #include <iosfwd>
 #include <string>
 
@@ -51,6 +57,21 @@
 
 
 
+#pragma mark Constants
+
+/*!
+Importance of a message.  Messages that are less severe than
+the current minimum (see Console_SetMinimumSeverity()) are
+discarded without being formatted.
+*/
+enum Console_Severity
+{
+	kConsole_SeverityDebug		= 0,	//!< detailed tracing
+	kConsole_SeverityInfo		= 1,	//!< ordinary messages; the default for all writes
+	kConsole_SeverityWarning	= 2,	//!< messages from Console_Warning()
+	kConsole_SeverityError		= 3		//!< assertion failures
+};
+
 #pragma mark Types
 
 /*!
@@ -126,6 +147,49 @@ private:
 };
 
 
+/*!
+Tracks how often one call site has written messages
+recently, so that a flood of identical warnings (for
+instance, one per byte of bad input data) does not slow
+down the program.  Console_Warning() declares one of
+these statically at each place it is used.
+*/
+struct Console_RateLimit
+{
+	std::atomic< SInt64 >	windowStart = { 0 };		//!< time that the current 1-second window began, in milliseconds
+	std::atomic< UInt32 >	windowCount = { 0 };		//!< messages written (or attempted) in the current window
+	std::atomic< UInt32 >	suppressedCount = { 0 };	//!< messages discarded since the last one written
+};
+
+
+/*!
+Declare a variable of this type in a block to change the
+severity of all messages written by the current thread
+within that block.  When the block exits, the previous
+severity is restored.
+*/
+struct Console_SeverityScope
+{
+public:
+	inline
+	Console_SeverityScope	(Console_Severity);
+	
+	inline
+	~Console_SeverityScope	();
+
+private:
+	Console_Severity	_previousSeverity;
+};
+
+
+
+//!\name Module Tests
+//@{
+
+void
+	Console_RunTests				();
+
+//@}
 
 //!\name Initialization
 //@{
@@ -140,6 +204,29 @@ void
 
 //@}
 
+//!\name Output Control
+//@{
+
+// WAITS UNTIL EVERYTHING WRITTEN SO FAR (BY ANY THREAD) HAS BEEN PRINTED
+void
+	Console_Flush					();
+
+// MESSAGES LESS SEVERE THAN THIS ARE DISCARDED; RETURNS THE PREVIOUS MINIMUM
+Console_Severity
+	Console_SetMinimumSeverity		(Console_Severity	inMinimumSeverity);
+
+Boolean
+	__Console_IsSeverityEnabled		(Console_Severity	inSeverity);
+
+Boolean
+	__Console_RateLimitAllows		(Console_RateLimit&	inoutLimit,
+									 UInt32*			outSuppressedCountPtr);
+
+Console_Severity
+	__Console_SetThreadSeverity		(Console_Severity	inSeverity);
+
+//@}
+
 //!\name Writing Messages to the Console
 //@{
 
@@ -151,6 +238,10 @@ Boolean
 Boolean
 	__Console_WarningsTriggerCrashTraces	();
 
+// COUNTS EVERY FAILED Console_Assert() (e.g. TO SET THE EXIT STATUS OF A TEST PROGRAM)
+UInt32
+	Console_ReturnAssertionFailureCount		();
+
 inline bool __Console_CrashTraceably ()
 {
 	// force a crash so that backtracing to the offending line is easier
@@ -160,6 +251,7 @@ inline bool __Console_CrashTraceably ()
 }
 inline bool __Console_AssertHelper (char const* t, char const* file, unsigned long line)
 {
+	Console_Flush();
 	UNUSED_RETURN(int)printf("MacTerm: ASSERTION FAILURE: %s [%s:%lu]\n", t, file, line);
 	__Console_CrashTraceably();
 	return false;
@@ -191,11 +283,20 @@ inline bool __Console_AssertHelper (char const* t, char const* file, unsigned lo
 	do { if (false == Console_Assert(#e, (e))) { cumulativeFlag = false; f(args); } } while (0)
 
 // usage: e.g. Console_Warning(Console_WriteValue, "message", 25); // Console_WriteValue("message", 25);
-// the first argument is a function, and all remaining arguments are the function parameters
+// the first argument is a function, and all remaining arguments are the function parameters;
+// each place that this is used may write only a few warnings per second, and any others are
+// counted and reported with the next warning that is written from the same place;
+// the severity is checked first so if warnings are disabled (see Console_SetMinimumSeverity())
+// then nothing else happens: no rate check, no formatting and no evaluation of the arguments
 // IMPORTANT: the "args..." and " , ##" syntax only work in GNU compilers
 #define Console_Warning(f, t, args...)  \
-	do { char s[256]; (int)snprintf(s, sizeof(s), "warning, %s", t); f(s    , ## args); \
-	     if (__Console_WarningsTriggerCrashTraces()) __Console_CrashTraceably(); } while (0)
+	do { if (__Console_IsSeverityEnabled(kConsole_SeverityWarning)) \
+	     { static Console_RateLimit __limit; UInt32 __suppressed = 0; \
+	       if (__Console_RateLimitAllows(__limit, &__suppressed)) \
+	       { Console_SeverityScope __scope(kConsole_SeverityWarning); \
+	         if (__suppressed > 0) Console_WriteValue("warning, identical warnings suppressed", __suppressed); \
+	         char s[256]; (int)snprintf(s, sizeof(s), "warning, %s", t); f(s    , ## args); } \
+	       if (__Console_WarningsTriggerCrashTraces()) { Console_Flush(); __Console_CrashTraceably(); } } } while (0)
 
 void
 	Console_WriteHorizontalRule		();
@@ -364,4 +465,25 @@ Console_BlockTracker::
 	Console_WriteValueCString("Block exited:", _name.c_str());
 }
 
+
+/*!
+Changes the severity of messages from the current thread.
+*/
+Console_SeverityScope::
+Console_SeverityScope	(Console_Severity	inSeverity)
+:
+_previousSeverity(__Console_SetThreadSeverity(inSeverity))
+{
+}
+
+
+/*!
+Restores the previous severity of messages.
+*/
+Console_SeverityScope::
+~Console_SeverityScope ()
+{
+	UNUSED_RETURN(Console_Severity)__Console_SetThreadSeverity(_previousSeverity);
+}
+
 // BELOW IS REQUIRED NEWLINE TO END FILE
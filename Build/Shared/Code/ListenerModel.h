@@ -19,6 +19,11 @@
 	been added to this module as an option, and longer-term
 	any code that supports listeners may change to use Cocoa
 	exclusively.
+	
+	Events can also be posted for later delivery on a queue
+	(by default, the main queue) instead of being delivered
+	immediately; identical events that are still waiting to
+	be delivered can be coalesced into one.
 */
 /*###############################################################
 
@@ -54,6 +59,7 @@
 #	import <Cocoa/Cocoa.h>
 #endif
 #include <CoreServices/CoreServices.h>
+#include <dispatch/dispatch.h>
 
 // library includes
 #include <Console.h>
@@ -70,7 +76,9 @@ enum ListenerModel_Result
 {
 	kListenerModel_ResultOK							= 0,	//!< no error occurred
 	kListenerModel_ResultInvalidModelReference		= 1,	//!< listener model is not recognized
-	kListenerModel_ResultInvalidListenerReference	= 2		//!< listener is not recognized
+	kListenerModel_ResultInvalidListenerReference	= 2,	//!< listener is not recognized
+	kListenerModel_ResultEventCoalesced				= 3,	//!< event was not posted because an identical one is pending
+	kListenerModel_ResultUnsupportedStyle			= 4		//!< operation is not allowed for the style of the model
 };
 
 /*!
@@ -274,6 +282,21 @@ ListenerModel_Result
 
 //@}
 
+//!\name Deferred Notification
+//@{
+
+ListenerModel_Result
+	ListenerModel_PostEvent					(ListenerModel_Ref				inForWhichModel,
+											 ListenerModel_Event			inEventThatOccurred,
+											 void*							inContextPtr,
+											 Boolean						inCoalesce = true);
+
+ListenerModel_Result
+	ListenerModel_SetDeliveryQueue			(ListenerModel_Ref				inForWhichModel,
+											 dispatch_queue_t				inQueueOrNullForMainQueue);
+
+//@}
+
 //!\name Accessing Listeners
 //@{
 
@@ -31,11 +31,14 @@
 
 // standard-C++ includes
 #import <algorithm>
-#import <map>
+#import <memory>
+#import <mutex>
 #import <vector>
 
 // library includes
-#import <CocoaExtensions.objc++.h>
+#ifdef __OBJC__
+#	import <CocoaExtensions.objc++.h>
+#endif
 #import <Console.h>
 #import <MemoryBlockPtrLocker.template.h>
 #import <MemoryBlockReferenceLocker.template.h>
@@ -69,9 +72,94 @@ enum
 #pragma mark Types
 namespace {
 
-typedef std::vector< ListenerModel_ListenerRef >			My_ListenerList;
-typedef My_ListenerList*									My_ListenerListPtr;
-typedef std::map< ListenerModel_Event, My_ListenerListPtr >	My_EventToListenerListPtrMap;
+/*!
+A listener as seen by a notification: everything needed to
+invoke it is copied when it is added to a model, so that
+notifying requires no per-listener locks or lookups.  The
+reference is kept to confirm validity, if any listener has
+been destroyed since the list was built.
+*/
+struct My_ListenerEntry
+{
+	ListenerModel_ListenerRef	listenerRef;	// the listener that was added
+	void*						context;		// copy of the listener’s context
+	union
+	{
+		ListenerModel_BooleanProcPtr	boolean;
+		ListenerModel_StandardProcPtr	standard;
+	} callback;		// copy of the listener’s function
+};
+
+/*!
+An immutable snapshot of the listeners for one event.  Changes
+to a model replace the snapshot instead of modifying it, so a
+notification in progress (which holds its own reference to the
+snapshot) is never disturbed by listeners that add or remove
+listeners, even for the same event.
+*/
+struct My_ListenerList
+{
+	std::vector< My_ListenerEntry >		entries;					// listeners in the order they were added
+	UInt32								validatedDestructionCount;	// value of "gListenerDestructionCount" when all
+																	// entries were known to be valid listeners
+};
+typedef std::shared_ptr< My_ListenerList const >	My_ListenerListConstPtr;
+
+/*!
+The listeners for one event in a model.  Models store these
+in a flat array sorted by event.
+*/
+struct My_EventListeners
+{
+	ListenerModel_Event			event;		// the event these listeners are for
+	My_ListenerListConstPtr		listPtr;	// current snapshot of listeners; never nullptr
+};
+typedef std::vector< My_EventListeners >	My_EventListenersList;
+
+/*!
+An event that was posted with ListenerModel_PostEvent() and
+has not been delivered yet.
+*/
+struct My_PendingEvent
+{
+	ListenerModel_Event		event;		// event to deliver
+	void*					context;	// event context to deliver
+	Boolean					coalesce;	// true if identical posts may be merged into this one
+};
+
+/*!
+Information needed to deliver events later.  This is shared
+between a model and the callbacks that will deliver its
+events, so that a callback that runs after the model is disposed can
+safely do nothing.  Posting may occur on any thread so the
+data is protected by a mutex.
+*/
+struct My_DeliveryState
+{
+	inline
+	My_DeliveryState ();
+	
+	inline
+	~My_DeliveryState ();
+	
+	std::mutex						lock;				// protects all members
+	dispatch_queue_t				queue;				// queue for deliveries; nullptr means main queue
+	std::vector< My_PendingEvent >	pendingEvents;		// events that are not yet delivered, in order
+	Boolean							isModelDisposed;	// true if deliveries must be discarded
+};
+typedef std::shared_ptr< My_DeliveryState >		My_DeliveryStatePtr;
+
+/*!
+Context for one call to deliverPendingEvent(), allocated
+when an event is posted and deleted once it is delivered.
+(A function is queued instead of a block so that this
+module can be built without block support.)
+*/
+struct My_PendingDelivery
+{
+	ListenerModel_Ref		model;		// model that posted the event
+	My_DeliveryStatePtr		delivery;	// keeps the delivery state alive until the callback runs
+};
 
 typedef MemoryBlockReferenceTracker< ListenerModel_Ref >			ListenerModelRefTracker;
 typedef Registrar< ListenerModel_Ref, ListenerModelRefTracker >		ListenerModelRefRegistrar;
@@ -81,11 +169,21 @@ struct ListenerModel
 	inline
 	ListenerModel ();
 	
+	inline
+	~ListenerModel ();
+	
+	My_ListenerListConstPtr
+	returnListeners		(ListenerModel_Event) const;
+	
+	void
+	setListeners		(ListenerModel_Event, My_ListenerListConstPtr const&);
+	
 	ListenerModelRefRegistrar		refValidator;			// ensures this reference is recognized as a valid one
 	ListenerModel_Descriptor		descriptor;				// user-defined identifier for this model
 	ListenerModelBehavior			notificationBehavior;	// a "kListenerModelBehavior..." constant describing how to notify listeners
 	ListenerModelCallbackType		callbackType;			// what kind all listeners must be
-	My_EventToListenerListPtrMap	eventListeners;			// associative array of one or more "Listener" structures per event type
+	My_EventListenersList			eventListeners;			// listeners for each event type, sorted by event
+	My_DeliveryStatePtr				delivery;				// used by ListenerModel_PostEvent()
 };
 typedef ListenerModel*		ListenerModelPtr;
 
@@ -121,9 +219,19 @@ typedef MemoryBlockReferenceLocker< ListenerModel_ListenerRef, Listener >	Listen
 #pragma mark Internal Method Prototypes
 namespace {
 
-void		objectiveCStandardListener	(ListenerModel_Ref, ListenerModel_Event, void*, void*);
-Boolean		unitTest000_Begin			();
-void		unitTest000_Callback1		(ListenerModel_Ref, ListenerModel_Event, void*, void*);
+void						deliverPendingEvent			(void*);
+Boolean						isListenerEntryValid		(My_ListenerEntry const&, My_ListenerList const&);
+#ifdef __OBJC__
+void						objectiveCStandardListener	(ListenerModel_Ref, ListenerModel_Event, void*, void*);
+#endif
+My_ListenerListConstPtr		removeDestroyedListeners	(ListenerModelPtr, ListenerModel_Event, My_ListenerListConstPtr const&);
+Boolean						unitTest000_Begin			();
+void						unitTest000_Callback1		(ListenerModel_Ref, ListenerModel_Event, void*, void*);
+Boolean						unitTest001_Begin			();
+void						unitTest001_Callback1		(ListenerModel_Ref, ListenerModel_Event, void*, void*);
+void						unitTest001_FlushQueue		(void*);
+Boolean						unitTest002_Begin			();
+void						unitTest002_Callback1		(ListenerModel_Ref, ListenerModel_Event, void*, void*);
 
 } // anonymous namespace
 
@@ -135,128 +243,17 @@ ListenerModelRefTracker&	gListenerModelValidRefs ()	{ static ListenerModelRefTra
 ListenerPtrLocker&			gListenerPtrLocks ()		{ static ListenerPtrLocker x; return x; }
 ListenerReferenceLocker&	gListenerRefLocks ()		{ static ListenerReferenceLocker x; return x; }
 ListenerReferenceTracker&	gListenerValidRefs ()		{ static ListenerReferenceTracker x; return x; }
+UInt32						gListenerDestructionCount = 0;	// incremented whenever any listener is destroyed
 SInt32						gUnitTest000_CallCount = 0;
 ListenerModel_Ref			gUnitTest000_Model = nullptr;
 Boolean						gUnitTest000_Result = false;
+SInt32						gUnitTest001_CallCount = 0;
+ListenerModel_ListenerRef	gUnitTest001_ListenerToRemove = nullptr;
+UInt32						gUnitTest002_CallCount = 0;
 
 } // anonymous namespace
 
 
-#pragma mark Functors
-
-/*!
-This is a functor designed to invoke a listener
-of the Boolean type (that is, it has a return
-value of true or false).
-
-Model of STL Predicate.
-
-(1.0)
-*/
-#pragma mark booleanListenerInvoker
-class booleanListenerInvoker:
-public std::unary_function< My_EventToListenerListPtrMap::value_type/* argument */, bool/* return */ >
-{
-public:
-	booleanListenerInvoker		(ListenerModel_Ref		inForWhichModel,
-								 ListenerModel_Event	inEventThatOccurred,
-								 void*					inEventContextPtr)
-	: _model(inForWhichModel), _event(inEventThatOccurred), _context(inEventContextPtr), _anyInvalidListeners(false)
-	{
-	}
-	
-	bool
-	operator()	(ListenerModel_ListenerRef	inListener)
-	{
-		ListenerAutoLocker	listenerPtr(gListenerPtrLocks(), inListener);
-		bool				result = false;
-		
-		
-		if (gListenerValidRefs().end() == gListenerValidRefs().find(inListener))
-		{
-			Console_Warning(Console_WriteValueAddress, "attempt to notify nonexistent Boolean listener",
-							inListener);
-		}
-		else
-		{
-			result = ListenerModel_InvokeBooleanProc(listenerPtr->callback.boolean, _model, _event,
-														_context, listenerPtr->context);
-		}
-		return result;
-	}
-	
-	bool
-	anyInvalidListeners () const
-	{
-		return _anyInvalidListeners;
-	}
-
-protected:
-
-private:
-	ListenerModel_Ref		_model;
-	ListenerModel_Event		_event;
-	void*					_context;
-	bool					_anyInvalidListeners;
-};
-
-
-/*!
-This is a functor designed to invoke a listener
-of the Standard type (that is, it has no return
-value).
-
-Model of STL Unary Function.
-
-(1.0)
-*/
-#pragma mark standardListenerInvoker
-class standardListenerInvoker:
-public std::unary_function< My_EventToListenerListPtrMap::value_type/* argument */, void/* return */ >
-{
-public:
-	standardListenerInvoker		(ListenerModel_Ref		inForWhichModel,
-								 ListenerModel_Event	inEventThatOccurred,
-								 void*					inEventContextPtr)
-	: _model(inForWhichModel), _event(inEventThatOccurred), _context(inEventContextPtr), _anyInvalidListeners(false)
-	{
-	}
-	
-	void
-	operator()	(ListenerModel_ListenerRef	inListener)
-	{
-		ListenerAutoLocker	listenerPtr(gListenerPtrLocks(), inListener);
-		
-		
-		if (gListenerValidRefs().end() == gListenerValidRefs().find(inListener))
-		{
-			Console_Warning(Console_WriteValueAddress, "attempt to notify nonexistent standard listener",
-							inListener);
-		}
-		else
-		{
-			ListenerModel_InvokeStandardProc(listenerPtr->callback.standard, _model, _event,
-												_context, listenerPtr->context);
-		}
-	}
-	
-	bool
-	anyInvalidListeners () const
-	{
-		return _anyInvalidListeners;
-	}
-
-protected:
-
-private:
-	ListenerModel_Ref		_model;
-	ListenerModel_Event		_event;
-	void*					_context;
-	bool					_anyInvalidListeners;
-};
-
-
-
 #pragma mark Public Methods
 
 /*!
@@ -277,6 +274,8 @@ ListenerModel_RunTests ()
 	
 	
 	++totalTests; if (false == unitTest000_Begin()) ++failedTests;
+	++totalTests; if (false == unitTest001_Begin()) ++failedTests;
+	++totalTests; if (false == unitTest002_Begin()) ++failedTests;
 	
 	Console_WriteUnitTestReport("ListenerModel", failedTests, totalTests);
 }// RunTests
@@ -453,7 +452,7 @@ void
 ListenerModel_RetainListener	(ListenerModel_ListenerRef		inRef)
 {
 	if ((nullptr == inRef) ||
-		(gListenerValidRefs().end() == gListenerValidRefs().find(inRef)))
+		(false == gListenerValidRefs().contains(inRef)))
 	{
 		Console_Warning(Console_WriteValueAddress, "attempt to retain a nonexistent listener", inRef);
 	}
@@ -482,7 +481,7 @@ ListenerModel_ReleaseListener	(ListenerModel_ListenerRef*		inoutRefPtr)
 	if (nullptr != inoutRefPtr)
 	{
 		if ((nullptr == *inoutRefPtr) ||
-			(gListenerValidRefs().end() == gListenerValidRefs().find(*inoutRefPtr)))
+			(false == gListenerValidRefs().contains(*inoutRefPtr)))
 		{
 			Console_Warning(Console_WriteValueAddress, "attempt to release a nonexistent listener",
 							*inoutRefPtr);
@@ -493,6 +492,10 @@ ListenerModel_ReleaseListener	(ListenerModel_ListenerRef*		inoutRefPtr)
 			unless (gListenerRefLocks().isLocked(*inoutRefPtr))
 			{
 				delete (REINTERPRET_CAST(*inoutRefPtr, Listener*));
+				
+				// models may still refer to this listener; the change in
+				// count tells them to check their listeners before use
+				++gListenerDestructionCount;
 			}
 		}
 		*inoutRefPtr = nullptr;
@@ -547,32 +550,32 @@ ListenerModel_AddListenerForEvent	(ListenerModel_Ref			inToWhichModel,
 			}
 			else
 			{
-				if (ptr->eventListeners.end() == ptr->eventListeners.find(inForWhichEvent))
+				// replace the snapshot of listeners for this event
+				// with a copy that includes the new listener
+				try
 				{
-					// list does not yet exist - create it
-					try
-					{
-						My_ListenerList*	newListPtr = new My_ListenerList();
-						
-						
-						ptr->eventListeners.insert(My_EventToListenerListPtrMap::value_type(inForWhichEvent, newListPtr));
-						assert(ptr->eventListeners.end() != ptr->eventListeners.find(inForWhichEvent));
-					}
-					catch (std::bad_alloc)
+					My_ListenerListConstPtr				oldListPtr = ptr->returnListeners(inForWhichEvent);
+					std::shared_ptr< My_ListenerList >	newListPtr = (nullptr == oldListPtr)
+																	? std::make_shared< My_ListenerList >()
+																	: std::make_shared< My_ListenerList >(*oldListPtr);
+					My_ListenerEntry					newEntry;
+					
+					
+					newEntry.listenerRef = inListenerToAdd;
+					newEntry.context = listenerPtr->context;
+					newEntry.callback.standard = listenerPtr->callback.standard; // (copies either union member)
+					if (nullptr == oldListPtr)
 					{
-						// not enough memory?!?!?
+						newListPtr->validatedDestructionCount = gListenerDestructionCount;
 					}
+					newListPtr->entries.push_back(newEntry);
+					ptr->setListeners(inForWhichEvent, newListPtr);
 				}
-				if ((ptr->eventListeners.end() == ptr->eventListeners.find(inForWhichEvent)) ||
-						(nullptr == ptr->eventListeners[inForWhichEvent]))
+				catch (std::bad_alloc)
 				{
+					// not enough memory?!?!?
 					result = false;
 				}
-				else
-				{
-					// add to the sequence of callbacks for this event
-					ptr->eventListeners[inForWhichEvent]->push_back(inListenerToAdd);
-				}
 			}
 		}
 	}
@@ -613,14 +616,14 @@ ListenerModel_IsAnyListenerForEvent		(ListenerModel_Ref		inForWhichModel,
 										 ListenerModel_Event	inEventThatOccurred)
 {
 	ListenerModelAutoLocker		ptr(gListenerModelPtrLocks(), inForWhichModel);
-	auto						toEventToListenerListPtr = ptr->eventListeners.find(inEventThatOccurred);
+	My_ListenerListConstPtr		listPtr = ptr->returnListeners(inEventThatOccurred);
 	Boolean						result = false;
 	
 	
-	if (ptr->eventListeners.end() != toEventToListenerListPtr)
+	if (nullptr != listPtr)
 	{
 		// are any listeners in this list?
-		result = (false == toEventToListenerListPtr->second->empty());
+		result = (false == listPtr->entries.empty());
 	}
 	return result;
 }// IsAnyListenerForEvent
@@ -677,8 +680,12 @@ if "inForWhichModel" is not valid
 if some listener found in the model is no longer valid;
 this does not prevent remaining listeners from being
 considered, it is purely an informational return value
-(but in the future, this routine may automatically remove
-listeners found to be invalid)
+(such listeners are removed from the model automatically)
+
+Listeners may add or remove listeners (even themselves)
+during notification; that does not affect the current
+notification, except that a listener destroyed along the
+way is not invoked.
 
 (1.1)
 */
@@ -693,7 +700,7 @@ ListenerModel_NotifyListenersOfEvent	(ListenerModel_Ref		inForWhichModel,
 	
 	
 	if ((nullptr == ptr) ||
-		(gListenerModelValidRefs().end() == gListenerModelValidRefs().find(inForWhichModel)))
+		(false == gListenerModelValidRefs().contains(inForWhichModel)))
 	{
 		Console_Warning(Console_WriteValueFourChars, "attempt to notify listeners in nonexistent model of event",
 						inEventThatOccurred);
@@ -701,66 +708,70 @@ ListenerModel_NotifyListenersOfEvent	(ListenerModel_Ref		inForWhichModel,
 	}
 	else
 	{
-		switch (ptr->callbackType)
+		// the snapshot is held until all listeners are notified; so if
+		// listeners change the model, they affect only later notifications
+		My_ListenerListConstPtr		listPtr = ptr->returnListeners(inEventThatOccurred);
+		
+		
+		if ((nullptr != listPtr) && (listPtr->validatedDestructionCount != gListenerDestructionCount))
 		{
-		case kListenerModelCallbackTypeStandard:
+			// some listener somewhere has been destroyed since this list
+			// was last checked; remove any that were in this model
+			My_ListenerListConstPtr		checkedListPtr = removeDestroyedListeners(ptr, inEventThatOccurred, listPtr);
+			
+			
+			if (checkedListPtr->entries.size() != listPtr->entries.size())
 			{
-				auto	toEventToListenerListPtr = ptr->eventListeners.find(inEventThatOccurred);
-				
-				
-				if (ptr->eventListeners.end() != toEventToListenerListPtr)
+				result = kListenerModel_ResultInvalidListenerReference;
+			}
+			listPtr = checkedListPtr;
+		}
+		
+		if (nullptr != listPtr)
+		{
+			switch (ptr->callbackType)
+			{
+			case kListenerModelCallbackTypeStandard:
+				// invoke each Standard listener in turn
+				for (auto const&	listenerEntry : listPtr->entries)
 				{
-					standardListenerInvoker		perListenerFunction(inForWhichModel, inEventThatOccurred,
-																	inEventContextPtr);
-					
-					
-					// invoke each Standard listener in turn
-					perListenerFunction = std::for_each(toEventToListenerListPtr->second->begin(),
-														toEventToListenerListPtr->second->end(), perListenerFunction);
-					
-					if (perListenerFunction.anyInvalidListeners())
+					// (a listener may destroy others as it is notified)
+					if (isListenerEntryValid(listenerEntry, *listPtr))
 					{
-						result = kListenerModel_ResultInvalidListenerReference;
+						ListenerModel_InvokeStandardProc(listenerEntry.callback.standard, inForWhichModel, inEventThatOccurred,
+															inEventContextPtr, listenerEntry.context);
 					}
 				}
-			}
-			break;
-		
-		case kListenerModelCallbackTypeBoolean:
-			{
-				auto	toEventToListenerListPtr = ptr->eventListeners.find(inEventThatOccurred);
-				
-				
-				if (ptr->eventListeners.end() != toEventToListenerListPtr)
+				break;
+			
+			case kListenerModelCallbackTypeBoolean:
 				{
-					// invoke each Boolean listener and stop as soon as one returns true;
-					// the fact that the callback invoker is modeled as a Predicate allows
-					// the STL find_if() algorithm to be exploited to do the right thing here
-					booleanListenerInvoker		perListenerFunction(inForWhichModel, inEventThatOccurred,
-																			inEventContextPtr);
-					auto						toListener = std::find_if(toEventToListenerListPtr->second->begin(),
-																			toEventToListenerListPtr->second->end(),
-																			perListenerFunction);
-					Boolean						someListenerReturnedTrue = false;
+					Boolean		someListenerReturnedTrue = false;
 					
 					
-					someListenerReturnedTrue = (toEventToListenerListPtr->second->end() != toListener);
-					if (nullptr != outReturnValuePtrOrNull)
+					// invoke each Boolean listener and stop as soon as one returns true
+					for (auto const&	listenerEntry : listPtr->entries)
 					{
-						*(REINTERPRET_CAST(outReturnValuePtrOrNull, Boolean*)) = someListenerReturnedTrue;
+						if (isListenerEntryValid(listenerEntry, *listPtr) &&
+							ListenerModel_InvokeBooleanProc(listenerEntry.callback.boolean, inForWhichModel, inEventThatOccurred,
+															inEventContextPtr, listenerEntry.context))
+						{
+							someListenerReturnedTrue = true;
+							break;
+						}
 					}
 					
-					if (perListenerFunction.anyInvalidListeners())
+					if (nullptr != outReturnValuePtrOrNull)
 					{
-						result = kListenerModel_ResultInvalidListenerReference;
+						*(REINTERPRET_CAST(outReturnValuePtrOrNull, Boolean*)) = someListenerReturnedTrue;
 					}
 				}
+				break;
+			
+			default:
+				// ???
+				break;
 			}
-			break;
-		
-		default:
-			// ???
-			break;
 		}
 	}
 	
@@ -768,6 +779,113 @@ ListenerModel_NotifyListenersOfEvent	(ListenerModel_Ref		inForWhichModel,
 }// NotifyListenersOfEvent
 
 
+/*!
+Arranges for ListenerModel_NotifyListenersOfEvent() to be
+called later with the given event and context, on the
+delivery queue of the model (by default, the main queue;
+see ListenerModel_SetDeliveryQueue()).  Unlike other
+routines in this module, this may be called from any
+thread.
+
+If "inCoalesce" is true and the same event with the same
+context was posted with coalescing and is still waiting
+to be delivered, nothing new is posted: listeners see one
+notification instead of several.  This is appropriate for
+events that only mean “something changed, look again”.
+Since delivery occurs later, the context must remain valid
+until then.
+
+Events are discarded if the model is disposed of before
+they are due.  Only standard-style models support posting,
+since there is nowhere to return a value.
+
+\retval kListenerModel_ResultOK
+if the event will be delivered
+
+\retval kListenerModel_ResultEventCoalesced
+if an identical pending event will be delivered instead
+
+\retval kListenerModel_ResultInvalidModelReference
+if "inForWhichModel" is not valid
+
+\retval kListenerModel_ResultUnsupportedStyle
+if "inForWhichModel" is not a standard-style model
+
+(2021.06)
+*/
+ListenerModel_Result
+ListenerModel_PostEvent		(ListenerModel_Ref		inForWhichModel,
+							 ListenerModel_Event	inEventThatOccurred,
+							 void*					inEventContextPtr,
+							 Boolean				inCoalesce)
+{
+	// NOTE: since this may be called from any thread, the model is not
+	// locked or validated here (neither operation is thread-safe); the
+	// caller must ensure that the model is not being disposed of
+	ListenerModelPtr		ptr = REINTERPRET_CAST(inForWhichModel, ListenerModelPtr);
+	ListenerModel_Result	result = kListenerModel_ResultOK;
+	
+	
+	if (nullptr == ptr)
+	{
+		result = kListenerModel_ResultInvalidModelReference;
+	}
+	else if (kListenerModelCallbackTypeStandard != ptr->callbackType)
+	{
+		result = kListenerModel_ResultUnsupportedStyle;
+	}
+	else
+	{
+		My_DeliveryStatePtr		deliveryPtr = ptr->delivery;
+		dispatch_queue_t		targetQueue = nullptr;
+		
+		
+		{
+			std::lock_guard< std::mutex >	deliveryGuard(deliveryPtr->lock);
+			
+			
+			if (inCoalesce)
+			{
+				auto	toPendingEvent = std::find_if(deliveryPtr->pendingEvents.begin(), deliveryPtr->pendingEvents.end(),
+														[=](My_PendingEvent const& inPendingEvent)
+														{
+															return ((inPendingEvent.coalesce) &&
+																	(inEventThatOccurred == inPendingEvent.event) &&
+																	(inEventContextPtr == inPendingEvent.context));
+														});
+				
+				
+				if (deliveryPtr->pendingEvents.end() != toPendingEvent)
+				{
+					result = kListenerModel_ResultEventCoalesced;
+				}
+			}
+			
+			if (kListenerModel_ResultOK == result)
+			{
+				My_PendingEvent		newEvent;
+				
+				
+				newEvent.event = inEventThatOccurred;
+				newEvent.context = inEventContextPtr;
+				newEvent.coalesce = inCoalesce;
+				deliveryPtr->pendingEvents.push_back(newEvent);
+				targetQueue = deliveryPtr->queue;
+			}
+		}
+		
+		if (kListenerModel_ResultOK == result)
+		{
+			// each callback delivers the oldest pending event; as long as
+			// the queue is serial, events arrive in the order posted
+			dispatch_async_f((nullptr != targetQueue) ? targetQueue : dispatch_get_main_queue(),
+								new My_PendingDelivery{ inForWhichModel, deliveryPtr }, deliverPendingEvent);
+		}
+	}
+	return result;
+}// PostEvent
+
+
 /*!
 Removes a callback routine from the given model, so it will no
 longer be invoked when ListenerModel_NotifyListenersOfEvent() is
@@ -799,14 +917,14 @@ ListenerModel_RemoveListenerForEvent	(ListenerModel_Ref			inFromWhichModel,
 	
 	
 	if ((nullptr == ptr) ||
-		(gListenerModelValidRefs().end() == gListenerModelValidRefs().find(inFromWhichModel)))
+		(false == gListenerModelValidRefs().contains(inFromWhichModel)))
 	{
 		Console_Warning(Console_WriteValueFourChars, "attempt to remove listener from nonexistent model for event",
 						inForWhichEvent);
 		result = kListenerModel_ResultInvalidModelReference;
 	}
 	else if ((nullptr == inListenerToRemove) ||
-				(gListenerValidRefs().end() == gListenerValidRefs().find(inListenerToRemove)))
+				(false == gListenerValidRefs().contains(inListenerToRemove)))
 	{
 		Console_Warning(Console_WriteValueFourChars, "attempt to remove nonexistent listener for event",
 						inForWhichEvent);
@@ -814,17 +932,24 @@ ListenerModel_RemoveListenerForEvent	(ListenerModel_Ref			inFromWhichModel,
 	}
 	else
 	{
-		auto	toEventToListenerListPtr = ptr->eventListeners.find(inForWhichEvent);
+		My_ListenerListConstPtr		oldListPtr = ptr->returnListeners(inForWhichEvent);
 		
 		
-		if (ptr->eventListeners.end() != toEventToListenerListPtr)
+		if (nullptr != oldListPtr)
 		{
-			My_EventToListenerListPtrMap::mapped_type	listenerListPtr = toEventToListenerListPtr->second;
+			// replace the snapshot of listeners for this event with a copy
+			// that has no occurrences of the given listener (notifications
+			// that are in progress continue to use the original snapshot)
+			std::shared_ptr< My_ListenerList >	newListPtr = std::make_shared< My_ListenerList >(*oldListPtr);
 			
 			
-			// delete occurrences of the given listener in the list for this event
-			listenerListPtr->erase(std::remove(listenerListPtr->begin(), listenerListPtr->end(), inListenerToRemove),
-									listenerListPtr->end());
+			newListPtr->entries.erase(std::remove_if(newListPtr->entries.begin(), newListPtr->entries.end(),
+														[=](My_ListenerEntry const& inEntry)
+														{
+															return (inListenerToRemove == inEntry.listenerRef);
+														}),
+										newListPtr->entries.end());
+			ptr->setListeners(inForWhichEvent, newListPtr);
 		}
 	}
 	
@@ -832,6 +957,53 @@ ListenerModel_RemoveListenerForEvent	(ListenerModel_Ref			inFromWhichModel,
 }// RemoveListenerForEvent
 
 
+/*!
+Specifies the queue that delivers events posted with
+ListenerModel_PostEvent() from now on (the default is the
+main queue).  Listeners are invoked on this queue so it
+must be a serial queue, and it must be the only place
+where the model is used because models are not otherwise
+thread-safe.
+
+\retval kListenerModel_ResultOK
+if no errors occur
+
+\retval kListenerModel_InvalidModelReference
+if "inForWhichModel" is not valid
+
+(2021.06)
+*/
+ListenerModel_Result
+ListenerModel_SetDeliveryQueue	(ListenerModel_Ref		inForWhichModel,
+								 dispatch_queue_t		inQueueOrNullForMainQueue)
+{
+	ListenerModelAutoLocker		ptr(gListenerModelPtrLocks(), inForWhichModel);
+	ListenerModel_Result		result = kListenerModel_ResultOK;
+	
+	
+	if (nullptr == ptr)
+	{
+		result = kListenerModel_ResultInvalidModelReference;
+	}
+	else
+	{
+		std::lock_guard< std::mutex >	deliveryGuard(ptr->delivery->lock);
+		
+		
+		if (nullptr != inQueueOrNullForMainQueue)
+		{
+			dispatch_retain(inQueueOrNullForMainQueue);
+		}
+		if (nullptr != ptr->delivery->queue)
+		{
+			dispatch_release(ptr->delivery->queue);
+		}
+		ptr->delivery->queue = inQueueOrNullForMainQueue;
+	}
+	return result;
+}// SetDeliveryQueue
+
+
 #pragma mark Internal Methods
 namespace {
 
@@ -865,11 +1037,222 @@ refValidator(REINTERPRET_CAST(this, ListenerModel_Ref), gListenerModelValidRefs(
 descriptor(kListenerModel_InvalidDescriptor),
 notificationBehavior(kListenerModelBehaviorNotifyAllSequentially),
 callbackType(kListenerModelCallbackTypeStandard),
-eventListeners()
+eventListeners(),
+delivery(std::make_shared< My_DeliveryState >())
 {
 }// ListenerModel default constructor
 
 
+/*!
+Destructor.  Any events that were posted but not yet
+delivered are discarded.
+*/
+ListenerModel::
+~ListenerModel ()
+{
+	std::lock_guard< std::mutex >	deliveryGuard(delivery->lock);
+	
+	
+	// blocks that are still queued share this state and will see the flag
+	delivery->isModelDisposed = true;
+	delivery->pendingEvents.clear();
+}// ListenerModel destructor
+
+
+/*!
+Returns the current snapshot of listeners for the given
+event, or nullptr if no listener was ever added for it.
+The snapshot never changes, even if the model does.
+
+(2021.06)
+*/
+My_ListenerListConstPtr
+ListenerModel::
+returnListeners		(ListenerModel_Event	inEvent)
+const
+{
+	My_ListenerListConstPtr		result;
+	auto						toEventListeners = std::lower_bound(eventListeners.begin(), eventListeners.end(), inEvent,
+																	[](My_EventListeners const& inElement, ListenerModel_Event inKey)
+																	{
+																		return (inElement.event < inKey);
+																	});
+	
+	
+	if ((eventListeners.end() != toEventListeners) && (inEvent == toEventListeners->event))
+	{
+		result = toEventListeners->listPtr;
+	}
+	return result;
+}// returnListeners
+
+
+/*!
+Replaces the snapshot of listeners for the given event,
+keeping the array of events sorted.
+
+(2021.06)
+*/
+void
+ListenerModel::
+setListeners	(ListenerModel_Event				inEvent,
+				 My_ListenerListConstPtr const&		inListPtr)
+{
+	auto	toEventListeners = std::lower_bound(eventListeners.begin(), eventListeners.end(), inEvent,
+												[](My_EventListeners const& inElement, ListenerModel_Event inKey)
+												{
+													return (inElement.event < inKey);
+												});
+	
+	
+	if ((eventListeners.end() != toEventListeners) && (inEvent == toEventListeners->event))
+	{
+		toEventListeners->listPtr = inListPtr;
+	}
+	else
+	{
+		My_EventListeners	newElement;
+		
+		
+		newElement.event = inEvent;
+		newElement.listPtr = inListPtr;
+		eventListeners.insert(toEventListeners, newElement);
+	}
+}// setListeners
+
+
+/*!
+Initializes delivery state for a model that has not
+posted any events.
+*/
+My_DeliveryState::
+My_DeliveryState ()
+:
+lock(),
+queue(nullptr),
+pendingEvents(),
+isModelDisposed(false)
+{
+}// My_DeliveryState default constructor
+
+
+/*!
+Destructor.  Releases the delivery queue, if any.
+*/
+My_DeliveryState::
+~My_DeliveryState ()
+{
+	if (nullptr != queue)
+	{
+		dispatch_release(queue);
+	}
+}// My_DeliveryState destructor
+
+
+/*!
+Invoked on the delivery queue of a model once for each
+event posted by ListenerModel_PostEvent(); notifies
+listeners of the oldest pending event, unless the model
+has since been disposed of.
+
+The context is a "My_PendingDelivery*", which is deleted.
+
+(2021.06)
+*/
+void
+deliverPendingEvent		(void*		inPendingDeliveryPtr)
+{
+	std::unique_ptr< My_PendingDelivery >	pendingDeliveryPtr(STATIC_CAST(inPendingDeliveryPtr, My_PendingDelivery*));
+	ListenerModel_Ref						inForWhichModel = pendingDeliveryPtr->model;
+	My_DeliveryStatePtr const&				inDeliveryPtr = pendingDeliveryPtr->delivery;
+	Boolean									isDue = false;
+	My_PendingEvent							pendingEvent;
+	
+	
+	{
+		std::lock_guard< std::mutex >	deliveryGuard(inDeliveryPtr->lock);
+		
+		
+		if ((false == inDeliveryPtr->isModelDisposed) && (false == inDeliveryPtr->pendingEvents.empty()))
+		{
+			pendingEvent = inDeliveryPtr->pendingEvents.front();
+			inDeliveryPtr->pendingEvents.erase(inDeliveryPtr->pendingEvents.begin());
+			isDue = true;
+		}
+	}
+	
+	// the lock is not held while listeners run, so they can post more events
+	if (isDue)
+	{
+		UNUSED_RETURN(ListenerModel_Result)ListenerModel_NotifyListenersOfEvent(inForWhichModel, pendingEvent.event,
+																					pendingEvent.context);
+	}
+}// deliverPendingEvent
+
+
+/*!
+Returns true if the given listener can be invoked.  This is
+trivially true when no listener anywhere has been destroyed
+since the list was validated; otherwise the listener must
+still be registered.
+
+(2021.06)
+*/
+Boolean
+isListenerEntryValid	(My_ListenerEntry const&	inEntry,
+						 My_ListenerList const&		inList)
+{
+	Boolean		result = (inList.validatedDestructionCount == gListenerDestructionCount);
+	
+	
+	unless (result)
+	{
+		result = (gListenerValidRefs().contains(inEntry.listenerRef));
+	}
+	return result;
+}// isListenerEntryValid
+
+
+/*!
+Replaces the given snapshot of listeners for an event with
+one that has no destroyed listeners, and returns the new
+snapshot.  Since listeners that are destroyed are no longer
+explicitly removed from models, this is normal; but it is
+reported in case a listener was destroyed unintentionally.
+
+(2021.06)
+*/
+My_ListenerListConstPtr
+removeDestroyedListeners	(ListenerModelPtr					inModelPtr,
+							 ListenerModel_Event				inForWhichEvent,
+							 My_ListenerListConstPtr const&		inListPtr)
+{
+	std::shared_ptr< My_ListenerList >	result = std::make_shared< My_ListenerList >();
+	
+	
+	result->entries.reserve(inListPtr->entries.size());
+	for (auto const&	listenerEntry : inListPtr->entries)
+	{
+		if (gListenerValidRefs().contains(listenerEntry.listenerRef))
+		{
+			result->entries.push_back(listenerEntry);
+		}
+	}
+	result->validatedDestructionCount = gListenerDestructionCount;
+	
+	if (result->entries.size() != inListPtr->entries.size())
+	{
+		Console_Warning(Console_WriteValueFourChars, "removed destroyed listener(s) from model for event",
+						inForWhichEvent);
+	}
+	
+	inModelPtr->setListeners(inForWhichEvent, result);
+	
+	return result;
+}// removeDestroyedListeners
+
+
+#ifdef __OBJC__
 /*!
 This C-based callback is invoked by a listener model in the
 usual way, and it forwards the event to a particular object
@@ -889,6 +1272,7 @@ objectiveCStandardListener	(ListenerModel_Ref		inModel,
 	
 	[asStandardListener listenerModel:inModel firedEvent:inEvent context:inEventContext];
 }// objectiveCStandardListener
+#endif // __OBJC__
 
 } // anonymous namespace
 
@@ -1007,9 +1391,200 @@ unitTest000_Callback1	(ListenerModel_Ref		inModel,
 	++gUnitTest000_CallCount;
 }// unitTest000_Callback1
 
+
+/*!
+Tests changes to a model made by its own listeners during
+notification, and coalescing of posted events.
+
+Returns "true" if ALL assertions pass; "false" is
+returned if any fail, however messages should be
+printed for ALL assertion failures regardless.
+
+(2021.06)
+*/
+Boolean
+unitTest001_Begin ()
+{
+	Boolean						result = true;
+	ListenerModel_Ref			model = ListenerModel_New(kListenerModel_StyleStandard, 'u001');
+	ListenerModel_ListenerWrap	firstListener(ListenerModel_NewStandardListener(unitTest001_Callback1), ListenerModel_ListenerWrap::kAlreadyRetained);
+	ListenerModel_ListenerWrap	secondListener(ListenerModel_NewStandardListener(unitTest001_Callback1), ListenerModel_ListenerWrap::kAlreadyRetained);
+	ListenerModel_Result		modelError = kListenerModel_ResultOK;
+	
+	
+	result &= Console_Assert("model constructed", nullptr != model);
+	result &= Console_Assert("listener added", ListenerModel_AddListenerForEvent(model, 'test', firstListener.returnRef()));
+	result &= Console_Assert("listener added", ListenerModel_AddListenerForEvent(model, 'test', secondListener.returnRef()));
+	
+	// the first listener removes the second one while being notified;
+	// the change must not disturb the notification in progress
+	gUnitTest001_CallCount = 0;
+	gUnitTest001_ListenerToRemove = secondListener.returnRef();
+	modelError = ListenerModel_NotifyListenersOfEvent(model, 'test', model/* event context */);
+	result &= Console_Assert("no errors on notify", kListenerModel_ResultOK == modelError);
+	result &= Console_Assert("both listeners notified during removal", 2 == gUnitTest001_CallCount);
+	gUnitTest001_CallCount = 0;
+	gUnitTest001_ListenerToRemove = nullptr;
+	modelError = ListenerModel_NotifyListenersOfEvent(model, 'test', model/* event context */);
+	result &= Console_Assert("no errors on notify", kListenerModel_ResultOK == modelError);
+	result &= Console_Assert("removed listener is not notified later", 1 == gUnitTest001_CallCount);
+	
+	// a listener that is destroyed without being removed is skipped
+	result &= Console_Assert("listener added", ListenerModel_AddListenerForEvent(model, 'test', secondListener.returnRef()));
+	secondListener.clear();
+	gUnitTest001_CallCount = 0;
+	modelError = ListenerModel_NotifyListenersOfEvent(model, 'test', model/* event context */);
+	result &= Console_Assert("destroyed listener is reported", kListenerModel_ResultInvalidListenerReference == modelError);
+	result &= Console_Assert("destroyed listener is not notified", 1 == gUnitTest001_CallCount);
+	modelError = ListenerModel_NotifyListenersOfEvent(model, 'test', model/* event context */);
+	result &= Console_Assert("destroyed listener is removed", kListenerModel_ResultOK == modelError);
+	
+	// identical posted events are coalesced until delivered
+	{
+		dispatch_queue_t	deliveryQueue = dispatch_queue_create("net.macterm.ListenerModel.unitTest001", DISPATCH_QUEUE_SERIAL);
+		
+		
+		modelError = ListenerModel_SetDeliveryQueue(model, deliveryQueue);
+		result &= Console_Assert("no errors setting delivery queue", kListenerModel_ResultOK == modelError);
+		gUnitTest001_CallCount = 0;
+		dispatch_suspend(deliveryQueue);
+		modelError = ListenerModel_PostEvent(model, 'test', model/* event context */);
+		result &= Console_Assert("first post is accepted", kListenerModel_ResultOK == modelError);
+		modelError = ListenerModel_PostEvent(model, 'test', model/* event context */);
+		result &= Console_Assert("second post is coalesced", kListenerModel_ResultEventCoalesced == modelError);
+		modelError = ListenerModel_PostEvent(model, 'test', model/* event context */, false/* coalesce */);
+		result &= Console_Assert("uncoalesced post is accepted", kListenerModel_ResultOK == modelError);
+		result &= Console_Assert("posted events are not delivered immediately", 0 == gUnitTest001_CallCount);
+		dispatch_resume(deliveryQueue);
+		dispatch_sync_f(deliveryQueue, nullptr, unitTest001_FlushQueue);
+		result &= Console_Assert("posted events are delivered", 2 == gUnitTest001_CallCount);
+		
+		// events posted before disposal are discarded
+		dispatch_suspend(deliveryQueue);
+		modelError = ListenerModel_PostEvent(model, 'test', model/* event context */);
+		result &= Console_Assert("post is accepted", kListenerModel_ResultOK == modelError);
+		ListenerModel_Dispose(&model);
+		dispatch_resume(deliveryQueue);
+		dispatch_sync_f(deliveryQueue, nullptr, unitTest001_FlushQueue);
+		result &= Console_Assert("no delivery after disposal", 2 == gUnitTest001_CallCount);
+		
+		dispatch_release(deliveryQueue);
+	}
+	
+	return result;
+}// unitTest001_Begin
+
+
+/*!
+Test callback used with unitTest001_Begin().
+
+(2021.06)
+*/
+void
+unitTest001_Callback1	(ListenerModel_Ref		inModel,
+						 ListenerModel_Event	inEvent,
+						 void*					inEventContext,
+						 void*					UNUSED_ARGUMENT(inListenerContext))
+{
+	// the model is passed as the event context (arbitrarily)
+	UNUSED_RETURN(Boolean)Console_Assert("proper event context", inModel == inEventContext);
+	
+	if (nullptr != gUnitTest001_ListenerToRemove)
+	{
+		UNUSED_RETURN(ListenerModel_Result)ListenerModel_RemoveListenerForEvent(inModel, inEvent, gUnitTest001_ListenerToRemove);
+		gUnitTest001_ListenerToRemove = nullptr;
+	}
+	
+	// increment a global to indicate the callback was invoked
+	++gUnitTest001_CallCount;
+}// unitTest001_Callback1
+
+
+/*!
+Does nothing; queued synchronously by unitTest001_Begin()
+to wait until a delivery queue has run everything ahead of
+it.
+
+(2021.06)
+*/
+void
+unitTest001_FlushQueue	(void*	UNUSED_ARGUMENT(inContext))
+{
+}// unitTest001_FlushQueue
+
+
+/*!
+Measures the cost of notifying models with different
+numbers of listeners.  This prints timing information
+instead of making assertions about speed.
+
+Returns "true" if ALL assertions pass; "false" is
+returned if any fail, however messages should be
+printed for ALL assertion failures regardless.
+
+(2021.06)
+*/
+Boolean
+unitTest002_Begin ()
+{
+	UInt32 const	kNotificationCount = 10000;
+	Boolean			result = true;
+	
+	
+	for (UInt32 listenerCount : { 1, 4, 16, 64, 256 })
+	{
+		ListenerModel_Ref							model = ListenerModel_New(kListenerModel_StyleStandard, 'u002');
+		std::vector< ListenerModel_ListenerWrap >	listeners(listenerCount);
+		CFAbsoluteTime								startTime = 0;
+		CFAbsoluteTime								elapsedTime = 0;
+		
+		
+		for (auto&	listenerWrap : listeners)
+		{
+			listenerWrap.setWithNoRetain(ListenerModel_NewStandardListener(unitTest002_Callback1));
+			result &= Console_Assert("listener added", ListenerModel_AddListenerForEvent(model, 'test', listenerWrap.returnRef()));
+		}
+		
+		gUnitTest002_CallCount = 0;
+		startTime = CFAbsoluteTimeGetCurrent();
+		for (UInt32 i = 0; i < kNotificationCount; ++i)
+		{
+			UNUSED_RETURN(ListenerModel_Result)ListenerModel_NotifyListenersOfEvent(model, 'test', nullptr/* event context */);
+		}
+		elapsedTime = CFAbsoluteTimeGetCurrent() - startTime;
+		result &= Console_Assert("every listener notified every time", (listenerCount * kNotificationCount) == gUnitTest002_CallCount);
+		
+		Console_WriteValueFloat4("listener notification benchmark: listeners, notifications, seconds, nanoseconds per listener call",
+									STATIC_CAST(listenerCount, Float32), STATIC_CAST(kNotificationCount, Float32),
+									STATIC_CAST(elapsedTime, Float32),
+									STATIC_CAST(elapsedTime * 1e9 / (listenerCount * kNotificationCount), Float32));
+		
+		ListenerModel_Dispose(&model);
+	}
+	
+	return result;
+}// unitTest002_Begin
+
+
+/*!
+Test callback used with unitTest002_Begin().
+
+(2021.06)
+*/
+void
+unitTest002_Callback1	(ListenerModel_Ref		UNUSED_ARGUMENT(inModel),
+						 ListenerModel_Event	UNUSED_ARGUMENT(inEvent),
+						 void*					UNUSED_ARGUMENT(inEventContext),
+						 void*					UNUSED_ARGUMENT(inListenerContext))
+{
+	++gUnitTest002_CallCount;
+}// unitTest002_Callback1
+
 }// anonymous namespace
 
 
+#ifdef __OBJC__
+
 #pragma mark -
 @implementation ListenerModel_StandardListener //{
 
@@ -1161,4 +1736,6 @@ setTarget:(id)		anObject
 
 @end //} ListenerModel_StandardListener
 
+#endif // __OBJC__
+
 // BELOW IS REQUIRED NEWLINE TO END FILE
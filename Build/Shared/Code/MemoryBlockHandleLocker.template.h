@@ -79,14 +79,12 @@ acquireLock	(structure_reference_type	inReference)
 {
 	structure_type*		result = nullptr;
 	UInt16				newLockCount = 0;
-#ifndef NDEBUG
-	UInt16				oldLockCount = this->returnLockCount(inReference);
-#endif
+	UInt16				oldLockCount = 0;
 	
 	
 	HLock(REINTERPRET_CAST(inReference, Handle));
 	result = *(REINTERPRET_CAST(inReference, structure_type**));
-	newLockCount = this->incrementLockCount(inReference);
+	newLockCount = this->incrementLockCount(inReference, &oldLockCount);
 	if (debugged)
 	{
 		// log that a lock was acquired, and show where the lock came from
@@ -105,13 +103,11 @@ releaseLock	(structure_reference_type	inReference,
 {
 	// BE SURE THIS IMPLEMENTATION IS SYNCHRONIZED WITH THE “CONSTANT” VERSION, ABOVE
 	UInt16	newLockCount = 0;
-#ifndef NDEBUG
-	UInt16	oldLockCount = this->returnLockCount(inReference);
-#endif
+	UInt16	oldLockCount = 0;
 	
 	
+	newLockCount = this->decrementLockCount(inReference, &oldLockCount);
 	assert(oldLockCount > 0);
-	newLockCount = this->decrementLockCount(inReference);
 	if (debugged)
 	{
 		// log that a lock was released, and show where the release came from
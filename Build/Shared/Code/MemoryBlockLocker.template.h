@@ -51,12 +51,15 @@
 #	error "Do not know how to find <unordered_map> with this compiler."
 #endif
 
+// standard-C++ includes
+#include <mutex>
+
 // Mac includes
 #include <CoreServices/CoreServices.h>
 
 // library includes
 #include <Console.h>
-#include <MemoryBlockReferenceTracker.template.h> // for _AddrToLongHasher
+#include <MemoryBlockReferenceTracker.template.h> // for _AddrToLongHasher, _AddrToShardIndex
 
 
 
@@ -71,6 +74,12 @@ class is a repository containing lock counts for as many references
 of the same type as you wish.  To add a reference, simply try to
 lock it for the first time with acquireLock().  To remove a
 reference, unlock all locks on it.
+
+Lock counts may be changed and queried from any thread: they are
+divided into partitions that each have a lock, so threads that
+use different references rarely wait for each other.  Note that
+answers such as isLocked() can change as soon as they return,
+if other threads use the same reference.
 */
 template < typename structure_reference_type, typename structure_type, bool debugged = false >
 class MemoryBlockLocker
@@ -110,20 +119,35 @@ public:
 	returnLockCount			(structure_reference_type			inReference) const;
 
 protected:
-	//! decreases the number of locks on a reference, returning the new value
-	//! (MUST be used by all releaseLock() implementations)
+	//! decreases the number of locks on a reference, returning the new value and
+	//! optionally the value it replaced (MUST be used by all releaseLock() implementations)
 	UInt16
-	decrementLockCount		(structure_reference_type			inReference);
+	decrementLockCount		(structure_reference_type			inReference,
+							 UInt16*							outOldLockCountOrNull = nullptr);
 	
-	//! increases the number of locks on a reference, returning the new value
-	//! (MUST be used by all acquireLock() implementations)
+	//! increases the number of locks on a reference, returning the new value and
+	//! optionally the value it replaced (MUST be used by all acquireLock() implementations)
 	UInt16
-	incrementLockCount		(structure_reference_type			inReference);
+	incrementLockCount		(structure_reference_type			inReference,
+							 UInt16*							outOldLockCountOrNull = nullptr);
 
 private:
 	typedef unordered_map_namespace::unordered_map< structure_reference_type, UInt16,
 													_AddrToLongHasher< structure_reference_type > >		CountMapType;
-	CountMapType	_mapObject;		//!< repository for reference lock count information
+	
+	struct Shard
+	{
+		mutable std::mutex	lock;		//!< protects this partition only
+		CountMapType		mapObject;	//!< lock counts for references in this partition
+	};
+	
+	Shard&
+	returnShard		(structure_reference_type);
+	
+	Shard const&
+	returnShard		(structure_reference_type) const;
+	
+	Shard	_shards[_AddrToShardIndex< structure_reference_type >::kShardCount];	//!< repository for reference lock count information
 };
 
 
@@ -193,27 +217,41 @@ void
 MemoryBlockLocker< structure_reference_type, structure_type, debugged >::
 clear ()
 {
-	_mapObject.clear();
+	for (auto&	shard : _shards)
+	{
+		std::lock_guard< std::mutex >	shardGuard(shard.lock);
+		
+		
+		shard.mapObject.clear();
+	}
 }// clear
 
 
 template < typename structure_reference_type, typename structure_type, bool debugged >
 UInt16
 MemoryBlockLocker< structure_reference_type, structure_type, debugged >::
-decrementLockCount	(structure_reference_type	inReference)
+decrementLockCount	(structure_reference_type	inReference,
+					 UInt16*					outOldLockCountOrNull)
 {
-	UInt16		result = 0;
-	auto		toCount = _mapObject.find(inReference);
+	Shard&							shard = returnShard(inReference);
+	std::lock_guard< std::mutex >	shardGuard(shard.lock);
+	UInt16							result = 0;
+	auto							toCount = shard.mapObject.find(inReference);
 	
 	
-	if (_mapObject.end() != toCount)
+	if (nullptr != outOldLockCountOrNull)
+	{
+		*outOldLockCountOrNull = (shard.mapObject.end() != toCount) ? toCount->second : 0;
+	}
+	
+	if (shard.mapObject.end() != toCount)
 	{
 		--(toCount->second);
 		result = toCount->second;
 		if (0 == result)
 		{
 			// delete the item when the count reaches zero
-			_mapObject.erase(toCount);
+			shard.mapObject.erase(toCount);
 		}
 	}
 	return result;
@@ -223,20 +261,27 @@ decrementLockCount	(structure_reference_type	inReference)
 template < typename structure_reference_type, typename structure_type, bool debugged >
 UInt16
 MemoryBlockLocker< structure_reference_type, structure_type, debugged >::
-incrementLockCount	(structure_reference_type	inReference)
+incrementLockCount	(structure_reference_type	inReference,
+					 UInt16*					outOldLockCountOrNull)
 {
-	UInt16		result = 0;
-	auto		toCount = _mapObject.find(inReference);
+	Shard&							shard = returnShard(inReference);
+	std::lock_guard< std::mutex >	shardGuard(shard.lock);
+	UInt16							result = 0;
+	auto							toCount = shard.mapObject.find(inReference);
 	
 	
 	// add the item if it is not present
-	if (_mapObject.end() == toCount)
+	if (shard.mapObject.end() == toCount)
 	{
-		_mapObject[inReference] = 0;
-		toCount = _mapObject.find(inReference);
+		toCount = shard.mapObject.insert(typename CountMapType::value_type(inReference, 0)).first;
 	}
 	
-	assert(_mapObject.end() != toCount);
+	assert(shard.mapObject.end() != toCount);
+	
+	if (nullptr != outOldLockCountOrNull)
+	{
+		*outOldLockCountOrNull = toCount->second;
+	}
 	
 	++(toCount->second);
 	result = toCount->second;
@@ -251,9 +296,13 @@ MemoryBlockLocker< structure_reference_type, structure_type, debugged >::
 isLocked	(structure_reference_type	inReference)
 const
 {
+	Shard const&					shard = returnShard(inReference);
+	std::lock_guard< std::mutex >	shardGuard(shard.lock);
+	
+	
 	// if any lock count is currently stored in the collection for
 	// the given reference, then that reference is considered locked
-	return (_mapObject.end() != _mapObject.find(inReference));
+	return (shard.mapObject.end() != shard.mapObject.find(inReference));
 }// isLocked
 
 
@@ -278,11 +327,13 @@ MemoryBlockLocker< structure_reference_type, structure_type, debugged >::
 returnLockCount		(structure_reference_type	inReference)
 const
 {
-	UInt16		result = 0;
-	auto		toCount = _mapObject.find(inReference);
+	Shard const&					shard = returnShard(inReference);
+	std::lock_guard< std::mutex >	shardGuard(shard.lock);
+	UInt16							result = 0;
+	auto							toCount = shard.mapObject.find(inReference);
 	
 	
-	if (_mapObject.end() != toCount)
+	if (shard.mapObject.end() != toCount)
 	{
 		result = toCount->second;
 	}
@@ -290,6 +341,25 @@ const
 }// returnLockCount
 
 
+template < typename structure_reference_type, typename structure_type, bool debugged >
+typename MemoryBlockLocker< structure_reference_type, structure_type, debugged >::Shard&
+MemoryBlockLocker< structure_reference_type, structure_type, debugged >::
+returnShard		(structure_reference_type	inReference)
+{
+	return _shards[_AddrToShardIndex< structure_reference_type >()(inReference)];
+}// returnShard
+
+
+template < typename structure_reference_type, typename structure_type, bool debugged >
+typename MemoryBlockLocker< structure_reference_type, structure_type, debugged >::Shard const&
+MemoryBlockLocker< structure_reference_type, structure_type, debugged >::
+returnShard		(structure_reference_type	inReference)
+const
+{
+	return _shards[_AddrToShardIndex< structure_reference_type >()(inReference)];
+}// returnShard const
+
+
 template < typename structure_reference_type, typename structure_type, bool debugged >
 LockAcquireRelease< structure_reference_type, structure_type, debugged >::
 LockAcquireRelease	(LockAcquireRelease< structure_reference_type, structure_type, debugged >::LockerType&	inLocker,
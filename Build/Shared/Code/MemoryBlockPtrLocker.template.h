@@ -31,6 +31,11 @@
 
 #pragma once
 
+// standard-C++ includes
+#include <atomic>
+#include <thread>
+#include <vector>
+
 // Mac includes
 #include <CoreServices/CoreServices.h>
 
@@ -81,7 +86,7 @@ protected:
 
 private:
 	DisposeProcPtr		_disposer;
-	bool				_requireLocks;	//!< in the destruct phase ONLY, this is cleared to
+	std::atomic< bool >	_requireLocks;	//!< in the destruct phase ONLY, this is cleared to
 										//!  prevent callbacks from looping back; it is
 										//!  implicit in that phase that the structure is
 										//!  locked (and is in the process of being destroyed)
@@ -152,12 +157,10 @@ acquireLock	(structure_reference_type	inReference)
 	if (_requireLocks)
 	{
 		UInt16	newLockCount = 0;
-	#ifndef NDEBUG
-		UInt16	oldLockCount = this->returnLockCount(inReference);
-	#endif
+		UInt16	oldLockCount = 0;
 		
 		
-		newLockCount = this->incrementLockCount(inReference);
+		newLockCount = this->incrementLockCount(inReference, &oldLockCount);
 		if (debugged)
 		{
 			// log that a lock was acquired, and show where the lock came from
@@ -178,12 +181,10 @@ releaseLock	(structure_reference_type	inReference,
 	if (_requireLocks)
 	{
 		UInt16	newLockCount = 0;
-	#ifndef NDEBUG
-		UInt16	oldLockCount = this->returnLockCount(inReference);
-	#endif
+		UInt16	oldLockCount = 0;
 		
 		
-		newLockCount = this->decrementLockCount(inReference);
+		newLockCount = this->decrementLockCount(inReference, &oldLockCount);
 		if (debugged)
 		{
 			// log that a lock was released, and show where the release came from
@@ -288,6 +289,37 @@ unitTest ()
 		result &= Console_Assert("lock count is down to zero for ref2", 0 == locker.returnLockCount(ref2));
 	}
 	
+	// concurrent locking (skipped for the debugged variant, since it
+	// would print thousands of stack traces)
+	unless (debugged)
+	{
+		TestLockerClass				locker;
+		structure_reference_type	sharedRef = REINTERPRET_CAST(0x1234DEAD, structure_reference_type);
+		std::vector< std::thread >	threads;
+		
+		
+		for (UInt16 i = 0; i < 4; ++i)
+		{
+			threads.push_back(std::thread([&locker, sharedRef, i] ()
+			{
+				structure_reference_type	privateRef = REINTERPRET_CAST(0x5678BE00 + (i * 0x10), structure_reference_type);
+				
+				
+				for (UInt16 j = 0; j < 10000; ++j)
+				{
+					TestAutoLockerClass		ptr1(locker, sharedRef);
+					TestAutoLockerClass		ptr2(locker, privateRef);
+				}
+			}));
+		}
+		for (auto&	thread : threads)
+		{
+			thread.join();
+		}
+		result &= Console_Assert("lock count is down to zero for shared reference after concurrent use", 0 == locker.returnLockCount(sharedRef));
+		result &= Console_Assert("no locks remain after concurrent use", false == locker.isLocked(REINTERPRET_CAST(0x5678BE00, structure_reference_type)));
+	}
+	
 	return result;
 }// unitTest
 
@@ -83,12 +83,10 @@ MemoryBlockReferenceLocker< structure_reference_type, structure_type, debugged >
 acquireLock	(structure_reference_type	inReference)
 {
 	UInt16				newLockCount = 0;
-#ifndef NDEBUG
-	UInt16				oldLockCount = this->returnLockCount(inReference);
-#endif
+	UInt16				oldLockCount = 0;
 	
 	
-	newLockCount = this->incrementLockCount(inReference);
+	newLockCount = this->incrementLockCount(inReference, &oldLockCount);
 	if (debugged)
 	{
 		// log that a lock was acquired, and show where the lock came from
@@ -119,11 +117,12 @@ releaseLock	(structure_reference_type	inReference,
 			 structure_type**			UNUSED_ARGUMENT(inNull))
 {
 	UInt16	newLockCount = 0;
-#ifndef NDEBUG
-	UInt16	oldLockCount = this->returnLockCount(inReference);
-#endif
+	UInt16	oldLockCount = 0;
 	
 	
+	// (the old count is read by the same operation that changes it,
+	// so the assertions hold even if other threads use the reference)
+	newLockCount = this->decrementLockCount(inReference, &oldLockCount);
 	if (debugged)
 	{
 		if (oldLockCount <= 0)
@@ -132,7 +131,6 @@ releaseLock	(structure_reference_type	inReference,
 		}
 	}
 	assert(oldLockCount > 0);
-	newLockCount = this->decrementLockCount(inReference);
 	if (debugged)
 	{
 		// log that a lock was released, and show where the release came from
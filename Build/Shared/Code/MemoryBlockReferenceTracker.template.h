@@ -49,6 +49,9 @@
 #	error "Do not know how to find <unordered_set> with this compiler."
 #endif
 
+// standard-C++ includes
+#include <mutex>
+
 
 
 #pragma mark Types
@@ -64,19 +67,141 @@ public:
 	operator ()	(structure_reference_type) const;
 };
 
+/*!
+Chooses one of several independently-locked partitions for
+an address, so that threads using different objects rarely
+wait for each other.  The low bits of addresses are mostly
+alignment so they are ignored.
+*/
+template < typename structure_reference_type >
+class _AddrToShardIndex
+{
+public:
+	enum
+	{
+		kShardCount = 16	//!< number of partitions; must be a power of 2
+	};
+	
+	size_t
+	operator ()	(structure_reference_type) const;
+};
+
 /*!
 Stores a set of references (pointers) to a data structure.
 Useful for checking that a reference is “valid” before it is
 used.
+
+All operations are thread-safe: the set is divided into
+partitions that each have a lock, so a reference can be
+validated on any thread while objects are created and
+destroyed on others.  (Of course, a reference that is valid
+when checked may become invalid immediately afterward unless
+something else, such as a lock count, keeps it alive.)
 */
 template < typename structure_reference_type >
-class MemoryBlockReferenceTracker:
-public unordered_set_namespace::unordered_set< structure_reference_type,
-												_AddrToLongHasher< structure_reference_type > >
+class MemoryBlockReferenceTracker
 {
+public:
+	//! returns true only if the reference is in the set
+	bool
+	contains	(structure_reference_type) const;
+	
+	//! removes the reference from the set, if present
+	void
+	erase		(structure_reference_type);
+	
+	//! adds the reference to the set, if not present
+	void
+	insert		(structure_reference_type);
+	
+	//! returns the number of references in the set (which may already
+	//! be out of date if other threads are changing the set)
+	size_t
+	size		() const;
+
+private:
+	typedef unordered_set_namespace::unordered_set< structure_reference_type,
+													_AddrToLongHasher< structure_reference_type > >	SetType;
+	
+	struct Shard
+	{
+		mutable std::mutex	lock;		//!< protects this partition only
+		SetType				setObject;	//!< references in this partition
+	};
+	
+	Shard&
+	returnShard		(structure_reference_type);
+	
+	Shard const&
+	returnShard		(structure_reference_type) const;
+	
+	Shard	_shards[_AddrToShardIndex< structure_reference_type >::kShardCount];
 };
 
 
+
+#pragma mark Public Methods
+
+template < typename structure_reference_type >
+bool
+MemoryBlockReferenceTracker< structure_reference_type >::
+contains	(structure_reference_type	inReference)
+const
+{
+	Shard const&					shard = returnShard(inReference);
+	std::lock_guard< std::mutex >	shardGuard(shard.lock);
+	
+	
+	return (shard.setObject.end() != shard.setObject.find(inReference));
+}// contains
+
+
+template < typename structure_reference_type >
+void
+MemoryBlockReferenceTracker< structure_reference_type >::
+erase	(structure_reference_type	inReference)
+{
+	Shard&							shard = returnShard(inReference);
+	std::lock_guard< std::mutex >	shardGuard(shard.lock);
+	
+	
+	shard.setObject.erase(inReference);
+}// erase
+
+
+template < typename structure_reference_type >
+void
+MemoryBlockReferenceTracker< structure_reference_type >::
+insert	(structure_reference_type	inReference)
+{
+	Shard&							shard = returnShard(inReference);
+	std::lock_guard< std::mutex >	shardGuard(shard.lock);
+	
+	
+	shard.setObject.insert(inReference);
+}// insert
+
+
+template < typename structure_reference_type >
+size_t
+MemoryBlockReferenceTracker< structure_reference_type >::
+size ()
+const
+{
+	size_t		result = 0;
+	
+	
+	for (auto const&	shard : _shards)
+	{
+		std::lock_guard< std::mutex >	shardGuard(shard.lock);
+		
+		
+		result += shard.setObject.size();
+	}
+	return result;
+}// size
+
+
 #pragma mark Internal Methods
 
 template < typename structure_reference_type >
@@ -88,4 +213,36 @@ const
 	return REINTERPRET_CAST(inAddress, size_t);
 }// operator ()
 
+
+template < typename structure_reference_type >
+size_t
+_AddrToShardIndex< structure_reference_type >::
+operator ()	(structure_reference_type	inAddress)
+const
+{
+	size_t const	kAddress = REINTERPRET_CAST(inAddress, size_t);
+	
+	
+	return (((kAddress >> 4) ^ (kAddress >> 12)) & (kShardCount - 1));
+}// operator ()
+
+
+template < typename structure_reference_type >
+typename MemoryBlockReferenceTracker< structure_reference_type >::Shard&
+MemoryBlockReferenceTracker< structure_reference_type >::
+returnShard		(structure_reference_type	inReference)
+{
+	return _shards[_AddrToShardIndex< structure_reference_type >()(inReference)];
+}// returnShard
+
+
+template < typename structure_reference_type >
+typename MemoryBlockReferenceTracker< structure_reference_type >::Shard const&
+MemoryBlockReferenceTracker< structure_reference_type >::
+returnShard		(structure_reference_type	inReference)
+const
+{
+	return _shards[_AddrToShardIndex< structure_reference_type >()(inReference)];
+}// returnShard const
+
 // BELOW IS REQUIRED NEWLINE TO END FILE
@@ -0,0 +1,512 @@
+/*!	\file ProcessSpawn.cp
+	\brief Starts programs attached to new pseudo-terminal
+	devices, without forking the calling process.
+*/
+/*###############################################################
+
+	Data Access Library
+	© 1998-2021 by Kevin Grant
+	
+	This library is free software; you can redistribute it or
+	modify it under the terms of the GNU Lesser Public License
+	as published by the Free Software Foundation; either version
+	2.1 of the License, or (at your option) any later version.
+	
+	This program is distributed in the hope that it will be
+	useful, but WITHOUT ANY WARRANTY; without even the implied
+	warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+	PURPOSE.  See the GNU Lesser Public License for details.
+	
+	You should have received a copy of the GNU Lesser Public
+	License along with this library; if not, write to:
+	
+		Free Software Foundation, Inc.
+		59 Temple Place, Suite 330
+		Boston, MA  02111-1307
+		USA
+
+###############################################################*/
+
+#include <ProcessSpawn.h>
+#include <UniversalDefines.h>
+
+// standard-C includes
+#include <cerrno>
+#include <cstring>
+
+// standard-C++ includes
+#include <chrono>
+
+// UNIX includes
+extern "C"
+{
+#	include <fcntl.h>
+#	include <poll.h>
+#	include <signal.h>
+#	include <spawn.h>
+#	include <sysexits.h>
+#	include <unistd.h>
+#	include <sys/wait.h>
+#if defined(__APPLE__)
+#	include <util.h>
+#else
+#	include <pty.h>
+#endif
+	extern char**	environ;
+}
+
+// library includes
+#include <Console.h>
+
+
+
+#pragma mark Internal Method Prototypes
+namespace {
+
+std::vector< std::string >	mergeEnvironment		(std::vector< std::string > const&);
+void						setCloseOnExec			(int);
+Boolean						unitTest000_Begin		();
+Boolean						unitTest001_Begin		();
+Boolean						waitForProcessOutput	(ProcessSpawn_Process&, std::string&, int&);
+
+} // anonymous namespace
+
+#pragma mark Variables
+namespace {
+
+std::string		gHelperPath;	//!< if not empty, the program that runs every other program (see ProcessSpawn_SetHelperPath())
+
+} // anonymous namespace
+
+
+
+#pragma mark Public Methods
+
+/*!
+A unit test for this module.  This should always
+be run before a release, after any substantial
+changes are made, or if you suspect bugs!  It
+should also be EXPANDED as new functionality is
+proposed (ideally, a test is written before the
+functionality is added).
+
+If a helper has been set, programs are started by
+the helper (so run the tests again after calling
+ProcessSpawn_SetHelperPath() to test both ways).
+
+(2021.06)
+*/
+void
+ProcessSpawn_RunTests ()
+{
+	UInt16		totalTests = 0;
+	UInt16		failedTests = 0;
+	
+	
+	++totalTests; if (false == unitTest000_Begin()) ++failedTests;
+	++totalTests; if (false == unitTest001_Begin()) ++failedTests;
+	
+	Console_WriteUnitTestReport((gHelperPath.empty()) ? "Process Spawn" : "Process Spawn (with helper)",
+								failedTests, totalTests);
+}// RunTests
+
+
+/*!
+Opens a new pseudo-terminal device and starts the given
+program in a new session, with the device as its standard
+input, output, error and controlling terminal.  The
+program is found using the PATH, as execvp() would.
+
+The environment of the program is a copy of the environment
+of the caller, except that each "NAME=value" string in the
+given settings is added (replacing any inherited value for
+the same name).  The environment of the caller is NOT
+changed, since setenv() is unsafe when there are threads.
+
+The terminal settings and size are optional; if the size is
+not given, the device is 80 columns by 24 rows.
+
+If the program cannot be started, nothing is left open and
+"errno" is set (unless a helper is used, in which case the
+helper starts but exits with EX_UNAVAILABLE).  A directory
+that does not exist is an error either way.
+
+(2021.06)
+*/
+ProcessSpawn_Result
+ProcessSpawn_InPseudoTerminal	(std::vector< std::string > const&	inArguments,
+								 std::vector< std::string > const&	inEnvironmentSettings,
+								 char const*						inWorkingDirectoryOrNull,
+								 struct termios const*				inTerminalControlOrNull,
+								 struct winsize const*				inTerminalSizeOrNull,
+								 ProcessSpawn_Process&				outProcess)
+{
+	ProcessSpawn_Result		result = kProcessSpawn_ResultOK;
+	
+	
+	outProcess = ProcessSpawn_Process();
+	if (inArguments.empty() || inArguments[0].empty())
+	{
+		result = kProcessSpawn_ResultParameterError;
+	}
+	else
+	{
+		struct winsize		terminalSize;
+		int					masterFD = -1;
+		int					slaveFD = -1;
+		char				slaveDeviceName[128/* arbitrary */];
+		
+		
+		std::memset(&terminalSize, 0, sizeof(terminalSize));
+		terminalSize.ws_col = 80;
+		terminalSize.ws_row = 24;
+		if (nullptr != inTerminalSizeOrNull)
+		{
+			terminalSize = *inTerminalSizeOrNull;
+		}
+		
+		// NOTE: there is no way to open the device with close-on-exec
+		// already set, so another thread that forks at exactly the
+		// wrong time would leak these descriptors into its child
+		if ((0 != openpty(&masterFD, &slaveFD, nullptr/* name */, CONST_CAST(inTerminalControlOrNull, struct termios*), &terminalSize)) ||
+			(0 != ttyname_r(slaveFD, slaveDeviceName, sizeof(slaveDeviceName))))
+		{
+			Console_Warning(Console_WriteValue, "unable to open pseudo-terminal, errno", errno);
+			if (masterFD >= 0)
+			{
+				UNUSED_RETURN(int)close(masterFD), masterFD = -1;
+				UNUSED_RETURN(int)close(slaveFD), slaveFD = -1;
+			}
+			result = kProcessSpawn_ResultPseudoTerminalError;
+		}
+		else
+		{
+			std::vector< std::string >	environmentStrings = mergeEnvironment(inEnvironmentSettings);
+			std::vector< char* >		argumentPointers;
+			std::vector< char* >		environmentPointers;
+			posix_spawn_file_actions_t	fileActions;
+			posix_spawnattr_t			attributes;
+			sigset_t					noSignals;
+			sigset_t					allSignals;
+			pid_t						processID = -1;
+			int							spawnError = 0;
+			
+			
+			setCloseOnExec(masterFD);
+			setCloseOnExec(slaveFD);
+			
+			// the helper runs first, and is told what to run next
+			unless (gHelperPath.empty())
+			{
+				argumentPointers.push_back(CONST_CAST(gHelperPath.c_str(), char*));
+			}
+			for (auto const&	argument : inArguments)
+			{
+				argumentPointers.push_back(CONST_CAST(argument.c_str(), char*));
+			}
+			argumentPointers.push_back(nullptr);
+			
+			// the program sees the environment of the caller, plus the new settings
+			for (auto const&	variable : environmentStrings)
+			{
+				environmentPointers.push_back(CONST_CAST(variable.c_str(), char*));
+			}
+			environmentPointers.push_back(nullptr);
+			
+			// undo the signal settings of the caller, because programs
+			// like shells inherit them (otherwise, a shell might ignore
+			// interrupts or leave signals blocked for its own children)
+			sigemptyset(&noSignals);
+			sigfillset(&allSignals);
+			sigdelset(&allSignals, SIGKILL);
+			sigdelset(&allSignals, SIGSTOP);
+			
+			posix_spawnattr_init(&attributes);
+			UNUSED_RETURN(int)posix_spawnattr_setsigmask(&attributes, &noSignals);
+			UNUSED_RETURN(int)posix_spawnattr_setsigdefault(&attributes, &allSignals);
+			UNUSED_RETURN(int)posix_spawnattr_setflags(&attributes, POSIX_SPAWN_SETSID | POSIX_SPAWN_SETSIGMASK | POSIX_SPAWN_SETSIGDEF
+#if defined(POSIX_SPAWN_CLOEXEC_DEFAULT)
+																		| POSIX_SPAWN_CLOEXEC_DEFAULT
+#endif
+																		);
+			
+			// opening the device by name in the new session (instead of
+			// inheriting the open descriptor) is what makes it the
+			// controlling terminal, where file actions follow setsid()
+			posix_spawn_file_actions_init(&fileActions);
+			if ((nullptr != inWorkingDirectoryOrNull) && ('\0' != inWorkingDirectoryOrNull[0]))
+			{
+				UNUSED_RETURN(int)posix_spawn_file_actions_addchdir_np(&fileActions, inWorkingDirectoryOrNull);
+			}
+			UNUSED_RETURN(int)posix_spawn_file_actions_addopen(&fileActions, STDIN_FILENO, slaveDeviceName, O_RDWR, 0);
+			UNUSED_RETURN(int)posix_spawn_file_actions_adddup2(&fileActions, STDIN_FILENO, STDOUT_FILENO);
+			UNUSED_RETURN(int)posix_spawn_file_actions_adddup2(&fileActions, STDIN_FILENO, STDERR_FILENO);
+#if defined(__GLIBC__) && __GLIBC_PREREQ(2, 34)
+			UNUSED_RETURN(int)posix_spawn_file_actions_addclosefrom_np(&fileActions, STDERR_FILENO + 1);
+#endif
+
+			spawnError = posix_spawnp(&processID, argumentPointers[0], &fileActions, &attributes,
+										argumentPointers.data(), environmentPointers.data());
+			
+			posix_spawn_file_actions_destroy(&fileActions);
+			posix_spawnattr_destroy(&attributes);
+			
+			// the child has its own descriptor for the device by now
+			UNUSED_RETURN(int)close(slaveFD), slaveFD = -1;
+			
+			if (0 != spawnError)
+			{
+				Console_Warning(Console_WriteValueCString, "unable to spawn process, program", argumentPointers[0]);
+				Console_Warning(Console_WriteValue, "spawn error", spawnError);
+				UNUSED_RETURN(int)close(masterFD), masterFD = -1;
+				errno = spawnError;
+				result = kProcessSpawn_ResultSpawnError;
+			}
+			else
+			{
+				outProcess.masterFD = masterFD;
+				outProcess.slaveDeviceName = slaveDeviceName;
+				outProcess.processID = processID;
+			}
+		}
+	}
+	return result;
+}// InPseudoTerminal
+
+
+/*!
+Specifies the absolute path of a program that must start
+all other programs, or nullptr to start them directly.  The
+helper is given the program and its arguments, as its own
+arguments.  It starts in the new session with the pseudo-
+terminal as its standard input, output and error, and must
+make that device its controlling terminal before it runs
+the program.
+
+On macOS this is required (see the module description), and
+the helper is normally "MacTermSpawnHelper" from the bundle.
+This should be called once, before any programs are started.
+
+(2021.06)
+*/
+void
+ProcessSpawn_SetHelperPath	(char const*	inPathOrNull)
+{
+	gHelperPath = (nullptr != inPathOrNull) ? inPathOrNull : "";
+}// SetHelperPath
+
+
+#pragma mark Internal Methods
+namespace {
+
+/*!
+Returns a copy of the environment of this process, with
+the given "NAME=value" settings added at the end (and any
+inherited values for the same names left out).
+
+(2021.06)
+*/
+std::vector< std::string >
+mergeEnvironment	(std::vector< std::string > const&		inEnvironmentSettings)
+{
+	std::vector< std::string >	result;
+	
+	
+	for (char** variablePtr = environ; ((nullptr != variablePtr) && (nullptr != *variablePtr)); ++variablePtr)
+	{
+		std::string const	kVariable(*variablePtr);
+		std::string const	kName = kVariable.substr(0, kVariable.find('=') + 1);
+		Boolean				isReplaced = false;
+		
+		
+		for (auto const&	setting : inEnvironmentSettings)
+		{
+			if (0 == setting.compare(0, kName.size(), kName))
+			{
+				isReplaced = true;
+			}
+		}
+		unless (isReplaced)
+		{
+			result.push_back(kVariable);
+		}
+	}
+	result.insert(result.end(), inEnvironmentSettings.begin(), inEnvironmentSettings.end());
+	return result;
+}// mergeEnvironment
+
+
+/*!
+Arranges for the given file descriptor to be closed in
+any program that this process runs.
+
+(2021.06)
+*/
+void
+setCloseOnExec	(int	inFileDescriptor)
+{
+	int const	kFlags = fcntl(inFileDescriptor, F_GETFD);
+	
+	
+	if (kFlags >= 0)
+	{
+		UNUSED_RETURN(int)fcntl(inFileDescriptor, F_SETFD, kFlags | FD_CLOEXEC);
+	}
+}// setCloseOnExec
+
+
+/*!
+Starts a shell that reports its working directory, an
+environment setting, its terminal size and whether or
+not it has a controlling terminal; and checks the output.
+
+Returns "true" if ALL assertions pass; "false" is
+returned if any fail, however messages should be
+printed for ALL assertion failures regardless.
+
+(2021.06)
+*/
+Boolean
+unitTest000_Begin ()
+{
+	struct winsize			terminalSize;
+	ProcessSpawn_Process	process;
+	ProcessSpawn_Result		spawnResult = kProcessSpawn_ResultOK;
+	Boolean					result = true;
+	
+	
+	std::memset(&terminalSize, 0, sizeof(terminalSize));
+	terminalSize.ws_col = 91;
+	terminalSize.ws_row = 37;
+	spawnResult = ProcessSpawn_InPseudoTerminal({ "sh", "-c", "pwd; echo \"setting=$MY_SPAWN_TEST\"; stty size; "
+																"(exec 3</dev/tty) && echo has-terminal; exit 3" },
+												{ "MY_SPAWN_TEST=hello" }, "/", nullptr/* terminal settings */, &terminalSize, process);
+	Console_TestAssertUpdate(result, kProcessSpawn_ResultOK == spawnResult, Console_WriteValue, "spawn result", spawnResult);
+	if (kProcessSpawn_ResultOK == spawnResult)
+	{
+		std::string		output;
+		int				exitStatus = 0;
+		
+		
+		Console_TestAssertUpdate(result, false == process.slaveDeviceName.empty(), Console_WriteLine, "expected a device name");
+		Console_TestAssertUpdate(result, waitForProcessOutput(process, output, exitStatus), Console_WriteLine, "expected process to exit");
+		Console_TestAssertUpdate(result, 3 == exitStatus, Console_WriteValue, "exit status", exitStatus);
+		Console_TestAssertUpdate(result, 0 == output.compare(0, 3, "/\r\n"), Console_WriteValueStdString, "output", output);
+		Console_TestAssertUpdate(result, std::string::npos != output.find("setting=hello\r\n"), Console_WriteValueStdString, "output", output);
+		Console_TestAssertUpdate(result, std::string::npos != output.find("37 91\r\n"), Console_WriteValueStdString, "output", output);
+		Console_TestAssertUpdate(result, std::string::npos != output.find("has-terminal\r\n"), Console_WriteValueStdString, "output", output);
+	}
+	
+	return result;
+}// unitTest000_Begin
+
+
+/*!
+Tests failures: an empty command line, and a program that
+does not exist (which is an error from the spawn itself,
+or an exit status of the helper if there is a helper).
+
+Returns "true" if ALL assertions pass; "false" is
+returned if any fail, however messages should be
+printed for ALL assertion failures regardless.
+
+(2021.06)
+*/
+Boolean
+unitTest001_Begin ()
+{
+	ProcessSpawn_Process	process;
+	ProcessSpawn_Result		spawnResult = kProcessSpawn_ResultOK;
+	Boolean					result = true;
+	
+	
+	spawnResult = ProcessSpawn_InPseudoTerminal({}, {}, nullptr/* directory */, nullptr/* terminal settings */,
+												nullptr/* size */, process);
+	Console_TestAssertUpdate(result, kProcessSpawn_ResultParameterError == spawnResult, Console_WriteValue, "spawn result", spawnResult);
+	Console_TestAssertUpdate(result, -1 == process.masterFD, Console_WriteValue, "master", process.masterFD);
+	
+	spawnResult = ProcessSpawn_InPseudoTerminal({ "/nonexistent/MacTerm-program" }, {}, nullptr/* directory */,
+												nullptr/* terminal settings */, nullptr/* size */, process);
+	if (gHelperPath.empty())
+	{
+		Console_TestAssertUpdate(result, kProcessSpawn_ResultSpawnError == spawnResult, Console_WriteValue, "spawn result", spawnResult);
+		Console_TestAssertUpdate(result, -1 == process.masterFD, Console_WriteValue, "master", process.masterFD);
+	}
+	else
+	{
+		std::string		output;
+		int				exitStatus = 0;
+		
+		
+		Console_TestAssertUpdate(result, kProcessSpawn_ResultOK == spawnResult, Console_WriteValue, "spawn result", spawnResult);
+		Console_TestAssertUpdate(result, waitForProcessOutput(process, output, exitStatus), Console_WriteLine, "expected process to exit");
+		Console_TestAssertUpdate(result, EX_UNAVAILABLE == exitStatus, Console_WriteValue, "exit status", exitStatus);
+	}
+	
+	return result;
+}// unitTest001_Begin
+
+
+/*!
+Reads the pseudo-terminal of a process that was started
+by a test until the process exits (or 10 seconds pass),
+then closes the device and returns the exit status.
+
+Returns true only if the process exited.
+
+(2021.06)
+*/
+Boolean
+waitForProcessOutput	(ProcessSpawn_Process&	inoutProcess,
+						 std::string&			outOutput,
+						 int&					outExitStatus)
+{
+	auto const		kDeadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+	Boolean			isEnd = false;
+	int				waitStatus = 0;
+	Boolean			result = false;
+	
+	
+	outOutput.clear();
+	outExitStatus = -1;
+	
+	// read until the device hangs up (which is an error on some
+	// systems, and the end of the file on others)
+	while ((false == isEnd) && (std::chrono::steady_clock::now() < kDeadline))
+	{
+		struct pollfd	pollInfo = { inoutProcess.masterFD, POLLIN, 0 };
+		
+		
+		if (poll(&pollInfo, 1, 100/* milliseconds */) > 0)
+		{
+			char		buffer[512];
+			ssize_t		byteCount = read(inoutProcess.masterFD, buffer, sizeof(buffer));
+			
+			
+			if (byteCount > 0)
+			{
+				outOutput.append(buffer, byteCount);
+			}
+			else if ((0 == byteCount) || (EINTR != errno))
+			{
+				isEnd = true;
+			}
+		}
+	}
+	UNUSED_RETURN(int)close(inoutProcess.masterFD), inoutProcess.masterFD = -1;
+	
+	if (inoutProcess.processID == waitpid(inoutProcess.processID, &waitStatus, 0))
+	{
+		result = WIFEXITED(waitStatus);
+		if (result)
+		{
+			outExitStatus = WEXITSTATUS(waitStatus);
+		}
+	}
+	
+	return result;
+}// waitForProcessOutput
+
+} // anonymous namespace
+
+// BELOW IS REQUIRED NEWLINE TO END FILE
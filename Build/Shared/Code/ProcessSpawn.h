@@ -0,0 +1,137 @@
+/*!	\file ProcessSpawn.h
+	\brief Starts programs attached to new pseudo-terminal
+	devices, without forking the calling process.
+	
+	A large, multithreaded process (such as a GUI) should
+	not use fork() or forkpty(): the cost of fork() grows
+	with the address space of the parent, and the child of a
+	multithreaded process can only safely call a handful of
+	system routines before it runs a new program.  This
+	module opens the pseudo-terminal in the caller and then
+	uses posix_spawn() to start the program in a new session
+	whose controlling terminal is that device, so the time
+	to start a program does not depend on the size of the
+	caller and no code of the caller runs in the child.
+	
+	The child starts with no blocked signals, with default
+	handling of all signals, and (where supported) with no
+	file descriptors other than the pseudo-terminal.
+	
+	On systems that run file actions before creating the new
+	session (macOS), opening the device in the child does not
+	make it the controlling terminal; so a helper program
+	must be given (see ProcessSpawn_SetHelperPath()), which
+	claims the terminal and then runs the real program.
+*/
+/*###############################################################
+
+	Data Access Library
+	© 1998-2021 by Kevin Grant
+	
+	This library is free software; you can redistribute it or
+	modify it under the terms of the GNU Lesser Public License
+	as published by the Free Software Foundation; either version
+	2.1 of the License, or (at your option) any later version.
+	
+	This program is distributed in the hope that it will be
+	useful, but WITHOUT ANY WARRANTY; without even the implied
+	warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+	PURPOSE.  See the GNU Lesser Public License for details.
+	
+	You should have received a copy of the GNU Lesser Public
+	License along with this library; if not, write to:
+	
+		Free Software Foundation, Inc.
+		59 Temple Place, Suite 330
+		Boston, MA  02111-1307
+		USA
+
+###############################################################*/
+
+#include <UniversalDefines.h>
+
+#pragma once
+
+// standard-C++ includes
+#include <string>
+#include <vector>
+
+// UNIX includes
+extern "C"
+{
+#	include <termios.h>
+#	include <sys/ioctl.h>
+#	include <sys/types.h>
+}
+
+// Mac includes
+#include <CoreServices/CoreServices.h>
+
+
+
+#pragma mark Constants
+
+/*!
+Possible return values from Process Spawn module routines.
+*/
+enum ProcessSpawn_Result
+{
+	kProcessSpawn_ResultOK						= 0,	//!< no error occurred
+	kProcessSpawn_ResultParameterError			= 1,	//!< invalid input (e.g. empty command line)
+	kProcessSpawn_ResultPseudoTerminalError		= 2,	//!< no pseudo-terminal device could be opened
+	kProcessSpawn_ResultSpawnError				= 3		//!< the program could not be started (see "errno")
+};
+
+#pragma mark Types
+
+/*!
+Describes a program that has been started.  The caller owns
+the master device, and must close it and eventually wait for
+the process to exit (waitpid()).
+*/
+struct ProcessSpawn_Process
+{
+	int				masterFD;			//!< read and write this to talk to the program; close-on-exec
+	std::string		slaveDeviceName;	//!< such as "/dev/ttys001"
+	pid_t			processID;			//!< leader of a new session
+	
+	ProcessSpawn_Process ()
+	:
+	masterFD(-1),
+	slaveDeviceName(),
+	processID(-1)
+	{
+	}
+};
+
+
+
+#pragma mark Public Methods
+
+//!\name Module Tests
+//@{
+
+void
+	ProcessSpawn_RunTests					();
+
+//@}
+
+//!\name Starting Programs
+//@{
+
+// CALL ONCE AT STARTUP; IF SET, PROGRAMS ARE RUN BY "helper program [arguments...]"
+void
+	ProcessSpawn_SetHelperPath				(char const*						inPathOrNull);
+
+// ARGUMENTS ARE FOUND USING "PATH"; SETTINGS ARE "NAME=value" AND REPLACE ANY INHERITED VALUES
+ProcessSpawn_Result
+	ProcessSpawn_InPseudoTerminal			(std::vector< std::string > const&	inArguments,
+											 std::vector< std::string > const&	inEnvironmentSettings,
+											 char const*						inWorkingDirectoryOrNull,
+											 struct termios const*				inTerminalControlOrNull,
+											 struct winsize const*				inTerminalSizeOrNull,
+											 ProcessSpawn_Process&				outProcess);
+
+//@}
+
+// BELOW IS REQUIRED NEWLINE TO END FILE
@@ -141,12 +141,16 @@ the scaling factor that should be applied when rendering
 to fit the precise-integer cell count, and an output flag
 to terminate iteration early if necessary.
 */
+#ifdef __BLOCKS__
 typedef void (^StringUtilities_CellBlock) (CFStringRef, StringUtilities_Cell, CFRange, CGFloat, Boolean&);
+#endif
 
 /*!
 Used to iterate over composed character sequences.
 */
+#ifdef __BLOCKS__
 typedef void (^StringUtilities_ComposedCharacterBlock) (CFStringRef, CFRange, Boolean&);
+#endif
 
 
 #pragma mark Public Methods
@@ -179,6 +183,7 @@ void
 //!\name Unicode Utilities
 //@{
 
+#ifdef __BLOCKS__
 void
 	StringUtilities_ForEachComposedCellCluster			(CFStringRef,
 														 StringUtilities_CellBlock);
@@ -196,6 +201,7 @@ void
 	StringUtilities_ForEachComposedCharacterSequenceInRange	(CFStringRef,
 														 CFRange,
 														 StringUtilities_ComposedCharacterBlock);
+#endif // __BLOCKS__
 
 CFStringRef
 	StringUtilities_ReturnBlankStringCopy				(CFIndex);
@@ -48,8 +48,10 @@
 #pragma mark Internal Method Prototypes
 namespace {
 
+#ifdef __OBJC__
 Boolean			unitTest_ReturnUnicodeSymbol_000				();
 Boolean			unitTest_StudyInRange_000						();
+#endif
 
 } // anonymous namespace
 
@@ -57,6 +59,10 @@ Boolean			unitTest_StudyInRange_000						();
 
 #pragma mark Public Methods
 
+// Unicode-aware utilities (and their tests) require Cocoa and
+// blocks; the rest of this module is also built portably
+#ifdef __OBJC__
+
 /*!
 A unit test for this module.  This should always
 be run before a release, after any substantial
@@ -79,6 +85,7 @@ StringUtilities_RunTests ()
 	
 	Console_WriteUnitTestReport("String Utilities", failedTests, totalTests);
 }// RunTests
+#endif // __OBJC__
 
 
 /*!
@@ -166,6 +173,7 @@ StringUtilities_CFToUTF8	(CFStringRef	inCFString,
 }// CFToUTF8
 
 
+#ifdef __OBJC__
 /*!
 Calls StringUtilities_ForEachComposedCellClusterInRange()
 for the entire length of the string, starting at 0.
@@ -318,6 +326,7 @@ StringUtilities_ForEachComposedCharacterSequenceInRange		(CFStringRef								inS
 		}
 	}
 }// ForEachComposedCharacterSequenceInRange
+#endif // __OBJC__
 
 
 /*!
@@ -334,21 +343,14 @@ cache.
 CFStringRef
 StringUtilities_ReturnBlankStringCopy	(CFIndex	inLength)
 {
-	static dispatch_once_t		onceToken;
-	static CFStringRef			gBlankString = nullptr;
-	static CFIndex				gBlankLength = 0;
+	static CFStringRef const	gBlankString = CFSTR("                                                  "
+													 "                                                  "
+													 "                                                  "
+													 "                                                  ");
+	static CFIndex const		gBlankLength = CFStringGetLength(gBlankString);
 	CFStringRef					result = nullptr;
 	
 	
-	dispatch_once(&onceToken,
-	^{
-		gBlankString = CFSTR("                                                  "
-							 "                                                  "
-							 "                                                  "
-							 "                                                  ");
-		gBlankLength = CFStringGetLength(gBlankString);
-	});
-	
 	if (inLength > gBlankLength)
 	{
 		CFMutableStringRef		mutableString = CFStringCreateMutable(kCFAllocatorDefault, inLength);
@@ -442,6 +444,7 @@ StringUtilities_ReturnSubstringRangeForCellRange	(CFStringRef							UNUSED_ARGUM
 }// ReturnSubstringRangeForCellRange
 
 
+#ifdef __OBJC__
 /*!
 Given a substring representing a single composed character
 sequence (such as that returned by the iteration method
@@ -557,11 +560,14 @@ StringUtilities_StudyInRange	(CFStringRef						inString,
 		baseString = [asNSString substringWithRange:NSMakeRange(baseStringOffset, asNSString.length - baseStringOffset)];
 	}
 }// StudyInRange
+#endif // __OBJC__
 
 
 #pragma mark Internal Methods: Unit Tests
 namespace {
 
+#ifdef __OBJC__
+
 /*!
 Tests StringUtilities_ReturnUnicodeSymbol().
 
@@ -686,6 +692,8 @@ unitTest_StudyInRange_000 ()
 	return result;
 }// unitTest_StudyInRange_000
 
+#endif // __OBJC__
+
 } // anonymous namespace
 
 // BELOW IS REQUIRED NEWLINE TO END FILE
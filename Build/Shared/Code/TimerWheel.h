@@ -0,0 +1,176 @@
+/*!	\file TimerWheel.h
+	\brief Many one-shot timers that share a single system
+	timer, with constant-time arm, re-arm and cancel.
+	
+	Timers are kept in a hierarchical wheel of time slots.
+	Arming or cancelling a timer only links or unlinks it
+	from a slot, and re-arming a timer to go off LATER (as a
+	keep-alive or inactivity watch does every time data
+	arrives) only records the new deadline: the timer stays
+	where it is, and when its old slot comes up it is simply
+	moved to the slot of its new deadline.  That makes it
+	reasonable to re-arm a timer for every chunk of data
+	received, which is not the case for a system timer.
+	
+	Only one system timer per wheel is scheduled, for the
+	next slot that has timers in it; so hundreds of sessions
+	with watches cost no more than one.  Use the wheel from
+	TimerWheel_ReturnShared() (on the main queue) unless
+	there is a reason to have another.
+	
+	All calls for a wheel and its timers must be made on the
+	queue of the wheel.  Timers go off no earlier than their
+	deadlines, and at most one tick later.
+*/
+/*###############################################################
+
+	Data Access Library
+	© 1998-2021 by Kevin Grant
+	
+	This library is free software; you can redistribute it or
+	modify it under the terms of the GNU Lesser Public License
+	as published by the Free Software Foundation; either version
+	2.1 of the License, or (at your option) any later version.
+	
+	This program is distributed in the hope that it will be
+	useful, but WITHOUT ANY WARRANTY; without even the implied
+	warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+	PURPOSE.  See the GNU Lesser Public License for details.
+	
+	You should have received a copy of the GNU Lesser Public
+	License along with this library; if not, write to:
+	
+		Free Software Foundation, Inc.
+		59 Temple Place, Suite 330
+		Boston, MA  02111-1307
+		USA
+
+###############################################################*/
+
+#include <UniversalDefines.h>
+
+#pragma once
+
+// Mac includes
+#include <CoreServices/CoreServices.h>
+#include <dispatch/dispatch.h>
+
+
+
+#pragma mark Constants
+
+/*!
+Possible return values from Timer Wheel module routines.
+*/
+enum TimerWheel_Result
+{
+	kTimerWheel_ResultOK					= 0,	//!< no error occurred
+	kTimerWheel_ResultInvalidReference		= 1,	//!< wheel or timer is not recognized
+	kTimerWheel_ResultUnsupported			= 2		//!< operation is not allowed for this kind of wheel
+};
+
+UInt64 const	kTimerWheel_NoTime = ~STATIC_CAST(0, UInt64);	//!< returned when there is no next event
+
+#pragma mark Types
+
+typedef struct TimerWheel_OpaqueWheel*		TimerWheel_Ref;
+typedef struct TimerWheel_OpaqueTimer*		TimerWheel_TimerRef;
+
+#pragma mark Callbacks
+
+/*!
+Timer Callback
+
+Invoked on the queue of the wheel when a timer goes off.
+The timer is no longer armed at that point, so it may be
+armed again (to repeat) or disposed, as may any other
+timer; but the wheel must not be disposed.
+*/
+typedef void (*TimerWheel_TimerProcPtr)	(TimerWheel_TimerRef	inTimer,
+										 void*					inContext);
+
+
+
+#pragma mark Public Methods
+
+//!\name Module Tests
+//@{
+
+void
+	TimerWheel_RunTests					();
+
+//@}
+
+//!\name Creating and Destroying Wheels
+//@{
+
+// FOR A QUEUE OF nullptr, THE WHEEL ONLY MOVES WHEN TimerWheel_AdvanceTo() IS CALLED
+TimerWheel_Ref
+	TimerWheel_New						(UInt32					inMillisecondsPerTick,
+										 dispatch_queue_t		inQueueOrNull);
+
+// TIMERS MUST BE DISPOSED FIRST
+void
+	TimerWheel_Dispose					(TimerWheel_Ref*		inoutWheelPtr);
+
+// MAIN QUEUE, 50-MILLISECOND TICKS; NEVER DISPOSED
+TimerWheel_Ref
+	TimerWheel_ReturnShared				();
+
+//@}
+
+//!\name Time
+//@{
+
+// ONLY FOR WHEELS WITHOUT A QUEUE; TIMES CANNOT DECREASE
+TimerWheel_Result
+	TimerWheel_AdvanceTo				(TimerWheel_Ref			inWheel,
+										 UInt64					inMilliseconds);
+
+UInt64
+	TimerWheel_ReturnArmedTimerCount	(TimerWheel_Ref			inWheel);
+
+// RETURNS kTimerWheel_NoTime IF NO TIMERS ARE ARMED; MAY BE EARLIER THAN ANY DEADLINE
+UInt64
+	TimerWheel_ReturnNextWakeTime		(TimerWheel_Ref			inWheel);
+
+// MILLISECONDS; FOR WHEELS WITH A QUEUE, SINCE THE WHEEL WAS CREATED
+UInt64
+	TimerWheel_ReturnTime				(TimerWheel_Ref			inWheel);
+
+//@}
+
+//!\name Creating and Destroying Timers
+//@{
+
+TimerWheel_TimerRef
+	TimerWheel_NewTimer					(TimerWheel_Ref				inWheel,
+										 TimerWheel_TimerProcPtr	inProcPtr,
+										 void*						inContext);
+
+// CANCELS THE TIMER IF IT IS ARMED
+void
+	TimerWheel_DisposeTimer				(TimerWheel_TimerRef*		inoutTimerPtr);
+
+//@}
+
+//!\name Arming Timers
+//@{
+
+TimerWheel_Result
+	TimerWheel_Arm						(TimerWheel_TimerRef	inTimer,
+										 UInt32					inDelayInMilliseconds);
+
+TimerWheel_Result
+	TimerWheel_Cancel					(TimerWheel_TimerRef	inTimer);
+
+Boolean
+	TimerWheel_IsArmed					(TimerWheel_TimerRef	inTimer);
+
+// USES THE DELAY OF THE MOST RECENT TimerWheel_Arm(); CHEAP ENOUGH TO CALL FOR EVERY CHUNK OF DATA
+TimerWheel_Result
+	TimerWheel_Rearm					(TimerWheel_TimerRef	inTimer);
+
+//@}
+
+// BELOW IS REQUIRED NEWLINE TO END FILE
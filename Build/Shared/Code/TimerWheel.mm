@@ -0,0 +1,1270 @@
+/*!	\file TimerWheel.mm
+	\brief Many one-shot timers that share a single system
+	timer, with constant-time arm, re-arm and cancel.
+*/
+/*###############################################################
+
+	Data Access Library
+	© 1998-2021 by Kevin Grant
+	
+	This library is free software; you can redistribute it or
+	modify it under the terms of the GNU Lesser Public License
+	as published by the Free Software Foundation; either version
+	2.1 of the License, or (at your option) any later version.
+	
+	This program is distributed in the hope that it will be
+	useful, but WITHOUT ANY WARRANTY; without even the implied
+	warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+	PURPOSE.  See the GNU Lesser Public License for details.
+	
+	You should have received a copy of the GNU Lesser Public
+	License along with this library; if not, write to:
+	
+		Free Software Foundation, Inc.
+		59 Temple Place, Suite 330
+		Boston, MA  02111-1307
+		USA
+
+###############################################################*/
+
+#import <TimerWheel.h>
+#import <UniversalDefines.h>
+
+// standard-C++ includes
+#import <algorithm>
+#import <chrono>
+#import <vector>
+
+// library includes
+#import <Console.h>
+
+
+
+#pragma mark Constants
+namespace {
+
+/*!
+The wheel has one level of 256 slots, one per tick, and
+three levels of 64 slots that each cover 64 slots of the
+level below; so timers can be up to 2^26 ticks away (more
+than 38 days with 50-millisecond ticks).  A timer that is
+further away is put in the farthest slot, and moved again
+when that slot comes up.
+*/
+UInt8 const		kMy_LevelCount = 4;
+UInt8 const		kMy_LevelShift[kMy_LevelCount] = { 0, 8, 14, 20 };		//!< tick bits below the slot index of each level
+UInt8 const		kMy_LevelBits[kMy_LevelCount] = { 8, 6, 6, 6 };			//!< slot index bits of each level
+UInt16 const	kMy_LevelFirstSlot[kMy_LevelCount] = { 0, 256, 320, 384 };	//!< position of each level in the slot array
+UInt16 const	kMy_SlotCount = 448;
+UInt64 const	kMy_TickRange = (STATIC_CAST(1, UInt64) << 26);			//!< ticks covered by the whole wheel
+
+UInt32 const	kMy_SharedMillisecondsPerTick = 50;
+
+} // anonymous namespace
+
+#pragma mark Types
+namespace {
+
+struct My_TimerWheel;
+
+/*!
+Links timers into the circular list of a slot.  Each slot
+has one of these as its list head, so that timers can be
+unlinked without knowing which list they are in.
+*/
+struct My_TimerLink
+{
+	My_TimerLink*	previous;
+	My_TimerLink*	next;
+};
+
+/*!
+A one-shot timer.  While armed, it is linked into the slot
+for "expiryTick"; its real deadline may be later, if it was
+re-armed after being linked (see TimerWheel_Arm()).
+*/
+struct My_Timer:
+public My_TimerLink
+{
+	My_TimerWheel*				wheel;				//!< the wheel that the timer belongs to
+	TimerWheel_TimerProcPtr		procPtr;			//!< invoked when the timer goes off
+	void*						context;			//!< passed to the callback
+	UInt64						expiryTick;			//!< tick of the slot that the timer is linked into
+	UInt64						deadlineTick;		//!< first tick at which the timer may go off (never before "expiryTick")
+	UInt32						delayMilliseconds;	//!< delay of the most recent arm, for TimerWheel_Rearm()
+	UInt16						slotIndex;			//!< where the timer is linked, if armed
+	Boolean						isArmed;			//!< true only if the timer is linked into a slot
+};
+typedef My_Timer*	My_TimerPtr;
+
+/*!
+The slots of a wheel, and its system timer (if any).  Every
+tick before "currentTick" has been processed.
+*/
+struct My_TimerWheel
+{
+	My_TimerWheel	(UInt32, dispatch_queue_t);
+	~My_TimerWheel	();
+	
+	void
+	advanceTo	(UInt64);
+	
+	void
+	arm		(My_TimerPtr, UInt64);
+	
+	void
+	link	(My_TimerPtr, UInt64);
+	
+	UInt64
+	returnNextEventTick () const;
+	
+	UInt64
+	returnTime () const;
+	
+	void
+	scheduleSystemTimer ();
+	
+	void
+	unlink	(My_TimerPtr);
+	
+	My_TimerLink								slots[kMy_SlotCount];		//!< list heads
+	UInt64										occupiedSlots[kMy_SlotCount / 64];	//!< bit set for each slot with timers
+	UInt64										currentTick;				//!< next tick to be processed
+	UInt64										armedCount;					//!< number of timers linked into slots
+	UInt64										manualTime;					//!< time given to TimerWheel_AdvanceTo(), without a queue
+	UInt64										systemTimerTick;			//!< tick that the system timer is set for, or "kTimerWheel_NoTime"
+	std::chrono::steady_clock::time_point		startTime;					//!< time zero, with a queue
+	UInt32										millisecondsPerTick;		//!< wheel resolution
+	dispatch_queue_t							queue;						//!< where timers go off; nullptr if advanced manually
+#ifdef __OBJC__
+	dispatch_source_t							systemTimer;				//!< set for the next slot that has timers; nullptr if no queue
+#endif
+};
+typedef My_TimerWheel*	My_TimerWheelPtr;
+
+/*!
+Used by unitTest001_Begin() to count how often a timer goes
+off, and to find another timer to cancel.
+*/
+struct My_UnitTestTimerInfo
+{
+	UInt32					fireCount;
+	TimerWheel_TimerRef		timerToCancel;
+};
+
+} // anonymous namespace
+
+#pragma mark Internal Method Prototypes
+namespace {
+
+inline My_TimerPtr		getTimer				(TimerWheel_TimerRef);
+inline My_TimerWheelPtr	getWheel				(TimerWheel_Ref);
+#ifdef __OBJC__
+void					systemTimerFired		(void*);
+#endif
+Boolean					unitTest000_Begin		();
+void					unitTest000_Callback	(TimerWheel_TimerRef, void*);
+Boolean					unitTest001_Begin		();
+void					unitTest001_Callback	(TimerWheel_TimerRef, void*);
+
+} // anonymous namespace
+
+
+
+#pragma mark Public Methods
+
+/*!
+A unit test for this module.  This should always
+be run before a release, after any substantial
+changes are made, or if you suspect bugs!  It
+should also be EXPANDED as new functionality is
+proposed (ideally, a test is written before the
+functionality is added).
+
+(2021.06)
+*/
+void
+TimerWheel_RunTests ()
+{
+	UInt16		totalTests = 0;
+	UInt16		failedTests = 0;
+	
+	
+	++totalTests; if (false == unitTest000_Begin()) ++failedTests;
+	++totalTests; if (false == unitTest001_Begin()) ++failedTests;
+	
+	Console_WriteUnitTestReport("Timer Wheel", failedTests, totalTests);
+}// RunTests
+
+
+/*!
+Creates a new wheel of timers, which go off on the given
+queue.  A wheel needs only one system timer, regardless of
+how many of its timers are armed; and the system timer only
+wakes the queue for ticks that have timers.
+
+Timers cannot go off more precisely than the tick length,
+and the wheel can only schedule timers up to 2^26 ticks
+away without moving them again; so the tick should be as
+long as the least precise timers allow.
+
+If the queue is nullptr, time does not pass on its own:
+TimerWheel_AdvanceTo() must be called, and timers go off
+from that call.  This is useful for tests, and for event
+loops that compute their own timeouts (see the routine
+TimerWheel_ReturnNextWakeTime()).  In builds without
+dispatch sources, every wheel is advanced this way.
+
+(2021.06)
+*/
+TimerWheel_Ref
+TimerWheel_New	(UInt32				inMillisecondsPerTick,
+				 dispatch_queue_t	inQueueOrNull)
+{
+	TimerWheel_Ref		result = nullptr;
+	
+	
+	try
+	{
+		result = REINTERPRET_CAST(new My_TimerWheel(std::max< UInt32 >(1, inMillisecondsPerTick), inQueueOrNull), TimerWheel_Ref);
+	}
+	catch (std::bad_alloc)
+	{
+		result = nullptr;
+	}
+	return result;
+}// New
+
+
+/*!
+Destroys a wheel created with TimerWheel_New(), and sets
+your copy of the reference to nullptr.  All of its timers
+must have been disposed already.
+
+(2021.06)
+*/
+void
+TimerWheel_Dispose	(TimerWheel_Ref*	inoutWheelPtr)
+{
+	if (nullptr != inoutWheelPtr)
+	{
+		My_TimerWheelPtr	ptr = getWheel(*inoutWheelPtr);
+		
+		
+		if (nullptr != ptr)
+		{
+			if (ptr->armedCount > 0)
+			{
+				Console_Warning(Console_WriteValue, "timer wheel disposed with armed timers; count", ptr->armedCount);
+			}
+			delete ptr;
+		}
+		*inoutWheelPtr = nullptr;
+	}
+}// Dispose
+
+
+/*!
+Moves time forward on a wheel that has no queue, which makes
+every timer go off whose deadline is at or before the given
+time (in order of deadline tick).  Callbacks are invoked
+from this routine.
+
+Times are in milliseconds, from any starting point chosen
+by the caller; but they cannot decrease (a smaller time is
+ignored).
+
+\retval kTimerWheel_ResultOK
+if time has moved
+
+\retval kTimerWheel_ResultInvalidReference
+if the wheel is not valid
+
+\retval kTimerWheel_ResultUnsupported
+if the wheel has a queue, which keeps its own time
+
+(2021.06)
+*/
+TimerWheel_Result
+TimerWheel_AdvanceTo	(TimerWheel_Ref		inWheel,
+						 UInt64				inMilliseconds)
+{
+	TimerWheel_Result	result = kTimerWheel_ResultOK;
+	My_TimerWheelPtr	ptr = getWheel(inWheel);
+	
+	
+	if (nullptr == ptr) result = kTimerWheel_ResultInvalidReference;
+	else if (nullptr != ptr->queue) result = kTimerWheel_ResultUnsupported;
+	else
+	{
+		ptr->manualTime = std::max(ptr->manualTime, inMilliseconds);
+		ptr->advanceTo(ptr->manualTime);
+	}
+	return result;
+}// AdvanceTo
+
+
+/*!
+Returns the number of timers that are currently armed.
+
+(2021.06)
+*/
+UInt64
+TimerWheel_ReturnArmedTimerCount	(TimerWheel_Ref		inWheel)
+{
+	My_TimerWheelPtr	ptr = getWheel(inWheel);
+	UInt64				result = 0;
+	
+	
+	if (nullptr != ptr)
+	{
+		result = ptr->armedCount;
+	}
+	return result;
+}// ReturnArmedTimerCount
+
+
+/*!
+Returns the time at which the wheel next needs to advance:
+the tick of the nearest slot that has timers, or the start
+of a slot on another level whose timers must be spread out.
+This is never later than the nearest deadline, but it may
+be earlier (advancing at that time simply makes no timers
+go off).
+
+Returns "kTimerWheel_NoTime" if no timers are armed, or if
+the wheel is not valid.
+
+(2021.06)
+*/
+UInt64
+TimerWheel_ReturnNextWakeTime	(TimerWheel_Ref		inWheel)
+{
+	My_TimerWheelPtr	ptr = getWheel(inWheel);
+	UInt64				result = kTimerWheel_NoTime;
+	
+	
+	if (nullptr != ptr)
+	{
+		UInt64 const	kTick = ptr->returnNextEventTick();
+		
+		
+		if (kTimerWheel_NoTime != kTick)
+		{
+			result = (kTick * ptr->millisecondsPerTick);
+		}
+	}
+	return result;
+}// ReturnNextWakeTime
+
+
+/*!
+Returns the shared wheel of the application, whose timers
+go off on the main queue with a precision of 50 milliseconds.
+Prefer this to creating wheels, so that the whole application
+needs only one system timer.
+
+(2021.06)
+*/
+TimerWheel_Ref
+TimerWheel_ReturnShared ()
+{
+	static TimerWheel_Ref	gSharedWheel = TimerWheel_New(kMy_SharedMillisecondsPerTick, dispatch_get_main_queue());
+	
+	
+	return gSharedWheel;
+}// ReturnShared
+
+
+/*!
+Returns the current time of the wheel, in milliseconds.
+For a wheel with a queue, this is the time since the wheel
+was created; otherwise, it is the most recent time given to
+TimerWheel_AdvanceTo().
+
+(2021.06)
+*/
+UInt64
+TimerWheel_ReturnTime	(TimerWheel_Ref		inWheel)
+{
+	My_TimerWheelPtr	ptr = getWheel(inWheel);
+	UInt64				result = 0;
+	
+	
+	if (nullptr != ptr)
+	{
+		result = ptr->returnTime();
+	}
+	return result;
+}// ReturnTime
+
+
+/*!
+Creates a timer on the given wheel, which is not armed.
+The callback is invoked each time that the timer goes off,
+with the given context.
+
+(2021.06)
+*/
+TimerWheel_TimerRef
+TimerWheel_NewTimer		(TimerWheel_Ref				inWheel,
+						 TimerWheel_TimerProcPtr	inProcPtr,
+						 void*						inContext)
+{
+	My_TimerWheelPtr		wheelPtr = getWheel(inWheel);
+	TimerWheel_TimerRef		result = nullptr;
+	
+	
+	if (nullptr != wheelPtr)
+	{
+		try
+		{
+			My_TimerPtr		ptr = new My_Timer;
+			
+			
+			ptr->previous = ptr;
+			ptr->next = ptr;
+			ptr->wheel = wheelPtr;
+			ptr->procPtr = inProcPtr;
+			ptr->context = inContext;
+			ptr->expiryTick = 0;
+			ptr->deadlineTick = 0;
+			ptr->delayMilliseconds = 0;
+			ptr->slotIndex = 0;
+			ptr->isArmed = false;
+			result = REINTERPRET_CAST(ptr, TimerWheel_TimerRef);
+		}
+		catch (std::bad_alloc)
+		{
+			result = nullptr;
+		}
+	}
+	return result;
+}// NewTimer
+
+
+/*!
+Cancels the timer if it is armed, destroys it, and sets
+your copy of the reference to nullptr.
+
+(2021.06)
+*/
+void
+TimerWheel_DisposeTimer		(TimerWheel_TimerRef*	inoutTimerPtr)
+{
+	if (nullptr != inoutTimerPtr)
+	{
+		My_TimerPtr		ptr = getTimer(*inoutTimerPtr);
+		
+		
+		if (nullptr != ptr)
+		{
+			if (ptr->isArmed)
+			{
+				ptr->wheel->unlink(ptr);
+			}
+			delete ptr;
+		}
+		*inoutTimerPtr = nullptr;
+	}
+}// DisposeTimer
+
+
+/*!
+Arms the timer to go off after the given delay, replacing
+any deadline that it had.  The delay is also remembered for
+TimerWheel_Rearm().
+
+This takes constant time.  If the timer is already armed
+for an earlier time, it is not even moved: it only records
+the new deadline, and is moved when its current slot comes
+up.  A delay of zero makes the timer go off on the next
+tick (never from this call).
+
+\retval kTimerWheel_ResultOK
+if the timer is armed
+
+\retval kTimerWheel_ResultInvalidReference
+if the timer is not valid
+
+(2021.06)
+*/
+TimerWheel_Result
+TimerWheel_Arm	(TimerWheel_TimerRef	inTimer,
+				 UInt32					inDelayInMilliseconds)
+{
+	TimerWheel_Result	result = kTimerWheel_ResultOK;
+	My_TimerPtr			ptr = getTimer(inTimer);
+	
+	
+	if (nullptr == ptr) result = kTimerWheel_ResultInvalidReference;
+	else
+	{
+		ptr->delayMilliseconds = inDelayInMilliseconds;
+		ptr->wheel->arm(ptr, ptr->wheel->returnTime() + inDelayInMilliseconds);
+	}
+	return result;
+}// Arm
+
+
+/*!
+Disarms the timer, if it is armed.
+
+\retval kTimerWheel_ResultOK
+if the timer is no longer armed
+
+\retval kTimerWheel_ResultInvalidReference
+if the timer is not valid
+
+(2021.06)
+*/
+TimerWheel_Result
+TimerWheel_Cancel	(TimerWheel_TimerRef	inTimer)
+{
+	TimerWheel_Result	result = kTimerWheel_ResultOK;
+	My_TimerPtr			ptr = getTimer(inTimer);
+	
+	
+	if (nullptr == ptr) result = kTimerWheel_ResultInvalidReference;
+	else if (ptr->isArmed)
+	{
+		ptr->wheel->unlink(ptr);
+	}
+	return result;
+}// Cancel
+
+
+/*!
+Returns true only if the timer is armed (that is, it has
+not gone off or been cancelled since it was last armed).
+
+(2021.06)
+*/
+Boolean
+TimerWheel_IsArmed	(TimerWheel_TimerRef	inTimer)
+{
+	My_TimerPtr		ptr = getTimer(inTimer);
+	Boolean			result = false;
+	
+	
+	if (nullptr != ptr)
+	{
+		result = ptr->isArmed;
+	}
+	return result;
+}// IsArmed
+
+
+/*!
+Arms the timer again with the delay that was most recently
+given to TimerWheel_Arm(), whether or not it is still armed;
+for example, call this whenever data arrives to restart a
+watch for inactivity.  This normally only stores a number.
+
+\retval kTimerWheel_ResultOK
+if the timer is armed
+
+\retval kTimerWheel_ResultInvalidReference
+if the timer is not valid
+
+(2021.06)
+*/
+TimerWheel_Result
+TimerWheel_Rearm	(TimerWheel_TimerRef	inTimer)
+{
+	TimerWheel_Result	result = kTimerWheel_ResultOK;
+	My_TimerPtr			ptr = getTimer(inTimer);
+	
+	
+	if (nullptr == ptr) result = kTimerWheel_ResultInvalidReference;
+	else
+	{
+		ptr->wheel->arm(ptr, ptr->wheel->returnTime() + ptr->delayMilliseconds);
+	}
+	return result;
+}// Rearm
+
+
+#pragma mark Internal Methods
+namespace {
+
+/*!
+Creates an empty wheel.  With a queue, a system timer is
+created (but not scheduled until a timer is armed).
+
+(2021.06)
+*/
+My_TimerWheel::
+My_TimerWheel	(UInt32				inMillisecondsPerTick,
+				 dispatch_queue_t	inQueueOrNull)
+:
+currentTick(0),
+armedCount(0),
+manualTime(0),
+systemTimerTick(kTimerWheel_NoTime),
+startTime(std::chrono::steady_clock::now()),
+millisecondsPerTick(inMillisecondsPerTick),
+queue(nullptr)
+#ifdef __OBJC__
+,
+systemTimer(nullptr)
+#endif
+{
+	for (auto& slotHead : this->slots)
+	{
+		slotHead.previous = &slotHead;
+		slotHead.next = &slotHead;
+	}
+	std::fill(this->occupiedSlots, this->occupiedSlots + (kMy_SlotCount / 64), 0);
+	
+	if (nullptr != inQueueOrNull)
+	{
+	#ifdef __OBJC__
+		this->queue = inQueueOrNull;
+		dispatch_retain(this->queue);
+		this->systemTimer = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, this->queue);
+		dispatch_set_context(this->systemTimer, this);
+		dispatch_source_set_event_handler_f(this->systemTimer, systemTimerFired);
+		dispatch_source_set_timer(this->systemTimer, DISPATCH_TIME_FOREVER, DISPATCH_TIME_FOREVER, 0);
+		dispatch_resume(this->systemTimer);
+	#else
+		Console_Warning(Console_WriteLine, "timer wheel requires dispatch sources for a queue; advance it manually");
+	#endif
+	}
+}// My_TimerWheel 2-argument constructor
+
+
+/*!
+Stops the system timer, if any.
+
+(2021.06)
+*/
+My_TimerWheel::
+~My_TimerWheel ()
+{
+#ifdef __OBJC__
+	if (nullptr != this->systemTimer)
+	{
+		dispatch_source_cancel(this->systemTimer);
+		dispatch_release(this->systemTimer);
+	}
+#endif
+	if (nullptr != this->queue)
+	{
+		dispatch_release(this->queue);
+	}
+}// My_TimerWheel destructor
+
+
+/*!
+Processes every tick up to the one that contains the given
+time: timers in higher levels are spread into lower levels
+at the start of their slots, and timers in the slot of each
+tick either go off or (if they were re-armed for later) move
+to the slot of their new deadline.
+
+Timers that are armed by callbacks go into later ticks, so
+each tick is processed once.  With a queue, the system timer
+is then set for the next tick that has timers.
+
+(2021.06)
+*/
+void
+My_TimerWheel::
+advanceTo	(UInt64		inMilliseconds)
+{
+	UInt64 const	kTargetTick = (inMilliseconds / this->millisecondsPerTick);
+	
+	
+	while ((this->currentTick <= kTargetTick) && (this->armedCount > 0))
+	{
+		UInt64 const	kTick = this->currentTick;
+		My_TimerLink	dueList;
+		
+		
+		// skip ahead over ticks that cannot have anything to do
+		{
+			UInt64 const	kNextEventTick = this->returnNextEventTick();
+			
+			
+			if (kNextEventTick > kTick)
+			{
+				this->currentTick = std::min(kNextEventTick, kTargetTick + 1);
+				continue;
+			}
+		}
+		
+		// at the start of the slot of a higher level, spread its
+		// timers into lower levels (highest level first, so that
+		// timers fall through several levels at once if necessary)
+		for (SInt16 level = (kMy_LevelCount - 1); level > 0; --level)
+		{
+			if (0 == (kTick & ((STATIC_CAST(1, UInt64) << kMy_LevelShift[level]) - 1)))
+			{
+				UInt16 const	kSlotIndex = kMy_LevelFirstSlot[level] +
+												STATIC_CAST((kTick >> kMy_LevelShift[level]) &
+															((1 << kMy_LevelBits[level]) - 1), UInt16);
+				My_TimerLink&	slotHead = this->slots[kSlotIndex];
+				
+				
+				while (slotHead.next != &slotHead)
+				{
+					My_TimerPtr		timerPtr = STATIC_CAST(slotHead.next, My_TimerPtr);
+					
+					
+					this->unlink(timerPtr);
+					this->link(timerPtr, timerPtr->deadlineTick);
+				}
+			}
+		}
+		
+		// detach the timers that are due, so that callbacks can
+		// change any timer (including others that are due)
+		{
+			My_TimerLink&	slotHead = this->slots[kTick & 0xFF];
+			
+			
+			if (slotHead.next == &slotHead)
+			{
+				dueList.previous = &dueList;
+				dueList.next = &dueList;
+			}
+			else
+			{
+				dueList.previous = slotHead.previous;
+				dueList.next = slotHead.next;
+				dueList.previous->next = &dueList;
+				dueList.next->previous = &dueList;
+				slotHead.previous = &slotHead;
+				slotHead.next = &slotHead;
+			}
+			this->occupiedSlots[(kTick & 0xFF) / 64] &= ~(STATIC_CAST(1, UInt64) << (kTick % 64));
+		}
+		this->currentTick = (kTick + 1);
+		
+		while (dueList.next != &dueList)
+		{
+			My_TimerPtr		timerPtr = STATIC_CAST(dueList.next, My_TimerPtr);
+			
+			
+			// the timer is still counted and considered armed,
+			// but its slot is the detached list
+			timerPtr->previous->next = timerPtr->next;
+			timerPtr->next->previous = timerPtr->previous;
+			timerPtr->previous = timerPtr;
+			timerPtr->next = timerPtr;
+			if (timerPtr->deadlineTick > kTick)
+			{
+				// re-armed for later since it was linked
+				--(this->armedCount);
+				timerPtr->isArmed = false;
+				this->link(timerPtr, timerPtr->deadlineTick);
+			}
+			else
+			{
+				--(this->armedCount);
+				timerPtr->isArmed = false;
+				if (nullptr != timerPtr->procPtr)
+				{
+					timerPtr->procPtr(REINTERPRET_CAST(timerPtr, TimerWheel_TimerRef), timerPtr->context);
+				}
+			}
+		}
+	}
+	
+	if (this->currentTick <= kTargetTick)
+	{
+		// nothing is armed, so the remaining ticks are empty
+		this->currentTick = (kTargetTick + 1);
+	}
+	
+	this->scheduleSystemTimer();
+}// My_TimerWheel::advanceTo
+
+
+/*!
+Arms a timer to go off at the first tick that contains the
+given time.  If the timer is already linked into an earlier
+slot, only its deadline changes (see advanceTo()).
+
+(2021.06)
+*/
+void
+My_TimerWheel::
+arm		(My_TimerPtr	inTimerPtr,
+		 UInt64			inDeadlineMilliseconds)
+{
+	UInt64 const	kDeadlineTick = std::max((inDeadlineMilliseconds + this->millisecondsPerTick - 1) / this->millisecondsPerTick,
+												this->currentTick);
+	
+	
+	if (inTimerPtr->isArmed && (kDeadlineTick >= inTimerPtr->expiryTick))
+	{
+		inTimerPtr->deadlineTick = kDeadlineTick;
+	}
+	else
+	{
+		if (inTimerPtr->isArmed)
+		{
+			this->unlink(inTimerPtr);
+		}
+		else if (0 == this->armedCount)
+		{
+			// nothing was waiting, so skip the idle ticks instead of
+			// processing them later (that would have no effect)
+			this->currentTick = std::max(this->currentTick, this->returnTime() / this->millisecondsPerTick);
+		}
+		this->link(inTimerPtr, std::max(kDeadlineTick, this->currentTick));
+		if (inTimerPtr->expiryTick < this->systemTimerTick)
+		{
+			this->scheduleSystemTimer();
+		}
+	}
+}// My_TimerWheel::arm
+
+
+/*!
+Links a timer that is not armed into the slot for the
+given tick (or the farthest slot, for ticks beyond the
+range of the wheel), and sets its deadline to that tick.
+
+(2021.06)
+*/
+void
+My_TimerWheel::
+link	(My_TimerPtr	inTimerPtr,
+		 UInt64			inDeadlineTick)
+{
+	UInt64 const	kExpiryTick = std::min(std::max(inDeadlineTick, this->currentTick), this->currentTick + kMy_TickRange - 1);
+	UInt64 const	kDelta = (kExpiryTick - this->currentTick);
+	UInt8			level = 0;
+	
+	
+	while ((level < (kMy_LevelCount - 1)) && (kDelta >= (STATIC_CAST(1, UInt64) << kMy_LevelShift[level + 1])))
+	{
+		++level;
+	}
+	
+	{
+		UInt16 const	kSlotIndex = kMy_LevelFirstSlot[level] +
+										STATIC_CAST((kExpiryTick >> kMy_LevelShift[level]) & ((1 << kMy_LevelBits[level]) - 1), UInt16);
+		My_TimerLink&	slotHead = this->slots[kSlotIndex];
+		
+		
+		inTimerPtr->expiryTick = kExpiryTick;
+		inTimerPtr->deadlineTick = std::max(inDeadlineTick, kExpiryTick);
+		inTimerPtr->slotIndex = kSlotIndex;
+		inTimerPtr->isArmed = true;
+		inTimerPtr->previous = slotHead.previous;
+		inTimerPtr->next = &slotHead;
+		slotHead.previous->next = inTimerPtr;
+		slotHead.previous = inTimerPtr;
+		this->occupiedSlots[kSlotIndex / 64] |= (STATIC_CAST(1, UInt64) << (kSlotIndex % 64));
+		++(this->armedCount);
+	}
+}// My_TimerWheel::link
+
+
+/*!
+Returns the tick at which advanceTo() next has something
+to do: the nearest slot on the first level that has timers,
+or the start of the nearest slot on a higher level whose
+timers must be spread out, whichever is earlier.  In each
+level, only the slots ahead of the current one in the cycle
+of the level are considered exactly; slots behind it belong
+to the next cycle, so they only limit the result to the
+start of that cycle.
+
+Returns "kTimerWheel_NoTime" if no timers are armed.
+
+(2021.06)
+*/
+UInt64
+My_TimerWheel::
+returnNextEventTick ()
+const
+{
+	UInt64		result = kTimerWheel_NoTime;
+	
+	
+	if (this->armedCount > 0)
+	{
+		for (UInt8 level = 0; level < kMy_LevelCount; ++level)
+		{
+			UInt8 const		kShift = kMy_LevelShift[level];
+			UInt8 const		kCycleShift = (kShift + kMy_LevelBits[level]);
+			UInt16 const	kLevelSlotCount = (1 << kMy_LevelBits[level]);
+			UInt16 const	kCurrentIndex = STATIC_CAST((this->currentTick >> kShift) & (kLevelSlotCount - 1), UInt16);
+			Boolean const	kAtSlotStart = (0 == (this->currentTick & ((STATIC_CAST(1, UInt64) << kShift) - 1)));
+			UInt64			levelResult = kTimerWheel_NoTime;
+			
+			
+			// the current slot of a higher level has been spread out
+			// already, unless the current tick is the start of the slot
+			// (levels start on a word of the bit set, so a word never
+			// has bits from two levels)
+			for (UInt16 i = (kAtSlotStart ? kCurrentIndex : (kCurrentIndex + 1)); i < kLevelSlotCount; )
+			{
+				UInt16 const	kSlotIndex = (kMy_LevelFirstSlot[level] + i);
+				UInt64 const	kWord = this->occupiedSlots[kSlotIndex / 64] >> (kSlotIndex % 64);
+				
+				
+				if (0 == kWord)
+				{
+					// skip the rest of this word
+					i = STATIC_CAST((i | 63) + 1, UInt16);
+				}
+				else
+				{
+					i = STATIC_CAST(i + __builtin_ctzll(kWord), UInt16);
+					levelResult = (((this->currentTick >> kCycleShift) << kCycleShift) + (STATIC_CAST(i, UInt64) << kShift));
+					break;
+				}
+			}
+			
+			if (kTimerWheel_NoTime == levelResult)
+			{
+				for (UInt16 i = 0; i < kLevelSlotCount; i += 64)
+				{
+					if (0 != this->occupiedSlots[(kMy_LevelFirstSlot[level] + i) / 64])
+					{
+						// the remaining timers of this level are in the next cycle
+						levelResult = (((this->currentTick >> kCycleShift) + 1) << kCycleShift);
+						break;
+					}
+				}
+			}
+			
+			result = std::min(result, levelResult);
+		}
+	}
+	return result;
+}// My_TimerWheel::returnNextEventTick
+
+
+/*!
+Returns the current time, in milliseconds (see the routine
+TimerWheel_ReturnTime()).
+
+(2021.06)
+*/
+UInt64
+My_TimerWheel::
+returnTime ()
+const
+{
+	UInt64		result = this->manualTime;
+	
+	
+	if (nullptr != this->queue)
+	{
+		result = STATIC_CAST(std::chrono::duration_cast< std::chrono::milliseconds >
+								(std::chrono::steady_clock::now() - this->startTime).count(), UInt64);
+	}
+	return result;
+}// My_TimerWheel::returnTime
+
+
+/*!
+Sets the system timer for the next tick that has something
+to do, or turns it off if no timers are armed.  Has no
+effect for a wheel without a queue.
+
+(2021.06)
+*/
+void
+My_TimerWheel::
+scheduleSystemTimer ()
+{
+	UInt64 const	kNextTick = this->returnNextEventTick();
+	
+	
+	if (kNextTick != this->systemTimerTick)
+	{
+		this->systemTimerTick = kNextTick;
+	#ifdef __OBJC__
+		if (nullptr != this->systemTimer)
+		{
+			if (kTimerWheel_NoTime == kNextTick)
+			{
+				dispatch_source_set_timer(this->systemTimer, DISPATCH_TIME_FOREVER, DISPATCH_TIME_FOREVER, 0);
+			}
+			else
+			{
+				UInt64 const	kNow = this->returnTime();
+				UInt64 const	kWakeTime = (kNextTick * this->millisecondsPerTick);
+				UInt64 const	kDelay = (kWakeTime > kNow) ? (kWakeTime - kNow) : 0;
+				
+				
+				// allow the system to combine wake-ups within half a tick
+				dispatch_source_set_timer(this->systemTimer, dispatch_time(DISPATCH_TIME_NOW, STATIC_CAST(kDelay * NSEC_PER_MSEC, int64_t)),
+											DISPATCH_TIME_FOREVER, (this->millisecondsPerTick * NSEC_PER_MSEC) / 2);
+			}
+		}
+	#endif
+	}
+}// My_TimerWheel::scheduleSystemTimer
+
+
+/*!
+Unlinks an armed timer from its slot.
+
+(2021.06)
+*/
+void
+My_TimerWheel::
+unlink	(My_TimerPtr	inTimerPtr)
+{
+	My_TimerLink&	slotHead = this->slots[inTimerPtr->slotIndex];
+	
+	
+	inTimerPtr->previous->next = inTimerPtr->next;
+	inTimerPtr->next->previous = inTimerPtr->previous;
+	inTimerPtr->previous = inTimerPtr;
+	inTimerPtr->next = inTimerPtr;
+	inTimerPtr->isArmed = false;
+	if (slotHead.next == &slotHead)
+	{
+		this->occupiedSlots[inTimerPtr->slotIndex / 64] &= ~(STATIC_CAST(1, UInt64) << (inTimerPtr->slotIndex % 64));
+	}
+	--(this->armedCount);
+}// My_TimerWheel::unlink
+
+
+/*!
+Returns the internal structure of a timer reference.
+
+(2021.06)
+*/
+inline My_TimerPtr
+getTimer	(TimerWheel_TimerRef	inTimer)
+{
+	return REINTERPRET_CAST(inTimer, My_TimerPtr);
+}// getTimer
+
+
+/*!
+Returns the internal structure of a wheel reference.
+
+(2021.06)
+*/
+inline My_TimerWheelPtr
+getWheel	(TimerWheel_Ref		inWheel)
+{
+	return REINTERPRET_CAST(inWheel, My_TimerWheelPtr);
+}// getWheel
+
+
+#ifdef __OBJC__
+/*!
+Invoked on the queue of a wheel when its system timer
+fires; advances the wheel to the current time.
+
+(2021.06)
+*/
+void
+systemTimerFired	(void*		inWheelPtr)
+{
+	My_TimerWheelPtr	ptr = REINTERPRET_CAST(inWheelPtr, My_TimerWheelPtr);
+	
+	
+	// force the system timer to be set again for the next tick
+	ptr->systemTimerTick = kTimerWheel_NoTime;
+	ptr->advanceTo(ptr->returnTime());
+}// systemTimerFired
+#endif
+
+
+/*!
+Arms timers for many different delays (crossing every level
+of the wheel), and checks that each goes off at the first
+tick at or after its deadline, and that the next wake time
+is never later than the next deadline.
+
+Returns "true" if ALL assertions pass; "false" is
+returned if any fail, however messages should be
+printed for ALL assertion failures regardless.
+
+(2021.06)
+*/
+Boolean
+unitTest000_Begin ()
+{
+	UInt32 const					kMillisecondsPerTick = 10;
+	UInt32 const					kDelays[] =
+									{
+										0, 1, 9, 10, 11, 2550, 2560, 2570, 5000, 163830, 163840, 163850,
+										1000000, 10485750, 10485770, 50000000, 671088630, 700000000
+									};
+	size_t const					kTimerCount = sizeof(kDelays) / sizeof(kDelays[0]);
+	TimerWheel_Ref					wheel = TimerWheel_New(kMillisecondsPerTick, nullptr);
+	std::vector< TimerWheel_TimerRef >	timers;
+	std::vector< UInt64 >			firedTimes(kTimerCount, kTimerWheel_NoTime);
+	UInt32							wakeCount = 0;
+	Boolean							result = true;
+	
+	
+	// start at an odd time so that ticks are not aligned with delays
+	UNUSED_RETURN(TimerWheel_Result)TimerWheel_AdvanceTo(wheel, 12345);
+	for (size_t i = 0; i < kTimerCount; ++i)
+	{
+		timers.push_back(TimerWheel_NewTimer(wheel, unitTest000_Callback, &firedTimes[i]));
+		UNUSED_RETURN(TimerWheel_Result)TimerWheel_Arm(timers.back(), kDelays[i]);
+	}
+	Console_TestAssertUpdate(result, kTimerCount == TimerWheel_ReturnArmedTimerCount(wheel),
+								Console_WriteValue, "armed timer count", TimerWheel_ReturnArmedTimerCount(wheel));
+	
+	// advance only to each wake time, as an event loop would
+	while (TimerWheel_ReturnArmedTimerCount(wheel) > 0)
+	{
+		UInt64 const	kWakeTime = TimerWheel_ReturnNextWakeTime(wheel);
+		UInt64			nextDeadline = kTimerWheel_NoTime;
+		
+		
+		for (size_t i = 0; i < kTimerCount; ++i)
+		{
+			if (TimerWheel_IsArmed(timers[i]))
+			{
+				nextDeadline = std::min< UInt64 >(nextDeadline, 12345 + kDelays[i]);
+			}
+		}
+		Console_TestAssertUpdate(result, kWakeTime <= (nextDeadline + kMillisecondsPerTick),
+									Console_WriteValue, "next wake time is after a deadline; time", kWakeTime);
+		UNUSED_RETURN(TimerWheel_Result)TimerWheel_AdvanceTo(wheel, kWakeTime);
+		if (++wakeCount > 1000)
+		{
+			Console_TestAssertUpdate(result, false, Console_WriteLine, "too many wake-ups");
+			break;
+		}
+	}
+	
+	for (size_t i = 0; i < kTimerCount; ++i)
+	{
+		UInt64 const	kDeadline = (12345 + kDelays[i]);
+		
+		
+		Console_TestAssertUpdate(result, (firedTimes[i] >= kDeadline) && (firedTimes[i] < (kDeadline + kMillisecondsPerTick)),
+									Console_WriteValue, "timer did not go off on time; delay", kDelays[i]);
+		TimerWheel_DisposeTimer(&timers[i]);
+	}
+	TimerWheel_Dispose(&wheel);
+	
+	return result;
+}// unitTest000_Begin
+
+
+/*!
+Used by unitTest000_Begin() to record when a timer went off.
+
+(2021.06)
+*/
+void
+unitTest000_Callback	(TimerWheel_TimerRef	inTimer,
+						 void*					inFiredTimePtr)
+{
+	My_TimerPtr		ptr = getTimer(inTimer);
+	
+	
+	*(REINTERPRET_CAST(inFiredTimePtr, UInt64*)) = ptr->wheel->returnTime();
+}// unitTest000_Callback
+
+
+/*!
+Tests re-arming and cancelling: a timer that is re-armed
+more often than its delay must never go off, and must go
+off one delay after the last re-arm; arming for an earlier
+time must move a timer; and a callback must be able to
+cancel another timer that is due at the same time.
+
+Returns "true" if ALL assertions pass; "false" is
+returned if any fail, however messages should be
+printed for ALL assertion failures regardless.
+
+(2021.06)
+*/
+Boolean
+unitTest001_Begin ()
+{
+	TimerWheel_Ref			wheel = TimerWheel_New(50, nullptr);
+	My_UnitTestTimerInfo	keepAliveInfo = { 0, nullptr };
+	My_UnitTestTimerInfo	otherInfo = { 0, nullptr };
+	TimerWheel_TimerRef		keepAliveTimer = TimerWheel_NewTimer(wheel, unitTest001_Callback, &keepAliveInfo);
+	TimerWheel_TimerRef		otherTimer = TimerWheel_NewTimer(wheel, unitTest001_Callback, &otherInfo);
+	Boolean					result = true;
+	
+	
+	// data arrives every 700 milliseconds for a minute, with a
+	// keep-alive of 30 seconds
+	UNUSED_RETURN(TimerWheel_Result)TimerWheel_Arm(keepAliveTimer, 30000);
+	for (UInt64 time = 0; time <= 60000; time += 700)
+	{
+		UNUSED_RETURN(TimerWheel_Result)TimerWheel_AdvanceTo(wheel, time);
+		UNUSED_RETURN(TimerWheel_Result)TimerWheel_Rearm(keepAliveTimer);
+	}
+	Console_TestAssertUpdate(result, 0 == keepAliveInfo.fireCount,
+								Console_WriteValue, "re-armed timer went off; count", keepAliveInfo.fireCount);
+	UNUSED_RETURN(TimerWheel_Result)TimerWheel_AdvanceTo(wheel, 59500 + 30000 - 1);
+	Console_TestAssertUpdate(result, 0 == keepAliveInfo.fireCount,
+								Console_WriteValue, "re-armed timer went off early; count", keepAliveInfo.fireCount);
+	UNUSED_RETURN(TimerWheel_Result)TimerWheel_AdvanceTo(wheel, 59500 + 30000 + 50);
+	Console_TestAssertUpdate(result, (1 == keepAliveInfo.fireCount) && (false == TimerWheel_IsArmed(keepAliveTimer)),
+								Console_WriteValue, "re-armed timer did not go off once; count", keepAliveInfo.fireCount);
+	
+	// arming for an earlier time moves the timer
+	UNUSED_RETURN(TimerWheel_Result)TimerWheel_Arm(otherTimer, 100000);
+	UNUSED_RETURN(TimerWheel_Result)TimerWheel_Arm(otherTimer, 100);
+	UNUSED_RETURN(TimerWheel_Result)TimerWheel_AdvanceTo(wheel, TimerWheel_ReturnTime(wheel) + 200);
+	Console_TestAssertUpdate(result, 1 == otherInfo.fireCount,
+								Console_WriteValue, "timer armed earlier did not go off; count", otherInfo.fireCount);
+	
+	// cancelled timers do not go off
+	UNUSED_RETURN(TimerWheel_Result)TimerWheel_Arm(otherTimer, 100);
+	UNUSED_RETURN(TimerWheel_Result)TimerWheel_Cancel(otherTimer);
+	UNUSED_RETURN(TimerWheel_Result)TimerWheel_AdvanceTo(wheel, TimerWheel_ReturnTime(wheel) + 200);
+	Console_TestAssertUpdate(result, (1 == otherInfo.fireCount) && (0 == TimerWheel_ReturnArmedTimerCount(wheel)),
+								Console_WriteValue, "cancelled timer went off; count", otherInfo.fireCount);
+	
+	// whichever of two timers that are due in the same tick goes
+	// off first cancels the other one
+	keepAliveInfo.timerToCancel = otherTimer;
+	otherInfo.timerToCancel = keepAliveTimer;
+	UNUSED_RETURN(TimerWheel_Result)TimerWheel_Arm(keepAliveTimer, 100);
+	UNUSED_RETURN(TimerWheel_Result)TimerWheel_Arm(otherTimer, 100);
+	UNUSED_RETURN(TimerWheel_Result)TimerWheel_AdvanceTo(wheel, TimerWheel_ReturnTime(wheel) + 100);
+	Console_TestAssertUpdate(result, (3 == (keepAliveInfo.fireCount + otherInfo.fireCount)) &&
+										(0 == TimerWheel_ReturnArmedTimerCount(wheel)),
+								Console_WriteValue, "timer cancelled by callback went off; count", otherInfo.fireCount);
+	
+	TimerWheel_DisposeTimer(&keepAliveTimer);
+	TimerWheel_DisposeTimer(&otherTimer);
+	Console_TestAssertUpdate(result, nullptr == keepAliveTimer,
+								Console_WriteLine, "disposed timer reference was not cleared");
+	TimerWheel_Dispose(&wheel);
+	
+	return result;
+}// unitTest001_Begin
+
+
+/*!
+Used by unitTest001_Begin() to count how often a timer goes
+off, and to cancel another timer (if any).
+
+(2021.06)
+*/
+void
+unitTest001_Callback	(TimerWheel_TimerRef	UNUSED_ARGUMENT(inTimer),
+						 void*					inInfoPtr)
+{
+	My_UnitTestTimerInfo*	infoPtr = REINTERPRET_CAST(inInfoPtr, My_UnitTestTimerInfo*);
+	
+	
+	++(infoPtr->fireCount);
+	if (nullptr != infoPtr->timerToCancel)
+	{
+		UNUSED_RETURN(TimerWheel_Result)TimerWheel_Cancel(infoPtr->timerToCancel);
+	}
+}// unitTest001_Callback
+
+} // anonymous namespace
+
+// BELOW IS REQUIRED NEWLINE TO END FILE
@@ -0,0 +1,510 @@
+/*!	\file TraceSpan.cp
+	\brief Records timed spans of work on any thread, for
+	export in the trace format of Chrome and Perfetto.
+*/
+/*###############################################################
+
+	Data Access Library
+	© 1998-2021 by Kevin Grant
+	
+	This library is free software; you can redistribute it or
+	modify it under the terms of the GNU Lesser Public License
+	as published by the Free Software Foundation; either version
+	2.1 of the License, or (at your option) any later version.
+	
+	This program is distributed in the hope that it will be
+	useful, but WITHOUT ANY WARRANTY; without even the implied
+	warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+	PURPOSE.  See the GNU Lesser Public License for details.
+	
+	You should have received a copy of the GNU Lesser Public
+	License along with this library; if not, write to:
+	
+		Free Software Foundation, Inc.
+		59 Temple Place, Suite 330
+		Boston, MA  02111-1307
+		USA
+
+###############################################################*/
+
+#include <TraceSpan.h>
+#include <UniversalDefines.h>
+
+// standard-C includes
+#include <cstdio>
+#include <cstring>
+
+// standard-C++ includes
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Unix includes
+#include <pthread.h>
+#include <unistd.h>
+
+// Mac includes
+#include <CoreServices/CoreServices.h>
+#include <dispatch/dispatch.h>
+
+// library includes
+#include <Console.h>
+
+
+
+#pragma mark Constants
+namespace {
+
+UInt32 const	kMy_SpanRingCapacity = 65536;		//!< most recent spans kept per thread; must be a power of 2
+size_t const	kMy_ThreadNameMaximum = 64;			//!< bytes kept from a thread or queue name
+
+} // anonymous namespace
+
+#pragma mark Types
+namespace {
+
+/*!
+One completed span.  Times are nanoseconds on the monotonic
+clock used by __TraceSpan_ReturnTime().
+*/
+struct My_SpanRecord
+{
+	char const*		name;			//!< string literal given to the span
+	SInt64			startTime;		//!< when the span began
+	SInt64			endTime;		//!< when the span ended
+	SInt64			byteCount;		//!< amount of data handled, or negative if not applicable
+};
+
+/*!
+The spans of one thread.  Once full, new spans overwrite
+the oldest ones.  The lock is only ever contended while
+spans are being exported or discarded, so recording a
+span does not normally wait.
+*/
+struct My_SpanRing
+{
+	inline
+	My_SpanRing ();
+	
+	std::mutex						lock;			//!< protects all other members
+	std::vector< My_SpanRecord >	records;		//!< allocated on first use, to "kMy_SpanRingCapacity" entries
+	UInt64							writeCount;		//!< spans recorded since the last reset (may exceed capacity)
+	UInt32							threadID;		//!< stable number for the owning thread, used as "tid" in traces
+	char							threadName[kMy_ThreadNameMaximum];	//!< thread or queue name, if any
+};
+typedef std::shared_ptr< My_SpanRing >	My_SpanRingPtr;
+
+/*!
+The buffers of all threads that have recorded spans.
+*/
+struct My_SpanRegistry
+{
+	inline
+	My_SpanRegistry ();
+	
+	std::mutex						lock;				//!< protects all members
+	std::vector< My_SpanRingPtr >	rings;				//!< buffers of all threads (including exited threads)
+	SInt64							captureStartTime;	//!< time that recording was last enabled; trace time zero
+	UInt32							nextThreadID;		//!< value for the next buffer’s "threadID"
+};
+
+} // anonymous namespace
+
+#pragma mark Internal Method Prototypes
+namespace {
+
+My_SpanRing*	returnThreadRing	();
+void			writeJSONString		(std::ostream&, char const*);
+
+} // anonymous namespace
+
+#pragma mark Variables
+namespace {
+
+thread_local My_SpanRingPtr		gThreadRingPtr;
+My_SpanRegistry&				gSpanRegistry ()	{ static My_SpanRegistry* x = new My_SpanRegistry(); return *x; } // never deleted
+
+} // anonymous namespace
+
+std::atomic< bool >		gTraceSpan_IsEnabled(false);
+
+
+
+#pragma mark Public Methods
+
+/*!
+A unit test for this module.  This should always
+be run before a release, after any substantial
+changes are made, or if you suspect bugs!  It
+should also be EXPANDED as new functionality is
+proposed (ideally, a test is written before the
+functionality is added).
+
+Note that this discards any spans recorded so far.
+
+(2021.06)
+*/
+void
+TraceSpan_RunTests ()
+{
+	Boolean const	kWasEnabled = TraceSpan_IsEnabled();
+	Boolean			result = true;
+	
+	
+	TraceSpan_SetEnabled(false);
+	{
+		TraceSpan_Scope("test span while disabled");
+	}
+	TraceSpan_SetEnabled(true);
+	{
+		TraceSpan_ScopeWithByteCount("test span", 12);
+	}
+	{
+		TraceSpan_Scope("test \"quoted\" span");
+		
+		
+		TraceSpan_SetByteCount(34);
+	}
+	std::thread([]{ TraceSpan_Scope("test span on other thread"); }).join();
+	{
+		std::ostringstream	traceStream;
+		size_t const		kSpanCount = TraceSpan_WriteChromeTrace(traceStream);
+		std::string const	kTrace = traceStream.str();
+		
+		
+	#if TRACE_SPANS
+		result &= Console_Assert("three spans exported", 3 == kSpanCount);
+		result &= Console_Assert("trace has span", std::string::npos != kTrace.find("\"name\":\"test span\""));
+		result &= Console_Assert("trace has byte count", std::string::npos != kTrace.find("\"bytes\":12"));
+		result &= Console_Assert("trace has late byte count", std::string::npos != kTrace.find("\"bytes\":34"));
+		result &= Console_Assert("trace escapes quotes", std::string::npos != kTrace.find("test \\\"quoted\\\" span"));
+		result &= Console_Assert("trace has other thread", std::string::npos != kTrace.find("test span on other thread"));
+		result &= Console_Assert("trace omits disabled span", std::string::npos == kTrace.find("while disabled"));
+	#else
+		result &= Console_Assert("no spans exported", 0 == kSpanCount);
+	#endif
+		result &= Console_Assert("trace is an object", (false == kTrace.empty()) && ('{' == kTrace.front()));
+	}
+	TraceSpan_SetEnabled(kWasEnabled);
+	
+	Console_WriteUnitTestReport("TraceSpan", (result) ? 0 : 1, 1);
+}// RunTests
+
+
+/*!
+Turns recording on or off.  When recording starts, all
+spans from the previous recording are discarded (as are
+the buffers of threads that have since exited).
+
+Spans that are already in progress when recording starts
+are not recorded; spans in progress when recording stops
+are still recorded when they end.
+
+(2021.06)
+*/
+void
+TraceSpan_SetEnabled	(Boolean	inIsEnabled)
+{
+	My_SpanRegistry&				registry = gSpanRegistry();
+	std::lock_guard< std::mutex >	registryGuard(registry.lock);
+	
+	
+	if ((inIsEnabled) && (false == gTraceSpan_IsEnabled.load()))
+	{
+		std::vector< My_SpanRingPtr >	remainingRings;
+		
+		
+		for (auto& ringPtr : registry.rings)
+		{
+			// only the registry refers to buffers of exited threads
+			if (ringPtr.use_count() > 1)
+			{
+				std::lock_guard< std::mutex >	ringGuard(ringPtr->lock);
+				
+				
+				ringPtr->writeCount = 0;
+				remainingRings.push_back(ringPtr);
+			}
+		}
+		registry.rings.swap(remainingRings);
+		registry.captureStartTime = __TraceSpan_ReturnTime();
+	}
+	gTraceSpan_IsEnabled = inIsEnabled;
+}// SetEnabled
+
+
+/*!
+Writes all spans recorded since recording was last enabled,
+as a JSON object in the “Trace Event Format” understood by
+Chrome (“chrome://tracing”) and Perfetto.  Each thread of
+this process appears as a separate track, named after the
+thread or the dispatch queue that first ran a span on it.
+
+Recording does not have to be turned off first; but for a
+consistent picture, export right after the interesting
+period ends, before older spans are overwritten.
+
+Returns the number of spans written.
+
+(2021.06)
+*/
+size_t
+TraceSpan_WriteChromeTrace	(std::ostream&	inoutStream)
+{
+	My_SpanRegistry&				registry = gSpanRegistry();
+	std::vector< My_SpanRingPtr >	rings;
+	SInt64							captureStartTime = 0;
+	int const						kProcessID = STATIC_CAST(getpid(), int);
+	size_t							result = 0;
+	
+	
+	{
+		std::lock_guard< std::mutex >	registryGuard(registry.lock);
+		
+		
+		rings = registry.rings;
+		captureStartTime = registry.captureStartTime;
+	}
+	
+	inoutStream << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+	inoutStream << std::fixed << std::setprecision(3);
+	inoutStream << "\n{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << kProcessID << ",\"args\":{\"name\":\"MacTerm\"}}";
+	for (auto& ringPtr : rings)
+	{
+		std::vector< My_SpanRecord >	records;
+		UInt32							threadID = 0;
+		std::string						threadName;
+		
+		
+		// copy quickly, so that the owning thread is not held up
+		// while the trace is formatted
+		{
+			std::lock_guard< std::mutex >	ringGuard(ringPtr->lock);
+			UInt64 const					kAvailable = std::min< UInt64 >(ringPtr->writeCount, kMy_SpanRingCapacity);
+			
+			
+			records.reserve(STATIC_CAST(kAvailable, size_t));
+			for (UInt64 i = ringPtr->writeCount - kAvailable; i < ringPtr->writeCount; ++i)
+			{
+				records.push_back(ringPtr->records[STATIC_CAST(i & (kMy_SpanRingCapacity - 1), size_t)]);
+			}
+			threadID = ringPtr->threadID;
+			threadName = ringPtr->threadName;
+		}
+		
+		inoutStream << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << kProcessID
+					<< ",\"tid\":" << threadID << ",\"args\":{\"name\":";
+		writeJSONString(inoutStream, threadName.c_str());
+		inoutStream << "}}";
+		for (auto const& record : records)
+		{
+			// spans that began before recording started belong to
+			// an older recording
+			if (record.startTime >= captureStartTime)
+			{
+				inoutStream << ",\n{\"name\":";
+				writeJSONString(inoutStream, record.name);
+				inoutStream << ",\"cat\":\"MacTerm\",\"ph\":\"X\",\"pid\":" << kProcessID << ",\"tid\":" << threadID
+							<< ",\"ts\":" << (STATIC_CAST(record.startTime - captureStartTime, double) / 1000.0)
+							<< ",\"dur\":" << (STATIC_CAST(record.endTime - record.startTime, double) / 1000.0);
+				if (record.byteCount >= 0)
+				{
+					inoutStream << ",\"args\":{\"bytes\":" << record.byteCount << "}";
+				}
+				inoutStream << "}";
+				++result;
+			}
+		}
+	}
+	inoutStream << "\n]}\n";
+	
+	return result;
+}// WriteChromeTrace
+
+
+/*!
+Writes a trace (see TraceSpan_WriteChromeTrace()) to a new
+file at the given path, replacing any existing file.
+
+Returns "true" only if the entire file was written.
+
+(2021.06)
+*/
+Boolean
+TraceSpan_WriteChromeTraceFile	(char const*	inPathname)
+{
+	std::ofstream	fileStream(inPathname, std::ios::out | std::ios::trunc);
+	Boolean			result = false;
+	
+	
+	if (fileStream)
+	{
+		size_t const	kSpanCount = TraceSpan_WriteChromeTrace(fileStream);
+		
+		
+		fileStream.close();
+		result = (false == fileStream.fail());
+		if (result)
+		{
+			Console_WriteValue("exported trace spans", kSpanCount);
+		}
+	}
+	
+	unless (result)
+	{
+		Console_Warning(Console_WriteValueCString, "failed to write trace file", inPathname);
+	}
+	
+	return result;
+}// WriteChromeTraceFile
+
+
+/*!
+Adds a completed span to the buffer of the calling thread.
+Used by TraceSpan_Span; do not call directly.
+
+(2021.06)
+*/
+void
+__TraceSpan_Record	(char const*	inStaticName,
+					 SInt64			inStartTime,
+					 SInt64			inEndTime,
+					 SInt64			inByteCountOrNegative)
+{
+	My_SpanRing*					ringPtr = returnThreadRing();
+	std::lock_guard< std::mutex >	ringGuard(ringPtr->lock);
+	My_SpanRecord&					record = ringPtr->records[STATIC_CAST(ringPtr->writeCount & (kMy_SpanRingCapacity - 1), size_t)];
+	
+	
+	record.name = inStaticName;
+	record.startTime = inStartTime;
+	record.endTime = inEndTime;
+	record.byteCount = inByteCountOrNegative;
+	++(ringPtr->writeCount);
+}// __TraceSpan_Record
+
+
+#pragma mark Internal Methods
+namespace {
+
+/*!
+Initializes an empty buffer.
+*/
+My_SpanRing::
+My_SpanRing ()
+:
+lock(),
+records(),
+writeCount(0),
+threadID(0),
+threadName()
+{
+}// My_SpanRing default constructor
+
+
+/*!
+Initializes an empty registry.
+*/
+My_SpanRegistry::
+My_SpanRegistry ()
+:
+lock(),
+rings(),
+captureStartTime(0),
+nextThreadID(1)
+{
+}// My_SpanRegistry default constructor
+
+
+/*!
+Returns the buffer of the calling thread, creating and
+registering it the first time that the thread records a
+span.  The buffer is named after the thread, or the
+dispatch queue that is running on it (such as the data
+loop of a session), so that trace viewers can label it.
+
+(2021.06)
+*/
+My_SpanRing*
+returnThreadRing ()
+{
+	if (nullptr == gThreadRingPtr)
+	{
+		My_SpanRingPtr		newRingPtr = std::make_shared< My_SpanRing >();
+		char const*			queueName = dispatch_queue_get_label(DISPATCH_CURRENT_QUEUE_LABEL);
+		
+		
+		newRingPtr->records.resize(kMy_SpanRingCapacity);
+		if (0 != pthread_getname_np(pthread_self(), newRingPtr->threadName, sizeof(newRingPtr->threadName)))
+		{
+			newRingPtr->threadName[0] = '\0';
+		}
+		if (('\0' == newRingPtr->threadName[0]) && (nullptr != queueName))
+		{
+			UNUSED_RETURN(int)snprintf(newRingPtr->threadName, sizeof(newRingPtr->threadName), "%s", queueName);
+		}
+		
+		{
+			My_SpanRegistry&				registry = gSpanRegistry();
+			std::lock_guard< std::mutex >	registryGuard(registry.lock);
+			
+			
+			newRingPtr->threadID = registry.nextThreadID++;
+			if ('\0' == newRingPtr->threadName[0])
+			{
+				UNUSED_RETURN(int)snprintf(newRingPtr->threadName, sizeof(newRingPtr->threadName), "thread %u",
+											STATIC_CAST(newRingPtr->threadID, unsigned int));
+			}
+			registry.rings.push_back(newRingPtr);
+		}
+		gThreadRingPtr = newRingPtr;
+	}
+	return gThreadRingPtr.get();
+}// returnThreadRing
+
+
+/*!
+Writes a string in quotes, escaping characters as required
+by JSON.
+
+(2021.06)
+*/
+void
+writeJSONString		(std::ostream&	inoutStream,
+					 char const*	inString)
+{
+	inoutStream << '"';
+	for (char const* charPtr = inString; '\0' != *charPtr; ++charPtr)
+	{
+		UInt8 const		kCharacter = STATIC_CAST(*charPtr, UInt8);
+		
+		
+		if (('"' == kCharacter) || ('\\' == kCharacter))
+		{
+			inoutStream << '\\' << *charPtr;
+		}
+		else if (kCharacter < ' '/* space */)
+		{
+			char	escapeBuffer[8];
+			
+			
+			UNUSED_RETURN(int)snprintf(escapeBuffer, sizeof(escapeBuffer), "\\u%04x", STATIC_CAST(kCharacter, unsigned int));
+			inoutStream << escapeBuffer;
+		}
+		else
+		{
+			inoutStream << *charPtr;
+		}
+	}
+	inoutStream << '"';
+}// writeJSONString
+
+} // anonymous namespace
+
+// BELOW IS REQUIRED NEWLINE TO END FILE
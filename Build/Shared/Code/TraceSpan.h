@@ -0,0 +1,213 @@
+/*!	\file TraceSpan.h
+	\brief Records timed spans of work on any thread, for
+	export in the trace format of Chrome and Perfetto.
+	
+	Declare a span at the beginning of a block with the macro
+	TraceSpan_Scope(); when the block exits, the time spent
+	inside is recorded by the calling thread.  Spans cost
+	almost nothing unless recording has been turned on with
+	TraceSpan_SetEnabled(), and they can be removed from the
+	build entirely by defining TRACE_SPANS to 0.
+	
+	Each thread keeps only its most recent spans, so recording
+	can be left on indefinitely; export with
+	TraceSpan_WriteChromeTrace() just after a problem occurs
+	and open the file in “chrome://tracing” or the Perfetto UI
+	to see where the time went.
+*/
+/*###############################################################
+
+	Data Access Library
+	© 1998-2021 by Kevin Grant
+	
+	This library is free software; you can redistribute it or
+	modify it under the terms of the GNU Lesser Public License
+	as published by the Free Software Foundation; either version
+	2.1 of the License, or (at your option) any later version.
+	
+	This program is distributed in the hope that it will be
+	useful, but WITHOUT ANY WARRANTY; without even the implied
+	warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+	PURPOSE.  See the GNU Lesser Public License for details.
+	
+	You should have received a copy of the GNU Lesser Public
+	License along with this library; if not, write to:
+	
+		Free Software Foundation, Inc.
+		59 Temple Place, Suite 330
+		Boston, MA  02111-1307
+		USA
+
+###############################################################*/
+
+#include <UniversalDefines.h>
+
+#pragma once
+
+// standard-C++ includes
+#include <atomic>
+#include <chrono>
+#include <iosfwd>
+
+// Mac includes
+#include <CoreServices/CoreServices.h>
+
+
+
+#pragma mark Constants
+
+//! set to 0 to compile out every span (the functions remain
+//! available, but there is never anything to export)
+#ifndef TRACE_SPANS
+#	define TRACE_SPANS 1
+#endif
+
+#pragma mark Types
+
+/*!
+Measures the time between its construction and destruction,
+and records a span for the calling thread if recording was
+enabled when the span began.  Use TraceSpan_Scope() instead
+of declaring this directly, so that spans can be compiled
+out.
+
+The name must be a string literal (or otherwise live for
+the rest of the program), as only its address is stored.
+*/
+struct TraceSpan_Span
+{
+public:
+	inline
+	TraceSpan_Span		(char const*	inStaticName,
+						 SInt64			inByteCountOrNegative = -1);
+	
+	inline
+	~TraceSpan_Span		();
+	
+	inline void
+	setByteCount		(SInt64		inByteCount);
+
+private:
+	char const*		_name;			//!< label shown in the trace viewer
+	SInt64			_startTime;		//!< nanoseconds on the monotonic clock; 0 if not recording
+	SInt64			_byteCount;		//!< amount of data handled by the span, or negative if not applicable
+};
+
+#pragma mark Variables
+
+extern std::atomic< bool >		gTraceSpan_IsEnabled;
+
+
+
+#pragma mark Public Methods
+
+//!\name Module Tests
+//@{
+
+void
+	TraceSpan_RunTests				();
+
+//@}
+
+//!\name Recording
+//@{
+
+// USE THESE MACROS INSTEAD OF DECLARING TraceSpan_Span VARIABLES DIRECTLY;
+// e.g. TraceSpan_Scope("draw text"); ... TraceSpan_SetByteCount(length);
+// (at most one span may be declared per block, and the name must be a literal)
+#if TRACE_SPANS
+#	define TraceSpan_Scope(name)						TraceSpan_Span __traceSpan(name)
+#	define TraceSpan_ScopeWithByteCount(name, count)	TraceSpan_Span __traceSpan(name, STATIC_CAST(count, SInt64))
+#	define TraceSpan_SetByteCount(count)				__traceSpan.setByteCount(STATIC_CAST(count, SInt64))
+#else
+#	define TraceSpan_Scope(name)						do {} while (0)
+#	define TraceSpan_ScopeWithByteCount(name, count)	do {} while (0)
+#	define TraceSpan_SetByteCount(count)				do {} while (0)
+#endif
+
+inline Boolean
+	TraceSpan_IsEnabled				()
+	{
+	#if TRACE_SPANS
+		return gTraceSpan_IsEnabled.load(std::memory_order_relaxed);
+	#else
+		return false;
+	#endif
+	}
+
+// DISCARDS ANY PREVIOUS SPANS WHEN RECORDING IS TURNED ON
+void
+	TraceSpan_SetEnabled			(Boolean			inIsEnabled);
+
+// DO NOT USE DIRECTLY
+void
+	__TraceSpan_Record				(char const*		inStaticName,
+									 SInt64				inStartTime,
+									 SInt64				inEndTime,
+									 SInt64				inByteCountOrNegative);
+
+// DO NOT USE DIRECTLY
+inline SInt64
+	__TraceSpan_ReturnTime			()
+	{
+		return STATIC_CAST(std::chrono::duration_cast< std::chrono::nanoseconds >
+							(std::chrono::steady_clock::now().time_since_epoch()).count(), SInt64);
+	}
+
+//@}
+
+//!\name Exporting Spans
+//@{
+
+// RETURNS THE NUMBER OF SPANS WRITTEN
+size_t
+	TraceSpan_WriteChromeTrace		(std::ostream&		inoutStream);
+
+Boolean
+	TraceSpan_WriteChromeTraceFile	(char const*		inPathname);
+
+//@}
+
+
+
+#pragma mark Inline Methods
+
+/*!
+Starts timing, if recording is enabled.
+*/
+TraceSpan_Span::
+TraceSpan_Span	(char const*	inStaticName,
+				 SInt64			inByteCountOrNegative)
+:
+_name(inStaticName),
+_startTime(TraceSpan_IsEnabled() ? __TraceSpan_ReturnTime() : 0),
+_byteCount(inByteCountOrNegative)
+{
+}
+
+
+/*!
+Records the span, if it was started while recording.
+*/
+TraceSpan_Span::
+~TraceSpan_Span ()
+{
+	if (0 != _startTime)
+	{
+		__TraceSpan_Record(_name, _startTime, __TraceSpan_ReturnTime(), _byteCount);
+	}
+}
+
+
+/*!
+Specifies the amount of data handled by the span, when it
+was not known at the beginning.
+*/
+void
+TraceSpan_Span::
+setByteCount	(SInt64		inByteCount)
+{
+	_byteCount = inByteCount;
+}
+
+// BELOW IS REQUIRED NEWLINE TO END FILE
@@ -0,0 +1,108 @@
+/*!	\file SpawnHelper.cp
+	\brief Runs a program with the pseudo-terminal that it
+	was given as its controlling terminal.
+	
+	Started by the Process Spawn module (see ProcessSpawn.h)
+	on systems where posix_spawn() cannot do this by itself.
+	The helper is already the leader of a new session, in the
+	right directory, with the device as its standard input,
+	output and error; so it only claims the terminal and then
+	replaces itself with the program.  It must stay tiny, as
+	it runs for every new session.
+*/
+/*###############################################################
+
+	MacTerm
+		© 1998-2021 by Kevin Grant.
+		© 2001-2003 by Ian Anderson.
+		© 1986-1994 University of Illinois Board of Trustees
+		(see About box for full list of U of I contributors).
+	
+	This program is free software; you can redistribute it or
+	modify it under the terms of the GNU General Public License
+	as published by the Free Software Foundation; either version
+	2 of the License, or (at your option) any later version.
+	
+	This program is distributed in the hope that it will be
+	useful, but WITHOUT ANY WARRANTY; without even the implied
+	warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+	PURPOSE.  See the GNU General Public License for more
+	details.
+	
+	You should have received a copy of the GNU General Public
+	License along with this program; if not, write to:
+	
+		Free Software Foundation, Inc.
+		59 Temple Place, Suite 330
+		Boston, MA  02111-1307
+		USA
+
+###############################################################*/
+
+// standard-C includes
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// UNIX includes
+extern "C"
+{
+#	include <sysexits.h>
+#	include <unistd.h>
+#	include <sys/ioctl.h>
+}
+
+
+
+#pragma mark Public Methods
+
+/*!
+Makes standard input the controlling terminal and runs the
+program named by the first argument, with the remaining
+arguments.  Output goes to the terminal, so that the user
+can see why a session ends immediately.
+
+Exits with EX_UNAVAILABLE if the program cannot be run (as
+the application did before it used this helper), or with
+EX_OSERR if the terminal cannot be claimed.
+
+(2021.06)
+*/
+int
+main	(int		argc,
+		 char*		argv[])
+{
+	int		result = EX_UNAVAILABLE;
+	
+	
+	if (argc < 2)
+	{
+		std::fprintf(stderr, "usage: %s program [arguments...]\n", argv[0]);
+		result = EX_USAGE;
+	}
+	else
+	{
+		// this normally fails, because the helper is started in
+		// a new session; but it is harmless, and makes the helper
+		// work even if it is started some other way
+		(void)setsid();
+		
+		if (0 != ioctl(STDIN_FILENO, TIOCSCTTY, 0))
+		{
+			std::perror("unable to set controlling terminal");
+			result = EX_OSERR;
+		}
+		else
+		{
+			// does not return unless there is an error
+			(void)execvp(argv[1], argv + 1);
+			std::fprintf(stderr, "unable to run \"%s\": %s\n", argv[1], std::strerror(errno));
+			result = EX_UNAVAILABLE;
+		}
+	}
+	
+	return result;
+}// main
+
+// BELOW IS REQUIRED NEWLINE TO END FILE